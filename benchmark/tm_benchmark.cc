@@ -28,8 +28,13 @@
 #include "common/cmdline.hpp"
 #include "common/timer.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <thread>
+#include <vector>
 
 
 int benchmark_loop = 1;
@@ -38,6 +43,10 @@ int benchmark_model = -1;
 int benchmark_cluster = 0;
 int benchmark_mask = 0xFFFF;
 int benchmark_data_type = 0;
+int benchmark_warmup = 1;
+int benchmark_instances = 1;
+int benchmark_precision = TENGINE_MODE_FP32;
+float benchmark_threshold = 10.f;
 std::string benchmark_device = "";
 context_t s_context;
 
@@ -61,60 +70,69 @@ int get_tenser_element_size(int data_type)
 }
 
 
-int benchmark_graph(options_t* opt, const char* name, const char* file, int height, int width, int channel, int batch)
+struct benchmark_result
+{
+    std::string name;
+    int batch;
+    float min, max, avg;
+    float p50, p90, p99;
+    float fps;
+};
+
+std::vector<benchmark_result> benchmark_results;
+
+
+graph_t create_benchmark_graph(options_t* opt, const char* file, int* shape, std::vector<unsigned char>& input_buffer)
 {
     // create graph, load tengine model xxx.tmfile
     graph_t graph = create_graph(s_context, "tengine", file);
     if (nullptr == graph)
     {
         fprintf(stderr, "Tengine Benchmark: Create graph failed.\n");
-        return -1;
+        return nullptr;
     }
 
-    // set the input shape to initial the graph, and pre-run graph to infer shape
-    int input_size = height * width * channel;
-    int shape[] = { batch, channel, height, width };    // nchw
-
-    std::vector<unsigned char> input_buffer(batch * input_size * get_tenser_element_size(benchmark_data_type));
-
-    memset(input_buffer.data(), 1, input_buffer.size());
-
     tensor_t input_tensor = get_graph_input_tensor(graph, 0, 0);
     if (input_tensor == nullptr)
     {
         fprintf(stderr, "Tengine Benchmark: Get input tensor failed.\n");
-        return -1;
+        destroy_graph(graph);
+        return nullptr;
     }
 
+    // set the input shape to initial the graph, and pre-run graph to infer shape
     if (set_tensor_shape(input_tensor, shape, 4) < 0)
     {
         fprintf(stderr, "Tengine Benchmark: Set input tensor shape failed.\n");
-        return -1;
+        destroy_graph(graph);
+        return nullptr;
     }
 
     if (prerun_graph_multithread(graph, *opt) < 0)
     {
         fprintf(stderr, "Tengine Benchmark: Pre-run graph failed.\n");
-        return -1;
+        destroy_graph(graph);
+        return nullptr;
     }
 
     // prepare process input data, set the data mem to input tensor
     if (set_tensor_buffer(input_tensor, input_buffer.data(), (int)input_buffer.size()) < 0)
     {
         fprintf(stderr, "Tengine Benchmark: Set input tensor buffer failed\n");
-        return -1;
+        postrun_graph(graph);
+        destroy_graph(graph);
+        return nullptr;
     }
 
-    // warning up graph
-    if (run_graph(graph, 1) < 0)
-    {
-        fprintf(stderr, "Tengine Benchmark: Run graph failed.\n");
-        return -1;
-    }
+    release_graph_tensor(input_tensor);
 
-    std::vector<float> time_cost(benchmark_loop);
+    return graph;
+}
 
-    // run graph
+
+// run the graph in a loop, the time of each run is saved
+int run_benchmark_graph(graph_t graph, float* time_cost)
+{
     for (int i = 0; i < benchmark_loop; i++)
     {
         Timer timer;
@@ -128,35 +146,250 @@ int benchmark_graph(options_t* opt, const char* name, const char* file, int heig
         }
     }
 
-    float min = time_cost[0], max = time_cost[0], sum = 0.f;
-    for (const auto& var : time_cost)
+    return 0;
+}
+
+
+// the nearest rank percentile of the sorted time
+float get_percentile(const std::vector<float>& sorted_time, float percent)
+{
+    int rank = (int)std::ceil(percent / 100.f * (float)sorted_time.size());
+
+    return sorted_time[std::max(rank, 1) - 1];
+}
+
+
+int benchmark_graph(options_t* opt, const char* name, const char* file, int height, int width, int channel, int batch)
+{
+    int input_size = height * width * channel;
+    int shape[] = { batch, channel, height, width };    // nchw
+
+    // each instance has its own graph and input, in throughput mode they run at the same time
+    std::vector<std::vector<unsigned char> > input_buffer(benchmark_instances);
+    std::vector<graph_t> graph(benchmark_instances, nullptr);
+
+    int ret = 0;
+    for (int n = 0; n < benchmark_instances; n++)
     {
-        if (min > var)
+        input_buffer[n].resize(batch * input_size * get_tenser_element_size(benchmark_data_type));
+        memset(input_buffer[n].data(), 1, input_buffer[n].size());
+
+        graph[n] = create_benchmark_graph(opt, file, shape, input_buffer[n]);
+        if (nullptr == graph[n])
         {
-            min = var;
+            ret = -1;
+            break;
         }
+    }
 
-        if (max < var)
+    // warning up graph
+    for (int n = 0; 0 == ret && n < benchmark_instances; n++)
+    {
+        for (int i = 0; i < benchmark_warmup; i++)
         {
-            max = var;
+            if (run_graph(graph[n], 1) < 0)
+            {
+                fprintf(stderr, "Tengine Benchmark: Run graph failed.\n");
+                ret = -1;
+                break;
+            }
         }
-
-        sum += var;
     }
-    sum /= (float)time_cost.size();
 
+    std::vector<float> time_cost(benchmark_loop * benchmark_instances);
+    float wall_time = 0.f;
+
+    // run graph
+    if (0 == ret)
+    {
+        Timer timer;
+
+        if (1 == benchmark_instances)
+        {
+            ret = run_benchmark_graph(graph[0], time_cost.data());
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            std::vector<int> worker_ret(benchmark_instances, 0);
+
+            for (int n = 0; n < benchmark_instances; n++)
+            {
+                workers.emplace_back([&, n]() { worker_ret[n] = run_benchmark_graph(graph[n], time_cost.data() + n * benchmark_loop); });
+            }
+
+            for (int n = 0; n < benchmark_instances; n++)
+            {
+                workers[n].join();
+                ret |= worker_ret[n];
+            }
+        }
 
-    fprintf(stderr, "%20s  min = %7.2f ms   max = %7.2f ms   avg = %7.2f ms\n", name, min, max, sum);
+        wall_time = timer.TimeCost();
+    }
 
     // release tengine graph
-    release_graph_tensor(input_tensor);
-    postrun_graph(graph);
-    destroy_graph(graph);
+    for (int n = 0; n < benchmark_instances; n++)
+    {
+        if (nullptr != graph[n])
+        {
+            postrun_graph(graph[n]);
+            destroy_graph(graph[n]);
+        }
+    }
+
+    if (0 != ret)
+    {
+        return -1;
+    }
+
+    std::sort(time_cost.begin(), time_cost.end());
+
+    benchmark_result result;
+    result.name = name;
+    result.batch = batch;
+    result.min = time_cost.front();
+    result.max = time_cost.back();
+    result.avg = 0.f;
+    for (const auto& var : time_cost)
+    {
+        result.avg += var;
+    }
+    result.avg /= (float)time_cost.size();
+    result.p50 = get_percentile(time_cost, 50.f);
+    result.p90 = get_percentile(time_cost, 90.f);
+    result.p99 = get_percentile(time_cost, 99.f);
+    result.fps = wall_time > 0.f ? (float)(benchmark_loop * benchmark_instances * batch) * 1000.f / wall_time : 0.f;
+
+    fprintf(stderr, "%20s  min = %7.2f ms   max = %7.2f ms   avg = %7.2f ms   p50 = %7.2f ms   p90 = %7.2f ms   p99 = %7.2f ms   fps = %8.2f\n",
+            name, result.min, result.max, result.avg, result.p50, result.p90, result.p99, result.fps);
+
+    benchmark_results.push_back(result);
+
+    return 0;
+}
+
+
+// the results are written one on a line, so that a baseline can be read back by load_baseline()
+int save_results(const char* file)
+{
+    FILE* fp = fopen(file, "w");
+    if (nullptr == fp)
+    {
+        fprintf(stderr, "Tengine Benchmark: Open json file %s failed.\n", file);
+        return -1;
+    }
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"version\": \"%s\",\n", get_tengine_version());
+    fprintf(fp, "  \"device\": \"%s\",\n", benchmark_device.c_str());
+    fprintf(fp, "  \"threads\": %d,\n", benchmark_threads);
+    fprintf(fp, "  \"instances\": %d,\n", benchmark_instances);
+    fprintf(fp, "  \"loops\": %d,\n", benchmark_loop);
+    fprintf(fp, "  \"warmup\": %d,\n", benchmark_warmup);
+    fprintf(fp, "  \"results\": [\n");
+    for (size_t i = 0; i < benchmark_results.size(); i++)
+    {
+        const benchmark_result& r = benchmark_results[i];
+        fprintf(fp, "    {\"name\": \"%s\", \"batch\": %d, \"min\": %.3f, \"max\": %.3f, \"avg\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"fps\": %.3f}%s\n",
+                r.name.c_str(), r.batch, r.min, r.max, r.avg, r.p50, r.p90, r.p99, r.fps, i + 1 < benchmark_results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+
+    fclose(fp);
+
+    return 0;
+}
+
+
+bool get_json_value(const char* line, const char* key, float* value)
+{
+    std::string pattern = std::string("\"") + key + "\":";
+    const char* p = strstr(line, pattern.c_str());
+
+    return nullptr != p && 1 == sscanf(p + pattern.size(), "%f", value);
+}
+
+
+// read the results saved by save_results()
+int load_baseline(const char* file, std::vector<benchmark_result>& baseline)
+{
+    FILE* fp = fopen(file, "r");
+    if (nullptr == fp)
+    {
+        fprintf(stderr, "Tengine Benchmark: Open baseline file %s failed.\n", file);
+        return -1;
+    }
+
+    char line[1024];
+    while (nullptr != fgets(line, sizeof(line), fp))
+    {
+        const char* name = strstr(line, "\"name\": \"");
+        if (nullptr == name)
+        {
+            continue;
+        }
+
+        name += strlen("\"name\": \"");
+        const char* name_end = strchr(name, '"');
+        if (nullptr == name_end)
+        {
+            continue;
+        }
+
+        benchmark_result r = {};
+        r.name.assign(name, name_end - name);
+        if (get_json_value(line, "p50", &r.p50) && get_json_value(line, "fps", &r.fps))
+        {
+            baseline.push_back(r);
+        }
+    }
+
+    fclose(fp);
 
     return 0;
 }
 
 
+// flag the models whose p50 latency or throughput is worse than the baseline by more than the threshold
+int compare_baseline(const char* file)
+{
+    std::vector<benchmark_result> baseline;
+    if (load_baseline(file, baseline) < 0)
+    {
+        return -1;
+    }
+
+    int regression = 0;
+
+    fprintf(stderr, "Compare with baseline %s, threshold %.1f%%:\n", file, benchmark_threshold);
+    for (const auto& r : benchmark_results)
+    {
+        auto base = std::find_if(baseline.begin(), baseline.end(), [&](const benchmark_result& b) { return b.name == r.name; });
+        if (base == baseline.end())
+        {
+            fprintf(stderr, "%20s  p50 = %7.2f ms   not in baseline\n", r.name.c_str(), r.p50);
+            continue;
+        }
+
+        float p50_change = base->p50 > 0.f ? (r.p50 - base->p50) / base->p50 * 100.f : 0.f;
+        float fps_change = base->fps > 0.f ? (r.fps - base->fps) / base->fps * 100.f : 0.f;
+        bool is_regression = p50_change > benchmark_threshold || fps_change < -benchmark_threshold;
+
+        fprintf(stderr, "%20s  p50 = %7.2f ms (%7.2f ms, %+6.1f%%)   fps = %8.2f (%8.2f, %+6.1f%%)   %s\n",
+                r.name.c_str(), r.p50, base->p50, p50_change, r.fps, base->fps, fps_change, is_regression ? "REGRESSION" : "ok");
+
+        if (is_regression)
+        {
+            regression++;
+        }
+    }
+
+    return regression;
+}
+
+
 int main(int argc, char* argv[])
 {
     cmdline::parser cmd;
@@ -170,6 +403,12 @@ int main(int argc, char* argv[])
     cmd.add<std::string>("model_file", 'm', "path to a model file", false);
     cmd.add<std::string>("input_shape", 'i', "shape of input (n,c,h,w)", false);
     cmd.add<int>("input_dtype", 'f', "data type of input", false);
+    cmd.add<int>("warmup_count", 'w', "warm up loops count", false, 1);
+    cmd.add<int>("instance_count", 'n', "graph instances run at the same time, for throughput", false, 1);
+    cmd.add<int>("precision", 'e', "precision of the run [0:fp32, 1:fp16, 5:bf16]", false, TENGINE_MODE_FP32);
+    cmd.add<std::string>("json_file", 'j', "save the results to a json file", false);
+    cmd.add<std::string>("baseline_file", 'b', "compare the results with a json file saved by -j", false);
+    cmd.add<float>("regression_threshold", 'x', "regression threshold of the baseline comparison, in percent", false, 10.f);
 
     cmd.parse_check(argc, argv);
 
@@ -182,6 +421,12 @@ int main(int argc, char* argv[])
     std::string benchmark_model_file = cmd.get<std::string>("model_file");
     std::string input_shape = cmd.get<std::string>("input_shape");
     benchmark_data_type = cmd.get<int>("input_dtype");
+    benchmark_warmup = cmd.get<int>("warmup_count");
+    benchmark_instances = std::max(cmd.get<int>("instance_count"), 1);
+    benchmark_precision = cmd.get<int>("precision");
+    benchmark_threshold = cmd.get<float>("regression_threshold");
+    std::string json_file = cmd.get<std::string>("json_file");
+    std::string baseline_file = cmd.get<std::string>("baseline_file");
     if (benchmark_device.empty())
     {
         benchmark_device = "CPU";
@@ -196,7 +441,9 @@ int main(int argc, char* argv[])
 
     fprintf(stdout, "Tengine benchmark:\n");
     fprintf(stdout, "  loops:    %d\n", benchmark_loop);
+    fprintf(stdout, "  warmup:   %d\n", benchmark_warmup);
     fprintf(stdout, "  threads:  %d\n", benchmark_threads);
+    fprintf(stdout, "  graphs:   %d\n", benchmark_instances);
     fprintf(stdout, "  cluster:  %d\n", benchmark_cluster);
     fprintf(stdout, "  affinity: 0x%X\n", benchmark_mask);
     fprintf(stdout, "  device:   %s\n", benchmark_device.c_str());
@@ -222,7 +469,7 @@ int main(int argc, char* argv[])
 
     struct options opt;
     opt.num_thread = benchmark_threads;
-    opt.precision = TENGINE_MODE_FP32;
+    opt.precision = benchmark_precision;
     opt.affinity = benchmark_mask;
 
     switch (benchmark_cluster)
@@ -319,10 +566,20 @@ int main(int argc, char* argv[])
             benchmark_graph(&opt, "mobilefacenets",   "./models/mobilefacenets_benchmark.tmfile",     112, 112, 3, 1);
     }
 
+    int regression = 0;
+    if (!json_file.empty())
+    {
+        save_results(json_file.c_str());
+    }
+    if (!baseline_file.empty())
+    {
+        regression = compare_baseline(baseline_file.c_str());
+    }
+
     /* release tengine */
     destroy_context(s_context);
     release_tengine();
     fprintf(stderr, "ALL TEST DONE.\n");
 
-    return 0;
+    return 0 == regression ? 0 : 1;
 }
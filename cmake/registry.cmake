@@ -1,4 +1,5 @@
 # generate needed registry
+# if _GEN_REG_NAME_FUNC is set, it is called with the file name after each register function
 FUNCTION (GENERATE_REGISTER_HEADER_FILE _REG_LEAD_STRING _DEL_LEAD_STRING _BACK_STRING _CONFIG_FILE _TARGET_FILE)
     SET (_BGN_NOTICE_STR "// code generation start\n")
     SET (_END_NOTICE_STR "// code generation finish\n")
@@ -21,6 +22,9 @@ FUNCTION (GENERATE_REGISTER_HEADER_FILE _REG_LEAD_STRING _DEL_LEAD_STRING _BACK_
         SET (_GEN_REG_CAL_STR "${_GEN_REG_CAL_STR}    {\n")
         SET (_GEN_REG_CAL_STR "${_GEN_REG_CAL_STR}        TLOG_ERR(\"Tengine FATAL: Call %s failed(%d).\\n\", \"${_REG_FUNC}\", ret);\n")
         SET (_GEN_REG_CAL_STR "${_GEN_REG_CAL_STR}    }\n")
+        IF (_GEN_REG_NAME_FUNC)
+            SET (_GEN_REG_CAL_STR "${_GEN_REG_CAL_STR}    ${_GEN_REG_NAME_FUNC}(\"${_NAME}\");\n")
+        ENDIF()
 
         SET (_GEN_DEL_DEF_STR "${_GEN_DEL_DEF_STR}extern int ${_DEL_FUNC};\n")
 
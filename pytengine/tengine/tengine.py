@@ -182,13 +182,15 @@ tg.options = options
 # define TENGINE_MODE_HYBRID_INT8 2
 # define TENGINE_MODE_UINT8 3
 # define TENGINE_MODE_INT8 4 // todo
+# define TENGINE_MODE_BF16 5
 (
     tg.TENGINE_MODE_FP32,
     tg.TENGINE_MODE_FP16,
     tg.TENGINE_MODE_HYBRID_INT8,
     tg.TENGINE_MODE_UINT8,
     tg.TENGINE_MODE_INT8,
-) = map(int, range(5))
+    tg.TENGINE_MODE_BF16,
+) = map(int, range(6))
 
 # /* layout type, not real layout */
 (tg.TENGINE_LAYOUT_NCHW, tg.TENGINE_LAYOUT_NHWC) = map(int, range(2))
@@ -0,0 +1,476 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "api/c_api.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+
+#include <string.h>
+
+#ifdef TENGINE_HAS_LIB_POSIX_THREAD
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+/*
+ * the queue coalesces the single samples run by several callers into one run of the graph.
+ * the samples are stacked along dims[0] of the graph inputs, the graph is reshaped to the
+ * batch taken when it differs from the last one, see reshape_exec_graph() of the cpu device.
+ */
+
+/* an input or output tensor of the graph, the shape of one sample has dims[0] of 1 */
+struct batch_port
+{
+    struct tensor* tensor;
+    int dim_num;
+    int dims[MAX_SHAPE_DIM_NUM];
+    int sample_size; //!< the bytes of one sample
+    void* buffer;    //!< the inputs of the batch, max_batch samples
+};
+
+/* a sample queued by a caller, it lives on the stack of the caller until it is done */
+struct batch_request
+{
+    const void** input_data;
+    void** output_data;
+    struct timespec arrive_time;
+    int done;
+    int result;
+    struct batch_request* next;
+};
+
+struct batch_queue
+{
+    struct graph* graph;
+    int max_batch;
+    int timeout_us;
+    int batch;           //!< the batch the graph is reshaped to
+    int input_num;
+    int output_num;
+    struct batch_port* input_list;
+    struct batch_port* output_list;
+
+    pthread_t worker;
+    pthread_mutex_t lock;
+    pthread_cond_t arrive_cond; //!< a request is queued, or the queue quits
+    pthread_cond_t done_cond;   //!< a batch is done
+    struct batch_request* head;
+    struct batch_request* tail;
+    int pending;                //!< the requests queued and not taken by the worker
+    int quit;
+};
+
+static int init_batch_port(struct batch_port* port, struct tensor* ir_tensor)
+{
+    if (ir_tensor->dim_num < 1 || ir_tensor->dims[0] < 1 || ir_tensor->elem_num <= 0)
+    {
+        TLOG_ERR("Tengine: Tensor %s of batch queue has no batch dim.\n", ir_tensor->name);
+        return -1;
+    }
+
+    port->tensor = ir_tensor;
+    port->dim_num = ir_tensor->dim_num;
+    port->sample_size = ir_tensor->elem_num / ir_tensor->dims[0] * ir_tensor->elem_size;
+    port->buffer = NULL;
+
+    for (int i = 0; i < ir_tensor->dim_num; i++)
+        port->dims[i] = ir_tensor->dims[i];
+
+    port->dims[0] = 1;
+
+    return 0;
+}
+
+static int init_batch_queue_ports(struct batch_queue* queue)
+{
+    struct graph* ir_graph = queue->graph;
+
+    queue->input_num = 0;
+    queue->output_num = 0;
+
+    for (int i = 0; i < ir_graph->input_num; i++)
+        queue->input_num += get_ir_graph_node(ir_graph, ir_graph->input_nodes[i])->output_num;
+
+    for (int i = 0; i < ir_graph->output_num; i++)
+        queue->output_num += get_ir_graph_node(ir_graph, ir_graph->output_nodes[i])->output_num;
+
+    queue->input_list = (struct batch_port*)sys_malloc(sizeof(struct batch_port) * queue->input_num);
+    queue->output_list = (struct batch_port*)sys_malloc(sizeof(struct batch_port) * queue->output_num);
+
+    if (NULL == queue->input_list || NULL == queue->output_list)
+        return -1;
+
+    memset(queue->input_list, 0, sizeof(struct batch_port) * queue->input_num);
+    memset(queue->output_list, 0, sizeof(struct batch_port) * queue->output_num);
+
+    int n = 0;
+
+    for (int i = 0; i < ir_graph->input_num; i++)
+    {
+        struct node* ir_node = get_ir_graph_node(ir_graph, ir_graph->input_nodes[i]);
+
+        for (int j = 0; j < ir_node->output_num; j++, n++)
+        {
+            struct batch_port* port = &queue->input_list[n];
+
+            if (init_batch_port(port, get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j])) < 0)
+                return -1;
+
+            port->buffer = sys_malloc((size_t)port->sample_size * queue->max_batch);
+
+            if (NULL == port->buffer)
+                return -1;
+        }
+    }
+
+    n = 0;
+
+    for (int i = 0; i < ir_graph->output_num; i++)
+    {
+        struct node* ir_node = get_ir_graph_node(ir_graph, ir_graph->output_nodes[i]);
+
+        for (int j = 0; j < ir_node->output_num; j++, n++)
+        {
+            if (init_batch_port(&queue->output_list[n], get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j])) < 0)
+                return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* reshape the inputs to the batch and bind them to the buffers of the queue */
+static int set_batch_queue_inputs(struct batch_queue* queue, int batch)
+{
+    for (int i = 0; i < queue->input_num; i++)
+    {
+        struct batch_port* port = &queue->input_list[i];
+        int dims[MAX_SHAPE_DIM_NUM];
+
+        memcpy(dims, port->dims, sizeof(int) * port->dim_num);
+        dims[0] = batch;
+
+        if (set_tensor_shape(port->tensor, dims, port->dim_num) < 0
+            || set_tensor_buffer(port->tensor, port->buffer, port->sample_size * batch) < 0)
+        {
+            TLOG_ERR("Tengine: Reshape input %s of batch queue to batch %d failed.\n", port->tensor->name, batch);
+            return -1;
+        }
+    }
+
+    queue->batch = batch;
+
+    return 0;
+}
+
+static int run_batch(struct batch_queue* queue, struct batch_request* list, int batch)
+{
+    if (batch != queue->batch && set_batch_queue_inputs(queue, batch) < 0)
+        return -1;
+
+    for (int i = 0; i < queue->input_num; i++)
+    {
+        struct batch_port* port = &queue->input_list[i];
+        struct batch_request* request = list;
+
+        for (int k = 0; k < batch; k++, request = request->next)
+            memcpy((char*)port->buffer + (size_t)port->sample_size * k, request->input_data[i], port->sample_size);
+    }
+
+    if (run_graph(queue->graph, 1) < 0)
+    {
+        TLOG_ERR("Tengine: Run graph of batch queue with batch %d failed.\n", batch);
+        return -1;
+    }
+
+    for (int i = 0; i < queue->output_num; i++)
+    {
+        struct batch_port* port = &queue->output_list[i];
+        struct tensor* ir_tensor = port->tensor;
+
+        if (NULL == ir_tensor->data || ir_tensor->dims[0] != batch
+            || ir_tensor->elem_num * ir_tensor->elem_size != port->sample_size * batch)
+        {
+            TLOG_ERR("Tengine: Output %s of batch queue does not follow batch %d.\n", ir_tensor->name, batch);
+            return -1;
+        }
+
+        struct batch_request* request = list;
+
+        for (int k = 0; k < batch; k++, request = request->next)
+            memcpy(request->output_data[i], (char*)ir_tensor->data + (size_t)port->sample_size * k, port->sample_size);
+    }
+
+    return 0;
+}
+
+/* the time the batch of the first request is run at the latest */
+static struct timespec get_batch_deadline(const struct batch_queue* queue, const struct batch_request* request)
+{
+    struct timespec deadline = request->arrive_time;
+    long nsec = deadline.tv_nsec + (long)(queue->timeout_us % 1000000) * 1000;
+
+    deadline.tv_sec += queue->timeout_us / 1000000 + nsec / 1000000000;
+    deadline.tv_nsec = nsec % 1000000000;
+
+    return deadline;
+}
+
+static void* batch_queue_worker(void* arg)
+{
+    struct batch_queue* queue = (struct batch_queue*)arg;
+
+    pthread_mutex_lock(&queue->lock);
+
+    while (1)
+    {
+        while (NULL == queue->head && !queue->quit)
+            pthread_cond_wait(&queue->arrive_cond, &queue->lock);
+
+        if (NULL == queue->head)
+            break;
+
+        /* wait the batch to fill, the requests queued run at once when the queue quits */
+        if (queue->timeout_us > 0)
+        {
+            struct timespec deadline = get_batch_deadline(queue, queue->head);
+
+            while (queue->pending < queue->max_batch && !queue->quit)
+            {
+                if (ETIMEDOUT == pthread_cond_timedwait(&queue->arrive_cond, &queue->lock, &deadline))
+                    break;
+            }
+        }
+
+        int batch = queue->pending < queue->max_batch ? queue->pending : queue->max_batch;
+        struct batch_request* list = queue->head;
+        struct batch_request* last = list;
+
+        for (int k = 1; k < batch; k++)
+            last = last->next;
+
+        queue->head = last->next;
+        if (NULL == queue->head)
+            queue->tail = NULL;
+        queue->pending -= batch;
+
+        pthread_mutex_unlock(&queue->lock);
+
+        int ret = run_batch(queue, list, batch);
+
+        pthread_mutex_lock(&queue->lock);
+
+        struct batch_request* request = list;
+
+        for (int k = 0; k < batch; k++)
+        {
+            struct batch_request* next = request->next;
+
+            request->result = ret;
+            request->done = 1;
+            request = next;
+        }
+
+        pthread_cond_broadcast(&queue->done_cond);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return NULL;
+}
+
+static void free_batch_queue(struct batch_queue* queue)
+{
+    for (int i = 0; NULL != queue->input_list && i < queue->input_num; i++)
+    {
+        if (NULL != queue->input_list[i].buffer)
+            sys_free(queue->input_list[i].buffer);
+    }
+
+    if (NULL != queue->input_list)
+        sys_free(queue->input_list);
+    if (NULL != queue->output_list)
+        sys_free(queue->output_list);
+
+    sys_free(queue);
+}
+
+batch_queue_t create_batch_queue(graph_t graph, int max_batch, int timeout_us)
+{
+    struct graph* ir_graph = (struct graph*)graph;
+
+    if (NULL == ir_graph || max_batch < 1 || timeout_us < 0)
+    {
+        TLOG_ERR("Tengine: Create batch queue with max batch %d, timeout %d us failed.\n", max_batch, timeout_us);
+        return NULL;
+    }
+
+    if (GRAPH_STAT_READY != ir_graph->status && GRAPH_STAT_DONE != ir_graph->status)
+    {
+        TLOG_ERR("Tengine: Graph of batch queue must be prerun, status is %d.\n", ir_graph->status);
+        return NULL;
+    }
+
+    struct batch_queue* queue = (struct batch_queue*)sys_malloc(sizeof(struct batch_queue));
+
+    if (NULL == queue)
+        return NULL;
+
+    memset(queue, 0, sizeof(struct batch_queue));
+    queue->graph = ir_graph;
+    queue->max_batch = max_batch;
+    queue->timeout_us = timeout_us;
+
+    if (init_batch_queue_ports(queue) < 0)
+    {
+        TLOG_ERR("Tengine: Create batch queue with max batch %d failed.\n", max_batch);
+        free_batch_queue(queue);
+        return NULL;
+    }
+
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->arrive_cond, NULL);
+    pthread_cond_init(&queue->done_cond, NULL);
+
+    if (0 != pthread_create(&queue->worker, NULL, batch_queue_worker, queue))
+    {
+        TLOG_ERR("Tengine: Create worker of batch queue failed.\n");
+        pthread_cond_destroy(&queue->done_cond);
+        pthread_cond_destroy(&queue->arrive_cond);
+        pthread_mutex_destroy(&queue->lock);
+        free_batch_queue(queue);
+        return NULL;
+    }
+
+    return queue;
+}
+
+int run_batch_queue(batch_queue_t batch_queue, const void* input_data[], int input_number, void* output_data[],
+                    int output_number)
+{
+    struct batch_queue* queue = (struct batch_queue*)batch_queue;
+
+    if (NULL == queue || input_number != queue->input_num || output_number != queue->output_num)
+    {
+        TLOG_ERR("Tengine: Batch queue takes %d inputs and %d outputs, not %d and %d.\n",
+                 NULL != queue ? queue->input_num : 0, NULL != queue ? queue->output_num : 0, input_number,
+                 output_number);
+        return -1;
+    }
+
+    struct batch_request request;
+
+    request.input_data = input_data;
+    request.output_data = output_data;
+    request.done = 0;
+    request.result = -1;
+    request.next = NULL;
+    clock_gettime(CLOCK_REALTIME, &request.arrive_time);
+
+    pthread_mutex_lock(&queue->lock);
+
+    if (queue->quit)
+    {
+        pthread_mutex_unlock(&queue->lock);
+        TLOG_ERR("Tengine: Batch queue is destroyed.\n");
+        return -1;
+    }
+
+    if (NULL == queue->tail)
+        queue->head = &request;
+    else
+        queue->tail->next = &request;
+
+    queue->tail = &request;
+    queue->pending++;
+
+    pthread_cond_signal(&queue->arrive_cond);
+
+    while (!request.done)
+        pthread_cond_wait(&queue->done_cond, &queue->lock);
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return request.result;
+}
+
+int destroy_batch_queue(batch_queue_t batch_queue)
+{
+    struct batch_queue* queue = (struct batch_queue*)batch_queue;
+
+    if (NULL == queue)
+        return -1;
+
+    /* the worker runs the requests queued before it exits */
+    pthread_mutex_lock(&queue->lock);
+    queue->quit = 1;
+    pthread_cond_broadcast(&queue->arrive_cond);
+    pthread_mutex_unlock(&queue->lock);
+
+    pthread_join(queue->worker, NULL);
+
+    pthread_cond_destroy(&queue->done_cond);
+    pthread_cond_destroy(&queue->arrive_cond);
+    pthread_mutex_destroy(&queue->lock);
+
+    /* the inputs are left unbound, back in the shape of one sample */
+    for (int i = 0; i < queue->input_num; i++)
+    {
+        struct batch_port* port = &queue->input_list[i];
+
+        if (port->tensor->data == port->buffer)
+        {
+            port->tensor->data = NULL;
+            set_tensor_shape(port->tensor, port->dims, port->dim_num);
+        }
+    }
+
+    free_batch_queue(queue);
+
+    return 0;
+}
+
+#else
+
+batch_queue_t create_batch_queue(graph_t graph, int max_batch, int timeout_us)
+{
+    TLOG_ERR("Tengine: Batch queue needs posix thread.\n");
+    return NULL;
+}
+
+int run_batch_queue(batch_queue_t batch_queue, const void* input_data[], int input_number, void* output_data[],
+                    int output_number)
+{
+    return -1;
+}
+
+int destroy_batch_queue(batch_queue_t batch_queue)
+{
+    return -1;
+}
+
+#endif
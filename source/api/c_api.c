@@ -38,8 +38,10 @@
 #include "serializer/register.h"
 #include "device/device.h"
 #include "executer/executer.h"
+#include "executer/profile.h"
 #include "scheduler/scheduler.h"
 #include "system/cpu.h"
+#include "system/thread_pool.h"
 #include "module/module.h"
 #include "utility/sys_port.h"
 #include "utility/vector.h"
@@ -344,6 +346,8 @@ void release_tengine(void)
         TLOG_ERR("Tengine: Release serializer registry failed: %d\n", ret);
     }
 
+    release_thread_pool();
+
     ret = unregister_all_devices();
     if (0 != ret)
     {
@@ -473,25 +477,32 @@ int prerun_graph_multithread(graph_t graph, struct options option)
         dev = find_default_device();
     }
 
+    int precision = TENGINE_MODE_FP32;
+    if (0 <= option.precision && (TENGINE_MODE_FP32 == option.precision || TENGINE_MODE_FP16 == option.precision || TENGINE_MODE_HYBRID_INT8 == option.precision || TENGINE_MODE_UINT8 == option.precision || TENGINE_MODE_INT8 == option.precision || TENGINE_MODE_BF16 == option.precision))
+    {
+        precision = option.precision;
+    }
+
     if (NULL != dev && NULL != dev->optimizer)
     {
-        if (NULL != dev->optimizer->split_graph)
+        /* the graph is optimized before the split, the subgraphs see the fused nodes */
+        if (NULL != dev->optimizer->optimize_graph)
         {
-            if (0 != dev->optimizer->split_graph(ir_graph))
+            ret = dev->optimizer->optimize_graph(ir_graph, precision);
+            if (0 != ret)
             {
                 ir_graph->status = GRAPH_STAT_ERROR;
-                fprintf(stderr, "Tengine: Split graph via device(%s) failed.\n", dev->name);
+                fprintf(stderr, "Tengine: Optimize graph via device(%s) failed.\n", dev->name);
                 return -1;
             }
         }
 
-        if (NULL != dev->optimizer->optimize_graph)
+        if (NULL != dev->optimizer->split_graph)
         {
-            ret = dev->optimizer->optimize_graph(ir_graph, -1);
-            if (0 != ret)
+            if (0 != dev->optimizer->split_graph(ir_graph))
             {
                 ir_graph->status = GRAPH_STAT_ERROR;
-                fprintf(stderr, "Tengine: Optimize graph via device(%s) failed.\n", dev->name);
+                fprintf(stderr, "Tengine: Split graph via device(%s) failed.\n", dev->name);
                 return -1;
             }
         }
@@ -499,11 +510,9 @@ int prerun_graph_multithread(graph_t graph, struct options option)
 
     check_cpu();
 
-    size_t mask = get_cpu_cluster_mask(TENGINE_CLUSTER_BIG);
-    if (0 <= option.cluster)
-    {
-        mask = get_cpu_cluster_mask(option.cluster);
-    }
+    /* the cluster the threads are counted on is the one the kernels run on */
+    int cluster = 0 <= option.cluster ? option.cluster : TENGINE_CLUSTER_BIG;
+    size_t mask = get_cpu_cluster_mask(cluster);
 
     int count = get_cpu_mask_count(mask);
     if (0 < option.num_thread && count > option.num_thread)
@@ -511,18 +520,12 @@ int prerun_graph_multithread(graph_t graph, struct options option)
         count = option.num_thread;
     }
 
-    int precision = TENGINE_MODE_FP32;
-    if (0 <= option.precision && (TENGINE_MODE_FP32 == option.precision || TENGINE_MODE_FP16 == option.precision || TENGINE_MODE_HYBRID_INT8 == option.precision || TENGINE_MODE_UINT8 == option.precision || TENGINE_MODE_INT8 == option.precision))
-    {
-        precision = option.precision;
-    }
-
     ctx->default_options = sys_malloc(sizeof(struct cpu_option));
 
     struct cpu_option* opt = (struct cpu_option*)ctx->default_options;
     opt->dev_name = CPU_DEVICE_NAME;
     opt->num_thread = count;
-    opt->cluster = TENGINE_CLUSTER_BIG;
+    opt->cluster = cluster;
     opt->precision = precision;
     opt->affinity = option.affinity;
 
@@ -563,18 +566,11 @@ int run_graph(graph_t graph, int block)
     struct context* context = get_ir_graph_context(ir_graph);
     struct scheduler* scheduler = context->scheduler;
 
-    ir_graph->status = GRAPH_STAT_RUNNING;
-
+    /* the scheduler sets the status, a non-blocking run sets it from its worker */
     if (scheduler->run(scheduler, ir_graph, block) < 0)
     {
-        ir_graph->status = GRAPH_STAT_ERROR;
         return -1;
     }
-    else
-    {
-        if (block)
-            ir_graph->status = GRAPH_STAT_READY;
-    }
 
     return 0;
 }
@@ -585,22 +581,12 @@ int wait_graph(graph_t graph, int try_wait)
     struct context* context = get_ir_graph_context(ir_graph);
     struct scheduler* scheduler = context->scheduler;
 
-    if (GRAPH_STAT_RUNNING != ir_graph->status || GRAPH_STAT_READY != ir_graph->status)
-    {
-        return -1;
-    }
-
-    if (ir_graph->status == GRAPH_STAT_READY)
-    {
-        return 0;
-    }
-
-    if (!try_wait)
+    if (GRAPH_STAT_RUNNING != ir_graph->status && GRAPH_STAT_READY != ir_graph->status)
     {
         return -1;
     }
 
-    return scheduler->wait(scheduler, ir_graph);
+    return scheduler->wait(scheduler, ir_graph, try_wait);
 }
 
 int postrun_graph(graph_t graph)
@@ -625,6 +611,95 @@ int postrun_graph(graph_t graph)
     return 0;
 }
 
+int enable_graph_profile(graph_t graph, int record_number)
+{
+    struct graph* ir_graph = (struct graph*)graph;
+
+    if (record_number < 0)
+    {
+        TLOG_ERR("Tengine: Profile record number(%d) is invalid.\n", record_number);
+        return -1;
+    }
+
+    destroy_profile(ir_graph->profile);
+    ir_graph->profile = NULL;
+
+    if (0 == record_number)
+    {
+        return 0;
+    }
+
+    ir_graph->profile = create_profile(record_number);
+
+    if (NULL == ir_graph->profile)
+    {
+        TLOG_ERR("Tengine: Create profile of %d records failed.\n", record_number);
+        return -1;
+    }
+
+    return 0;
+}
+
+int reset_graph_profile(graph_t graph)
+{
+    struct graph* ir_graph = (struct graph*)graph;
+
+    if (NULL == ir_graph->profile)
+    {
+        return -1;
+    }
+
+    reset_profile(ir_graph->profile);
+
+    return 0;
+}
+
+int get_graph_profile_record_number(graph_t graph)
+{
+    struct graph* ir_graph = (struct graph*)graph;
+
+    if (NULL == ir_graph->profile)
+    {
+        return -1;
+    }
+
+    return get_profile_record_number(ir_graph->profile);
+}
+
+int get_graph_profile_record(graph_t graph, int idx, profile_record_t* record)
+{
+    struct graph* ir_graph = (struct graph*)graph;
+
+    if (NULL == ir_graph->profile || NULL == record)
+    {
+        return -1;
+    }
+
+    const profile_record_t* profile_record = get_profile_record(ir_graph->profile, idx);
+
+    if (NULL == profile_record)
+    {
+        return -1;
+    }
+
+    memcpy(record, profile_record, sizeof(profile_record_t));
+
+    return 0;
+}
+
+int export_graph_profile(graph_t graph, int format, char* buf, int size)
+{
+    struct graph* ir_graph = (struct graph*)graph;
+
+    if (NULL == ir_graph->profile)
+    {
+        TLOG_ERR("Tengine: Profile of the graph is not enabled.\n");
+        return -1;
+    }
+
+    return export_profile(ir_graph->profile, format, buf, size);
+}
+
 int set_graph_layout(graph_t graph, int layout_type)
 {
     struct graph* ir_graph = (struct graph*)graph;
@@ -659,14 +734,72 @@ int set_graph_thread_mask(graph_t graph, size_t cpu_mask)
     return -1;
 }
 
+graph_t clone_graph(graph_t graph)
+{
+    struct graph* ir_graph = (struct graph*)graph;
+
+    /* the clone is copied from the optimized graph */
+    if (GRAPH_STAT_READY != ir_graph->status && GRAPH_STAT_RUNNING != ir_graph->status && GRAPH_STAT_DONE != ir_graph->status)
+    {
+        TLOG_ERR("Tengine: Graph to clone should be prerun first.\n");
+        return NULL;
+    }
+
+    /* a private context keeps the options of each instance prerun */
+    struct context* context = ir_graph->attribute->context;
+    int is_new_context = ir_graph->attribute->private_context;
+
+    if (is_new_context)
+    {
+        context = (struct context*)create_context(NULL, 1);
+        context->device = ir_graph->attribute->context->device;
+    }
+
+    ir_graph_t* clone = clone_ir_graph(ir_graph, context);
+
+    if (NULL == clone)
+    {
+        if (is_new_context)
+            destroy_context(context);
+
+        return NULL;
+    }
+
+    clone->attribute->private_context = is_new_context;
+
+    return clone;
+}
+
 int destroy_graph(graph_t graph)
 {
     struct graph* ir_graph = (struct graph*)graph;
+    struct graph* origin = ir_graph;
+    struct scheduler* scheduler = get_ir_graph_context(ir_graph)->scheduler;
+
+    /* join the worker of a non-blocking run, even if the graph was not postrun */
+    if (NULL != scheduler->release)
+    {
+        scheduler->release(scheduler, ir_graph);
+    }
+
+    if (NULL != ir_graph->origin)
+    {
+        origin = ir_graph->origin;
+
+        if (ir_graph->attribute->private_context)
+            destroy_context(ir_graph->attribute->context);
+
+        destroy_ir_graph(ir_graph);
+    }
+
+    /* the origin is kept for its clones, which share its consts and context */
+    if (0 < release_ir_graph_instance(origin))
+        return 0;
 
-    if (ir_graph->attribute->private_context)
-        destroy_context(ir_graph->attribute->context);
+    if (origin->attribute->private_context)
+        destroy_context(origin->attribute->context);
 
-    destroy_ir_graph(ir_graph);
+    destroy_ir_graph(origin);
 
     return 0;
 }
@@ -84,6 +84,7 @@ extern "C" {
 #define TENGINE_MODE_HYBRID_INT8 2
 #define TENGINE_MODE_UINT8       3
 #define TENGINE_MODE_INT8        4
+#define TENGINE_MODE_BF16        5
 
 /* node dump action definition */
 #define NODE_DUMP_ACTION_DISABLE 0
@@ -100,6 +101,10 @@ extern "C" {
 #define GRAPH_PERF_STAT_RESET   4
 #define GRAPH_PERF_STAT_GET     5
 
+/* the formats of the graph profile export */
+#define GRAPH_PROFILE_CHROME_TRACE 0
+#define GRAPH_PROFILE_SUMMARY      1
+
 /* follow the std. UNIX log level definition */
 enum log_level
 {
@@ -144,6 +149,7 @@ typedef void* context_t;
 typedef void* graph_t;
 typedef void* tensor_t;
 typedef void* node_t;
+typedef void* batch_queue_t;
 
 typedef int (*event_handler_t)(graph_t, int, void* arg);
 
@@ -158,6 +164,22 @@ typedef struct options
     uint64_t affinity;
 } options_t;
 
+/* a run of a node recorded by the graph profile, see enable_graph_profile() */
+typedef struct profile_record
+{
+    int node_idx;          /* the index of the node in the graph */
+    const char* node_name; /* the strings are valid until the graph is destroyed */
+    const char* op_name;
+    const char* device;  /* the device running the node */
+    const char* kernel;  /* the kernel implementation the device chose for the node */
+    int run_idx;         /* the run of the graph, counted from 0 since the profile was enabled or reset */
+    int thread_id;       /* 0 for the thread running the graph, 1 ~ n for the threads of the pool */
+    double start_time;   /* ms since the profile was enabled or reset */
+    double end_time;     /* ms since the profile was enabled or reset */
+    double flops;        /* the estimated float operations of the node */
+    double bytes;        /* the bytes of the input and output tensors of the node */
+} profile_record_t;
+
 struct custom_kernel_tensor
 {
     int dim[MAX_SHAPE_DIM_NUM]; /* the shape dim array */
@@ -396,6 +418,21 @@ DLLEXPORT int set_graph_input_node(graph_t graph, const char* input_nodes[], int
 
 DLLEXPORT int set_graph_output_node(graph_t graph, const char* output_nodes[], int output_number);
 
+/*!
+ * @brief Clone a prerun graph into another execution instance of it.
+ *        The clone shares the const tensors of the graph read only, and the weights
+ *        packed by the kernels of the cpu device while any instance is prerun. It owns
+ *        a copy of the op params, its other tensors and its execution state, and should be prerun
+ *        and postrun itself. Each instance may run in a thread of its own.
+ *
+ * @param [in] graph: The graph handle, or the handle of a clone.
+ * @return  The handle of the clone or NULL if failed.
+ *
+ * @note  the graph is released after all of its clones are destroyed, and should not
+ *        be reshaped while it is being cloned.
+ */
+DLLEXPORT graph_t clone_graph(graph_t graph);
+
 /*!
  * @brief Destroy the runtime graph and release allocated resource.
  *
@@ -1033,6 +1070,7 @@ DLLEXPORT int run_graph(graph_t graph, int block);
  * @param [in] try_wait: If set, just check status and return.
  * @return  1: Graph is done.
  *          0: Try again.
+ *         -1: Fail, the graph is not running or the run failed.
  *
  */
 DLLEXPORT int wait_graph(graph_t graph, int try_wait);
@@ -1066,6 +1104,105 @@ DLLEXPORT DEPRECATED_BEFORE int get_graph_exec_status(graph_t graph) DEPRECATED_
  */
 DLLEXPORT DEPRECATED_BEFORE int set_graph_event_hook(graph_t graph, int event, event_handler_t cb_func, void* cb_arg) DEPRECATED_AFTER;
 
+/***************** Batch queue *****************************/
+
+/*!
+ * @brief Create a queue coalescing the samples run by several threads into batched runs of a graph.
+ *        The graph runs once the max batch of samples are queued, or timeout_us after the first
+ *        of them is queued, and is reshaped to the count of the samples taken along dims[0].
+ *
+ * @param [in] graph: The graph handle, it must be prerun, the queue owns it and runs it until destroyed.
+ * @param [in] max_batch: The max count of the samples run at once.
+ * @param [in] timeout_us: The max time a sample waits for the batch to fill, 0 to run the queued samples at once.
+ *
+ * @return The queue handle, NULL for failure.
+ * @note  The inputs of the graph are bound to the buffers of the queue, bind them again after it is destroyed.
+ */
+DLLEXPORT batch_queue_t create_batch_queue(graph_t graph, int max_batch, int timeout_us);
+
+/*!
+ * @brief Run one sample by the queue, wait until the batch of it is done.
+ *
+ * @param [in]  queue: The queue handle.
+ * @param [in]  input_data: The data of one sample of each tensor of the graph input nodes, in their order.
+ * @param [in]  input_number: The count of the graph input tensors.
+ * @param [out] output_data: The buffer of one sample of each tensor of the graph output nodes, in their order.
+ * @param [in]  output_number: The count of the graph output tensors.
+ *
+ * @return 0: Success, -1: Fail.
+ * @note  The size of a sample is the one of the tensor with dims[0] of 1.
+ */
+DLLEXPORT int run_batch_queue(batch_queue_t queue, const void* input_data[], int input_number, void* output_data[],
+                              int output_number);
+
+/*!
+ * @brief Destroy the queue, the samples queued are run first.
+ *
+ * @param [in] queue: The queue handle.
+ *
+ * @return 0: Success, -1: Fail.
+ */
+DLLEXPORT int destroy_batch_queue(batch_queue_t queue);
+
+/***************** Graph profiling *****************************/
+
+/*!
+ * @brief Enable or disable the profile of a graph, which records each run of its nodes.
+ *        The records are kept in a ring, the oldest ones are dropped once it is full.
+ *        Enabling it again drops the records. Call it while the graph is not running.
+ *
+ * @param [in] graph: The graph handle.
+ * @param [in] record_number: The max count of the records kept, 0 to disable the profile.
+ *
+ * @return 0: Success, -1: Fail.
+ *
+ * @note  Only the nodes run by the cpu device are recorded.
+ */
+DLLEXPORT int enable_graph_profile(graph_t graph, int record_number);
+
+/*!
+ * @brief Drop the records and the run count of the graph profile, the times restart from 0.
+ *
+ * @param [in] graph: The graph handle.
+ *
+ * @return 0: Success, -1: Fail, the profile is not enabled.
+ */
+DLLEXPORT int reset_graph_profile(graph_t graph);
+
+/*!
+ * @brief Get the count of the records kept by the graph profile.
+ *
+ * @param [in] graph: The graph handle.
+ *
+ * @return The record count, -1 for the profile not enabled.
+ */
+DLLEXPORT int get_graph_profile_record_number(graph_t graph);
+
+/*!
+ * @brief Get a record of the graph profile, the records are in the order they were taken.
+ *
+ * @param [in]  graph: The graph handle.
+ * @param [in]  idx: The index of the record, from 0 to get_graph_profile_record_number() - 1.
+ * @param [out] record: The record.
+ *
+ * @return 0: Success, -1: Fail.
+ */
+DLLEXPORT int get_graph_profile_record(graph_t graph, int idx, profile_record_t* record);
+
+/*!
+ * @brief Export the graph profile as json, like snprintf().
+ *        GRAPH_PROFILE_CHROME_TRACE: the records as the events of chrome://tracing or perfetto.
+ *        GRAPH_PROFILE_SUMMARY: the count, total, avg, min and max time, flops and bytes of each node.
+ *
+ * @param [in]  graph: The graph handle.
+ * @param [in]  format: GRAPH_PROFILE_CHROME_TRACE or GRAPH_PROFILE_SUMMARY.
+ * @param [out] buf: The buffer of the json, it is ended by '\0' if size > 0.
+ * @param [in]  size: The size of the buffer, 0 to get the length only.
+ *
+ * @return The length of the whole json, without the ending '\0', -1 for failure.
+ */
+DLLEXPORT int export_graph_profile(graph_t graph, int format, char* buf, int size);
+
 /***************** Device related *****************************/
 
 /*!
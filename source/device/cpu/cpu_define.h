@@ -33,7 +33,6 @@
 #define OPS_SCORE_NOTSUP 2000
 
 #define MEM_POOL_ALLOCATED 8
-#define INPLACE_BLOCK_FLAG 0x40
 
 #define CPU_DEVICE_NAME "CPU"
 
@@ -42,6 +41,13 @@
 #define TENGINE_DUMP_GRAPH       "TG_DEBUG_GRAPH"
 #define TENGINE_PRINT_LAYER_COST "TG_DEBUG_TIME"
 #define TENGINE_FORCE_USE_REF_OP "TG_DEBUG_REF"
+#define TENGINE_DISABLE_FUSION   "TG_NO_FUSION"
+#define TENGINE_DISABLE_NCHWC    "TG_NO_NCHWC"
+
+#define TENGINE_INTER_OP_PARALLEL "TG_INTER_OP"
+
+/* the directory of the files caching the weights packed in prerun, see cpu_prepack.h */
+#define TENGINE_PREPACK_CACHE "TG_PREPACK_CACHE"
 
 typedef struct cpu_option
 {
@@ -30,6 +30,7 @@
 #include "cpu_graph.h"
 #include "cpu_pool.h"
 #include "cpu_dump.h"
+#include "cpu_prepack.h"
 
 #include "device/cpu/cpu_ops.h"
 
@@ -38,8 +39,12 @@
 #include "graph/graph.h"
 #include "graph/subgraph.h"
 #include "optimizer/split.h"
+#include "optimizer/fusion.h"
+#include "executer/profile.h"
 #include "module/module.h"
 #include "serializer/serializer.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
 #include "utility/vector.h"
 #include "utility/sys_port.h"
 #include "utility/utils.h"
@@ -50,12 +55,14 @@
 int init_cpu(struct device* device)
 {
     (void)device;
+    init_prepack_share();
     return register_all_cpu_ops();
 }
 
 int release_cpu(struct device* device)
 {
     (void)device;
+    release_prepack_share();
     return unregister_all_cpu_ops();
 }
 
@@ -70,7 +77,20 @@ static int prerun(struct device* dev, struct subgraph* subgraph, void* option)
     if (exec_graph == NULL)
         return -1;
 
-    if (alloc_exec_graph_mem(exec_graph) < 0 || prerun_exec_graph(exec_graph) < 0)
+    /* the cores of the cluster, narrowed by the affinity if they overlap */
+    exec_graph->cpu_mask = get_cpu_cluster_mask(opt->cluster);
+    if (0 != (opt->affinity & exec_graph->cpu_mask))
+        exec_graph->cpu_mask &= opt->affinity;
+
+    const char* inter_op = getenv(TENGINE_INTER_OP_PARALLEL);
+    if (inter_op && inter_op[0] == '1' && split_exec_graph_wave(exec_graph) < 0)
+    {
+        release_exec_graph(exec_graph);
+        return -1;
+    }
+
+    if (alloc_exec_graph_mem(exec_graph) < 0 || open_prepack_cache(exec_graph) < 0 || prerun_exec_graph(exec_graph) < 0
+        || close_prepack_cache(exec_graph) < 0)
     {
         release_exec_graph(exec_graph);
         return -1;
@@ -94,132 +114,248 @@ static int prerun(struct device* dev, struct subgraph* subgraph, void* option)
     return 0;
 }
 
-static int run(struct device* dev, struct subgraph* subgraph)
+static int run_exec_node(struct device* dev, struct exec_graph* exec_graph, struct exec_node* node, int i, int node_num, double* cost)
 {
-    struct exec_graph* exec_graph = (struct exec_graph*)subgraph->device_graph;
+    struct node_ops* node_ops = node->node_ops;
 
-    int node_num = get_vector_num(exec_graph->exec_node_list);
+    /* the other nodes are reshaped only when the input shapes change, see reshape_exec_graph() */
+    if (node->ir_node->dynamic_shape && node_ops->reshape && node_ops->reshape(node_ops, node, exec_graph) < 0)
+    {
+        TLOG_ERR("%s: failed to reshape node %d, %s\n", dev->name, node->ir_node->index, node->ir_node->name);
+        return -1;
+    }
 
+    /* TODO: add dynamic skip feature */
+#ifdef DEBUG_TIME
+    double start = get_current_time();
+#endif
+    double st_time, end_time;
     if (exec_graph->timer)
     {
-        double* timer = (double*)exec_graph->timer;
-        timer[node_num] += 1.0; // repeat
+        st_time = get_current_time();
     }
-
-    for (int i = 0; i < node_num; i++)
+    struct profile* profile = node->ir_node->graph->profile;
+    double profile_start = NULL != profile ? get_profile_time(profile) : 0.;
+    if (node_ops->run(node_ops, node, exec_graph) < 0)
     {
-        struct exec_node* node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
-        struct node_ops* node_ops = node->node_ops;
-
-        /* TODO: handle the shape changed  and dynamic shape case */
-        if (node_ops->reshape && node_ops->reshape(node_ops, node, exec_graph) < 0)
-        {
-            TLOG_ERR("%s: failed to reshape node %d, %s\n", dev->name, node->ir_node->index, node->ir_node->name);
-            return -1;
-        }
-
-        /* TODO: add dynamic skip feature */
+        TLOG_ERR("%s: failed to run node %d, %s\n", dev->name, node->ir_node->index, node->ir_node->name);
+        return -1;
+    }
+    if (NULL != profile)
+    {
+        record_profile_node(profile, node->ir_node, dev->name, node_ops->name, profile_start, get_profile_time(profile));
+    }
+    char* name = node->ir_node->name;
 #ifdef DEBUG_TIME
-        double start = get_current_time();
+    double end = get_current_time();
+    fprintf(stderr, "%-20s  %8.2f ms  %s\n", get_op_name_from_type(node->ir_node->op.type), end - start, name);
 #endif
-        double st_time, end_time;
-        if (exec_graph->timer)
+    if (exec_graph->timer)
+    {
+        end_time = get_current_time();
+        double* timer = (double*)exec_graph->timer;
+        double cur_time = end_time - st_time;
+
+        // save min time
+        if (timer[node_num] < 2.0)
         {
-            st_time = get_current_time();
+            timer[i] = cur_time;
         }
-        if (node_ops->run(node_ops, node, exec_graph) < 0)
+        else
         {
-            TLOG_ERR("%s: failed to run node %d, %s\n", dev->name, node->ir_node->index, node->ir_node->name);
-            return -1;
+            timer[i] = cur_time < timer[i] ? cur_time : timer[i];
         }
-        char* name = node->ir_node->name;
-#ifdef DEBUG_TIME
-        double end = get_current_time();
-        fprintf(stderr, "%-20s  %8.2f ms  %s\n", get_op_name_from_type(node->ir_node->op.type), end - start, name);
-#endif
-        if (exec_graph->timer)
+        *cost += cur_time;
+    }
+#ifdef DEBUG_DATA
+    struct graph* ir_graph = node->ir_node->graph;
+
+    for (uint8_t j = 0; j < node->ir_node->input_num; j++)
+    {
+        struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, node->ir_node->input_tensors[j]);
+        if (input_tensor->dim_num <= 5)
         {
-            end_time = get_current_time();
-            double* timer = (double*)exec_graph->timer;
-            double cur_time = end_time - st_time;
+            char dir_str[32] = {0};
+            sprintf(dir_str, "in[%d]", j);
 
-            // save min time
-            if (timer[node_num] < 2.0)
+            if (NULL != input_tensor->data)
             {
-                timer[i] = cur_time;
+                extract_feature_from_tensor(dir_str, name, input_tensor);
             }
-            else
-            {
-                timer[i] = cur_time < timer[i] ? cur_time : timer[i];
-            }
-            timer[node_num + 1] += cur_time; // sum
         }
-#ifdef DEBUG_DATA
-        struct graph* ir_graph = node->ir_node->graph;
+    }
 
-        for (uint8_t j = 0; j < node->ir_node->input_num; j++)
+    for (uint8_t j = 0; j < node->ir_node->output_num; j++)
+    {
+        struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, node->ir_node->output_tensors[j]);
+        /* debug */
+        if (output_tensor->dim_num <= 5)
         {
-            struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, node->ir_node->input_tensors[j]);
-            if (input_tensor->dim_num <= 5)
-            {
-                char dir_str[32] = {0};
-                sprintf(dir_str, "in[%d]", j);
+            char dir_str[32] = {0};
+            sprintf(dir_str, "out[%d]", j);
 
-                if (NULL != input_tensor->data)
-                {
-                    extract_feature_from_tensor(dir_str, name, input_tensor);
-                }
-            }
+            extract_feature_from_tensor(dir_str, name, output_tensor);
         }
+    }
+#endif
+    const char* env = getenv(TENGINE_DUMP_LAYER);
+    if (env && env[0] == '1')
+    {
+        struct graph* ir_graph = node->ir_node->graph;
+        struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, node->ir_node->input_tensors[0]);
+        struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, node->ir_node->output_tensors[0]);
+        /* debug */
+        if (input_tensor->dim_num <= 5)
+            extract_feature_from_tensor("in", name, input_tensor);
+        if (output_tensor->dim_num <= 5)
+            extract_feature_from_tensor("out", name, output_tensor);
+    }
+
+//#define DUMP_NODE_OUTPUT
+#ifdef DUMP_NODE_OUTPUT
+    /* dump the node output */
+    struct node* ir_node = node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+
+    for (int i = 0; i < ir_node->input_num; i++)
+    {
+        char fname[128];
+        struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+
+        sprintf(fname, "/tmp/dump/node%s%d.%d", (ir_node->idx < 10 ? "0" : ""), ir_node->idx, i);
+
+        dump_float(fname, ir_tensor->data, ir_tensor->elem_num);
+    }
+
+#endif
+
+    return 0;
+}
+
+struct wave_job
+{
+    struct device* dev;
+    struct exec_graph* exec_graph;
+    int start;
+    int wave_size;
+    int slot_num;
+    int node_num;
+    int has_error;
+    double cost[MAX_WAVE_WORKER];
+};
 
-        for (uint8_t j = 0; j < node->ir_node->output_num; j++)
+/* nodes sharing a slot share its shared mem, so each slot is drained by one thread */
+static void run_wave_slot(void* arg, int begin, int end)
+{
+    struct wave_job* job = (struct wave_job*)arg;
+
+    for (int slot = begin; slot < end; slot++)
+    {
+        for (int j = slot; j < job->wave_size; j += job->slot_num)
         {
-            struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, node->ir_node->output_tensors[j]);
-            /* debug */
-            if (output_tensor->dim_num <= 5)
-            {
-                char dir_str[32] = {0};
-                sprintf(dir_str, "out[%d]", j);
+            struct exec_node* node = (struct exec_node*)get_vector_data(job->exec_graph->exec_node_list, job->start + j);
+            struct exec_graph view;
 
-                extract_feature_from_tensor(dir_str, name, output_tensor);
-            }
+            get_exec_graph_slot_view(job->exec_graph, job->wave_size, j, &view);
+
+            if (run_exec_node(job->dev, &view, node, job->start + j, job->node_num, &job->cost[slot]) < 0)
+                job->has_error = 1;
         }
-#endif
-        const char* env = getenv(TENGINE_DUMP_LAYER);
-        if (env && env[0] == '1')
+    }
+}
+
+static int run_exec_graph(struct device* dev, struct exec_graph* exec_graph, double* cost)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    if (exec_graph->wave_num == 0)
+    {
+        for (int i = 0; i < node_num; i++)
         {
-            struct graph* ir_graph = node->ir_node->graph;
-            struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, node->ir_node->input_tensors[0]);
-            struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, node->ir_node->output_tensors[0]);
-            /* debug */
-            if (input_tensor->dim_num <= 5)
-                extract_feature_from_tensor("in", name, input_tensor);
-            if (output_tensor->dim_num <= 5)
-                extract_feature_from_tensor("out", name, output_tensor);
+            struct exec_node* node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+
+            if (run_exec_node(dev, exec_graph, node, i, node_num, cost) < 0)
+                return -1;
         }
 
-//#define DUMP_NODE_OUTPUT
-#ifdef DUMP_NODE_OUTPUT
-        /* dump the node output */
-        struct node* ir_node = node->ir_node;
-        struct graph* ir_graph = ir_node->graph;
+        return 0;
+    }
+
+    for (int w = 0; w < exec_graph->wave_num; w++)
+    {
+        int start = exec_graph->wave_list[w];
+        int wave_size = exec_graph->wave_list[w + 1] - start;
 
-        for (int i = 0; i < ir_node->input_num; i++)
+        if (wave_size == 1)
         {
-            char fname[128];
-            struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+            struct exec_node* node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, start);
 
-            sprintf(fname, "/tmp/dump/node%s%d.%d", (ir_node->idx < 10 ? "0" : ""), ir_node->idx, i);
+            if (run_exec_node(dev, exec_graph, node, start, node_num, cost) < 0)
+                return -1;
 
-            dump_float(fname, ir_tensor->data, ir_tensor->elem_num);
+            continue;
         }
 
-#endif
+        struct wave_job job;
+
+        job.dev = dev;
+        job.exec_graph = exec_graph;
+        job.start = start;
+        job.wave_size = wave_size;
+        job.slot_num = wave_size < exec_graph->worker_num ? wave_size : exec_graph->worker_num;
+        job.node_num = node_num;
+        job.has_error = 0;
+
+        memset(job.cost, 0, sizeof(job.cost));
+
+        parallel_for(run_wave_slot, &job, job.slot_num, job.slot_num);
+
+        for (int i = 0; i < job.slot_num; i++)
+            *cost += job.cost[i];
+
+        if (job.has_error)
+            return -1;
     }
 
     return 0;
 }
 
+static int run(struct device* dev, struct subgraph* subgraph)
+{
+    struct exec_graph* exec_graph = (struct exec_graph*)subgraph->device_graph;
+
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+    double cost = 0.;
+
+    if (exec_graph->timer)
+    {
+        double* timer = (double*)exec_graph->timer;
+        timer[node_num] += 1.0; // repeat
+    }
+
+    size_t cpu_mask = set_parallel_cpu_mask(exec_graph->cpu_mask);
+
+    /* the input shapes changed since prerun, infer the shapes and plan the memory again */
+    if (exec_graph_input_reshaped(exec_graph) && reshape_exec_graph(exec_graph) < 0)
+    {
+        TLOG_ERR("%s: failed to reshape graph\n", dev->name);
+        set_parallel_cpu_mask(cpu_mask);
+        return -1;
+    }
+
+    int ret = run_exec_graph(dev, exec_graph, &cost);
+
+    set_parallel_cpu_mask(cpu_mask);
+
+    if (exec_graph->timer)
+    {
+        double* timer = (double*)exec_graph->timer;
+        timer[node_num + 1] += cost; // sum
+    }
+
+    return ret;
+}
+
 static int postrun(struct device* dev, struct subgraph* subgraph)
 {
     struct exec_graph* exec_graph = (struct exec_graph*)subgraph->device_graph;
@@ -378,6 +514,28 @@ int cpu_split_graph(struct graph* ir_graph)
     return 0;
 }
 
+static int cpu_optimize_graph(struct graph* ir_graph, int precision)
+{
+    /* the fusion can be turned off to compare with the original graph */
+    const char* env = getenv(TENGINE_DISABLE_FUSION);
+    if (NULL != env && env[0] == '1')
+    {
+        return 0;
+    }
+
+    /* the clones are copied from a fused graph, and the op params they share must not change */
+    if (NULL != ir_graph->origin)
+    {
+        return 0;
+    }
+
+    /* the fusion follows the mode the kernels run in */
+    int mode, weight_mode;
+    get_exec_graph_mode(precision, &mode, &weight_mode);
+
+    return fuse_ir_graph(ir_graph, mode);
+}
+
 static struct interface cpu_interface = {
     .init = init_cpu,
     .pre_run = prerun,
@@ -398,7 +556,7 @@ static struct allocator cpu_allocator = {
 
 static struct optimizer cpu_optimizer = {
     .split_graph = cpu_split_graph,
-    .optimize_graph = NULL,
+    .optimize_graph = cpu_optimize_graph,
 };
 
 static struct cpu_device cpu_dev = {
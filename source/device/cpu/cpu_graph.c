@@ -27,6 +27,8 @@
 #include "cpu_node.h"
 #include "cpu_pool.h"
 #include "cpu_module.h"
+#include "cpu_layout.h"
+#include "cpu_prepack.h"
 
 #include "defines.h"
 #include "utility/sys_port.h"
@@ -39,6 +41,8 @@
 #include "utility/log.h"
 #include "serializer/serializer.h"
 
+#include <string.h>
+
 static struct exec_graph* new_exec_graph(void)
 {
     struct exec_graph* exec_graph = (struct exec_graph*)sys_malloc(sizeof(struct exec_graph));
@@ -61,9 +65,80 @@ static struct exec_graph* new_exec_graph(void)
     exec_graph->shared_pack4_mem = NULL;
     exec_graph->shared_pack4_mem_size = 0;
 
+    exec_graph->cpu_mask = 0;
+
+    exec_graph->wave_num = 0;
+    exec_graph->wave_list = NULL;
+    exec_graph->worker_num = 1;
+
+    exec_graph->input_num = 0;
+    exec_graph->input_list = NULL;
+    exec_graph->input_shape = NULL;
+
+    exec_graph->prepack_cache = NULL;
+
     return exec_graph;
 }
 
+#define SHAPE_SIZE (TE_MAX_SHAPE_DIM_NUM + 1)
+
+static void save_tensor_shape(const struct tensor* ir_tensor, int* shape)
+{
+    shape[0] = ir_tensor->dim_num;
+
+    for (int i = 0; i < ir_tensor->dim_num; i++)
+        shape[1 + i] = ir_tensor->dims[i];
+}
+
+static int tensor_shape_changed(const struct tensor* ir_tensor, const int* shape)
+{
+    if (shape[0] != ir_tensor->dim_num)
+        return 1;
+
+    for (int i = 0; i < ir_tensor->dim_num; i++)
+    {
+        if (shape[1 + i] != ir_tensor->dims[i])
+            return 1;
+    }
+
+    return 0;
+}
+
+static struct graph* get_exec_graph_ir_graph(struct exec_graph* exec_graph)
+{
+    struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, 0);
+
+    return exec_node->ir_node->graph;
+}
+
+static void save_exec_graph_input_shape(struct exec_graph* exec_graph, struct graph* ir_graph)
+{
+    for (int i = 0; i < exec_graph->input_num; i++)
+    {
+        struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, exec_graph->input_list[i]);
+
+        save_tensor_shape(ir_tensor, exec_graph->input_shape + i * SHAPE_SIZE);
+    }
+}
+
+int exec_graph_input_reshaped(struct exec_graph* exec_graph)
+{
+    if (exec_graph->input_num == 0 || get_vector_num(exec_graph->exec_node_list) == 0)
+        return 0;
+
+    struct graph* ir_graph = get_exec_graph_ir_graph(exec_graph);
+
+    for (int i = 0; i < exec_graph->input_num; i++)
+    {
+        struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, exec_graph->input_list[i]);
+
+        if (tensor_shape_changed(ir_tensor, exec_graph->input_shape + i * SHAPE_SIZE))
+            return 1;
+    }
+
+    return 0;
+}
+
 void release_exec_graph(void* exec_graph)
 {
     struct exec_graph* graph = (struct exec_graph*)exec_graph;
@@ -80,12 +155,81 @@ void release_exec_graph(void* exec_graph)
 
     free_exec_graph_mem(graph);
 
+    /* the nodes may use the packed weights of the file until they are released */
+    release_prepack_cache(graph);
+
+    reset_exec_graph_layout(graph);
+
     release_vector(graph->exec_node_list);
 
+    if (graph->wave_list)
+        sys_free(graph->wave_list);
+
+    if (graph->input_list)
+        sys_free(graph->input_list);
+    if (graph->input_shape)
+        sys_free(graph->input_shape);
+
     sys_free(graph);
 }
 
-struct exec_graph* create_exec_graph(struct subgraph* subgraph, int num_thread, int mode, size_t cpu_affinity)
+/* the layouts are set once the ops of all the nodes are bound, the nodes reading or writing a blocked tensor are init again */
+static int init_exec_graph_layout(struct exec_graph* exec_graph)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    if (node_num == 0)
+        return 0;
+
+    uint8_t* node_mask = (uint8_t*)sys_malloc(node_num);
+
+    if (node_mask == NULL)
+        return -1;
+
+    memset(node_mask, 0, node_num);
+
+    int ret = set_exec_graph_layout(exec_graph, node_mask) < 0 ? -1 : 0;
+
+    for (int i = 0; ret == 0 && i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+        struct node_ops* node_ops = exec_node->node_ops;
+
+        if (!node_mask[i])
+            continue;
+
+        release_exec_node(exec_graph, exec_node, node_ops);
+
+        if (init_exec_node(exec_graph, exec_node, exec_node->ir_node, node_ops) < 0)
+        {
+            TLOG_ERR("%s: failed to init exec node %d again\n", exec_graph->dev->base.name, exec_node->ir_node->index);
+            ret = -1;
+        }
+    }
+
+    sys_free(node_mask);
+
+    return ret;
+}
+
+void get_exec_graph_mode(int precision, int* mode, int* weight_mode)
+{
+    *mode = precision;
+    *weight_mode = precision;
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    if (TENGINE_MODE_FP16 == precision || TENGINE_MODE_BF16 == precision)
+        *mode = TENGINE_MODE_FP32;
+#else
+    if (TENGINE_MODE_BF16 == precision)
+    {
+        *mode = TENGINE_MODE_FP32;
+        *weight_mode = TENGINE_MODE_FP32;
+    }
+#endif
+}
+
+struct exec_graph* create_exec_graph(struct subgraph* subgraph, int num_thread, int precision, size_t cpu_affinity)
 {
     /* generate exec_graph */
     int node_num = subgraph->node_num;
@@ -101,7 +245,7 @@ struct exec_graph* create_exec_graph(struct subgraph* subgraph, int num_thread,
     exec_graph->dev = dev;
     exec_graph->num_thread = num_thread;
     exec_graph->cpu_affinity = cpu_affinity;
-    exec_graph->mode = mode;
+    get_exec_graph_mode(precision, &exec_graph->mode, &exec_graph->weight_mode);
 
     for (int i = 0; i < node_num; i++)
     {
@@ -133,6 +277,23 @@ struct exec_graph* create_exec_graph(struct subgraph* subgraph, int num_thread,
         push_vector_data(exec_graph->exec_node_list, &exec_node);
     }
 
+    if (init_exec_graph_layout(exec_graph) < 0)
+        goto error;
+
+    if (subgraph->input_num > 0)
+    {
+        exec_graph->input_list = (uint16_t*)sys_malloc(sizeof(uint16_t) * subgraph->input_num);
+        exec_graph->input_shape = (int*)sys_malloc(sizeof(int) * SHAPE_SIZE * subgraph->input_num);
+
+        if (exec_graph->input_list == NULL || exec_graph->input_shape == NULL)
+            goto error;
+
+        exec_graph->input_num = subgraph->input_num;
+        memcpy(exec_graph->input_list, subgraph->input_tensor_list, sizeof(uint16_t) * subgraph->input_num);
+
+        save_exec_graph_input_shape(exec_graph, ir_graph);
+    }
+
     return exec_graph;
 
 error:
@@ -140,21 +301,323 @@ error:
     return NULL;
 }
 
+/* prerun the nodes marked in node_mask, or all the nodes if it is NULL */
+static int prerun_exec_node_list(struct exec_graph* exec_graph, const uint8_t* node_mask)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+    int wave_num = exec_graph->wave_num > 0 ? exec_graph->wave_num : 1;
+
+    for (int w = 0; w < wave_num; w++)
+    {
+        int start = exec_graph->wave_num > 0 ? exec_graph->wave_list[w] : 0;
+        int end = exec_graph->wave_num > 0 ? exec_graph->wave_list[w + 1] : node_num;
+
+        for (int i = start; i < end; i++)
+        {
+            struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+            struct node_ops* node_ops = exec_node->node_ops;
+            struct exec_graph view;
+
+            if (node_mask && !node_mask[i])
+                continue;
+
+            /* kernels may bind shared mem in prerun, so bind the one of the slot the node will run on */
+            get_exec_graph_slot_view(exec_graph, end - start, i - start, &view);
+
+            if (node_ops->prerun && node_ops->prerun(node_ops, exec_node, &view) < 0)
+            {
+                TLOG_ERR("%s: failed to prerun node %d\n", exec_graph->dev->base.name, exec_node->ir_node->index);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
 int prerun_exec_graph(struct exec_graph* exec_graph)
+{
+    return prerun_exec_node_list(exec_graph, NULL);
+}
+
+static int infer_exec_node_shape(struct exec_graph* exec_graph, struct exec_node* exec_node)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct node_ops* node_ops = exec_node->node_ops;
+    struct graph* ir_graph = ir_node->graph;
+
+    if (node_ops->reshape)
+        return node_ops->reshape(node_ops, exec_node, exec_graph);
+
+    if (ir_node->op.same_shape)
+    {
+        struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+        struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+        return set_ir_tensor_shape(output_tensor, input_tensor->dims, input_tensor->dim_num);
+    }
+
+    if (ir_node->op.infer_shape)
+        return ir_node->op.infer_shape(ir_node);
+
+    return 0;
+}
+
+static int exec_node_shape_changed(struct exec_node* exec_node, const int* old_shape)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+
+    for (int i = 0; i < ir_node->input_num; i++)
+    {
+        struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+
+        if (tensor_shape_changed(ir_tensor, old_shape + ir_tensor->index * SHAPE_SIZE))
+            return 1;
+    }
+
+    for (int i = 0; i < ir_node->output_num; i++)
+    {
+        struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[i]);
+
+        if (tensor_shape_changed(ir_tensor, old_shape + ir_tensor->index * SHAPE_SIZE))
+            return 1;
+    }
+
+    return 0;
+}
+
+/* drop the shape dependent state of a node, prerun builds it again */
+static int resize_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node)
+{
+    struct node_ops* node_ops = exec_node->node_ops;
+
+    if (node_ops->resize)
+        return node_ops->resize(node_ops, exec_node, exec_graph);
+
+    if (node_ops->postrun && node_ops->postrun(node_ops, exec_node, exec_graph) < 0)
+        return -1;
+
+    release_exec_node(exec_graph, exec_node, node_ops);
+
+    return init_exec_node(exec_graph, exec_node, exec_node->ir_node, node_ops);
+}
+
+int reshape_exec_graph(struct exec_graph* exec_graph)
 {
     int node_num = get_vector_num(exec_graph->exec_node_list);
 
+    if (node_num == 0)
+        return 0;
+
+    struct graph* ir_graph = get_exec_graph_ir_graph(exec_graph);
+
+    int* old_shape = (int*)sys_malloc(sizeof(int) * SHAPE_SIZE * ir_graph->tensor_num);
+    uint8_t* node_mask = (uint8_t*)sys_malloc(node_num);
+
+    if (old_shape == NULL || node_mask == NULL)
+    {
+        if (old_shape)
+            sys_free(old_shape);
+        if (node_mask)
+            sys_free(node_mask);
+        return -1;
+    }
+
+    int ret = -1;
+
+    for (int i = 0; i < ir_graph->tensor_num; i++)
+        save_tensor_shape(get_ir_graph_tensor(ir_graph, i), old_shape + i * SHAPE_SIZE);
+
+    memset(node_mask, 0, node_num);
+
+    /* exec_node_list is in topological order, so the inputs of a node get their shapes first */
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+
+        if (infer_exec_node_shape(exec_graph, exec_node) < 0)
+        {
+            TLOG_ERR("%s: failed to reshape node %d, %s\n", exec_graph->dev->base.name, exec_node->ir_node->index, exec_node->ir_node->name);
+            goto out;
+        }
+    }
+
+    /* the nodes may choose other layouts for the new shapes, their readers and writers are resized too */
+    if (set_exec_graph_layout(exec_graph, node_mask) < 0)
+        goto out;
+
     for (int i = 0; i < node_num; i++)
     {
         struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
-        struct node_ops* node_ops = exec_node->node_ops;
 
-        if (node_ops->prerun && node_ops->prerun(node_ops, exec_node, exec_graph) < 0)
+        node_mask[i] = node_mask[i] || exec_node_shape_changed(exec_node, old_shape);
+
+        if (node_mask[i] && resize_exec_node(exec_graph, exec_node) < 0)
         {
-            TLOG_ERR("%s: failed to prerun node %d\n", exec_graph->dev->base.name, exec_node->ir_node->index);
-            return -1;
+            TLOG_ERR("%s: failed to resize node %d, %s\n", exec_graph->dev->base.name, exec_node->ir_node->index, exec_node->ir_node->name);
+            goto out;
         }
     }
 
+    if (realloc_exec_graph_mem(exec_graph) < 0)
+        goto out;
+
+    int shared_mem_moved = realloc_exec_graph_shared_mem(exec_graph);
+
+    if (shared_mem_moved < 0)
+        goto out;
+
+    /* the nodes bound to the old shared mem must be bound again */
+    for (int i = 0; shared_mem_moved && i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+
+        if (node_mask[i] || (exec_node->shared_mem_size == 0 && exec_node->shared_pack4_mem_size == 0))
+            continue;
+
+        node_mask[i] = 1;
+
+        if (resize_exec_node(exec_graph, exec_node) < 0)
+        {
+            TLOG_ERR("%s: failed to resize node %d, %s\n", exec_graph->dev->base.name, exec_node->ir_node->index, exec_node->ir_node->name);
+            goto out;
+        }
+    }
+
+    if (prerun_exec_node_list(exec_graph, node_mask) < 0)
+        goto out;
+
+    save_exec_graph_input_shape(exec_graph, ir_graph);
+
+    ret = 0;
+
+out:
+    sys_free(old_shape);
+    sys_free(node_mask);
+
+    return ret;
+}
+
+/*
+ * the waves run one after another, instead of sending each node to the pool once its inputs
+ * are done. a node waits for the slowest node of the wave before it, but the lifetime of the
+ * arena blocks is counted in waves and a slot holds its shared mem for one node at a time, so
+ * no block or slot is used by two nodes running at once. see mem_pool_plan().
+ */
+int split_exec_graph_wave(struct exec_graph* exec_graph)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    if (node_num < 2 || exec_graph->num_thread < 2)
+        return 0;
+
+    struct graph* ir_graph = ((struct exec_node*)get_vector_data(exec_graph->exec_node_list, 0))->ir_node->graph;
+
+    int* exec_idx = (int*)sys_malloc(sizeof(int) * ir_graph->node_num);
+    int* level = (int*)sys_malloc(sizeof(int) * node_num);
+    int* wave_list = (int*)sys_malloc(sizeof(int) * (node_num + 1));
+    struct vector* sorted_list = create_vector(sizeof(struct exec_node), NULL);
+
+    if (NULL == exec_idx || NULL == level || NULL == wave_list || NULL == sorted_list)
+    {
+        sys_free(exec_idx);
+        sys_free(level);
+        sys_free(wave_list);
+        if (sorted_list)
+            release_vector(sorted_list);
+        return -1;
+    }
+
+    for (int i = 0; i < ir_graph->node_num; i++)
+        exec_idx[i] = -1;
+
+    /* exec_node_list is in topological order, so producers always get their level first */
+    int wave_num = 0;
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+        struct node* ir_node = exec_node->ir_node;
+
+        exec_idx[ir_node->index] = i;
+        level[i] = 0;
+
+        for (int j = 0; j < ir_node->input_num; j++)
+        {
+            struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[j]);
+
+            if (ir_tensor->producer < 0 || exec_idx[ir_tensor->producer] < 0)
+                continue;
+
+            int producer_level = level[exec_idx[ir_tensor->producer]];
+
+            if (producer_level + 1 > level[i])
+                level[i] = producer_level + 1;
+        }
+
+        if (level[i] + 1 > wave_num)
+            wave_num = level[i] + 1;
+    }
+
+    /* stable reorder by level, and find the widest wave */
+    int max_wave_size = 0;
+    for (int w = 0; w < wave_num; w++)
+    {
+        wave_list[w] = get_vector_num(sorted_list);
+
+        for (int i = 0; i < node_num; i++)
+        {
+            if (level[i] == w)
+                push_vector_data(sorted_list, get_vector_data(exec_graph->exec_node_list, i));
+        }
+
+        int wave_size = get_vector_num(sorted_list) - wave_list[w];
+        if (wave_size > max_wave_size)
+            max_wave_size = wave_size;
+    }
+    wave_list[wave_num] = node_num;
+
+    sys_free(exec_idx);
+    sys_free(level);
+
+    /* a chain graph gains nothing */
+    if (max_wave_size < 2)
+    {
+        sys_free(wave_list);
+        release_vector(sorted_list);
+        return 0;
+    }
+
+    release_vector(exec_graph->exec_node_list);
+    exec_graph->exec_node_list = sorted_list;
+    exec_graph->wave_num = wave_num;
+    exec_graph->wave_list = wave_list;
+    exec_graph->worker_num = max_wave_size < exec_graph->num_thread ? max_wave_size : exec_graph->num_thread;
+    if (exec_graph->worker_num > MAX_WAVE_WORKER)
+        exec_graph->worker_num = MAX_WAVE_WORKER;
+
+    TLOG_DEBUG("Tengine: Inter-op parallel, %d nodes in %d waves, %d workers\n", node_num, wave_num, exec_graph->worker_num);
+
     return 0;
 }
+
+void get_exec_graph_slot_view(struct exec_graph* exec_graph, int wave_size, int slot, struct exec_graph* view)
+{
+    *view = *exec_graph;
+
+    /* single node wave takes all the threads */
+    if (wave_size < 2 || exec_graph->worker_num < 2)
+        return;
+
+    int worker_num = wave_size < exec_graph->worker_num ? wave_size : exec_graph->worker_num;
+    slot = slot % exec_graph->worker_num;
+
+    view->num_thread = exec_graph->num_thread / worker_num;
+    if (view->num_thread < 1)
+        view->num_thread = 1;
+
+    if (exec_graph->shared_mem)
+        view->shared_mem = (char*)exec_graph->shared_mem + (size_t)slot * exec_graph->shared_mem_size;
+    if (exec_graph->shared_pack4_mem)
+        view->shared_pack4_mem = (char*)exec_graph->shared_pack4_mem + (size_t)slot * exec_graph->shared_pack4_mem_size;
+}
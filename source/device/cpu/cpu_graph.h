@@ -28,6 +28,10 @@
 #include "cpu_device.h"
 
 #include <stddef.h>
+#include <stdint.h>
+
+/* the max concurrent nodes of a wave, the thread pool runs no more threads */
+#define MAX_WAVE_WORKER ((int)sizeof(size_t) * 8)
 
 struct exec_graph
 {
@@ -40,13 +44,50 @@ struct exec_graph
     void* shared_pack4_mem;
     int shared_pack4_mem_size;
     int num_thread;
-    int mode;
+    int mode;        /* the mode the kernels run in, see get_exec_graph_mode() */
+    int weight_mode; /* the precision the weights of fc and matmul are kept in */
     size_t cpu_affinity;
+    size_t cpu_mask; /* cores the parallel kernels run on, 0 means all */
     void* timer;
+
+    /* inter-op parallel mode, exec_node_list is sorted by wave, nodes in the same wave are independent */
+    int wave_num;   /* 0 means run exec_node_list in order */
+    int* wave_list; /* start index of each wave, wave_num + 1 items */
+    int worker_num; /* max concurrent nodes, each worker slot owns a piece of shared mem */
+
+    /* the subgraph inputs and their shapes the graph is planned for */
+    int input_num;
+    uint16_t* input_list;
+    int* input_shape; /* dim_num and TE_MAX_SHAPE_DIM_NUM dims of each input */
+
+    void* prepack_cache; /* the packed weights cached in a file or shared with the clones, see cpu_prepack.h */
 };
 
-struct exec_graph* create_exec_graph(struct subgraph* subgraph, int num_thread, int mode, size_t cpu_affinity);
+/*
+ * the mode of the kernels and the weights for the precision option. the x86 kernels keep the
+ * activations in fp32 in the fp16 and bf16 modes, fc and matmul keep their weights in them.
+ * the other cpus run the bf16 mode in fp32.
+ */
+void get_exec_graph_mode(int precision, int* mode, int* weight_mode);
+
+struct exec_graph* create_exec_graph(struct subgraph* subgraph, int num_thread, int precision, size_t cpu_affinity);
 
 int prerun_exec_graph(struct exec_graph* exec_graph);
 
+/* group independent nodes into waves for inter-op parallel mode, must be called before alloc_exec_graph_mem */
+int split_exec_graph_wave(struct exec_graph* exec_graph);
+
+/* get the view of exec graph which a node of a wave runs on, with the shared mem of its worker slot */
+void get_exec_graph_slot_view(struct exec_graph* exec_graph, int wave_size, int slot, struct exec_graph* view);
+
+/* check if the shape of any subgraph input changed since the graph was planned */
+int exec_graph_input_reshaped(struct exec_graph* exec_graph);
+
+/*
+ * infer the shapes for the new input shapes, plan the memory again and refresh the nodes
+ * whose shapes changed. the arena and the shared mem only grow, the packed weights are
+ * kept by the nodes having resize().
+ */
+int reshape_exec_graph(struct exec_graph* exec_graph);
+
 void release_exec_graph(void* exec_graph);
@@ -0,0 +1,191 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "cpu_layout.h"
+
+#include "cpu_define.h"
+#include "cpu_node.h"
+#include "cpu_graph.h"
+#include "cpu_pool.h"
+
+#include "api/c_api.h"
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/vector.h"
+#include "utility/log.h"
+
+#include <stdlib.h>
+
+static int exec_graph_layout_enabled(struct graph* ir_graph)
+{
+    if (ir_graph->graph_layout != TENGINE_LAYOUT_NCHW)
+        return 0;
+
+    const char* env = getenv(TENGINE_DISABLE_NCHWC);
+    if (env && env[0] == '1')
+        return 0;
+
+    /* the dumped data is read as NCHW */
+    env = getenv(TENGINE_DUMP_LAYER);
+    if (env && env[0] == '1')
+        return 0;
+
+    return 1;
+}
+
+/* the channel block a tensor is kept in, 1 for the plain tensors */
+static int get_tensor_block(struct graph* ir_graph, struct tensor* ir_tensor, const int* node_pack)
+{
+    if (ir_tensor->tensor_type != TENSOR_TYPE_VAR || ir_tensor->data_type != TENGINE_DT_FP32 || ir_tensor->dim_num != 4)
+        return 1;
+
+    if (ir_tensor->consumer_num == 0 || is_graph_output_tensor(ir_graph, ir_tensor))
+        return 1;
+
+    /* the buffer bound by the user */
+    if (ir_tensor->data != NULL && ir_tensor->internal_allocated != MEM_POOL_ALLOCATED)
+        return 1;
+
+    int block = node_pack[ir_tensor->producer];
+
+    if (block <= 1 || get_channel_block_layout(block) < 0)
+        return 1;
+
+    for (int i = 0; i < ir_tensor->consumer_num; i++)
+    {
+        if (node_pack[ir_tensor->consumer[i]] != block)
+            return 1;
+    }
+
+    return block;
+}
+
+int set_exec_graph_layout(struct exec_graph* exec_graph, uint8_t* node_mask)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    if (node_num == 0)
+        return 0;
+
+    struct exec_node* first_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, 0);
+    struct graph* ir_graph = first_node->ir_node->graph;
+
+    /* the pack and the exec node of each ir node, 0 and -1 for the nodes not on this graph */
+    int* node_pack = (int*)sys_malloc(sizeof(int) * ir_graph->node_num);
+    int* exec_index = (int*)sys_malloc(sizeof(int) * ir_graph->node_num);
+
+    if (node_pack == NULL || exec_index == NULL)
+    {
+        if (node_pack)
+            sys_free(node_pack);
+        if (exec_index)
+            sys_free(exec_index);
+        return -1;
+    }
+
+    for (int i = 0; i < ir_graph->node_num; i++)
+    {
+        node_pack[i] = 0;
+        exec_index[i] = -1;
+    }
+
+    int enabled = exec_graph_layout_enabled(ir_graph);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+        struct node* ir_node = exec_node->ir_node;
+        struct node_ops* node_ops = exec_node->node_ops;
+
+        exec_index[ir_node->index] = i;
+
+        if (enabled && node_ops->pack)
+            node_pack[ir_node->index] = node_ops->pack(node_ops, exec_graph, ir_node);
+    }
+
+    int changed = 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+        struct node* ir_node = exec_node->ir_node;
+
+        for (int j = 0; j < ir_node->output_num; j++)
+        {
+            struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
+            int block = get_tensor_block(ir_graph, ir_tensor, node_pack);
+            int layout = ir_tensor->layout;
+
+            /* infer_shape copies the layout of the input to the output of some ops */
+            if (block > 1)
+                layout = get_channel_block_layout(block);
+            else if (get_layout_channel_block(layout) > 1)
+                layout = TENGINE_LAYOUT_NCHW;
+
+            if (layout == ir_tensor->layout)
+                continue;
+
+            ir_tensor->layout = layout;
+            changed++;
+
+            if (node_mask == NULL)
+                continue;
+
+            node_mask[i] = 1;
+
+            for (int k = 0; k < ir_tensor->consumer_num; k++)
+            {
+                int index = exec_index[ir_tensor->consumer[k]];
+
+                if (index >= 0)
+                    node_mask[index] = 1;
+            }
+        }
+    }
+
+    sys_free(node_pack);
+    sys_free(exec_index);
+
+    return changed;
+}
+
+void reset_exec_graph_layout(struct exec_graph* exec_graph)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+        struct node* ir_node = exec_node->ir_node;
+
+        for (int j = 0; j < ir_node->output_num; j++)
+        {
+            struct tensor* ir_tensor = get_ir_graph_tensor(ir_node->graph, ir_node->output_tensors[j]);
+
+            if (get_layout_channel_block(ir_tensor->layout) > 1)
+                ir_tensor->layout = TENGINE_LAYOUT_NCHW;
+        }
+    }
+}
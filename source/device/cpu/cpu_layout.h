@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+struct exec_graph;
+
+/*
+ * keep the 4d fp32 tensors between the nodes of a graph in a blocked layout, such as
+ * NC8HW8. a tensor is blocked when its producer and all its consumers run on this graph
+ * and report the same channel block by node_ops pack(), the other tensors stay plain,
+ * so the nodes at the boundaries read or write the plain ones themselves. the graph
+ * outputs and the graphs dumping their data are never blocked.
+ *
+ * returns the count of the tensors whose layout changed, the nodes writing or reading
+ * them are marked in node_mask if it is not NULL, -1 for failure.
+ */
+int set_exec_graph_layout(struct exec_graph* exec_graph, uint8_t* node_mask);
+
+/* set the blocked tensors of the graph back to NCHW */
+void reset_exec_graph_layout(struct exec_graph* exec_graph);
+
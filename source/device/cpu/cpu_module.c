@@ -44,6 +44,7 @@
 #include "utility/utils.h"
 #include "utility/log.h"
 #include "serializer/serializer.h"
+#include "system/cpu.h"
 
 static struct vector** cpu_builtin_ops_registry;
 static struct vector* cpu_custom_ops_registry;
@@ -119,6 +120,25 @@ int register_builtin_node_ops(int op_type, struct node_ops* node_ops)
     return 0;
 }
 
+void set_builtin_node_ops_name(const char* name)
+{
+    if (NULL == cpu_builtin_ops_registry)
+        return;
+
+    for (int i = 0; i < OP_BUILTIN_LAST; i++)
+    {
+        struct vector* ops_vector = cpu_builtin_ops_registry[i];
+
+        for (int j = 0; j < get_vector_num(ops_vector); j++)
+        {
+            struct node_ops* node_ops = *(struct node_ops**)get_vector_data(ops_vector, j);
+
+            if (NULL == node_ops->name)
+                node_ops->name = name;
+        }
+    }
+}
+
 int unregister_builtin_node_ops(int op_type, struct node_ops* node_ops)
 {
     if (op_type < OP_GENERIC || op_type >= OP_BUILTIN_LAST)
@@ -142,11 +162,16 @@ static inline struct node_ops* find_builtin_node_ops(struct exec_graph* exec_gra
 
     int max_score = 0;
     struct node_ops* selected_ops = NULL;
+    int cpu_isa = get_cpu_isa();
 
     for (int i = 0; i < num; i++)
     {
         struct node_ops* node_ops = *(struct node_ops**)get_vector_data(ops_vector, i);
 
+        /* the ops built for the isa not supported by this cpu */
+        if ((node_ops->isa & cpu_isa) != node_ops->isa)
+            continue;
+
         int score = node_ops->score(node_ops, exec_graph, ir_node);
 
         if (score > max_score)
@@ -33,6 +33,9 @@ void release_cpu_node_ops_registry(void);
 int register_builtin_node_ops(int op_type, struct node_ops* node_ops);
 int unregister_builtin_node_ops(int op_type, struct node_ops* node_ops);
 
+/* name the builtin node ops registered without a name, by the op file registering them */
+void set_builtin_node_ops_name(const char* name);
+
 int register_custom_node_ops(int op_type, struct node_ops* node_ops);
 int unregister_custom_node_ops(int op_type, struct node_ops* node_ops);
 
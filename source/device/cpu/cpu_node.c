@@ -25,6 +25,8 @@
 #include "cpu_node.h"
 
 #include "cpu_module.h"
+#include "api/c_api.h"
+#include "graph/tensor.h"
 #include "graph/node.h"
 #include "utility/sys_port.h"
 
@@ -39,17 +41,6 @@ int init_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, s
     exec_node->shared_pack4_mem_size = 0;
     exec_node->output_num = ir_node->output_num;
 
-    int8_t* block_id = exec_node->block_id;
-
-    if (exec_node->output_num > 4)
-    {
-        exec_node->block_id_ptr = (int8_t*)sys_malloc(sizeof(int8_t) * exec_node->output_num);
-        block_id = exec_node->block_id_ptr;
-    }
-
-    for (int i = 0; i < exec_node->output_num; i++)
-        block_id[i] = -1;
-
     if (node_ops->init_node && node_ops->init_node(node_ops, exec_node, exec_graph) < 0)
         return -1;
 
@@ -63,7 +54,24 @@ void release_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_nod
 
     if (exec_node->inplace_map_num > 2)
         sys_free(exec_node->inplace_map_ptr);
+}
+
+int can_view_ir_tensor(const struct tensor* base, const struct tensor* view)
+{
+    if (base->data_type != view->data_type || base->elem_size != view->elem_size)
+        return 0;
+
+    if (get_layout_channel_block(base->layout) != 1 || get_layout_channel_block(view->layout) != 1)
+        return 0;
+
+    if (base->data_type == TENGINE_DT_INT8 || base->data_type == TENGINE_DT_UINT8)
+    {
+        if (base->quant_param_num > 1 || view->quant_param_num > 1)
+            return 0;
+
+        if (base->scale != view->scale || base->zero_point != view->zero_point)
+            return 0;
+    }
 
-    if (exec_node->output_num > 4)
-        sys_free(exec_node->block_id_ptr);
+    return 1;
 }
@@ -30,6 +30,7 @@
 #include <stdint.h>
 
 struct node;
+struct tensor;
 struct node_ops;
 struct exec_node;
 struct exec_graph;
@@ -49,12 +50,6 @@ struct exec_node
         uint8_t inplace_map[4]; /* opt for single inplace map, such as relu */
     };
 
-    union
-    {
-        int8_t block_id[4];
-        int8_t* block_id_ptr;
-    };
-
     int shared_mem_size;
     int shared_pack4_mem_size;
 };
@@ -79,7 +74,46 @@ struct node_ops
 
     /* score */
     int (*score)(struct node_ops*, struct exec_graph*, struct node*);
+
+    /* resize node is called when the shapes of the node changed after prerun(),
+       prerun() is called again after it, with the new shared mem.
+       so that the node_ops can update the shared_mem size and drop the buffers
+       depending on the shapes, while keeping the packed weights.
+       without it, the node goes through postrun(), release_node(), init_node() and prerun().
+    */
+    int (*resize)(struct node_ops*, struct exec_node*, struct exec_graph*);
+
+    /* the cpu isa features the ops are built for, see CPU_ISA_BUILD in system/cpu.h.
+       the ops are not scored on a cpu without all of them, 0 for the ops run anywhere.
+    */
+    int isa;
+
+    /* the channel block of the blocked layout the node reads and writes its 4d fp32 var tensors in,
+       see TENGINE_LAYOUT_NC8HW8 in graph/tensor.h. the node runs each of them plain or blocked, as
+       the layout of the tensor is set, 0 for the node knowing no blocked layout.
+    */
+    int (*pack)(struct node_ops*, struct exec_graph*, struct node*);
+
+    /* the name of the kernel implementation, shown by the graph profile.
+       the builtin ops left NULL are named after the op file registering them, such as "conv_hcl_x86".
+    */
+    const char* name;
+
+    /* the output of the node is a view of an input, at offset bytes into its data, so that the node copies nothing.
+       returns the input slot, -1 for the output computed apart. the output gets the data of the input when both are
+       planned by the mem pool, the node must skip its copy in run() once the data pointers match.
+    */
+    int (*view_output)(struct node_ops*, struct exec_node*, int output_slot, size_t* offset);
+
+    /* the input of the node is a slice of the first output, at offset bytes into its data, such as the inputs of concat.
+       returns 0 for an input its producer may write right into the output, -1 for none. the mem pool places the
+       block of the input there when it can, the node must skip its copy in run() once the data pointers match.
+    */
+    int (*view_input)(struct node_ops*, struct exec_node*, int input_slot, size_t* offset);
 };
 
 int init_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, struct node* ir_node, struct node_ops* node_ops);
 void release_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, struct node_ops* node_ops);
+
+/* check if the view tensor can share the data of the base one, they must be of the same type, quantization and a plain layout */
+int can_view_ir_tensor(const struct tensor* base, const struct tensor* view);
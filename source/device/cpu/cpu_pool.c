@@ -23,6 +23,7 @@
  * Revised: lswang@openailab.com
  */
 
+
 #include "cpu_pool.h"
 
 #include "cpu_node.h"
@@ -36,14 +37,88 @@
 #include "utility/vector.h"
 #include "utility/log.h"
 
-struct mem_record
+#include <stdint.h>
+#include <stdlib.h>
+
+/* some kernels load a few vectors beyond the end of a tensor */
+#define MEM_BLOCK_PADDING 128
+
+/* graph outputs must keep their data after run, even if some nodes consume them */
+int is_graph_output_tensor(struct graph* ir_graph, const struct tensor* ir_tensor)
 {
-    struct tensor* ir_tensor;
-    int used;
-    int block_id;
-};
+    for (int i = 0; i < ir_graph->output_num; i++)
+    {
+        struct node* ir_node = get_ir_graph_node(ir_graph, ir_graph->output_nodes[i]);
+
+        for (int j = 0; j < ir_node->output_num; j++)
+        {
+            if (ir_node->output_tensors[j] == ir_tensor->index)
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* the block the given one is a slice of at last, the offset of the slice in it is added to offset */
+static int mem_pool_get_root(struct mem_pool* mem_pool, int block_id, size_t* offset)
+{
+    struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, block_id);
 
-static int find_inplace_input(struct exec_node* exec_node, int output_slot, struct node* ir_node, struct graph* ir_graph)
+    while (entry->parent >= 0)
+    {
+        *offset += entry->offset;
+        block_id = entry->parent;
+        entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, block_id);
+    }
+
+    return block_id;
+}
+
+/* the root block of the tensor planned, -1 for none, the offset of the tensor in it is set to offset */
+static int mem_pool_get_tensor_root(struct mem_pool* mem_pool, const struct tensor* ir_tensor, size_t* offset)
+{
+    int block_id = mem_pool->tensor_block[ir_tensor->index];
+
+    *offset = mem_pool->tensor_offset[ir_tensor->index];
+
+    if (ir_tensor->data != NULL || block_id < 0)
+        return -1;
+
+    return mem_pool_get_root(mem_pool, block_id, offset);
+}
+
+/* the pending reads of the root block are all by the node, no other node reads the views or slices on it */
+static int is_root_read_by_node_only(struct mem_pool* mem_pool, int root_id, struct node* ir_node, struct graph* ir_graph)
+{
+    struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, root_id);
+    int read_num = 0;
+
+    for (int i = 0; i < ir_node->input_num; i++)
+    {
+        struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+        size_t offset;
+
+        if (mem_pool_get_tensor_root(mem_pool, ir_tensor, &offset) == root_id)
+            read_num++;
+    }
+
+    return entry->used == read_num;
+}
+
+static int find_view_input(struct exec_node* exec_node, int output_slot, size_t* offset)
+{
+    struct node_ops* node_ops = exec_node->node_ops;
+
+    *offset = 0;
+
+    if (node_ops->view_output == NULL)
+        return -1;
+
+    return node_ops->view_output(node_ops, exec_node, output_slot, offset);
+}
+
+static int find_inplace_input(struct mem_pool* mem_pool, struct exec_node* exec_node, int output_slot, struct node* ir_node, struct graph* ir_graph)
 {
     if (exec_node->inplace_map_num == 0)
         return -1;
@@ -70,25 +145,16 @@ static int find_inplace_input(struct exec_node* exec_node, int output_slot, stru
 
     struct tensor* tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_slot]);
 
-    if (tensor->consumer_num > 1)
+    if (tensor->consumer_num > 1 || is_graph_output_tensor(ir_graph, tensor))
         return -1;
 
-    return input_slot;
-}
-
-static int find_tensor_mem_list(struct vector* tensor_mem_list, const struct tensor* ir_tensor)
-{
-    int rec_number = get_vector_num(tensor_mem_list);
-
-    for (int i = 0; i < rec_number; i++)
-    {
-        struct mem_record* rec = (struct mem_record*)get_vector_data(tensor_mem_list, i);
+    size_t offset;
+    int root_id = mem_pool_get_tensor_root(mem_pool, tensor, &offset);
 
-        if (rec->ir_tensor == ir_tensor)
-            return i;
-    }
+    if (root_id >= 0 && !is_root_read_by_node_only(mem_pool, root_id, ir_node, ir_graph))
+        return -1;
 
-    return -1;
+    return input_slot;
 }
 
 void free_exec_graph_mem(struct exec_graph* graph)
@@ -120,14 +186,21 @@ static void mem_pool_dump(struct mem_pool* mem_pool)
 {
     int block_number = get_vector_num(mem_pool->block_list);
 
-    TLOG_INFO("Tengine: Block number: %d align size: %d\n", block_number, mem_pool->align_size);
+    TLOG_INFO("Tengine: Block number: %d align size: %d arena: %zu lower bound: %zu\n", block_number,
+              mem_pool->align_size, mem_pool->arena_size, mem_pool->lower_bound);
 
     for (int i = 0; i < block_number; i++)
     {
         struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, i);
 
-        TLOG_INFO("Tengine: %d: %p (%d) used: %d free: %d\n", i, entry->addr, entry->block_size, entry->alloc_count,
-                  entry->free_count);
+        if (entry->parent >= 0)
+        {
+            TLOG_DEBUG("Tengine: %d: in block %d at %zu (%zu)\n", i, entry->parent, entry->offset, entry->extent);
+            continue;
+        }
+
+        TLOG_DEBUG("Tengine: %d: offset %zu (%zu) wave: %d - %d\n", i, entry->offset, entry->size, entry->first_wave,
+                   entry->last_wave);
     }
 }
 
@@ -135,111 +208,236 @@ static void* mem_pool_get_mem_block(struct mem_pool* mem_pool, int block_id)
 {
     struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, block_id);
 
-    size_t addr = (size_t)(entry->addr);
-    size_t aligned_addr = (addr + 4 + mem_pool->align_size) & (~(mem_pool->align_size - 1));
+    size_t addr = (size_t)(mem_pool->arena);
+    size_t aligned_addr = (addr + mem_pool->align_size - 1) & (~(size_t)(mem_pool->align_size - 1));
 
-    return (void*)aligned_addr;
+    return (void*)(aligned_addr + entry->offset);
 }
 
-static int mem_pool_get_backend_mem(struct mem_pool* mem_pool)
+static int mem_pool_allocate(struct mem_pool* mem_pool, size_t size, int wave)
 {
-    int block_num = get_vector_num(mem_pool->block_list);
+    struct mem_block_entry e;
 
-    for (int i = 0; i < block_num; i++)
-    {
-        struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, i);
+    e.size = (size + MEM_BLOCK_PADDING + mem_pool->align_size - 1) & (~(size_t)(mem_pool->align_size - 1));
+    e.offset = 0;
+    e.extent = 0;
+    e.parent = -1;
+    e.first_wave = wave;
+    e.last_wave = wave;
+    e.used = 0;
 
-        entry->block_size = entry->max_req_size + mem_pool->align_size + 128;
+    push_vector_data(mem_pool->block_list, &e);
 
-        entry->addr = sys_malloc(entry->block_size);
+    return get_vector_num(mem_pool->block_list) - 1;
+}
 
-        if (entry->addr == NULL)
-            return -1;
-    }
+struct block_order
+{
+    size_t size;
+    int first_wave;
+    int block_id;
+};
 
-    return 0;
+static int compare_block_order(const void* a, const void* b)
+{
+    const struct block_order* order_a = (const struct block_order*)a;
+    const struct block_order* order_b = (const struct block_order*)b;
+
+    if (order_a->size != order_b->size)
+        return order_a->size > order_b->size ? -1 : 1;
+
+    if (order_a->first_wave != order_b->first_wave)
+        return order_a->first_wave - order_b->first_wave;
+
+    return order_a->block_id - order_b->block_id;
 }
 
-static int mem_pool_allocate(struct mem_pool* mem_pool, int size)
+/*
+ * greedy by size: place the blocks from the largest one, each into the smallest
+ * gap left by the placed blocks whose lifetime overlaps with it, or above them.
+ */
+static int mem_pool_pack(struct mem_pool* mem_pool, int wave_num)
 {
     int block_num = get_vector_num(mem_pool->block_list);
-    ;
+    int order_num = 0;
+
+    mem_pool->arena_size = 0;
+    mem_pool->lower_bound = 0;
+
+    if (block_num == 0)
+        return 0;
+
+    struct block_order* order = (struct block_order*)sys_malloc(sizeof(struct block_order) * block_num);
+
+    if (order == NULL)
+        return -1;
+
+    int* overlap = (int*)sys_malloc(sizeof(int) * block_num);
+
+    if (overlap == NULL)
+    {
+        sys_free(order);
+        return -1;
+    }
 
+    /* the slices are placed with their parents */
     for (int i = 0; i < block_num; i++)
     {
         struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, i);
 
-        if (entry->free_count != entry->alloc_count)
+        if (entry->parent >= 0)
             continue;
 
-        /* TODO: use the best match alg */
+        order[order_num].size = entry->size;
+        order[order_num].first_wave = entry->first_wave;
+        order[order_num].block_id = i;
+        order_num++;
+    }
 
-        entry->alloc_count++;
+    qsort(order, order_num, sizeof(struct block_order), compare_block_order);
 
-        if (entry->max_req_size < size)
-            entry->max_req_size = size;
+    for (int i = 0; i < order_num; i++)
+    {
+        struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, order[i].block_id);
+        int overlap_num = 0;
+
+        /* the placed blocks alive at the same time, sorted by offset */
+        for (int j = 0; j < i; j++)
+        {
+            struct mem_block_entry* placed = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, order[j].block_id);
+
+            if (placed->last_wave < entry->first_wave || entry->last_wave < placed->first_wave)
+                continue;
+
+            int k = overlap_num++;
+
+            while (k > 0)
+            {
+                struct mem_block_entry* prev = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, overlap[k - 1]);
+
+                if (prev->offset <= placed->offset)
+                    break;
+
+                overlap[k] = overlap[k - 1];
+                k--;
+            }
+
+            overlap[k] = order[j].block_id;
+        }
 
-        return i;
+        size_t best_gap = SIZE_MAX;
+        size_t best_offset = 0;
+        size_t top = 0;
+
+        for (int j = 0; j < overlap_num; j++)
+        {
+            struct mem_block_entry* placed = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, overlap[j]);
+
+            if (placed->offset > top)
+            {
+                size_t gap = placed->offset - top;
+
+                if (gap >= entry->size && gap < best_gap)
+                {
+                    best_gap = gap;
+                    best_offset = top;
+                }
+            }
+
+            if (placed->offset + placed->size > top)
+                top = placed->offset + placed->size;
+        }
+
+        entry->offset = best_gap == SIZE_MAX ? top : best_offset;
+
+        if (entry->offset + entry->size > mem_pool->arena_size)
+            mem_pool->arena_size = entry->offset + entry->size;
     }
 
-    /* create new block */
+    sys_free(order);
+    sys_free(overlap);
 
-    struct mem_block_entry e;
+    for (int w = 0; w < wave_num; w++)
+    {
+        size_t alive_size = 0;
 
-    e.addr = NULL;
-    e.max_req_size = size;
-    e.alloc_count = 1;
-    e.free_count = 0;
+        for (int i = 0; i < block_num; i++)
+        {
+            struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, i);
 
-    push_vector_data(mem_pool->block_list, &e);
+            if (entry->parent < 0 && entry->first_wave <= w && w <= entry->last_wave)
+                alive_size += entry->size;
+        }
 
-    return block_num;
+        if (alive_size > mem_pool->lower_bound)
+            mem_pool->lower_bound = alive_size;
+    }
+
+    return 0;
 }
 
-static void mem_pool_free(struct mem_pool* mem_pool, int block_id)
+static int mem_pool_get_backend_mem(struct mem_pool* mem_pool)
 {
-    struct mem_block_entry* block = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, block_id);
+    /* keep the arena while the blocks fit in it */
+    if (mem_pool->arena_size <= mem_pool->arena_capacity)
+        return 0;
+
+    if (mem_pool->arena != NULL)
+        sys_free(mem_pool->arena);
+
+    mem_pool->arena = sys_malloc(mem_pool->arena_size + mem_pool->align_size);
+    mem_pool->arena_capacity = 0;
+
+    if (mem_pool->arena == NULL)
+        return -1;
 
-    block->free_count++;
+    mem_pool->arena_capacity = mem_pool->arena_size;
+
+    return 0;
 }
 
 void release_mem_pool(struct mem_pool* mem_pool)
 {
     if (mem_pool->block_list != NULL)
-    {
-        int block_num = get_vector_num(mem_pool->block_list);
+        release_vector(mem_pool->block_list);
 
-        for (int i = 0; i < block_num; i++)
-        {
-            struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, i);
+    if (mem_pool->arena != NULL)
+        sys_free(mem_pool->arena);
 
-            sys_free(entry->addr);
-        }
+    if (mem_pool->tensor_block != NULL)
+        sys_free(mem_pool->tensor_block);
 
-        release_vector(mem_pool->block_list);
-    }
+    if (mem_pool->tensor_offset != NULL)
+        sys_free(mem_pool->tensor_offset);
 
     sys_free(mem_pool);
 }
 
-static struct mem_pool* create_mem_pool(void)
+static struct mem_pool* create_mem_pool(int tensor_num)
 {
     struct mem_pool* mem_pool = (struct mem_pool*)sys_malloc(sizeof(struct mem_pool));
 
     if (mem_pool == NULL)
         return NULL;
 
-    mem_pool->align_size = 16;
+    mem_pool->align_size = 64;
+    mem_pool->arena = NULL;
+    mem_pool->arena_size = 0;
+    mem_pool->arena_capacity = 0;
+    mem_pool->lower_bound = 0;
+    mem_pool->tensor_num = tensor_num;
+    mem_pool->tensor_block = (int*)sys_malloc(sizeof(int) * tensor_num);
+    mem_pool->tensor_offset = (size_t*)sys_malloc(sizeof(size_t) * tensor_num);
     mem_pool->block_list = create_vector(sizeof(struct mem_block_entry), NULL);
 
-    if (mem_pool->block_list == NULL)
+    if (mem_pool->tensor_block == NULL || mem_pool->tensor_offset == NULL || mem_pool->block_list == NULL)
         goto error;
 
-    mem_pool->allocate = mem_pool_allocate;
-    mem_pool->free = mem_pool_free;
-    mem_pool->dump = mem_pool_dump;
-    mem_pool->get_backend_mem = mem_pool_get_backend_mem;
-    mem_pool->get_mem_block = mem_pool_get_mem_block;
+    for (int i = 0; i < tensor_num; i++)
+    {
+        mem_pool->tensor_block[i] = -1;
+        mem_pool->tensor_offset[i] = 0;
+    }
 
     return mem_pool;
 
@@ -250,190 +448,342 @@ error:
     return NULL;
 }
 
-int alloc_exec_graph_mem(struct exec_graph* exec_graph)
+/*
+ * place the blocks of the inputs in the slices of the output the node offers, such as the inputs of concat,
+ * so that their producers write right into the output. the block of an input must hold no other tensor
+ * beyond the slice, and must not hold another input placed already.
+ */
+static void mem_pool_place_inputs(struct mem_pool* mem_pool, struct exec_node* exec_node, struct graph* ir_graph)
 {
-    struct mem_pool* mem_pool;
-    int max_shared_mem_size = 0;
-    int max_shared_pack4_mem_size = 0;
+    struct node_ops* node_ops = exec_node->node_ops;
+    struct node* ir_node = exec_node->ir_node;
 
-    int node_num = get_vector_num(exec_graph->exec_node_list);
+    if (node_ops->view_input == NULL)
+        return;
 
-    struct vector* tensor_mem_list = create_vector(sizeof(struct mem_record), NULL);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    size_t output_offset;
+    int output_root = mem_pool_get_tensor_root(mem_pool, output_tensor, &output_offset);
 
-    if (tensor_mem_list == NULL)
-        return -1;
+    if (output_root < 0)
+        return;
 
-    mem_pool = create_mem_pool();
+    for (int i = 0; i < ir_node->input_num; i++)
+    {
+        struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+        size_t input_offset;
+        size_t slice_offset;
+        int input_root = mem_pool_get_tensor_root(mem_pool, input_tensor, &input_offset);
 
-    if (mem_pool == NULL)
-        return -1;
+        if (input_root < 0 || input_root == output_root || input_offset != 0)
+            continue;
 
-    exec_graph->mem_pool = mem_pool;
+        if (node_ops->view_input(node_ops, exec_node, i, &slice_offset) < 0)
+            continue;
 
-    for (int i = 0; i < node_num; i++)
-    {
-        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
-        struct node* ir_node = exec_node->ir_node;
-        struct graph* ir_graph = ir_node->graph;
+        struct mem_block_entry* input_entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, input_root);
+        struct mem_block_entry* output_entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, output_root);
 
-        int8_t* block_id;
+        if (input_entry->extent > get_ir_tensor_mem_size(input_tensor))
+            continue;
 
-        if (exec_node->output_num > 4)
-            block_id = exec_node->block_id_ptr;
-        else
-            block_id = exec_node->block_id;
+        input_entry->parent = output_root;
+        input_entry->offset = output_offset + slice_offset;
 
-        for (int j = 0; j < ir_node->output_num; j++)
-        {
-            struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
+        /* the output block lives as long as the blocks in it, and takes their pending reads */
+        if (output_entry->first_wave > input_entry->first_wave)
+            output_entry->first_wave = input_entry->first_wave;
 
-            if (ir_tensor->data != NULL)
-                continue;
+        if (output_entry->last_wave < input_entry->last_wave)
+            output_entry->last_wave = input_entry->last_wave;
 
-            int inplace_input = find_inplace_input(exec_node, j, ir_node, ir_graph);
+        output_entry->used += input_entry->used;
+        input_entry->used = 0;
 
-            if (inplace_input >= 0)
-            {
-                struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[inplace_input]);
+        if (output_entry->extent < input_entry->offset + input_entry->extent)
+            output_entry->extent = input_entry->offset + input_entry->extent;
+    }
+}
+
+/* the tensors already having data, such as the inputs set by the user, are not planned */
+static int mem_pool_plan(struct mem_pool* mem_pool, struct exec_graph* exec_graph, struct graph* ir_graph)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+    int* tensor_block = mem_pool->tensor_block;
 
-                int idx = find_tensor_mem_list(tensor_mem_list, input_tensor);
+    int wave_num = exec_graph->wave_num > 0 ? exec_graph->wave_num : node_num;
+
+    /*
+     * a block lives from the wave writing it to the last wave reading it. nodes of
+     * the same wave may run at the same time, so the lifetime is counted in waves.
+     * without waves every node is a wave.
+     */
+    for (int w = 0; w < wave_num; w++)
+    {
+        int start = exec_graph->wave_num > 0 ? exec_graph->wave_list[w] : w;
+        int end = exec_graph->wave_num > 0 ? exec_graph->wave_list[w + 1] : w + 1;
+
+        for (int i = start; i < end; i++)
+        {
+            struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+            struct node* ir_node = exec_node->ir_node;
 
-                /* if the input is from outside buffer, input_r should be NULL */
-                if (idx < 0)
+            for (int j = 0; j < ir_node->output_num; j++)
+            {
+                struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
+
+                if (ir_tensor->data != NULL)
                     continue;
 
-                struct mem_record* input_r = (struct mem_record*)get_vector_data(tensor_mem_list, idx);
+                size_t mem_size = get_ir_tensor_mem_size(ir_tensor);
+                size_t offset;
+                int input_slot = find_view_input(exec_node, j, &offset);
+                int block_id = -1;
 
-                input_r->ir_tensor = ir_tensor;
-                input_r->used = ir_tensor->consumer_num;
-                block_id[j] = INPLACE_BLOCK_FLAG | inplace_input;
-                continue;
-            }
+                if (input_slot >= 0)
+                {
+                    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_slot]);
+                    size_t input_offset;
 
-            /* allocate mem from pool */
-            int mem_size = ir_tensor->elem_size * ir_tensor->elem_num;
+                    /* the view of an input from outside buffer is computed apart */
+                    block_id = mem_pool_get_tensor_root(mem_pool, input_tensor, &input_offset);
+                    offset += input_offset;
+                }
+                else if ((input_slot = find_inplace_input(mem_pool, exec_node, j, ir_node, ir_graph)) >= 0)
+                {
+                    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_slot]);
 
-            struct mem_record r;
+                    block_id = mem_pool_get_tensor_root(mem_pool, input_tensor, &offset);
 
-            r.ir_tensor = ir_tensor;
-            r.block_id = mem_pool->allocate(mem_pool, mem_size);
-            r.used = ir_tensor->consumer_num;
+                    /* if the input is from outside buffer, it has no block */
+                    if (block_id < 0)
+                        continue;
 
-            block_id[j] = r.block_id;
+                    struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, block_id);
+                    size_t padded_size = (mem_size + MEM_BLOCK_PADDING + mem_pool->align_size - 1) & (~(size_t)(mem_pool->align_size - 1));
 
-            push_vector_data(tensor_mem_list, &r);
-        }
+                    if (entry->size < offset + padded_size)
+                        entry->size = offset + padded_size;
+                }
 
-        /* clear input tensor count */
-        for (int j = 0; j < ir_node->input_num; j++)
-        {
-            struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[j]);
+                if (block_id < 0)
+                {
+                    block_id = mem_pool_allocate(mem_pool, mem_size, w);
+                    offset = 0;
 
-            if (ir_tensor->data != NULL)
-                continue;
+                    if (block_id < 0)
+                        return -1;
+                }
 
-            int idx = find_tensor_mem_list(tensor_mem_list, ir_tensor);
+                struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, block_id);
 
-            if (idx < 0)
-                continue;
+                /* an inplace block or a view still counts the read of its input by this node */
+                entry->used += ir_tensor->consumer_num;
 
-            struct mem_record* input_r = (struct mem_record*)get_vector_data(tensor_mem_list, idx);
+                /* never give the block of a graph output back to the pool */
+                if (is_graph_output_tensor(ir_graph, ir_tensor))
+                    entry->used++;
 
-            input_r->used--;
+                if (entry->extent < offset + mem_size)
+                    entry->extent = offset + mem_size;
 
-            if (input_r->used == 0)
+                tensor_block[ir_tensor->index] = block_id;
+                mem_pool->tensor_offset[ir_tensor->index] = offset;
+            }
+
+            mem_pool_place_inputs(mem_pool, exec_node, ir_graph);
+        }
+
+        for (int i = start; i < end; i++)
+        {
+            struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+            struct node* ir_node = exec_node->ir_node;
+
+            /* the readers extend the lifetime of the block */
+            for (int j = 0; j < ir_node->input_num; j++)
             {
-                mem_pool->free(mem_pool, input_r->block_id);
-                remove_vector_via_index(tensor_mem_list, idx);
+                struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[j]);
+                size_t offset;
+                int block_id = mem_pool_get_tensor_root(mem_pool, ir_tensor, &offset);
+
+                if (block_id < 0)
+                    continue;
+
+                struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, block_id);
+
+                entry->used--;
+                entry->last_wave = w;
             }
         }
+    }
+
+    /* graph outputs and the tensors read by other subgraphs stay alive until the end */
+    int block_num = get_vector_num(mem_pool->block_list);
+
+    for (int i = 0; i < block_num; i++)
+    {
+        struct mem_block_entry* entry = (struct mem_block_entry*)get_vector_data(mem_pool->block_list, i);
+
+        if (entry->parent < 0 && entry->used > 0)
+            entry->last_wave = wave_num - 1;
+    }
+
+    return mem_pool_pack(mem_pool, wave_num);
+}
+
+static void mem_pool_bind(struct mem_pool* mem_pool, struct graph* ir_graph)
+{
+    for (int i = 0; i < mem_pool->tensor_num; i++)
+    {
+        if (mem_pool->tensor_block[i] < 0)
+            continue;
+
+        struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, i);
+        size_t offset = mem_pool->tensor_offset[i];
+        int block_id = mem_pool_get_root(mem_pool, mem_pool->tensor_block[i], &offset);
+
+        ir_tensor->data = (uint8_t*)mem_pool_get_mem_block(mem_pool, block_id) + offset;
+        ir_tensor->free_host_mem = 0;
+        ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
+    }
+}
+
+static struct graph* get_exec_graph_ir_graph(struct exec_graph* exec_graph)
+{
+    struct exec_node* first_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, 0);
+
+    return first_node->ir_node->graph;
+}
+
+int realloc_exec_graph_shared_mem(struct exec_graph* exec_graph)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+    int max_shared_mem_size = 0;
+    int max_shared_pack4_mem_size = 0;
+    int moved = 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
 
-        /* handle shared mem */
         if (exec_node->shared_mem_size > max_shared_mem_size)
             max_shared_mem_size = exec_node->shared_mem_size;
         if (exec_node->shared_pack4_mem_size > max_shared_pack4_mem_size)
             max_shared_pack4_mem_size = exec_node->shared_pack4_mem_size;
     }
 
-    TLOG_DEBUG("Tengine: Final tensor_mem_list number: %d\n", get_vector_num(tensor_mem_list));
-
-    release_vector(tensor_mem_list);
-
-    exec_graph->shared_mem_size = max_shared_mem_size;
-    exec_graph->shared_pack4_mem_size = max_shared_pack4_mem_size;
-
-    if (max_shared_mem_size > 0)
+    /* each worker slot of inter-op parallel mode owns a piece of shared mem */
+    if (max_shared_mem_size > exec_graph->shared_mem_size)
     {
-        exec_graph->shared_mem = sys_malloc(max_shared_mem_size);
+        if (exec_graph->shared_mem)
+            sys_free(exec_graph->shared_mem);
+
+        exec_graph->shared_mem = sys_malloc((size_t)max_shared_mem_size * exec_graph->worker_num);
+        exec_graph->shared_mem_size = max_shared_mem_size;
+        moved = 1;
 
         if (exec_graph->shared_mem == NULL)
         {
             TLOG_ERR("Tengine: Cannot allocate shared memory. size=%d\n", max_shared_mem_size);
+            exec_graph->shared_mem_size = 0;
             return -1;
         }
     }
-    if (max_shared_pack4_mem_size > 0)
+    if (max_shared_pack4_mem_size > exec_graph->shared_pack4_mem_size)
     {
-        exec_graph->shared_pack4_mem = sys_malloc(max_shared_pack4_mem_size);
+        if (exec_graph->shared_pack4_mem)
+            sys_free(exec_graph->shared_pack4_mem);
+
+        exec_graph->shared_pack4_mem = sys_malloc((size_t)max_shared_pack4_mem_size * exec_graph->worker_num);
+        exec_graph->shared_pack4_mem_size = max_shared_pack4_mem_size;
+        moved = 1;
 
         if (exec_graph->shared_pack4_mem == NULL)
         {
             TLOG_ERR("Tengine: Cannot allocate shared pack4 memory. size=%d\n", max_shared_pack4_mem_size);
+            exec_graph->shared_pack4_mem_size = 0;
             return -1;
         }
     }
 
-    TLOG_DEBUG("Tengine: Shared memory: %p size=%d\n", exec_graph->shared_mem, max_shared_mem_size);
-    TLOG_DEBUG("Tengine: Shared pack4 memory: %p size=%d\n", exec_graph->shared_pack4_mem, max_shared_pack4_mem_size);
+    TLOG_DEBUG("Tengine: Shared memory: %p size=%d\n", exec_graph->shared_mem, exec_graph->shared_mem_size);
+    TLOG_DEBUG("Tengine: Shared pack4 memory: %p size=%d\n", exec_graph->shared_pack4_mem, exec_graph->shared_pack4_mem_size);
+
+    return moved;
+}
+
+int alloc_exec_graph_mem(struct exec_graph* exec_graph)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    if (node_num == 0)
+        return 0;
+
+    struct graph* ir_graph = get_exec_graph_ir_graph(exec_graph);
+    struct mem_pool* mem_pool = create_mem_pool(ir_graph->tensor_num);
+
+    if (mem_pool == NULL)
+        return -1;
+
+    exec_graph->mem_pool = mem_pool;
 
-    if (mem_pool->get_backend_mem(mem_pool) < 0)
+    if (mem_pool_plan(mem_pool, exec_graph, ir_graph) < 0)
+        return -1;
+
+    if (realloc_exec_graph_shared_mem(exec_graph) < 0)
+        return -1;
+
+    if (mem_pool_get_backend_mem(mem_pool) < 0)
     {
         TLOG_ERR("Tengine: Cannot allocate enough memory from backend\n");
         return -1;
     }
 
-    mem_pool->dump(mem_pool);
+    mem_pool_dump(mem_pool);
 
     /* now, the real allocate */
-    for (int i = 0; i < node_num; i++)
+    mem_pool_bind(mem_pool, ir_graph);
+
+    return 0;
+}
+
+int realloc_exec_graph_mem(struct exec_graph* exec_graph)
+{
+    struct mem_pool* mem_pool = exec_graph->mem_pool;
+
+    if (mem_pool == NULL)
+        return 0;
+
+    struct graph* ir_graph = get_exec_graph_ir_graph(exec_graph);
+
+    /* forget the old plan, the tensors still bound to the pool are planned again */
+    for (int i = 0; i < mem_pool->tensor_num; i++)
     {
-        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
-        struct node* ir_node = exec_node->ir_node;
-        struct graph* ir_graph = ir_node->graph;
-        struct mem_pool* local_mem_pool = exec_graph->mem_pool;
+        if (mem_pool->tensor_block[i] < 0)
+            continue;
 
-        int8_t* block_id;
+        struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, i);
 
-        if (exec_node->output_num > 4)
-            block_id = exec_node->block_id_ptr;
-        else
-            block_id = exec_node->block_id;
+        if (ir_tensor->internal_allocated == MEM_POOL_ALLOCATED)
+            ir_tensor->data = NULL;
 
-        for (int j = 0; j < ir_node->output_num; j++)
-        {
-            struct tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
+        mem_pool->tensor_block[i] = -1;
+    }
 
-            if (block_id[j] < 0)
-                continue;
+    resize_vector(mem_pool->block_list, 0);
 
-            if (block_id[j] & INPLACE_BLOCK_FLAG)
-            {
-                int input_idx = block_id[j] & (INPLACE_BLOCK_FLAG - 1);
+    if (mem_pool_plan(mem_pool, exec_graph, ir_graph) < 0)
+        return -1;
 
-                struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_idx]);
-                ir_tensor->data = input_tensor->data;
-                ir_tensor->free_host_mem = 0;
-                ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
-            }
-            else
-            {
-                ir_tensor->data = local_mem_pool->get_mem_block(local_mem_pool, block_id[j]);
-                // ir_tensor->data = sys_malloc(ir_tensor->elem_size * ir_tensor->elem_num);
-                ir_tensor->free_host_mem = 0;
-                ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
-            }
-        }
+    if (mem_pool_get_backend_mem(mem_pool) < 0)
+    {
+        TLOG_ERR("Tengine: Cannot allocate enough memory from backend\n");
+        return -1;
     }
 
+    mem_pool_dump(mem_pool);
+
+    mem_pool_bind(mem_pool, ir_graph);
+
     return 0;
 }
@@ -29,15 +29,24 @@
 
 #include <stdint.h>
 
+struct graph;
+struct tensor;
 struct exec_graph;
 
+/*
+ * a block of the arena, shared by an output tensor, the outputs computed inplace on it and the views
+ * of it. a block placed in a slice of another one, such as an input of concat in its output, is packed
+ * with that one, its parent, and counts nothing itself any more.
+ */
 struct mem_block_entry
 {
-    void* addr;
-    int block_size;
-    int max_req_size;
-    int alloc_count;
-    int free_count;
+    size_t size;    /* bytes, aligned and padded */
+    size_t offset;  /* offset from the base of the arena, or from the parent */
+    size_t extent;  /* the bytes the tensors on the block reach, not padded */
+    int parent;     /* the block it is a slice of, -1 for none */
+    int first_wave; /* the wave writing the block */
+    int last_wave;  /* the last wave reading the block */
+    int used;       /* pending readers while planning */
 };
 
 struct mem_pool
@@ -45,13 +54,25 @@ struct mem_pool
     uint8_t align_size; /* must be 2^n */
     struct vector* block_list;
 
-    int (*get_backend_mem)(struct mem_pool*);
-    void* (*get_mem_block)(struct mem_pool*, int block_id);
-    int (*allocate)(struct mem_pool*, int size);
-    void (*free)(struct mem_pool*, int block_id);
-    void (*dump)(struct mem_pool*);
+    void* arena;
+    size_t arena_size;     /* the peak of the packed blocks */
+    size_t arena_capacity; /* the size allocated, the arena only grows when the shapes change */
+    size_t lower_bound;    /* the max size of the blocks alive in one wave, no packing can do better */
+
+    int tensor_num;
+    int* tensor_block;     /* the block of each tensor, -1 if not planned */
+    size_t* tensor_offset; /* the offset of each tensor in its block */
 };
 
 void release_mem_pool(struct mem_pool* mem_pool);
 int alloc_exec_graph_mem(struct exec_graph* exec_graph);
+
+/* plan the tensors again with their new shapes, the tensors planned get new data */
+int realloc_exec_graph_mem(struct exec_graph* exec_graph);
+
+/* grow the shared mem to the max size of the nodes, returns 1 if the shared mem moved */
+int realloc_exec_graph_shared_mem(struct exec_graph* exec_graph);
 void free_exec_graph_mem(struct exec_graph* graph);
+
+/* check if the tensor is an output of the graph, which is read by the user after run */
+int is_graph_output_tensor(struct graph* ir_graph, const struct tensor* ir_tensor);
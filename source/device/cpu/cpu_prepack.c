@@ -0,0 +1,717 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "cpu_prepack.h"
+
+#include "cpu_define.h"
+#include "cpu_node.h"
+#include "cpu_graph.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "system/cpu.h"
+#include "utility/sys_port.h"
+#include "utility/vector.h"
+#include "utility/lock.h"
+#include "utility/log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <process.h>
+#endif
+
+#define PREPACK_MAGIC   "TGPACK"
+#define PREPACK_VERSION 2
+#define PREPACK_ALIGN   64
+#define PREPACK_NAME    32
+
+#define PREPACK_CLOSED 0 /* the nodes find and save nothing */
+#define PREPACK_OPEN   1 /* the nodes find their weights in the file or the share, and save the others */
+
+struct prepack_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_num;
+    uint64_t graph_hash;
+    int32_t isa;
+    int32_t num_thread;
+    int32_t mode;
+    int32_t weight_mode;
+};
+
+struct prepack_entry
+{
+    int32_t node_idx;
+    int32_t size;
+    uint64_t offset; /* from the file start, aligned by PREPACK_ALIGN */
+    char ops_name[PREPACK_NAME];
+};
+
+struct prepack_save
+{
+    struct prepack_entry entry;
+    const void* data;
+};
+
+/* the weights packed by a graph and its clones, kept while any of them is prerun */
+struct prepack_share
+{
+    struct graph* origin;
+    int ref_count;
+    struct vector* weight_list;
+};
+
+struct prepack_weight
+{
+    int node_idx;
+    uint64_t node_hash;
+    char ops_name[PREPACK_NAME];
+    void* data;
+    int size;
+};
+
+struct prepack_cache
+{
+    int state;
+    char* path; /* NULL for no cache file */
+    struct prepack_header header;
+
+    /* the mapped file, NULL for not found */
+    void* mem;
+    size_t mem_size;
+    int mem_mapped;
+
+    /* the weights to write to the file, NULL for the file found */
+    struct vector* save_list;
+
+    struct prepack_share* share;
+};
+
+static mutex_t share_mutex;
+static struct vector* share_list;
+
+/* a 64 bit hash of 4 lanes of words, it only needs to tell the graphs apart */
+static uint64_t hash_data(uint64_t hash, const void* data, size_t size)
+{
+    const uint64_t prime = 0x100000001b3ULL;
+    const uint8_t* ptr = (const uint8_t*)data;
+    uint64_t lane[4] = {hash, hash ^ 0x9e3779b97f4a7c15ULL, hash + size, ~hash};
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        for (int l = 0; l < 4; l++)
+        {
+            uint64_t word;
+            memcpy(&word, ptr + i + l * 8, 8);
+            lane[l] = (lane[l] ^ word) * prime;
+            lane[l] ^= lane[l] >> 29;
+        }
+    }
+
+    for (; i < size; i++)
+        lane[0] = (lane[0] ^ ptr[i]) * prime;
+
+    for (int l = 0; l < 4; l++)
+        hash = (hash ^ lane[l]) * prime;
+
+    return hash ^ (hash >> 32);
+}
+
+static uint64_t hash_value(uint64_t hash, int value)
+{
+    return hash_data(hash, &value, sizeof(value));
+}
+
+static uint64_t hash_tensor(uint64_t hash, const struct tensor* ir_tensor, int with_data)
+{
+    hash = hash_value(hash, ir_tensor->data_type);
+    hash = hash_value(hash, ir_tensor->layout);
+    hash = hash_value(hash, ir_tensor->dim_num);
+    hash = hash_data(hash, ir_tensor->dims, sizeof(int) * ir_tensor->dim_num);
+
+    if (with_data && ir_tensor->tensor_type == TENSOR_TYPE_CONST && ir_tensor->data != NULL)
+        hash = hash_data(hash, ir_tensor->data, (size_t)ir_tensor->elem_num * ir_tensor->elem_size);
+
+    return hash;
+}
+
+static uint64_t hash_exec_node(uint64_t hash, struct exec_node* exec_node, int with_data)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+
+    hash = hash_value(hash, ir_node->index);
+    hash = hash_value(hash, ir_node->op.type);
+
+    for (int j = 0; j < ir_node->input_num; j++)
+        hash = hash_tensor(hash, get_ir_graph_tensor(ir_graph, ir_node->input_tensors[j]), with_data);
+
+    for (int j = 0; j < ir_node->output_num; j++)
+        hash = hash_tensor(hash, get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]), with_data);
+
+    return hash;
+}
+
+/* the ops, the shapes and the layouts of the tensors, and the data of the const ones */
+static uint64_t hash_exec_graph(struct exec_graph* exec_graph)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    hash = hash_value(hash, exec_graph->mode);
+    hash = hash_value(hash, exec_graph->weight_mode);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, i);
+
+        hash = hash_exec_node(hash, exec_node, 1);
+    }
+
+    return hash;
+}
+
+/* the weights of the instances are the same, only the way they are packed may differ */
+static uint64_t hash_share_node(struct exec_graph* exec_graph, struct exec_node* exec_node)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    hash = hash_value(hash, exec_graph->mode);
+    hash = hash_value(hash, exec_graph->weight_mode);
+
+    return hash_exec_node(hash, exec_node, 0);
+}
+
+static void set_ops_name(char* name, struct exec_node* exec_node)
+{
+    const char* ops_name = exec_node->node_ops->name;
+
+    memset(name, 0, PREPACK_NAME);
+
+    if (ops_name != NULL)
+        strncpy(name, ops_name, PREPACK_NAME - 1);
+}
+
+static int check_cache_file(const struct prepack_cache* cache, const void* mem, size_t mem_size)
+{
+    const struct prepack_header* header = (const struct prepack_header*)mem;
+
+    if (mem_size < sizeof(struct prepack_header) || memcmp(header->magic, PREPACK_MAGIC, sizeof(PREPACK_MAGIC)) != 0)
+        return -1;
+
+    if (header->version != PREPACK_VERSION || header->graph_hash != cache->header.graph_hash || header->isa != cache->header.isa
+        || header->num_thread != cache->header.num_thread || header->mode != cache->header.mode
+        || header->weight_mode != cache->header.weight_mode)
+        return -1;
+
+    if (mem_size < sizeof(struct prepack_header) + (size_t)header->entry_num * sizeof(struct prepack_entry))
+        return -1;
+
+    const struct prepack_entry* entry = (const struct prepack_entry*)(header + 1);
+
+    for (uint32_t i = 0; i < header->entry_num; i++)
+    {
+        if (entry[i].size <= 0 || entry[i].offset % PREPACK_ALIGN != 0 || entry[i].offset + entry[i].size > mem_size)
+            return -1;
+    }
+
+    return 0;
+}
+
+static void unmap_cache_file(struct prepack_cache* cache)
+{
+    if (cache->mem == NULL)
+        return;
+
+#ifndef _MSC_VER
+    if (cache->mem_mapped)
+        munmap(cache->mem, cache->mem_size);
+    else
+#endif
+        sys_free(cache->mem);
+
+    cache->mem = NULL;
+    cache->mem_size = 0;
+}
+
+static int map_cache_file(struct prepack_cache* cache)
+{
+#ifndef _MSC_VER
+    int fd = open(cache->path, O_RDONLY);
+
+    if (fd < 0)
+        return -1;
+
+    struct stat stat;
+
+    if (fstat(fd, &stat) < 0 || stat.st_size <= 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    void* mem = mmap(NULL, stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (MAP_FAILED == mem)
+        return -1;
+
+    cache->mem = mem;
+    cache->mem_size = stat.st_size;
+    cache->mem_mapped = 1;
+#else
+    FILE* fp = fopen(cache->path, "rb");
+
+    if (NULL == fp)
+        return -1;
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    void* mem = size > 0 ? sys_malloc(size) : NULL;
+
+    if (NULL == mem || fread(mem, 1, size, fp) != (size_t)size)
+    {
+        sys_free(mem);
+        fclose(fp);
+        return -1;
+    }
+
+    fclose(fp);
+
+    cache->mem = mem;
+    cache->mem_size = size;
+    cache->mem_mapped = 0;
+#endif
+
+    if (check_cache_file(cache, cache->mem, cache->mem_size) < 0)
+    {
+        TLOG_WARNING("Tengine: prepack cache %s does not match the graph, it is written again.\n", cache->path);
+        unmap_cache_file(cache);
+        return -1;
+    }
+
+    return 0;
+}
+
+void init_prepack_share(void)
+{
+    init_mutex(&share_mutex);
+
+    share_list = create_vector(sizeof(struct prepack_share*), NULL);
+}
+
+void release_prepack_share(void)
+{
+    if (NULL != share_list)
+        release_vector(share_list);
+
+    share_list = NULL;
+
+    free_mutex(&share_mutex);
+}
+
+static struct prepack_share* get_prepack_share(struct graph* ir_graph)
+{
+    struct graph* origin = NULL != ir_graph->origin ? ir_graph->origin : ir_graph;
+    struct prepack_share* share = NULL;
+
+    lock_mutex(&share_mutex);
+
+    int share_num = get_vector_num(share_list);
+
+    for (int i = 0; i < share_num && NULL == share; i++)
+    {
+        struct prepack_share* item = *(struct prepack_share**)get_vector_data(share_list, i);
+
+        if (item->origin == origin)
+            share = item;
+    }
+
+    if (NULL == share)
+    {
+        share = (struct prepack_share*)sys_malloc(sizeof(struct prepack_share));
+
+        if (NULL != share)
+        {
+            share->origin = origin;
+            share->ref_count = 0;
+            share->weight_list = create_vector(sizeof(struct prepack_weight), NULL);
+
+            if (NULL == share->weight_list || push_vector_data(share_list, &share) < 0)
+            {
+                if (share->weight_list)
+                    release_vector(share->weight_list);
+                sys_free(share);
+                share = NULL;
+            }
+        }
+    }
+
+    if (NULL != share)
+        share->ref_count++;
+
+    unlock_mutex(&share_mutex);
+
+    return share;
+}
+
+static void put_prepack_share(struct prepack_share* share)
+{
+    lock_mutex(&share_mutex);
+
+    if (--share->ref_count > 0)
+    {
+        unlock_mutex(&share_mutex);
+        return;
+    }
+
+    int share_num = get_vector_num(share_list);
+
+    for (int i = 0; i < share_num; i++)
+    {
+        if (*(struct prepack_share**)get_vector_data(share_list, i) == share)
+        {
+            remove_vector_via_index(share_list, i);
+            break;
+        }
+    }
+
+    unlock_mutex(&share_mutex);
+
+    int weight_num = get_vector_num(share->weight_list);
+
+    for (int i = 0; i < weight_num; i++)
+    {
+        struct prepack_weight* weight = (struct prepack_weight*)get_vector_data(share->weight_list, i);
+        sys_free(weight->data);
+    }
+
+    release_vector(share->weight_list);
+    sys_free(share);
+}
+
+static int open_cache_file(struct prepack_cache* cache, struct exec_graph* exec_graph, const char* dir)
+{
+    memcpy(cache->header.magic, PREPACK_MAGIC, sizeof(PREPACK_MAGIC));
+    cache->header.version = PREPACK_VERSION;
+    cache->header.graph_hash = hash_exec_graph(exec_graph);
+    cache->header.isa = get_cpu_isa();
+    cache->header.num_thread = exec_graph->num_thread;
+    cache->header.mode = exec_graph->mode;
+    cache->header.weight_mode = exec_graph->weight_mode;
+
+    int path_size = (int)strlen(dir) + 80;
+    cache->path = (char*)sys_malloc(path_size);
+
+    if (NULL == cache->path)
+        return -1;
+
+    /* the graphs run in another mode keep files of their own */
+    snprintf(cache->path, path_size, "%s/tengine_%016llx_%x_%d_%d_%d.tmpack", dir, (unsigned long long)cache->header.graph_hash,
+             (unsigned int)cache->header.isa, (int)cache->header.num_thread, (int)cache->header.mode, (int)cache->header.weight_mode);
+
+    if (map_cache_file(cache) == 0)
+        return 0;
+
+    cache->save_list = create_vector(sizeof(struct prepack_save), NULL);
+
+    return NULL != cache->save_list ? 0 : -1;
+}
+
+int open_prepack_cache(struct exec_graph* exec_graph)
+{
+    if (get_vector_num(exec_graph->exec_node_list) == 0)
+        return 0;
+
+    struct prepack_cache* cache = (struct prepack_cache*)sys_malloc(sizeof(struct prepack_cache));
+
+    if (NULL == cache)
+        return -1;
+
+    memset(cache, 0, sizeof(struct prepack_cache));
+
+    exec_graph->prepack_cache = cache;
+
+    struct exec_node* exec_node = (struct exec_node*)get_vector_data(exec_graph->exec_node_list, 0);
+
+    cache->share = get_prepack_share(exec_node->ir_node->graph);
+
+    if (NULL == cache->share)
+        return -1;
+
+    const char* dir = getenv(TENGINE_PREPACK_CACHE);
+
+    if (NULL != dir && dir[0] != '\0' && open_cache_file(cache, exec_graph, dir) < 0)
+        return -1;
+
+    cache->state = PREPACK_OPEN;
+
+    return 0;
+}
+
+static int write_cache_file(struct prepack_cache* cache)
+{
+    int entry_num = get_vector_num(cache->save_list);
+
+    char* temp_path = (char*)sys_malloc(strlen(cache->path) + 32);
+
+    if (NULL == temp_path)
+        return -1;
+
+    /* the other writers, in this process or not, only see the whole file */
+#ifndef _MSC_VER
+    sprintf(temp_path, "%s.XXXXXX", cache->path);
+
+    FILE* fp = NULL;
+    int fd = mkstemp(temp_path);
+
+    if (fd >= 0)
+    {
+        fchmod(fd, 0644);
+        fp = fdopen(fd, "wb");
+
+        if (NULL == fp)
+        {
+            close(fd);
+            remove(temp_path);
+        }
+    }
+#else
+    static unsigned int temp_count = 0;
+
+    lock_mutex(&share_mutex);
+    unsigned int count = temp_count++;
+    unlock_mutex(&share_mutex);
+
+    sprintf(temp_path, "%s.%d.%u.tmp", cache->path, _getpid(), count);
+
+    FILE* fp = fopen(temp_path, "wb");
+#endif
+
+    if (NULL == fp)
+    {
+        sys_free(temp_path);
+        return -1;
+    }
+
+    struct prepack_header header = cache->header;
+    header.entry_num = entry_num;
+
+    uint64_t offset = sizeof(struct prepack_header) + (uint64_t)entry_num * sizeof(struct prepack_entry);
+
+    int ret = fwrite(&header, sizeof(header), 1, fp) == 1 ? 0 : -1;
+
+    for (int i = 0; i < entry_num && 0 == ret; i++)
+    {
+        struct prepack_save* save = (struct prepack_save*)get_vector_data(cache->save_list, i);
+
+        offset = (offset + PREPACK_ALIGN - 1) / PREPACK_ALIGN * PREPACK_ALIGN;
+        save->entry.offset = offset;
+        offset += save->entry.size;
+
+        if (fwrite(&save->entry, sizeof(struct prepack_entry), 1, fp) != 1)
+            ret = -1;
+    }
+
+    static const char zero[PREPACK_ALIGN] = {0};
+
+    for (int i = 0; i < entry_num && 0 == ret; i++)
+    {
+        struct prepack_save* save = (struct prepack_save*)get_vector_data(cache->save_list, i);
+        long pad = (long)save->entry.offset - ftell(fp);
+
+        if ((pad > 0 && fwrite(zero, pad, 1, fp) != 1) || fwrite(save->data, save->entry.size, 1, fp) != 1)
+            ret = -1;
+    }
+
+    if (fclose(fp) != 0)
+        ret = -1;
+
+    if (0 == ret && rename(temp_path, cache->path) != 0)
+        ret = -1;
+
+    if (0 != ret)
+        remove(temp_path);
+
+    sys_free(temp_path);
+
+    return ret;
+}
+
+int close_prepack_cache(struct exec_graph* exec_graph)
+{
+    struct prepack_cache* cache = (struct prepack_cache*)exec_graph->prepack_cache;
+
+    if (NULL == cache)
+        return 0;
+
+    if (NULL != cache->save_list && get_vector_num(cache->save_list) > 0 && write_cache_file(cache) < 0)
+        TLOG_WARNING("Tengine: write prepack cache %s failed.\n", cache->path);
+
+    cache->state = PREPACK_CLOSED;
+
+    /* the weights saved are kept by the share */
+    if (NULL != cache->save_list)
+        release_vector(cache->save_list);
+
+    cache->save_list = NULL;
+
+    return 0;
+}
+
+void release_prepack_cache(struct exec_graph* exec_graph)
+{
+    struct prepack_cache* cache = (struct prepack_cache*)exec_graph->prepack_cache;
+
+    if (NULL == cache)
+        return;
+
+    unmap_cache_file(cache);
+
+    if (NULL != cache->save_list)
+        release_vector(cache->save_list);
+
+    if (NULL != cache->share)
+        put_prepack_share(cache->share);
+
+    sys_free(cache->path);
+    sys_free(cache);
+
+    exec_graph->prepack_cache = NULL;
+}
+
+static void* find_file_weight(struct prepack_cache* cache, struct exec_node* exec_node, const char* ops_name, int* size)
+{
+    const struct prepack_header* header = (const struct prepack_header*)cache->mem;
+    const struct prepack_entry* entry = (const struct prepack_entry*)(header + 1);
+
+    for (uint32_t i = 0; i < header->entry_num; i++)
+    {
+        if (entry[i].node_idx == exec_node->ir_node->index && strncmp(entry[i].ops_name, ops_name, PREPACK_NAME) == 0)
+        {
+            *size = entry[i].size;
+            return (char*)cache->mem + entry[i].offset;
+        }
+    }
+
+    return NULL;
+}
+
+static void* find_share_weight(struct prepack_share* share, struct exec_node* exec_node, uint64_t node_hash,
+                               const char* ops_name, int* size)
+{
+    void* data = NULL;
+
+    lock_mutex(&share_mutex);
+
+    int weight_num = get_vector_num(share->weight_list);
+
+    for (int i = 0; i < weight_num && NULL == data; i++)
+    {
+        struct prepack_weight* weight = (struct prepack_weight*)get_vector_data(share->weight_list, i);
+
+        if (weight->node_idx == exec_node->ir_node->index && weight->node_hash == node_hash
+            && strncmp(weight->ops_name, ops_name, PREPACK_NAME) == 0)
+        {
+            *size = weight->size;
+            data = weight->data;
+        }
+    }
+
+    unlock_mutex(&share_mutex);
+
+    return data;
+}
+
+void* find_prepack_weight(struct exec_graph* exec_graph, struct exec_node* exec_node, int* size)
+{
+    struct prepack_cache* cache = (struct prepack_cache*)exec_graph->prepack_cache;
+
+    if (NULL == cache || cache->state != PREPACK_OPEN)
+        return NULL;
+
+    char ops_name[PREPACK_NAME];
+    set_ops_name(ops_name, exec_node);
+
+    void* data = NULL;
+
+    if (NULL != cache->mem)
+        data = find_file_weight(cache, exec_node, ops_name, size);
+
+    if (NULL == data)
+        data = find_share_weight(cache->share, exec_node, hash_share_node(exec_graph, exec_node), ops_name, size);
+
+    return data;
+}
+
+int save_prepack_weight(struct exec_graph* exec_graph, struct exec_node* exec_node, void* data, int size)
+{
+    struct prepack_cache* cache = (struct prepack_cache*)exec_graph->prepack_cache;
+
+    if (NULL == cache || cache->state != PREPACK_OPEN || NULL == data || size <= 0)
+        return 0;
+
+    if (NULL != cache->save_list)
+    {
+        struct prepack_save save;
+
+        memset(&save, 0, sizeof(save));
+        save.entry.node_idx = exec_node->ir_node->index;
+        save.entry.size = size;
+        set_ops_name(save.entry.ops_name, exec_node);
+        save.data = data;
+
+        push_vector_data(cache->save_list, &save);
+    }
+
+    struct prepack_weight weight;
+
+    memset(&weight, 0, sizeof(weight));
+    weight.node_idx = exec_node->ir_node->index;
+    weight.node_hash = hash_share_node(exec_graph, exec_node);
+    set_ops_name(weight.ops_name, exec_node);
+    weight.data = data;
+    weight.size = size;
+
+    lock_mutex(&share_mutex);
+
+    int ret = push_vector_data(cache->share->weight_list, &weight) < 0 ? 0 : 1;
+
+    unlock_mutex(&share_mutex);
+
+    return ret;
+}
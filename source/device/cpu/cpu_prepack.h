@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#pragma once
+
+struct exec_node;
+struct exec_graph;
+
+/*
+ * the prepack cache keeps the weights the nodes pack in prerun in a file of the directory
+ * set by TG_PREPACK_CACHE, see TENGINE_PREPACK_CACHE in cpu_define.h. the file is keyed by
+ * the hash of the graph and its weights, the input shapes, the precision, the cpu isa and
+ * the thread count, each packed weight by the node and the name of its node ops. the file
+ * is named tengine_<hash>_<isa>_<threads>_<mode>_<weight mode>.tmpack, see cpu_graph.h.
+ *
+ * the file is mapped read only when it is found, the nodes use the packed weights in it
+ * instead of packing them, and must not free or write them. otherwise the nodes save the
+ * weights they packed, and the file is written once the graph is prerun.
+ *
+ * the weights saved are given to the share of the graph and its clones, see clone_ir_graph(),
+ * the clones prerun later find them there. the share frees them once no instance is prerun.
+ */
+
+/* create the share list of the graphs, when the device is initialized */
+void init_prepack_share(void);
+
+/* release the share list of the graphs, when the device is released */
+void release_prepack_share(void);
+
+/* find or map the cache file of the graph and get its share, before the nodes are prerun */
+int open_prepack_cache(struct exec_graph* exec_graph);
+
+/* write the weights saved to a new cache file, after the nodes are prerun. the nodes prerun later find nothing */
+int close_prepack_cache(struct exec_graph* exec_graph);
+
+/* unmap the cache file and put the share, after the nodes are released */
+void release_prepack_cache(struct exec_graph* exec_graph);
+
+/* the packed weights of the node in the cache file or the share, NULL for none. the size of them is set to size */
+void* find_prepack_weight(struct exec_graph* exec_graph, struct exec_node* exec_node, int* size);
+
+/* save the packed weights of the node, 1 for the share taking them, then the node must not free them any more */
+int save_prepack_weight(struct exec_graph* exec_graph, struct exec_node* exec_node, void* data, int size);
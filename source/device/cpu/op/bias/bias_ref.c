@@ -27,34 +27,51 @@
 #include "graph/graph.h"
 #include "utility/sys_port.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
 #include <math.h>
 
+struct bias_job
+{
+    const float* in_data;
+    const float* bias;
+    float* out_data;
+    int size;
+};
+
+static void bias_channel(void* arg, int begin, int end)
+{
+    struct bias_job* job = (struct bias_job*)arg;
+
+    for (int c = begin; c < end; c++)
+    {
+        float* out_ptr = job->out_data + c * job->size;
+        const float* in_ptr = job->in_data + c * job->size;
+        for (int i = 0; i < job->size; i++)
+        {
+            out_ptr[i] = in_ptr[i] + job->bias[c];
+        }
+    }
+}
+
 int ref_bias_fp32(struct tensor* input_tensor, struct tensor* output_tensor, struct tensor* bias_tensor,
                   int num_thread)
 {
     int channels = input_tensor->dims[1];
     int h = input_tensor->dims[2];
     int w = input_tensor->dims[3];
-    int size = h * w;
 
-    float* in_data = (float*)input_tensor->data;
-    float* bias = (float*)bias_tensor->data;
-    float* out_data = (float*)output_tensor->data;
+    struct bias_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int c = 0; c < channels; c++)
-    {
-        float* out_ptr = out_data + c * size;
-        float* in_ptr = in_data + c * size;
-        for (int i = 0; i < size; i++)
-        {
-            out_ptr[i] = in_ptr[i] + bias[c];
-        }
-    }
+    job.in_data = (float*)input_tensor->data;
+    job.bias = (float*)bias_tensor->data;
+    job.out_data = (float*)output_tensor->data;
+    job.size = h * w;
+
+    parallel_for(bias_channel, &job, channels, num_thread);
 
     return 0;
 }
@@ -30,6 +30,7 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
@@ -37,6 +38,72 @@
 #include <math.h>
 #include <string.h>
 
+struct cast_job
+{
+    const void* idata;
+    void* odata;
+    float scale;
+    int zero_point;
+};
+
+static void cast_fp32_to_fp16(void* arg, int begin, int end)
+{
+    struct cast_job* job = (struct cast_job*)arg;
+    const fp32_t* idata = (const fp32_t*)job->idata;
+    fp16_t* odata = (fp16_t*)job->odata;
+
+    for (int i = begin; i < end; i++)
+    {
+        odata[i] = fp32_to_fp16(idata[i]);
+    }
+}
+
+static void cast_fp16_to_fp32(void* arg, int begin, int end)
+{
+    struct cast_job* job = (struct cast_job*)arg;
+    const fp16_t* idata = (const fp16_t*)job->idata;
+    fp32_t* odata = (fp32_t*)job->odata;
+
+    for (int i = begin; i < end; i++)
+    {
+        odata[i] = fp16_to_fp32(idata[i]);
+    }
+}
+
+static void cast_fp32_to_uint8(void* arg, int begin, int end)
+{
+    struct cast_job* job = (struct cast_job*)arg;
+    const float* idata = (const float*)job->idata;
+    uint8_t* odata = (uint8_t*)job->odata;
+
+    for (int i = begin; i < end; i++)
+    {
+        int val = (int)(roundf(idata[i] / job->scale)) + job->zero_point;
+
+        if (255 >= val && 0 <= val)
+            odata[i] = (uint8_t)val;
+        else
+        {
+            if (255 < val)
+                odata[i] = 255;
+            if (0 > val)
+                odata[i] = 0;
+        }
+    }
+}
+
+static void cast_uint8_to_fp32(void* arg, int begin, int end)
+{
+    struct cast_job* job = (struct cast_job*)arg;
+    const uint8_t* idata = (const uint8_t*)job->idata;
+    float* odata = (float*)job->odata;
+
+    for (int i = begin; i < end; i++)
+    {
+        odata[i] = (float)(idata[i] - job->zero_point) * job->scale;
+    }
+}
+
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     return 0;
@@ -90,59 +157,32 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
         return -1;
     }
 
+    struct cast_job job;
+
+    job.idata = input_tensor->data;
+    job.odata = output_tensor->data;
+    job.scale = input_tensor->scale;
+    job.zero_point = input_tensor->zero_point;
+
     if (type_from == TENGINE_DT_FP32 && type_to == TENGINE_DT_FP16)
     {
-        fp32_t* idata = (fp32_t*)input_tensor->data;
-        fp16_t* odata = (fp16_t*)output_tensor->data;
-
-#pragma omp parallel for num_threads(num_thread)
-        for (int i = 0; i < input_tensor->elem_num; i++)
-        {
-            odata[i] = fp32_to_fp16(idata[i]);
-        }
+        parallel_for(cast_fp32_to_fp16, &job, input_tensor->elem_num, num_thread);
 
         return 0;
     }
 
     if (type_from == TENGINE_DT_FP16 && type_to == TENGINE_DT_FP32)
     {
-        fp16_t* idata = (fp16_t*)input_tensor->data;
-        fp32_t* odata = (fp32_t*)output_tensor->data;
-
-#pragma omp parallel for num_threads(num_thread)
-        for (int i = 0; i < input_tensor->elem_num; i++)
-        {
-            odata[i] = fp16_to_fp32(idata[i]);
-        }
+        parallel_for(cast_fp16_to_fp32, &job, input_tensor->elem_num, num_thread);
 
         return 0;
     }
 
     if (type_from == TENGINE_DT_FP32 && type_to == TENGINE_DT_UINT8)
     {
-        float* idata = (float*)input_tensor->data;
-        uint8_t* odata = (uint8_t*)output_tensor->data;
-
         if (1 == input_tensor->quant_param_num)
         {
-            float scale = input_tensor->scale;
-            int zero_point = input_tensor->zero_point;
-
-#pragma omp parallel for num_threads(num_thread)
-            for (int i = 0; i < input_tensor->elem_num; i++)
-            {
-                int val = (int)(roundf(idata[i] / scale)) + zero_point;
-
-                if (255 >= val && 0 <= val)
-                    odata[i] = (uint8_t)val;
-                else
-                {
-                    if (255 < val)
-                        odata[i] = 255;
-                    if (0 > val)
-                        odata[i] = 0;
-                }
-            }
+            parallel_for(cast_fp32_to_uint8, &job, input_tensor->elem_num, num_thread);
 
             return 0;
         }
@@ -150,19 +190,9 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
 
     if (type_from == TENGINE_DT_UINT8 && type_to == TENGINE_DT_FP32)
     {
-        uint8_t* idata = (uint8_t*)input_tensor->data;
-        float* odata = (float*)output_tensor->data;
-
         if (1 == input_tensor->quant_param_num)
         {
-            float scale = input_tensor->scale;
-            int zero_point = input_tensor->zero_point;
-
-#pragma omp parallel for num_threads(num_thread)
-            for (int i = 0; i < input_tensor->elem_num; i++)
-            {
-                odata[i] = (float)(idata[i] - zero_point) * scale;
-            }
+            parallel_for(cast_uint8_to_fp32, &job, input_tensor->elem_num, num_thread);
 
             return 0;
         }
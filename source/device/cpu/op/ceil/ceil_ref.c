@@ -29,12 +29,37 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
 #include <math.h>
 
+struct ceil_job
+{
+    const float* input_data;
+    float* out_data;
+    int c_step;
+    int size;
+};
+
+static void ceil_channel(void* arg, int begin, int end)
+{
+    struct ceil_job* job = (struct ceil_job*)arg;
+
+    for (int q = begin; q < end; q++)
+    {
+        const float* src = job->input_data + job->c_step * q;
+        float* dst = job->out_data + job->c_step * q;
+
+        for (int i = 0; i < job->size; i++)
+        {
+            dst[i] = ceilf(src[i]);
+        }
+    }
+}
+
 int ref_ceil_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
 {
     // dims size = 2 or 3
@@ -60,20 +85,14 @@ int ref_ceil_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int
         int size = h * w;
         int c_step = h * w;
 
-        float* input_data = (float*)input_tensor->data;
-        float* out_data = (float*)output_tensor->data;
+        struct ceil_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-        for (int q = 0; q < channels; q++)
-        {
-            float* src = input_data + c_step * q;
-            float* dst = out_data + c_step * q;
+        job.input_data = (float*)input_tensor->data;
+        job.out_data = (float*)output_tensor->data;
+        job.c_step = c_step;
+        job.size = size;
 
-            for (int i = 0; i < size; i++)
-            {
-                dst[i] = ceilf(src[i]);
-            }
-        }
+        parallel_for(ceil_channel, &job, channels, num_thread);
 
         return 0;
     }
@@ -122,17 +141,14 @@ int ref_ceil_uint8(struct tensor* input_tensor, struct tensor* output_tensor, in
         int size = h * w;
         int c_step = h * w;
 
-#pragma omp parallel for num_threads(num_thread)
-        for (int q = 0; q < channels; q++)
-        {
-            float* src = input_data + c_step * q;
-            float* dst = out_data + c_step * q;
+        struct ceil_job job;
 
-            for (int i = 0; i < size; i++)
-            {
-                dst[i] = ceil(src[i]);
-            }
-        }
+        job.input_data = input_data;
+        job.out_data = out_data;
+        job.c_step = c_step;
+        job.size = size;
+
+        parallel_for(ceil_channel, &job, channels, num_thread);
 
         // return 0;
     }
@@ -38,6 +38,37 @@
 
 #include "concat_kernel_ref.h"
 
+#include <string.h>
+
+/* the inputs are consecutive in the output when the concat is along the outer dim, the input of another quantization is not */
+static int get_view_offset(struct graph* ir_graph, struct node* ir_node, int input_slot, size_t* offset)
+{
+    struct concat_param* concat_param = (struct concat_param*)ir_node->op.param_mem;
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_slot]);
+    int axis = concat_param->axis < 0 ? concat_param->axis + output_tensor->dim_num : concat_param->axis;
+
+    if (!can_view_ir_tensor(output_tensor, input_tensor))
+        return -1;
+
+    for (int i = 0; i < axis; i++)
+    {
+        if (output_tensor->dims[i] != 1)
+            return -1;
+    }
+
+    *offset = 0;
+
+    for (int i = 0; i < input_slot; i++)
+    {
+        struct tensor* prev_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+
+        *offset += (size_t)prev_tensor->elem_num * output_tensor->elem_size;
+    }
+
+    return 0;
+}
+
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     return 0;
@@ -54,6 +85,37 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct graph* ir_graph = ir_node->graph;
     struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
     struct concat_param* concat_param = (struct concat_param*)ir_node->op.param_mem;
+    int view_num = 0;
+
+    /* the inputs being slices of the output, which the mem pool may have placed in it */
+    for (int i = 0; i < ir_node->input_num; i++)
+    {
+        struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+        size_t offset;
+
+        if (get_view_offset(ir_graph, ir_node, i, &offset) < 0)
+            break;
+
+        view_num++;
+    }
+
+    /* along the outer dim every input is a slice of the output, copy over the slices not placed yet */
+    if (view_num == ir_node->input_num)
+    {
+        for (int i = 0; i < ir_node->input_num; i++)
+        {
+            struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+            size_t offset;
+
+            get_view_offset(ir_graph, ir_node, i, &offset);
+
+            uint8_t* slice = (uint8_t*)output_tensor->data + offset;
+            if (input_tensor->data != slice)
+                memcpy(slice, input_tensor->data, (size_t)input_tensor->elem_num * input_tensor->elem_size);
+        }
+
+        return 0;
+    }
 
     int ret = -1;
     if (output_tensor->data_type == TENGINE_DT_FP32)
@@ -74,6 +136,13 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     return ret;
 }
 
+static int view_input(struct node_ops* node_ops, struct exec_node* exec_node, int input_slot, size_t* offset)
+{
+    struct node* ir_node = exec_node->ir_node;
+
+    return get_view_offset(ir_node->graph, ir_node, input_slot, offset);
+}
+
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
     return OPS_SCORE_CANDO;
@@ -86,7 +155,8 @@ static struct node_ops hcl_node_ops = {
     .postrun = NULL,
     .init_node = init_node,
     .release_node = release_node,
-    .score = score};
+    .score = score,
+    .view_input = view_input};
 
 int register_concat_ref_op()
 {
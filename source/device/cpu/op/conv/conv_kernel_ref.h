@@ -43,4 +43,7 @@ int ref_conv_int8(struct tensor* input_tensor, struct tensor* output_tensor, str
 int ref_conv_uint8(struct tensor* input_tensor, struct tensor* output_tensor, struct tensor* kernel,
                    struct tensor* bias, struct conv_param* conv_param);
 
+/* the residual input fused from an eltwise sum, added before the activation */
+void ref_conv_residual_fp32(struct tensor* residual_tensor, struct tensor* output_tensor, int activation);
+
 #endif
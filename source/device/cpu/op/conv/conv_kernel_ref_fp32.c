@@ -37,6 +37,8 @@
 
 #include "conv_kernel_ref.h"
 
+#include <math.h>
+
 int ref_conv_fp32(struct tensor* input_tensor, struct tensor* output_tensor, struct tensor* kernel,
                   struct tensor* bias, struct conv_param* conv_param)
 {
@@ -137,3 +139,29 @@ int ref_conv_fp32(struct tensor* input_tensor, struct tensor* output_tensor, str
 
     return 0;
 }
+
+void ref_conv_residual_fp32(struct tensor* residual_tensor, struct tensor* output_tensor, int activation)
+{
+    const float* residual = (const float*)residual_tensor->data;
+    float* output = (float*)output_tensor->data;
+    int size = output_tensor->elem_num;
+
+    /* as the activation of ref_conv_fp32 */
+    float min = activation == 1 ? -1.f : 0.f;
+    float max = activation == 1 ? 1.f : (activation == 6 ? 6.f : INFINITY);
+
+    if (activation < 0)
+    {
+        for (int i = 0; i < size; i++)
+            output[i] += residual[i];
+    }
+    else
+    {
+        for (int i = 0; i < size; i++)
+        {
+            float v = output[i] + residual[i];
+            v = v < min ? min : v;
+            output[i] = v > max ? max : v;
+        }
+    }
+}
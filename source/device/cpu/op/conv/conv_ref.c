@@ -58,6 +58,26 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
 
     struct conv_param* conv_param = (struct conv_param*)ir_node->op.param_mem;
 
+    /* the residual is added before the activation */
+    if (ir_node->input_num > 3)
+    {
+        struct tensor* residual_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]);
+        struct conv_param param = *conv_param;
+
+        if (input_tensor->data_type != TENGINE_DT_FP32)
+        {
+            TLOG_ERR("Input data type %d not to be supported with a residual.\n", input_tensor->data_type);
+            return -1;
+        }
+
+        param.activation = -1;
+
+        int ret = ref_conv_fp32(input_tensor, output_tensor, weight_tensor, bias_tensor, &param);
+        ref_conv_residual_fp32(residual_tensor, output_tensor, conv_param->activation);
+
+        return ret;
+    }
+
     int ret = 0;
     if (input_tensor->data_type == TENGINE_DT_FP32)
         ret = ref_conv_fp32(input_tensor, output_tensor, weight_tensor, bias_tensor, conv_param);
@@ -161,7 +181,7 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
     int dims[4];
     dims[0] = n;
 
-    if (output_tensor->dims[1] != out_c || output_tensor->dims[2] != out_h || output_tensor->dims[3] != out_w)
+    if (output_tensor->dims[0] != n || output_tensor->dims[1] != out_c || output_tensor->dims[2] != out_h || output_tensor->dims[3] != out_w)
     {
         dims[1] = out_c;
         dims[2] = out_h;
@@ -197,6 +197,10 @@ static int release_node(struct node_ops* node_ops, struct exec_node* exec_node,
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
+    /* the residual input fused from an eltwise sum is not supported */
+    if (exec_node->input_num > 3)
+        return 0;
+
     struct conv_param* param = (struct conv_param*)exec_node->op.param_mem;
     struct node* ir_node = exec_node;
     struct graph* ir_graph = ir_node->graph;
@@ -24,6 +24,7 @@
  */
 
 #include "conv_kernel_arm.h"
+#include "device/cpu/op/conv/conv_kernel_ref.h"
 
 #include "convolution_param.h"
 
@@ -154,13 +155,22 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     /* fp32 run */
     if (exec_graph->mode == TENGINE_MODE_FP32 || exec_graph->mode == TENGINE_MODE_UINT8)
     {
-        if (conv_hcl_run(input_tensor, weight_tensor, bias_tensor, output_tensor, conv_priv_info, conv_param, num_thread,
+        /* the residual is added before the activation */
+        struct conv_param residual_param = *conv_param;
+        if (ir_node->input_num > 3)
+            residual_param.activation = -1;
+
+        if (conv_hcl_run(input_tensor, weight_tensor, bias_tensor, output_tensor, conv_priv_info, &residual_param, num_thread,
                          cpu_affinity)
             < 0)
         {
             TLOG_ERR("hcl conv run failed\n");
             return -1;
         }
+
+        if (ir_node->input_num > 3)
+            ref_conv_residual_fp32(get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]), output_tensor,
+                                   conv_param->activation);
     }
     /* armv8.2 fp16 run */
 #if __ARM_FEATURE_FP16_VECTOR_ARITHMETIC
@@ -295,7 +305,7 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
     dims[0] = n;
     if (ir_graph->graph_layout == TENGINE_LAYOUT_NCHW)
     {
-        if (output_tensor->dims[1] != out_c || output_tensor->dims[2] != out_h || output_tensor->dims[3] != out_w)
+        if (output_tensor->dims[0] != n || output_tensor->dims[1] != out_c || output_tensor->dims[2] != out_h || output_tensor->dims[3] != out_w)
         {
             dims[1] = out_c;
             dims[2] = out_h;
@@ -312,7 +322,7 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
     }
     else
     {
-        if (output_tensor->dims[1] != out_h || output_tensor->dims[2] != out_w || output_tensor->dims[3] != out_c)
+        if (output_tensor->dims[0] != n || output_tensor->dims[1] != out_h || output_tensor->dims[2] != out_w || output_tensor->dims[3] != out_c)
         {
             dims[1] = out_h;
             dims[2] = out_w;
@@ -458,6 +468,9 @@ static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struc
 #endif
     if (group > 1 && in_c == 1 && out_c == 1)
         return 0;
+    /* the residual input is only supported for fp32 */
+    if (ir_node->input_num > 3 && input_tensor->data_type != TENGINE_DT_FP32)
+        return 0;
     return OPS_SCORE_PREFER;
 }
 
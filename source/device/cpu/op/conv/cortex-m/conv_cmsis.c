@@ -131,6 +131,10 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
+    /* the residual input fused from an eltwise sum is not supported */
+    if (exec_node->input_num > 3)
+        return 0;
+
     return OPS_SCORE_BEST;
 }
 
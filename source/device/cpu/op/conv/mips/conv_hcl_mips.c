@@ -221,6 +221,10 @@ static int release_node(struct node_ops* node_ops, struct exec_node* exec_node,
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
+    /* the residual input fused from an eltwise sum is not supported */
+    if (exec_node->input_num > 3)
+        return 0;
+
     struct node* ir_node = exec_node;
     struct graph* ir_graph = ir_node->graph;
     struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
@@ -30,6 +30,8 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
@@ -92,60 +94,150 @@ static void pad_int8(int8_t* input, int8_t* output, int in_h, int in_w, int out_
     }
 }
 
-static int conv3x3s1_int8_sse(struct tensor* input_tensor, struct tensor* weight_tensor, struct tensor* bias_tensor,
-                              struct tensor* output_tensor, struct conv_param* param, int num_thread)
+struct conv3x3_int8_job
 {
-    int inch = input_tensor->dims[1];
-    int inh = input_tensor->dims[2];
-    int inw = input_tensor->dims[3];
-    int in_hw = inh * inw;
+    int8_t* input_int8;
+    int8_t* input_tmp;
+    const signed char* kernel;
+    int32_t* output_int32;
+    float* output_fp32;
+    int8_t* output_int8;
+    int32_t* bias_int32;
+    float* kernel_scales;
+    float input_scale;
+    float output_scale;
+    int inch;
+    int inh;
+    int inw;
+    int inh_tmp;
+    int inw_tmp;
+    int pad_h;
+    int pad_w;
+    int outh;
+    int outw;
+    int out_hw;
+    int tailstep;
+};
+
+static void pad_int8_channel(void* arg, int begin, int end)
+{
+    struct conv3x3_int8_job* job = (struct conv3x3_int8_job*)arg;
+    int8_t* input_int8 = job->input_int8;
+    int8_t* input_tmp = job->input_tmp;
+    int inh = job->inh;
+    int inw = job->inw;
+    int inh_tmp = job->inh_tmp;
+    int inw_tmp = job->inw_tmp;
+    int pad_h = job->pad_h;
+    int pad_w = job->pad_w;
+
+    for (int g = begin; g < end; g++)
+    {
+        int8_t* pad_in = input_int8 + g * inh * inw;
+        int8_t* pad_out = input_tmp + g * inh_tmp * inw_tmp;
+        pad_int8(pad_in, pad_out, inh, inw, inh_tmp, inw_tmp, pad_h, pad_w, 0);
+    }
+}
 
-    int outch = output_tensor->dims[1];
-    int outh = output_tensor->dims[2];
-    int outw = output_tensor->dims[3];
-    int out_hw = outh * outw;
-    int out_size = output_tensor->elem_num;
+static void dequant_channel(void* arg, int begin, int end)
+{
+    struct conv3x3_int8_job* job = (struct conv3x3_int8_job*)arg;
+    int32_t* output_int32 = job->output_int32;
+    float* output_fp32 = job->output_fp32;
+    int32_t* bias_int32 = job->bias_int32;
+    float* kernel_scales = job->kernel_scales;
+    float input_scale = job->input_scale;
+    int out_hw = job->out_hw;
+
+    for (int i = begin; i < end; i++)
+    {
+        for (int j = 0; j < out_hw; j++)
+        {
+            int output_off = i * out_hw + j;
+            if (bias_int32)
+                output_fp32[output_off] = (float)(output_int32[output_off] + bias_int32[i]) * input_scale * kernel_scales[i];
+            else
+                output_fp32[output_off] = (float)output_int32[output_off] * input_scale * kernel_scales[i];
+        }
+    }
+}
 
-    int pad_w = param->pad_w0;
-    int pad_h = param->pad_h0;
+static void relu_channel(void* arg, int begin, int end)
+{
+    struct conv3x3_int8_job* job = (struct conv3x3_int8_job*)arg;
+    float* output_fp32 = job->output_fp32;
+    int out_hw = job->out_hw;
 
-    int32_t* output_int32 = (int32_t*)sys_malloc(out_size * sizeof(int32_t));
-    memset(output_int32, 0, out_size * sizeof(int32_t));
-    float* output_fp32 = (float*)sys_malloc(out_size * sizeof(float));
+    for (int i = begin; i < end; i++)
+    {
+        for (int j = 0; j < out_hw; j++)
+        {
+            int output_off = i * out_hw + j;
 
-    int8_t* output_int8 = (int8_t*)output_tensor->data;
-    int8_t* input_int8 = (int8_t*)input_tensor->data;
-    int32_t* bias_int32 = NULL;
-    if (bias_tensor)
-        bias_int32 = (int32_t*)bias_tensor->data;
+            if (output_fp32[output_off] < 0)
+                output_fp32[output_off] = 0;
+        }
+    }
+}
 
-    /* get scale value of quantizaiton */
-    float input_scale = input_tensor->scale;
-    float* kernel_scales = weight_tensor->scale_list;
-    float output_scale = output_tensor->scale;
+static void relu6_channel(void* arg, int begin, int end)
+{
+    struct conv3x3_int8_job* job = (struct conv3x3_int8_job*)arg;
+    float* output_fp32 = job->output_fp32;
+    int out_hw = job->out_hw;
 
-    const signed char* kernel = (const signed char*)weight_tensor->data;
+    for (int i = begin; i < end; i++)
+    {
+        for (int j = 0; j < out_hw; j++)
+        {
+            int output_off = i * out_hw + j;
 
-    /* pading */
-    int inh_tmp = inh + pad_h + pad_h;
-    int inw_tmp = inw + pad_w + pad_w;
-    int8_t* input_tmp = NULL;
-    if (inh_tmp == inh && inw_tmp == inw)
-        input_tmp = input_int8;
-    else
+            if (output_fp32[output_off] < 0)
+                output_fp32[output_off] = 0;
+            if (output_fp32[output_off] > 6)
+                output_fp32[output_off] = 6;
+        }
+    }
+}
+
+static void quant_channel(void* arg, int begin, int end)
+{
+    struct conv3x3_int8_job* job = (struct conv3x3_int8_job*)arg;
+    float* output_fp32 = job->output_fp32;
+    int8_t* output_int8 = job->output_int8;
+    float output_scale = job->output_scale;
+    int out_hw = job->out_hw;
+
+    for (int i = begin; i < end; i++)
     {
-        input_tmp = (int8_t*)sys_malloc((size_t)inh_tmp * inw_tmp * inch * sizeof(int8_t));
-#pragma omp parallel for num_threads(num_thread)
-        for (int g = 0; g < inch; g++)
+        for (int j = 0; j < out_hw; j++)
         {
-            int8_t* pad_in = input_int8 + g * inh * inw;
-            int8_t* pad_out = input_tmp + g * inh_tmp * inw_tmp;
-            pad_int8(pad_in, pad_out, inh, inw, inh_tmp, inw_tmp, pad_h, pad_w, 0);
+            int output_off = i * out_hw + j;
+
+            int32_t data_i32 = (int32_t)(round(output_fp32[output_off] / output_scale));
+            if (data_i32 > 127)
+                data_i32 = 127;
+            else if (data_i32 < -127)
+                data_i32 = -127;
+            output_int8[output_off] = (int8_t)data_i32;
         }
     }
+}
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int p = 0; p < outch; p++)
+static void conv3x3s1_int8_channel(void* arg, int begin, int end)
+{
+    struct conv3x3_int8_job* job = (struct conv3x3_int8_job*)arg;
+    const signed char* kernel = job->kernel;
+    int32_t* output_int32 = job->output_int32;
+    int8_t* input_tmp = job->input_tmp;
+    int inch = job->inch;
+    int inh_tmp = job->inh_tmp;
+    int inw_tmp = job->inw_tmp;
+    int outh = job->outh;
+    int outw = job->outw;
+    int out_hw = job->out_hw;
+
+    for (int p = begin; p < end; p++)
     {
         int32_t* out0 = output_int32 + p * out_hw;
         int8_t* kernel0 = (int8_t*)kernel + p * inch * 9;
@@ -194,82 +286,9 @@ static int conv3x3s1_int8_sse(struct tensor* input_tensor, struct tensor* weight
             kernel0 += 9;
         }
     }
-
-    /* process bias and dequant output from int32 to fp32 */
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = 0; i < outch; i++)
-    {
-        for (int j = 0; j < outh * outw; j++)
-        {
-            int output_off = i * (outh * outw) + j;
-            if (bias_tensor)
-                output_fp32[output_off] = (float)(output_int32[output_off] + bias_int32[i]) * input_scale * kernel_scales[i];
-            else
-                output_fp32[output_off] = (float)output_int32[output_off] * input_scale * kernel_scales[i];
-        }
-    }
-
-    /* process activation relu */
-    if (param->activation == 0)
-    {
-#pragma omp parallel for num_threads(num_thread)
-        for (int i = 0; i < outch; i++)
-        {
-            for (int j = 0; j < outh * outw; j++)
-            {
-                int output_off = i * (outh * outw) + j;
-
-                if (output_fp32[output_off] < 0)
-                    output_fp32[output_off] = 0;
-            }
-        }
-    }
-
-    /* process activation relu6 */
-    if (param->activation > 0)
-    {
-#pragma omp parallel for num_threads(num_thread)
-        for (int i = 0; i < outch; i++)
-        {
-            for (int j = 0; j < outh * outw; j++)
-            {
-                int output_off = i * (outh * outw) + j;
-
-                if (output_fp32[output_off] < 0)
-                    output_fp32[output_off] = 0;
-                if (output_fp32[output_off] > 6)
-                    output_fp32[output_off] = 6;
-            }
-        }
-    }
-
-    /* quant from fp32 to int8 */
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = 0; i < outch; i++)
-    {
-        for (int j = 0; j < outh * outw; j++)
-        {
-            int output_off = i * (outh * outw) + j;
-
-            int32_t data_i32 = (int32_t)(round(output_fp32[output_off] / output_scale));
-            if (data_i32 > 127)
-                data_i32 = 127;
-            else if (data_i32 < -127)
-                data_i32 = -127;
-            output_int8[output_off] = (int8_t)data_i32;
-        }
-    }
-
-    sys_free(output_int32);
-    sys_free(output_fp32);
-
-    if (!(inh_tmp == inh && inw_tmp == inw))
-        sys_free(input_tmp);
-
-    return 0;
 }
 
-static int conv3x3s2_int8_sse(struct tensor* input_tensor, struct tensor* weight_tensor, struct tensor* bias_tensor,
+static int conv3x3s1_int8_sse(struct tensor* input_tensor, struct tensor* weight_tensor, struct tensor* bias_tensor,
                               struct tensor* output_tensor, struct conv_param* param, int num_thread)
 {
     int inch = input_tensor->dims[1];
@@ -310,21 +329,79 @@ static int conv3x3s2_int8_sse(struct tensor* input_tensor, struct tensor* weight
     if (inh_tmp == inh && inw_tmp == inw)
         input_tmp = input_int8;
     else
-    {
         input_tmp = (int8_t*)sys_malloc((size_t)inh_tmp * inw_tmp * inch * sizeof(int8_t));
-#pragma omp parallel for num_threads(num_thread)
-        for (int g = 0; g < inch; g++)
-        {
-            int8_t* pad_in = input_int8 + g * inh * inw;
-            int8_t* pad_out = input_tmp + g * inh_tmp * inw_tmp;
-            pad_int8(pad_in, pad_out, inh, inw, inh_tmp, inw_tmp, pad_h, pad_w, 0);
-        }
+
+    struct conv3x3_int8_job job;
+
+    job.input_int8 = input_int8;
+    job.input_tmp = input_tmp;
+    job.kernel = kernel;
+    job.output_int32 = output_int32;
+    job.output_fp32 = output_fp32;
+    job.output_int8 = output_int8;
+    job.bias_int32 = bias_int32;
+    job.kernel_scales = kernel_scales;
+    job.input_scale = input_scale;
+    job.output_scale = output_scale;
+    job.inch = inch;
+    job.inh = inh;
+    job.inw = inw;
+    job.inh_tmp = inh_tmp;
+    job.inw_tmp = inw_tmp;
+    job.pad_h = pad_h;
+    job.pad_w = pad_w;
+    job.outh = outh;
+    job.outw = outw;
+    job.out_hw = out_hw;
+    job.tailstep = 0;
+
+    if (input_tmp != input_int8)
+        parallel_for(pad_int8_channel, &job, inch, num_thread);
+
+    parallel_for(conv3x3s1_int8_channel, &job, outch, num_thread);
+
+    /* process bias and dequant output from int32 to fp32 */
+    parallel_for(dequant_channel, &job, outch, num_thread);
+
+    /* process activation relu */
+    if (param->activation == 0)
+    {
+        parallel_for(relu_channel, &job, outch, num_thread);
     }
 
-    int tailstep = inw_tmp - 2 * outw + inw_tmp;
+    /* process activation relu6 */
+    if (param->activation > 0)
+    {
+        parallel_for(relu6_channel, &job, outch, num_thread);
+    }
+
+    /* quant from fp32 to int8 */
+    parallel_for(quant_channel, &job, outch, num_thread);
+
+    sys_free(output_int32);
+    sys_free(output_fp32);
+
+    if (!(inh_tmp == inh && inw_tmp == inw))
+        sys_free(input_tmp);
+
+    return 0;
+}
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int p = 0; p < outch; p++)
+static void conv3x3s2_int8_channel(void* arg, int begin, int end)
+{
+    struct conv3x3_int8_job* job = (struct conv3x3_int8_job*)arg;
+    const signed char* kernel = job->kernel;
+    int32_t* output_int32 = job->output_int32;
+    int8_t* input_tmp = job->input_tmp;
+    int inch = job->inch;
+    int inh_tmp = job->inh_tmp;
+    int inw_tmp = job->inw_tmp;
+    int outh = job->outh;
+    int outw = job->outw;
+    int out_hw = job->out_hw;
+    int tailstep = job->tailstep;
+
+    for (int p = begin; p < end; p++)
     {
         int32_t* out0 = output_int32 + p * out_hw;
         int8_t* kernel0 = (int8_t*)kernel + p * inch * 9;
@@ -373,71 +450,97 @@ static int conv3x3s2_int8_sse(struct tensor* input_tensor, struct tensor* weight
             kernel0 += 9;
         }
     }
+}
+
+static int conv3x3s2_int8_sse(struct tensor* input_tensor, struct tensor* weight_tensor, struct tensor* bias_tensor,
+                              struct tensor* output_tensor, struct conv_param* param, int num_thread)
+{
+    int inch = input_tensor->dims[1];
+    int inh = input_tensor->dims[2];
+    int inw = input_tensor->dims[3];
+    int in_hw = inh * inw;
+
+    int outch = output_tensor->dims[1];
+    int outh = output_tensor->dims[2];
+    int outw = output_tensor->dims[3];
+    int out_hw = outh * outw;
+    int out_size = output_tensor->elem_num;
+
+    int pad_w = param->pad_w0;
+    int pad_h = param->pad_h0;
+
+    int32_t* output_int32 = (int32_t*)sys_malloc(out_size * sizeof(int32_t));
+    memset(output_int32, 0, out_size * sizeof(int32_t));
+    float* output_fp32 = (float*)sys_malloc(out_size * sizeof(float));
+
+    int8_t* output_int8 = (int8_t*)output_tensor->data;
+    int8_t* input_int8 = (int8_t*)input_tensor->data;
+    int32_t* bias_int32 = NULL;
+    if (bias_tensor)
+        bias_int32 = (int32_t*)bias_tensor->data;
+
+    /* get scale value of quantizaiton */
+    float input_scale = input_tensor->scale;
+    float* kernel_scales = weight_tensor->scale_list;
+    float output_scale = output_tensor->scale;
+
+    const signed char* kernel = (const signed char*)weight_tensor->data;
+
+    /* pading */
+    int inh_tmp = inh + pad_h + pad_h;
+    int inw_tmp = inw + pad_w + pad_w;
+    int8_t* input_tmp = NULL;
+    if (inh_tmp == inh && inw_tmp == inw)
+        input_tmp = input_int8;
+    else
+        input_tmp = (int8_t*)sys_malloc((size_t)inh_tmp * inw_tmp * inch * sizeof(int8_t));
+
+    struct conv3x3_int8_job job;
+
+    job.input_int8 = input_int8;
+    job.input_tmp = input_tmp;
+    job.kernel = kernel;
+    job.output_int32 = output_int32;
+    job.output_fp32 = output_fp32;
+    job.output_int8 = output_int8;
+    job.bias_int32 = bias_int32;
+    job.kernel_scales = kernel_scales;
+    job.input_scale = input_scale;
+    job.output_scale = output_scale;
+    job.inch = inch;
+    job.inh = inh;
+    job.inw = inw;
+    job.inh_tmp = inh_tmp;
+    job.inw_tmp = inw_tmp;
+    job.pad_h = pad_h;
+    job.pad_w = pad_w;
+    job.outh = outh;
+    job.outw = outw;
+    job.out_hw = out_hw;
+    job.tailstep = inw_tmp - 2 * outw + inw_tmp;
+
+    if (input_tmp != input_int8)
+        parallel_for(pad_int8_channel, &job, inch, num_thread);
+
+    parallel_for(conv3x3s2_int8_channel, &job, outch, num_thread);
 
     /* process bias and dequant output from int32 to fp32 */
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = 0; i < outch; i++)
-    {
-        for (int j = 0; j < outh * outw; j++)
-        {
-            int output_off = i * (outh * outw) + j;
-            if (bias_tensor)
-                output_fp32[output_off] = (float)(output_int32[output_off] + bias_int32[i]) * input_scale * kernel_scales[i];
-            else
-                output_fp32[output_off] = (float)output_int32[output_off] * input_scale * kernel_scales[i];
-        }
-    }
+    parallel_for(dequant_channel, &job, outch, num_thread);
 
     /* process activation relu */
     if (param->activation == 0)
     {
-#pragma omp parallel for num_threads(num_thread)
-        for (int i = 0; i < outch; i++)
-        {
-            for (int j = 0; j < outh * outw; j++)
-            {
-                int output_off = i * (outh * outw) + j;
-
-                if (output_fp32[output_off] < 0)
-                    output_fp32[output_off] = 0;
-            }
-        }
+        parallel_for(relu_channel, &job, outch, num_thread);
     }
 
     /* process activation relu6 */
     if (param->activation > 0)
     {
-#pragma omp parallel for num_threads(num_thread)
-        for (int i = 0; i < outch; i++)
-        {
-            for (int j = 0; j < outh * outw; j++)
-            {
-                int output_off = i * (outh * outw) + j;
-
-                if (output_fp32[output_off] < 0)
-                    output_fp32[output_off] = 0;
-                if (output_fp32[output_off] > 6)
-                    output_fp32[output_off] = 6;
-            }
-        }
+        parallel_for(relu6_channel, &job, outch, num_thread);
     }
 
     /* quant from fp32 to int8 */
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = 0; i < outch; i++)
-    {
-        for (int j = 0; j < outh * outw; j++)
-        {
-            int output_off = i * (outh * outw) + j;
-
-            int32_t data_i32 = (int32_t)(round(output_fp32[output_off] / output_scale));
-            if (data_i32 > 127)
-                data_i32 = 127;
-            else if (data_i32 < -127)
-                data_i32 = -127;
-            output_int8[output_off] = (int8_t)data_i32;
-        }
-    }
+    parallel_for(quant_channel, &job, outch, num_thread);
 
     sys_free(output_int32);
     sys_free(output_fp32);
@@ -531,7 +634,8 @@ static struct node_ops hcl_node_ops = {.prerun = NULL,
                                        .postrun = NULL,
                                        .init_node = init_node,
                                        .release_node = release_node,
-                                       .score = score};
+                                       .score = score,
+                                       .isa = CPU_ISA_BUILD};
 
 int register_conv_direct_hcl_int8_x86_op()
 {
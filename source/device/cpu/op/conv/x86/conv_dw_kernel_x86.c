@@ -30,6 +30,7 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
@@ -2339,22 +2340,33 @@ static void convdw3x3s2(float* output, float* img_data, float* kernel_data, floa
     sys_free(bias_tmp);
 }
 #else
-static void convdw3x3s1(float* output, float* input, float* _kernel, float* _bias, int channel, int in_h, int in_w,
-                        int out_h, int out_w, int num_thread)
+struct convdw3x3s1_job
 {
-    int w = in_w;
-    int h = in_h;
-    int c_step_in = w * h;
-
-    int outw = out_w;
-    int outh = out_h;
-    int c_step_out = outw * outh;
-
-    const int group = channel;
-    const float* kernel = _kernel;
-
-#pragma omp parallel for num_threads(num_thread)
-    for (int g = 0; g < group; g++)
+    float* output;
+    float* input;
+    const float* kernel;
+    float* bias;
+    int w;
+    int c_step_in;
+    int outw;
+    int outh;
+    int c_step_out;
+};
+
+static void convdw3x3s1_group(void* arg, int begin, int end)
+{
+    struct convdw3x3s1_job* job = (struct convdw3x3s1_job*)arg;
+    float* output = job->output;
+    float* input = job->input;
+    const float* kernel = job->kernel;
+    float* _bias = job->bias;
+    int w = job->w;
+    int c_step_in = job->c_step_in;
+    int outw = job->outw;
+    int outh = job->outh;
+    int c_step_out = job->c_step_out;
+
+    for (int g = begin; g < end; g++)
     {
         float* out = output + g * c_step_out;
         float* outptr = out;
@@ -2454,7 +2466,7 @@ static void convdw3x3s1(float* output, float* input, float* _kernel, float* _bia
     }
 }
 
-static void convdw3x3s2(float* output, float* input, float* _kernel, float* _bias, int channel, int in_h, int in_w,
+static void convdw3x3s1(float* output, float* input, float* _kernel, float* _bias, int channel, int in_h, int in_w,
                         int out_h, int out_w, int num_thread)
 {
     int w = in_w;
@@ -2466,12 +2478,52 @@ static void convdw3x3s2(float* output, float* input, float* _kernel, float* _bia
     int c_step_out = outw * outh;
 
     const int group = channel;
-
-    const int tailstep = w - 2 * outw + w;
     const float* kernel = _kernel;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int g = 0; g < group; g++)
+    struct convdw3x3s1_job job;
+
+    job.output = output;
+    job.input = input;
+    job.kernel = kernel;
+    job.bias = _bias;
+    job.w = w;
+    job.c_step_in = c_step_in;
+    job.outw = outw;
+    job.outh = outh;
+    job.c_step_out = c_step_out;
+
+    parallel_for(convdw3x3s1_group, &job, group, num_thread);
+}
+
+struct convdw3x3s2_job
+{
+    float* output;
+    float* input;
+    const float* kernel;
+    float* bias;
+    int w;
+    int c_step_in;
+    int outw;
+    int outh;
+    int c_step_out;
+    int tailstep;
+};
+
+static void convdw3x3s2_group(void* arg, int begin, int end)
+{
+    struct convdw3x3s2_job* job = (struct convdw3x3s2_job*)arg;
+    float* output = job->output;
+    float* input = job->input;
+    const float* kernel = job->kernel;
+    float* _bias = job->bias;
+    int w = job->w;
+    int c_step_in = job->c_step_in;
+    int outw = job->outw;
+    int outh = job->outh;
+    int c_step_out = job->c_step_out;
+    int tailstep = job->tailstep;
+
+    for (int g = begin; g < end; g++)
     {
         float* out = output + g * c_step_out;
         float* outptr = out;
@@ -2519,8 +2571,72 @@ static void convdw3x3s2(float* output, float* input, float* _kernel, float* _bia
         }
     }
 }
+
+static void convdw3x3s2(float* output, float* input, float* _kernel, float* _bias, int channel, int in_h, int in_w,
+                        int out_h, int out_w, int num_thread)
+{
+    int w = in_w;
+    int h = in_h;
+    int c_step_in = w * h;
+
+    int outw = out_w;
+    int outh = out_h;
+    int c_step_out = outw * outh;
+
+    const int group = channel;
+
+    const int tailstep = w - 2 * outw + w;
+    const float* kernel = _kernel;
+
+    struct convdw3x3s2_job job;
+
+    job.output = output;
+    job.input = input;
+    job.kernel = kernel;
+    job.bias = _bias;
+    job.w = w;
+    job.c_step_in = c_step_in;
+    job.outw = outw;
+    job.outh = outh;
+    job.c_step_out = c_step_out;
+    job.tailstep = tailstep;
+
+    parallel_for(convdw3x3s2_group, &job, group, num_thread);
+}
 #endif
 
+struct conv_dw_pad_job
+{
+    float* input;
+    float* input_tmp;
+    int inh;
+    int inw;
+    int inh_tmp;
+    int inw_tmp;
+    int pad_h;
+    int pad_w;
+};
+
+static void pad_group(void* arg, int begin, int end)
+{
+    struct conv_dw_pad_job* job = (struct conv_dw_pad_job*)arg;
+    float* input = job->input;
+    float* input_tmp = job->input_tmp;
+    int inh = job->inh;
+    int inw = job->inw;
+    int inh_tmp = job->inh_tmp;
+    int inw_tmp = job->inw_tmp;
+    int pad_h = job->pad_h;
+    int pad_w = job->pad_w;
+
+    for (int g = begin; g < end; g++)
+    {
+        float* pad_in = input + g * inh * inw;
+        float* pad_out = input_tmp + g * inh_tmp * inw_tmp;
+        pad(pad_in, pad_out, inh, inw, inh_tmp, inw_tmp, pad_h, pad_w, 0.f);
+    }
+}
+
 int conv_dw_run(struct tensor* input_tensor, struct tensor* weight_tensor, struct tensor* bias_tensor,
                 struct tensor* output_tensor, struct conv_priv_info* conv_info, struct conv_param* param, int num_thread, int cpu_affinity)
 {
@@ -2565,13 +2681,18 @@ int conv_dw_run(struct tensor* input_tensor, struct tensor* weight_tensor, struc
     else
     {
         input_tmp = (float*)sys_malloc((size_t)inh_tmp * inw_tmp * group * sizeof(float));
-#pragma omp parallel for num_threads(num_thread)
-        for (int g = 0; g < group; g++)
-        {
-            float* pad_in = input + g * inh * inw;
-            float* pad_out = input_tmp + g * inh_tmp * inw_tmp;
-            pad(pad_in, pad_out, inh, inw, inh_tmp, inw_tmp, pad_h, pad_w, 0.f);
-        }
+        struct conv_dw_pad_job job;
+
+        job.input = input;
+        job.input_tmp = input_tmp;
+        job.inh = inh;
+        job.inw = inw;
+        job.inh_tmp = inh_tmp;
+        job.inw_tmp = inw_tmp;
+        job.pad_h = pad_h;
+        job.pad_w = pad_w;
+
+        parallel_for(pad_group, &job, group, num_thread);
     }
 
     /* process */
@@ -25,6 +25,7 @@
 #include "convolution_param.h"
 
 #include "conv_kernel_x86.h"
+#include "conv_nchwc_kernel_x86.h"
 
 #include "graph/tensor.h"
 #include "graph/node.h"
@@ -32,13 +33,48 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/cpu.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
+#include "device/cpu/cpu_prepack.h"
 
 #include <string.h>
 
-static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+static struct tensor* get_residual_tensor(struct node* ir_node)
+{
+    if (ir_node->input_num > 3)
+        return get_ir_graph_tensor(ir_node->graph, ir_node->input_tensors[3]);
+
+    return NULL;
+}
+
+/* the weights packed by prerun, which are saved by the prepack cache */
+static void* get_packed_weight(struct conv_priv_info* priv_info, struct tensor* filter_tensor, struct conv_param* param, int* size)
+{
+    if (priv_info->nchwc)
+    {
+        *size = conv_nchwc_get_weight_size(filter_tensor, param);
+        return priv_info->nchwc_weight;
+    }
+
+    if (priv_info->winograd)
+    {
+        *size = priv_info->interleave_buffer_size;
+        return priv_info->interleave_buffer;
+    }
+
+    /* the weights copied only are not worth it */
+    if (priv_info->external_interleave_pack4_mem || priv_info->sgemm_i8_scales != NULL)
+    {
+        *size = priv_info->interleave_buffer_pack4_size;
+        return priv_info->interleave_buffer_pack4;
+    }
+
+    return NULL;
+}
+
+static int prerun_kernel(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     struct node* ir_node = exec_node->ir_node;
     struct graph* ir_graph = ir_node->graph;
@@ -52,6 +88,22 @@ static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct
     /* get cpu affinity */
     conv_priv_info->cpu_type = exec_graph->cpu_affinity;
 
+    /* the input or the output is kept blocked by the graph */
+    if (conv_nchwc_enabled(input_tensor, output_tensor, get_residual_tensor(ir_node)))
+    {
+        struct tensor* bias_tensor = NULL;
+        if (ir_node->input_num > 2)
+            bias_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
+
+        if (conv_nchwc_prerun(input_tensor, filter_tensor, bias_tensor, conv_priv_info, conv_param) < 0)
+        {
+            TLOG_ERR("hcl conv nchwc prerun failed\n");
+            return -1;
+        }
+
+        return 0;
+    }
+
     /* fp32 prerun */
     if (exec_graph->mode == TENGINE_MODE_FP32 || exec_graph->mode == TENGINE_MODE_UINT8 || exec_graph->mode == TENGINE_MODE_INT8)
     {
@@ -100,6 +152,36 @@ static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct
     return 0;
 }
 
+static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct tensor* filter_tensor = get_ir_graph_tensor(ir_node->graph, ir_node->input_tensors[1]);
+    struct conv_param* conv_param = (struct conv_param*)ir_node->op.param_mem;
+    struct conv_priv_info* conv_priv_info = (struct conv_priv_info*)exec_node->ops_priv;
+
+    /* the kernels use the weights of the prepack cache instead of packing them */
+    if (conv_priv_info->cached_weight == NULL)
+        conv_priv_info->cached_weight = find_prepack_weight(exec_graph, exec_node, &conv_priv_info->cached_weight_size);
+
+    if (prerun_kernel(node_ops, exec_node, exec_graph) < 0)
+        return -1;
+
+    /* the weights taken by the share are freed with it, the kernels handle them as cached */
+    if (conv_priv_info->cached_weight == NULL)
+    {
+        int size = 0;
+        void* weight = get_packed_weight(conv_priv_info, filter_tensor, conv_param, &size);
+
+        if (save_prepack_weight(exec_graph, exec_node, weight, size) > 0)
+        {
+            conv_priv_info->cached_weight = weight;
+            conv_priv_info->cached_weight_size = size;
+        }
+    }
+
+    return 0;
+}
+
 static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     // TLOG_ERR("conv hcl start\n");
@@ -122,8 +204,35 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct conv_param* conv_param = (struct conv_param*)ir_node->op.param_mem;
     struct conv_priv_info* conv_priv_info = (struct conv_priv_info*)exec_node->ops_priv;
 
+    if (conv_priv_info->nchwc)
+    {
+        if (conv_nchwc_run(input_tensor, output_tensor, get_residual_tensor(ir_node), conv_priv_info, conv_param, num_thread) < 0)
+        {
+            TLOG_ERR("hcl conv nchwc run failed\n");
+            return -1;
+        }
+    }
+    /* the residual is added before the activation */
+    else if (ir_node->input_num > 3)
+    {
+        struct tensor* residual_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]);
+        struct conv_param param = *conv_param;
+
+        param.activation = -1;
+
+        if (conv_hcl_run(input_tensor, weight_tensor, bias_tensor, output_tensor, conv_priv_info, &param, num_thread,
+                         cpu_affinity)
+            < 0)
+        {
+            TLOG_ERR("hcl conv run failed\n");
+            return -1;
+        }
+
+        conv_hcl_residual_fp32((const float*)residual_tensor->data, (float*)output_tensor->data, output_tensor->elem_num,
+                               conv_param->activation, num_thread);
+    }
     /* fp32 run */
-    if (exec_graph->mode == TENGINE_MODE_FP32 || exec_graph->mode == TENGINE_MODE_UINT8 || exec_graph->mode == TENGINE_MODE_INT8)
+    else if (exec_graph->mode == TENGINE_MODE_FP32 || exec_graph->mode == TENGINE_MODE_UINT8 || exec_graph->mode == TENGINE_MODE_INT8)
     {
         if (conv_hcl_run(input_tensor, weight_tensor, bias_tensor, output_tensor, conv_priv_info, conv_param, num_thread,
                          cpu_affinity)
@@ -243,7 +352,7 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
     dims[0] = n;
     if (ir_graph->graph_layout == TENGINE_LAYOUT_NCHW)
     {
-        if (output_tensor->dims[1] != out_c || output_tensor->dims[2] != out_h || output_tensor->dims[3] != out_w)
+        if (output_tensor->dims[0] != n || output_tensor->dims[1] != out_c || output_tensor->dims[2] != out_h || output_tensor->dims[3] != out_w)
         {
             dims[1] = out_c;
             dims[2] = out_h;
@@ -260,7 +369,7 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
     }
     else
     {
-        if (output_tensor->dims[1] != out_h || output_tensor->dims[2] != out_w || output_tensor->dims[3] != out_c)
+        if (output_tensor->dims[0] != n || output_tensor->dims[1] != out_h || output_tensor->dims[2] != out_w || output_tensor->dims[3] != out_c)
         {
             dims[1] = out_h;
             dims[2] = out_w;
@@ -283,6 +392,9 @@ static int postrun(struct node_ops* node_ops, struct exec_node* exec_node, struc
 {
     struct conv_priv_info* conv_priv_info = (struct conv_priv_info*)exec_node->ops_priv;
 
+    if (conv_priv_info->nchwc)
+        return conv_nchwc_postrun(conv_priv_info);
+
     /* fp32 postrun */
     if (exec_graph->mode == TENGINE_MODE_FP32 || exec_graph->mode == TENGINE_MODE_UINT8 || exec_graph->mode == TENGINE_MODE_INT8)
     {
@@ -324,6 +436,10 @@ static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, str
     memset(conv_priv_info, 0, sizeof(struct conv_priv_info));
     exec_node->ops_priv = conv_priv_info;
 
+    /* the kernel of the blocked layout needs no shared memory */
+    if (conv_nchwc_enabled(input_tensor, output_tensor, get_residual_tensor(ir_node)))
+        return 0;
+
     /* get shared memory size */
     if (exec_graph->mode == TENGINE_MODE_FP32 || exec_graph->mode == TENGINE_MODE_UINT8 || exec_graph->mode == TENGINE_MODE_INT8)
     {
@@ -339,6 +455,51 @@ static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, str
     return 0;
 }
 
+static int resize(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* filter_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    struct conv_param* conv_param = (struct conv_param*)ir_node->op.param_mem;
+    struct conv_priv_info* conv_priv_info = (struct conv_priv_info*)exec_node->ops_priv;
+
+    int nchwc = conv_nchwc_enabled(input_tensor, output_tensor, get_residual_tensor(ir_node));
+
+    /* the weights are packed in another way for the new layouts, pack them again in prerun */
+    if (nchwc != conv_priv_info->nchwc)
+    {
+        int ret = conv_priv_info->nchwc ? conv_nchwc_postrun(conv_priv_info) : conv_hcl_postrun(conv_priv_info);
+
+        if (ret < 0)
+            return -1;
+
+        memset(conv_priv_info, 0, sizeof(struct conv_priv_info));
+    }
+
+    if (nchwc)
+    {
+        exec_node->shared_mem_size = 0;
+        exec_node->shared_pack4_mem_size = 0;
+
+        return conv_nchwc_resize(conv_priv_info);
+    }
+
+    /* the shared memory size follows the output shape */
+    exec_node->shared_mem_size = conv_hcl_get_shared_mem_size(input_tensor, output_tensor, conv_param);
+    exec_node->shared_pack4_mem_size = conv_hcl_get_shared_pack4_mem_size(filter_tensor, output_tensor, conv_param);
+
+    if (conv_hcl_resize(input_tensor, conv_priv_info, conv_param) < 0)
+    {
+        TLOG_ERR("hcl conv resize failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
 static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     struct conv_priv_info* conv_priv_info = (struct conv_priv_info*)exec_node->ops_priv;
@@ -367,16 +528,43 @@ static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struc
     if (group != 1)
         return 0;
 
+    /* the residual is for fp32 only */
+    if (ir_node->input_num > 3 && input_tensor->data_type != TENGINE_DT_FP32)
+        return 0;
+
     return OPS_SCORE_PREFER;
 }
 
+static int pack(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* ir_node)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* filter_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct conv_param* param = (struct conv_param*)ir_node->op.param_mem;
+
+    if (exec_graph->mode != TENGINE_MODE_FP32 || filter_tensor->tensor_type != TENSOR_TYPE_CONST)
+        return 0;
+
+    if (ir_node->input_num > 2 && get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2])->tensor_type != TENSOR_TYPE_CONST)
+        return 0;
+
+    if (!conv_hcl_nchwc_support(input_tensor, output_tensor, param))
+        return 0;
+
+    return conv_nchwc_get_block();
+}
+
 static struct node_ops hcl_node_ops = {.prerun = prerun,
                                        .run = run,
                                        .reshape = reshape,
                                        .postrun = postrun,
                                        .init_node = init_node,
                                        .release_node = release_node,
-                                       .score = score};
+                                       .score = score,
+                                       .resize = resize,
+                                       .isa = CPU_ISA_BUILD,
+                                       .pack = pack};
 
 int register_conv_hcl_x86_op()
 {
@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "conv_kernel_x86.h"
+
+#include <string.h>
+
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+ * built with avx2 whatever the isa of the other x86 sources, see the cpu CMakeLists.txt,
+ * so it is called only on a cpu with avx2. the columns of B are packed by 8.
+ *
+ * vpmaddubsw takes the abs of B as uint8 and A with the sign of B, the pairs of the products
+ * are at most 2 * 128 * 127 and never saturate the int16. -128 of A would keep its sign against
+ * a negative B, sgemm_i8_quant() runs such an A on the c tile.
+ */
+#if __AVX2__
+static inline __m256i load_a(const int8_t* va)
+{
+    return _mm256_set1_epi32(*(const int32_t*)va);
+}
+
+static inline __m256i dot(__m256i _sum, __m256i _a, __m256i _b, __m256i _b_abs)
+{
+    __m256i _p = _mm256_maddubs_epi16(_b_abs, _mm256_sign_epi8(_a, _b));
+
+    return _mm256_add_epi32(_sum, _mm256_madd_epi16(_p, _mm256_set1_epi16(1)));
+}
+
+/* the same steps as sgemm_i8_requant_c() */
+static inline void store_requant(const struct sgemm_i8_requant* requant, __m256i _sum, __m256i _bias, __m256 _scale,
+                                 int8_t* output, int cols)
+{
+    __m256 _v = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_sum, _bias)), _scale);
+
+    _v = _mm256_min_ps(_mm256_max_ps(_v, _mm256_set1_ps(requant->act_min)), _mm256_set1_ps(requant->act_max));
+    _v = _mm256_div_ps(_v, _mm256_set1_ps(requant->output_scale));
+    _v = _mm256_min_ps(_mm256_max_ps(_v, _mm256_set1_ps(-127.f)), _mm256_set1_ps(127.f));
+
+    /* rounded half away from zero as round() */
+    __m256 _sign = _mm256_set1_ps(-0.f);
+    __m256 _t = _mm256_round_ps(_v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256 _half = _mm256_cmp_ps(_mm256_andnot_ps(_sign, _mm256_sub_ps(_v, _t)), _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+    __m256 _one = _mm256_or_ps(_mm256_and_ps(_v, _sign), _mm256_set1_ps(1.f));
+
+    __m256i _i = _mm256_cvttps_epi32(_mm256_add_ps(_t, _mm256_and_ps(_half, _one)));
+    __m128i _i16 = _mm_packs_epi32(_mm256_castsi256_si128(_i), _mm256_extracti128_si256(_i, 1));
+    __m128i _i8 = _mm_packs_epi16(_i16, _i16);
+
+    if (cols == 8)
+    {
+        _mm_storel_epi64((__m128i*)output, _i8);
+    }
+    else
+    {
+        int8_t tmp[16];
+        _mm_storeu_si128((__m128i*)tmp, _i8);
+        memcpy(output, tmp, cols);
+    }
+}
+#endif
+
+void sgemm_i8_requant_avx2(const int32_t* sum, int rows, int cols, int8_t* output, int ldc,
+                           const struct sgemm_i8_requant* requant, int row, int col)
+{
+#if __AVX2__
+    __m256i _bias = _mm256_setzero_si256();
+    __m256 _scale;
+
+    if (requant->channel_col)
+    {
+        int32_t bias[8] = {0};
+        float scales[8] = {0.f};
+
+        for (int j = 0; j < cols; j++)
+        {
+            if (requant->bias)
+                bias[j] += requant->bias[col + j];
+            if (requant->offset)
+                bias[j] += requant->offset[col + j];
+
+            scales[j] = requant->scales[col + j];
+        }
+
+        _bias = _mm256_loadu_si256((const __m256i*)bias);
+        _scale = _mm256_loadu_ps(scales);
+    }
+
+    for (int r = 0; r < rows; r++)
+    {
+        if (!requant->channel_col)
+        {
+            int32_t bias = 0;
+
+            if (requant->bias)
+                bias += requant->bias[row + r];
+            if (requant->offset)
+                bias += requant->offset[row + r];
+
+            _bias = _mm256_set1_epi32(bias);
+            _scale = _mm256_set1_ps(requant->scales[row + r]);
+        }
+
+        store_requant(requant, _mm256_loadu_si256((const __m256i*)(sum + r * 8)), _bias, _scale, output + r * ldc, cols);
+    }
+#else
+    for (int r = 0; r < rows; r++)
+    {
+        for (int j = 0; j < cols; j++)
+        {
+            int ch = requant->channel_col ? col + j : row + r;
+            output[r * ldc + j] = sgemm_i8_requant_c(requant, sum[r * 8 + j], ch);
+        }
+    }
+#endif
+}
+
+void sgemm_i8_tile_avx2(int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                        const struct sgemm_i8_requant* requant, int row, int col)
+{
+#if __AVX2__
+    int32_t sum[8 * 8];
+
+    if (rows == 1)
+    {
+        /* the k are added in two sums to hide the latency */
+        __m256i _sum0 = _mm256_setzero_si256();
+        __m256i _sum1 = _mm256_setzero_si256();
+        int k = 0;
+
+        for (; k + 1 < K4; k += 2)
+        {
+            __m256i _b0 = _mm256_loadu_si256((const __m256i*)vb);
+            __m256i _b1 = _mm256_loadu_si256((const __m256i*)(vb + 32));
+
+            _sum0 = dot(_sum0, load_a(va), _b0, _mm256_abs_epi8(_b0));
+            _sum1 = dot(_sum1, load_a(va + 32), _b1, _mm256_abs_epi8(_b1));
+
+            va += 64;
+            vb += 64;
+        }
+        if (k < K4)
+        {
+            __m256i _b0 = _mm256_loadu_si256((const __m256i*)vb);
+
+            _sum0 = dot(_sum0, load_a(va), _b0, _mm256_abs_epi8(_b0));
+        }
+
+        _mm256_storeu_si256((__m256i*)sum, _mm256_add_epi32(_sum0, _sum1));
+    }
+    else
+    {
+        __m256i _sum[8];
+
+        for (int r = 0; r < 8; r++)
+            _sum[r] = _mm256_setzero_si256();
+
+        for (int k = 0; k < K4; k++)
+        {
+            __m256i _b = _mm256_loadu_si256((const __m256i*)vb);
+            __m256i _b_abs = _mm256_abs_epi8(_b);
+
+            for (int r = 0; r < 8; r++)
+                _sum[r] = dot(_sum[r], load_a(va + r * 4), _b, _b_abs);
+
+            va += 32;
+            vb += 32;
+        }
+
+        for (int r = 0; r < 8; r++)
+            _mm256_storeu_si256((__m256i*)(sum + r * 8), _sum[r]);
+    }
+
+    sgemm_i8_requant_avx2(sum, rows, cols, output, ldc, requant, row, col);
+#else
+    sgemm_i8_tile_c(SGEMM_I8_AVX2, K4, va, vb, rows, cols, output, ldc, requant, row, col);
+#endif
+}
@@ -0,0 +1,271 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "conv_kernel_x86.h"
+
+#if __AVX512VNNI__
+#include <immintrin.h>
+#endif
+
+/*
+ * built with avx512f, avx512bw, avx512vl and avx512vnni whatever the isa of the other x86
+ * sources, see the cpu CMakeLists.txt, so it is called only on a cpu with them. the columns
+ * of B are packed by 16 and a tile takes two blocks of them.
+ */
+#if __AVX512VNNI__
+/* vpdpbusd takes the flipped inputs as uint8, they are A for fc and B for conv */
+static inline __m512i dot(__m512i _sum, __m512i _a, __m512i _b, int channel_col)
+{
+    if (channel_col)
+        return _mm512_dpbusd_epi32(_sum, _a, _b);
+    else
+        return _mm512_dpbusd_epi32(_sum, _b, _a);
+}
+
+static inline __m512i load_a(const int8_t* va)
+{
+    return _mm512_set1_epi32(*(const int32_t*)va);
+}
+
+static inline __mmask16 get_mask(int cols)
+{
+    return cols >= 16 ? (__mmask16)0xffff : (__mmask16)((1 << cols) - 1);
+}
+
+/* the same steps as sgemm_i8_requant_c() */
+static inline void store_requant(const struct sgemm_i8_requant* requant, __m512i _sum, __m512i _bias, __m512 _scale,
+                                 int8_t* output, __mmask16 _mask)
+{
+    __m512 _v = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(_sum, _bias)), _scale);
+
+    _v = _mm512_min_ps(_mm512_max_ps(_v, _mm512_set1_ps(requant->act_min)), _mm512_set1_ps(requant->act_max));
+    _v = _mm512_div_ps(_v, _mm512_set1_ps(requant->output_scale));
+    _v = _mm512_min_ps(_mm512_max_ps(_v, _mm512_set1_ps(-127.f)), _mm512_set1_ps(127.f));
+
+    /* rounded half away from zero as round() */
+    __m512 _t = _mm512_roundscale_ps(_v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __mmask16 _half = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_sub_ps(_v, _t)), _mm512_set1_ps(0.5f), _CMP_GE_OQ);
+    __m512i _one = _mm512_or_si512(_mm512_and_si512(_mm512_castps_si512(_v), _mm512_set1_epi32((int)0x80000000)),
+                                   _mm512_set1_epi32(0x3f800000));
+
+    _t = _mm512_mask_add_ps(_t, _half, _t, _mm512_castsi512_ps(_one));
+
+    _mm512_mask_cvtepi32_storeu_epi8(output, _mask, _mm512_cvttps_epi32(_t));
+}
+
+/* the bias and scale of the 16 output channels from ch in the lanes */
+static inline void load_channel_col(const struct sgemm_i8_requant* requant, int ch, __mmask16 _mask, __m512i* _bias, __m512* _scale)
+{
+    *_bias = _mm512_setzero_si512();
+
+    if (requant->bias)
+        *_bias = _mm512_maskz_loadu_epi32(_mask, requant->bias + ch);
+    if (requant->offset)
+        *_bias = _mm512_add_epi32(*_bias, _mm512_maskz_loadu_epi32(_mask, requant->offset + ch));
+
+    *_scale = _mm512_maskz_loadu_ps(_mask, requant->scales + ch);
+}
+
+/* the bias and scale of the output channel ch in all the lanes */
+static inline void load_channel_row(const struct sgemm_i8_requant* requant, int ch, __m512i* _bias, __m512* _scale)
+{
+    int32_t bias = 0;
+
+    if (requant->bias)
+        bias += requant->bias[ch];
+    if (requant->offset)
+        bias += requant->offset[ch];
+
+    *_bias = _mm512_set1_epi32(bias);
+    *_scale = _mm512_set1_ps(requant->scales[ch]);
+}
+
+static void tile_8rows(int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                       const struct sgemm_i8_requant* requant, int row, int col, int channel_col)
+{
+    __m512i _sum[8][2];
+
+    for (int r = 0; r < 8; r++)
+    {
+        _sum[r][0] = _mm512_setzero_si512();
+        _sum[r][1] = _mm512_setzero_si512();
+    }
+
+    if (cols > 16)
+    {
+        const int8_t* vb1 = vb + K4 * 64;
+
+        for (int k = 0; k < K4; k++)
+        {
+            __m512i _b0 = _mm512_loadu_si512(vb);
+            __m512i _b1 = _mm512_loadu_si512(vb1);
+
+            for (int r = 0; r < 8; r++)
+            {
+                __m512i _a = load_a(va + r * 4);
+
+                _sum[r][0] = dot(_sum[r][0], _a, _b0, channel_col);
+                _sum[r][1] = dot(_sum[r][1], _a, _b1, channel_col);
+            }
+
+            va += 32;
+            vb += 64;
+            vb1 += 64;
+        }
+    }
+    else
+    {
+        for (int k = 0; k < K4; k++)
+        {
+            __m512i _b0 = _mm512_loadu_si512(vb);
+
+            for (int r = 0; r < 8; r++)
+                _sum[r][0] = dot(_sum[r][0], load_a(va + r * 4), _b0, channel_col);
+
+            va += 32;
+            vb += 64;
+        }
+    }
+
+    __m512i _bias[2];
+    __m512 _scale[2];
+
+    if (channel_col)
+    {
+        for (int j = 0; j * 16 < cols; j++)
+            load_channel_col(requant, col + j * 16, get_mask(cols - j * 16), &_bias[j], &_scale[j]);
+    }
+
+    for (int r = 0; r < rows; r++)
+    {
+        if (!channel_col)
+        {
+            load_channel_row(requant, row + r, &_bias[0], &_scale[0]);
+            _bias[1] = _bias[0];
+            _scale[1] = _scale[0];
+        }
+
+        for (int j = 0; j * 16 < cols; j++)
+            store_requant(requant, _sum[r][j], _bias[j], _scale[j], output + r * ldc + j * 16, get_mask(cols - j * 16));
+    }
+}
+
+/* a single row of A as the batch 1 of fc, the k are added in two sums to hide the latency */
+static void tile_1row(int K4, const int8_t* va, const int8_t* vb, int r, int cols, int8_t* output,
+                      const struct sgemm_i8_requant* requant, int row, int col, int channel_col)
+{
+    const int8_t* vb1 = vb + K4 * 64;
+    __m512i _sum0 = _mm512_setzero_si512();
+    __m512i _sum1 = _mm512_setzero_si512();
+    __m512i _sum2 = _mm512_setzero_si512();
+    __m512i _sum3 = _mm512_setzero_si512();
+    int k = 0;
+
+    va += r * 4;
+
+    if (cols > 16)
+    {
+        for (; k + 1 < K4; k += 2)
+        {
+            __m512i _a0 = load_a(va);
+            __m512i _a1 = load_a(va + 32);
+
+            _sum0 = dot(_sum0, _a0, _mm512_loadu_si512(vb), channel_col);
+            _sum1 = dot(_sum1, _a0, _mm512_loadu_si512(vb1), channel_col);
+            _sum2 = dot(_sum2, _a1, _mm512_loadu_si512(vb + 64), channel_col);
+            _sum3 = dot(_sum3, _a1, _mm512_loadu_si512(vb1 + 64), channel_col);
+
+            va += 64;
+            vb += 128;
+            vb1 += 128;
+        }
+        for (; k < K4; k++)
+        {
+            __m512i _a0 = load_a(va);
+
+            _sum0 = dot(_sum0, _a0, _mm512_loadu_si512(vb), channel_col);
+            _sum1 = dot(_sum1, _a0, _mm512_loadu_si512(vb1), channel_col);
+        }
+    }
+    else
+    {
+        for (; k + 1 < K4; k += 2)
+        {
+            _sum0 = dot(_sum0, load_a(va), _mm512_loadu_si512(vb), channel_col);
+            _sum2 = dot(_sum2, load_a(va + 32), _mm512_loadu_si512(vb + 64), channel_col);
+
+            va += 64;
+            vb += 128;
+        }
+        for (; k < K4; k++)
+            _sum0 = dot(_sum0, load_a(va), _mm512_loadu_si512(vb), channel_col);
+    }
+
+    _sum0 = _mm512_add_epi32(_sum0, _sum2);
+    _sum1 = _mm512_add_epi32(_sum1, _sum3);
+
+    __m512i _bias;
+    __m512 _scale;
+
+    if (channel_col)
+        load_channel_col(requant, col, get_mask(cols), &_bias, &_scale);
+    else
+        load_channel_row(requant, row + r, &_bias, &_scale);
+
+    store_requant(requant, _sum0, _bias, _scale, output, get_mask(cols));
+
+    if (cols > 16)
+    {
+        if (channel_col)
+            load_channel_col(requant, col + 16, get_mask(cols - 16), &_bias, &_scale);
+
+        store_requant(requant, _sum1, _bias, _scale, output + 16, get_mask(cols - 16));
+    }
+}
+#endif
+
+void sgemm_i8_tile_avx512vnni(int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                              const struct sgemm_i8_requant* requant, int row, int col)
+{
+#if __AVX512VNNI__
+    if (rows <= 2)
+    {
+        for (int r = 0; r < rows; r++)
+        {
+            if (requant->channel_col)
+                tile_1row(K4, va, vb, r, cols, output + r * ldc, requant, row, col, 1);
+            else
+                tile_1row(K4, va, vb, r, cols, output + r * ldc, requant, row, col, 0);
+        }
+    }
+    else
+    {
+        if (requant->channel_col)
+            tile_8rows(K4, va, vb, rows, cols, output, ldc, requant, row, col, 1);
+        else
+            tile_8rows(K4, va, vb, rows, cols, output, ldc, requant, row, col, 0);
+    }
+#else
+    sgemm_i8_tile_c(SGEMM_I8_AVX512VNNI, K4, va, vb, rows, cols, output, ldc, requant, row, col);
+#endif
+}
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "conv_kernel_x86.h"
+
+#if __AVXVNNI__
+#include <immintrin.h>
+#endif
+
+/*
+ * built with avx2 and avx-vnni whatever the isa of the other x86 sources, see the cpu
+ * CMakeLists.txt, so it is called only on a cpu with them. the columns of B are packed by 8,
+ * and the sums are requantized by the avx2 kernel.
+ */
+#if __AVXVNNI__
+/* vpdpbusd takes the flipped inputs as uint8, they are A for fc and B for conv */
+static inline __m256i dot(__m256i _sum, __m256i _a, __m256i _b, int channel_col)
+{
+    if (channel_col)
+        return _mm256_dpbusd_avx_epi32(_sum, _a, _b);
+    else
+        return _mm256_dpbusd_avx_epi32(_sum, _b, _a);
+}
+
+static inline __m256i load_a(const int8_t* va)
+{
+    return _mm256_set1_epi32(*(const int32_t*)va);
+}
+
+static void tile_sum(int K4, const int8_t* va, const int8_t* vb, int rows, int32_t* sum, int channel_col)
+{
+    if (rows == 1)
+    {
+        /* the k are added in two sums to hide the latency */
+        __m256i _sum0 = _mm256_setzero_si256();
+        __m256i _sum1 = _mm256_setzero_si256();
+        int k = 0;
+
+        for (; k + 1 < K4; k += 2)
+        {
+            _sum0 = dot(_sum0, load_a(va), _mm256_loadu_si256((const __m256i*)vb), channel_col);
+            _sum1 = dot(_sum1, load_a(va + 32), _mm256_loadu_si256((const __m256i*)(vb + 32)), channel_col);
+
+            va += 64;
+            vb += 64;
+        }
+        if (k < K4)
+            _sum0 = dot(_sum0, load_a(va), _mm256_loadu_si256((const __m256i*)vb), channel_col);
+
+        _mm256_storeu_si256((__m256i*)sum, _mm256_add_epi32(_sum0, _sum1));
+    }
+    else
+    {
+        __m256i _sum[8];
+
+        for (int r = 0; r < 8; r++)
+            _sum[r] = _mm256_setzero_si256();
+
+        for (int k = 0; k < K4; k++)
+        {
+            __m256i _b = _mm256_loadu_si256((const __m256i*)vb);
+
+            for (int r = 0; r < 8; r++)
+                _sum[r] = dot(_sum[r], load_a(va + r * 4), _b, channel_col);
+
+            va += 32;
+            vb += 32;
+        }
+
+        for (int r = 0; r < 8; r++)
+            _mm256_storeu_si256((__m256i*)(sum + r * 8), _sum[r]);
+    }
+}
+#endif
+
+void sgemm_i8_tile_avxvnni(int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                           const struct sgemm_i8_requant* requant, int row, int col)
+{
+#if __AVXVNNI__
+    int32_t sum[8 * 8];
+
+    if (requant->channel_col)
+        tile_sum(K4, va, vb, rows, sum, 1);
+    else
+        tile_sum(K4, va, vb, rows, sum, 0);
+
+    sgemm_i8_requant_avx2(sum, rows, cols, output, ldc, requant, row, col);
+#else
+    sgemm_i8_tile_c(SGEMM_I8_AVXVNNI, K4, va, vb, rows, cols, output, ldc, requant, row, col);
+#endif
+}
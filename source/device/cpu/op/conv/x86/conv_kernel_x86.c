@@ -32,6 +32,8 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
@@ -41,6 +43,9 @@
 #include <string.h>
 #include <math.h>
 
+#if __SSE2__
+#include <emmintrin.h>
+#endif
 #if __AVX__
 #include <immintrin.h>
 #endif
@@ -270,14 +275,24 @@ static void im2col_ir(struct tensor* input, struct tensor* output, struct conv_p
     }
 }
 
-void input_pack4_fp32(int K, int N, float* pB, float* pB_t, int num_thread)
+struct input_pack4_fp32_job
 {
-    int nn_size = N >> 3;
-    int remian_size_start = nn_size << 3;
+    int K;
+    int N;
+    float* pB;
+    float* pB_t;
+    int remian_size_start;
+};
+
+static void pack4_fp32_col8(void* arg, int begin, int end)
+{
+    struct input_pack4_fp32_job* job = (struct input_pack4_fp32_job*)arg;
+    int K = job->K;
+    int N = job->N;
+    float* pB = job->pB;
+    float* pB_t = job->pB_t;
 
-// [ch00, ch10, ch20, ch30, ch01, ch11, ch21, ch31, ch02, ch12, ch22, ch32, ch03, ch13, ch23, ch33 ....]
-#pragma omp parallel for num_threads(num_thread)
-    for (int ii = 0; ii < nn_size; ii++)
+    for (int ii = begin; ii < end; ii++)
     {
         int i = ii * 8;
         const float* img = pB + i;
@@ -301,10 +316,18 @@ void input_pack4_fp32(int K, int N, float* pB, float* pB_t, int num_thread)
             img += N;
         }
     }
+}
 
-// [ch00, ch01, ch02, ch03 ....]
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = remian_size_start; i < N; i++)
+static void pack4_fp32_col1(void* arg, int begin, int end)
+{
+    struct input_pack4_fp32_job* job = (struct input_pack4_fp32_job*)arg;
+    int K = job->K;
+    int N = job->N;
+    float* pB = job->pB;
+    float* pB_t = job->pB_t;
+    int remian_size_start = job->remian_size_start;
+
+    for (int i = remian_size_start + begin; i < remian_size_start + end; i++)
     {
         const float* img = pB + i;
         float* tmp = pB_t + (i / 8 + i % 8) * 8 * K;
@@ -319,16 +342,47 @@ void input_pack4_fp32(int K, int N, float* pB, float* pB_t, int num_thread)
     }
 }
 
-static void sgemm_fp(int M, int N, int K, float* pA_t, float* pB_t, float* pC, int num_thread)
+void input_pack4_fp32(int K, int N, float* pB, float* pB_t, int num_thread)
 {
-    int nn_outch = 0;
-    int remain_outch_start = 0;
+    int nn_size = N >> 3;
+    int remian_size_start = nn_size << 3;
 
-    nn_outch = M >> 3;
-    remain_outch_start = nn_outch << 3;
+    struct input_pack4_fp32_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int pp = 0; pp < nn_outch; pp++)
+    job.K = K;
+    job.N = N;
+    job.pB = pB;
+    job.pB_t = pB_t;
+    job.remian_size_start = remian_size_start;
+
+    // [ch00, ch10, ch20, ch30, ch01, ch11, ch21, ch31, ch02, ch12, ch22, ch32, ch03, ch13, ch23, ch33 ....]
+    parallel_for(pack4_fp32_col8, &job, nn_size, num_thread);
+
+    // [ch00, ch01, ch02, ch03 ....]
+    parallel_for(pack4_fp32_col1, &job, N - remian_size_start, num_thread);
+}
+
+struct sgemm_fp_job
+{
+    int N;
+    int K;
+    float* pA_t;
+    float* pB_t;
+    float* pC;
+    int remain_outch_start;
+    int avx512; /* the cpu has avx512f */
+};
+
+static void sgemm_fp_outch8(void* arg, int begin, int end)
+{
+    struct sgemm_fp_job* job = (struct sgemm_fp_job*)arg;
+    int N = job->N;
+    int K = job->K;
+    float* pA_t = job->pA_t;
+    float* pB_t = job->pB_t;
+    float* pC = job->pC;
+
+    for (int pp = begin; pp < end; pp++)
     {
         int i = pp * 8;
 
@@ -342,6 +396,27 @@ static void sgemm_fp(int M, int N, int K, float* pA_t, float* pB_t, float* pC, i
         float* output7 = pC + (i + 7) * N;
 
         int j = 0;
+        if (job->avx512)
+        {
+            // two columns blocks at once
+            for (; j + 15 < N; j += 16)
+            {
+                float* va = pA_t + (i / 8) * 8 * K;
+                float* vb = pB_t + (j / 8) * 8 * K;
+
+                sgemm_fp_8x16_avx512(K, va, vb, vb + 8 * K, output0, N);
+
+                output0 += 16;
+                output1 += 16;
+                output2 += 16;
+                output3 += 16;
+                output4 += 16;
+                output5 += 16;
+                output6 += 16;
+                output7 += 16;
+            }
+        }
+
         for (; j + 7 < N; j += 8)
         {
             float* va = pA_t + (i / 8) * 8 * K;
@@ -631,10 +706,19 @@ static void sgemm_fp(int M, int N, int K, float* pA_t, float* pB_t, float* pC, i
             output7++;
         }
     }
+}
 
-    nn_outch = (M - remain_outch_start) >> 2;
-
-    for (int pp = 0; pp < nn_outch; pp++)
+static void sgemm_fp_outch4(void* arg, int begin, int end)
+{
+    struct sgemm_fp_job* job = (struct sgemm_fp_job*)arg;
+    int N = job->N;
+    int K = job->K;
+    float* pA_t = job->pA_t;
+    float* pB_t = job->pB_t;
+    float* pC = job->pC;
+    int remain_outch_start = job->remain_outch_start;
+
+    for (int pp = begin; pp < end; pp++)
     {
         int i = remain_outch_start + pp * 4;
 
@@ -847,11 +931,19 @@ static void sgemm_fp(int M, int N, int K, float* pA_t, float* pB_t, float* pC, i
             output3++;
         }
     }
+}
 
-    remain_outch_start += nn_outch << 2;
-
-    // output ch0
-    for (int i = remain_outch_start; i < M; i++)
+static void sgemm_fp_outch1(void* arg, int begin, int end)
+{
+    struct sgemm_fp_job* job = (struct sgemm_fp_job*)arg;
+    int N = job->N;
+    int K = job->K;
+    float* pA_t = job->pA_t;
+    float* pB_t = job->pB_t;
+    float* pC = job->pC;
+    int remain_outch_start = job->remain_outch_start;
+
+    for (int i = remain_outch_start + begin; i < remain_outch_start + end; i++)
     {
         float* output = pC + i * N;
 
@@ -960,14 +1052,55 @@ static void sgemm_fp(int M, int N, int K, float* pA_t, float* pB_t, float* pC, i
     }
 }
 
-void input_pack4_int8(int K, int N, int8_t* pB, int8_t* pB_t, int num_thread)
+void sgemm_fp(int M, int N, int K, float* pA_t, float* pB_t, float* pC, int num_thread)
 {
-    int nn_size = N >> 3;
-    int remian_size_start = nn_size << 3;
+    int nn_outch = 0;
+    int remain_outch_start = 0;
 
-// [ch00, ch10, ch20, ch30, ch01, ch11, ch21, ch31, ch02, ch12, ch22, ch32, ch03, ch13, ch23, ch33 ....]
-#pragma omp parallel for num_threads(num_thread)
-    for (int ii = 0; ii < nn_size; ii++)
+    nn_outch = M >> 3;
+    remain_outch_start = nn_outch << 3;
+
+    struct sgemm_fp_job job;
+
+    job.N = N;
+    job.K = K;
+    job.pA_t = pA_t;
+    job.pB_t = pB_t;
+    job.pC = pC;
+    job.avx512 = (get_cpu_isa() & CPU_ISA_AVX512F) != 0;
+
+    parallel_for(sgemm_fp_outch8, &job, nn_outch, num_thread);
+
+    nn_outch = (M - remain_outch_start) >> 2;
+    job.remain_outch_start = remain_outch_start;
+
+    parallel_for(sgemm_fp_outch4, &job, nn_outch, num_thread);
+
+    remain_outch_start += nn_outch << 2;
+    job.remain_outch_start = remain_outch_start;
+
+    // output ch0
+    parallel_for(sgemm_fp_outch1, &job, M - remain_outch_start, num_thread);
+}
+
+struct input_pack4_int8_job
+{
+    int K;
+    int N;
+    int8_t* pB;
+    int8_t* pB_t;
+    int remian_size_start;
+};
+
+static void pack4_int8_col8(void* arg, int begin, int end)
+{
+    struct input_pack4_int8_job* job = (struct input_pack4_int8_job*)arg;
+    int K = job->K;
+    int N = job->N;
+    int8_t* pB = job->pB;
+    int8_t* pB_t = job->pB_t;
+
+    for (int ii = begin; ii < end; ii++)
     {
         int i = ii * 8;
         const int8_t* img = pB + i;
@@ -988,10 +1121,18 @@ void input_pack4_int8(int K, int N, int8_t* pB, int8_t* pB_t, int num_thread)
             img += N;
         }
     }
+}
 
-// [ch00, ch01, ch02, ch03 ....]
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = remian_size_start; i < N; i++)
+static void pack4_int8_col1(void* arg, int begin, int end)
+{
+    struct input_pack4_int8_job* job = (struct input_pack4_int8_job*)arg;
+    int K = job->K;
+    int N = job->N;
+    int8_t* pB = job->pB;
+    int8_t* pB_t = job->pB_t;
+    int remian_size_start = job->remian_size_start;
+
+    for (int i = remian_size_start + begin; i < remian_size_start + end; i++)
     {
         const int8_t* img = pB + i;
         int8_t* tmp = pB_t + (i / 8 + i % 8) * 8 * K;
@@ -1005,16 +1146,47 @@ void input_pack4_int8(int K, int N, int8_t* pB, int8_t* pB_t, int num_thread)
         }
     }
 }
-static void sgemm_i8(int M, int N, int K, int8_t* pA_t, int8_t* pB_t, int32_t* pC, int num_thread)
+
+void input_pack4_int8(int K, int N, int8_t* pB, int8_t* pB_t, int num_thread)
 {
-    int nn_outch = 0;
-    int remain_outch_start = 0;
+    int nn_size = N >> 3;
+    int remian_size_start = nn_size << 3;
 
-    nn_outch = M >> 3;
-    remain_outch_start = nn_outch << 3;
+    struct input_pack4_int8_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int pp = 0; pp < nn_outch; pp++)
+    job.K = K;
+    job.N = N;
+    job.pB = pB;
+    job.pB_t = pB_t;
+    job.remian_size_start = remian_size_start;
+
+    // [ch00, ch10, ch20, ch30, ch01, ch11, ch21, ch31, ch02, ch12, ch22, ch32, ch03, ch13, ch23, ch33 ....]
+    parallel_for(pack4_int8_col8, &job, nn_size, num_thread);
+
+    // [ch00, ch01, ch02, ch03 ....]
+    parallel_for(pack4_int8_col1, &job, N - remian_size_start, num_thread);
+}
+
+struct sgemm_i8_job
+{
+    int N;
+    int K;
+    int8_t* pA_t;
+    int8_t* pB_t;
+    int32_t* pC;
+    int remain_outch_start;
+};
+
+static void sgemm_i8_outch8(void* arg, int begin, int end)
+{
+    struct sgemm_i8_job* job = (struct sgemm_i8_job*)arg;
+    int N = job->N;
+    int K = job->K;
+    int8_t* pA_t = job->pA_t;
+    int8_t* pB_t = job->pB_t;
+    int32_t* pC = job->pC;
+
+    for (int pp = begin; pp < end; pp++)
     {
         int i = pp * 8;
 
@@ -1319,10 +1491,19 @@ static void sgemm_i8(int M, int N, int K, int8_t* pA_t, int8_t* pB_t, int32_t* p
             output7++;
         }
     }
+}
 
-    nn_outch = (M - remain_outch_start) >> 2;
-
-    for (int pp = 0; pp < nn_outch; pp++)
+static void sgemm_i8_outch4(void* arg, int begin, int end)
+{
+    struct sgemm_i8_job* job = (struct sgemm_i8_job*)arg;
+    int N = job->N;
+    int K = job->K;
+    int8_t* pA_t = job->pA_t;
+    int8_t* pB_t = job->pB_t;
+    int32_t* pC = job->pC;
+    int remain_outch_start = job->remain_outch_start;
+
+    for (int pp = begin; pp < end; pp++)
     {
         int i = remain_outch_start + pp * 4;
 
@@ -1535,11 +1716,19 @@ static void sgemm_i8(int M, int N, int K, int8_t* pA_t, int8_t* pB_t, int32_t* p
             output3++;
         }
     }
+}
 
-    remain_outch_start += nn_outch << 2;
-
-    // output ch0
-    for (int i = remain_outch_start; i < M; i++)
+static void sgemm_i8_outch1(void* arg, int begin, int end)
+{
+    struct sgemm_i8_job* job = (struct sgemm_i8_job*)arg;
+    int N = job->N;
+    int K = job->K;
+    int8_t* pA_t = job->pA_t;
+    int8_t* pB_t = job->pB_t;
+    int32_t* pC = job->pC;
+    int remain_outch_start = job->remain_outch_start;
+
+    for (int i = remain_outch_start + begin; i < remain_outch_start + end; i++)
     {
         int32_t* output = pC + i * N;
 
@@ -1629,6 +1818,360 @@ static void sgemm_i8(int M, int N, int K, int8_t* pA_t, int8_t* pB_t, int32_t* p
     }
 }
 
+static void sgemm_i8(int M, int N, int K, int8_t* pA_t, int8_t* pB_t, int32_t* pC, int num_thread)
+{
+    int nn_outch = 0;
+    int remain_outch_start = 0;
+
+    nn_outch = M >> 3;
+    remain_outch_start = nn_outch << 3;
+
+    struct sgemm_i8_job job;
+
+    job.N = N;
+    job.K = K;
+    job.pA_t = pA_t;
+    job.pB_t = pB_t;
+    job.pC = pC;
+
+    parallel_for(sgemm_i8_outch8, &job, nn_outch, num_thread);
+
+    nn_outch = (M - remain_outch_start) >> 2;
+    job.remain_outch_start = remain_outch_start;
+
+    parallel_for(sgemm_i8_outch4, &job, nn_outch, num_thread);
+
+    remain_outch_start += nn_outch << 2;
+    job.remain_outch_start = remain_outch_start;
+
+    // output ch0
+    parallel_for(sgemm_i8_outch1, &job, M - remain_outch_start, num_thread);
+}
+
+int sgemm_i8_get_kernel(void)
+{
+    int isa = get_cpu_isa();
+    int avx2 = CPU_ISA_AVX | CPU_ISA_FMA | CPU_ISA_F16C | CPU_ISA_AVX2;
+    int avx512vnni = avx2 | CPU_ISA_AVX512F | CPU_ISA_AVX512BW | CPU_ISA_AVX512VL | CPU_ISA_AVX512VNNI;
+
+    if ((isa & avx512vnni) == avx512vnni)
+        return SGEMM_I8_AVX512VNNI;
+    if ((isa & (avx2 | CPU_ISA_AVXVNNI)) == (avx2 | CPU_ISA_AVXVNNI))
+        return SGEMM_I8_AVXVNNI;
+    if ((isa & avx2) == avx2)
+        return SGEMM_I8_AVX2;
+
+    return SGEMM_I8_NONE;
+}
+
+int sgemm_i8_flip_input(int kernel)
+{
+    return kernel == SGEMM_I8_AVXVNNI || kernel == SGEMM_I8_AVX512VNNI;
+}
+
+int sgemm_i8_get_pack_width(int kernel)
+{
+    return kernel == SGEMM_I8_AVX512VNNI ? 16 : 8;
+}
+
+int sgemm_i8_get_pack_a_size(int M, int K)
+{
+    return ((M + 7) / 8) * 8 * ((K + 3) / 4) * 4;
+}
+
+int sgemm_i8_get_pack_b_size(int K, int N, int width)
+{
+    return ((N + width - 1) / width) * width * ((K + 3) / 4) * 4;
+}
+
+void sgemm_i8_pack_a(int M, int K, const int8_t* pA, int row_stride, int k_stride, int8_t* pA_t, int flip)
+{
+    int K4 = (K + 3) / 4;
+    int8_t mask = flip ? (int8_t)0x80 : 0;
+
+    for (int i = 0; i < M; i += 8)
+    {
+        for (int k = 0; k < K4 * 4; k += 4)
+        {
+            for (int r = 0; r < 8; r++)
+            {
+                for (int q = 0; q < 4; q++)
+                {
+                    int8_t value = 0;
+
+                    if (i + r < M && k + q < K)
+                        value = pA[(size_t)(i + r) * row_stride + (size_t)(k + q) * k_stride];
+
+                    *pA_t++ = value ^ mask;
+                }
+            }
+        }
+    }
+}
+
+struct sgemm_i8_pack_b_job
+{
+    int K;
+    int N;
+    const int8_t* pB;
+    int k_stride;
+    int col_stride;
+    int8_t* pB_t;
+    int width;
+    int flip;
+};
+
+static void sgemm_i8_pack_b_block(void* arg, int begin, int end)
+{
+    struct sgemm_i8_pack_b_job* job = (struct sgemm_i8_pack_b_job*)arg;
+    int K = job->K;
+    int N = job->N;
+    int K4 = (K + 3) / 4;
+    int k_stride = job->k_stride;
+    int col_stride = job->col_stride;
+    int width = job->width;
+    int8_t mask = job->flip ? (int8_t)0x80 : 0;
+
+    for (int b = begin; b < end; b++)
+    {
+        int j0 = b * width;
+        const int8_t* pB = job->pB + (size_t)j0 * col_stride;
+        int8_t* out = job->pB_t + (size_t)b * K4 * width * 4;
+        int k = 0;
+
+#if __SSE2__
+        /* the 4 rows of k of the contiguous columns are interleaved */
+        if (col_stride == 1 && j0 + width <= N)
+        {
+            __m128i _mask = _mm_set1_epi8(mask);
+
+            for (; k + 3 < K; k += 4)
+            {
+                const int8_t* p = pB + (size_t)k * k_stride;
+
+                if (width == 16)
+                {
+                    __m128i _r0 = _mm_loadu_si128((const __m128i*)p);
+                    __m128i _r1 = _mm_loadu_si128((const __m128i*)(p + k_stride));
+                    __m128i _r2 = _mm_loadu_si128((const __m128i*)(p + k_stride * 2));
+                    __m128i _r3 = _mm_loadu_si128((const __m128i*)(p + k_stride * 3));
+                    __m128i _t0 = _mm_unpacklo_epi8(_r0, _r1);
+                    __m128i _t1 = _mm_unpackhi_epi8(_r0, _r1);
+                    __m128i _t2 = _mm_unpacklo_epi8(_r2, _r3);
+                    __m128i _t3 = _mm_unpackhi_epi8(_r2, _r3);
+
+                    _mm_storeu_si128((__m128i*)out, _mm_xor_si128(_mm_unpacklo_epi16(_t0, _t2), _mask));
+                    _mm_storeu_si128((__m128i*)(out + 16), _mm_xor_si128(_mm_unpackhi_epi16(_t0, _t2), _mask));
+                    _mm_storeu_si128((__m128i*)(out + 32), _mm_xor_si128(_mm_unpacklo_epi16(_t1, _t3), _mask));
+                    _mm_storeu_si128((__m128i*)(out + 48), _mm_xor_si128(_mm_unpackhi_epi16(_t1, _t3), _mask));
+                }
+                else
+                {
+                    __m128i _r0 = _mm_loadl_epi64((const __m128i*)p);
+                    __m128i _r1 = _mm_loadl_epi64((const __m128i*)(p + k_stride));
+                    __m128i _r2 = _mm_loadl_epi64((const __m128i*)(p + k_stride * 2));
+                    __m128i _r3 = _mm_loadl_epi64((const __m128i*)(p + k_stride * 3));
+                    __m128i _t0 = _mm_unpacklo_epi8(_r0, _r1);
+                    __m128i _t2 = _mm_unpacklo_epi8(_r2, _r3);
+
+                    _mm_storeu_si128((__m128i*)out, _mm_xor_si128(_mm_unpacklo_epi16(_t0, _t2), _mask));
+                    _mm_storeu_si128((__m128i*)(out + 16), _mm_xor_si128(_mm_unpackhi_epi16(_t0, _t2), _mask));
+                }
+
+                out += width * 4;
+            }
+        }
+#endif
+
+        for (; k < K4 * 4; k += 4)
+        {
+            for (int j = 0; j < width; j++)
+            {
+                for (int q = 0; q < 4; q++)
+                {
+                    int8_t value = 0;
+
+                    if (j0 + j < N && k + q < K)
+                        value = pB[(size_t)(k + q) * k_stride + (size_t)j * col_stride];
+
+                    *out++ = value ^ mask;
+                }
+            }
+        }
+    }
+}
+
+void sgemm_i8_pack_b(int K, int N, const int8_t* pB, int k_stride, int col_stride, int8_t* pB_t, int width, int flip, int num_thread)
+{
+    struct sgemm_i8_pack_b_job job;
+
+    job.K = K;
+    job.N = N;
+    job.pB = pB;
+    job.k_stride = k_stride;
+    job.col_stride = col_stride;
+    job.pB_t = pB_t;
+    job.width = width;
+    job.flip = flip;
+
+    parallel_for(sgemm_i8_pack_b_block, &job, (N + width - 1) / width, num_thread);
+}
+
+void sgemm_i8_get_offset(int num, int K, const int8_t* w, int channel_stride, int k_stride, int32_t* offset)
+{
+    for (int i = 0; i < num; i++)
+    {
+        int32_t sum = 0;
+
+        for (int k = 0; k < K; k++)
+            sum += w[(size_t)i * channel_stride + (size_t)k * k_stride];
+
+        offset[i] = -128 * sum;
+    }
+}
+
+/* the steps of the int8 conv and fc ref ops, the float results are the same */
+int8_t sgemm_i8_requant_c(const struct sgemm_i8_requant* requant, int32_t sum, int channel)
+{
+    if (requant->bias)
+        sum += requant->bias[channel];
+    if (requant->offset)
+        sum += requant->offset[channel];
+
+    float value = (float)sum * requant->scales[channel];
+
+    if (value < requant->act_min)
+        value = requant->act_min;
+    if (value > requant->act_max)
+        value = requant->act_max;
+
+    value = value / requant->output_scale;
+
+    if (value < -127.f)
+        value = -127.f;
+    if (value > 127.f)
+        value = 127.f;
+
+    return (int8_t)round(value);
+}
+
+void sgemm_i8_tile_c(int kernel, int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                     const struct sgemm_i8_requant* requant, int row, int col)
+{
+    int width = sgemm_i8_get_pack_width(kernel);
+    int flip = sgemm_i8_flip_input(kernel);
+    int channel_col = requant->channel_col;
+
+    for (int r = 0; r < rows; r++)
+    {
+        for (int j = 0; j < cols; j++)
+        {
+            const int8_t* pa = va + r * 4;
+            const int8_t* pb = vb + (j / width) * K4 * width * 4 + (j % width) * 4;
+            int32_t sum = 0;
+
+            for (int k = 0; k < K4; k++)
+            {
+                for (int q = 0; q < 4; q++)
+                {
+                    /* the flipped inputs are uint8 */
+                    int32_t a = flip && channel_col ? (uint8_t)pa[q] : pa[q];
+                    int32_t b = flip && !channel_col ? (uint8_t)pb[q] : pb[q];
+
+                    sum += a * b;
+                }
+
+                pa += 32;
+                pb += width * 4;
+            }
+
+            output[r * ldc + j] = sgemm_i8_requant_c(requant, sum, channel_col ? col + j : row + r);
+        }
+    }
+}
+
+struct sgemm_i8_quant_job
+{
+    int kernel;
+    int M;
+    int N;
+    int K4;
+    const int8_t* pA_t;
+    const int8_t* pB_t;
+    int8_t* pC;
+    int ldc;
+    const struct sgemm_i8_requant* requant;
+    int row_blocks;
+    int tile_cols;
+};
+
+static void sgemm_i8_quant_tile(void* arg, int begin, int end)
+{
+    struct sgemm_i8_quant_job* job = (struct sgemm_i8_quant_job*)arg;
+    int K4 = job->K4;
+    int width = sgemm_i8_get_pack_width(job->kernel);
+
+    for (int t = begin; t < end; t++)
+    {
+        /* the tiles of the same columns are next to each other, the columns of B stay in cache */
+        int row = (t % job->row_blocks) * 8;
+        int col = (t / job->row_blocks) * job->tile_cols;
+        int rows = min(8, job->M - row);
+        int cols = min(job->tile_cols, job->N - col);
+
+        const int8_t* va = job->pA_t + (size_t)row * K4 * 4;
+        const int8_t* vb = job->pB_t + (size_t)col * K4 * 4;
+        int8_t* output = job->pC + (size_t)row * job->ldc + col;
+
+        if (job->kernel == SGEMM_I8_AVX512VNNI)
+            sgemm_i8_tile_avx512vnni(K4, va, vb, rows, cols, output, job->ldc, job->requant, row, col);
+        else if (job->kernel == SGEMM_I8_AVXVNNI)
+            sgemm_i8_tile_avxvnni(K4, va, vb, rows, cols, output, job->ldc, job->requant, row, col);
+        else if (job->kernel == SGEMM_I8_AVX2)
+            sgemm_i8_tile_avx2(K4, va, vb, rows, cols, output, job->ldc, job->requant, row, col);
+        else
+            sgemm_i8_tile_c(job->kernel, K4, va, vb, rows, cols, output, job->ldc, job->requant, row, col);
+    }
+}
+
+/* the min is vectorized, an early exit would not be */
+static int sgemm_i8_has_min(const int8_t* p, int size)
+{
+    int8_t value = 0;
+
+    for (int i = 0; i < size; i++)
+        value = p[i] < value ? p[i] : value;
+
+    return value == -128;
+}
+
+void sgemm_i8_quant(int kernel, int M, int N, int K, const int8_t* pA_t, const int8_t* pB_t, int8_t* pC, int ldc,
+                    const struct sgemm_i8_requant* requant, int num_thread)
+{
+    struct sgemm_i8_quant_job job;
+
+    /* the avx2 tile gives A the sign of B, which leaves -128 negative. the c tile of no isa
+     * reads the same packing, and is exact */
+    if (kernel == SGEMM_I8_AVX2 && sgemm_i8_has_min(pA_t, sgemm_i8_get_pack_a_size(M, K)))
+        kernel = SGEMM_I8_NONE;
+
+    job.kernel = kernel;
+    job.M = M;
+    job.N = N;
+    job.K4 = (K + 3) / 4;
+    job.pA_t = pA_t;
+    job.pB_t = pB_t;
+    job.pC = pC;
+    job.ldc = ldc;
+    job.requant = requant;
+    job.row_blocks = (M + 7) / 8;
+    job.tile_cols = kernel == SGEMM_I8_AVX512VNNI ? 32 : 8;
+
+    int col_tiles = (N + job.tile_cols - 1) / job.tile_cols;
+
+    parallel_for(sgemm_i8_quant_tile, &job, job.row_blocks * col_tiles, num_thread);
+}
+
 static void sgemm_fp32(struct tensor* input, struct tensor* filter, struct tensor* bias,
                        struct tensor* output, struct conv_priv_info* priv_info, struct conv_param* param, int n,
                        int group, int num_thread)
@@ -1793,6 +2336,110 @@ static void sgemm_uint8(struct tensor* input, struct tensor* filter, struct tens
     sys_free(output_sgemm);
 }
 
+struct sgemm_int8_job
+{
+    int out_h;
+    int out_w;
+    struct tensor* bias;
+    int32_t* bias_int32;
+    int32_t* output_sgemm_int32;
+    float* output_sgemm_fp32;
+    float input_scale;
+    float* kernel_scales;
+    int8_t* output_int8;
+    float output_scale;
+};
+
+static void sgemm_int8_dequant(void* arg, int begin, int end)
+{
+    struct sgemm_int8_job* job = (struct sgemm_int8_job*)arg;
+    int out_h = job->out_h;
+    int out_w = job->out_w;
+    struct tensor* bias = job->bias;
+    int32_t* bias_int32 = job->bias_int32;
+    int32_t* output_sgemm_int32 = job->output_sgemm_int32;
+    float* output_sgemm_fp32 = job->output_sgemm_fp32;
+    float input_scale = job->input_scale;
+    float* kernel_scales = job->kernel_scales;
+
+    for (int i = begin; i < end; i++)
+    {
+        for (int j = 0; j < out_h * out_w; j++)
+        {
+            int output_off = i * (out_h * out_w) + j;
+            if (bias)
+                output_sgemm_fp32[output_off] = (float)(output_sgemm_int32[output_off] + bias_int32[i]) * input_scale * kernel_scales[i];
+            else
+                output_sgemm_fp32[output_off] = (float)output_sgemm_int32[output_off] * input_scale * kernel_scales[i];
+        }
+    }
+}
+
+static void sgemm_int8_relu(void* arg, int begin, int end)
+{
+    struct sgemm_int8_job* job = (struct sgemm_int8_job*)arg;
+    int out_h = job->out_h;
+    int out_w = job->out_w;
+    float* output_sgemm_fp32 = job->output_sgemm_fp32;
+
+    for (int i = begin; i < end; i++)
+    {
+        for (int j = 0; j < out_h * out_w; j++)
+        {
+            int output_off = i * (out_h * out_w) + j;
+
+            if (output_sgemm_fp32[output_off] < 0)
+                output_sgemm_fp32[output_off] = 0;
+        }
+    }
+}
+
+static void sgemm_int8_relu6(void* arg, int begin, int end)
+{
+    struct sgemm_int8_job* job = (struct sgemm_int8_job*)arg;
+    int out_h = job->out_h;
+    int out_w = job->out_w;
+    float* output_sgemm_fp32 = job->output_sgemm_fp32;
+
+    for (int i = begin; i < end; i++)
+    {
+        for (int j = 0; j < out_h * out_w; j++)
+        {
+            int output_off = i * (out_h * out_w) + j;
+
+            if (output_sgemm_fp32[output_off] < 0)
+                output_sgemm_fp32[output_off] = 0;
+            if (output_sgemm_fp32[output_off] > 6)
+                output_sgemm_fp32[output_off] = 6;
+        }
+    }
+}
+
+static void sgemm_int8_quant(void* arg, int begin, int end)
+{
+    struct sgemm_int8_job* job = (struct sgemm_int8_job*)arg;
+    int out_h = job->out_h;
+    int out_w = job->out_w;
+    float* output_sgemm_fp32 = job->output_sgemm_fp32;
+    int8_t* output_int8 = job->output_int8;
+    float output_scale = job->output_scale;
+
+    for (int i = begin; i < end; i++)
+    {
+        for (int j = 0; j < out_h * out_w; j++)
+        {
+            int output_off = i * (out_h * out_w) + j;
+
+            int32_t data_i32 = (int32_t)(round(output_sgemm_fp32[output_off] / output_scale));
+            if (data_i32 > 127)
+                data_i32 = 127;
+            else if (data_i32 < -127)
+                data_i32 = -127;
+            output_int8[output_off] = (int8_t)data_i32;
+        }
+    }
+}
+
 static void sgemm_int8(struct tensor* input, struct tensor* filter, struct tensor* bias,
                        struct tensor* output, struct conv_priv_info* priv_info, struct conv_param* param, int n,
                        int group, int num_thread)
@@ -1823,73 +2470,152 @@ static void sgemm_int8(struct tensor* input, struct tensor* filter, struct tenso
 
     sgemm_i8(outchan_g, out_h * out_w, kernel_size, filter_sgemm, input_sgemm_pack4, output_sgemm_int32, num_thread);
 
+    struct sgemm_int8_job job;
+
+    job.out_h = out_h;
+    job.out_w = out_w;
+    job.bias = bias;
+    job.bias_int32 = bias_int32;
+    job.output_sgemm_int32 = output_sgemm_int32;
+    job.output_sgemm_fp32 = output_sgemm_fp32;
+    job.input_scale = input_scale;
+    job.kernel_scales = kernel_scales;
+    job.output_int8 = output_int8;
+    job.output_scale = output_scale;
+
     /* process bias and dequant output from int32 to fp32 */
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = 0; i < outchan_g; i++)
-    {
-        for (int j = 0; j < out_h * out_w; j++)
-        {
-            int output_off = i * (out_h * out_w) + j;
-            if (bias)
-                output_sgemm_fp32[output_off] = (float)(output_sgemm_int32[output_off] + bias_int32[i]) * input_scale * kernel_scales[i];
-            else
-                output_sgemm_fp32[output_off] = (float)output_sgemm_int32[output_off] * input_scale * kernel_scales[i];
-        }
-    }
+    parallel_for(sgemm_int8_dequant, &job, outchan_g, num_thread);
 
     /* process activation relu */
     if (param->activation == 0)
     {
-#pragma omp parallel for num_threads(num_thread)
-        for (int i = 0; i < outchan_g; i++)
-        {
-            for (int j = 0; j < out_h * out_w; j++)
-            {
-                int output_off = i * (out_h * out_w) + j;
-
-                if (output_sgemm_fp32[output_off] < 0)
-                    output_sgemm_fp32[output_off] = 0;
-            }
-        }
+        parallel_for(sgemm_int8_relu, &job, outchan_g, num_thread);
     }
 
     /* process activation relu6 */
     if (param->activation > 0)
     {
-#pragma omp parallel for num_threads(num_thread)
-        for (int i = 0; i < outchan_g; i++)
-        {
-            for (int j = 0; j < out_h * out_w; j++)
-            {
-                int output_off = i * (out_h * out_w) + j;
-
-                if (output_sgemm_fp32[output_off] < 0)
-                    output_sgemm_fp32[output_off] = 0;
-                if (output_sgemm_fp32[output_off] > 6)
-                    output_sgemm_fp32[output_off] = 6;
-            }
-        }
+        parallel_for(sgemm_int8_relu6, &job, outchan_g, num_thread);
     }
 
     /* quant from fp32 to int8 */
-    for (int i = 0; i < outchan_g; i++)
+    parallel_for(sgemm_int8_quant, &job, outchan_g, num_thread);
+
+    sys_free(output_sgemm_int32);
+    sys_free(output_sgemm_fp32);
+}
+
+/* the int8 conv on the int8 sgemm, the im2col is packed as B and the sums are requantized at once */
+static void sgemm_int8_requant(struct tensor* input, struct tensor* filter, struct tensor* bias,
+                               struct tensor* output, struct conv_priv_info* priv_info, struct conv_param* param, int n,
+                               int group, int num_thread)
+{
+    int kernel_size = param->kernel_h * param->kernel_w * param->input_channel / param->group;
+    int outchan_g = param->output_channel / param->group;
+
+    int out_h = output->dims[2];
+    int out_w = output->dims[3];
+    int out_image_size = output->dims[1] * output->dims[2] * output->dims[3];
+    int channel = outchan_g * group;
+
+    int8_t* interleave_int8 = (int8_t*)priv_info->interleave_buffer_pack4 + group * sgemm_i8_get_pack_a_size(outchan_g, kernel_size);
+    int8_t* output_int8 = (int8_t*)output->data + n * out_image_size + channel * out_h * out_w;
+    int8_t* input_int8 = (int8_t*)priv_info->im2col_buffer;
+
+    /* the input is the im2col of 1x1s1 */
+    if (param->kernel_h == 1 && param->kernel_w == 1 && param->stride_h == 1 && param->stride_w == 1
+        && param->pad_h0 == 0 && param->pad_h1 == 0 && param->pad_w0 == 0 && param->pad_w1 == 0)
     {
-#pragma omp parallel for num_threads(num_thread)
-        for (int j = 0; j < out_h * out_w; j++)
-        {
-            int output_off = i * (out_h * out_w) + j;
+        int input_image_size = input->dims[1] * input->dims[2] * input->dims[3];
+        input_int8 = (int8_t*)input->data + n * input_image_size + group * kernel_size * out_h * out_w;
+    }
+    else
+    {
+        im2col_ir(input, output, priv_info, param, n, group);
+    }
 
-            int32_t data_i32 = (int32_t)(round(output_sgemm_fp32[output_off] / output_scale));
-            if (data_i32 > 127)
-                data_i32 = 127;
-            else if (data_i32 < -127)
-                data_i32 = -127;
-            output_int8[output_off] = (int8_t)data_i32;
+    int kernel = priv_info->sgemm_i8_kernel;
+
+    sgemm_i8_pack_b(kernel_size, out_h * out_w, input_int8, out_h * out_w, 1, (int8_t*)priv_info->im2col_buffer_pack4,
+                    sgemm_i8_get_pack_width(kernel), sgemm_i8_flip_input(kernel), num_thread);
+
+    struct sgemm_i8_requant requant;
+
+    requant.bias = bias ? (int32_t*)bias->data + channel : NULL;
+    requant.offset = priv_info->sgemm_i8_offset ? priv_info->sgemm_i8_offset + channel : NULL;
+    requant.scales = priv_info->sgemm_i8_scales + channel;
+    requant.output_scale = output->scale;
+    requant.channel_col = 0;
+
+    /* as the int8 conv ref op */
+    requant.act_min = -INFINITY;
+    requant.act_max = INFINITY;
+
+    if (param->activation == 1)
+    {
+        requant.act_min = -1.f;
+        requant.act_max = 1.f;
+    }
+    else if (param->activation >= 0)
+    {
+        requant.act_min = 0.f;
+
+        if (param->activation == 6)
+            requant.act_max = 6.f;
+    }
+
+    sgemm_i8_quant(kernel, outchan_g, out_h * out_w, kernel_size, interleave_int8,
+                   (int8_t*)priv_info->im2col_buffer_pack4, output_int8, out_h * out_w, &requant, num_thread);
+}
+
+static int sgemm_int8_requant_prerun(struct tensor* input_tensor, struct tensor* filter_tensor, struct conv_priv_info* priv_info,
+                                     struct conv_param* param)
+{
+    int kernel = priv_info->sgemm_i8_kernel;
+    int M = filter_tensor->dims[0];
+    int K = filter_tensor->elem_num / filter_tensor->dims[0];
+    int outchan_g = M / param->group;
+    int pack_size = sgemm_i8_get_pack_a_size(outchan_g, K);
+
+    int cached = priv_info->cached_weight != NULL && priv_info->cached_weight_size == pack_size * param->group;
+
+    int8_t* pack = cached ? (int8_t*)priv_info->cached_weight : (int8_t*)sys_malloc((size_t)pack_size * param->group);
+    float* scales = (float*)sys_malloc(M * sizeof(float));
+
+    if (pack == NULL || scales == NULL)
+    {
+        if (!cached)
+            sys_free(pack);
+        sys_free(scales);
+        return -1;
+    }
+
+    for (int g = 0; g < param->group && !cached; g++)
+        sgemm_i8_pack_a(outchan_g, K, (int8_t*)filter_tensor->data + g * outchan_g * K, K, 1, pack + g * pack_size, 0);
+
+    for (int i = 0; i < M; i++)
+        scales[i] = input_tensor->scale * filter_tensor->scale_list[i];
+
+    if (sgemm_i8_flip_input(kernel))
+    {
+        priv_info->sgemm_i8_offset = (int*)sys_malloc(M * sizeof(int));
+
+        if (priv_info->sgemm_i8_offset == NULL)
+        {
+            if (!cached)
+                sys_free(pack);
+            sys_free(scales);
+            return -1;
         }
+
+        sgemm_i8_get_offset(M, K, (int8_t*)filter_tensor->data, K, 1, (int32_t*)priv_info->sgemm_i8_offset);
     }
 
-    sys_free(output_sgemm_int32);
-    sys_free(output_sgemm_fp32);
+    priv_info->interleave_buffer_pack4 = pack;
+    priv_info->interleave_buffer_pack4_size = pack_size * param->group;
+    priv_info->sgemm_i8_scales = scales;
+
+    return 0;
 }
 
 /* check the conv wheather need to be using winograd */
@@ -1914,6 +2640,22 @@ static int winograd_support(struct conv_param* param, int in_h, int in_w)
     return 1;
 }
 
+int conv_hcl_nchwc_support(struct tensor* input, struct tensor* output, struct conv_param* param)
+{
+    if (input->data_type != TENGINE_DT_FP32 || param->group != 1)
+        return 0;
+
+    /* winograd runs on the plain layout */
+    if (winograd_support(param, input->dims[2], input->dims[3]))
+        return 0;
+
+    /* the direct kernel streams the weights of 16 output channels for each output row,
+       sgemm does better once they no longer stay in the cache */
+    int weight_size = param->kernel_h * param->kernel_w * param->input_channel * 16 * (int)sizeof(float);
+
+    return weight_size <= 128 * 1024;
+}
+
 int conv_hcl_get_shared_mem_size(struct tensor* input, struct tensor* output, struct conv_param* param)
 {
     int group = param->group;
@@ -1939,7 +2681,13 @@ int conv_hcl_get_shared_pack4_mem_size(struct tensor* filter, struct tensor* out
     if (filter->data_type == TENGINE_DT_UINT8)
         elem_size = 4;
 
-    return (8 * K * (N / 8 + N % 8)) * elem_size;
+    int size = (8 * K * (N / 8 + N % 8)) * elem_size;
+
+    /* packed for the int8 sgemm of any kernel */
+    if (filter->data_type == TENGINE_DT_INT8)
+        size = max(size, sgemm_i8_get_pack_b_size(K, N, 16));
+
+    return size;
 }
 
 int conv_hcl_get_interleave_pack4_size(int M, int K, struct tensor* filter)
@@ -1954,11 +2702,8 @@ int conv_hcl_get_interleave_pack4_size(int M, int K, struct tensor* filter)
     return size;
 }
 
-void conv_hcl_interleave_pack4_fp32(int M, int K, struct conv_priv_info* priv_info)
+void interleave_pack4_fp32(int M, int K, float* pA, float* pA_t)
 {
-    float* pA = (float*)priv_info->interleave_buffer;
-    float* pA_t = (float*)priv_info->interleave_buffer_pack4;
-
     int nn_outch = M >> 3;
     int remain_outch_start = nn_outch << 3;
 
@@ -2044,6 +2789,11 @@ void conv_hcl_interleave_pack4_fp32(int M, int K, struct conv_priv_info* priv_in
     }
 }
 
+void conv_hcl_interleave_pack4_fp32(int M, int K, struct conv_priv_info* priv_info)
+{
+    interleave_pack4_fp32(M, K, (float*)priv_info->interleave_buffer, (float*)priv_info->interleave_buffer_pack4);
+}
+
 void conv_hcl_interleave_pack4_int8(int M, int K, struct conv_priv_info* priv_info)
 {
     int8_t* pA = (int8_t*)priv_info->interleave_buffer;
@@ -2165,6 +2915,32 @@ int conv_hcl_prerun(struct tensor* input_tensor, struct tensor* filter_tensor, s
         priv_info->im2col_buffer_pack4_size = mem_size;
     }
 
+    /* the weights are kept packed when resized */
+    if (priv_info->interleave_buffer_pack4 != NULL)
+        return 0;
+
+    if (input_tensor->data_type == TENGINE_DT_INT8)
+    {
+        priv_info->sgemm_i8_kernel = sgemm_i8_get_kernel();
+
+        if (priv_info->sgemm_i8_kernel != SGEMM_I8_NONE)
+            return sgemm_int8_requant_prerun(input_tensor, filter_tensor, priv_info, param);
+    }
+
+    /* the weights packed by the prepack cache */
+    if (priv_info->external_interleave_pack4_mem && priv_info->cached_weight != NULL)
+    {
+        int M = filter_tensor->dims[0];
+        int K = filter_tensor->elem_num / filter_tensor->dims[0];
+
+        if (priv_info->cached_weight_size == conv_hcl_get_interleave_pack4_size(M, K, filter_tensor))
+        {
+            priv_info->interleave_buffer_pack4 = priv_info->cached_weight;
+            priv_info->interleave_buffer_pack4_size = priv_info->cached_weight_size;
+            return 0;
+        }
+    }
+
     if (!priv_info->external_interleave_mem)
     {
         int mem_size = get_private_mem_size(filter_tensor);
@@ -2215,9 +2991,21 @@ int conv_hcl_postrun(struct conv_priv_info* priv_info)
         return wino_conv_hcl_postrun(priv_info);
     }
 
+    if (priv_info->sgemm_i8_scales != NULL)
+    {
+        if (priv_info->interleave_buffer_pack4 != priv_info->cached_weight)
+            sys_free(priv_info->interleave_buffer_pack4);
+        sys_free(priv_info->sgemm_i8_scales);
+        sys_free(priv_info->sgemm_i8_offset);
+        priv_info->interleave_buffer_pack4 = NULL;
+        priv_info->sgemm_i8_scales = NULL;
+        priv_info->sgemm_i8_offset = NULL;
+    }
+
     if (priv_info->external_interleave_pack4_mem && !priv_info->external_interleave_mem && priv_info->interleave_buffer != NULL)
     {
-        sys_free(priv_info->interleave_buffer_pack4);
+        if (priv_info->interleave_buffer_pack4 != priv_info->cached_weight)
+            sys_free(priv_info->interleave_buffer_pack4);
         priv_info->interleave_buffer_pack4 = NULL;
     }
 
@@ -2233,10 +3021,49 @@ int conv_hcl_postrun(struct conv_priv_info* priv_info)
     }
     if (priv_info->external_interleave_pack4_mem && priv_info->interleave_buffer_pack4 != NULL)
     {
-        sys_free(priv_info->interleave_buffer_pack4);
+        if (priv_info->interleave_buffer_pack4 != priv_info->cached_weight)
+            sys_free(priv_info->interleave_buffer_pack4);
         priv_info->interleave_buffer_pack4 = NULL;
     }
 
+    /* the weights are packed again in the next prerun */
+    priv_info->cached_weight = NULL;
+    priv_info->cached_weight_size = 0;
+
+    return 0;
+}
+
+int conv_hcl_resize(struct tensor* input_tensor, struct conv_priv_info* priv_info, struct conv_param* param)
+{
+    int in_h = input_tensor->dims[2];
+    int in_w = input_tensor->dims[3];
+
+    int winograd = input_tensor->data_type == TENGINE_DT_FP32 && winograd_support(param, in_h, in_w);
+
+    /* the weights are packed in another way, pack them again in prerun */
+    if (winograd != priv_info->winograd)
+    {
+        if (conv_hcl_postrun(priv_info) < 0)
+            return -1;
+    }
+    else if (priv_info->winograd)
+    {
+        return wino_conv_hcl_resize(priv_info);
+    }
+    else
+    {
+        if (!priv_info->external_im2col_mem && priv_info->im2col_buffer != NULL)
+            sys_free(priv_info->im2col_buffer);
+        if (!priv_info->external_im2col_pack4_mem && priv_info->im2col_buffer_pack4 != NULL)
+            sys_free(priv_info->im2col_buffer_pack4);
+    }
+
+    /* prerun binds the shared mem or allocates them again */
+    priv_info->external_im2col_mem = 0;
+    priv_info->im2col_buffer = NULL;
+    priv_info->external_im2col_pack4_mem = 0;
+    priv_info->im2col_buffer_pack4 = NULL;
+
     return 0;
 }
 
@@ -2257,6 +3084,12 @@ int conv_hcl_run(struct tensor* input_tensor, struct tensor* filter_tensor, stru
     {
         for (int j = 0; j < group; j++)
         {
+            if (type == TENGINE_DT_INT8 && priv_info->sgemm_i8_kernel != SGEMM_I8_NONE)
+            {
+                sgemm_int8_requant(input_tensor, filter_tensor, bias_tensor, output_tensor, priv_info, param, i, j, num_thread);
+                continue;
+            }
+
             im2col_ir(input_tensor, output_tensor, priv_info, param, i, j);
 
             int K = filter_tensor->elem_num / filter_tensor->dims[0];
@@ -2293,6 +3126,65 @@ int conv_hcl_run(struct tensor* input_tensor, struct tensor* filter_tensor, stru
     return 0;
 }
 
+/* the elements are cut in blocks for the threads */
+#define RESIDUAL_BLOCK 4096
+
+struct residual_job
+{
+    const float* residual;
+    float* output;
+    int size;
+    float min;
+    float max;
+};
+
+static void residual_block(void* arg, int begin, int end)
+{
+    struct residual_job* job = (struct residual_job*)arg;
+    const float* residual = job->residual;
+    float* output = job->output;
+
+    int i = begin * RESIDUAL_BLOCK;
+    int size = end * RESIDUAL_BLOCK < job->size ? end * RESIDUAL_BLOCK : job->size;
+
+#if __AVX__
+    __m256 _min = _mm256_set1_ps(job->min);
+    __m256 _max = _mm256_set1_ps(job->max);
+
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _v = _mm256_add_ps(_mm256_loadu_ps(output + i), _mm256_loadu_ps(residual + i));
+        _v = _mm256_min_ps(_max, _mm256_max_ps(_min, _v));
+        _mm256_storeu_ps(output + i, _v);
+    }
+#endif
+    for (; i < size; i++)
+    {
+        float v = output[i] + residual[i];
+        v = v < job->min ? job->min : v;
+        output[i] = v > job->max ? job->max : v;
+    }
+}
+
+void conv_hcl_residual_fp32(const float* residual, float* output, int size, int activation, int num_thread)
+{
+    struct residual_job job;
+
+    job.residual = residual;
+    job.output = output;
+    job.size = size;
+    job.min = -INFINITY;
+    job.max = INFINITY;
+
+    /* as the activation of sgemm_fp32 */
+    if (activation >= 0)
+        job.min = 0.f;
+    if (activation > 0)
+        job.max = (float)activation;
+
+    parallel_for(residual_block, &job, (size + RESIDUAL_BLOCK - 1) / RESIDUAL_BLOCK, num_thread);
+}
+
 int conv_hcl_set_shared_mem(struct conv_priv_info* priv_info, void* mem, int mem_size)
 {
     priv_info->external_im2col_mem = 1;
@@ -31,16 +31,27 @@
 #include "graph/node.h"
 #include "graph/graph.h"
 
+#include <stdint.h>
+
 /* float32 */
 int conv_hcl_prerun(struct tensor* input_tensor, struct tensor* filter_tensor, struct tensor* output_tensor,
                     struct conv_priv_info* info, struct conv_param* param);
 
 int conv_hcl_postrun(struct conv_priv_info* info);
 
+/* free the buffers depending on the input shape, the packed weights are kept for the next prerun */
+int conv_hcl_resize(struct tensor* input_tensor, struct conv_priv_info* info, struct conv_param* param);
+
 int conv_hcl_run(struct tensor* input_tensor, struct tensor* filter_tensor, struct tensor* bias_tensor,
                  struct tensor* output_tensor, struct conv_priv_info* conv_info, struct conv_param* param,
                  int num_thread, int cpu_affinity);
 
+/* add the residual fused from an eltwise sum to the output of the conv run without activation, then the activation */
+void conv_hcl_residual_fp32(const float* residual, float* output, int size, int activation, int num_thread);
+
+/* check if the conv may run the direct kernel of the blocked layout, see conv_nchwc_kernel_x86.h */
+int conv_hcl_nchwc_support(struct tensor* input_tensor, struct tensor* output_tensor, struct conv_param* param);
+
 int conv_hcl_get_shared_mem_size(struct tensor* input_tensor, struct tensor* output_tensor,
                                  struct conv_param* param);
 int conv_hcl_get_shared_pack4_mem_size(struct tensor* input_tensor, struct tensor* output_tensor,
@@ -50,4 +61,79 @@ int conv_hcl_set_shared_mem(struct conv_priv_info* priv_info, void* mem, int mem
 
 int conv_hcl_set_shared_pack4_mem(struct conv_priv_info* priv_info, void* mem, int mem_size);
 
+/* the sgemm used by conv, C[M, N] = A[M, K] * B[K, N], also used by the other x86 ops */
+
+/* pack the rows of A by 8, 4 and 1, pA_t takes 8 * K * (M / 8 + (M % 8) / 4 + M % 4) floats */
+void interleave_pack4_fp32(int M, int K, float* pA, float* pA_t);
+
+/* pack the columns of B by 8 and 1, pB_t takes 8 * K * (N / 8 + N % 8) floats */
+void input_pack4_fp32(int K, int N, float* pB, float* pB_t, int num_thread);
+
+void sgemm_fp(int M, int N, int K, float* pA_t, float* pB_t, float* pC, int num_thread);
+
+/* C[8, 16] of the rows packed at va and the columns blocks vb0 and vb1, only for the cpu with avx512f */
+void sgemm_fp_8x16_avx512(int K, const float* va, const float* vb0, const float* vb1, float* output, int ldc);
+
+/*
+ * the int8 sgemm requantizing the int32 sums to int8 at once, C[M, N] = A[M, K] * B[K, N].
+ * the k of A and B are packed by 4 for the dot product instructions, the values of A are
+ * broadcast and the columns of B are the vector lanes. the output channels are the rows
+ * of C for conv, and the columns for fc.
+ */
+#define SGEMM_I8_NONE       0 /* the cpu has no avx2 */
+#define SGEMM_I8_AVX2       1 /* vpmaddubsw of the abs of B and A of its sign, an A of -128 runs on the c tile */
+#define SGEMM_I8_AVXVNNI    2 /* vpdpbusd of 8 columns */
+#define SGEMM_I8_AVX512VNNI 3 /* vpdpbusd of 32 columns */
+
+struct sgemm_i8_requant
+{
+    const int32_t* bias;   /* of the output channels, NULL for none */
+    const int32_t* offset; /* of the output channels for the flipped inputs, NULL for none */
+    const float* scales;   /* of the output channels, the sums are dequantized with them */
+    float output_scale;    /* the dequantized value is divided by it, then rounded and clamped to [-127, 127] */
+    float act_min;
+    float act_max;
+    int channel_col; /* the output channels are the columns of C */
+};
+
+/* the kernel for the isa of the cpu */
+int sgemm_i8_get_kernel(void);
+
+/* the vnni kernels take the inputs as uint8, the A or B without the output channels is flipped by xor 0x80 */
+int sgemm_i8_flip_input(int kernel);
+
+/* the count of the columns of B packed together */
+int sgemm_i8_get_pack_width(int kernel);
+
+/* pack the rows of A[M, K] by 8 as [M / 8][K / 4][8][4], padded with 0, the value of A[i, k] is at pA[i * row_stride + k * k_stride] */
+int sgemm_i8_get_pack_a_size(int M, int K);
+void sgemm_i8_pack_a(int M, int K, const int8_t* pA, int row_stride, int k_stride, int8_t* pA_t, int flip);
+
+/* pack the columns of B[K, N] by width as [N / width][K / 4][width][4], the value of B[k, j] is at pB[k * k_stride + j * col_stride] */
+int sgemm_i8_get_pack_b_size(int K, int N, int width);
+void sgemm_i8_pack_b(int K, int N, const int8_t* pB, int k_stride, int col_stride, int8_t* pB_t, int width, int flip, int num_thread);
+
+/* the offset of the output channels in the weights w[num, K] for the flipped inputs, -128 * sum(w) */
+void sgemm_i8_get_offset(int num, int K, const int8_t* w, int channel_stride, int k_stride, int32_t* offset);
+
+void sgemm_i8_quant(int kernel, int M, int N, int K, const int8_t* pA_t, const int8_t* pB_t, int8_t* pC, int ldc,
+                    const struct sgemm_i8_requant* requant, int num_thread);
+
+/* C[rows, cols] of 8 rows at va and the columns at vb, up to 32 columns for avx512vnni and 8 for the others */
+void sgemm_i8_tile_avx2(int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                        const struct sgemm_i8_requant* requant, int row, int col);
+void sgemm_i8_tile_avxvnni(int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                           const struct sgemm_i8_requant* requant, int row, int col);
+void sgemm_i8_tile_avx512vnni(int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                              const struct sgemm_i8_requant* requant, int row, int col);
+
+/* the c version of the tiles and the requantization, for the kernels not built with their isa */
+int8_t sgemm_i8_requant_c(const struct sgemm_i8_requant* requant, int32_t sum, int channel);
+void sgemm_i8_tile_c(int kernel, int K4, const int8_t* va, const int8_t* vb, int rows, int cols, int8_t* output, int ldc,
+                     const struct sgemm_i8_requant* requant, int row, int col);
+
+/* requantize the int32 sums[rows, 8] of the 8 columns kernels */
+void sgemm_i8_requant_avx2(const int32_t* sum, int rows, int cols, int8_t* output, int ldc,
+                           const struct sgemm_i8_requant* requant, int row, int col);
+
 #endif
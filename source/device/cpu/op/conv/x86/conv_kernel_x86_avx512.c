@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "conv_kernel_x86.h"
+
+#if __AVX512F__
+#include <immintrin.h>
+#endif
+
+/*
+ * built with avx512f whatever the isa of the other x86 sources, see the cpu CMakeLists.txt,
+ * so it is called only on a cpu with avx512f. the sums are added in the same order as the
+ * 8 columns kernel of sgemm_fp.
+ */
+void sgemm_fp_8x16_avx512(int K, const float* va, const float* vb0, const float* vb1, float* output, int ldc)
+{
+#if __AVX512F__
+    __m512 _sum0 = _mm512_setzero_ps();
+    __m512 _sum1 = _mm512_setzero_ps();
+    __m512 _sum2 = _mm512_setzero_ps();
+    __m512 _sum3 = _mm512_setzero_ps();
+    __m512 _sum4 = _mm512_setzero_ps();
+    __m512 _sum5 = _mm512_setzero_ps();
+    __m512 _sum6 = _mm512_setzero_ps();
+    __m512 _sum7 = _mm512_setzero_ps();
+
+    for (int k = 0; k < K; k++)
+    {
+        /* the columns 0-7 from vb0 and 8-15 from vb1 */
+        __m512d _vb = _mm512_castpd256_pd512(_mm256_castps_pd(_mm256_loadu_ps(vb0)));
+        __m512 _vb0 = _mm512_castpd_ps(_mm512_insertf64x4(_vb, _mm256_castps_pd(_mm256_loadu_ps(vb1)), 1));
+
+        _sum0 = _mm512_fmadd_ps(_vb0, _mm512_set1_ps(va[0]), _sum0);
+        _sum1 = _mm512_fmadd_ps(_vb0, _mm512_set1_ps(va[1]), _sum1);
+        _sum2 = _mm512_fmadd_ps(_vb0, _mm512_set1_ps(va[2]), _sum2);
+        _sum3 = _mm512_fmadd_ps(_vb0, _mm512_set1_ps(va[3]), _sum3);
+        _sum4 = _mm512_fmadd_ps(_vb0, _mm512_set1_ps(va[4]), _sum4);
+        _sum5 = _mm512_fmadd_ps(_vb0, _mm512_set1_ps(va[5]), _sum5);
+        _sum6 = _mm512_fmadd_ps(_vb0, _mm512_set1_ps(va[6]), _sum6);
+        _sum7 = _mm512_fmadd_ps(_vb0, _mm512_set1_ps(va[7]), _sum7);
+
+        va += 8;
+        vb0 += 8;
+        vb1 += 8;
+    }
+
+    _mm512_storeu_ps(output, _sum0);
+    _mm512_storeu_ps(output + ldc, _sum1);
+    _mm512_storeu_ps(output + ldc * 2, _sum2);
+    _mm512_storeu_ps(output + ldc * 3, _sum3);
+    _mm512_storeu_ps(output + ldc * 4, _sum4);
+    _mm512_storeu_ps(output + ldc * 5, _sum5);
+    _mm512_storeu_ps(output + ldc * 6, _sum6);
+    _mm512_storeu_ps(output + ldc * 7, _sum7);
+#else
+    for (int r = 0; r < 8; r++)
+    {
+        for (int n = 0; n < 16; n++)
+        {
+            const float* vb = n < 8 ? vb0 + n : vb1 + n - 8;
+            float sum = 0.f;
+
+            for (int k = 0; k < K; k++)
+                sum += va[k * 8 + r] * vb[k * 8];
+
+            output[r * ldc + n] = sum;
+        }
+    }
+#endif
+}
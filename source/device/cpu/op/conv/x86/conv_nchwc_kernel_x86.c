@@ -0,0 +1,682 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "conv_nchwc_kernel_x86.h"
+
+#include "graph/tensor.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/thread_pool.h"
+
+#include <math.h>
+#include <string.h>
+
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#define NCHWC_BLOCK 8
+
+int conv_nchwc_get_block(void)
+{
+#if __AVX__
+    return NCHWC_BLOCK;
+#else
+    return 0;
+#endif
+}
+
+int conv_nchwc_enabled(struct tensor* input_tensor, struct tensor* output_tensor, struct tensor* residual_tensor)
+{
+    if (residual_tensor != NULL && get_layout_channel_block(residual_tensor->layout) > 1)
+        return 1;
+
+    return get_layout_channel_block(input_tensor->layout) > 1 || get_layout_channel_block(output_tensor->layout) > 1;
+}
+
+static int get_block_num(int channel)
+{
+    return (channel + NCHWC_BLOCK - 1) / NCHWC_BLOCK;
+}
+
+int conv_nchwc_get_weight_size(struct tensor* filter_tensor, struct conv_param* param)
+{
+    int block_num = get_block_num(param->output_channel);
+    int kernel_size = param->kernel_h * param->kernel_w * (param->input_channel / param->group);
+
+    return (int)sizeof(float) * block_num * NCHWC_BLOCK * (kernel_size + 1);
+}
+
+/* [block][kh][kw][ic][8] of the filter [oc][ic][kh][kw], the padded channels are 0, then the bias of [block][8] */
+static void pack_weight(const float* filter, const float* bias, float* weight, struct conv_param* param)
+{
+    int out_c = param->output_channel;
+    int in_c = param->input_channel / param->group;
+    int kernel_hw = param->kernel_h * param->kernel_w;
+    int block_num = get_block_num(out_c);
+
+    float* ptr = weight;
+
+    for (int b = 0; b < block_num; b++)
+    {
+        for (int k = 0; k < kernel_hw; k++)
+        {
+            for (int ic = 0; ic < in_c; ic++)
+            {
+                for (int l = 0; l < NCHWC_BLOCK; l++)
+                {
+                    int oc = b * NCHWC_BLOCK + l;
+
+                    *ptr++ = oc < out_c ? filter[(oc * in_c + ic) * kernel_hw + k] : 0.f;
+                }
+            }
+        }
+    }
+
+    for (int oc = 0; oc < block_num * NCHWC_BLOCK; oc++)
+        *ptr++ = (bias != NULL && oc < out_c) ? bias[oc] : 0.f;
+}
+
+int conv_nchwc_prerun(struct tensor* input_tensor, struct tensor* filter_tensor, struct tensor* bias_tensor,
+                      struct conv_priv_info* info, struct conv_param* param)
+{
+    info->nchwc = 1;
+
+    /* the depthwise kernel reads the blocked input only */
+    if (param->group > 1 && get_layout_channel_block(input_tensor->layout) == 1)
+    {
+        int size = (int)sizeof(float) * get_block_num(input_tensor->dims[1]) * NCHWC_BLOCK * input_tensor->dims[2] * input_tensor->dims[3];
+
+        info->nchwc_input = (float*)sys_malloc(size);
+        info->nchwc_input_size = size;
+
+        if (info->nchwc_input == NULL)
+            return -1;
+    }
+
+    /* the weights are kept packed when resized */
+    if (info->nchwc_weight != NULL)
+        return 0;
+
+    int weight_size = conv_nchwc_get_weight_size(filter_tensor, param);
+
+    /* the weights packed by the prepack cache */
+    if (info->cached_weight != NULL && info->cached_weight_size == weight_size)
+    {
+        info->nchwc_weight = (float*)info->cached_weight;
+        return 0;
+    }
+
+    info->nchwc_weight = (float*)sys_malloc(weight_size);
+
+    if (info->nchwc_weight == NULL)
+        return -1;
+
+    pack_weight((const float*)filter_tensor->data, bias_tensor ? (const float*)bias_tensor->data : NULL, info->nchwc_weight, param);
+
+    return 0;
+}
+
+int conv_nchwc_resize(struct conv_priv_info* info)
+{
+    if (info->nchwc_input != NULL)
+        sys_free(info->nchwc_input);
+
+    info->nchwc_input = NULL;
+    info->nchwc_input_size = 0;
+
+    return 0;
+}
+
+int conv_nchwc_postrun(struct conv_priv_info* info)
+{
+    conv_nchwc_resize(info);
+
+    if (info->nchwc_weight != NULL && (void*)info->nchwc_weight != info->cached_weight)
+        sys_free(info->nchwc_weight);
+
+    info->nchwc_weight = NULL;
+    info->nchwc = 0;
+    info->cached_weight = NULL;
+    info->cached_weight_size = 0;
+
+    return 0;
+}
+
+#if __AVX__
+struct nchwc_conv_job
+{
+    const float* input;
+    const float* weight;
+    const float* bias;
+    const float* residual;
+    float* output;
+    int in_c;
+    int in_h;
+    int in_w;
+    int in_step;         /* the floats from a pixel to the next, 8 for the blocked input */
+    int ic_block;        /* the input channels of a block, all of them for the plain input */
+    int ic_stride;       /* the floats from a channel to the next in a block */
+    size_t block_stride; /* the floats from a block of the input channels to the next */
+    int out_c;
+    int out_h;
+    int out_w;
+    int block_num;
+    int out_blocked;
+    int res_blocked;
+    int kernel_h;
+    int kernel_w;
+    int stride_h;
+    int stride_w;
+    int dilation_h;
+    int dilation_w;
+    int pad_h;
+    int pad_w;
+    int x_begin; /* the output columns in [x_begin, x_end) read no padding */
+    int x_end;
+    float min;
+    float max;
+};
+
+/* the kernel positions [*begin, *end) reading no padding for an output position */
+static void get_kernel_range(int pos, int stride, int pad, int dilation, int kernel, int in_size, int* begin, int* end)
+{
+    int start = pos * stride - pad;
+    int b = 0;
+    int e = kernel;
+
+    while (b < kernel && start + b * dilation < 0)
+        b++;
+    while (e > b && start + (e - 1) * dilation >= in_size)
+        e--;
+
+    *begin = b;
+    *end = e;
+}
+
+/* add the bias and the residual to the 8 channels of a block at a pixel, then the activation and store */
+static inline void store_block(const struct nchwc_conv_job* job, int b, int pixel, __m256 v)
+{
+    int out_hw = job->out_h * job->out_w;
+    int lanes = job->out_c - b * NCHWC_BLOCK < NCHWC_BLOCK ? job->out_c - b * NCHWC_BLOCK : NCHWC_BLOCK;
+
+    v = _mm256_add_ps(v, _mm256_loadu_ps(job->bias + b * NCHWC_BLOCK));
+
+    if (job->residual != NULL)
+    {
+        if (job->res_blocked)
+        {
+            v = _mm256_add_ps(v, _mm256_loadu_ps(job->residual + ((size_t)b * out_hw + pixel) * NCHWC_BLOCK));
+        }
+        else
+        {
+            float res[NCHWC_BLOCK] = {0.f};
+
+            for (int l = 0; l < lanes; l++)
+                res[l] = job->residual[(size_t)(b * NCHWC_BLOCK + l) * out_hw + pixel];
+
+            v = _mm256_add_ps(v, _mm256_loadu_ps(res));
+        }
+    }
+
+    v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(job->min)), _mm256_set1_ps(job->max));
+
+    if (job->out_blocked)
+    {
+        _mm256_storeu_ps(job->output + ((size_t)b * out_hw + pixel) * NCHWC_BLOCK, v);
+    }
+    else
+    {
+        float out[NCHWC_BLOCK];
+
+        _mm256_storeu_ps(out, v);
+
+        for (int l = 0; l < lanes; l++)
+            job->output[(size_t)(b * NCHWC_BLOCK + l) * out_hw + pixel] = out[l];
+    }
+}
+
+/*
+ * n pixels, at most 6, of nb output blocks from the column x, the pixels are step floats apart in the input.
+ * the columns read no padding, unless n is 1 and the kernel columns are cut to [kw0, kw1).
+ * it is inlined with nb and n known, so the sums of the pixels out of the tile are dropped.
+ */
+static inline __attribute__((always_inline)) void conv_tile(const struct nchwc_conv_job* job, const float* weight, int nb, int n, int step,
+                                                            int b, int y, int x, int kh0, int kh1, int kw0, int kw1)
+{
+    int in_c = job->in_c;
+    int block_size = job->kernel_h * job->kernel_w * in_c * NCHWC_BLOCK;
+    int ic_block = job->ic_block;
+    int ic_stride = job->ic_stride;
+
+    __m256 _s00 = _mm256_setzero_ps();
+    __m256 _s01 = _mm256_setzero_ps();
+    __m256 _s02 = _mm256_setzero_ps();
+    __m256 _s03 = _mm256_setzero_ps();
+    __m256 _s04 = _mm256_setzero_ps();
+    __m256 _s05 = _mm256_setzero_ps();
+    __m256 _s10 = _mm256_setzero_ps();
+    __m256 _s11 = _mm256_setzero_ps();
+    __m256 _s12 = _mm256_setzero_ps();
+    __m256 _s13 = _mm256_setzero_ps();
+    __m256 _s14 = _mm256_setzero_ps();
+    __m256 _s15 = _mm256_setzero_ps();
+
+    for (int kh = kh0; kh < kh1; kh++)
+    {
+        int ih = y * job->stride_h - job->pad_h + kh * job->dilation_h;
+
+        for (int kw = kw0; kw < kw1; kw++)
+        {
+            int iw = x * job->stride_w - job->pad_w + kw * job->dilation_w;
+            const float* in = job->input + (size_t)(ih * job->in_w + iw) * job->in_step;
+            const float* k0 = weight + (kh * job->kernel_w + kw) * in_c * NCHWC_BLOCK;
+
+            for (int ic = 0; ic < in_c; ic += ic_block)
+            {
+                const float* p = in + (size_t)(ic / ic_block) * job->block_stride;
+                const float* k = k0 + ic * NCHWC_BLOCK;
+                int count = in_c - ic < ic_block ? in_c - ic : ic_block;
+
+                for (int i = 0; i < count; i++)
+                {
+                    __m256 _w0 = _mm256_loadu_ps(k);
+                    __m256 _w1 = nb > 1 ? _mm256_loadu_ps(k + block_size) : _w0;
+                    __m256 _v;
+
+                    _v = _mm256_broadcast_ss(p);
+                    _s00 = _mm256_fmadd_ps(_w0, _v, _s00);
+                    if (nb > 1)
+                        _s10 = _mm256_fmadd_ps(_w1, _v, _s10);
+                    if (n > 1)
+                    {
+                        _v = _mm256_broadcast_ss(p + step);
+                        _s01 = _mm256_fmadd_ps(_w0, _v, _s01);
+                        if (nb > 1)
+                            _s11 = _mm256_fmadd_ps(_w1, _v, _s11);
+                    }
+                    if (n > 2)
+                    {
+                        _v = _mm256_broadcast_ss(p + 2 * step);
+                        _s02 = _mm256_fmadd_ps(_w0, _v, _s02);
+                        if (nb > 1)
+                            _s12 = _mm256_fmadd_ps(_w1, _v, _s12);
+                    }
+                    if (n > 3)
+                    {
+                        _v = _mm256_broadcast_ss(p + 3 * step);
+                        _s03 = _mm256_fmadd_ps(_w0, _v, _s03);
+                        if (nb > 1)
+                            _s13 = _mm256_fmadd_ps(_w1, _v, _s13);
+                    }
+                    if (n > 4)
+                    {
+                        _v = _mm256_broadcast_ss(p + 4 * step);
+                        _s04 = _mm256_fmadd_ps(_w0, _v, _s04);
+                        if (nb > 1)
+                            _s14 = _mm256_fmadd_ps(_w1, _v, _s14);
+                    }
+                    if (n > 5)
+                    {
+                        _v = _mm256_broadcast_ss(p + 5 * step);
+                        _s05 = _mm256_fmadd_ps(_w0, _v, _s05);
+                        if (nb > 1)
+                            _s15 = _mm256_fmadd_ps(_w1, _v, _s15);
+                    }
+
+                    p += ic_stride;
+                    k += NCHWC_BLOCK;
+                }
+            }
+        }
+    }
+
+    int pixel = y * job->out_w + x;
+    __m256 _s0[6] = {_s00, _s01, _s02, _s03, _s04, _s05};
+    __m256 _s1[6] = {_s10, _s11, _s12, _s13, _s14, _s15};
+
+    for (int j = 0; j < n; j++)
+    {
+        store_block(job, b, pixel + j, _s0[j]);
+        if (nb > 1)
+            store_block(job, b + 1, pixel + j, _s1[j]);
+    }
+}
+
+/* the tiles of the interior columns */
+static void conv_tile_2x6(const struct nchwc_conv_job* job, const float* weight, int step, int b, int y, int x, int kh0, int kh1)
+{
+    conv_tile(job, weight, 2, 6, step, b, y, x, kh0, kh1, 0, job->kernel_w);
+}
+
+static void conv_tile_2x4(const struct nchwc_conv_job* job, const float* weight, int step, int b, int y, int x, int kh0, int kh1)
+{
+    conv_tile(job, weight, 2, 4, step, b, y, x, kh0, kh1, 0, job->kernel_w);
+}
+
+static void conv_tile_2x2(const struct nchwc_conv_job* job, const float* weight, int step, int b, int y, int x, int kh0, int kh1)
+{
+    conv_tile(job, weight, 2, 2, step, b, y, x, kh0, kh1, 0, job->kernel_w);
+}
+
+static void conv_tile_1x6(const struct nchwc_conv_job* job, const float* weight, int step, int b, int y, int x, int kh0, int kh1)
+{
+    conv_tile(job, weight, 1, 6, step, b, y, x, kh0, kh1, 0, job->kernel_w);
+}
+
+static void conv_tile_1x2(const struct nchwc_conv_job* job, const float* weight, int step, int b, int y, int x, int kh0, int kh1)
+{
+    conv_tile(job, weight, 1, 2, step, b, y, x, kh0, kh1, 0, job->kernel_w);
+}
+
+/* one pixel of 1 or 2 output blocks, any position */
+static void conv_pixel(const struct nchwc_conv_job* job, const float* weight, int nb, int b, int y, int x, int kh0, int kh1)
+{
+    int kw0, kw1;
+    get_kernel_range(x, job->stride_w, job->pad_w, job->dilation_w, job->kernel_w, job->in_w, &kw0, &kw1);
+
+    if (nb > 1)
+        conv_tile(job, weight, 2, 1, 0, b, y, x, kh0, kh1, kw0, kw1);
+    else
+        conv_tile(job, weight, 1, 1, 0, b, y, x, kh0, kh1, kw0, kw1);
+}
+
+/* the interior columns [x, x_end) of a row, 6 pixels at a time and then the tails of 4 and 2 */
+static int conv_interior(const struct nchwc_conv_job* job, const float* weight, int nb, int step, int b, int y, int x, int kh0, int kh1)
+{
+    if (nb > 1)
+    {
+        for (; x + 5 < job->x_end; x += 6)
+            conv_tile_2x6(job, weight, step, b, y, x, kh0, kh1);
+        if (x + 3 < job->x_end)
+        {
+            conv_tile_2x4(job, weight, step, b, y, x, kh0, kh1);
+            x += 4;
+        }
+        if (x + 1 < job->x_end)
+        {
+            conv_tile_2x2(job, weight, step, b, y, x, kh0, kh1);
+            x += 2;
+        }
+    }
+    else
+    {
+        for (; x + 5 < job->x_end; x += 6)
+            conv_tile_1x6(job, weight, step, b, y, x, kh0, kh1);
+        for (; x + 1 < job->x_end; x += 2)
+            conv_tile_1x2(job, weight, step, b, y, x, kh0, kh1);
+    }
+
+    return x;
+}
+
+/* a task is an output row of 2 output blocks, the rows of the same blocks are next to each other to share the weights */
+static void conv_nchwc_row(void* arg, int begin, int end)
+{
+    const struct nchwc_conv_job* job = (const struct nchwc_conv_job*)arg;
+    int block_size = job->kernel_h * job->kernel_w * job->in_c * NCHWC_BLOCK;
+    int step = job->stride_w * job->in_step;
+
+    for (int t = begin; t < end; t++)
+    {
+        int b = t / job->out_h * 2;
+        int y = t % job->out_h;
+        int nb = job->block_num - b < 2 ? job->block_num - b : 2;
+        const float* weight = job->weight + (size_t)b * block_size;
+
+        int kh0, kh1;
+        get_kernel_range(y, job->stride_h, job->pad_h, job->dilation_h, job->kernel_h, job->in_h, &kh0, &kh1);
+
+        int x = 0;
+
+        for (; x < job->x_begin && x < job->out_w; x++)
+            conv_pixel(job, weight, nb, b, y, x, kh0, kh1);
+
+        x = conv_interior(job, weight, nb, step, b, y, x, kh0, kh1);
+
+        for (; x < job->out_w; x++)
+            conv_pixel(job, weight, nb, b, y, x, kh0, kh1);
+    }
+}
+
+/* one pixel of a channel block, any position */
+static void conv_dw_pixel(const struct nchwc_conv_job* job, const float* in, const float* weight, int b, int y, int x, int kh0, int kh1)
+{
+    int kw0, kw1;
+    get_kernel_range(x, job->stride_w, job->pad_w, job->dilation_w, job->kernel_w, job->in_w, &kw0, &kw1);
+
+    __m256 _s = _mm256_setzero_ps();
+
+    for (int kh = kh0; kh < kh1; kh++)
+    {
+        int ih = y * job->stride_h - job->pad_h + kh * job->dilation_h;
+
+        for (int kw = kw0; kw < kw1; kw++)
+        {
+            int iw = x * job->stride_w - job->pad_w + kw * job->dilation_w;
+            __m256 _v = _mm256_loadu_ps(in + (ih * job->in_w + iw) * NCHWC_BLOCK);
+
+            _s = _mm256_fmadd_ps(_mm256_loadu_ps(weight + (kh * job->kernel_w + kw) * NCHWC_BLOCK), _v, _s);
+        }
+    }
+
+    store_block(job, b, y * job->out_w + x, _s);
+}
+
+/* 4 pixels of a channel block, all reading no padding in the columns */
+static void conv_dw_tile_4(const struct nchwc_conv_job* job, const float* in, const float* weight, int b, int y, int x, int kh0, int kh1)
+{
+    int step = job->stride_w * NCHWC_BLOCK;
+
+    __m256 _s0 = _mm256_setzero_ps();
+    __m256 _s1 = _mm256_setzero_ps();
+    __m256 _s2 = _mm256_setzero_ps();
+    __m256 _s3 = _mm256_setzero_ps();
+
+    for (int kh = kh0; kh < kh1; kh++)
+    {
+        int ih = y * job->stride_h - job->pad_h + kh * job->dilation_h;
+
+        for (int kw = 0; kw < job->kernel_w; kw++)
+        {
+            int iw = x * job->stride_w - job->pad_w + kw * job->dilation_w;
+            const float* p = in + (ih * job->in_w + iw) * NCHWC_BLOCK;
+            __m256 _w = _mm256_loadu_ps(weight + (kh * job->kernel_w + kw) * NCHWC_BLOCK);
+
+            _s0 = _mm256_fmadd_ps(_w, _mm256_loadu_ps(p), _s0);
+            _s1 = _mm256_fmadd_ps(_w, _mm256_loadu_ps(p + step), _s1);
+            _s2 = _mm256_fmadd_ps(_w, _mm256_loadu_ps(p + 2 * step), _s2);
+            _s3 = _mm256_fmadd_ps(_w, _mm256_loadu_ps(p + 3 * step), _s3);
+        }
+    }
+
+    int pixel = y * job->out_w + x;
+
+    store_block(job, b, pixel, _s0);
+    store_block(job, b, pixel + 1, _s1);
+    store_block(job, b, pixel + 2, _s2);
+    store_block(job, b, pixel + 3, _s3);
+}
+
+/* a task is an output row of a channel block */
+static void conv_dw_nchwc_row(void* arg, int begin, int end)
+{
+    const struct nchwc_conv_job* job = (const struct nchwc_conv_job*)arg;
+    int kernel_size = job->kernel_h * job->kernel_w * NCHWC_BLOCK;
+
+    for (int t = begin; t < end; t++)
+    {
+        int b = t / job->out_h;
+        int y = t % job->out_h;
+        const float* in = job->input + (size_t)b * job->in_h * job->in_w * NCHWC_BLOCK;
+        const float* weight = job->weight + (size_t)b * kernel_size;
+
+        int kh0, kh1;
+        get_kernel_range(y, job->stride_h, job->pad_h, job->dilation_h, job->kernel_h, job->in_h, &kh0, &kh1);
+
+        int x = 0;
+
+        for (; x < job->x_begin && x < job->out_w; x++)
+            conv_dw_pixel(job, in, weight, b, y, x, kh0, kh1);
+        for (; x + 3 < job->x_end; x += 4)
+            conv_dw_tile_4(job, in, weight, b, y, x, kh0, kh1);
+        for (; x < job->out_w; x++)
+            conv_dw_pixel(job, in, weight, b, y, x, kh0, kh1);
+    }
+}
+
+struct nchwc_pack_job
+{
+    const float* input;
+    float* output;
+    int channel;
+    int size;
+};
+
+/* pack the plain channels of an image into the blocks, the padded channels are 0 */
+static void pack_input_block(void* arg, int begin, int end)
+{
+    const struct nchwc_pack_job* job = (const struct nchwc_pack_job*)arg;
+    int size = job->size;
+
+    for (int b = begin; b < end; b++)
+    {
+        float* out = job->output + (size_t)b * size * NCHWC_BLOCK;
+
+        for (int l = 0; l < NCHWC_BLOCK; l++)
+        {
+            int c = b * NCHWC_BLOCK + l;
+            const float* in = job->input + (size_t)c * size;
+
+            if (c < job->channel)
+            {
+                for (int i = 0; i < size; i++)
+                    out[i * NCHWC_BLOCK + l] = in[i];
+            }
+            else
+            {
+                for (int i = 0; i < size; i++)
+                    out[i * NCHWC_BLOCK + l] = 0.f;
+            }
+        }
+    }
+}
+#endif
+
+int conv_nchwc_run(struct tensor* input_tensor, struct tensor* output_tensor, struct tensor* residual_tensor,
+                   struct conv_priv_info* info, struct conv_param* param, int num_thread)
+{
+#if __AVX__
+    struct nchwc_conv_job job;
+
+    int batch = input_tensor->dims[0];
+    int in_blocked = get_layout_channel_block(input_tensor->layout) > 1;
+    int depthwise = param->group > 1;
+
+    job.in_c = input_tensor->dims[1] / param->group;
+    job.in_h = input_tensor->dims[2];
+    job.in_w = input_tensor->dims[3];
+    job.out_c = output_tensor->dims[1];
+    job.out_h = output_tensor->dims[2];
+    job.out_w = output_tensor->dims[3];
+    job.block_num = get_block_num(job.out_c);
+    job.out_blocked = get_layout_channel_block(output_tensor->layout) > 1;
+    job.res_blocked = residual_tensor != NULL && get_layout_channel_block(residual_tensor->layout) > 1;
+    job.kernel_h = param->kernel_h;
+    job.kernel_w = param->kernel_w;
+    job.stride_h = param->stride_h;
+    job.stride_w = param->stride_w;
+    job.dilation_h = param->dilation_h;
+    job.dilation_w = param->dilation_w;
+    job.pad_h = param->pad_h0;
+    job.pad_w = param->pad_w0;
+    job.weight = info->nchwc_weight;
+    job.bias = info->nchwc_weight + (size_t)job.block_num * NCHWC_BLOCK * job.kernel_h * job.kernel_w * job.in_c;
+    job.min = param->activation >= 0 ? 0.f : -INFINITY;
+    job.max = param->activation > 0 ? (float)param->activation : INFINITY;
+
+    job.x_begin = (job.pad_w + job.stride_w - 1) / job.stride_w;
+    job.x_end = job.in_w - 1 + job.pad_w - (job.kernel_w - 1) * job.dilation_w;
+    job.x_end = job.x_end < 0 ? 0 : job.x_end / job.stride_w + 1;
+    job.x_end = job.x_end < job.out_w ? job.x_end : job.out_w;
+
+    int in_hw = job.in_h * job.in_w;
+    int out_hw = job.out_h * job.out_w;
+    int in_c_pad = get_block_num(input_tensor->dims[1]) * NCHWC_BLOCK;
+    int out_c_pad = job.block_num * NCHWC_BLOCK;
+    size_t in_image = (size_t)(in_blocked ? in_c_pad : input_tensor->dims[1]) * in_hw;
+    size_t out_image = (size_t)(job.out_blocked ? out_c_pad : job.out_c) * out_hw;
+    size_t res_image = (size_t)(job.res_blocked ? out_c_pad : job.out_c) * out_hw;
+
+    /* the depthwise kernel reads the blocked input only */
+    if (depthwise || in_blocked)
+    {
+        job.in_step = NCHWC_BLOCK;
+        job.ic_block = NCHWC_BLOCK;
+        job.ic_stride = 1;
+        job.block_stride = (size_t)in_hw * NCHWC_BLOCK;
+    }
+    else
+    {
+        job.in_step = 1;
+        job.ic_block = job.in_c;
+        job.ic_stride = in_hw;
+        job.block_stride = 0;
+    }
+
+    for (int n = 0; n < batch; n++)
+    {
+        job.input = (const float*)input_tensor->data + n * in_image;
+        job.output = (float*)output_tensor->data + n * out_image;
+        job.residual = residual_tensor != NULL ? (const float*)residual_tensor->data + n * res_image : NULL;
+
+        if (depthwise)
+        {
+            if (!in_blocked)
+            {
+                struct nchwc_pack_job pack_job;
+
+                pack_job.input = job.input;
+                pack_job.output = info->nchwc_input;
+                pack_job.channel = input_tensor->dims[1];
+                pack_job.size = in_hw;
+
+                parallel_for(pack_input_block, &pack_job, get_block_num(pack_job.channel), num_thread);
+
+                job.input = info->nchwc_input;
+            }
+
+            parallel_for(conv_dw_nchwc_row, &job, job.block_num * job.out_h, num_thread);
+        }
+        else
+        {
+            parallel_for(conv_nchwc_row, &job, (job.block_num + 1) / 2 * job.out_h, num_thread);
+        }
+    }
+
+    return 0;
+#else
+    TLOG_ERR("conv nchwc: the kernels are built without avx\n");
+    return -1;
+#endif
+}
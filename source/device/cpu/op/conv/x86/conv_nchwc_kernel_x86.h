@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef __CONV_NCHWC_KERNEL_X86_H_
+#define __CONV_NCHWC_KERNEL_X86_H_
+
+#include "convolution_param.h"
+
+#include "graph/tensor.h"
+
+/*
+ * the fp32 direct conv of the NC8HW8 layout, for group 1 and depthwise. the input, the
+ * output and the residual are each plain NCHW or NC8HW8, as their layouts are set by the
+ * graph. the weights are packed by 8 output channels, so one vector of the output is the
+ * 8 channels of a block at a pixel, and a plain tensor is read or written lane by lane.
+ */
+
+/* the channel block of the kernels, 0 for the build without avx */
+int conv_nchwc_get_block(void);
+
+/* check if any of the input, the output and the residual of the conv is blocked, the residual may be NULL */
+int conv_nchwc_enabled(struct tensor* input_tensor, struct tensor* output_tensor, struct tensor* residual_tensor);
+
+/* the size of the weights and the bias packed for the conv */
+int conv_nchwc_get_weight_size(struct tensor* filter_tensor, struct conv_param* param);
+
+int conv_nchwc_prerun(struct tensor* input_tensor, struct tensor* filter_tensor, struct tensor* bias_tensor,
+                      struct conv_priv_info* info, struct conv_param* param);
+
+int conv_nchwc_postrun(struct conv_priv_info* info);
+
+/* free the buffers depending on the input shape, the packed weights are kept for the next prerun */
+int conv_nchwc_resize(struct conv_priv_info* info);
+
+/* the residual is added to the output before the activation, NULL for none */
+int conv_nchwc_run(struct tensor* input_tensor, struct tensor* output_tensor, struct tensor* residual_tensor,
+                   struct conv_priv_info* info, struct conv_param* param, int num_thread);
+
+#endif
@@ -43,6 +43,9 @@ int wino_conv_hcl_prerun(struct tensor* input_tensor, struct tensor* filter_tens
 
 int wino_conv_hcl_postrun(struct conv_priv_info* info);
 
+/* free the buffers depending on the input shape, the transformed kernel is kept for the next prerun */
+int wino_conv_hcl_resize(struct conv_priv_info* info);
+
 int wino_conv_hcl_run(struct tensor* input_tensor, struct tensor* filter_tensor, struct tensor* bias_tensor,
                       struct tensor* output_tensor, struct conv_priv_info* conv_info, struct conv_param* param,
                       int num_thread, int affinity);
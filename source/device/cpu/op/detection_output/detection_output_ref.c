@@ -22,18 +22,21 @@
  * Author: jxyang@openailab.com
  */
 
+#include "nms_kernel_ref.h"
+
 #include "detection_output_param.h"
 
 #include "graph/tensor.h"
 #include "graph/node.h"
 #include "graph/graph.h"
 #include "utility/sys_port.h"
-#include "utility/vector.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
+#include "device/cpu/op/topkv2/topk_kernel_ref.h"
 
 #include <math.h>
 #include <string.h>
@@ -48,39 +51,6 @@ typedef struct
     float score;
 } Box_t;
 
-#define T_MAX(a, b) ((a) > (b) ? (a) : (b))
-#define T_MIN(a, b) ((a) < (b) ? (a) : (b))
-
-static void quick_sort(Box_t* array, int left, int right)
-{
-    int i = left;
-    int j = right;
-    Box_t key;
-
-    if (left >= right)
-        return;
-
-    memmove(&key, &array[left], sizeof(Box_t));
-    while (left < right)
-    {
-        while (left < right && key.score >= array[right].score)
-        {
-            --right;
-        }
-        memmove(&array[left], &array[right], sizeof(Box_t));
-        while (left < right && key.score <= array[left].score)
-        {
-            ++left;
-        }
-        memmove(&array[right], &array[left], sizeof(Box_t));
-    }
-
-    memmove(&array[left], &key, sizeof(Box_t));
-
-    quick_sort(array, i, left - 1);
-    quick_sort(array, left + 1, j);
-}
-
 static void get_boxes(Box_t* boxes, int num_prior, float* loc_ptr, float* prior_ptr)
 {
     for (int i = 0; i < num_prior; i++)
@@ -108,53 +78,73 @@ static void get_boxes(Box_t* boxes, int num_prior, float* loc_ptr, float* prior_
     }
 }
 
-static inline float intersection_area(const Box_t* a, const Box_t* b)
+/*
+ * the classes but the background 0 are independent, a task is some of them. the priors over
+ * confidence_threshold are the candidates, the nms_top_k best of them are sorted for nms.
+ */
+struct detection_output_job
 {
-    if (a->x0 > b->x1 || a->x1 < b->x0 || a->y0 > b->y1 || a->y1 < b->y0)
-    {
-        // no intersection
-        return 0.f;
-    }
-
-    float inter_width = T_MIN(a->x1, b->x1) - T_MAX(a->x0, b->x0);
-    float inter_height = T_MIN(a->y1, b->y1) - T_MAX(a->y0, b->y0);
-
-    return inter_width * inter_height;
-}
-
-void nms_sorted_bboxes(const Box_t* bboxes, int bboxes_num, int* picked, int* picked_num, float nms_threshold)
+    const Box_t* boxes; /* of all the priors */
+    const float* conf;
+    int num_prior;
+    int num_classes;
+    float confidence_threshold;
+    float nms_threshold;
+
+    int slot_size; /* the kept priors of a class at most */
+    int* kept;     /* [num_classes - 1][slot_size] */
+    int* kept_num; /* [num_classes - 1], -1 for no memory */
+};
+
+static void class_nms_task(void* arg, int begin, int end)
 {
-    float* areas = (float*)sys_malloc(sizeof(float) * bboxes_num);
-
-    for (int i = 0; i < bboxes_num; i++)
-    {
-        float width = bboxes[i].x1 - bboxes[i].x0;
-        float height = bboxes[i].y1 - bboxes[i].y0;
+    const struct detection_output_job* job = (const struct detection_output_job*)arg;
+    int num_prior = job->num_prior;
+    int slot_size = job->slot_size;
 
-        areas[i] = width * height;
-    }
+    struct topk_pair* pairs = (struct topk_pair*)sys_malloc(sizeof(struct topk_pair) * num_prior);
+    Box_t* class_box = (Box_t*)sys_malloc(sizeof(Box_t) * slot_size);
 
-    for (int i = 0; i < bboxes_num; i++)
+    for (int i = begin; i < end; i++)
     {
-        int keep = 1;
-        for (int j = 0; j < *picked_num; j++)
+        int* kept = job->kept + (size_t)i * slot_size;
+        const float* conf = job->conf + i + 1;
+
+        if (pairs == NULL || class_box == NULL)
         {
-            // intersection over union
-            float inter_area = intersection_area(&bboxes[i], &bboxes[picked[j]]);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            //             float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
+            job->kept_num[i] = -1;
+            continue;
         }
 
-        if (keep)
+        int num = 0;
+        for (int j = 0; j < num_prior; j++)
         {
-            picked[*picked_num] = i;
-            *picked_num += 1;
+            float score = conf[(size_t)j * job->num_classes];
+            if (score > job->confidence_threshold)
+            {
+                pairs[num].score = score;
+                pairs[num].index = j;
+                num++;
+            }
         }
+
+        int top = num < slot_size ? num : slot_size;
+        ref_topk(pairs, num, top);
+
+        for (int j = 0; j < top; j++)
+            class_box[j] = job->boxes[pairs[j].index];
+
+        int kept_num = ref_nms_sorted((const float*)class_box, sizeof(Box_t) / sizeof(float), top, job->nms_threshold,
+                                      0.f, 0, 0, kept, 1);
+
+        for (int j = 0; j < kept_num; j++)
+            kept[j] = pairs[kept[j]].index;
+
+        job->kept_num[i] = kept_num;
     }
 
-    sys_free(areas);
+    sys_free(pairs);
+    sys_free(class_box);
 }
 
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
@@ -271,56 +261,74 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
 
     Box_t* boxes = (Box_t*)sys_malloc(sizeof(Box_t) * num_prior);
     get_boxes(boxes, num_prior, loc_ptr, prior_ptr);
-    struct vector* output_bbox_v = create_vector(sizeof(Box_t), NULL);
 
-    for (int i = 1; i < num_classes; i++)
-    {
-        Box_t* class_box = (Box_t*)sys_malloc(sizeof(Box_t) * num_prior);
-        int class_box_num = 0;
-        for (int j = 0; j < num_prior; j++)
-        {
-            float score = conf_ptr[j * num_classes + i];
-            if (score > param->confidence_threshold)
-            {
-                boxes[j].score = score;
-                boxes[j].class_idx = i;
-                memcpy(&class_box[class_box_num++], &boxes[j], sizeof(Box_t));
-            }
-        }
+    int class_num = num_classes > 1 ? num_classes - 1 : 0;
 
-        quick_sort(class_box, 0, class_box_num - 1);
+    struct detection_output_job job;
+    job.boxes = boxes;
+    job.conf = conf_ptr;
+    job.num_prior = num_prior;
+    job.num_classes = num_classes;
+    job.confidence_threshold = param->confidence_threshold;
+    job.nms_threshold = param->nms_threshold;
+    job.slot_size = param->nms_top_k > 0 && param->nms_top_k < num_prior ? param->nms_top_k : num_prior;
+    job.kept = (int*)sys_malloc(sizeof(int) * class_num * job.slot_size + 1);
+    job.kept_num = (int*)sys_malloc(sizeof(int) * class_num + 1);
 
-        if (class_box_num > param->nms_top_k)
-            class_box_num = param->nms_top_k;
+    if (boxes == NULL || job.kept == NULL || job.kept_num == NULL)
+    {
+        TLOG_ERR("detection_output: no memory for %d priors\n", num_prior);
+        sys_free(boxes);
+        sys_free(job.kept);
+        sys_free(job.kept_num);
+        return -1;
+    }
 
-        int* picked = (int*)sys_malloc(sizeof(int) * class_box_num); // = NULL;
-        int picked_num = 0;
-        nms_sorted_bboxes(class_box, class_box_num, picked, &picked_num, param->nms_threshold);
+    parallel_for(class_nms_task, &job, class_num, exec_graph->num_thread);
 
-        for (int j = 0; j < picked_num; j++)
-        {
-            int z = picked[j];
-            push_vector_data(output_bbox_v, &class_box[z]);
-        }
+    int total_num = 0;
+    for (int i = 0; i < class_num; i++)
+        total_num = job.kept_num[i] < 0 || total_num < 0 ? -1 : total_num + job.kept_num[i];
+
+    Box_t* bbox_rects = (Box_t*)sys_malloc(sizeof(Box_t) * total_num + 1);
+    struct topk_pair* pairs = (struct topk_pair*)sys_malloc(sizeof(struct topk_pair) * total_num + 1);
 
-        sys_free(picked);
-        sys_free(class_box);
+    if (total_num < 0 || bbox_rects == NULL || pairs == NULL)
+    {
+        TLOG_ERR("detection_output: no memory for the nms of %d priors\n", num_prior);
+        sys_free(boxes);
+        sys_free(job.kept);
+        sys_free(job.kept_num);
+        sys_free(bbox_rects);
+        sys_free(pairs);
+        return -1;
     }
 
-    sys_free(boxes);
+    /* the kept boxes of all the classes, the keep_top_k best of them in order */
+    total_num = 0;
+    for (int i = 0; i < class_num; i++)
+    {
+        for (int j = 0; j < job.kept_num[i]; j++)
+        {
+            int prior = job.kept[(size_t)i * job.slot_size + j];
 
-    int total_num = get_vector_num(output_bbox_v);
-    Box_t* bbox_rects = (Box_t*)sys_malloc(total_num * sizeof(Box_t));
+            bbox_rects[total_num] = boxes[prior];
+            bbox_rects[total_num].class_idx = i + 1;
+            bbox_rects[total_num].score = conf_ptr[(size_t)prior * num_classes + i + 1];
 
-    for (int i = 0; i < total_num; i++)
-        memcpy(&bbox_rects[i], get_vector_data(output_bbox_v, i), sizeof(Box_t));
+            pairs[total_num].score = bbox_rects[total_num].score;
+            pairs[total_num].index = total_num;
+            total_num++;
+        }
+    }
 
-    quick_sort(bbox_rects, 0, total_num - 1);
+    sys_free(boxes);
+    sys_free(job.kept);
+    sys_free(job.kept_num);
 
-    if (total_num > param->keep_top_k)
-        total_num = param->keep_top_k;
+    int num_detected = param->keep_top_k > 0 && total_num > param->keep_top_k ? param->keep_top_k : total_num;
+    ref_topk(pairs, total_num, num_detected);
 
-    int num_detected = total_num;
     int dims[4] = {1, num_detected, 6, 1};
     set_ir_tensor_shape(output_tensor, dims, 4);
 
@@ -335,17 +343,18 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
 
     for (int i = 0; i < num_detected; i++)
     {
+        const Box_t* box = &bbox_rects[pairs[i].index];
         float* outptr = output_fp32 + i * 6;
-        outptr[0] = bbox_rects[i].class_idx;
-        outptr[1] = bbox_rects[i].score;
-        outptr[2] = bbox_rects[i].x0;
-        outptr[3] = bbox_rects[i].y0;
-        outptr[4] = bbox_rects[i].x1;
-        outptr[5] = bbox_rects[i].y1;
+        outptr[0] = box->class_idx;
+        outptr[1] = box->score;
+        outptr[2] = box->x0;
+        outptr[3] = box->y0;
+        outptr[4] = box->x1;
+        outptr[5] = box->y1;
     }
 
     sys_free(bbox_rects);
-    release_vector(output_bbox_v);
+    sys_free(pairs);
 
     /* quant uint8 */
     if (output_tensor->data_type == TENGINE_DT_UINT8)
@@ -0,0 +1,282 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "nms_kernel_ref.h"
+
+#include "system/thread_pool.h"
+#include "utility/sys_port.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#elif __ARM_NEON && __aarch64__
+#include <arm_neon.h>
+#define NMS_REF_NEON 1
+#endif
+
+#define NMS_REF_BITMASK_MIN 256  /* the least boxes of the bitmask nms */
+#define NMS_REF_BITMASK_MAX 4096 /* the most, the masks are n * n / 8 bytes */
+
+#define NMS_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define NMS_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/* the boxes compared to, all of them or the kept ones, as the arrays of their coordinates */
+struct nms_job
+{
+    float threshold;
+    float offset;
+    int inclusive;
+
+    float* x0;
+    float* y0;
+    float* x1;
+    float* y1;
+    float* area;
+
+    /* the bit j of the row i is set when the box i drops the box j */
+    int n;
+    int words;
+    uint64_t* masks;
+};
+
+static int init_job(struct nms_job* job, int n, float iou_threshold, float offset, int inclusive)
+{
+    float* buffer = (float*)sys_malloc((size_t)n * 5 * sizeof(float));
+    if (buffer == NULL)
+        return -1;
+
+    job->threshold = iou_threshold;
+    job->offset = offset;
+    job->inclusive = inclusive;
+    job->x0 = buffer;
+    job->y0 = buffer + n;
+    job->x1 = buffer + (size_t)n * 2;
+    job->y1 = buffer + (size_t)n * 3;
+    job->area = buffer + (size_t)n * 4;
+    job->n = n;
+    job->words = (n + 63) / 64;
+    job->masks = NULL;
+
+    return 0;
+}
+
+static inline void set_box(struct nms_job* job, int i, const float* box)
+{
+    job->x0[i] = box[0];
+    job->y0[i] = box[1];
+    job->x1[i] = box[2];
+    job->y1[i] = box[3];
+    job->area[i] = (box[2] - box[0] + job->offset) * (box[3] - box[1] + job->offset);
+}
+
+/* the box i drops the box j, the same as j drops i */
+static inline int is_dropped(const struct nms_job* job, const float* box, float area, int j)
+{
+    float w = NMS_MIN(box[2], job->x1[j]) - NMS_MAX(box[0], job->x0[j]) + job->offset;
+    float h = NMS_MIN(box[3], job->y1[j]) - NMS_MAX(box[1], job->y0[j]) + job->offset;
+
+    w = NMS_MAX(w, 0.f);
+    h = NMS_MAX(h, 0.f);
+
+    float inter = w * h;
+    float iou = inter / (area + job->area[j] - inter);
+
+    return job->inclusive ? iou >= job->threshold : iou > job->threshold;
+}
+
+/* the bit k is of the box j + k */
+#if __SSE2__
+static inline int get_dropped_4(const struct nms_job* job, const float* box, float area, int j)
+{
+    __m128 _w = _mm_sub_ps(_mm_min_ps(_mm_set1_ps(box[2]), _mm_loadu_ps(job->x1 + j)),
+                           _mm_max_ps(_mm_set1_ps(box[0]), _mm_loadu_ps(job->x0 + j)));
+    __m128 _h = _mm_sub_ps(_mm_min_ps(_mm_set1_ps(box[3]), _mm_loadu_ps(job->y1 + j)),
+                           _mm_max_ps(_mm_set1_ps(box[1]), _mm_loadu_ps(job->y0 + j)));
+
+    __m128 _offset = _mm_set1_ps(job->offset);
+    __m128 _zero = _mm_setzero_ps();
+    _w = _mm_max_ps(_mm_add_ps(_w, _offset), _zero);
+    _h = _mm_max_ps(_mm_add_ps(_h, _offset), _zero);
+
+    __m128 _inter = _mm_mul_ps(_w, _h);
+    __m128 _union = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(area), _mm_loadu_ps(job->area + j)), _inter);
+    __m128 _iou = _mm_div_ps(_inter, _union);
+    __m128 _threshold = _mm_set1_ps(job->threshold);
+
+    __m128 _mask = job->inclusive ? _mm_cmpge_ps(_iou, _threshold) : _mm_cmpgt_ps(_iou, _threshold);
+
+    return _mm_movemask_ps(_mask);
+}
+#elif NMS_REF_NEON
+static inline int get_dropped_4(const struct nms_job* job, const float* box, float area, int j)
+{
+    float32x4_t _w = vsubq_f32(vminq_f32(vdupq_n_f32(box[2]), vld1q_f32(job->x1 + j)),
+                               vmaxq_f32(vdupq_n_f32(box[0]), vld1q_f32(job->x0 + j)));
+    float32x4_t _h = vsubq_f32(vminq_f32(vdupq_n_f32(box[3]), vld1q_f32(job->y1 + j)),
+                               vmaxq_f32(vdupq_n_f32(box[1]), vld1q_f32(job->y0 + j)));
+
+    float32x4_t _offset = vdupq_n_f32(job->offset);
+    float32x4_t _zero = vdupq_n_f32(0.f);
+    _w = vmaxq_f32(vaddq_f32(_w, _offset), _zero);
+    _h = vmaxq_f32(vaddq_f32(_h, _offset), _zero);
+
+    float32x4_t _inter = vmulq_f32(_w, _h);
+    float32x4_t _union = vsubq_f32(vaddq_f32(vdupq_n_f32(area), vld1q_f32(job->area + j)), _inter);
+    float32x4_t _iou = vdivq_f32(_inter, _union);
+    float32x4_t _threshold = vdupq_n_f32(job->threshold);
+
+    uint32x4_t _mask = job->inclusive ? vcgeq_f32(_iou, _threshold) : vcgtq_f32(_iou, _threshold);
+
+    static const uint32_t bits[4] = {1, 2, 4, 8};
+    return (int)vaddvq_u32(vandq_u32(_mask, vld1q_u32(bits)));
+}
+#else
+static inline int get_dropped_4(const struct nms_job* job, const float* box, float area, int j)
+{
+    int mask = 0;
+    for (int k = 0; k < 4; k++)
+        mask |= is_dropped(job, box, area, j + k) << k;
+
+    return mask;
+}
+#endif
+
+static int nms_greedy(struct nms_job* job, const float* boxes, int box_step, int n, int max_keep, int* keep)
+{
+    int count = 0;
+
+    for (int i = 0; i < n && count < max_keep; i++)
+    {
+        const float* box = boxes + (size_t)i * box_step;
+        float area = (box[2] - box[0] + job->offset) * (box[3] - box[1] + job->offset);
+
+        int dropped = 0;
+        int j = 0;
+
+        for (; j + 3 < count && !dropped; j += 4)
+            dropped = get_dropped_4(job, box, area, j);
+
+        for (; j < count && !dropped; j++)
+            dropped = is_dropped(job, box, area, j);
+
+        if (dropped)
+            continue;
+
+        set_box(job, count, box);
+        keep[count++] = i;
+    }
+
+    return count;
+}
+
+static void mask_task(void* arg, int begin, int end)
+{
+    const struct nms_job* job = (const struct nms_job*)arg;
+
+    for (int i = begin; i < end; i++)
+    {
+        uint64_t* row = job->masks + (size_t)i * job->words;
+        float box[4] = {job->x0[i], job->y0[i], job->x1[i], job->y1[i]};
+        float area = job->area[i];
+
+        memset(row, 0, job->words * sizeof(uint64_t));
+
+        /* the groups of 4 are in a word */
+        int j = i + 1;
+        for (; (j & 3) != 0 && j < job->n; j++)
+            row[j >> 6] |= (uint64_t)is_dropped(job, box, area, j) << (j & 63);
+
+        for (; j + 3 < job->n; j += 4)
+            row[j >> 6] |= (uint64_t)get_dropped_4(job, box, area, j) << (j & 63);
+
+        for (; j < job->n; j++)
+            row[j >> 6] |= (uint64_t)is_dropped(job, box, area, j) << (j & 63);
+    }
+}
+
+static int nms_bitmask(struct nms_job* job, const float* boxes, int box_step, int n, int max_keep, int* keep,
+                       int num_thread)
+{
+    int words = job->words;
+
+    job->masks = (uint64_t*)sys_malloc(((size_t)n + 1) * words * sizeof(uint64_t));
+    if (job->masks == NULL)
+        return -1;
+
+    for (int i = 0; i < n; i++)
+        set_box(job, i, boxes + (size_t)i * box_step);
+
+    parallel_for(mask_task, job, n, num_thread);
+
+    /* the boxes dropped by the kept ones */
+    uint64_t* dropped = job->masks + (size_t)n * words;
+    memset(dropped, 0, words * sizeof(uint64_t));
+
+    int count = 0;
+
+    for (int i = 0; i < n && count < max_keep; i++)
+    {
+        if ((dropped[i >> 6] >> (i & 63)) & 1)
+            continue;
+
+        keep[count++] = i;
+
+        const uint64_t* row = job->masks + (size_t)i * words;
+        for (int w = i >> 6; w < words; w++)
+            dropped[w] |= row[w];
+    }
+
+    sys_free(job->masks);
+    job->masks = NULL;
+
+    return count;
+}
+
+int ref_nms_sorted(const float* boxes, int box_step, int n, float iou_threshold, float offset, int inclusive,
+                   int max_keep, int* keep, int num_thread)
+{
+    if (n <= 0)
+        return 0;
+
+    if (max_keep <= 0 || max_keep > n)
+        max_keep = n;
+
+    struct nms_job job;
+    if (init_job(&job, n, iou_threshold, offset, inclusive) < 0)
+        return -1;
+
+    int count = -1;
+
+    if (num_thread > 1 && n >= NMS_REF_BITMASK_MIN && n <= NMS_REF_BITMASK_MAX)
+        count = nms_bitmask(&job, boxes, box_step, n, max_keep, keep, num_thread);
+
+    if (count < 0)
+        count = nms_greedy(&job, boxes, box_step, n, max_keep, keep);
+
+    sys_free(job.x0);
+
+    return count;
+}
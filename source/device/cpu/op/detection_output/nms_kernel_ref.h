@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef __NMS_KERNEL_REF_H__
+#define __NMS_KERNEL_REF_H__
+
+/*
+ * the greedy nms of detection_output, detection_postprocess and rpn. the n boxes are sorted
+ * by score, the best first, boxes + i * box_step is x0, y0, x1, y1 of the box i. a box is
+ * dropped when its iou with a kept box is over iou_threshold, or also equal to it when
+ * inclusive. the widths are x1 - x0 + offset and the heights y1 - y0 + offset, offset is 1
+ * for the boxes of pixel indices.
+ *
+ * a box is compared to 4 kept boxes at a time with simd. with threads and many boxes the
+ * ious of all the pairs are computed in parallel to bitmasks first, and the boxes dropped
+ * by a kept box are cleared by its mask.
+ *
+ * keep gets the indices of the kept boxes in order, at most max_keep of them, or all of them
+ * for 0. return the count of them, or -1 for no memory.
+ */
+int ref_nms_sorted(const float* boxes, int box_step, int n, float iou_threshold, float offset, int inclusive,
+                   int max_keep, int* keep, int num_thread);
+
+#endif
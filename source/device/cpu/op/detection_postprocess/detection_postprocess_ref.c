@@ -35,6 +35,9 @@
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
+#include "device/cpu/op/detection_output/nms_kernel_ref.h"
+#include "device/cpu/op/topkv2/topk_kernel_ref.h"
+#include "device/cpu/op/transpose/transpose_kernel_ref.h"
 
 #include <math.h>
 #include <string.h>
@@ -63,86 +66,8 @@ struct dpp_param
     int zero[3];
 };
 
-#define DPP_MIN(a, b) (a < b ? a : b)
-#define DPP_MAX(a, b) (a > b ? a : b)
-static float intersection_area(const struct Dpp_Box a, const struct Dpp_Box b)
-{
-    if (a.x0 > b.x1 || a.x1 < b.x0 || a.y0 > b.y1 || a.y1 < b.y0)
-    {
-        // no intersection
-        return 0.f;
-    }
-
-    float inter_width = DPP_MIN(a.x1, b.x1) - DPP_MAX(a.x0, b.x0);
-    float inter_height = DPP_MIN(a.y1, b.y1) - DPP_MAX(a.y0, b.y0);
-
-    return inter_width * inter_height;
-}
-
-static void nms_sorted_bboxes(const struct Dpp_Box* boxes, int boxes_size, int* picked, int* picked_size,
-                              float nms_threshold)
-{
-    float* areas = (float*)sys_malloc(sizeof(float) * boxes_size);
-    int n_picked = 0;
-    for (int i = 0; i < boxes_size; i++)
-    {
-        float width = boxes[i].x1 - boxes[i].x0;
-        float height = boxes[i].y1 - boxes[i].y0;
-
-        areas[i] = width * height;
-    }
-
-    for (int i = 0; i < boxes_size; i++)
-    {
-        int keep = 1;
-        for (int j = 0; j < n_picked; j++)
-        {
-            // intersection over union
-            float inter_area = intersection_area(boxes[i], boxes[picked[j]]);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
-        }
-
-        if (keep)
-        {
-            picked[n_picked] = i;
-            n_picked++;
-        }
-    }
-    *picked_size = n_picked;
-
-    sys_free(areas);
-}
-
-static void sort_boxes_by_score(struct Dpp_Box* boxes, int size)
-{
-    int i, j;
-    for (i = 0; i < size - 1; i++)
-    {
-        int max_idx = i;
-        for (j = i + 1; j < size; j++)
-        {
-            if (boxes[j].score < 0.6)
-                continue;
-            if (boxes[max_idx].score < boxes[j].score)
-                max_idx = j;
-        }
-        if (i != max_idx)
-        {
-            struct Dpp_Box tmp;
-            memcpy(&tmp, boxes + i, sizeof(struct Dpp_Box));
-            memcpy(boxes + i, boxes + max_idx, sizeof(struct Dpp_Box));
-            memcpy(boxes + max_idx, &tmp, sizeof(struct Dpp_Box));
-        }
-        else
-        {
-            if (boxes[max_idx].score < 0.6)
-                return;
-        }
-    }
-}
+/* the boxes of a score under it are dropped before nms */
+#define DPP_SCORE_THRESHOLD 0.6f
 
 static int decode_single_box(struct Dpp_Box* box, const float* box_ptr, const float* anchor_ptr,
                              const float* scales)
@@ -167,199 +92,144 @@ static int decode_single_box(struct Dpp_Box* box, const float* box_ptr, const fl
     return 0;
 }
 
-void get_all_boxes_rect(struct Dpp_Box* all_class_bbox_rects, const float* box, const float* scores,
-                        const float* anchor, int num_boxes, int num_classes, float* scales)
-{
-    struct Dpp_Box selected_box;
-    for (int j = 0; j < num_boxes; j++)
-    {
-        for (int i = 1; i < num_classes; i++)
-        {
-            float score = scores[j * num_classes + i];
-
-            if (score < 0.6)
-                continue;
-
-            selected_box.score = score;
-            selected_box.class_idx = i;
-            selected_box.box_idx = j;
-
-            if (decode_single_box(&selected_box, box, anchor, scales) < 0)
-                continue;
-
-            // struct Box* cls_vector = all_class_bbox_rects[i];
-            memcpy(all_class_bbox_rects + i * num_boxes + j, &selected_box, sizeof(struct Dpp_Box));
-        }
-    }
-}
-
-int ref_dpp_fp32(const float* input_f, const float* score_f, const float* anchor_f,
-                 float* detect_num, float* detect_class, float* detect_score, float* detect_boxes, struct dpp_param* param)
+/*
+ * the boxes of the scores over the threshold are decoded, the 2 * max_detections best of a
+ * class are sorted for nms, and the max_detections best of the kept boxes of all the classes
+ * are the outputs.
+ */
+int ref_dpp_fp32(const float* input_f, const float* score_f, const float* anchor_f, float* detect_num,
+                 float* detect_class, float* detect_score, float* detect_boxes, struct dpp_param* param, int num_thread)
 {
     const int num_classes = param->num_classes + 1;
     const int num_boxes = param->num_boxes;
     const int max_detections = param->max_detections;
+    const int class_top = 2 * max_detections < num_boxes ? 2 * max_detections : num_boxes;
+    const int max_picked_boxes = class_top * num_classes;
 
-    struct Dpp_Box* all_boxes = (struct Dpp_Box*)malloc((unsigned long)num_classes * num_boxes * sizeof(struct Dpp_Box));
-    memset(all_boxes, 0, sizeof(struct Dpp_Box) * num_classes * num_boxes);
+    struct topk_pair* pairs = (struct topk_pair*)sys_malloc(sizeof(struct topk_pair) * (num_boxes > max_picked_boxes ? num_boxes : max_picked_boxes) + 1);
+    struct Dpp_Box* class_box = (struct Dpp_Box*)sys_malloc(sizeof(struct Dpp_Box) * num_boxes + 1);
+    struct Dpp_Box* sorted_box = (struct Dpp_Box*)sys_malloc(sizeof(struct Dpp_Box) * class_top + 1);
+    struct Dpp_Box* picked_boxes = (struct Dpp_Box*)sys_malloc(sizeof(struct Dpp_Box) * max_picked_boxes + 1);
+    int* keep = (int*)sys_malloc(sizeof(int) * class_top + 1);
 
-    get_all_boxes_rect(all_boxes, input_f, score_f, anchor_f, num_boxes, num_classes, param->scales);
+    if (pairs == NULL || class_box == NULL || sorted_box == NULL || picked_boxes == NULL || keep == NULL)
+    {
+        sys_free(pairs);
+        sys_free(class_box);
+        sys_free(sorted_box);
+        sys_free(picked_boxes);
+        sys_free(keep);
+        return -1;
+    }
 
-    int max_picked_boxes = 2 * max_detections * num_classes;
-    struct Dpp_Box* picked_boxes = (struct Dpp_Box*)malloc(max_picked_boxes * sizeof(struct Dpp_Box));
-    memset(picked_boxes, 0, sizeof(struct Dpp_Box) * max_picked_boxes);
     int all_picked_size = 0;
 
     for (int i = 1; i < num_classes; i++)
     {
-        struct Dpp_Box* class_box = all_boxes + i * num_boxes;
-
-        // sort
-        sort_boxes_by_score(class_box, num_boxes);
         int box_size = 0;
+
         for (int j = 0; j < num_boxes; j++)
         {
-            if (class_box[j].score < 0.6)
-                break;
+            float score = score_f[j * num_classes + i];
+            if (score < DPP_SCORE_THRESHOLD)
+                continue;
+
+            struct Dpp_Box* box = class_box + box_size;
+            box->score = score;
+            box->class_idx = i;
+            box->box_idx = j;
+
+            if (decode_single_box(box, input_f, anchor_f, param->scales) < 0)
+                continue;
+
+            pairs[box_size].score = score;
+            pairs[box_size].index = box_size;
             box_size++;
         }
-        if (box_size == 0)
-            continue;
 
-        if (box_size > max_detections * 2)
-            box_size = max_detections * 2;
+        int top = box_size < class_top ? box_size : class_top;
+        ref_topk(pairs, box_size, top);
 
-        int* picked = (int*)sys_malloc(sizeof(int) * num_boxes);
-        int picked_size = 0;
+        for (int j = 0; j < top; j++)
+            sorted_box[j] = class_box[pairs[j].index];
 
-        picked[0] = 0;
-        nms_sorted_bboxes(class_box, box_size, picked, &picked_size, param->nms_iou_threshold);
+        int picked_size = ref_nms_sorted((const float*)sorted_box, sizeof(struct Dpp_Box) / sizeof(float), top,
+                                         param->nms_iou_threshold, 0.f, 0, 0, keep, num_thread);
 
         // save the survivors
         for (int j = 0; j < picked_size; j++)
-        {
-            int z = picked[j];
-            memcpy(picked_boxes + all_picked_size, class_box + z, sizeof(struct Dpp_Box));
-            all_picked_size++;
-        }
+            picked_boxes[all_picked_size++] = sorted_box[keep[j]];
+    }
 
-        sys_free(picked);
+    for (int i = 0; i < all_picked_size; i++)
+    {
+        pairs[i].score = picked_boxes[i].score;
+        pairs[i].index = i;
     }
 
-    sort_boxes_by_score(picked_boxes, max_picked_boxes);
-    if (all_picked_size > max_detections)
-        all_picked_size = max_detections;
+    // the best of all the classes, before they are cut to max_detections
+    int detect_size = all_picked_size < max_detections ? all_picked_size : max_detections;
+    ref_topk(pairs, all_picked_size, detect_size);
+    all_picked_size = detect_size;
 
     // generate output tensors
     detect_num[0] = all_picked_size;
 
     for (int i = 0; i < all_picked_size; i++)
     {
-        detect_class[i] = picked_boxes[i].class_idx;
-        detect_score[i] = picked_boxes[i].score;
+        const struct Dpp_Box* box = picked_boxes + pairs[i].index;
 
-        detect_boxes[4 * i] = picked_boxes[i].x0;
-        detect_boxes[4 * i + 1] = picked_boxes[i].y0;
-        detect_boxes[4 * i + 2] = picked_boxes[i].x1;
-        detect_boxes[4 * i + 3] = picked_boxes[i].y1;
+        detect_class[i] = box->class_idx;
+        detect_score[i] = box->score;
+
+        detect_boxes[4 * i] = box->x0;
+        detect_boxes[4 * i + 1] = box->y0;
+        detect_boxes[4 * i + 2] = box->x1;
+        detect_boxes[4 * i + 3] = box->y1;
     }
 
-    free(all_boxes);
-    free(picked_boxes);
+    sys_free(pairs);
+    sys_free(class_box);
+    sys_free(sorted_box);
+    sys_free(picked_boxes);
+    sys_free(keep);
+
     return 0;
 }
 
-int ref_dpp_uint8(const uint8_t* input, const uint8_t* score, const uint8_t* anchor,
-                  float* detect_num, float* detect_class, float* detect_score, float* detect_boxes, struct dpp_param* param)
+int ref_dpp_uint8(const uint8_t* input, const uint8_t* score, const uint8_t* anchor, float* detect_num,
+                  float* detect_class, float* detect_score, float* detect_boxes, struct dpp_param* param, int num_thread)
 {
     const int num_classes = param->num_classes + 1;
     const int num_boxes = param->num_boxes;
-    const int max_detections = param->max_detections;
 
     /* transform uint8_t to fp32 */
     int input_size = num_boxes * 4;
     int score_size = num_boxes * num_classes;
-    float* input_f = (float*)malloc(input_size * sizeof(float));
-    float* score_f = (float*)malloc(score_size * sizeof(float));
-    float* anchor_f = (float*)malloc(input_size * sizeof(float));
-    for (int i = 0; i < input_size; i++)
-        input_f[i] = (input[i] - param->zero[0]) * param->quant_scale[0];
-    for (int i = 0; i < score_size; i++)
-        score_f[i] = score[i] * param->quant_scale[1];
-    for (int i = 0; i < input_size; i++)
-        anchor_f[i] = (anchor[i] - param->zero[2]) * param->quant_scale[2];
-
-    struct Dpp_Box* all_boxes = (struct Dpp_Box*)malloc((unsigned long)num_classes * num_boxes * sizeof(struct Dpp_Box));
-    memset(all_boxes, 0, sizeof(struct Dpp_Box) * num_classes * num_boxes);
-
-    get_all_boxes_rect(all_boxes, input_f, score_f, anchor_f, num_boxes, num_classes, param->scales);
-
-    int max_picked_boxes = 2 * max_detections * num_classes;
-    struct Dpp_Box* picked_boxes = (struct Dpp_Box*)malloc(max_picked_boxes * sizeof(struct Dpp_Box));
-    memset(picked_boxes, 0, sizeof(struct Dpp_Box) * max_picked_boxes);
-    int all_picked_size = 0;
-
-    for (int i = 1; i < num_classes; i++)
-    {
-        struct Dpp_Box* class_box = all_boxes + i * num_boxes;
-
-        // sort
-        sort_boxes_by_score(class_box, num_boxes);
-        int box_size = 0;
-        for (int j = 0; j < num_boxes; j++)
-        {
-            if (class_box[j].score < 0.6)
-                break;
-            box_size++;
-        }
-        if (box_size == 0)
-            continue;
-
-        if (box_size > max_detections * 2)
-            box_size = max_detections * 2;
+    float* input_f = (float*)sys_malloc(input_size * sizeof(float));
+    float* score_f = (float*)sys_malloc(score_size * sizeof(float));
+    float* anchor_f = (float*)sys_malloc(input_size * sizeof(float));
 
-        int* picked = (int*)sys_malloc(sizeof(int) * num_boxes);
-        int picked_size = 0;
+    int ret = -1;
 
-        picked[0] = 0;
-        nms_sorted_bboxes(class_box, box_size, picked, &picked_size, param->nms_iou_threshold);
-
-        // save the survivors
-        for (int j = 0; j < picked_size; j++)
-        {
-            int z = picked[j];
-            memcpy(picked_boxes + all_picked_size, class_box + z, sizeof(struct Dpp_Box));
-            all_picked_size++;
-        }
-
-        sys_free(picked);
-    }
-
-    sort_boxes_by_score(picked_boxes, max_picked_boxes);
-    if (all_picked_size > max_detections)
-        all_picked_size = max_detections;
-
-    // generate output tensors
-    detect_num[0] = all_picked_size;
-
-    for (int i = 0; i < all_picked_size; i++)
+    if (input_f != NULL && score_f != NULL && anchor_f != NULL)
     {
-        detect_class[i] = picked_boxes[i].class_idx;
-        detect_score[i] = picked_boxes[i].score;
-
-        detect_boxes[4 * i] = picked_boxes[i].x0;
-        detect_boxes[4 * i + 1] = picked_boxes[i].y0;
-        detect_boxes[4 * i + 2] = picked_boxes[i].x1;
-        detect_boxes[4 * i + 3] = picked_boxes[i].y1;
+        for (int i = 0; i < input_size; i++)
+            input_f[i] = (input[i] - param->zero[0]) * param->quant_scale[0];
+        for (int i = 0; i < score_size; i++)
+            score_f[i] = score[i] * param->quant_scale[1];
+        for (int i = 0; i < input_size; i++)
+            anchor_f[i] = (anchor[i] - param->zero[2]) * param->quant_scale[2];
+
+        ret = ref_dpp_fp32(input_f, score_f, anchor_f, detect_num, detect_class, detect_score, detect_boxes, param,
+                           num_thread);
     }
 
-    free(anchor_f);
-    free(score_f);
-    free(input_f);
-    free(all_boxes);
-    free(picked_boxes);
+    sys_free(anchor_f);
+    sys_free(score_f);
+    sys_free(input_f);
 
-    return 0;
+    return ret;
 }
 
 struct dpp_param param;
@@ -404,7 +274,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
     const void* input_data = input_tensor->data;
     struct tensor* score = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
-    void* score_data = score->data;
+    const void* score_data = score->data;
     struct tensor* anchor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
     void* anchor_data = anchor->data;
 
@@ -427,78 +297,37 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
         param.zero[2] = anchor->zero_point;
     }
 
-    /* transpose nchw to nchw */
-    if (input_tensor->dim_num == 3 && input_tensor->elem_size == 1)
-    {
-        int in_ch = input_tensor->dims[1];
-        int in_w = input_tensor->dims[2];
-        int in_size = input_tensor->elem_num;
-
-        int score_ch = score->dims[1];
-        int score_w = score->dims[2];
-        int score_size = score->elem_num;
-
-        uint8_t* input_uint8 = (uint8_t*)input_tensor->data;
-        uint8_t* score_uint8 = (uint8_t*)score->data;
-        uint8_t* input_uint8_temp = (uint8_t*)malloc(in_size);
-        uint8_t* score_uint8_temp = (uint8_t*)malloc(score_size);
-
-        memcpy(input_uint8_temp, input_uint8, in_size);
-        memcpy(score_uint8_temp, score_uint8, score_size);
-
-        int index = 0;
-        for (int w = 0; w < in_w; w++)
-            for (int c = 0; c < in_ch; c++)
-                input_uint8[index++] = input_uint8_temp[c * in_w + w];
-
-        index = 0;
-        for (int w = 0; w < score_w; w++)
-            for (int c = 0; c < score_ch; c++)
-                score_uint8[index++] = score_uint8_temp[c * score_w + w];
-
-        free(input_uint8_temp);
-        free(score_uint8_temp);
-    }
-    else
+    /* the boxes and the scores of [1, c, num_boxes] to [num_boxes, c], the inputs are kept */
+    int box_dims[2] = {input_tensor->dims[1], input_tensor->dims[2]};
+    int score_dims[2] = {score->dims[1], score->dims[2]};
+    int perm[2] = {1, 0};
+
+    void* input_t = sys_malloc((size_t)input_tensor->elem_num * input_tensor->elem_size);
+    void* score_t = sys_malloc((size_t)score->elem_num * score->elem_size);
+
+    int ret = -1;
+
+    if (input_t != NULL && score_t != NULL
+        && ref_transpose(input_data, input_t, box_dims, perm, 2, input_tensor->elem_size, exec_graph->num_thread) == 0
+        && ref_transpose(score_data, score_t, score_dims, perm, 2, score->elem_size, exec_graph->num_thread) == 0)
     {
-        int in_ch = input_tensor->dims[1];
-        int in_w = input_tensor->dims[2];
-        int in_size = input_tensor->elem_num;
-
-        int score_ch = score->dims[1];
-        int score_w = score->dims[2];
-        int score_size = score->elem_num;
-
-        float* input_fp32 = (float*)input_tensor->data;
-        float* score_fp32 = (float*)score->data;
-        float* input_fp32_temp = (float*)malloc(in_size * sizeof(float));
-        float* score_fp32_temp = (float*)malloc(score_size * sizeof(float));
-
-        memcpy(input_fp32_temp, input_fp32, in_size);
-        memcpy(score_fp32_temp, score_fp32, score_size);
-
-        int index = 0;
-        for (int w = 0; w < in_w; w++)
-            for (int c = 0; c < in_ch; c++)
-                input_fp32[index++] = input_fp32_temp[c * in_w + w];
-
-        index = 0;
-        for (int w = 0; w < score_w; w++)
-            for (int c = 0; c < score_ch; c++)
-                score_fp32[index++] = score_fp32_temp[c * score_w + w];
-
-        free(input_fp32_temp);
-        free(score_fp32_temp);
+        if (input_tensor->data_type == TENGINE_DT_FP32)
+            ret = ref_dpp_fp32((float*)input_t, (float*)score_t, (float*)anchor_data, detect_num_data,
+                               detect_classes_data, detect_scores_data, detect_boxes_data, &param,
+                               exec_graph->num_thread);
+        else
+            ret = ref_dpp_uint8((uint8_t*)input_t, (uint8_t*)score_t, (uint8_t*)anchor_data, detect_num_data,
+                                detect_classes_data, detect_scores_data, detect_boxes_data, &param,
+                                exec_graph->num_thread);
     }
 
-    if (input_tensor->data_type == TENGINE_DT_FP32)
-        ref_dpp_fp32((float*)input_data, (float*)score_data, (float*)anchor_data, detect_num_data,
-                     detect_classes_data, detect_scores_data, detect_boxes_data, &param);
-    else
-        ref_dpp_uint8((uint8_t*)input_data, (uint8_t*)score_data, (uint8_t*)anchor_data, detect_num_data,
-                      detect_classes_data, detect_scores_data, detect_boxes_data, &param);
+    sys_free(input_t);
+    sys_free(score_t);
 
-    return 0;
+    if (ret < 0)
+        TLOG_ERR("detection_postprocess: no memory for the boxes of node %d\n", ir_node->index);
+
+    return ret;
 }
 
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
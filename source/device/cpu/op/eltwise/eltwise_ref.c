@@ -898,9 +898,16 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
         {
             return -1;
         }
+
+        /* the ref broadcasts the smaller input to the larger one only, not both of them to the output */
+        if (output_tensor->elem_num != ELT_MAX(input_tensor0->elem_num, input_tensor1->elem_num))
+        {
+            TLOG_ERR("eltwise ref op does not support broadcasting both inputs\n");
+            return -1;
+        }
     }
 
-    if (!input_tensor1 || input_tensor0->elem_num >= input_tensor1->elem_num)
+    if (!input_tensor1 ||input_tensor0->elem_num >= input_tensor1->elem_num)
     {
         int input_chan_0 = 0;
         int input_hw_0 = 0;
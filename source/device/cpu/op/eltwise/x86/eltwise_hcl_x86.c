@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "eltwise_kernel_x86.h"
+
+#include "eltwise_param.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/cpu.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+
+/* the binary types, the unary ones and power are left to the ref op */
+static int get_eltwise_op(int type)
+{
+    switch (type)
+    {
+    case ELT_SUM:
+    case ELT_SUM_SCALAR:
+        return ELTWISE_X86_ADD;
+    case ELT_SUB:
+    case ELT_SUB_SCALAR:
+        return ELTWISE_X86_SUB;
+    case ELT_PROD:
+    case ELT_PROD_SCALAR:
+        return ELTWISE_X86_MUL;
+    case ELT_DIV:
+        return ELTWISE_X86_DIV;
+    case ELT_MAX:
+        return ELTWISE_X86_MAX;
+    case ELT_MIN_SCALAR:
+        return ELTWISE_X86_MIN;
+    case ELT_POW:
+        return ELTWISE_X86_POW;
+    default:
+        return -1;
+    }
+}
+
+/*
+ * the inputs of the same dim number broadcast numpy style. the others are as the ref op
+ * first, the smaller input is of one element, of the channels of the larger one or of its
+ * hw, then numpy style. the channels are of an nchw graph, in nhwc they are the last dim
+ * which numpy style broadcasts.
+ */
+static int set_eltwise_shape(struct eltwise_x86_param* param, struct tensor* input0, struct tensor* input1, int layout)
+{
+    if (input0->dim_num == input1->dim_num
+        && eltwise_x86_set_shape(param, input0->dims, input0->dim_num, input1->dims, input1->dim_num) == 0)
+        return 0;
+
+    int swap = input0->elem_num < input1->elem_num;
+    struct tensor* large = swap ? input1 : input0;
+    struct tensor* small = swap ? input0 : input1;
+
+    int count = large->elem_num;
+    int chan = 0;
+    int hw = 0;
+
+    if (layout == TENGINE_LAYOUT_NCHW && large->dim_num >= 4)
+    {
+        chan = large->dims[large->dim_num - 4] * large->dims[large->dim_num - 3];
+        hw = large->dims[large->dim_num - 2] * large->dims[large->dim_num - 1];
+    }
+    else if (layout == TENGINE_LAYOUT_NCHW && large->dim_num == 3)
+    {
+        chan = large->dims[0] == 1 ? large->dims[1] : large->dims[0];
+        hw = chan > 0 ? count / chan : 0;
+    }
+
+    int dims_large[2] = {count, 1};
+    int dims_small[2] = {1, 1};
+    int dim_num = 0;
+
+    if (small->elem_num == count)
+    {
+        dims_small[0] = count;
+        dim_num = 1;
+    }
+    else if (small->elem_num == 1)
+    {
+        dim_num = 1;
+    }
+    else if (chan * hw == count && small->elem_num == chan)
+    {
+        dims_large[0] = chan;
+        dims_large[1] = hw;
+        dims_small[0] = chan;
+        dim_num = 2;
+    }
+    else if (chan * hw == count && small->elem_num == hw)
+    {
+        dims_large[0] = chan;
+        dims_large[1] = hw;
+        dims_small[1] = hw;
+        dim_num = 2;
+    }
+
+    if (dim_num == 0)
+        return eltwise_x86_set_shape(param, input0->dims, input0->dim_num, input1->dims, input1->dim_num);
+
+    if (swap)
+        return eltwise_x86_set_shape(param, dims_small, dim_num, dims_large, dim_num);
+    else
+        return eltwise_x86_set_shape(param, dims_large, dim_num, dims_small, dim_num);
+}
+
+static int set_eltwise_param(struct eltwise_x86_param* param, struct node* ir_node)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct eltwise_param* eltwise_param = (struct eltwise_param*)ir_node->op.param_mem;
+
+    if (ir_node->input_num != 2)
+        return -1;
+
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* input_tensor1 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    param->op = get_eltwise_op(eltwise_param->type);
+    if (param->op < 0)
+        return -1;
+
+    if (eltwise_x86_set_type(param, input_tensor0, input_tensor1, output_tensor) < 0)
+        return -1;
+
+    int ret;
+
+    /* the first element of input1 for the scalar types */
+    if (eltwise_param->type == ELT_SUM_SCALAR || eltwise_param->type == ELT_SUB_SCALAR
+        || eltwise_param->type == ELT_PROD_SCALAR || eltwise_param->type == ELT_MIN_SCALAR)
+    {
+        int dim = 1;
+        ret = eltwise_x86_set_shape(param, input_tensor0->dims, input_tensor0->dim_num, &dim, 1);
+    }
+    else
+    {
+        ret = set_eltwise_shape(param, input_tensor0, input_tensor1, ir_graph->graph_layout);
+    }
+
+    if (ret < 0)
+        return -1;
+
+    int size = 1;
+    for (int i = 0; i < param->dim_num; i++)
+        size *= param->dims[i];
+
+    return size == output_tensor->elem_num ? 0 : -1;
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct eltwise_x86_param param;
+
+    /* the shapes may change with the inputs */
+    if (set_eltwise_param(&param, ir_node) < 0)
+    {
+        TLOG_ERR("eltwise x86 op does not support the shapes of node %d\n", ir_node->index);
+        return -1;
+    }
+
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* input_tensor1 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    eltwise_x86_run(&param, input_tensor0->data, input_tensor1->data, output_tensor->data, exec_graph->num_thread);
+
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct eltwise_x86_param param;
+
+    if (set_eltwise_param(&param, exec_node) < 0)
+        return 0;
+
+    return OPS_SCORE_PREFER;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = NULL,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = NULL,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .isa = CPU_ISA_BUILD};
+
+int register_eltwise_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_ELTWISE, &hcl_node_ops);
+}
+
+int unregister_eltwise_hcl_x86_op()
+{
+    return unregister_builtin_node_ops(OP_ELTWISE, &hcl_node_ops);
+}
@@ -0,0 +1,551 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "eltwise_kernel_x86.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#define ELTWISE_X86_BLOCK     256   /* the int8 and uint8 are computed in blocks of fp32 on the stack */
+#define ELTWISE_X86_TASK_SIZE 16384 /* the least elements of a thread */
+
+/*
+ * the dims of the output are collapsed, the ones of size 1 are dropped and the ones the
+ * inputs both walk contiguously or both broadcast are merged with their inner dim. the
+ * last dim is walked by the kernels, the inputs step 1 or 0 on it. the output is split
+ * to the threads evenly, a part of it may start or end in the middle of a row.
+ */
+struct eltwise_x86_job
+{
+    int op;
+    int data_type;
+    int dim_num;
+    int dims[MAX_SHAPE_DIM_NUM];
+    int strides0[MAX_SHAPE_DIM_NUM]; /* in elements, 0 for a broadcast dim */
+    int strides1[MAX_SHAPE_DIM_NUM];
+    size_t total;
+    int task_num;
+
+    const uint8_t* input0;
+    const uint8_t* input1;
+    uint8_t* output;
+
+    float scale[3];
+    int zero[3];
+    int avx512; /* the cpu has avx512f */
+};
+
+int eltwise_x86_set_shape(struct eltwise_x86_param* param, const int* dims0, int dim0_num, const int* dims1,
+                          int dim1_num)
+{
+    int dim_num = dim0_num > dim1_num ? dim0_num : dim1_num;
+
+    if (dim_num > MAX_SHAPE_DIM_NUM)
+        return -1;
+
+    for (int i = 0; i < dim_num; i++)
+    {
+        int index0 = i - (dim_num - dim0_num);
+        int index1 = i - (dim_num - dim1_num);
+        int dim0 = index0 >= 0 ? dims0[index0] : 1;
+        int dim1 = index1 >= 0 ? dims1[index1] : 1;
+
+        if (dim0 != dim1 && dim0 != 1 && dim1 != 1)
+            return -1;
+
+        param->dims[i] = dim0 == 1 ? dim1 : dim0;
+        param->dims0[i] = dim0;
+        param->dims1[i] = dim1;
+    }
+
+    param->dim_num = dim_num;
+
+    return 0;
+}
+
+int eltwise_x86_set_type(struct eltwise_x86_param* param, const struct tensor* input0, const struct tensor* input1,
+                         const struct tensor* output)
+{
+    const struct tensor* tensors[3] = {input0, input1, output};
+    int data_type = output->data_type;
+
+    if (data_type != TENGINE_DT_FP32 && data_type != TENGINE_DT_INT8 && data_type != TENGINE_DT_UINT8)
+        return -1;
+
+    for (int i = 0; i < 3; i++)
+    {
+        const struct tensor* tensor = tensors[i];
+
+        if (tensor->data_type != data_type)
+            return -1;
+
+        param->scale[i] = 1.f;
+        param->zero[i] = 0;
+
+        if (data_type == TENGINE_DT_FP32)
+            continue;
+
+        if (tensor->quant_param_num > 1)
+            return -1;
+
+        /* the int8 ones are symmetric as the ref ops */
+        param->scale[i] = tensor->scale;
+        if (data_type == TENGINE_DT_UINT8)
+            param->zero[i] = tensor->zero_point;
+    }
+
+    param->data_type = data_type;
+
+    return 0;
+}
+
+static inline float binary_op(int op, float a, float b)
+{
+    switch (op)
+    {
+    case ELTWISE_X86_ADD:
+        return a + b;
+    case ELTWISE_X86_SUB:
+        return a - b;
+    case ELTWISE_X86_MUL:
+        return a * b;
+    case ELTWISE_X86_DIV:
+        return a / b;
+    case ELTWISE_X86_MAX:
+        return a > b ? a : b;
+    case ELTWISE_X86_MIN:
+        return a < b ? a : b;
+    case ELTWISE_X86_POW:
+        return powf(a, b);
+    default:
+        return (a - b) * (a - b);
+    }
+}
+
+#if __AVX__
+static inline __m256 squared_diff_avx(__m256 a, __m256 b)
+{
+    __m256 d = _mm256_sub_ps(a, b);
+    return _mm256_mul_ps(d, d);
+}
+
+/* max and min return b for a nan as the c ones */
+#define BINARY_LOOP_AVX(_op)                                                               \
+    for (; i + 7 < n; i += 8)                                                              \
+    {                                                                                      \
+        __m256 _a = a_step ? _mm256_loadu_ps(a + i) : _mm256_broadcast_ss(a);             \
+        __m256 _b = b_step ? _mm256_loadu_ps(b + i) : _mm256_broadcast_ss(b);             \
+        _mm256_storeu_ps(c + i, _op(_a, _b));                                              \
+    }
+#endif
+
+static void binary_fp32(const struct eltwise_x86_job* job, int n, const float* a, int a_step, const float* b,
+                        int b_step, float* c)
+{
+    int op = job->op;
+
+    if (job->avx512 && op != ELTWISE_X86_POW)
+    {
+        eltwise_x86_fp32_avx512(op, n, a, a_step, b, b_step, c);
+        return;
+    }
+
+    int i = 0;
+
+#if __AVX__
+    switch (op)
+    {
+    case ELTWISE_X86_ADD:
+        BINARY_LOOP_AVX(_mm256_add_ps);
+        break;
+    case ELTWISE_X86_SUB:
+        BINARY_LOOP_AVX(_mm256_sub_ps);
+        break;
+    case ELTWISE_X86_MUL:
+        BINARY_LOOP_AVX(_mm256_mul_ps);
+        break;
+    case ELTWISE_X86_DIV:
+        BINARY_LOOP_AVX(_mm256_div_ps);
+        break;
+    case ELTWISE_X86_MAX:
+        BINARY_LOOP_AVX(_mm256_max_ps);
+        break;
+    case ELTWISE_X86_MIN:
+        BINARY_LOOP_AVX(_mm256_min_ps);
+        break;
+    case ELTWISE_X86_SQUARED_DIFF:
+        BINARY_LOOP_AVX(squared_diff_avx);
+        break;
+    default:
+        break;
+    }
+#endif
+
+    for (; i < n; i++)
+        c[i] = binary_op(op, a[i * a_step], b[i * b_step]);
+}
+
+/* y = (x - zero) * scale */
+static void dequant(const struct eltwise_x86_job* job, int slot, const uint8_t* x, int n, float* y)
+{
+    float scale = job->scale[slot];
+    int zero = job->zero[slot];
+    int is_uint8 = job->data_type == TENGINE_DT_UINT8;
+    int i = 0;
+
+#if __AVX__
+    __m256 _scale = _mm256_set1_ps(scale);
+    __m128i _zero = _mm_set1_epi32(zero);
+
+    for (; i + 7 < n; i += 8)
+    {
+        __m128i _x = _mm_loadl_epi64((const __m128i*)(x + i));
+        __m128i _lo = is_uint8 ? _mm_cvtepu8_epi32(_x) : _mm_cvtepi8_epi32(_x);
+        __m128i _hi = is_uint8 ? _mm_cvtepu8_epi32(_mm_srli_si128(_x, 4)) : _mm_cvtepi8_epi32(_mm_srli_si128(_x, 4));
+
+        _lo = _mm_sub_epi32(_lo, _zero);
+        _hi = _mm_sub_epi32(_hi, _zero);
+
+        __m256 _v = _mm256_cvtepi32_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(_lo), _hi, 1));
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(_v, _scale));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        int value = is_uint8 ? (int)x[i] : (int)(int8_t)x[i];
+        y[i] = (float)(value - zero) * scale;
+    }
+}
+
+/* y = round(x / scale) + zero, saturated to 0 ~ 255 for uint8 and -127 ~ 127 for int8 */
+static void quant(const struct eltwise_x86_job* job, const float* x, int n, uint8_t* y)
+{
+    float scale = job->scale[2];
+    int zero = job->zero[2];
+    int is_uint8 = job->data_type == TENGINE_DT_UINT8;
+    int low = is_uint8 ? 0 : -127;
+    int high = is_uint8 ? 255 : 127;
+    int i = 0;
+
+#if __AVX__
+    __m256 _scale = _mm256_set1_ps(scale);
+    __m256 _zero = _mm256_set1_ps((float)zero);
+    __m256 _low = _mm256_set1_ps((float)low);
+    __m256 _high = _mm256_set1_ps((float)high);
+    __m256 _sign = _mm256_set1_ps(-0.f);
+    __m256 _half = _mm256_set1_ps(0.5f);
+    __m256 _one = _mm256_set1_ps(1.f);
+
+    for (; i + 7 < n; i += 8)
+    {
+        __m256 _v = _mm256_div_ps(_mm256_loadu_ps(x + i), _scale);
+        __m256 _t = _mm256_round_ps(_v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+
+        /* the halves are rounded away from zero as round() */
+        __m256 _frac = _mm256_andnot_ps(_sign, _mm256_sub_ps(_v, _t));
+        __m256 _away = _mm256_or_ps(_one, _mm256_and_ps(_sign, _v));
+        _t = _mm256_add_ps(_t, _mm256_and_ps(_mm256_cmp_ps(_frac, _half, _CMP_GE_OQ), _away));
+
+        _t = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_t, _zero), _low), _high);
+
+        __m256i _q = _mm256_cvtps_epi32(_t);
+        __m128i _q16 = _mm_packs_epi32(_mm256_castsi256_si128(_q), _mm256_extractf128_si256(_q, 1));
+        __m128i _q8 = is_uint8 ? _mm_packus_epi16(_q16, _q16) : _mm_packs_epi16(_q16, _q16);
+
+        _mm_storel_epi64((__m128i*)(y + i), _q8);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        int value = (int)roundf(x[i] / scale) + zero;
+
+        if (value > high)
+            value = high;
+        else if (value < low)
+            value = low;
+
+        y[i] = (uint8_t)value;
+    }
+}
+
+/* n elements of a row, from the elements of the inputs at offset0 and offset1 to the ones of the output at offset */
+static void run_row(const struct eltwise_x86_job* job, size_t offset0, size_t offset1, size_t offset, int n)
+{
+    int step0 = job->strides0[job->dim_num - 1];
+    int step1 = job->strides1[job->dim_num - 1];
+
+    if (job->data_type == TENGINE_DT_FP32)
+    {
+        const float* input0 = (const float*)job->input0 + offset0;
+        const float* input1 = (const float*)job->input1 + offset1;
+        float* output = (float*)job->output + offset;
+
+        binary_fp32(job, n, input0, step0, input1, step1, output);
+        return;
+    }
+
+    float a[ELTWISE_X86_BLOCK];
+    float b[ELTWISE_X86_BLOCK];
+    float c[ELTWISE_X86_BLOCK];
+
+    for (int i = 0; i < n; i += ELTWISE_X86_BLOCK)
+    {
+        int block = n - i < ELTWISE_X86_BLOCK ? n - i : ELTWISE_X86_BLOCK;
+
+        dequant(job, 0, job->input0 + offset0 + (size_t)i * step0, step0 ? block : 1, a);
+        dequant(job, 1, job->input1 + offset1 + (size_t)i * step1, step1 ? block : 1, b);
+
+        binary_fp32(job, block, a, step0, b, step1, c);
+
+        quant(job, c, block, job->output + offset + i);
+    }
+}
+
+/* the first element of a task, aligned to 64 for the threads not to share the cache lines */
+static size_t get_task_start(const struct eltwise_x86_job* job, int task)
+{
+    if (task >= job->task_num)
+        return job->total;
+
+    return (job->total * task / job->task_num) & ~(size_t)63;
+}
+
+static void eltwise_task(void* arg, int begin, int end)
+{
+    const struct eltwise_x86_job* job = (const struct eltwise_x86_job*)arg;
+    int dim_num = job->dim_num;
+    int inner = job->dims[dim_num - 1];
+
+    size_t start = get_task_start(job, begin);
+    size_t stop = get_task_start(job, end);
+
+    if (start >= stop)
+        return;
+
+    /* the index of the outer dims of the first row */
+    int index[MAX_SHAPE_DIM_NUM];
+    size_t row = start / inner;
+    int col = (int)(start % inner);
+    size_t offset0 = 0;
+    size_t offset1 = 0;
+
+    for (int i = dim_num - 2; i >= 0; i--)
+    {
+        index[i] = (int)(row % job->dims[i]);
+        row /= job->dims[i];
+
+        offset0 += (size_t)index[i] * job->strides0[i];
+        offset1 += (size_t)index[i] * job->strides1[i];
+    }
+
+    size_t offset = start;
+
+    while (offset < stop)
+    {
+        int n = inner - col;
+        if ((size_t)n > stop - offset)
+            n = (int)(stop - offset);
+
+        run_row(job, offset0 + (size_t)col * job->strides0[dim_num - 1], offset1 + (size_t)col * job->strides1[dim_num - 1],
+                offset, n);
+
+        offset += n;
+        col = 0;
+
+        /* the next row, the offsets wrap as the index */
+        for (int i = dim_num - 2; i >= 0; i--)
+        {
+            offset0 += job->strides0[i];
+            offset1 += job->strides1[i];
+
+            if (++index[i] < job->dims[i])
+                break;
+
+            offset0 -= (size_t)job->dims[i] * job->strides0[i];
+            offset1 -= (size_t)job->dims[i] * job->strides1[i];
+            index[i] = 0;
+        }
+    }
+}
+
+static void collapse_shape(const struct eltwise_x86_param* param, struct eltwise_x86_job* job)
+{
+    /* from the inner dims to the outer ones */
+    int dims[MAX_SHAPE_DIM_NUM];
+    int strides0[MAX_SHAPE_DIM_NUM];
+    int strides1[MAX_SHAPE_DIM_NUM];
+    int size0 = 1;
+    int size1 = 1;
+    int num = 0;
+
+    for (int i = param->dim_num - 1; i >= 0; i--)
+    {
+        int dim = param->dims[i];
+        int stride0 = param->dims0[i] == 1 ? 0 : size0;
+        int stride1 = param->dims1[i] == 1 ? 0 : size1;
+
+        size0 *= param->dims0[i];
+        size1 *= param->dims1[i];
+
+        if (dim == 1)
+            continue;
+
+        if (num > 0 && stride0 == strides0[num - 1] * dims[num - 1] && stride1 == strides1[num - 1] * dims[num - 1])
+        {
+            dims[num - 1] *= dim;
+            continue;
+        }
+
+        dims[num] = dim;
+        strides0[num] = stride0;
+        strides1[num] = stride1;
+        num++;
+    }
+
+    if (num == 0)
+    {
+        dims[0] = 1;
+        strides0[0] = 0;
+        strides1[0] = 0;
+        num = 1;
+    }
+
+    job->dim_num = num;
+    job->total = 1;
+
+    for (int i = 0; i < num; i++)
+    {
+        job->dims[i] = dims[num - 1 - i];
+        job->strides0[i] = strides0[num - 1 - i];
+        job->strides1[i] = strides1[num - 1 - i];
+        job->total *= dims[i];
+    }
+}
+
+void eltwise_x86_run(const struct eltwise_x86_param* param, const void* input0, const void* input1, void* output,
+                     int num_thread)
+{
+    struct eltwise_x86_job job;
+
+    collapse_shape(param, &job);
+
+    job.op = param->op;
+    job.data_type = param->data_type;
+    job.input0 = (const uint8_t*)input0;
+    job.input1 = (const uint8_t*)input1;
+    job.output = (uint8_t*)output;
+    job.avx512 = (get_cpu_isa() & CPU_ISA_AVX512F) != 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        job.scale[i] = param->scale[i];
+        job.zero[i] = param->zero[i];
+    }
+
+    size_t task_num = (job.total + ELTWISE_X86_TASK_SIZE - 1) / ELTWISE_X86_TASK_SIZE;
+    job.task_num = task_num < (size_t)num_thread ? (int)task_num : num_thread;
+    if (job.task_num < 1)
+        job.task_num = 1;
+
+    parallel_for(eltwise_task, &job, job.task_num, num_thread);
+}
+
+/* the input of the slot folded into the output, -1 for the shapes not supported */
+static int set_fold_param(struct eltwise_x86_param* param, struct node* ir_node, int op, int input_slot)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_slot]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    if (input_tensor->data_type != TENGINE_DT_FP32 || output_tensor->data_type != TENGINE_DT_FP32)
+        return -1;
+
+    if (eltwise_x86_set_type(param, input_tensor, output_tensor, output_tensor) < 0)
+        return -1;
+
+    param->op = op;
+
+    int ret = eltwise_x86_set_shape(param, input_tensor->dims, input_tensor->dim_num, output_tensor->dims,
+                                    output_tensor->dim_num);
+    if (ret < 0)
+        return -1;
+
+    int size = 1;
+    for (int i = 0; i < param->dim_num; i++)
+        size *= param->dims[i];
+
+    return size == output_tensor->elem_num ? 0 : -1;
+}
+
+int eltwise_x86_check_fold(struct node* ir_node, int op)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct eltwise_x86_param param;
+
+    if (input_tensor0->data_type != TENGINE_DT_FP32 || input_tensor0->elem_num != output_tensor->elem_num)
+        return -1;
+
+    for (int i = 1; i < ir_node->input_num; i++)
+    {
+        if (set_fold_param(&param, ir_node, op, i) < 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+void eltwise_x86_fold(struct node* ir_node, int op, int num_thread)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    if (output_tensor->data != input_tensor0->data)
+        memcpy(output_tensor->data, input_tensor0->data, (size_t)output_tensor->elem_num * sizeof(float));
+
+    for (int i = 1; i < ir_node->input_num; i++)
+    {
+        struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+        struct eltwise_x86_param param;
+
+        set_fold_param(&param, ir_node, op, i);
+
+        eltwise_x86_run(&param, input_tensor->data, output_tensor->data, output_tensor->data, num_thread);
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef _ELTWISE_KERNEL_X86_H_
+#define _ELTWISE_KERNEL_X86_H_
+
+#include "api/c_api.h"
+
+struct tensor;
+struct node;
+
+/*
+ * the binary ops of eltwise, broadmul, maximum, minimum and squareddifference,
+ * output = input0 op input1, the inputs broadcast to the output numpy style.
+ */
+#define ELTWISE_X86_ADD          0
+#define ELTWISE_X86_SUB          1
+#define ELTWISE_X86_MUL          2
+#define ELTWISE_X86_DIV          3
+#define ELTWISE_X86_MAX          4 /* input0 > input1 ? input0 : input1 */
+#define ELTWISE_X86_MIN          5 /* input0 < input1 ? input0 : input1 */
+#define ELTWISE_X86_POW          6
+#define ELTWISE_X86_SQUARED_DIFF 7
+
+struct eltwise_x86_param
+{
+    int op;
+    int data_type; /* fp32, int8 or uint8 of all the tensors */
+
+    int dim_num;
+    int dims[MAX_SHAPE_DIM_NUM];  /* output */
+    int dims0[MAX_SHAPE_DIM_NUM]; /* input0 aligned to the right of the output, 1 for a broadcast dim */
+    int dims1[MAX_SHAPE_DIM_NUM];
+
+    /* of input0, input1 and output, int8 and uint8 are dequantized and requantized as the ref ops */
+    float scale[3];
+    int zero[3];
+};
+
+/* set the output shape the inputs broadcast to, -1 for the shapes not broadcast */
+int eltwise_x86_set_shape(struct eltwise_x86_param* param, const int* dims0, int dim0_num, const int* dims1,
+                          int dim1_num);
+
+/* set the data type and the quant params, -1 for the tensors not supported */
+int eltwise_x86_set_type(struct eltwise_x86_param* param, const struct tensor* input0, const struct tensor* input1,
+                         const struct tensor* output);
+
+/* the output is as contiguous as the inputs, and may be one of them */
+void eltwise_x86_run(const struct eltwise_x86_param* param, const void* input0, const void* input1, void* output,
+                     int num_thread);
+
+/*
+ * output = the op of all the inputs of the node, maximum or minimum, of the shape of input0, the
+ * others broadcast to it numpy style. they are folded into the output one by one as op(input, output),
+ * so that the earlier input is kept for the equal ones and a nan as the ref ops.
+ */
+int eltwise_x86_check_fold(struct node* ir_node, int op);
+
+void eltwise_x86_fold(struct node* ir_node, int op, int num_thread);
+
+/* only for the cpu with avx512f, c[i] = a[i * a_step] op b[i * b_step], the steps are 0 or 1 */
+void eltwise_x86_fp32_avx512(int op, int n, const float* a, int a_step, const float* b, int b_step, float* c);
+
+#endif
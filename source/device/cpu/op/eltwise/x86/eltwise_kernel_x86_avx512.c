@@ -0,0 +1,109 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "eltwise_kernel_x86.h"
+
+#include <math.h>
+
+#if __AVX512F__
+#include <immintrin.h>
+#endif
+
+static inline float binary_op(int op, float a, float b)
+{
+    switch (op)
+    {
+    case ELTWISE_X86_ADD:
+        return a + b;
+    case ELTWISE_X86_SUB:
+        return a - b;
+    case ELTWISE_X86_MUL:
+        return a * b;
+    case ELTWISE_X86_DIV:
+        return a / b;
+    case ELTWISE_X86_MAX:
+        return a > b ? a : b;
+    case ELTWISE_X86_MIN:
+        return a < b ? a : b;
+    case ELTWISE_X86_POW:
+        return powf(a, b);
+    default:
+        return (a - b) * (a - b);
+    }
+}
+
+#if __AVX512F__
+static inline __m512 squared_diff_avx512(__m512 a, __m512 b)
+{
+    __m512 d = _mm512_sub_ps(a, b);
+    return _mm512_mul_ps(d, d);
+}
+
+/* the tail is masked, max and min return b for a nan as the c ones */
+#define BINARY_LOOP_AVX512(_op)                                                                 \
+    for (; i < n; i += 16)                                                                      \
+    {                                                                                           \
+        __mmask16 _m = n - i >= 16 ? 0xffff : (__mmask16)((1u << (n - i)) - 1);                \
+        __m512 _a = a_step ? _mm512_maskz_loadu_ps(_m, a + i) : _mm512_set1_ps(a[0]);           \
+        __m512 _b = b_step ? _mm512_maskz_loadu_ps(_m, b + i) : _mm512_set1_ps(b[0]);           \
+        _mm512_mask_storeu_ps(c + i, _m, _op(_a, _b));                                          \
+    }
+#endif
+
+/* built with avx512f whatever the isa of the other x86 sources, called only on a cpu with it */
+void eltwise_x86_fp32_avx512(int op, int n, const float* a, int a_step, const float* b, int b_step, float* c)
+{
+    int i = 0;
+
+#if __AVX512F__
+    switch (op)
+    {
+    case ELTWISE_X86_ADD:
+        BINARY_LOOP_AVX512(_mm512_add_ps);
+        break;
+    case ELTWISE_X86_SUB:
+        BINARY_LOOP_AVX512(_mm512_sub_ps);
+        break;
+    case ELTWISE_X86_MUL:
+        BINARY_LOOP_AVX512(_mm512_mul_ps);
+        break;
+    case ELTWISE_X86_DIV:
+        BINARY_LOOP_AVX512(_mm512_div_ps);
+        break;
+    case ELTWISE_X86_MAX:
+        BINARY_LOOP_AVX512(_mm512_max_ps);
+        break;
+    case ELTWISE_X86_MIN:
+        BINARY_LOOP_AVX512(_mm512_min_ps);
+        break;
+    case ELTWISE_X86_SQUARED_DIFF:
+        BINARY_LOOP_AVX512(squared_diff_avx512);
+        break;
+    default:
+        break;
+    }
+#endif
+
+    for (; i < n; i++)
+        c[i] = binary_op(op, a[i * a_step], b[i * b_step]);
+}
@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "elu_param.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "utility/simd_math.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+
+/* the elements are cut in blocks for the threads */
+#define ELU_BLOCK 4096
+
+struct elu_job
+{
+    const float* input;
+    float* output;
+    int size;
+    float alpha;
+};
+
+static void elu_block(void* arg, int begin, int end)
+{
+    struct elu_job* job = (struct elu_job*)arg;
+    const float* input = job->input;
+    float* output = job->output;
+
+    int i = begin * ELU_BLOCK;
+    int size = end * ELU_BLOCK < job->size ? end * ELU_BLOCK : job->size;
+
+#if __AVX__
+    __m256 _alpha = _mm256_set1_ps(job->alpha);
+    __m256 _zero = _mm256_setzero_ps();
+
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _x = _mm256_loadu_ps(input + i);
+        __m256 _neg = _mm256_mul_ps(simd_expm1_f32x8(_x), _alpha);
+
+        _mm256_storeu_ps(output + i, simd_select_f32x8(_mm256_cmp_ps(_x, _zero, _CMP_LT_OQ), _neg, _x));
+    }
+#endif
+    for (; i < size; i++)
+        output[i] = input[i] < 0.f ? simd_expm1_f32(input[i]) * job->alpha : input[i];
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct elu_param* param = (struct elu_param*)ir_node->op.param_mem;
+
+    struct elu_job job;
+
+    job.input = (const float*)input_tensor->data;
+    job.output = (float*)output_tensor->data;
+    job.size = input_tensor->elem_num;
+    job.alpha = param->alpha;
+
+    parallel_for(elu_block, &job, (job.size + ELU_BLOCK - 1) / ELU_BLOCK, exec_graph->num_thread);
+
+    return 0;
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct node* ir_node = exec_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+
+    if (input_tensor->data_type != TENGINE_DT_FP32)
+        return 0;
+
+    return OPS_SCORE_PREFER;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = NULL,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = NULL,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .isa = CPU_ISA_BUILD};
+
+int register_elu_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_ELU, &hcl_node_ops);
+}
+
+int unregister_elu_hcl_x86_op()
+{
+    unregister_builtin_node_ops(OP_ELU, &hcl_node_ops);
+    return 0;
+}
@@ -125,6 +125,19 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
             TLOG_ERR("hcl fc run failed\n");
             return -1;
         }
+
+        /* the fused relu or relu6 */
+        if (fc_param->activation >= 0)
+        {
+            float* output = (float*)output_tensor->data;
+
+            for (int i = 0; i < output_tensor->elem_num; i++)
+            {
+                output[i] = output[i] > 0.f ? output[i] : 0.f;
+                if (fc_param->activation > 0 && output[i] > fc_param->activation)
+                    output[i] = fc_param->activation;
+            }
+        }
     }
     /* fp16 run */
 #if __ARM_FEATURE_FP16_VECTOR_ARITHMETIC
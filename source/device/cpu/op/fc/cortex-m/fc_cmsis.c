@@ -23,6 +23,7 @@
  */
 
 #include "op/pool_param.h"
+#include "fc_param.h"
 
 #include "graph/tensor.h"
 #include "graph/node.h"
@@ -130,6 +131,12 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
+    struct fc_param* param = (struct fc_param*)exec_node->op.param_mem;
+
+    /* the fused activation is not supported */
+    if (param->activation >= 0)
+        return 0;
+
     return OPS_SCORE_BEST;
 }
 
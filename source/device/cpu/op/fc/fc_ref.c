@@ -47,6 +47,7 @@ struct fc_data
     int hidden;     // hidden
     int zero[3];    // input, kernel, output
     float scale[3]; // input, kernel, output
+    int activation; // fused relu or relu6, fp32 only
 };
 
 static int ref_fc_fp32(struct tensor* input_tensor, struct tensor* output_tensor, struct tensor* weight_tensor, struct tensor* bias_tensor, struct fc_data* param)
@@ -75,6 +76,13 @@ static int ref_fc_fp32(struct tensor* input_tensor, struct tensor* output_tensor
                 else
                     tmp += input[n * hidden + j] * weight[i + j * out_number];
             }
+            if (param->activation >= 0)
+            {
+                if (tmp < 0)
+                    tmp = 0;
+                if (param->activation > 0 && tmp > param->activation)
+                    tmp = param->activation;
+            }
             output[n * out_number + i] = tmp;
         }
     }
@@ -347,6 +355,7 @@ static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct
     }
     op_param->batch = input_tensor->dims[0];
     op_param->out_number = param->num_output;
+    op_param->activation = param->activation;
 
     int weight_out = weight_tensor->dims[0];
 
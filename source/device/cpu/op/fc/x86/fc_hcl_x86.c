@@ -31,9 +31,14 @@
 #include "operator/op.h"
 #include "utility/sys_port.h"
 #include "utility/log.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
+#include "device/cpu/cpu_prepack.h"
+#include "device/cpu/op/conv/x86/conv_kernel_x86.h"
+#include "fc_kernel_x86.h"
 
 #include <math.h>
 #include <string.h>
@@ -53,55 +58,239 @@ struct fc_data
     int hidden;     // hidden
     int zero[3];    // input, kernel, output
     float scale[3]; // input, kernel, output
+
+    /* int8 on the sgemm of conv, the weights are packed as B */
+    int sgemm_i8_kernel;
+    int8_t* input_pack;
+    int8_t* weight_pack;
+    int32_t* offset;
+    float* scales;
+
+    /* fp32 with the weights in fp16 or bf16, see fc_kernel_x86.h */
+    int half_kernel;
+    uint16_t* weight_half;
+    void* input_half;
+    int half_cached; /* the weights are in the prepack cache or the share, not freed by the node */
 };
 
-static int innerproduct(int inn, int inc, int inh, int inw, int outc, const float* weight, const float* input, float* output,
-                        const float* _bias, int num_thread, int cpu_affinity)
+struct innerproduct_job
 {
-    size_t elemsize = sizeof(float);
-    int size = inw * inh;
+    const float* weight;
+    const float* input;
+    float* output;
+    const float* bias;
+    int inc;
+    int size;
+    int outc;
+    int n;
+    int activation;
+};
+
+static void innerproduct_outc(void* arg, int begin, int end)
+{
+    struct innerproduct_job* job = (struct innerproduct_job*)arg;
+    const float* weight = job->weight;
+    const float* input = job->input;
+    float* output = job->output;
+    const float* bias = job->bias;
+    int inc = job->inc;
+    int size = job->size;
+    int outc = job->outc;
+    int n = job->n;
+    int activation = job->activation;
     float tmp;
 
-    for (int n = 0; n < inn; n++)
+    for (int p = begin; p < end; p++)
     {
-#pragma omp parallel for num_threads(num_thread)
-        for (int p = 0; p < outc; p++)
-        {
-            int q = 0;
-            float sum = _bias ? _bias[p] : 0.f;
-            const float* weight1 = weight + p * inc * size;
-            const float* input1 = input + n * inc * size;
+        int q = 0;
+        float sum = bias ? bias[p] : 0.f;
+        const float* weight1 = weight + p * inc * size;
+        const float* input1 = input + n * inc * size;
 #if __AVX__ || __SSE__
 #if __SSE__
-            float _sum[4] = {0.f};
-            __m128 _sum0 = _mm_set1_ps(0.f);
-            for (; q + 3 < inc * size; q = q + 4)
-            {
-                __m128 _input = _mm_loadu_ps(input1 + q);
-                __m128 _weight = _mm_loadu_ps(weight1 + q);
-                __m128 _sum1 = _mm_mul_ps(_input, _weight);
-                _sum0 = _mm_add_ps(_sum0, _sum1);
-            }
-            _mm_storeu_ps(_sum, _sum0);
-            tmp = _sum[0] + _sum[1] + _sum[2] + _sum[3];
-            sum = sum + tmp;
+        float _sum[4] = {0.f};
+        __m128 _sum0 = _mm_set1_ps(0.f);
+        for (; q + 3 < inc * size; q = q + 4)
+        {
+            __m128 _input = _mm_loadu_ps(input1 + q);
+            __m128 _weight = _mm_loadu_ps(weight1 + q);
+            __m128 _sum1 = _mm_mul_ps(_input, _weight);
+            _sum0 = _mm_add_ps(_sum0, _sum1);
+        }
+        _mm_storeu_ps(_sum, _sum0);
+        tmp = _sum[0] + _sum[1] + _sum[2] + _sum[3];
+        sum = sum + tmp;
 #else //__AVX__ \
       // TODO
 #endif
 #endif
-            for (; q < inc * size; q++)
-            {
-                tmp = input1[q] * weight1[q];
-                sum = sum + tmp;
-            }
+        for (; q < inc * size; q++)
+        {
+            tmp = input1[q] * weight1[q];
+            sum = sum + tmp;
+        }
 
-            output[n * outc + p] = sum;
+        if (activation >= 0)
+        {
+            sum = sum > 0.f ? sum : 0.f;
+            if (activation > 0)
+                sum = sum < activation ? sum : (float)activation;
         }
+
+        output[n * outc + p] = sum;
+    }
+}
+
+static int innerproduct(int inn, int inc, int inh, int inw, int outc, const float* weight, const float* input, float* output,
+                        const float* _bias, int activation, int num_thread, int cpu_affinity)
+{
+    struct innerproduct_job job;
+
+    job.weight = weight;
+    job.input = input;
+    job.output = output;
+    job.bias = _bias;
+    job.inc = inc;
+    job.size = inw * inh;
+    job.outc = outc;
+    job.activation = activation;
+
+    for (int n = 0; n < inn; n++)
+    {
+        job.n = n;
+        parallel_for(innerproduct_outc, &job, outc, num_thread);
+    }
+
+    return 0;
+}
+
+static int innerproduct_int8_prerun(struct fc_data* op_param, struct tensor* input_tensor, struct tensor* weight_tensor,
+                                    struct tensor* output_tensor, int num_thread)
+{
+    int kernel = sgemm_i8_get_kernel();
+    int batch = op_param->batch;
+    int hidden = op_param->hidden;
+    int out_number = op_param->out_number;
+    int width = sgemm_i8_get_pack_width(kernel);
+
+    /* the weights are [out_number, hidden], or [hidden, out_number] to be transposed */
+    int k_stride = op_param->need_trans ? out_number : 1;
+    int channel_stride = op_param->need_trans ? 1 : hidden;
+
+    op_param->input_pack = (int8_t*)sys_malloc(sgemm_i8_get_pack_a_size(batch, hidden));
+
+    if (op_param->input_pack == NULL)
+        return -1;
+
+    /* kept packed when resized */
+    if (op_param->weight_pack != NULL)
+        return 0;
+
+    op_param->sgemm_i8_kernel = kernel;
+    op_param->weight_pack = (int8_t*)sys_malloc(sgemm_i8_get_pack_b_size(hidden, out_number, width));
+    op_param->scales = (float*)sys_malloc(out_number * sizeof(float));
+
+    if (op_param->weight_pack == NULL || op_param->scales == NULL)
+        return -1;
+
+    sgemm_i8_pack_b(hidden, out_number, (int8_t*)weight_tensor->data, k_stride, channel_stride, op_param->weight_pack, width, 0,
+                    num_thread);
+
+    /* as the int8 fc ref op */
+    for (int i = 0; i < out_number; i++)
+        op_param->scales[i] = (input_tensor->scale * weight_tensor->scale_list[i]) / output_tensor->scale;
+
+    if (sgemm_i8_flip_input(kernel))
+    {
+        op_param->offset = (int32_t*)sys_malloc(out_number * sizeof(int32_t));
+
+        if (op_param->offset == NULL)
+            return -1;
+
+        sgemm_i8_get_offset(out_number, hidden, (int8_t*)weight_tensor->data, channel_stride, k_stride, op_param->offset);
     }
 
     return 0;
 }
 
+static int innerproduct_int8(struct fc_data* op_param, const int8_t* input, int8_t* output, const int32_t* bias, int num_thread)
+{
+    int batch = op_param->batch;
+    int hidden = op_param->hidden;
+    int out_number = op_param->out_number;
+    int kernel = op_param->sgemm_i8_kernel;
+
+    struct sgemm_i8_requant requant;
+
+    requant.bias = bias;
+    requant.offset = op_param->offset;
+    requant.scales = op_param->scales;
+    requant.output_scale = 1.f;
+    requant.act_min = -INFINITY;
+    requant.act_max = INFINITY;
+    requant.channel_col = 1;
+
+    sgemm_i8_pack_a(batch, hidden, input, hidden, 1, op_param->input_pack, sgemm_i8_flip_input(kernel));
+
+    sgemm_i8_quant(kernel, batch, out_number, hidden, op_param->input_pack, op_param->weight_pack, output, out_number,
+                   &requant, num_thread);
+
+    return 0;
+}
+
+static int innerproduct_half_prerun(struct fc_data* op_param, struct tensor* weight_tensor, struct exec_node* exec_node,
+                                    struct exec_graph* exec_graph)
+{
+    int kernel = op_param->half_kernel;
+    int batch = op_param->batch;
+    int hidden = op_param->hidden;
+    int out_number = op_param->out_number;
+    int input_size = fc_half_get_input_size(kernel, batch, hidden);
+
+    if (input_size > 0)
+    {
+        op_param->input_half = sys_malloc(input_size);
+
+        if (op_param->input_half == NULL)
+            return -1;
+    }
+
+    /* kept packed when resized */
+    if (op_param->weight_half != NULL)
+        return 0;
+
+    /* the clones and the prepack cache share the packed weights */
+    int size = 0;
+    int pack_size = fc_half_get_pack_size(kernel, out_number, hidden);
+    void* cached = find_prepack_weight(exec_graph, exec_node, &size);
+
+    if (cached != NULL && size == pack_size)
+    {
+        op_param->weight_half = (uint16_t*)cached;
+        op_param->half_cached = 1;
+        return 0;
+    }
+
+    op_param->weight_half = (uint16_t*)sys_malloc(pack_size);
+
+    if (op_param->weight_half == NULL)
+        return -1;
+
+    /* the weights are [out_number, hidden], or [hidden, out_number] to be transposed. the fp32 ones are kept
+     * next to the half copy: the clones share them and may run in fp32, and a prerun after postrun packs them
+     * again, so the mode saves memory traffic but not memory */
+    int k_stride = op_param->need_trans ? out_number : 1;
+    int channel_stride = op_param->need_trans ? 1 : hidden;
+
+    fc_half_pack(kernel, out_number, hidden, (const float*)weight_tensor->data, channel_stride, k_stride,
+                 op_param->weight_half, exec_graph->num_thread);
+
+    if (save_prepack_weight(exec_graph, exec_node, op_param->weight_half, pack_size) > 0)
+        op_param->half_cached = 1;
+
+    return 0;
+}
+
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     struct fc_data* op_param = (struct fc_data*)sys_malloc(sizeof(struct fc_data));
@@ -161,6 +350,61 @@ static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct
     else
         op_param->need_trans = 1;
 
+    if (input_tensor->data_type == TENGINE_DT_INT8)
+    {
+        if (innerproduct_int8_prerun(op_param, input_tensor, weight_tensor, output_tensor, exec_graph->num_thread) < 0)
+        {
+            TLOG_ERR("hcl fc: pack int8 weights failed\n");
+            return -1;
+        }
+    }
+    else if (input_tensor->data_type == TENGINE_DT_FP32 && weight_tensor->data_type == TENGINE_DT_FP32)
+    {
+        op_param->half_kernel = fc_half_get_kernel(exec_graph->weight_mode);
+
+        if (op_param->half_kernel != FC_HALF_NONE && innerproduct_half_prerun(op_param, weight_tensor, exec_node, exec_graph) < 0)
+        {
+            TLOG_ERR("hcl fc: pack half weights failed\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* the weights are kept packed, only the buffers of the batch are freed */
+static int resize(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct fc_data* op_param = (struct fc_data*)exec_node->ops_priv;
+
+    sys_free(op_param->input_pack);
+    sys_free(op_param->input_half);
+
+    op_param->input_pack = NULL;
+    op_param->input_half = NULL;
+
+    return 0;
+}
+
+static int postrun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct fc_data* op_param = (struct fc_data*)exec_node->ops_priv;
+
+    resize(node_ops, exec_node, exec_graph);
+
+    sys_free(op_param->weight_pack);
+    sys_free(op_param->offset);
+    sys_free(op_param->scales);
+
+    if (!op_param->half_cached)
+        sys_free(op_param->weight_half);
+
+    op_param->weight_pack = NULL;
+    op_param->offset = NULL;
+    op_param->scales = NULL;
+    op_param->weight_half = NULL;
+    op_param->half_cached = 0;
+
     return 0;
 }
 
@@ -198,8 +442,20 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
         bias_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
         bias_data = bias_tensor->data;
     }
+
+    if (input_tensor->data_type == TENGINE_DT_INT8)
+        return innerproduct_int8(op_param, (const int8_t*)input_data, (int8_t*)output_data, (const int32_t*)bias_data, num_thread);
+
+    if (op_param->weight_half != NULL)
+    {
+        fc_half_run(op_param->half_kernel, op_param->batch, op_param->out_number, op_param->hidden, (const float*)input_data,
+                    op_param->weight_half, (const float*)bias_data, (float*)output_data, op_param->out_number,
+                    param->activation, op_param->input_half, num_thread);
+        return 0;
+    }
+
     if (innerproduct(batch_number, inc, inh, inw, outc, (float*)weight_data, (float*)input_data,
-                     (float*)output_data, (float*)bias_data, num_thread, cpu_affinity)
+                     (float*)output_data, (float*)bias_data, param->activation, num_thread, cpu_affinity)
         < 0)
         return -1;
 
@@ -284,6 +540,9 @@ static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struc
     struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
 
     /* todo support uint8 */
+    if (input_tensor->data_type == TENGINE_DT_INT8)
+        return sgemm_i8_get_kernel() != SGEMM_I8_NONE ? OPS_SCORE_BEST : 0;
+
     if (input_tensor->data_type != TENGINE_DT_FP32)
         return 0;
 
@@ -293,10 +552,12 @@ static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struc
 static struct node_ops hcl_node_ops = {.prerun = prerun,
                                        .run = run,
                                        .reshape = reshape,
-                                       .postrun = NULL,
+                                       .postrun = postrun,
                                        .init_node = init_node,
                                        .release_node = release_node,
-                                       .score = score};
+                                       .score = score,
+                                       .resize = resize,
+                                       .isa = CPU_ISA_BUILD};
 
 int register_fc_hcl_x86_op()
 {
@@ -0,0 +1,433 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "fc_kernel_x86.h"
+
+#include "api/c_api.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
+#include "utility/float.h"
+
+#include <string.h>
+
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+/* the base x86 sources are built with avx, fma and f16c, see the cpu CMakeLists.txt */
+#if __AVX__ && __F16C__ && __FMA__
+#define FC_HALF_AVX 1
+#else
+#define FC_HALF_AVX 0
+#endif
+
+/* the channels are packed by 4, the rows of the inputs are taken by 2, or by 4 for the dot kernel */
+#define FC_HALF_CHANNELS 4
+
+static int get_pack_k(int kernel, int K)
+{
+    return kernel == FC_HALF_BF16_DOT ? (K + 31) / 32 * 32 : K;
+}
+
+int fc_half_get_kernel(int weight_mode)
+{
+#if FC_HALF_AVX
+    int isa = get_cpu_isa();
+    int avx = CPU_ISA_AVX | CPU_ISA_FMA | CPU_ISA_F16C;
+    int avx512bf16 = avx | CPU_ISA_AVX512F | CPU_ISA_AVX512BW | CPU_ISA_AVX512VL | CPU_ISA_AVX512BF16;
+
+    if ((isa & avx) != avx)
+        return FC_HALF_NONE;
+
+    if (weight_mode == TENGINE_MODE_FP16)
+        return FC_HALF_FP16;
+
+    if (weight_mode == TENGINE_MODE_BF16)
+        return (isa & avx512bf16) == avx512bf16 && fc_half_has_avx512bf16() ? FC_HALF_BF16_DOT : FC_HALF_BF16;
+#endif
+
+    return FC_HALF_NONE;
+}
+
+int fc_half_get_pack_size(int kernel, int num, int K)
+{
+    int channels = (num + FC_HALF_CHANNELS - 1) / FC_HALF_CHANNELS * FC_HALF_CHANNELS;
+
+    return channels * get_pack_k(kernel, K) * (int)sizeof(uint16_t);
+}
+
+int fc_half_get_input_size(int kernel, int M, int K)
+{
+    return kernel == FC_HALF_BF16_DOT ? M * get_pack_k(kernel, K) * (int)sizeof(uint16_t) : 0;
+}
+
+/* rounded to the nearest even, as vcvtps2ph and vcvtne2ps2bf16 */
+static uint16_t round_bf16(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    /* keep a nan quiet */
+    if ((bits & 0x7fffffff) > 0x7f800000)
+        return (uint16_t)((bits >> 16) | 0x40);
+
+    bits += 0x7fff + ((bits >> 16) & 1);
+
+    return (uint16_t)(bits >> 16);
+}
+
+static uint16_t round_fp16(float value)
+{
+#if FC_HALF_AVX
+    return (uint16_t)_cvtss_sh(value, 0);
+#else
+    return fp32_to_fp16(value).value;
+#endif
+}
+
+static float widen_half(int kernel, uint16_t value)
+{
+    if (kernel == FC_HALF_FP16)
+    {
+#if FC_HALF_AVX
+        return _cvtsh_ss(value);
+#else
+        fp16_t half;
+        half.value = value;
+        return fp16_to_fp32(half);
+#endif
+    }
+
+    uint32_t bits = (uint32_t)value << 16;
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+struct fc_half_pack_job
+{
+    int kernel;
+    int num;
+    int K;
+    int Kp;
+    const float* w;
+    int channel_stride;
+    int k_stride;
+    uint16_t* w_half;
+};
+
+static void pack_channel(void* arg, int begin, int end)
+{
+    struct fc_half_pack_job* job = (struct fc_half_pack_job*)arg;
+
+    for (int i = begin; i < end; i++)
+    {
+        uint16_t* w_half = job->w_half + (size_t)i * job->Kp;
+        int k = 0;
+
+        /* the channels and the k padded are 0 */
+        if (i < job->num)
+        {
+            const float* w = job->w + (size_t)i * job->channel_stride;
+
+            for (; k < job->K; k++)
+            {
+                float value = w[(size_t)k * job->k_stride];
+                w_half[k] = job->kernel == FC_HALF_FP16 ? round_fp16(value) : round_bf16(value);
+            }
+        }
+
+        for (; k < job->Kp; k++)
+            w_half[k] = 0;
+    }
+}
+
+void fc_half_pack(int kernel, int num, int K, const float* w, int channel_stride, int k_stride, uint16_t* w_half,
+                  int num_thread)
+{
+    struct fc_half_pack_job job;
+
+    job.kernel = kernel;
+    job.num = num;
+    job.K = K;
+    job.Kp = get_pack_k(kernel, K);
+    job.w = w;
+    job.channel_stride = channel_stride;
+    job.k_stride = k_stride;
+    job.w_half = w_half;
+
+    int channels = (num + FC_HALF_CHANNELS - 1) / FC_HALF_CHANNELS * FC_HALF_CHANNELS;
+
+    parallel_for(pack_channel, &job, channels, num_thread);
+}
+
+#if FC_HALF_AVX
+static inline __m256 load_half(int kernel, const uint16_t* w)
+{
+    __m128i _w = _mm_loadu_si128((const __m128i*)w);
+
+    if (kernel == FC_HALF_FP16)
+        return _mm256_cvtph_ps(_w);
+
+    /* bf16 is the high half of fp32, the base build has no avx2 for a 256 bit shift */
+    __m128i _zero = _mm_setzero_si128();
+    __m128 _lo = _mm_castsi128_ps(_mm_unpacklo_epi16(_zero, _w));
+    __m128 _hi = _mm_castsi128_ps(_mm_unpackhi_epi16(_zero, _w));
+
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+/* the sums of the 8 lanes of the 4 channels */
+static inline __m128 reduce_sum4(__m256 _sum0, __m256 _sum1, __m256 _sum2, __m256 _sum3)
+{
+    __m256 _sum01 = _mm256_hadd_ps(_sum0, _sum1);
+    __m256 _sum23 = _mm256_hadd_ps(_sum2, _sum3);
+    __m256 _sum = _mm256_hadd_ps(_sum01, _sum23);
+
+    return _mm_add_ps(_mm256_castps256_ps128(_sum), _mm256_extractf128_ps(_sum, 1));
+}
+
+/* sum[2][4] of 2 rows of the inputs and 4 channels, the weights are read once for both rows */
+static void dot_half_2x4(int kernel, int K, const float* input, const uint16_t* w, float* sum)
+{
+    const float* input0 = input;
+    const float* input1 = input + K;
+    const uint16_t* w0 = w;
+    const uint16_t* w1 = w + K;
+    const uint16_t* w2 = w + K * 2;
+    const uint16_t* w3 = w + K * 3;
+
+    __m256 _sum00 = _mm256_setzero_ps();
+    __m256 _sum01 = _mm256_setzero_ps();
+    __m256 _sum02 = _mm256_setzero_ps();
+    __m256 _sum03 = _mm256_setzero_ps();
+    __m256 _sum10 = _mm256_setzero_ps();
+    __m256 _sum11 = _mm256_setzero_ps();
+    __m256 _sum12 = _mm256_setzero_ps();
+    __m256 _sum13 = _mm256_setzero_ps();
+
+    int k = 0;
+
+    for (; k + 7 < K; k += 8)
+    {
+        __m256 _in0 = _mm256_loadu_ps(input0 + k);
+        __m256 _in1 = _mm256_loadu_ps(input1 + k);
+        __m256 _w;
+
+        _w = load_half(kernel, w0 + k);
+        _sum00 = _mm256_fmadd_ps(_in0, _w, _sum00);
+        _sum10 = _mm256_fmadd_ps(_in1, _w, _sum10);
+        _w = load_half(kernel, w1 + k);
+        _sum01 = _mm256_fmadd_ps(_in0, _w, _sum01);
+        _sum11 = _mm256_fmadd_ps(_in1, _w, _sum11);
+        _w = load_half(kernel, w2 + k);
+        _sum02 = _mm256_fmadd_ps(_in0, _w, _sum02);
+        _sum12 = _mm256_fmadd_ps(_in1, _w, _sum12);
+        _w = load_half(kernel, w3 + k);
+        _sum03 = _mm256_fmadd_ps(_in0, _w, _sum03);
+        _sum13 = _mm256_fmadd_ps(_in1, _w, _sum13);
+    }
+
+    _mm_storeu_ps(sum, reduce_sum4(_sum00, _sum01, _sum02, _sum03));
+    _mm_storeu_ps(sum + 4, reduce_sum4(_sum10, _sum11, _sum12, _sum13));
+
+    for (; k < K; k++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            float value = widen_half(kernel, w[(size_t)c * K + k]);
+
+            sum[c] += input0[k] * value;
+            sum[4 + c] += input1[k] * value;
+        }
+    }
+}
+
+/* sum[4] of a row of the inputs and 4 channels, the k are added in two sums to hide the latency */
+static void dot_half_1x4(int kernel, int K, const float* input, const uint16_t* w, float* sum)
+{
+    const uint16_t* w0 = w;
+    const uint16_t* w1 = w + K;
+    const uint16_t* w2 = w + K * 2;
+    const uint16_t* w3 = w + K * 3;
+
+    __m256 _sum0 = _mm256_setzero_ps();
+    __m256 _sum1 = _mm256_setzero_ps();
+    __m256 _sum2 = _mm256_setzero_ps();
+    __m256 _sum3 = _mm256_setzero_ps();
+    __m256 _sum4 = _mm256_setzero_ps();
+    __m256 _sum5 = _mm256_setzero_ps();
+    __m256 _sum6 = _mm256_setzero_ps();
+    __m256 _sum7 = _mm256_setzero_ps();
+
+    int k = 0;
+
+    for (; k + 15 < K; k += 16)
+    {
+        __m256 _in0 = _mm256_loadu_ps(input + k);
+        __m256 _in1 = _mm256_loadu_ps(input + k + 8);
+
+        _sum0 = _mm256_fmadd_ps(_in0, load_half(kernel, w0 + k), _sum0);
+        _sum1 = _mm256_fmadd_ps(_in0, load_half(kernel, w1 + k), _sum1);
+        _sum2 = _mm256_fmadd_ps(_in0, load_half(kernel, w2 + k), _sum2);
+        _sum3 = _mm256_fmadd_ps(_in0, load_half(kernel, w3 + k), _sum3);
+        _sum4 = _mm256_fmadd_ps(_in1, load_half(kernel, w0 + k + 8), _sum4);
+        _sum5 = _mm256_fmadd_ps(_in1, load_half(kernel, w1 + k + 8), _sum5);
+        _sum6 = _mm256_fmadd_ps(_in1, load_half(kernel, w2 + k + 8), _sum6);
+        _sum7 = _mm256_fmadd_ps(_in1, load_half(kernel, w3 + k + 8), _sum7);
+    }
+    for (; k + 7 < K; k += 8)
+    {
+        __m256 _in0 = _mm256_loadu_ps(input + k);
+
+        _sum0 = _mm256_fmadd_ps(_in0, load_half(kernel, w0 + k), _sum0);
+        _sum1 = _mm256_fmadd_ps(_in0, load_half(kernel, w1 + k), _sum1);
+        _sum2 = _mm256_fmadd_ps(_in0, load_half(kernel, w2 + k), _sum2);
+        _sum3 = _mm256_fmadd_ps(_in0, load_half(kernel, w3 + k), _sum3);
+    }
+
+    _sum0 = _mm256_add_ps(_sum0, _sum4);
+    _sum1 = _mm256_add_ps(_sum1, _sum5);
+    _sum2 = _mm256_add_ps(_sum2, _sum6);
+    _sum3 = _mm256_add_ps(_sum3, _sum7);
+
+    _mm_storeu_ps(sum, reduce_sum4(_sum0, _sum1, _sum2, _sum3));
+
+    for (; k < K; k++)
+    {
+        for (int c = 0; c < 4; c++)
+            sum[c] += input[k] * widen_half(kernel, w[(size_t)c * K + k]);
+    }
+}
+#else
+static void dot_half_1x4(int kernel, int K, const float* input, const uint16_t* w, float* sum)
+{
+    for (int c = 0; c < 4; c++)
+    {
+        sum[c] = 0.f;
+
+        for (int k = 0; k < K; k++)
+            sum[c] += input[k] * widen_half(kernel, w[(size_t)c * K + k]);
+    }
+}
+
+static void dot_half_2x4(int kernel, int K, const float* input, const uint16_t* w, float* sum)
+{
+    dot_half_1x4(kernel, K, input, w, sum);
+    dot_half_1x4(kernel, K, input + K, w, sum + 4);
+}
+#endif
+
+struct fc_half_job
+{
+    int kernel;
+    int M;
+    int num;
+    int K;
+    const float* input;
+    const uint16_t* input_bf16;
+    const uint16_t* w_half;
+    const float* bias;
+    float* output;
+    int ldo;
+    int activation;
+};
+
+static void fc_half_block(void* arg, int begin, int end)
+{
+    struct fc_half_job* job = (struct fc_half_job*)arg;
+    int kernel = job->kernel;
+    int M = job->M;
+    int K = job->K;
+    int Kp = get_pack_k(kernel, K);
+    int max_rows = kernel == FC_HALF_BF16_DOT ? 4 : 2;
+    float sum[4 * FC_HALF_CHANNELS];
+
+    for (int b = begin; b < end; b++)
+    {
+        int channel = b * FC_HALF_CHANNELS;
+        int channels = job->num - channel < FC_HALF_CHANNELS ? job->num - channel : FC_HALF_CHANNELS;
+        const uint16_t* w = job->w_half + (size_t)channel * Kp;
+
+        for (int row = 0; row < M;)
+        {
+            int rows = M - row < max_rows ? M - row : max_rows;
+
+            if (kernel == FC_HALF_BF16_DOT)
+                fc_half_dot_avx512bf16(rows, Kp, job->input_bf16 + (size_t)row * Kp, w, sum);
+            else if (rows == 2)
+                dot_half_2x4(kernel, K, job->input + (size_t)row * K, w, sum);
+            else
+                dot_half_1x4(kernel, K, job->input + (size_t)row * K, w, sum);
+
+            for (int r = 0; r < rows; r++)
+            {
+                float* output = job->output + (size_t)(row + r) * job->ldo + channel;
+
+                for (int c = 0; c < channels; c++)
+                {
+                    float value = sum[r * FC_HALF_CHANNELS + c];
+
+                    if (job->bias)
+                        value += job->bias[channel + c];
+
+                    if (job->activation >= 0)
+                    {
+                        value = value > 0.f ? value : 0.f;
+                        if (job->activation > 0)
+                            value = value < job->activation ? value : (float)job->activation;
+                    }
+
+                    output[c] = value;
+                }
+            }
+
+            row += rows;
+        }
+    }
+}
+
+void fc_half_run(int kernel, int M, int num, int K, const float* input, const uint16_t* w_half, const float* bias,
+                 float* output, int ldo, int activation, void* input_mem, int num_thread)
+{
+    struct fc_half_job job;
+
+    job.kernel = kernel;
+    job.M = M;
+    job.num = num;
+    job.K = K;
+    job.input = input;
+    job.input_bf16 = (const uint16_t*)input_mem;
+    job.w_half = w_half;
+    job.bias = bias;
+    job.output = output;
+    job.ldo = ldo;
+    job.activation = activation;
+
+    if (kernel == FC_HALF_BF16_DOT)
+        fc_half_round_bf16_avx512bf16(M, K, get_pack_k(kernel, K), input, (uint16_t*)input_mem);
+
+    /* the weights are read once by the blocks of the channels, the threads split them */
+    parallel_for(fc_half_block, &job, (num + FC_HALF_CHANNELS - 1) / FC_HALF_CHANNELS, num_thread);
+}
@@ -0,0 +1,65 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef _FC_KERNEL_X86_H_
+#define _FC_KERNEL_X86_H_
+
+#include <stdint.h>
+
+/*
+ * the fc kernels keeping the weights in 16 bits, output[M, num] = input[M, K] * w[num, K]^T,
+ * also used by matmul. the weights are half the memory of fp32 and are widened to fp32 as
+ * they are loaded, the sums are in fp32. the activations stay fp32, but the bf16 dot kernel
+ * rounds the inputs to bf16 before each run.
+ */
+#define FC_HALF_NONE     0 /* the weights stay fp32 */
+#define FC_HALF_FP16     1 /* fp16 weights widened by f16c */
+#define FC_HALF_BF16     2 /* bf16 weights widened by a shift */
+#define FC_HALF_BF16_DOT 3 /* bf16 weights and inputs, vdpbf16ps of avx512-bf16 */
+
+/* the kernel for the weight mode of the graph and the isa of the cpu */
+int fc_half_get_kernel(int weight_mode);
+
+/* the size of the packed weights, the channels are padded to 4 and the k to 32 for the dot kernel */
+int fc_half_get_pack_size(int kernel, int num, int K);
+
+/* pack the weights w[num, K], the value of w[i, k] is at w[i * channel_stride + k * k_stride] */
+void fc_half_pack(int kernel, int num, int K, const float* w, int channel_stride, int k_stride, uint16_t* w_half,
+                  int num_thread);
+
+/* the size of the inputs rounded to bf16 for the dot kernel, 0 for the others */
+int fc_half_get_input_size(int kernel, int M, int K);
+
+/*
+ * the rows of output are ldo apart, bias is NULL for none. the activation is as the fc param,
+ * -1 for none, 0 for relu and the upper bound of the clip for the others.
+ */
+void fc_half_run(int kernel, int M, int num, int K, const float* input, const uint16_t* w_half, const float* bias,
+                 float* output, int ldo, int activation, void* input_mem, int num_thread);
+
+/* only for the cpu with avx512-bf16, and the file built with it */
+int fc_half_has_avx512bf16(void);
+void fc_half_round_bf16_avx512bf16(int M, int K, int Kp, const float* input, uint16_t* input_bf16);
+void fc_half_dot_avx512bf16(int rows, int Kp, const uint16_t* input, const uint16_t* w, float* sum);
+
+#endif
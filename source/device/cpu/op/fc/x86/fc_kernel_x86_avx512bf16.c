@@ -0,0 +1,207 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "fc_kernel_x86.h"
+
+#include <string.h>
+
+#if __AVX512BF16__
+#include <immintrin.h>
+#endif
+
+/*
+ * built with avx512 and avx512-bf16 whatever the isa of the other x86 sources, see the cpu
+ * CMakeLists.txt, so it is called only on a cpu with them. vdpbf16ps adds the products of
+ * the pairs of bf16 to the fp32 sums, 32 k in a vector, the k are padded to 32 with 0.
+ */
+int fc_half_has_avx512bf16(void)
+{
+#if __AVX512BF16__
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+#if __AVX512BF16__
+static inline __mmask16 get_mask(int n)
+{
+    if (n >= 16)
+        return 0xffff;
+
+    return n > 0 ? (__mmask16)((1u << n) - 1) : 0;
+}
+
+static inline __m512bh load_bf16(const uint16_t* p)
+{
+    return (__m512bh)_mm512_loadu_si512((const void*)p);
+}
+
+static void dot_4x4(int Kp, const uint16_t* input, const uint16_t* w, float* sum)
+{
+    __m512 _sum[4][4];
+
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+            _sum[r][c] = _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < Kp; k += 32)
+    {
+        __m512bh _w0 = load_bf16(w + k);
+        __m512bh _w1 = load_bf16(w + Kp + k);
+        __m512bh _w2 = load_bf16(w + Kp * 2 + k);
+        __m512bh _w3 = load_bf16(w + Kp * 3 + k);
+
+        for (int r = 0; r < 4; r++)
+        {
+            __m512bh _in = load_bf16(input + r * Kp + k);
+
+            _sum[r][0] = _mm512_dpbf16_ps(_sum[r][0], _in, _w0);
+            _sum[r][1] = _mm512_dpbf16_ps(_sum[r][1], _in, _w1);
+            _sum[r][2] = _mm512_dpbf16_ps(_sum[r][2], _in, _w2);
+            _sum[r][3] = _mm512_dpbf16_ps(_sum[r][3], _in, _w3);
+        }
+    }
+
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+            sum[r * 4 + c] = _mm512_reduce_add_ps(_sum[r][c]);
+    }
+}
+
+/* the k are added in two sums to hide the latency */
+static void dot_1x4(int Kp, const uint16_t* input, const uint16_t* w, float* sum)
+{
+    __m512 _sum0 = _mm512_setzero_ps();
+    __m512 _sum1 = _mm512_setzero_ps();
+    __m512 _sum2 = _mm512_setzero_ps();
+    __m512 _sum3 = _mm512_setzero_ps();
+    __m512 _sum4 = _mm512_setzero_ps();
+    __m512 _sum5 = _mm512_setzero_ps();
+    __m512 _sum6 = _mm512_setzero_ps();
+    __m512 _sum7 = _mm512_setzero_ps();
+
+    int k = 0;
+
+    for (; k + 63 < Kp; k += 64)
+    {
+        __m512bh _in0 = load_bf16(input + k);
+        __m512bh _in1 = load_bf16(input + k + 32);
+
+        _sum0 = _mm512_dpbf16_ps(_sum0, _in0, load_bf16(w + k));
+        _sum1 = _mm512_dpbf16_ps(_sum1, _in0, load_bf16(w + Kp + k));
+        _sum2 = _mm512_dpbf16_ps(_sum2, _in0, load_bf16(w + Kp * 2 + k));
+        _sum3 = _mm512_dpbf16_ps(_sum3, _in0, load_bf16(w + Kp * 3 + k));
+        _sum4 = _mm512_dpbf16_ps(_sum4, _in1, load_bf16(w + k + 32));
+        _sum5 = _mm512_dpbf16_ps(_sum5, _in1, load_bf16(w + Kp + k + 32));
+        _sum6 = _mm512_dpbf16_ps(_sum6, _in1, load_bf16(w + Kp * 2 + k + 32));
+        _sum7 = _mm512_dpbf16_ps(_sum7, _in1, load_bf16(w + Kp * 3 + k + 32));
+    }
+    if (k < Kp)
+    {
+        __m512bh _in0 = load_bf16(input + k);
+
+        _sum0 = _mm512_dpbf16_ps(_sum0, _in0, load_bf16(w + k));
+        _sum1 = _mm512_dpbf16_ps(_sum1, _in0, load_bf16(w + Kp + k));
+        _sum2 = _mm512_dpbf16_ps(_sum2, _in0, load_bf16(w + Kp * 2 + k));
+        _sum3 = _mm512_dpbf16_ps(_sum3, _in0, load_bf16(w + Kp * 3 + k));
+    }
+
+    sum[0] = _mm512_reduce_add_ps(_mm512_add_ps(_sum0, _sum4));
+    sum[1] = _mm512_reduce_add_ps(_mm512_add_ps(_sum1, _sum5));
+    sum[2] = _mm512_reduce_add_ps(_mm512_add_ps(_sum2, _sum6));
+    sum[3] = _mm512_reduce_add_ps(_mm512_add_ps(_sum3, _sum7));
+}
+#else
+static float widen_bf16(uint16_t value)
+{
+    uint32_t bits = (uint32_t)value << 16;
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+static void dot_1x4(int Kp, const uint16_t* input, const uint16_t* w, float* sum)
+{
+    for (int c = 0; c < 4; c++)
+    {
+        sum[c] = 0.f;
+
+        for (int k = 0; k < Kp; k++)
+            sum[c] += widen_bf16(input[k]) * widen_bf16(w[c * Kp + k]);
+    }
+}
+#endif
+
+void fc_half_round_bf16_avx512bf16(int M, int K, int Kp, const float* input, uint16_t* input_bf16)
+{
+    for (int m = 0; m < M; m++)
+    {
+        const float* in = input + (size_t)m * K;
+        uint16_t* out = input_bf16 + (size_t)m * Kp;
+
+#if __AVX512BF16__
+        for (int k = 0; k < Kp; k += 32)
+        {
+            __m512 _lo = _mm512_maskz_loadu_ps(get_mask(K - k), in + k);
+            __m512 _hi = _mm512_maskz_loadu_ps(get_mask(K - k - 16), in + k + 16);
+
+            _mm512_storeu_si512((void*)(out + k), (__m512i)_mm512_cvtne2ps_pbh(_hi, _lo));
+        }
+#else
+        for (int k = 0; k < Kp; k++)
+        {
+            uint32_t bits = 0;
+
+            if (k < K)
+                memcpy(&bits, in + k, sizeof(bits));
+
+            /* rounded to the nearest even, a nan stays quiet */
+            if ((bits & 0x7fffffff) > 0x7f800000)
+                bits |= 0x400000;
+            else
+                bits += 0x7fff + ((bits >> 16) & 1);
+
+            out[k] = (uint16_t)(bits >> 16);
+        }
+#endif
+    }
+}
+
+void fc_half_dot_avx512bf16(int rows, int Kp, const uint16_t* input, const uint16_t* w, float* sum)
+{
+#if __AVX512BF16__
+    if (rows == 4)
+    {
+        dot_4x4(Kp, input, w, sum);
+        return;
+    }
+#endif
+
+    for (int r = 0; r < rows; r++)
+        dot_1x4(Kp, input + (size_t)r * Kp, w, sum + r * 4);
+}
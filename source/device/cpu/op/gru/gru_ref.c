@@ -137,7 +137,7 @@ int ref_gru_default_fp32(struct tensor* input_tensor, struct tensor* w, struct t
                     float Z = 1.f / (1.f + exp(-Z_data[h]));
                     float H = tanh(H_data[h]);
                     float out = (1 - Z) * H + Z * h_0[h];
-                    output_data[t * hidden_size + h] = out;
+                    output_data[seq * hidden_size * batch_size + t * hidden_size + h] = out;
                     output_h_data[t * hidden_size + h] = out;
                 }
                 else
@@ -145,7 +145,7 @@ int ref_gru_default_fp32(struct tensor* input_tensor, struct tensor* w, struct t
                     float Z = 1.f / (1.f + exp(-Z_data[h]));
                     float H = tanh(H_data[h]);
                     float out = (1 - Z) * H + Z * output_h_data[t * hidden_size + h];
-                    output_data[t * hidden_size + h] = out;
+                    output_data[seq * hidden_size * batch_size + t * hidden_size + h] = out;
                     output_h_data[t * hidden_size + h] = out;
                 }
             }
@@ -255,7 +255,7 @@ int ref_gru_with_bias_fp32(struct tensor* input_tensor, struct tensor* w, struct
                     float Z = 1.f / (1.f + exp(-Z_data[h]));
                     float H = tanh(H_data[h]);
                     float out = (1 - Z) * H + Z * h_0[h];
-                    output_data[t * hidden_size + h] = out;
+                    output_data[seq * hidden_size * batch_size + t * hidden_size + h] = out;
                     output_h_data[t * hidden_size + h] = out;
                 }
                 else
@@ -263,7 +263,7 @@ int ref_gru_with_bias_fp32(struct tensor* input_tensor, struct tensor* w, struct
                     float Z = 1.f / (1.f + exp(-Z_data[h]));
                     float H = tanh(H_data[h]);
                     float out = (1 - Z) * H + Z * output_h_data[t * hidden_size + h];
-                    output_data[t * hidden_size + h] = out;
+                    output_data[seq * hidden_size * batch_size + t * hidden_size + h] = out;
                     output_h_data[t * hidden_size + h] = out;
                 }
             }
@@ -280,7 +280,7 @@ int ref_gru_with_bias_fp32(struct tensor* input_tensor, struct tensor* w, struct
     return 0;
 }
 
-int ref_gru_case1_fp32(struct tensor* input_tensor, struct tensor* w, struct tensor* r, struct tensor* b, struct tensor* output_tensor, struct gru_param* param)
+int ref_gru_case1_fp32(struct tensor* input_tensor, struct tensor* w, struct tensor* r, struct tensor* b, struct tensor* init_h, struct tensor* output_tensor, struct gru_param* param)
 {
     int batch_size = input_tensor->dims[1];
     int hidden_size = param->hidden_size;
@@ -295,7 +295,12 @@ int ref_gru_case1_fp32(struct tensor* input_tensor, struct tensor* w, struct ten
     float* h_0 = (float*)malloc((unsigned long)hidden_size * batch_size * sizeof(float));
     memset(initial_h_data, 0, (unsigned long)hidden_size * batch_size * sizeof(float));
     memset(output_h_data, 0, (unsigned long)hidden_size * batch_size * sizeof(float));
-    memset(h_0, 0, (unsigned long)hidden_size * batch_size * sizeof(float));
+
+    /* the initial h of [1, batch, hidden], or 0 */
+    if (init_h != NULL && init_h->data_type == TENGINE_DT_FP32 && init_h->elem_num == hidden_size * batch_size)
+        memcpy(initial_h_data, init_h->data, (unsigned long)hidden_size * batch_size * sizeof(float));
+
+    memcpy(h_0, initial_h_data, (unsigned long)hidden_size * batch_size * sizeof(float));
 
     float* Z_data = (float*)malloc(hidden_size * sizeof(float));
     float* R_data = (float*)malloc(hidden_size * sizeof(float));
@@ -361,7 +366,7 @@ int ref_gru_case1_fp32(struct tensor* input_tensor, struct tensor* w, struct ten
                 {
                     float Z = 1.f / (1.f + exp(-Z_data[h]));
                     float H = tanh(H_data[h]);
-                    float out = (1 - Z) * H + Z * h_0[h];
+                    float out = (1 - Z) * H + Z * h_0[t * hidden_size + h];
                     output_data[seq * hidden_size * batch_size + t * hidden_size + h] = out;
                     output_h_data[t * hidden_size + h] = out;
                 }
@@ -405,7 +410,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct gru_param* param = (struct gru_param*)(ir_node->op.param_mem);
 
     /* only support one way */
-    if (w->dim_num == 4 && w->dims[0] == 2)
+    if (w->dim_num >= 3 && w->dims[0] == 2)
     {
         printf("GRU only support one way.\n");
         return -1;
@@ -418,7 +423,10 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     }
     else if (ir_node->input_num == 5)
     {
-        ret = ref_gru_case1_fp32(input_tensor, w, r, b, output_tensor, param);
+        /* as exported by pytorch, with the initial h and no sequence_lens */
+        struct tensor* init_h = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[4]);
+
+        ret = ref_gru_case1_fp32(input_tensor, w, r, b, init_h, output_tensor, param);
     }
     else
     {
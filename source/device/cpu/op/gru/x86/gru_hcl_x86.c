@@ -0,0 +1,409 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "gru_param.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+#include "device/cpu/op/lstm/x86/lstm_kernel_x86.h"
+
+#include <string.h>
+
+/*
+ * the gru of onnx with linear_before_reset as exported by pytorch, one way or bidirectional,
+ * x[seq, batch, input_size] and the gates in the order of z, r, h, from the initial h of the 5 inputs
+ * exported by pytorch or from 0. the input projection of all the steps is one sgemm, and only R * h
+ * is left in the steps. the directions run one after the other, the reverse one from the last step.
+ * the scratch is in the shared memory of the graph: the projection [3 * hidden, seq * batch], then
+ * h of two steps of [batch, hidden].
+ */
+struct gru_priv_info
+{
+    int seq_len;
+    int batch;
+    int input_size;
+    int hidden;
+    int dir_num;
+
+    /* of each direction one after another */
+    float* w_pack;
+    float* r_pack;
+    float* bias; /* Wb + Rb of z and r, Wb of h, then Rb of h, NULL without B */
+};
+
+struct gru_step_job
+{
+    const struct gru_priv_info* priv_info;
+    const float* r_pack;
+    const float* bias;
+    const float* proj;
+    const float* h_prev;
+    float* h_next;
+    float* output;
+    int step;
+    int dir;
+};
+
+static int get_shared_mem_size(const struct gru_priv_info* priv_info)
+{
+    int step_num = priv_info->seq_len * priv_info->batch;
+    int proj_size = 3 * priv_info->hidden * step_num * (int)sizeof(float);
+    int state_size = 2 * priv_info->batch * priv_info->hidden * (int)sizeof(float);
+    int proj_mem_size = rnn_get_input_proj_mem_size(priv_info->input_size, step_num);
+
+    /* the scratch of the projection is free before the states are used */
+    return proj_size + (state_size > proj_mem_size ? state_size : proj_mem_size);
+}
+
+static void set_gru_shape(struct gru_priv_info* priv_info, struct tensor* input_tensor, struct gru_param* param)
+{
+    priv_info->seq_len = input_tensor->dims[0];
+    priv_info->batch = input_tensor->dims[1];
+    priv_info->input_size = input_tensor->dims[2];
+    priv_info->hidden = param->hidden_size;
+}
+
+/* the initial h of [dir_num, batch, hidden] of the direction, or 0 */
+static void set_init_state(struct node* ir_node, int dir, float* state, int size)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* w_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+
+    if (ir_node->input_num == 5)
+    {
+        struct tensor* state_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[4]);
+
+        if (state_tensor->data_type == TENGINE_DT_FP32 && state_tensor->elem_num == w_tensor->dims[0] * size)
+        {
+            memcpy(state, (float*)state_tensor->data + (size_t)dir * size, size * sizeof(float));
+            return;
+        }
+    }
+
+    memset(state, 0, size * sizeof(float));
+}
+
+static void gru_step(void* arg, int begin, int end)
+{
+    struct gru_step_job* job = (struct gru_step_job*)arg;
+    const struct gru_priv_info* priv_info = job->priv_info;
+    const float* bias = job->bias;
+    int hidden = priv_info->hidden;
+    int batch = priv_info->batch;
+    int step_num = priv_info->seq_len * batch;
+    float sum[3 * RNN_UNIT_BLOCK];
+    float gate[2 * RNN_UNIT_BLOCK];
+    float cand[RNN_UNIT_BLOCK];
+
+    for (int ub = begin; ub < end; ub++)
+    {
+        const float* r_pack = job->r_pack + (size_t)ub * hidden * 3 * RNN_UNIT_BLOCK;
+        int q0 = ub * RNN_UNIT_BLOCK;
+        int unit_num = hidden - q0 < RNN_UNIT_BLOCK ? hidden - q0 : RNN_UNIT_BLOCK;
+
+        for (int b = 0; b < batch; b++)
+        {
+            const float* proj = job->proj + job->step * batch + b;
+            const float* h_prev = job->h_prev + b * hidden + q0;
+
+            rnn_recurrent_gemv(3, hidden, r_pack, job->h_prev + b * hidden, sum);
+
+            /* z and r, the units over hidden are left 0 */
+            for (int g = 0; g < 2; g++)
+            {
+                for (int j = 0; j < RNN_UNIT_BLOCK; j++)
+                {
+                    int q = q0 + j;
+                    float x = 0.f;
+
+                    if (j < unit_num)
+                    {
+                        x = proj[(size_t)(g * hidden + q) * step_num] + sum[g * RNN_UNIT_BLOCK + j];
+                        if (bias)
+                            x += bias[g * hidden + q];
+                    }
+
+                    gate[g * RNN_UNIT_BLOCK + j] = x;
+                }
+            }
+
+            rnn_sigmoid(gate, 2 * RNN_UNIT_BLOCK);
+
+            const float* Z = gate;
+            const float* R = gate + RNN_UNIT_BLOCK;
+
+            for (int j = 0; j < unit_num; j++)
+            {
+                int q = q0 + j;
+                float w_h = proj[(size_t)(2 * hidden + q) * step_num];
+                float r_h = sum[2 * RNN_UNIT_BLOCK + j];
+
+                if (bias)
+                {
+                    w_h += bias[2 * hidden + q];
+                    r_h += bias[3 * hidden + q];
+                }
+
+                cand[j] = w_h + R[j] * r_h;
+            }
+
+            rnn_tanh(cand, unit_num);
+
+            for (int j = 0; j < unit_num; j++)
+            {
+                float out = (1 - Z[j]) * cand[j] + Z[j] * h_prev[j];
+
+                job->h_next[b * hidden + q0 + j] = out;
+                job->output[((size_t)(job->step * priv_info->dir_num + job->dir) * batch + b) * hidden + q0 + j] = out;
+            }
+        }
+    }
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct gru_param* param = (struct gru_param*)ir_node->op.param_mem;
+
+    struct gru_priv_info* priv_info = (struct gru_priv_info*)sys_malloc(sizeof(struct gru_priv_info));
+
+    if (priv_info == NULL)
+        return -1;
+
+    memset(priv_info, 0, sizeof(struct gru_priv_info));
+    exec_node->ops_priv = priv_info;
+
+    set_gru_shape(priv_info, input_tensor, param);
+    exec_node->shared_mem_size = get_shared_mem_size(priv_info);
+
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    sys_free(exec_node->ops_priv);
+    exec_node->ops_priv = NULL;
+
+    return 0;
+}
+
+static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* w_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct tensor* r_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
+    struct gru_priv_info* priv_info = (struct gru_priv_info*)exec_node->ops_priv;
+
+    /* kept packed when resized */
+    if (priv_info->w_pack != NULL)
+        return 0;
+
+    int hidden = priv_info->hidden;
+    int input_size = priv_info->input_size;
+    int dir_num = w_tensor->dims[0];
+    int w_pack_size = rnn_get_input_pack_size(3, hidden, input_size);
+    int r_pack_size = rnn_get_recurrent_pack_size(3, hidden);
+
+    priv_info->dir_num = dir_num;
+    priv_info->w_pack = (float*)sys_malloc((size_t)w_pack_size * dir_num);
+    priv_info->r_pack = (float*)sys_malloc((size_t)r_pack_size * dir_num * sizeof(float));
+
+    if (priv_info->w_pack == NULL || priv_info->r_pack == NULL)
+        return -1;
+
+    for (int d = 0; d < dir_num; d++)
+    {
+        float* w_data = (float*)w_tensor->data + (size_t)d * 3 * hidden * input_size;
+        const float* r_data = (const float*)r_tensor->data + (size_t)d * 3 * hidden * hidden;
+
+        rnn_pack_input_weight(3, hidden, input_size, w_data, (float*)((char*)priv_info->w_pack + (size_t)d * w_pack_size));
+        rnn_pack_recurrent_weight(3, hidden, r_data, priv_info->r_pack + (size_t)d * r_pack_size);
+    }
+
+    if (ir_node->input_num > 3)
+    {
+        struct tensor* b_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]);
+
+        priv_info->bias = (float*)sys_malloc((size_t)dir_num * 4 * hidden * sizeof(float));
+
+        if (priv_info->bias == NULL)
+            return -1;
+
+        for (int d = 0; d < dir_num; d++)
+        {
+            const float* b_data = (const float*)b_tensor->data + (size_t)d * 6 * hidden;
+            float* bias = priv_info->bias + (size_t)d * 4 * hidden;
+
+            for (int i = 0; i < 2 * hidden; i++)
+                bias[i] = b_data[i] + b_data[3 * hidden + i];
+            for (int i = 2 * hidden; i < 3 * hidden; i++)
+            {
+                bias[i] = b_data[i];
+                bias[hidden + i] = b_data[3 * hidden + i];
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct gru_priv_info* priv_info = (struct gru_priv_info*)exec_node->ops_priv;
+    int num_thread = exec_graph->num_thread;
+
+    int hidden = priv_info->hidden;
+    int batch = priv_info->batch;
+    int seq_len = priv_info->seq_len;
+    int step_num = seq_len * batch;
+    int w_pack_size = rnn_get_input_pack_size(3, hidden, priv_info->input_size);
+
+    float* proj = (float*)exec_graph->shared_mem;
+    float* state = proj + (size_t)3 * hidden * step_num;
+
+    struct gru_step_job job;
+
+    job.priv_info = priv_info;
+    job.proj = proj;
+    job.output = (float*)output_tensor->data;
+
+    for (int d = 0; d < priv_info->dir_num; d++)
+    {
+        float* w_pack = (float*)((char*)priv_info->w_pack + (size_t)d * w_pack_size);
+
+        rnn_input_proj(3, hidden, priv_info->input_size, step_num, w_pack, (const float*)input_tensor->data, state,
+                       proj, num_thread);
+
+        float* h_prev = state;
+        float* h_next = h_prev + batch * hidden;
+
+        set_init_state(ir_node, d, h_prev, batch * hidden);
+
+        job.r_pack = priv_info->r_pack + (size_t)d * rnn_get_recurrent_pack_size(3, hidden);
+        job.bias = priv_info->bias ? priv_info->bias + (size_t)d * 4 * hidden : NULL;
+        job.dir = d;
+
+        for (int s = 0; s < seq_len; s++)
+        {
+            job.h_prev = h_prev;
+            job.h_next = h_next;
+            job.step = d == 0 ? s : seq_len - 1 - s;
+
+            parallel_for(gru_step, &job, rnn_get_unit_block_num(hidden), num_thread);
+
+            float* tmp = h_prev;
+            h_prev = h_next;
+            h_next = tmp;
+        }
+    }
+
+    return 0;
+}
+
+static int resize(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct gru_param* param = (struct gru_param*)ir_node->op.param_mem;
+    struct gru_priv_info* priv_info = (struct gru_priv_info*)exec_node->ops_priv;
+
+    /* the shared memory size follows the seq and batch */
+    set_gru_shape(priv_info, input_tensor, param);
+    exec_node->shared_mem_size = get_shared_mem_size(priv_info);
+
+    return 0;
+}
+
+static int postrun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct gru_priv_info* priv_info = (struct gru_priv_info*)exec_node->ops_priv;
+
+    sys_free(priv_info->w_pack);
+    sys_free(priv_info->r_pack);
+    sys_free(priv_info->bias);
+
+    priv_info->w_pack = NULL;
+    priv_info->r_pack = NULL;
+    priv_info->bias = NULL;
+
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct node* ir_node = exec_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* w_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct gru_param* param = (struct gru_param*)ir_node->op.param_mem;
+
+    if (input_tensor->data_type != TENGINE_DT_FP32 || input_tensor->dim_num != 3)
+        return 0;
+
+    /* the bias out of the reset gate is left to the ref op */
+    if (ir_node->input_num != 3 && ir_node->input_num != 5)
+        return 0;
+
+    /* one way or bidirectional */
+    if (w_tensor->dim_num != 3 || w_tensor->dims[0] < 1 || w_tensor->dims[0] > 2 || w_tensor->dims[1] != 3 * param->hidden_size)
+        return 0;
+
+    return OPS_SCORE_PREFER;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = prerun,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = postrun,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .resize = resize,
+                                       .isa = CPU_ISA_BUILD};
+
+int register_gru_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_GRU, &hcl_node_ops);
+}
+
+int unregister_gru_hcl_x86_op()
+{
+    unregister_builtin_node_ops(OP_GRU, &hcl_node_ops);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "interp_kernel_x86.h"
+
+#include "interp_param.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/cpu.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+
+#include <string.h>
+
+/* 1 nearest, 2 bilinear, 3 bicubic as ncnn, 4 bilinear of align_corners */
+static int init_table(struct interp_x86_table* table, struct node* ir_node)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct interp_param* param = (struct interp_param*)ir_node->op.param_mem;
+
+    if (input_tensor->data_type != TENGINE_DT_FP32 || input_tensor->dim_num != 4 || output_tensor->dim_num != 4)
+        return -1;
+
+    if (input_tensor->dims[0] != output_tensor->dims[0] || input_tensor->dims[1] != output_tensor->dims[1])
+        return -1;
+
+    int in_h = input_tensor->dims[2];
+    int in_w = input_tensor->dims[3];
+    int out_h = output_tensor->dims[2];
+    int out_w = output_tensor->dims[3];
+
+    double scale_h = (double)in_h / out_h;
+    double scale_w = (double)in_w / out_w;
+
+    switch (param->resize_type)
+    {
+    case 1:
+        /* the output row h is the input row h / height_scale */
+        if (param->height_scale > 0.f && param->width_scale > 0.f)
+        {
+            scale_h = 1.f / param->height_scale;
+            scale_w = 1.f / param->width_scale;
+        }
+        return interp_x86_init_table(table, INTERP_X86_NEAREST, 0, in_h, in_w, out_h, out_w, scale_h, scale_w);
+    case 2:
+        return interp_x86_init_table(table, INTERP_X86_LINEAR, 0, in_h, in_w, out_h, out_w, scale_h, scale_w);
+    case 3:
+        return interp_x86_init_table(table, INTERP_X86_CUBIC, 0, in_h, in_w, out_h, out_w, scale_h, scale_w);
+    case 4:
+        return interp_x86_init_table(table, INTERP_X86_LINEAR, 1, in_h, in_w, out_h, out_w, scale_h, scale_w);
+    default:
+        return -1;
+    }
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct interp_x86_table* table = (struct interp_x86_table*)sys_malloc(sizeof(struct interp_x86_table));
+    if (table == NULL)
+        return -1;
+
+    memset(table, 0, sizeof(struct interp_x86_table));
+    exec_node->ops_priv = table;
+
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    sys_free(exec_node->ops_priv);
+    return 0;
+}
+
+/* the tables are of the shapes, a reshape runs postrun and prerun again */
+static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct interp_x86_table* table = (struct interp_x86_table*)exec_node->ops_priv;
+
+    interp_x86_release_table(table);
+
+    if (init_table(table, ir_node) < 0)
+    {
+        TLOG_ERR("interp x86 op does not support node %d\n", ir_node->index);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int postrun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    interp_x86_release_table((struct interp_x86_table*)exec_node->ops_priv);
+    return 0;
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct interp_x86_table* table = (struct interp_x86_table*)exec_node->ops_priv;
+
+    int plane_num = input_tensor->dims[0] * input_tensor->dims[1];
+
+    interp_x86_run(table, (const float*)input_tensor->data, (float*)output_tensor->data, plane_num,
+                   exec_graph->num_thread);
+
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct interp_x86_table table;
+
+    if (init_table(&table, exec_node) < 0)
+        return 0;
+
+    interp_x86_release_table(&table);
+
+    return OPS_SCORE_PREFER;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = prerun,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = postrun,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .isa = CPU_ISA_BUILD};
+
+int register_interp_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_INTERP, &hcl_node_ops);
+}
+
+int unregister_interp_hcl_x86_op()
+{
+    return unregister_builtin_node_ops(OP_INTERP, &hcl_node_ops);
+}
@@ -0,0 +1,381 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "interp_kernel_x86.h"
+
+#include "system/cpu.h"
+#include "system/thread_pool.h"
+#include "utility/sys_port.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#define INTERP_X86_TASK_ROWS 16 /* the least output rows of a thread when the planes are fewer than the threads */
+
+/*
+ * the planes are split to the threads, and also their rows when there are fewer planes than
+ * threads. a thread resizes the input rows of its output rows horizontally once, keeping the
+ * last taps of them for the next output rows, and sums them vertically.
+ */
+struct interp_x86_job
+{
+    const struct interp_x86_table* table;
+    const float* input;
+    float* output;
+    int band_num; /* the parts of the rows of a plane */
+    int avx2;
+};
+
+static inline int clamp_index(int x, int size)
+{
+    return x < 0 ? 0 : (x >= size ? size - 1 : x);
+}
+
+static void cubic_coeffs(float fx, float* coeffs)
+{
+    const float A = -0.75f;
+
+    float fx0 = fx + 1.f;
+    float fx1 = fx;
+    float fx2 = 1.f - fx;
+
+    coeffs[0] = A * fx0 * fx0 * fx0 - 5.f * A * fx0 * fx0 + 8.f * A * fx0 - 4.f * A;
+    coeffs[1] = (A + 2.f) * fx1 * fx1 * fx1 - (A + 3.f) * fx1 * fx1 + 1.f;
+    coeffs[2] = (A + 2.f) * fx2 * fx2 * fx2 - (A + 3.f) * fx2 * fx2 + 1.f;
+    coeffs[3] = 1.f - coeffs[0] - coeffs[1] - coeffs[2];
+}
+
+/* the tap k of the output d is at ofs[k * tap_step + d * out_step] */
+static void set_axis(int type, int align_corners, int in, int out, double scale, int* ofs, float* weight, int tap_step,
+                     int out_step)
+{
+    if (align_corners)
+        scale = out > 1 ? (double)(in - 1) / (out - 1) : 0.;
+
+    for (int d = 0; d < out; d++)
+    {
+        int* p = ofs + (size_t)d * out_step;
+        float* w = weight + (size_t)d * out_step;
+
+        if (type == INTERP_X86_NEAREST)
+        {
+            p[0] = clamp_index((int)(d * (float)scale), in);
+            w[0] = 1.f;
+            continue;
+        }
+
+        float fx = align_corners ? (float)(d * scale) : (float)((d + 0.5) * scale - 0.5);
+        int sx = (int)floorf(fx);
+        fx -= sx;
+
+        if (type == INTERP_X86_LINEAR)
+        {
+            /* as linear_coeffs of the ref op */
+            if (sx < 0)
+            {
+                sx = 0;
+                fx = 0.f;
+            }
+            if (sx >= in - 1)
+            {
+                sx = in - 2;
+                fx = 1.f;
+            }
+
+            p[0] = clamp_index(sx, in);
+            p[tap_step] = clamp_index(sx + 1, in);
+            w[0] = 1.f - fx;
+            w[tap_step] = fx;
+        }
+        else
+        {
+            float coeffs[4];
+            cubic_coeffs(fx, coeffs);
+
+            for (int k = 0; k < 4; k++)
+            {
+                p[k * tap_step] = clamp_index(sx - 1 + k, in);
+                w[k * tap_step] = coeffs[k];
+            }
+        }
+    }
+}
+
+int interp_x86_init_table(struct interp_x86_table* table, int type, int align_corners, int in_h, int in_w, int out_h,
+                          int out_w, double scale_h, double scale_w)
+{
+    memset(table, 0, sizeof(struct interp_x86_table));
+
+    if (type != INTERP_X86_NEAREST && type != INTERP_X86_LINEAR && type != INTERP_X86_CUBIC)
+        return -1;
+
+    if (in_h < 1 || in_w < 1 || out_h < 1 || out_w < 1)
+        return -1;
+
+    int taps = type == INTERP_X86_CUBIC ? 4 : type;
+    size_t size = (size_t)(out_w + out_h) * taps;
+
+    int* ofs = (int*)sys_malloc(size * (sizeof(int) + sizeof(float)));
+    if (ofs == NULL)
+        return -1;
+
+    table->type = type;
+    table->taps = taps;
+    table->in_h = in_h;
+    table->in_w = in_w;
+    table->out_h = out_h;
+    table->out_w = out_w;
+    table->xofs = ofs;
+    table->yofs = ofs + (size_t)out_w * taps;
+    table->alpha = (float*)(ofs + size);
+    table->beta = table->alpha + (size_t)out_w * taps;
+
+    set_axis(type, align_corners, in_w, out_w, scale_w, table->xofs, table->alpha, out_w, 1);
+    set_axis(type, align_corners, in_h, out_h, scale_h, table->yofs, table->beta, 1, taps);
+
+    return 0;
+}
+
+void interp_x86_release_table(struct interp_x86_table* table)
+{
+    sys_free(table->xofs);
+    memset(table, 0, sizeof(struct interp_x86_table));
+}
+
+static void hresize(const float* src, const int* xofs, const float* alpha, int taps, int out_w, float* dst, int avx2)
+{
+    if (avx2)
+    {
+        interp_x86_hresize_avx2(src, xofs, alpha, taps, out_w, dst);
+        return;
+    }
+
+    if (alpha == NULL)
+    {
+        for (int dx = 0; dx < out_w; dx++)
+            dst[dx] = src[xofs[dx]];
+    }
+    else if (taps == 2)
+    {
+        const int* xofs1 = xofs + out_w;
+        const float* alpha1 = alpha + out_w;
+
+        for (int dx = 0; dx < out_w; dx++)
+            dst[dx] = src[xofs[dx]] * alpha[dx] + src[xofs1[dx]] * alpha1[dx];
+    }
+    else
+    {
+        for (int dx = 0; dx < out_w; dx++)
+        {
+            float sum = 0.f;
+
+            for (int k = 0; k < taps; k++)
+                sum += src[xofs[k * out_w + dx]] * alpha[k * out_w + dx];
+
+            dst[dx] = sum;
+        }
+    }
+}
+
+/* dst = rows[0] * beta[0] + ... + rows[taps - 1] * beta[taps - 1] */
+static void vresize(const float* const* rows, const float* beta, int taps, int out_w, float* dst)
+{
+    int dx = 0;
+
+#if __AVX__
+    if (taps == 2)
+    {
+        __m256 _b0 = _mm256_set1_ps(beta[0]);
+        __m256 _b1 = _mm256_set1_ps(beta[1]);
+
+        for (; dx + 7 < out_w; dx += 8)
+        {
+            __m256 _sum = _mm256_mul_ps(_mm256_loadu_ps(rows[0] + dx), _b0);
+            _sum = _mm256_add_ps(_sum, _mm256_mul_ps(_mm256_loadu_ps(rows[1] + dx), _b1));
+            _mm256_storeu_ps(dst + dx, _sum);
+        }
+    }
+    else
+    {
+        __m256 _b0 = _mm256_set1_ps(beta[0]);
+        __m256 _b1 = _mm256_set1_ps(beta[1]);
+        __m256 _b2 = _mm256_set1_ps(beta[2]);
+        __m256 _b3 = _mm256_set1_ps(beta[3]);
+
+        for (; dx + 7 < out_w; dx += 8)
+        {
+            __m256 _sum0 = _mm256_mul_ps(_mm256_loadu_ps(rows[0] + dx), _b0);
+            __m256 _sum1 = _mm256_mul_ps(_mm256_loadu_ps(rows[1] + dx), _b1);
+            _sum0 = _mm256_add_ps(_sum0, _mm256_mul_ps(_mm256_loadu_ps(rows[2] + dx), _b2));
+            _sum1 = _mm256_add_ps(_sum1, _mm256_mul_ps(_mm256_loadu_ps(rows[3] + dx), _b3));
+            _mm256_storeu_ps(dst + dx, _mm256_add_ps(_sum0, _sum1));
+        }
+    }
+#endif
+
+    if (taps == 2)
+    {
+        for (; dx < out_w; dx++)
+            dst[dx] = rows[0][dx] * beta[0] + rows[1][dx] * beta[1];
+    }
+    else
+    {
+        for (; dx < out_w; dx++)
+            dst[dx] = (rows[0][dx] * beta[0] + rows[1][dx] * beta[1]) + (rows[2][dx] * beta[2] + rows[3][dx] * beta[3]);
+    }
+}
+
+static void resize_nearest(const struct interp_x86_table* table, const float* src, float* dst, int y0, int y1, int avx2)
+{
+    int in_w = table->in_w;
+    int out_w = table->out_w;
+
+    for (int dy = y0; dy < y1; dy++)
+    {
+        float* out = dst + (size_t)dy * out_w;
+
+        if (dy > y0 && table->yofs[dy] == table->yofs[dy - 1])
+            memcpy(out, out - out_w, out_w * sizeof(float));
+        else
+            hresize(src + (size_t)table->yofs[dy] * in_w, table->xofs, NULL, 1, out_w, out, avx2);
+    }
+}
+
+/* the rows are the buffers of taps * out_w, the input rows in them are tagged */
+static void resize_filter(const struct interp_x86_table* table, const float* src, float* dst, int y0, int y1,
+                          float* buffer, int avx2)
+{
+    int taps = table->taps;
+    int in_w = table->in_w;
+    int out_w = table->out_w;
+
+    float* bufs[4];
+    int tags[4];
+
+    for (int i = 0; i < taps; i++)
+    {
+        bufs[i] = buffer + (size_t)i * out_w;
+        tags[i] = -1;
+    }
+
+    for (int dy = y0; dy < y1; dy++)
+    {
+        const int* ys = table->yofs + (size_t)dy * taps;
+        const float* rows[4];
+
+        for (int k = 0; k < taps; k++)
+        {
+            int found = -1;
+
+            for (int i = 0; i < taps && found < 0; i++)
+            {
+                if (tags[i] == ys[k])
+                    found = i;
+            }
+
+            /* a buffer of none of the rows of dy, there are at most taps - 1 others */
+            for (int i = 0; i < taps && found < 0; i++)
+            {
+                int used = 0;
+                for (int j = 0; j < taps; j++)
+                    used |= tags[i] == ys[j];
+
+                if (!used)
+                {
+                    hresize(src + (size_t)ys[k] * in_w, table->xofs, table->alpha, taps, out_w, bufs[i], avx2);
+                    tags[i] = ys[k];
+                    found = i;
+                }
+            }
+
+            rows[k] = bufs[found];
+        }
+
+        vresize(rows, table->beta + (size_t)dy * taps, taps, out_w, dst + (size_t)dy * out_w);
+    }
+}
+
+static void interp_task(void* arg, int begin, int end)
+{
+    const struct interp_x86_job* job = (const struct interp_x86_job*)arg;
+    const struct interp_x86_table* table = job->table;
+
+    size_t in_size = (size_t)table->in_h * table->in_w;
+    size_t out_size = (size_t)table->out_h * table->out_w;
+
+    float* buffer = NULL;
+    if (table->type != INTERP_X86_NEAREST)
+    {
+        buffer = (float*)sys_malloc((size_t)table->taps * table->out_w * sizeof(float));
+        if (buffer == NULL)
+            return;
+    }
+
+    for (int i = begin; i < end; i++)
+    {
+        int plane = i / job->band_num;
+        int band = i % job->band_num;
+
+        int y0 = (int)((long long)table->out_h * band / job->band_num);
+        int y1 = (int)((long long)table->out_h * (band + 1) / job->band_num);
+
+        const float* src = job->input + in_size * plane;
+        float* dst = job->output + out_size * plane;
+
+        if (table->type == INTERP_X86_NEAREST)
+            resize_nearest(table, src, dst, y0, y1, job->avx2);
+        else
+            resize_filter(table, src, dst, y0, y1, buffer, job->avx2);
+    }
+
+    sys_free(buffer);
+}
+
+void interp_x86_run(const struct interp_x86_table* table, const float* input, float* output, int plane_num,
+                    int num_thread)
+{
+    struct interp_x86_job job;
+
+    job.table = table;
+    job.input = input;
+    job.output = output;
+    job.avx2 = (get_cpu_isa() & CPU_ISA_AVX2) != 0;
+    job.band_num = 1;
+
+    if (plane_num < num_thread)
+    {
+        int band_num = (num_thread + plane_num - 1) / plane_num;
+        int max_band = table->out_h / INTERP_X86_TASK_ROWS;
+
+        job.band_num = band_num < max_band ? band_num : max_band;
+        if (job.band_num < 1)
+            job.band_num = 1;
+    }
+
+    parallel_for(interp_task, &job, plane_num * job.band_num, num_thread);
+}
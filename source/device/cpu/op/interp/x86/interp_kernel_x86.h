@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+
+#ifndef _INTERP_KERNEL_X86_H_
+#define _INTERP_KERNEL_X86_H_
+
+/* the filters of interp and resize */
+#define INTERP_X86_NEAREST 1
+#define INTERP_X86_LINEAR  2
+#define INTERP_X86_CUBIC   3
+
+/*
+ * the output pixel is the sum of taps input pixels of a row times their weights, of taps rows
+ * times theirs. the pixels out of the input are clamped to its border. the tables are built
+ * in prerun and kept till the shape changes.
+ */
+struct interp_x86_table
+{
+    int type;
+    int taps; /* 1 for nearest, 2 for linear and 4 for cubic */
+    int in_h;
+    int in_w;
+    int out_h;
+    int out_w;
+
+    int* xofs;    /* [taps][out_w], the columns of the output columns */
+    float* alpha; /* [taps][out_w] */
+    int* yofs;    /* [out_h][taps], the rows of the output rows */
+    float* beta;  /* [out_h][taps] */
+};
+
+/*
+ * the output pixel dx is at the input coordinate dx * scale_w of nearest, rounded down, and
+ * of align_corners, which ignores the scales, or else (dx + 0.5) * scale_w - 0.5. the scales
+ * are input / output. cubic is of a = -0.75, as ncnn and pytorch.
+ * return -1 for the type or the shapes not supported or no memory.
+ */
+int interp_x86_init_table(struct interp_x86_table* table, int type, int align_corners, int in_h, int in_w, int out_h,
+                          int out_w, double scale_h, double scale_w);
+
+void interp_x86_release_table(struct interp_x86_table* table);
+
+/* resize the planes of plane_num images, the batch * channel of nchw */
+void interp_x86_run(const struct interp_x86_table* table, const float* input, float* output, int plane_num,
+                    int num_thread);
+
+/* only for the cpu with avx2, a row of the output of the columns and their weights, without the weights of nearest */
+void interp_x86_hresize_avx2(const float* src, const int* xofs, const float* alpha, int taps, int out_w, float* dst);
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "interp_kernel_x86.h"
+
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+/* the input columns of 8 output columns are gathered */
+void interp_x86_hresize_avx2(const float* src, const int* xofs, const float* alpha, int taps, int out_w, float* dst)
+{
+    int dx = 0;
+
+#if __AVX2__
+    if (alpha == NULL)
+    {
+        for (; dx + 7 < out_w; dx += 8)
+        {
+            __m256i _x = _mm256_loadu_si256((const __m256i*)(xofs + dx));
+            _mm256_storeu_ps(dst + dx, _mm256_i32gather_ps(src, _x, 4));
+        }
+    }
+    else
+    {
+        for (; dx + 7 < out_w; dx += 8)
+        {
+            __m256i _x = _mm256_loadu_si256((const __m256i*)(xofs + dx));
+            __m256 _sum = _mm256_mul_ps(_mm256_i32gather_ps(src, _x, 4), _mm256_loadu_ps(alpha + dx));
+
+            for (int k = 1; k < taps; k++)
+            {
+                _x = _mm256_loadu_si256((const __m256i*)(xofs + k * out_w + dx));
+                _sum = _mm256_fmadd_ps(_mm256_i32gather_ps(src, _x, 4), _mm256_loadu_ps(alpha + k * out_w + dx), _sum);
+            }
+
+            _mm256_storeu_ps(dst + dx, _sum);
+        }
+    }
+#endif
+
+    for (; dx < out_w; dx++)
+    {
+        if (alpha == NULL)
+        {
+            dst[dx] = src[xofs[dx]];
+            continue;
+        }
+
+        float sum = src[xofs[dx]] * alpha[dx];
+
+        for (int k = 1; k < taps; k++)
+            sum += src[xofs[k * out_w + dx]] * alpha[k * out_w + dx];
+
+        dst[dx] = sum;
+    }
+}
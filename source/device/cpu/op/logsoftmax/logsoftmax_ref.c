@@ -161,6 +161,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     max_array = (float*)sys_malloc(in_size * sizeof(float));
     sum_array = (float*)sys_malloc(in_size * sizeof(float));
 
+    ref_logsoftmax_param.out_size = out_size;
     ref_logsoftmax_param.in_size = in_size;
     ref_logsoftmax_param.on_size = on_size;
 
@@ -169,6 +170,9 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     // else
     // ref_logistic_uint8(input_tensor->data, output_tensor->data, &logical_param);
 
+    sys_free(max_array);
+    sys_free(sum_array);
+
     return 0;
 }
 
@@ -130,7 +130,7 @@ int ref_lstm_default_fp32(struct tensor* input_tensor, struct tensor* w, struct
                     float H = O * tmp;
                     output_c_data[i * hidden_size + c] = cell2;
                     output_h_data[i * hidden_size + c] = H;
-                    output_data[i * hidden_size + c] = H;
+                    output_data[seq * hidden_size * batch_size + i * hidden_size + c] = H;
                 }
                 else
                 {
@@ -143,7 +143,7 @@ int ref_lstm_default_fp32(struct tensor* input_tensor, struct tensor* w, struct
                     float H = O * tanh(cell2);
                     output_c_data[i * hidden_size + c] = cell2;
                     output_h_data[i * hidden_size + c] = H;
-                    output_data[i * hidden_size + c] = H;
+                    output_data[seq * hidden_size * batch_size + i * hidden_size + c] = H;
                 }
             }
         }
@@ -259,7 +259,7 @@ int ref_lstm_with_bias_fp32(struct tensor* input_tensor, struct tensor* w, struc
                     float H = O * tmp;
                     output_c_data[i * hidden_size + c] = cell2;
                     output_h_data[i * hidden_size + c] = H;
-                    output_data[i * hidden_size + c] = H;
+                    output_data[seq * hidden_size * batch_size + i * hidden_size + c] = H;
                 }
                 else
                 {
@@ -272,7 +272,7 @@ int ref_lstm_with_bias_fp32(struct tensor* input_tensor, struct tensor* w, struc
                     float H = O * tanh(cell2);
                     output_c_data[i * hidden_size + c] = cell2;
                     output_h_data[i * hidden_size + c] = H;
-                    output_data[i * hidden_size + c] = H;
+                    output_data[seq * hidden_size * batch_size + i * hidden_size + c] = H;
                 }
             }
         }
@@ -280,6 +280,8 @@ int ref_lstm_with_bias_fp32(struct tensor* input_tensor, struct tensor* w, struc
 
     free(init_h_data);
     free(init_c_data);
+    free(output_h_data);
+    free(output_c_data);
     free(i_flag);
     free(f_flag);
     free(o_flag);
@@ -288,7 +290,16 @@ int ref_lstm_with_bias_fp32(struct tensor* input_tensor, struct tensor* w, struc
     return 0;
 }
 
-int ref_lstm_with_bias_case1_fp32(struct tensor* input_tensor, struct tensor* w, struct tensor* r, struct tensor* b, struct tensor* output_tensor, struct lstm_param* param)
+/* the initial state of [1, batch, hidden] in the tensor, or 0 */
+static void ref_lstm_init_state(struct tensor* state, float* data, int size)
+{
+    if (state != NULL && state->data_type == TENGINE_DT_FP32 && state->elem_num == size)
+        memcpy(data, state->data, (unsigned long)size * sizeof(float));
+    else
+        memset(data, 0, (unsigned long)size * sizeof(float));
+}
+
+int ref_lstm_with_bias_case1_fp32(struct tensor* input_tensor, struct tensor* w, struct tensor* r, struct tensor* b, struct tensor* init_h, struct tensor* init_c, struct tensor* output_tensor, struct lstm_param* param)
 {
     int sequence_size = input_tensor->dims[0];
     int batch_size = input_tensor->dims[1];
@@ -306,8 +317,8 @@ int ref_lstm_with_bias_case1_fp32(struct tensor* input_tensor, struct tensor* w,
     float* output_h_data = (float*)malloc((unsigned long)hidden_size * batch_size * sizeof(float));
     float* output_c_data = (float*)malloc((unsigned long)hidden_size * batch_size * sizeof(float));
 
-    memset(init_h_data, 0, (unsigned long)hidden_size * batch_size * sizeof(float));
-    memset(init_c_data, 0, (unsigned long)hidden_size * batch_size * sizeof(float));
+    ref_lstm_init_state(init_h, init_h_data, hidden_size * batch_size);
+    ref_lstm_init_state(init_c, init_c_data, hidden_size * batch_size);
     memset(output_h_data, 0, (unsigned long)hidden_size * batch_size * sizeof(float));
     memset(output_c_data, 0, (unsigned long)hidden_size * batch_size * sizeof(float));
 
@@ -702,7 +713,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     lstm_param_t* param = (struct lstm_param*)(ir_node->op.param_mem);
 
     /* only support one way */
-    if (w->dim_num == 4 && w->dims[0] == 2)
+    if (w->dim_num >= 3 && w->dims[0] == 2)
     {
         printf("LSTM only support one way.\n");
         return -1;
@@ -721,9 +732,12 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     }
     else if (ir_node->input_num == 6)
     {
+        /* as exported by pytorch, with the initial states and no sequence_lens */
         b = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]);
+        init_h = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[4]);
+        init_c = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[5]);
 
-        ret = ref_lstm_with_bias_case1_fp32(input_tensor, w, r, b, output_tensor, param);
+        ret = ref_lstm_with_bias_case1_fp32(input_tensor, w, r, b, init_h, init_c, output_tensor, param);
     }
     else
     {
@@ -744,6 +758,7 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
     struct node* node = exec_node->ir_node;
     struct graph* ir_graph = node->graph;
     struct tensor* input = get_ir_graph_tensor(ir_graph, node->input_tensors[0]);
+    struct tensor* weight = get_ir_graph_tensor(ir_graph, node->input_tensors[1]);
     struct tensor* output = get_ir_graph_tensor(ir_graph, node->output_tensors[0]);
     struct lstm_param* lstm_param = (struct lstm_param*)(node->op.param_mem);
 
@@ -756,7 +771,7 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
     if (lstm_param->mxnet_flag == 0)
     {
         dims[0] = input->dims[0];
-        dims[1] = 1;
+        dims[1] = weight->dim_num == 3 ? weight->dims[0] : 1;
         dims[2] = input->dims[1];
         dims[3] = lstm_param->hidden_size;
     }
@@ -0,0 +1,185 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "lstm_kernel_x86.h"
+
+#include "device/cpu/op/conv/x86/conv_kernel_x86.h"
+#include "utility/simd_math.h"
+
+#include <string.h>
+
+int rnn_get_unit_block_num(int hidden)
+{
+    return (hidden + RNN_UNIT_BLOCK - 1) / RNN_UNIT_BLOCK;
+}
+
+int rnn_get_recurrent_pack_size(int gate_num, int hidden)
+{
+    return rnn_get_unit_block_num(hidden) * hidden * gate_num * RNN_UNIT_BLOCK;
+}
+
+void rnn_pack_recurrent_weight(int gate_num, int hidden, const float* r, float* r_pack)
+{
+    int block_num = rnn_get_unit_block_num(hidden);
+
+    for (int ub = 0; ub < block_num; ub++)
+    {
+        float* ptr = r_pack + (size_t)ub * hidden * gate_num * RNN_UNIT_BLOCK;
+
+        for (int k = 0; k < hidden; k++)
+        {
+            for (int g = 0; g < gate_num; g++)
+            {
+                for (int j = 0; j < RNN_UNIT_BLOCK; j++)
+                {
+                    int q = ub * RNN_UNIT_BLOCK + j;
+
+                    ptr[j] = q < hidden ? r[(size_t)(g * hidden + q) * hidden + k] : 0.f;
+                }
+
+                ptr += RNN_UNIT_BLOCK;
+            }
+        }
+    }
+}
+
+/* inlined for a const gate_num, so that the sums are kept in the registers */
+static inline void recurrent_gemv(const int gate_num, int hidden, const float* r_pack, const float* h, float* sum)
+{
+#if __AVX__
+    /* the k are added in two sums to hide the latency */
+    __m256 _sum0[4];
+    __m256 _sum1[4];
+
+    for (int g = 0; g < gate_num; g++)
+    {
+        _sum0[g] = _mm256_setzero_ps();
+        _sum1[g] = _mm256_setzero_ps();
+    }
+
+    int k = 0;
+    for (; k + 1 < hidden; k += 2)
+    {
+        __m256 _h0 = _mm256_broadcast_ss(h + k);
+        __m256 _h1 = _mm256_broadcast_ss(h + k + 1);
+
+        for (int g = 0; g < gate_num; g++)
+        {
+            _sum0[g] = _mm256_fmadd_ps(_mm256_loadu_ps(r_pack + g * 8), _h0, _sum0[g]);
+            _sum1[g] = _mm256_fmadd_ps(_mm256_loadu_ps(r_pack + (gate_num + g) * 8), _h1, _sum1[g]);
+        }
+
+        r_pack += gate_num * 16;
+    }
+    if (k < hidden)
+    {
+        __m256 _h0 = _mm256_broadcast_ss(h + k);
+
+        for (int g = 0; g < gate_num; g++)
+            _sum0[g] = _mm256_fmadd_ps(_mm256_loadu_ps(r_pack + g * 8), _h0, _sum0[g]);
+    }
+
+    for (int g = 0; g < gate_num; g++)
+        _mm256_storeu_ps(sum + g * 8, _mm256_add_ps(_sum0[g], _sum1[g]));
+#else
+    memset(sum, 0, sizeof(float) * gate_num * RNN_UNIT_BLOCK);
+
+    for (int k = 0; k < hidden; k++)
+    {
+        for (int i = 0; i < gate_num * RNN_UNIT_BLOCK; i++)
+            sum[i] += r_pack[i] * h[k];
+
+        r_pack += gate_num * RNN_UNIT_BLOCK;
+    }
+#endif
+}
+
+void rnn_recurrent_gemv(int gate_num, int hidden, const float* r_pack, const float* h, float* sum)
+{
+    if (gate_num == 4)
+        recurrent_gemv(4, hidden, r_pack, h, sum);
+    else if (gate_num == 3)
+        recurrent_gemv(3, hidden, r_pack, h, sum);
+    else
+        recurrent_gemv(gate_num, hidden, r_pack, h, sum);
+}
+
+void rnn_sigmoid(float* x, int n)
+{
+    int i = 0;
+#if __AVX__
+    for (; i + 7 < n; i += 8)
+        _mm256_storeu_ps(x + i, simd_sigmoid_f32x8(_mm256_loadu_ps(x + i)));
+#endif
+    for (; i < n; i++)
+        x[i] = simd_sigmoid_f32(x[i]);
+}
+
+void rnn_tanh(float* x, int n)
+{
+    int i = 0;
+#if __AVX__
+    for (; i + 7 < n; i += 8)
+        _mm256_storeu_ps(x + i, simd_tanh_f32x8(_mm256_loadu_ps(x + i)));
+#endif
+    for (; i < n; i++)
+        x[i] = simd_tanh_f32(x[i]);
+}
+
+int rnn_get_input_pack_size(int gate_num, int hidden, int input_size)
+{
+    int m = gate_num * hidden;
+
+    return 8 * input_size * (m / 8 + (m % 8) / 4 + m % 4) * (int)sizeof(float);
+}
+
+void rnn_pack_input_weight(int gate_num, int hidden, int input_size, float* w, float* w_pack)
+{
+    interleave_pack4_fp32(gate_num * hidden, input_size, w, w_pack);
+}
+
+int rnn_get_input_proj_mem_size(int input_size, int step_num)
+{
+    int x_size = input_size * step_num;
+    int x_pack_size = 8 * input_size * (step_num / 8 + step_num % 8);
+
+    return (x_size + x_pack_size) * (int)sizeof(float);
+}
+
+void rnn_input_proj(int gate_num, int hidden, int input_size, int step_num, float* w_pack, const float* x,
+                    void* mem, float* output, int num_thread)
+{
+    float* x_t = (float*)mem;
+    float* x_pack = x_t + (size_t)input_size * step_num;
+
+    /* the steps are the columns of B */
+    for (int n = 0; n < step_num; n++)
+    {
+        for (int k = 0; k < input_size; k++)
+            x_t[(size_t)k * step_num + n] = x[(size_t)n * input_size + k];
+    }
+
+    input_pack4_fp32(input_size, step_num, x_t, x_pack, num_thread);
+
+    sgemm_fp(gate_num * hidden, step_num, input_size, w_pack, x_pack, output, num_thread);
+}
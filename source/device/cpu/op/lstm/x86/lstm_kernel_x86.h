@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef _LSTM_KERNEL_X86_H_
+#define _LSTM_KERNEL_X86_H_
+
+/*
+ * the kernels shared by the x86 lstm and gru, the weights are of the onnx layout, the gates
+ * are stacked in the rows, W[gate_num * hidden, input_size] and R[gate_num * hidden, hidden].
+ */
+
+#define RNN_UNIT_BLOCK 8
+
+/* the count of the blocks of RNN_UNIT_BLOCK hidden units */
+int rnn_get_unit_block_num(int hidden);
+
+/* in floats, R packed by rnn_pack_recurrent_weight() */
+int rnn_get_recurrent_pack_size(int gate_num, int hidden);
+
+/*
+ * R[gate_num * hidden, hidden] packed as [unit block][k][gate][RNN_UNIT_BLOCK], so that a block
+ * of units gets all its gates at once, the units over hidden are padded with 0.
+ */
+void rnn_pack_recurrent_weight(int gate_num, int hidden, const float* r, float* r_pack);
+
+/*
+ * sum[gate][RNN_UNIT_BLOCK] = R * h of the units in the block packed at r_pack, gate_num <= 4.
+ */
+void rnn_recurrent_gemv(int gate_num, int hidden, const float* r_pack, const float* h, float* sum);
+
+/* the activations of the gates, in place over the n floats */
+void rnn_sigmoid(float* x, int n);
+
+void rnn_tanh(float* x, int n);
+
+/* in bytes, W packed by rnn_pack_input_weight() */
+int rnn_get_input_pack_size(int gate_num, int hidden, int input_size);
+
+void rnn_pack_input_weight(int gate_num, int hidden, int input_size, float* w, float* w_pack);
+
+/* in bytes, the scratch of rnn_input_proj() */
+int rnn_get_input_proj_mem_size(int input_size, int step_num);
+
+/*
+ * output[gate_num * hidden, step_num] = W * x^T, the input projection of all the steps as one sgemm,
+ * x[step_num, input_size] holds the sequence and batch in the rows.
+ */
+void rnn_input_proj(int gate_num, int hidden, int input_size, int step_num, float* w_pack, const float* x,
+                    void* mem, float* output, int num_thread);
+
+#endif
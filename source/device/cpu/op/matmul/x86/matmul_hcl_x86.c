@@ -0,0 +1,369 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/cpu.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+#include "device/cpu/op/conv/x86/conv_kernel_x86.h"
+#include "device/cpu/op/fc/x86/fc_kernel_x86.h"
+
+#include <string.h>
+
+/*
+ * output[m, k] = input0[m, n] * input1[n, k], named as the ref op, for each matrix of
+ * the leading dims of input0. the leading dims of input1 are aligned to the right of
+ * them, and the ones of size 1 or missing are broadcast.
+ */
+struct matmul_priv_info
+{
+    int batch;
+    int m;
+    int n;
+    int k;
+
+    int batch_dims[2];     /* leading dims of input0, padded with 1 in the front */
+    int input1_strides[2]; /* in matrices, 0 for a broadcast dim */
+    int input1_num;        /* count of the input1 matrices */
+
+    float* input0_pack;
+    int input0_pack_size;
+    float* input1_pack;
+    int input1_pack_size; /* of one matrix */
+    int input1_const;     /* input1 is packed once in prerun */
+
+    /* the const input1 kept transposed in fp16 or bf16 as the fc weights, see fc_kernel_x86.h */
+    int half_kernel;
+    uint16_t* input1_half;
+    int input1_half_size; /* of one matrix */
+    void* input0_half;
+};
+
+static int get_input1_index(struct matmul_priv_info* priv_info, int b)
+{
+    return (b / priv_info->batch_dims[1]) * priv_info->input1_strides[0] + (b % priv_info->batch_dims[1]) * priv_info->input1_strides[1];
+}
+
+static int set_matmul_shape(struct matmul_priv_info* priv_info, struct tensor* input0, struct tensor* input1)
+{
+    int dim0_num = input0->dim_num;
+    int dim1_num = input1->dim_num;
+
+    if (dim0_num < 2 || dim0_num > 4 || dim1_num < 2 || dim1_num > dim0_num)
+        return -1;
+
+    priv_info->m = input0->dims[dim0_num - 2];
+    priv_info->n = input0->dims[dim0_num - 1];
+    priv_info->k = input1->dims[dim1_num - 1];
+
+    if (input1->dims[dim1_num - 2] != priv_info->n)
+        return -1;
+
+    int dims1[2] = {1, 1};
+
+    priv_info->batch_dims[0] = 1;
+    priv_info->batch_dims[1] = 1;
+
+    for (int i = 0; i < dim0_num - 2; i++)
+        priv_info->batch_dims[4 - dim0_num + i] = input0->dims[i];
+    for (int i = 0; i < dim1_num - 2; i++)
+        dims1[4 - dim1_num + i] = input1->dims[i];
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (dims1[i] != 1 && dims1[i] != priv_info->batch_dims[i])
+            return -1;
+    }
+
+    priv_info->input1_strides[1] = dims1[1] == 1 ? 0 : 1;
+    priv_info->input1_strides[0] = dims1[0] == 1 ? 0 : dims1[1];
+    priv_info->input1_num = dims1[0] * dims1[1];
+    priv_info->batch = priv_info->batch_dims[0] * priv_info->batch_dims[1];
+
+    int m = priv_info->m;
+    int k = priv_info->k;
+
+    priv_info->input0_pack_size = 8 * priv_info->n * (m / 8 + (m % 8) / 4 + m % 4) * sizeof(float);
+    priv_info->input1_pack_size = 8 * priv_info->n * (k / 8 + k % 8) * sizeof(float);
+
+    return 0;
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct matmul_priv_info* priv_info = (struct matmul_priv_info*)sys_malloc(sizeof(struct matmul_priv_info));
+
+    if (priv_info == NULL)
+        return -1;
+
+    memset(priv_info, 0, sizeof(struct matmul_priv_info));
+    exec_node->ops_priv = priv_info;
+
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    sys_free(exec_node->ops_priv);
+    return 0;
+}
+
+static int prerun_half(struct matmul_priv_info* priv_info, struct tensor* input_tensor1, struct exec_graph* exec_graph)
+{
+    int kernel = priv_info->half_kernel;
+    int m = priv_info->m;
+    int n = priv_info->n;
+    int k = priv_info->k;
+    int input_size = fc_half_get_input_size(kernel, m, n);
+
+    if (input_size > 0)
+    {
+        priv_info->input0_half = sys_malloc(input_size);
+
+        if (priv_info->input0_half == NULL)
+            return -1;
+    }
+
+    /* kept packed when resized */
+    if (priv_info->input1_half != NULL)
+        return 0;
+
+    priv_info->input1_half_size = fc_half_get_pack_size(kernel, k, n);
+    priv_info->input1_half = (uint16_t*)sys_malloc((size_t)priv_info->input1_half_size * priv_info->input1_num);
+
+    if (priv_info->input1_half == NULL)
+        return -1;
+
+    /* the columns of input1[n, k] are the channels of the fc weights, the fp32 input1 is kept as in fc */
+    for (int i = 0; i < priv_info->input1_num; i++)
+    {
+        float* input1 = (float*)input_tensor1->data + (size_t)i * n * k;
+        uint16_t* input1_half = priv_info->input1_half + (size_t)i * priv_info->input1_half_size / sizeof(uint16_t);
+
+        fc_half_pack(kernel, k, n, input1, 1, k, input1_half, exec_graph->num_thread);
+    }
+
+    return 0;
+}
+
+static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* input_tensor1 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct matmul_priv_info* priv_info = (struct matmul_priv_info*)exec_node->ops_priv;
+
+    if (set_matmul_shape(priv_info, input_tensor0, input_tensor1) < 0)
+    {
+        TLOG_ERR("hcl matmul: shape of input0 and input1 does not match\n");
+        return -1;
+    }
+
+    priv_info->input1_const = input_tensor1->tensor_type == TENSOR_TYPE_CONST;
+
+    if (priv_info->input1_const)
+        priv_info->half_kernel = fc_half_get_kernel(exec_graph->weight_mode);
+
+    if (priv_info->input1_const && priv_info->half_kernel != FC_HALF_NONE)
+        return prerun_half(priv_info, input_tensor1, exec_graph);
+
+    priv_info->input0_pack = (float*)sys_malloc(priv_info->input0_pack_size);
+
+    if (priv_info->input0_pack == NULL)
+        return -1;
+
+    /* kept packed when resized */
+    if (priv_info->input1_pack != NULL)
+        return 0;
+
+    int input1_num = priv_info->input1_const ? priv_info->input1_num : 1;
+
+    priv_info->input1_pack = (float*)sys_malloc((size_t)priv_info->input1_pack_size * input1_num);
+
+    if (priv_info->input1_pack == NULL)
+        return -1;
+
+    if (priv_info->input1_const)
+    {
+        int n = priv_info->n;
+        int k = priv_info->k;
+
+        for (int i = 0; i < input1_num; i++)
+        {
+            float* input1 = (float*)input_tensor1->data + (size_t)i * n * k;
+            float* input1_pack = priv_info->input1_pack + (size_t)i * priv_info->input1_pack_size / sizeof(float);
+
+            input_pack4_fp32(n, k, input1, input1_pack, exec_graph->num_thread);
+        }
+    }
+
+    return 0;
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* input_tensor1 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct matmul_priv_info* priv_info = (struct matmul_priv_info*)exec_node->ops_priv;
+    int num_thread = exec_graph->num_thread;
+
+    int m = priv_info->m;
+    int n = priv_info->n;
+    int k = priv_info->k;
+    int packed_index = -1;
+
+    if (priv_info->input1_half != NULL)
+    {
+        for (int b = 0; b < priv_info->batch; b++)
+        {
+            const float* input0 = (const float*)input_tensor0->data + (size_t)b * m * n;
+            float* output = (float*)output_tensor->data + (size_t)b * m * k;
+            int index = get_input1_index(priv_info, b);
+            const uint16_t* input1_half = priv_info->input1_half + (size_t)index * priv_info->input1_half_size / sizeof(uint16_t);
+
+            fc_half_run(priv_info->half_kernel, m, k, n, input0, input1_half, NULL, output, k, -1, priv_info->input0_half,
+                        num_thread);
+        }
+
+        return 0;
+    }
+
+    for (int b = 0; b < priv_info->batch; b++)
+    {
+        float* input0 = (float*)input_tensor0->data + (size_t)b * m * n;
+        float* output = (float*)output_tensor->data + (size_t)b * m * k;
+        float* input1_pack = priv_info->input1_pack;
+        int index = get_input1_index(priv_info, b);
+
+        if (priv_info->input1_const)
+        {
+            input1_pack += (size_t)index * priv_info->input1_pack_size / sizeof(float);
+        }
+        else if (index != packed_index)
+        {
+            /* a broadcast input1 is packed only once */
+            input_pack4_fp32(n, k, (float*)input_tensor1->data + (size_t)index * n * k, input1_pack, num_thread);
+            packed_index = index;
+        }
+
+        interleave_pack4_fp32(m, n, input0, priv_info->input0_pack);
+
+        sgemm_fp(m, k, n, priv_info->input0_pack, input1_pack, output, num_thread);
+    }
+
+    return 0;
+}
+
+static int resize(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct matmul_priv_info* priv_info = (struct matmul_priv_info*)exec_node->ops_priv;
+
+    if (priv_info->input0_pack)
+    {
+        sys_free(priv_info->input0_pack);
+        priv_info->input0_pack = NULL;
+    }
+
+    if (priv_info->input0_half)
+    {
+        sys_free(priv_info->input0_half);
+        priv_info->input0_half = NULL;
+    }
+
+    /* the const input1 never changes its shape */
+    if (!priv_info->input1_const && priv_info->input1_pack)
+    {
+        sys_free(priv_info->input1_pack);
+        priv_info->input1_pack = NULL;
+    }
+
+    return 0;
+}
+
+static int postrun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct matmul_priv_info* priv_info = (struct matmul_priv_info*)exec_node->ops_priv;
+
+    resize(node_ops, exec_node, exec_graph);
+
+    if (priv_info->input1_pack)
+    {
+        sys_free(priv_info->input1_pack);
+        priv_info->input1_pack = NULL;
+    }
+
+    if (priv_info->input1_half)
+    {
+        sys_free(priv_info->input1_half);
+        priv_info->input1_half = NULL;
+    }
+
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct node* ir_node = exec_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* input_tensor1 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct matmul_priv_info priv_info;
+
+    if (input_tensor0->data_type != TENGINE_DT_FP32 || input_tensor1->data_type != TENGINE_DT_FP32)
+        return 0;
+
+    if (set_matmul_shape(&priv_info, input_tensor0, input_tensor1) < 0)
+        return 0;
+
+    return OPS_SCORE_PREFER;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = prerun,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = postrun,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .resize = resize,
+                                       .isa = CPU_ISA_BUILD};
+
+int register_matmul_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_MATMUL, &hcl_node_ops);
+}
+
+int unregister_matmul_hcl_x86_op()
+{
+    unregister_builtin_node_ops(OP_MATMUL, &hcl_node_ops);
+    return 0;
+}
@@ -32,12 +32,37 @@
 #include "utility/float.h"
 #include "utility/sys_port.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
 #include <math.h>
 
+struct mish_job
+{
+    const float* input_data;
+    float* out_data;
+    int c_step;
+    int size;
+};
+
+static void mish_channel(void* arg, int begin, int end)
+{
+    struct mish_job* job = (struct mish_job*)arg;
+
+    for (int q = begin; q < end; q++)
+    {
+        const float* src = job->input_data + job->c_step * q;
+        float* dst = job->out_data + job->c_step * q;
+
+        for (int i = 0; i < job->size; i++)
+        {
+            dst[i] = src[i] * tanhf(log(1 + exp(src[i])));
+        }
+    }
+}
+
 int ref_mish_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
 {
     int w = input_tensor->dims[3];
@@ -46,20 +71,14 @@ int ref_mish_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int
     int size = h * w;
     int c_step = h * w;
 
-    float* input_data = (float*)input_tensor->data;
-    float* out_data = (float*)output_tensor->data;
+    struct mish_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int q = 0; q < channels; q++)
-    {
-        float* src = input_data + c_step * q;
-        float* dst = out_data + c_step * q;
+    job.input_data = (float*)input_tensor->data;
+    job.out_data = (float*)output_tensor->data;
+    job.c_step = c_step;
+    job.size = size;
 
-        for (int i = 0; i < size; i++)
-        {
-            dst[i] = src[i] * tanhf(log(1 + exp(src[i])));
-        }
-    }
+    parallel_for(mish_channel, &job, channels, num_thread);
 
     return 0;
 }
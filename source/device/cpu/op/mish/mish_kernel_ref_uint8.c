@@ -32,12 +32,37 @@
 #include "utility/float.h"
 #include "utility/sys_port.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
 #include <math.h>
 
+struct mish_job
+{
+    const float* input_data;
+    float* out_data;
+    int c_step;
+    int size;
+};
+
+static void mish_channel(void* arg, int begin, int end)
+{
+    struct mish_job* job = (struct mish_job*)arg;
+
+    for (int q = begin; q < end; q++)
+    {
+        const float* src = job->input_data + job->c_step * q;
+        float* dst = job->out_data + job->c_step * q;
+
+        for (int i = 0; i < job->size; i++)
+        {
+            dst[i] = src[i] * tanhf(log(1 + exp(src[i])));
+        }
+    }
+}
+
 int ref_mish_uint8(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
 {
     int w = input_tensor->dims[3];
@@ -63,20 +88,15 @@ int ref_mish_uint8(struct tensor* input_tensor, struct tensor* output_tensor, in
     for (int i = 0; i < total_size; i++)
         data_fp32[i] = ((float)input_uint8[i] - (float)input_zero) * input_scale;
 
-    for (int n = 0; n < batch; n++)
-    {
-#pragma omp parallel for num_threads(num_thread)
-        for (int q = 0; q < channels; q++)
-        {
-            float* src = data_fp32 + batch_step * n + c_step * q;
-            float* dst = data_fp32 + batch_step * n + c_step * q;
+    /* the channels of all the batches are contiguous */
+    struct mish_job job;
 
-            for (int i = 0; i < size; i++)
-            {
-                dst[i] = src[i] * tanhf(log(1 + exp(src[i])));
-            }
-        }
-    }
+    job.input_data = data_fp32;
+    job.out_data = data_fp32;
+    job.c_step = c_step;
+    job.size = size;
+
+    parallel_for(mish_channel, &job, batch * channels, num_thread);
 
     // quant
     for (int i = 0; i < total_size; i++)
@@ -127,7 +127,7 @@ static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struc
 
     int dims[4];
 
-    if (output_tensor->dims[1] != channel || output_tensor->dims[2] != output_h || output_tensor->dims[3] != output_w)
+    if (output_tensor->dims[0] != batch || output_tensor->dims[1] != channel || output_tensor->dims[2] != output_h || output_tensor->dims[3] != output_w)
     {
         dims[0] = batch;
         dims[1] = channel;
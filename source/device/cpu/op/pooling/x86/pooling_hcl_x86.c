@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "pooling_param.h"
+#include "pooling_kernel_x86.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/cpu.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct pool_param* pool_param = (struct pool_param*)ir_node->op.param_mem;
+
+    return pooling_kernel_x86_run(input_tensor, output_tensor, pool_param, exec_graph->num_thread);
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct node* ir_node = exec_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct pool_param* pool_param = (struct pool_param*)ir_node->op.param_mem;
+
+    int data_type = input_tensor->data_type;
+
+    if (data_type != TENGINE_DT_FP32 && data_type != TENGINE_DT_INT8 && data_type != TENGINE_DT_UINT8)
+        return 0;
+
+    if (input_tensor->dim_num != 4)
+        return 0;
+
+    /* the fp32 tensors may be in the blocked layout set by the pack() of the nodes */
+    int block = get_layout_channel_block(input_tensor->layout);
+
+    if (input_tensor->layout != TENGINE_LAYOUT_NCHW && (data_type != TENGINE_DT_FP32 || block != pooling_kernel_x86_get_block()))
+        return 0;
+
+    if (pool_param->pool_method != POOL_MAX && pool_param->pool_method != POOL_AVG)
+        return 0;
+
+    return OPS_SCORE_PREFER;
+}
+
+static int pack(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* ir_node)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct pool_param* pool_param = (struct pool_param*)ir_node->op.param_mem;
+
+    if (exec_graph->mode != TENGINE_MODE_FP32 || input_tensor->data_type != TENGINE_DT_FP32 || input_tensor->dim_num != 4)
+        return 0;
+
+    if (pool_param->pool_method != POOL_MAX && pool_param->pool_method != POOL_AVG)
+        return 0;
+
+    return pooling_kernel_x86_get_block();
+}
+
+static struct node_ops hcl_node_ops = {.prerun = NULL,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = NULL,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .isa = CPU_ISA_BUILD,
+                                       .pack = pack};
+
+int register_pooling_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_POOL, &hcl_node_ops);
+}
+
+int unregister_pooling_hcl_x86_op()
+{
+    unregister_builtin_node_ops(OP_POOL, &hcl_node_ops);
+    return 0;
+}
@@ -0,0 +1,761 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "pooling_kernel_x86.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/thread_pool.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __SSE4_1__
+#include <smmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+/*
+ * the outputs of a row whose windows are all inside the input width are computed by
+ * vectors, for the stride of 1 and 2. the others go through the same steps as the ref
+ * op, and the sums of the avg pooling are added in the same order, except the global
+ * pooling of fp32, which is reduced by vectors.
+ */
+struct pool_job
+{
+    const void* input;
+    void* output;
+    int data_type;
+    int method;
+    int caffe_flavor;
+
+    int in_h;
+    int in_w;
+    int out_h;
+    int out_w;
+    int kernel_h;
+    int kernel_w;
+    int stride_h;
+    int stride_w;
+    int pad_h;
+    int pad_w;
+
+    /* the fp32 tensors in the blocked layout */
+    int channel;
+    int block_num;
+    int in_blocked;
+    int out_blocked;
+
+    float input_scale;
+    float output_scale;
+    int input_zero;
+    int output_zero;
+
+    /* the dequantized uint8, the sums of them are not fused into fma, so the same as the ref op */
+    float uint8_table[256];
+};
+
+/* clip the window of an output to the input, returns its size counted for the avg pooling */
+static inline int get_pool_window(int o, int stride, int pad, int kernel, int in, int caffe_flavor, int* start,
+                                  int* end)
+{
+    int s = o * stride - pad;
+    int e = s + kernel;
+
+    if (e > in + pad)
+        e = in + pad;
+
+    int size = e - s;
+
+    s = max(s, 0);
+    e = min(e, in);
+
+    *start = s;
+    *end = e;
+
+    return caffe_flavor ? size : e - s;
+}
+
+/* the outputs from pw can be done by a vector of vec_num lanes, including the reads over the odd lane of stride 2 */
+static inline int is_pool_vector(const struct pool_job* job, int pw, int vec_num)
+{
+    int w_start = pw * job->stride_w - job->pad_w;
+    int w_last = (pw + vec_num - 1) * job->stride_w - job->pad_w + job->kernel_w + job->stride_w - 1;
+
+    return (job->stride_w == 1 || job->stride_w == 2) && pw + vec_num <= job->out_w && w_start >= 0
+           && w_last <= job->in_w;
+}
+
+#if __AVX__
+#define POOL_VEC_FP32 8
+
+static inline __m256 load_pool_fp32(const float* p, int stride)
+{
+    if (stride == 1)
+        return _mm256_loadu_ps(p);
+
+    __m256 a = _mm256_loadu_ps(p);
+    __m256 b = _mm256_loadu_ps(p + 8);
+    __m256 lo = _mm256_permute2f128_ps(a, b, 0x20);
+    __m256 hi = _mm256_permute2f128_ps(a, b, 0x31);
+
+    return _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline void pool_vector_fp32(const float* input, float* output, int in_w, int h_start, int h_end,
+                                    int kernel_w, int stride_w, int method, int pool_size)
+{
+    if (method == POOL_MAX)
+    {
+        __m256 _max = load_pool_fp32(input + h_start * in_w, stride_w);
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+                _max = _mm256_max_ps(_max, load_pool_fp32(input + i * in_w + j, stride_w));
+        }
+
+        _mm256_storeu_ps(output, _max);
+    }
+    else
+    {
+        __m256 _sum = _mm256_setzero_ps();
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+                _sum = _mm256_add_ps(_sum, load_pool_fp32(input + i * in_w + j, stride_w));
+        }
+
+        _mm256_storeu_ps(output, _mm256_div_ps(_sum, _mm256_set1_ps((float)pool_size)));
+    }
+}
+#elif __SSE2__
+#define POOL_VEC_FP32 4
+
+static inline __m128 load_pool_fp32(const float* p, int stride)
+{
+    if (stride == 1)
+        return _mm_loadu_ps(p);
+
+    return _mm_shuffle_ps(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline void pool_vector_fp32(const float* input, float* output, int in_w, int h_start, int h_end,
+                                    int kernel_w, int stride_w, int method, int pool_size)
+{
+    if (method == POOL_MAX)
+    {
+        __m128 _max = load_pool_fp32(input + h_start * in_w, stride_w);
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+                _max = _mm_max_ps(_max, load_pool_fp32(input + i * in_w + j, stride_w));
+        }
+
+        _mm_storeu_ps(output, _max);
+    }
+    else
+    {
+        __m128 _sum = _mm_setzero_ps();
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+                _sum = _mm_add_ps(_sum, load_pool_fp32(input + i * in_w + j, stride_w));
+        }
+
+        _mm_storeu_ps(output, _mm_div_ps(_sum, _mm_set1_ps((float)pool_size)));
+    }
+}
+#endif
+
+static inline float pool_point_fp32(const float* input, int in_w, int h_start, int h_end, int w_start, int w_end,
+                                    int method, int pool_size)
+{
+    if (method == POOL_MAX)
+    {
+        float _max = input[h_start * in_w + w_start];
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = w_start; j < w_end; j++)
+                _max = max(_max, input[i * in_w + j]);
+        }
+
+        return _max;
+    }
+
+    float sum = 0.f;
+
+    for (int i = h_start; i < h_end; i++)
+    {
+        for (int j = w_start; j < w_end; j++)
+            sum += input[i * in_w + j];
+    }
+
+    return sum / pool_size;
+}
+
+/* the kernel and stride are passed as constants for the common cases, so the inner loops are unrolled */
+static inline void pool_row_fp32(const struct pool_job* job, const float* input, float* output, int h_start,
+                                 int h_end, int h_size, int kernel_w, int stride_w)
+{
+    int pw = 0;
+
+    while (pw < job->out_w)
+    {
+#ifdef POOL_VEC_FP32
+        if (is_pool_vector(job, pw, POOL_VEC_FP32))
+        {
+            const float* input_w = input + pw * stride_w - job->pad_w;
+            pool_vector_fp32(input_w, output + pw, job->in_w, h_start, h_end, kernel_w, stride_w, job->method,
+                             h_size * kernel_w);
+            pw += POOL_VEC_FP32;
+            continue;
+        }
+#endif
+        int w_start, w_end;
+        int w_size = get_pool_window(pw, stride_w, job->pad_w, kernel_w, job->in_w, job->caffe_flavor, &w_start,
+                                     &w_end);
+
+        output[pw] = pool_point_fp32(input, job->in_w, h_start, h_end, w_start, w_end, job->method, h_size * w_size);
+        pw++;
+    }
+}
+
+static float pool_global_fp32(const float* input, int size, int method)
+{
+    int i = 0;
+    float result;
+
+    if (method == POOL_MAX)
+    {
+        result = input[0];
+#if __AVX__
+        if (size >= 8)
+        {
+            __m256 _max = _mm256_loadu_ps(input);
+            for (i = 8; i + 7 < size; i += 8)
+                _max = _mm256_max_ps(_max, _mm256_loadu_ps(input + i));
+
+            __m128 _max4 = _mm_max_ps(_mm256_castps256_ps128(_max), _mm256_extractf128_ps(_max, 1));
+            float buf[4];
+            _mm_storeu_ps(buf, _max4);
+            result = max(max(buf[0], buf[1]), max(buf[2], buf[3]));
+        }
+#endif
+        for (; i < size; i++)
+            result = max(result, input[i]);
+
+        return result;
+    }
+
+    result = 0.f;
+#if __AVX__
+    if (size >= 8)
+    {
+        __m256 _sum = _mm256_setzero_ps();
+        for (; i + 7 < size; i += 8)
+            _sum = _mm256_add_ps(_sum, _mm256_loadu_ps(input + i));
+
+        __m128 _sum4 = _mm_add_ps(_mm256_castps256_ps128(_sum), _mm256_extractf128_ps(_sum, 1));
+        float buf[4];
+        _mm_storeu_ps(buf, _sum4);
+        result = (buf[0] + buf[1]) + (buf[2] + buf[3]);
+    }
+#endif
+    for (; i < size; i++)
+        result += input[i];
+
+    return result / size;
+}
+
+static void pool_channel_fp32(const struct pool_job* job, const float* input, float* output)
+{
+    int kernel_w = job->kernel_w;
+    int stride_w = job->stride_w;
+
+    if (job->out_h == 1 && job->out_w == 1 && job->pad_h == 0 && job->pad_w == 0 && job->kernel_h == job->in_h
+        && kernel_w == job->in_w)
+    {
+        output[0] = pool_global_fp32(input, job->in_h * job->in_w, job->method);
+        return;
+    }
+
+    for (int ph = 0; ph < job->out_h; ph++)
+    {
+        int h_start, h_end;
+        int h_size = get_pool_window(ph, job->stride_h, job->pad_h, job->kernel_h, job->in_h, job->caffe_flavor,
+                                     &h_start, &h_end);
+        float* output_row = output + ph * job->out_w;
+
+        if (kernel_w == 2 && stride_w == 2)
+            pool_row_fp32(job, input, output_row, h_start, h_end, h_size, 2, 2);
+        else if (kernel_w == 3 && stride_w == 2)
+            pool_row_fp32(job, input, output_row, h_start, h_end, h_size, 3, 2);
+        else if (kernel_w == 3 && stride_w == 1)
+            pool_row_fp32(job, input, output_row, h_start, h_end, h_size, 3, 1);
+        else
+            pool_row_fp32(job, input, output_row, h_start, h_end, h_size, kernel_w, stride_w);
+    }
+}
+
+/*
+ * the int8 and uint8 outputs are rounded from the fp32 values got by the same float
+ * steps as the ref ops:
+ *   int8:  max * (input_scale / output_scale), sum * input_scale / pool_size / output_scale
+ *   uint8: (max - input_zero) * input_scale / output_scale,
+ *          the sum of the uint8_table of the input / pool_size / output_scale
+ */
+static inline int load_pool_quant(const void* input, int index, int data_type)
+{
+    if (data_type == TENGINE_DT_INT8)
+        return ((const int8_t*)input)[index];
+
+    return ((const uint8_t*)input)[index];
+}
+
+static inline float pool_point_quant(const struct pool_job* job, const void* input, int h_start, int h_end,
+                                     int w_start, int w_end, int pool_size)
+{
+    int in_w = job->in_w;
+    int data_type = job->data_type;
+
+    if (job->method == POOL_MAX)
+    {
+        int _max = load_pool_quant(input, h_start * in_w + w_start, data_type);
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = w_start; j < w_end; j++)
+                _max = max(_max, load_pool_quant(input, i * in_w + j, data_type));
+        }
+
+        if (data_type == TENGINE_DT_INT8)
+            return (float)_max * (job->input_scale / job->output_scale);
+
+        return (_max - job->input_zero) * job->input_scale / job->output_scale;
+    }
+
+    if (data_type == TENGINE_DT_INT8)
+    {
+        int sum = 0;
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = w_start; j < w_end; j++)
+                sum += load_pool_quant(input, i * in_w + j, data_type);
+        }
+
+        float sum_fp32 = sum * job->input_scale;
+        sum_fp32 = sum_fp32 / (float)pool_size;
+
+        return sum_fp32 / job->output_scale;
+    }
+
+    float sum = 0.f;
+
+    for (int i = h_start; i < h_end; i++)
+    {
+        for (int j = w_start; j < w_end; j++)
+            sum += job->uint8_table[load_pool_quant(input, i * in_w + j, data_type)];
+    }
+
+    return sum / pool_size / job->output_scale;
+}
+
+static inline void store_pool_quant(const struct pool_job* job, void* output, int index, float value)
+{
+    int32_t data_i32 = round(value);
+
+    if (job->data_type == TENGINE_DT_INT8)
+    {
+        ((int8_t*)output)[index] = (int8_t)min(max(data_i32, -127), 127);
+    }
+    else
+    {
+        data_i32 += job->output_zero;
+        ((uint8_t*)output)[index] = (uint8_t)min(max(data_i32, 0), 255);
+    }
+}
+
+#if __SSE4_1__
+#define POOL_VEC_QUANT 4
+
+/* 4 int8 or uint8 of stride 1 or 2 widened to int32 */
+static inline __m128i load_pool_quant4(const uint8_t* p, int stride, int data_type)
+{
+    __m128i _v;
+
+    if (stride == 1)
+    {
+        int32_t v;
+        memcpy(&v, p, sizeof(v));
+        _v = _mm_cvtsi32_si128(v);
+    }
+    else
+    {
+        _v = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)p),
+                              _mm_setr_epi8(0, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    }
+
+    return data_type == TENGINE_DT_INT8 ? _mm_cvtepi8_epi32(_v) : _mm_cvtepu8_epi32(_v);
+}
+
+static inline __m128 pool_vector_quant(const struct pool_job* job, const uint8_t* input, int h_start, int h_end,
+                                       int kernel_w, int stride_w, int pool_size)
+{
+    int in_w = job->in_w;
+    int data_type = job->data_type;
+
+    if (job->method == POOL_MAX)
+    {
+        __m128i _max = load_pool_quant4(input + h_start * in_w, stride_w, data_type);
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+                _max = _mm_max_epi32(_max, load_pool_quant4(input + i * in_w + j, stride_w, data_type));
+        }
+
+        if (data_type == TENGINE_DT_INT8)
+            return _mm_mul_ps(_mm_cvtepi32_ps(_max), _mm_set1_ps(job->input_scale / job->output_scale));
+
+        __m128 _v = _mm_cvtepi32_ps(_mm_sub_epi32(_max, _mm_set1_epi32(job->input_zero)));
+        _v = _mm_mul_ps(_v, _mm_set1_ps(job->input_scale));
+
+        return _mm_div_ps(_v, _mm_set1_ps(job->output_scale));
+    }
+
+    if (data_type == TENGINE_DT_INT8)
+    {
+        __m128i _sum = _mm_setzero_si128();
+
+        for (int i = h_start; i < h_end; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+                _sum = _mm_add_epi32(_sum, load_pool_quant4(input + i * in_w + j, stride_w, data_type));
+        }
+
+        __m128 _v = _mm_mul_ps(_mm_cvtepi32_ps(_sum), _mm_set1_ps(job->input_scale));
+        _v = _mm_div_ps(_v, _mm_set1_ps((float)pool_size));
+
+        return _mm_div_ps(_v, _mm_set1_ps(job->output_scale));
+    }
+
+    const float* table = job->uint8_table;
+    __m128 _sum = _mm_setzero_ps();
+
+    for (int i = h_start; i < h_end; i++)
+    {
+        for (int j = 0; j < kernel_w; j++)
+        {
+            const uint8_t* p = input + i * in_w + j;
+            __m128 _v = _mm_setr_ps(table[p[0]], table[p[stride_w]], table[p[2 * stride_w]], table[p[3 * stride_w]]);
+            _sum = _mm_add_ps(_sum, _v);
+        }
+    }
+
+    _sum = _mm_div_ps(_sum, _mm_set1_ps((float)pool_size));
+
+    return _mm_div_ps(_sum, _mm_set1_ps(job->output_scale));
+}
+
+/* rounded half away from zero as round() */
+static inline void store_pool_quant4(const struct pool_job* job, uint8_t* output, __m128 _v)
+{
+    __m128 _sign = _mm_set1_ps(-0.f);
+    __m128 _t = _mm_round_ps(_v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m128 _half = _mm_cmpge_ps(_mm_andnot_ps(_sign, _mm_sub_ps(_v, _t)), _mm_set1_ps(0.5f));
+    __m128 _one = _mm_or_ps(_mm_and_ps(_v, _sign), _mm_set1_ps(1.f));
+
+    __m128i _i = _mm_cvttps_epi32(_mm_add_ps(_t, _mm_and_ps(_half, _one)));
+    __m128i _i16;
+
+    if (job->data_type == TENGINE_DT_INT8)
+    {
+        _i = _mm_min_epi32(_mm_max_epi32(_i, _mm_set1_epi32(-127)), _mm_set1_epi32(127));
+        _i16 = _mm_packs_epi32(_i, _i);
+        _i = _mm_packs_epi16(_i16, _i16);
+    }
+    else
+    {
+        _i16 = _mm_packs_epi32(_mm_add_epi32(_i, _mm_set1_epi32(job->output_zero)), _i);
+        _i = _mm_packus_epi16(_i16, _i16);
+    }
+
+    int32_t v = _mm_cvtsi128_si32(_i);
+    memcpy(output, &v, sizeof(v));
+}
+#endif
+
+static inline void pool_row_quant(const struct pool_job* job, const void* input, void* output, int h_start,
+                                  int h_end, int h_size, int kernel_w, int stride_w)
+{
+    int pw = 0;
+
+    while (pw < job->out_w)
+    {
+#ifdef POOL_VEC_QUANT
+        if (is_pool_vector(job, pw, POOL_VEC_QUANT))
+        {
+            const uint8_t* input_w = (const uint8_t*)input + pw * stride_w - job->pad_w;
+            __m128 _v = pool_vector_quant(job, input_w, h_start, h_end, kernel_w, stride_w, h_size * kernel_w);
+
+            store_pool_quant4(job, (uint8_t*)output + pw, _v);
+            pw += POOL_VEC_QUANT;
+            continue;
+        }
+#endif
+        int w_start, w_end;
+        int w_size = get_pool_window(pw, stride_w, job->pad_w, kernel_w, job->in_w, job->caffe_flavor, &w_start,
+                                     &w_end);
+
+        store_pool_quant(job, output, pw, pool_point_quant(job, input, h_start, h_end, w_start, w_end, h_size * w_size));
+        pw++;
+    }
+}
+
+static void pool_channel_quant(const struct pool_job* job, const void* input, void* output)
+{
+    int kernel_w = job->kernel_w;
+    int stride_w = job->stride_w;
+
+    for (int ph = 0; ph < job->out_h; ph++)
+    {
+        int h_start, h_end;
+        int h_size = get_pool_window(ph, job->stride_h, job->pad_h, job->kernel_h, job->in_h, job->caffe_flavor,
+                                     &h_start, &h_end);
+        void* output_row = (uint8_t*)output + ph * job->out_w;
+
+        if (kernel_w == 2 && stride_w == 2)
+            pool_row_quant(job, input, output_row, h_start, h_end, h_size, 2, 2);
+        else if (kernel_w == 3 && stride_w == 2)
+            pool_row_quant(job, input, output_row, h_start, h_end, h_size, 3, 2);
+        else if (kernel_w == 3 && stride_w == 1)
+            pool_row_quant(job, input, output_row, h_start, h_end, h_size, 3, 1);
+        else
+            pool_row_quant(job, input, output_row, h_start, h_end, h_size, kernel_w, stride_w);
+    }
+}
+
+#if __AVX__
+#define POOL_BLOCK 8
+
+/* the 8 channels of a block at a pixel of an image, gathered from the plain input with the padded channels of 0 */
+static inline __m256 load_pool_block(const struct pool_job* job, const float* input, int b, int index)
+{
+    int in_size = job->in_h * job->in_w;
+
+    if (job->in_blocked)
+        return _mm256_loadu_ps(input + ((size_t)b * in_size + index) * POOL_BLOCK);
+
+    float buf[POOL_BLOCK] = {0.f};
+    int lanes = min(job->channel - b * POOL_BLOCK, POOL_BLOCK);
+
+    for (int l = 0; l < lanes; l++)
+        buf[l] = input[(size_t)(b * POOL_BLOCK + l) * in_size + index];
+
+    return _mm256_loadu_ps(buf);
+}
+
+static inline void store_pool_block(const struct pool_job* job, float* output, int b, int index, __m256 _v)
+{
+    int out_size = job->out_h * job->out_w;
+
+    if (job->out_blocked)
+    {
+        _mm256_storeu_ps(output + ((size_t)b * out_size + index) * POOL_BLOCK, _v);
+        return;
+    }
+
+    float buf[POOL_BLOCK];
+    int lanes = min(job->channel - b * POOL_BLOCK, POOL_BLOCK);
+
+    _mm256_storeu_ps(buf, _v);
+
+    for (int l = 0; l < lanes; l++)
+        output[(size_t)(b * POOL_BLOCK + l) * out_size + index] = buf[l];
+}
+
+/* a task is a channel block of an image, each lane goes through the same steps as the ref op, the global pooling too */
+static void pool_block(void* arg, int begin, int end)
+{
+    const struct pool_job* job = (const struct pool_job*)arg;
+    size_t in_image = (size_t)(job->in_blocked ? job->block_num * POOL_BLOCK : job->channel) * job->in_h * job->in_w;
+    size_t out_image = (size_t)(job->out_blocked ? job->block_num * POOL_BLOCK : job->channel) * job->out_h * job->out_w;
+
+    for (int q = begin; q < end; q++)
+    {
+        int n = q / job->block_num;
+        int b = q % job->block_num;
+        const float* input = (const float*)job->input + n * in_image;
+        float* output = (float*)job->output + n * out_image;
+
+        for (int ph = 0; ph < job->out_h; ph++)
+        {
+            int h_start, h_end;
+            int h_size = get_pool_window(ph, job->stride_h, job->pad_h, job->kernel_h, job->in_h, job->caffe_flavor,
+                                         &h_start, &h_end);
+
+            for (int pw = 0; pw < job->out_w; pw++)
+            {
+                int w_start, w_end;
+                int w_size = get_pool_window(pw, job->stride_w, job->pad_w, job->kernel_w, job->in_w,
+                                             job->caffe_flavor, &w_start, &w_end);
+                __m256 _v;
+
+                if (job->method == POOL_MAX)
+                {
+                    _v = load_pool_block(job, input, b, h_start * job->in_w + w_start);
+
+                    for (int i = h_start; i < h_end; i++)
+                    {
+                        for (int j = w_start; j < w_end; j++)
+                            _v = _mm256_max_ps(_v, load_pool_block(job, input, b, i * job->in_w + j));
+                    }
+                }
+                else
+                {
+                    _v = _mm256_setzero_ps();
+
+                    for (int i = h_start; i < h_end; i++)
+                    {
+                        for (int j = w_start; j < w_end; j++)
+                            _v = _mm256_add_ps(_v, load_pool_block(job, input, b, i * job->in_w + j));
+                    }
+
+                    _v = _mm256_div_ps(_v, _mm256_set1_ps((float)(h_size * w_size)));
+                }
+
+                store_pool_block(job, output, b, ph * job->out_w + pw, _v);
+            }
+        }
+    }
+}
+#endif
+
+int pooling_kernel_x86_get_block(void)
+{
+#if __AVX__
+    return POOL_BLOCK;
+#else
+    return 0;
+#endif
+}
+
+static void pool_channel(void* arg, int begin, int end)
+{
+    const struct pool_job* job = (const struct pool_job*)arg;
+    int in_size = job->in_h * job->in_w;
+    int out_size = job->out_h * job->out_w;
+
+    for (int q = begin; q < end; q++)
+    {
+        if (job->data_type == TENGINE_DT_FP32)
+        {
+            pool_channel_fp32(job, (const float*)job->input + (size_t)q * in_size,
+                              (float*)job->output + (size_t)q * out_size);
+        }
+        else
+        {
+            pool_channel_quant(job, (const uint8_t*)job->input + (size_t)q * in_size,
+                               (uint8_t*)job->output + (size_t)q * out_size);
+        }
+    }
+}
+
+int pooling_kernel_x86_run(struct tensor* input_tensor, struct tensor* output_tensor, struct pool_param* param,
+                           int num_thread)
+{
+    struct pool_job job;
+
+    job.input = input_tensor->data;
+    job.output = output_tensor->data;
+    job.data_type = input_tensor->data_type;
+    job.method = param->pool_method;
+    job.caffe_flavor = param->caffe_flavor;
+
+    job.in_h = input_tensor->dims[2];
+    job.in_w = input_tensor->dims[3];
+    job.out_h = output_tensor->dims[2];
+    job.out_w = output_tensor->dims[3];
+    job.kernel_h = param->kernel_h;
+    job.kernel_w = param->kernel_w;
+    job.stride_h = param->stride_h;
+    job.stride_w = param->stride_w;
+    job.pad_h = param->pad_h0;
+    job.pad_w = param->pad_w0;
+
+    job.channel = input_tensor->dims[1];
+    job.block_num = 1;
+    job.in_blocked = get_layout_channel_block(input_tensor->layout) > 1;
+    job.out_blocked = get_layout_channel_block(output_tensor->layout) > 1;
+
+    job.input_scale = input_tensor->scale;
+    job.output_scale = output_tensor->scale;
+    job.input_zero = input_tensor->zero_point;
+    job.output_zero = output_tensor->zero_point;
+
+    if (job.data_type == TENGINE_DT_UINT8)
+    {
+        for (int i = 0; i < 256; i++)
+            job.uint8_table[i] = (i - job.input_zero) * job.input_scale;
+    }
+
+    if (job.method != POOL_MAX && job.method != POOL_AVG)
+    {
+        TLOG_ERR("hcl pooling: method %d not to be supported\n", job.method);
+        return -1;
+    }
+
+    if (job.in_blocked || job.out_blocked)
+    {
+#if __AVX__
+        job.block_num = (job.channel + POOL_BLOCK - 1) / POOL_BLOCK;
+        parallel_for(pool_block, &job, input_tensor->dims[0] * job.block_num, num_thread);
+        return 0;
+#else
+        TLOG_ERR("hcl pooling: blocked layout not to be supported\n");
+        return -1;
+#endif
+    }
+
+    parallel_for(pool_channel, &job, input_tensor->dims[0] * input_tensor->dims[1], num_thread);
+
+    return 0;
+}
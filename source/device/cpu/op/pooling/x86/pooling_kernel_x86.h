@@ -0,0 +1,43 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef _POOLING_KERNEL_X86_H_
+#define _POOLING_KERNEL_X86_H_
+
+#include "pooling_param.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+
+/* the channel block of the blocked layout of fp32 the kernel reads and writes, 0 for none */
+int pooling_kernel_x86_get_block(void);
+
+/*
+ * the input of fp32, int8 or uint8 in nchw, the results are the same as the ref op but the global avg of fp32.
+ * the fp32 input and output can be in the blocked layout as well, then the results are the same as the ref op.
+ */
+int pooling_kernel_x86_run(struct tensor* input_tensor, struct tensor* output_tensor, struct pool_param* param,
+                           int num_thread);
+
+#endif
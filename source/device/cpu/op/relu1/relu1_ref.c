@@ -28,28 +28,29 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
-int ref_relu1_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
+struct relu1_job
 {
-    int w = input_tensor->dims[3];
-    int h = output_tensor->dims[2];
-    int channels = input_tensor->dims[1];
-    int size = h * w;
-    int c_step = h * w;
+    const float* input_data;
+    float* out_data;
+    int c_step;
+    int size;
+};
 
-    float* input_data = (float*)input_tensor->data;
-    float* out_data = (float*)output_tensor->data;
+static void relu1_channel(void* arg, int begin, int end)
+{
+    struct relu1_job* job = (struct relu1_job*)arg;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int q = 0; q < channels; q++)
+    for (int q = begin; q < end; q++)
     {
-        float* src = input_data + c_step * q;
-        float* dst = out_data + c_step * q;
+        const float* src = job->input_data + job->c_step * q;
+        float* dst = job->out_data + job->c_step * q;
 
-        for (int i = 0; i < size; i++)
+        for (int i = 0; i < job->size; i++)
         {
             dst[i] = src[i];
             if (dst[i] > 1)
@@ -58,6 +59,24 @@ int ref_relu1_fp32(struct tensor* input_tensor, struct tensor* output_tensor, in
                 dst[i] = -1;
         }
     }
+}
+
+int ref_relu1_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
+{
+    int w = input_tensor->dims[3];
+    int h = output_tensor->dims[2];
+    int channels = input_tensor->dims[1];
+    int size = h * w;
+    int c_step = h * w;
+
+    struct relu1_job job;
+
+    job.input_data = (float*)input_tensor->data;
+    job.out_data = (float*)output_tensor->data;
+    job.c_step = c_step;
+    job.size = size;
+
+    parallel_for(relu1_channel, &job, channels, num_thread);
 
     return 0;
 }
@@ -28,12 +28,41 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
 #include <math.h>
 
+struct relu6_job
+{
+    const float* input_data;
+    float* out_data;
+    int c_step;
+    int size;
+};
+
+static void relu6_channel(void* arg, int begin, int end)
+{
+    struct relu6_job* job = (struct relu6_job*)arg;
+
+    for (int q = begin; q < end; q++)
+    {
+        const float* src = job->input_data + job->c_step * q;
+        float* dst = job->out_data + job->c_step * q;
+
+        for (int i = 0; i < job->size; i++)
+        {
+            dst[i] = src[i];
+            if (dst[i] > 6)
+                dst[i] = 6;
+            if (dst[i] < 0)
+                dst[i] = 0;
+        }
+    }
+}
+
 int ref_relu6_uint8(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
 {
     int w = input_tensor->dims[3];
@@ -59,24 +88,15 @@ int ref_relu6_uint8(struct tensor* input_tensor, struct tensor* output_tensor, i
     for (int i = 0; i < total_size; i++)
         data_fp32[i] = ((float)input_uint8[i] - (float)input_zero) * input_scale;
 
-    for (int n = 0; n < batch; n++)
-    {
-        //#pragma omp parallel for num_threads(num_thread)
-        for (int q = 0; q < channels; q++)
-        {
-            float* src = data_fp32 + batch_step * n + c_step * q;
-            float* dst = data_fp32 + batch_step * n + c_step * q;
-
-            for (int i = 0; i < size; i++)
-            {
-                dst[i] = src[i];
-                if (src[i] > 6)
-                    dst[i] = 6;
-                else if (src[i] < 0)
-                    dst[i] = 0;
-            }
-        }
-    }
+    /* the channels of all the batches are contiguous */
+    struct relu6_job job;
+
+    job.input_data = data_fp32;
+    job.out_data = data_fp32;
+    job.c_step = c_step;
+    job.size = size;
+
+    parallel_for(relu6_channel, &job, batch * channels, num_thread);
 
     // quant
     for (int i = 0; i < total_size; i++)
@@ -100,24 +120,14 @@ int ref_relu6_fp32(struct tensor* input_tensor, struct tensor* output_tensor, in
     int size = h * w;
     int c_step = h * w;
 
-    float* input_data = (float*)input_tensor->data;
-    float* out_data = (float*)output_tensor->data;
+    struct relu6_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int q = 0; q < channels; q++)
-    {
-        float* src = input_data + c_step * q;
-        float* dst = out_data + c_step * q;
+    job.input_data = (float*)input_tensor->data;
+    job.out_data = (float*)output_tensor->data;
+    job.c_step = c_step;
+    job.size = size;
 
-        for (int i = 0; i < size; i++)
-        {
-            dst[i] = src[i];
-            if (dst[i] > 6)
-                dst[i] = 6;
-            if (dst[i] < 0)
-                dst[i] = 0;
-        }
-    }
+    parallel_for(relu6_channel, &job, channels, num_thread);
 
     return 0;
 }
@@ -326,6 +326,26 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     return 0;
 }
 
+/* the output is the input in another shape, but for the transpose of the models in nhwc */
+static int view_output(struct node_ops* node_ops, struct exec_node* exec_node, int output_slot, size_t* offset)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    if (ir_graph->model_layout == TENGINE_LAYOUT_NHWC && input_tensor->dim_num == 4 && output_tensor->dim_num >= 2
+        && output_tensor->dim_num <= 4)
+        return -1;
+
+    if (!can_view_ir_tensor(input_tensor, output_tensor) || input_tensor->elem_num != output_tensor->elem_num)
+        return -1;
+
+    *offset = 0;
+
+    return 0;
+}
+
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
     return OPS_SCORE_BEST;
@@ -337,7 +357,8 @@ static struct node_ops reshape_node_ops = {.prerun = NULL,
                                            .postrun = NULL,
                                            .init_node = init_node,
                                            .release_node = release_node,
-                                           .score = score};
+                                           .score = score,
+                                           .view_output = view_output};
 
 int register_reshape_ref_op()
 {
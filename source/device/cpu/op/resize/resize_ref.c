@@ -49,8 +49,16 @@ static void bilinear_resize(float* inp, float* output, int h, int w, int c, floa
         float fy = (j + 0.5) * scale_y - 0.5;
         int sy = floor(fy);
         fy -= sy;
-        sy = T_MIN(sy, h - 2);
-        sy = T_MAX(0, sy);
+        if (sy < 0)
+        {
+            sy = 0;
+            fy = 0.f;
+        }
+        if (sy >= h - 1)
+        {
+            sy = h - 2;
+            fy = 1.f;
+        }
         float fy_0 = 1.f - fy;
 
         for (int i = 0; i < ow; i++)
@@ -65,7 +73,7 @@ static void bilinear_resize(float* inp, float* output, int h, int w, int c, floa
             }
             if (sx >= w - 1)
             {
-                fx = 0;
+                fx = 1.f;
                 sx = w - 2;
             }
             float fx_0 = 1.f - fx;
@@ -84,7 +92,7 @@ static void bilinear_resize_int8(struct tensor* input_tensor, struct tensor* out
 {
     int h = input_tensor->dims[2];
     int w = input_tensor->dims[3];
-    int c = input_tensor->dims[1];
+    int c = input_tensor->dims[0] * input_tensor->dims[1];
     int oh = output_tensor->dims[2];
     int ow = output_tensor->dims[3];
     int out_hw = oh * ow;
@@ -113,8 +121,16 @@ static void bilinear_resize_int8(struct tensor* input_tensor, struct tensor* out
         float fy = (j + 0.5) * scale_y - 0.5;
         int sy = floor(fy);
         fy -= sy;
-        sy = T_MIN(sy, h - 2);
-        sy = T_MAX(0, sy);
+        if (sy < 0)
+        {
+            sy = 0;
+            fy = 0.f;
+        }
+        if (sy >= h - 1)
+        {
+            sy = h - 2;
+            fy = 1.f;
+        }
         float fy_0 = 1.f - fy;
 
         for (int i = 0; i < ow; i++)
@@ -129,7 +145,7 @@ static void bilinear_resize_int8(struct tensor* input_tensor, struct tensor* out
             }
             if (sx >= w - 1)
             {
-                fx = 0;
+                fx = 1.f;
                 sx = w - 2;
             }
             float fx_0 = 1.f - fx;
@@ -162,7 +178,7 @@ static void bilinear_resize_uint8(struct tensor* input_tensor, struct tensor* ou
 {
     int h = input_tensor->dims[2];
     int w = input_tensor->dims[3];
-    int c = input_tensor->dims[1];
+    int c = input_tensor->dims[0] * input_tensor->dims[1];
     int oh = output_tensor->dims[2];
     int ow = output_tensor->dims[3];
     int out_hw = oh * ow;
@@ -191,8 +207,16 @@ static void bilinear_resize_uint8(struct tensor* input_tensor, struct tensor* ou
         float fy = (j + 0.5) * scale_y - 0.5;
         int sy = floor(fy);
         fy -= sy;
-        sy = T_MIN(sy, h - 2);
-        sy = T_MAX(0, sy);
+        if (sy < 0)
+        {
+            sy = 0;
+            fy = 0.f;
+        }
+        if (sy >= h - 1)
+        {
+            sy = h - 2;
+            fy = 1.f;
+        }
         float fy_0 = 1.f - fy;
 
         for (int i = 0; i < ow; i++)
@@ -207,7 +231,7 @@ static void bilinear_resize_uint8(struct tensor* input_tensor, struct tensor* ou
             }
             if (sx >= w - 1)
             {
-                fx = 0;
+                fx = 1.f;
                 sx = w - 2;
             }
             float fx_0 = 1.f - fx;
@@ -263,7 +287,7 @@ static void nearest_neighbor_resize_int8(struct tensor* input_tensor, struct ten
     int h = input_tensor->dims[2];
     int w = input_tensor->dims[3];
     int c_start = 0;
-    int c_end = input_tensor->dims[1];
+    int c_end = input_tensor->dims[0] * input_tensor->dims[1];
     int oh = output_tensor->dims[2];
     int ow = output_tensor->dims[3];
 
@@ -324,7 +348,7 @@ static void nearest_neighbor_resize_uint8(struct tensor* input_tensor, struct te
     int h = input_tensor->dims[2];
     int w = input_tensor->dims[3];
     int c_start = 0;
-    int c_end = input_tensor->dims[1];
+    int c_end = input_tensor->dims[0] * input_tensor->dims[1];
     int oh = output_tensor->dims[2];
     int ow = output_tensor->dims[3];
 
@@ -432,8 +456,8 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
             {
                 bilinear_resize(input, output, input_tensor->dims[2], input_tensor->dims[3], input_tensor->dims[1], scale_x,
                                 scale_y, output_tensor->dims[2], output_tensor->dims[3]);
-                input_tensor += in_chw;
-                output_tensor += out_chw;
+                input += in_chw;
+                output += out_chw;
             }
         }
     }
@@ -441,42 +465,22 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     {
         if (resize_param->type == 0)
         {
-            for (int i = 0; i < input_tensor->dims[0]; i++)
-            {
-                nearest_neighbor_resize_int8(input_tensor, output_tensor, scale_x, scale_y);
-                input += in_chw;
-                output += out_chw;
-            }
+            nearest_neighbor_resize_int8(input_tensor, output_tensor, scale_x, scale_y);
         }
         else
         {
-            for (int i = 0; i < input_tensor->dims[0]; i++)
-            {
-                bilinear_resize_int8(input_tensor, output_tensor, scale_x, scale_y);
-                input_tensor += in_chw;
-                output_tensor += out_chw;
-            }
+            bilinear_resize_int8(input_tensor, output_tensor, scale_x, scale_y);
         }
     }
     else if (input_tensor->data_type == TENGINE_DT_UINT8)
     {
         if (resize_param->type == 0)
         {
-            for (int i = 0; i < input_tensor->dims[0]; i++)
-            {
-                nearest_neighbor_resize_uint8(input_tensor, output_tensor, scale_x, scale_y);
-                input += in_chw;
-                output += out_chw;
-            }
+            nearest_neighbor_resize_uint8(input_tensor, output_tensor, scale_x, scale_y);
         }
         else
         {
-            for (int i = 0; i < input_tensor->dims[0]; i++)
-            {
-                bilinear_resize_uint8(input_tensor, output_tensor, scale_x, scale_y);
-                input_tensor += in_chw;
-                output_tensor += out_chw;
-            }
+            bilinear_resize_uint8(input_tensor, output_tensor, scale_x, scale_y);
         }
     }
     else
@@ -487,7 +491,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
-    return OPS_SCORE_BEST;
+    return OPS_SCORE_CANDO;
 }
 
 static struct node_ops hcl_node_ops = {.prerun = prerun,
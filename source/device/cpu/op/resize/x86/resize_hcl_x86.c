@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "resize_param.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/cpu.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+#include "device/cpu/op/interp/x86/interp_kernel_x86.h"
+
+#include <string.h>
+
+/* type 0 nearest, the others bilinear, the input coordinate is of 1 / scale as the ref op */
+static int init_table(struct interp_x86_table* table, struct node* ir_node)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct resize_param* param = (struct resize_param*)ir_node->op.param_mem;
+
+    if (ir_graph->graph_layout != TENGINE_LAYOUT_NCHW || input_tensor->data_type != TENGINE_DT_FP32
+        || input_tensor->dim_num != 4 || output_tensor->dim_num != 4)
+        return -1;
+
+    if (input_tensor->dims[0] != output_tensor->dims[0] || input_tensor->dims[1] != output_tensor->dims[1])
+        return -1;
+
+    if (param->scale_h <= 0.f || param->scale_w <= 0.f)
+        return -1;
+
+    int type = param->type == 0 ? INTERP_X86_NEAREST : INTERP_X86_LINEAR;
+
+    return interp_x86_init_table(table, type, 0, input_tensor->dims[2], input_tensor->dims[3], output_tensor->dims[2],
+                                 output_tensor->dims[3], 1.f / param->scale_h, 1.f / param->scale_w);
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct interp_x86_table* table = (struct interp_x86_table*)sys_malloc(sizeof(struct interp_x86_table));
+    if (table == NULL)
+        return -1;
+
+    memset(table, 0, sizeof(struct interp_x86_table));
+    exec_node->ops_priv = table;
+
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    sys_free(exec_node->ops_priv);
+    return 0;
+}
+
+static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct interp_x86_table* table = (struct interp_x86_table*)exec_node->ops_priv;
+
+    interp_x86_release_table(table);
+
+    if (init_table(table, ir_node) < 0)
+    {
+        TLOG_ERR("resize x86 op does not support node %d\n", ir_node->index);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int postrun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    interp_x86_release_table((struct interp_x86_table*)exec_node->ops_priv);
+    return 0;
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct interp_x86_table* table = (struct interp_x86_table*)exec_node->ops_priv;
+
+    int plane_num = input_tensor->dims[0] * input_tensor->dims[1];
+
+    interp_x86_run(table, (const float*)input_tensor->data, (float*)output_tensor->data, plane_num,
+                   exec_graph->num_thread);
+
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct interp_x86_table table;
+
+    if (init_table(&table, exec_node) < 0)
+        return 0;
+
+    interp_x86_release_table(&table);
+
+    return OPS_SCORE_PREFER;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = prerun,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = postrun,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .isa = CPU_ISA_BUILD};
+
+int register_resize_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_RESIZE, &hcl_node_ops);
+}
+
+int unregister_resize_hcl_x86_op()
+{
+    return unregister_builtin_node_ops(OP_RESIZE, &hcl_node_ops);
+}
@@ -34,6 +34,8 @@
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
+#include "device/cpu/op/detection_output/nms_kernel_ref.h"
+#include "device/cpu/op/topkv2/topk_kernel_ref.h"
 
 #include <math.h>
 #include <string.h>
@@ -147,74 +149,6 @@ static inline void ref_filter_boxes(struct RPN_Box* boxes, const float* featmap,
     *num_boxes = num;
 }
 
-void sort_rpn_boxes_by_score(struct RPN_Box* boxes, int size)
-{
-    int i, j;
-    for (i = 0; i < size - 1; i++)
-    {
-        int max_idx = i;
-        for (j = i + 1; j < size; j++)
-        {
-            if (boxes[max_idx].score < boxes[j].score)
-                max_idx = j;
-        }
-        if (i != max_idx)
-        {
-            struct RPN_Box tmp;
-            memcpy(&tmp, boxes + i, sizeof(struct RPN_Box));
-            memcpy(boxes + i, boxes + max_idx, sizeof(struct RPN_Box));
-            memcpy(boxes + max_idx, &tmp, sizeof(struct RPN_Box));
-        }
-    }
-}
-
-void nms_rpn_boxes(struct RPN_Box* input_boxes, int* size, float nms_thresh)
-{
-    int input_size = *size;
-    int output_size = 0;
-
-    struct RPN_Box* output_boxes = (struct RPN_Box*)sys_malloc(sizeof(struct RPN_Box) * input_size);
-    float* areas = (float*)sys_malloc(sizeof(float) * input_size);
-    int* picked = (int*)sys_malloc(sizeof(int) * input_size);
-
-    for (int i = 0; i < input_size; ++i)
-    {
-        areas[i] = (input_boxes[i].x1 - input_boxes[i].x0 + 1) * (input_boxes[i].y1 - input_boxes[i].y0 + 1);
-    }
-    for (int i = 0; i < input_size; ++i)
-    {
-        int keep = 1;
-        for (int j = 0; j < output_size; j++)
-        {
-            float xx1 = RPN_MAX(input_boxes[i].x0, output_boxes[j].x0);
-            float yy1 = RPN_MAX(input_boxes[i].y0, output_boxes[j].y0);
-            float xx2 = RPN_MIN(input_boxes[i].x1, output_boxes[j].x1);
-            float yy2 = RPN_MIN(input_boxes[i].y1, output_boxes[j].y1);
-            float w = RPN_MAX(0.f, xx2 - xx1 + 1);
-            float h = RPN_MAX(0.f, yy2 - yy1 + 1);
-            float inter = w * h;
-            float ovr = inter / (areas[i] + areas[picked[j]] - inter);
-
-            if (ovr >= nms_thresh)
-            {
-                keep = 0;
-                break;
-            }
-        }
-        if (keep)
-        {
-            memcpy(output_boxes + output_size, input_boxes + i, sizeof(struct RPN_Box));
-            picked[output_size] = i;
-            output_size++;
-        }
-    }
-    memcpy(input_boxes, output_boxes, output_size * sizeof(struct RPN_Box));
-    *size = output_size;
-    sys_free(picked);
-    sys_free(areas);
-    sys_free(output_boxes);
-}
-
 void ref_proposal_local_anchor(int feat_height, int feat_width, int feat_stride, struct vector* anchors,
                                float* local_anchors)
 {
@@ -234,7 +168,8 @@ void ref_proposal_local_anchor(int feat_height, int feat_width, int feat_stride,
     }
 }
 
-int ref_rpn_fp32(const float* score, float* featmap, float* anchors, float* output, struct rpn_param_ref* param)
+int ref_rpn_fp32(const float* score, float* featmap, float* anchors, float* output, struct rpn_param_ref* param,
+                 int num_thread)
 {
     if (score == NULL || featmap == NULL || anchors == NULL || output == NULL)
         return -1;
@@ -248,31 +183,54 @@ int ref_rpn_fp32(const float* score, float* featmap, float* anchors, float* outp
     int num_boxes = 0;
     ref_filter_boxes(boxes, featmap, score, &num_boxes, param);
 
-    sort_rpn_boxes_by_score(boxes, num_boxes);
+    /* the per_nms_topn best boxes in order */
+    int top = param->per_nms_topn > 0 ? RPN_MIN(param->per_nms_topn, num_boxes) : num_boxes;
 
-    if (param->per_nms_topn > 0)
+    struct topk_pair* pairs = (struct topk_pair*)sys_malloc(num_boxes * sizeof(struct topk_pair) + 1);
+    struct RPN_Box* sorted_boxes = (struct RPN_Box*)sys_malloc(top * sizeof(struct RPN_Box) + 1);
+    int* keep = (int*)sys_malloc(top * sizeof(int) + 1);
+
+    if (pairs == NULL || sorted_boxes == NULL || keep == NULL)
     {
-        num_boxes = RPN_MIN(param->per_nms_topn, num_boxes);
+        sys_free(boxes);
+        sys_free(pairs);
+        sys_free(sorted_boxes);
+        sys_free(keep);
+        return -1;
     }
-    nms_rpn_boxes(boxes, &num_boxes, param->nms_thresh);
 
-    if (param->post_nms_topn > 0)
+    for (int i = 0; i < num_boxes; i++)
     {
-        num_boxes = RPN_MIN(param->post_nms_topn, num_boxes);
+        pairs[i].score = boxes[i].score;
+        pairs[i].index = i;
     }
-    // inder shape [default batch=1]
 
-    // std::cout<<"num_box "<<num_box<<"\n";
+    ref_topk(pairs, num_boxes, top);
+
+    for (int i = 0; i < top; i++)
+        sorted_boxes[i] = boxes[pairs[i].index];
+
+    /* the boxes after the post_nms_topn kept ones are not needed */
+    int max_keep = param->post_nms_topn > 0 ? param->post_nms_topn : 0;
+    num_boxes = ref_nms_sorted((const float*)sorted_boxes, sizeof(struct RPN_Box) / sizeof(float), top,
+                               param->nms_thresh, 1.f, 1, max_keep, keep, num_thread);
+
+    // inder shape [default batch=1]
     for (int i = 0; i < num_boxes; i++)
     {
+        const struct RPN_Box* box = sorted_boxes + keep[i];
         float* outptr = output + i * 4;
-        outptr[0] = boxes[i].x0;
-        outptr[1] = boxes[i].y0;
-        outptr[2] = boxes[i].x1;
-        outptr[3] = boxes[i].y1;
+        outptr[0] = box->x0;
+        outptr[1] = box->y0;
+        outptr[2] = box->x1;
+        outptr[3] = box->y1;
     }
 
     sys_free(boxes);
+    sys_free(pairs);
+    sys_free(sorted_boxes);
+    sys_free(keep);
+
     return num_boxes;
 }
 
@@ -338,7 +296,8 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     ref_proposal_local_anchor(featmap_tensor->dims[2], featmap_tensor->dims[3], _param->feat_stride, _param->anchors_,
                               local_anchors);
 
-    int output_num = ref_rpn_fp32((float*)score_org, (float*)featmap_org, local_anchors, (float*)output_org, &param);
+    int output_num = ref_rpn_fp32((float*)score_org, (float*)featmap_org, local_anchors, (float*)output_org, &param,
+                                  exec_graph->num_thread);
     int dims[4];
     dims[0] = featmap_tensor->dims[0];
     dims[1] = output_num;
@@ -347,6 +306,12 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
 
     sys_free(local_anchors);
 
+    if (output_num < 0)
+    {
+        TLOG_ERR("rpn: failed to get the boxes of node %d\n", ir_node->index);
+        return -1;
+    }
+
     int ret = set_ir_tensor_shape(output_tensor, dims, 4);
 
     return ret;
@@ -30,39 +30,58 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
 #include <math.h>
 
-int ref_selu_fp32(struct tensor* output_tensor, struct tensor* input_tensor, struct selu_param* selu_param,
-                  int num_thread)
+struct selu_job
 {
-    float* data = (float*)input_tensor->data;
-    float* out_data = (float*)output_tensor->data;
-    float alpha = selu_param->alpha;
-    float lambda = selu_param->lambda;
-    float alpha_lambda = alpha * lambda;
-
-    int chan_num = input_tensor->dims[0] * input_tensor->dims[1];
-    int chan_size = input_tensor->dims[2] * input_tensor->dims[3];
+    const float* input_data;
+    float* output_data;
+    int chan_size;
+    float lambda;
+    float alpha_lambda;
+};
+
+static void selu_channel(void* arg, int begin, int end)
+{
+    struct selu_job* job = (struct selu_job*)arg;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = 0; i < chan_num; i++)
+    for (int i = begin; i < end; i++)
     {
-        int offset = i * chan_size;
-        float* input_data = (float*)input_tensor->data + i * chan_size;
-        float* output_data = (float*)output_tensor->data + i * chan_size;
+        const float* input_data = job->input_data + i * job->chan_size;
+        float* output_data = job->output_data + i * job->chan_size;
 
-        for (int j = 0; j < chan_size; j++)
+        for (int j = 0; j < job->chan_size; j++)
         {
             if (input_data[j] < 0.f)
-                output_data[j] = (exp(input_data[j]) - 1.f) * alpha_lambda;
+                output_data[j] = (exp(input_data[j]) - 1.f) * job->alpha_lambda;
             else
-                output_data[j] = input_data[j] * lambda;
+                output_data[j] = input_data[j] * job->lambda;
         }
     }
+}
+
+int ref_selu_fp32(struct tensor* output_tensor, struct tensor* input_tensor, struct selu_param* selu_param,
+                  int num_thread)
+{
+    float alpha = selu_param->alpha;
+    float lambda = selu_param->lambda;
+
+    int chan_num = input_tensor->dims[0] * input_tensor->dims[1];
+
+    struct selu_job job;
+
+    job.input_data = (float*)input_tensor->data;
+    job.output_data = (float*)output_tensor->data;
+    job.chan_size = input_tensor->dims[2] * input_tensor->dims[3];
+    job.lambda = lambda;
+    job.alpha_lambda = alpha * lambda;
+
+    parallel_for(selu_channel, &job, chan_num, num_thread);
 
     return 0;
 }
@@ -90,26 +109,19 @@ int ref_selu_uint8(struct tensor* output_tensor, struct tensor* input_tensor, st
 
     float alpha = selu_param->alpha;
     float lambda = selu_param->lambda;
-    float alpha_lambda = alpha * lambda;
 
     int chan_num = input_tensor->dims[0] * input_tensor->dims[1];
-    int chan_size = input_tensor->dims[2] * input_tensor->dims[3];
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = 0; i < chan_num; i++)
-    {
-        int offset = i * chan_size;
-        input_data = (float*)input_tensor->data + i * chan_size;
-        output_data = (float*)output_tensor->data + i * chan_size;
+    /* run on the dequantized buffers */
+    struct selu_job job;
 
-        for (int j = 0; j < chan_size; j++)
-        {
-            if (input_data[j] < 0.f)
-                output_data[j] = (exp(input_data[j]) - 1.f) * alpha_lambda;
-            else
-                output_data[j] = input_data[j] * lambda;
-        }
-    }
+    job.input_data = input_data;
+    job.output_data = output_data;
+    job.chan_size = input_tensor->dims[2] * input_tensor->dims[3];
+    job.lambda = lambda;
+    job.alpha_lambda = alpha * lambda;
+
+    parallel_for(selu_channel, &job, chan_num, num_thread);
 
     /* quant */
     for (int i = 0; i < output_size; i++)
@@ -23,6 +23,7 @@
  */
 
 #include "shuffle_channel_param.h"
+#include "device/cpu/op/transpose/transpose_kernel_ref.h"
 
 #include "graph/tensor.h"
 #include "graph/node.h"
@@ -37,93 +38,6 @@
 #include <math.h>
 #include <string.h>
 
-int ref_shuffle_channel_fp32(struct tensor* input_tensor, struct tensor* output_tensor, struct shuffle_channel_param* param)
-{
-    int batch = input_tensor->dims[0];
-    int c = input_tensor->dims[1];
-    int h = input_tensor->dims[2];
-    int w = input_tensor->dims[3];
-    int group = param->group;
-    int elemsize = input_tensor->elem_size;
-    int chs_per_group = c / group;
-
-    float* input_fp32 = (float*)input_tensor->data;
-    float* output_fp32 = (float*)output_tensor->data;
-
-    for (int n = 0; n < batch; n++)
-    {
-        for (int i = 0; i < group; i++)
-        {
-            for (int j = 0; j != chs_per_group; j++)
-            {
-                int src_q = n * c * h * w + (chs_per_group * i + j) * h * w;
-                int dst_q = n * c * h * w + (group * j + i) * h * w;
-                memcpy(output_fp32 + dst_q, input_fp32 + src_q, (size_t)h * w * elemsize);
-            }
-        }
-    }
-
-    return 0;
-}
-
-int ref_shuffle_channel_uint8(struct tensor* input_tensor, struct tensor* output_tensor, struct shuffle_channel_param* param)
-{
-    int batch = input_tensor->dims[0];
-    int c = input_tensor->dims[1];
-    int h = input_tensor->dims[2];
-    int w = input_tensor->dims[3];
-    int group = param->group;
-    int elemsize = input_tensor->elem_size;
-    int chs_per_group = c / group;
-
-    uint8_t* input_uint8 = (uint8_t*)input_tensor->data;
-    uint8_t* output_uint8 = (uint8_t*)output_tensor->data;
-
-    for (int n = 0; n < batch; n++)
-    {
-        for (int i = 0; i < group; i++)
-        {
-            for (int j = 0; j != chs_per_group; j++)
-            {
-                int src_q = n * c * h * w + (chs_per_group * i + j) * h * w;
-                int dst_q = n * c * h * w + (group * j + i) * h * w;
-                memcpy(output_uint8 + dst_q, input_uint8 + src_q, (size_t)h * w * elemsize);
-            }
-        }
-    }
-
-    return 0;
-}
-
-int ref_shuffle_channel_int8(struct tensor* input_tensor, struct tensor* output_tensor, struct shuffle_channel_param* param)
-{
-    int batch = input_tensor->dims[0];
-    int c = input_tensor->dims[1];
-    int h = input_tensor->dims[2];
-    int w = input_tensor->dims[3];
-    int group = param->group;
-    int elemsize = input_tensor->elem_size;
-    int chs_per_group = c / group;
-
-    int8_t* input_int8 = (int8_t*)input_tensor->data;
-    int8_t* output_int8 = (int8_t*)output_tensor->data;
-
-    for (int n = 0; n < batch; n++)
-    {
-        for (int i = 0; i < group; i++)
-        {
-            for (int j = 0; j != chs_per_group; j++)
-            {
-                int src_q = n * c * h * w + (chs_per_group * i + j) * h * w;
-                int dst_q = n * c * h * w + (group * j + i) * h * w;
-                memcpy(output_int8 + dst_q, input_int8 + src_q, (size_t)h * w * elemsize);
-            }
-        }
-    }
-
-    return 0;
-}
-
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     return 0;
@@ -157,17 +71,24 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
     struct shuffle_channel_param* param = (struct shuffle_channel_param*)ir_node->op.param_mem;
 
-    int ret = -1;
-    if (input_tensor->data_type == TENGINE_DT_FP32)
-        ret = ref_shuffle_channel_fp32(input_tensor, output_tensor, param);
-    else if (input_tensor->data_type == TENGINE_DT_UINT8)
-        ret = ref_shuffle_channel_uint8(input_tensor, output_tensor, param);
-    else if (input_tensor->data_type == TENGINE_DT_INT8)
-        ret = ref_shuffle_channel_int8(input_tensor, output_tensor, param);
-    else
-        TLOG_ERR("Input data type %d not to be supported.\n", input_tensor->data_type);
-
-    return ret;
+    int data_type = input_tensor->data_type;
+    if (data_type != TENGINE_DT_FP32 && data_type != TENGINE_DT_UINT8 && data_type != TENGINE_DT_INT8)
+    {
+        TLOG_ERR("Input data type %d not to be supported.\n", data_type);
+        return -1;
+    }
+
+    /* [n, group, c / group, hw] to [n, c / group, group, hw] */
+    int dims[4];
+    dims[0] = input_tensor->dims[0];
+    dims[1] = param->group;
+    dims[2] = input_tensor->dims[1] / param->group;
+    dims[3] = input_tensor->dims[2] * input_tensor->dims[3];
+
+    const int perm[4] = {0, 2, 1, 3};
+
+    return ref_transpose(input_tensor->data, output_tensor->data, dims, perm, 4, input_tensor->elem_size,
+                         exec_graph->num_thread);
 }
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
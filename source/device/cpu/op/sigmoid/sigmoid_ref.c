@@ -28,6 +28,7 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
@@ -37,6 +38,30 @@
 #define SIGMOID_MAX(a, b) ((a) > (b) ? (a) : (b))
 #define SIGMOID_MIN(a, b) ((a) < (b) ? (a) : (b))
 
+struct sigmoid_job
+{
+    const float* input_data;
+    float* output_data;
+    int cstep;
+};
+
+static void sigmoid_channel(void* arg, int begin, int end)
+{
+    struct sigmoid_job* job = (struct sigmoid_job*)arg;
+
+    for (int c = begin; c < end; c++)
+    {
+        const float* input_data = job->input_data + c * job->cstep;
+        float* output_data = job->output_data + c * job->cstep;
+        for (int i = 0; i < job->cstep; i++)
+        {
+            output_data[i] = SIGMOID_MIN(input_data[i], 30.0f);
+            output_data[i] = SIGMOID_MAX(input_data[i], -30.0f);
+            output_data[i] = 1.f / (1 + expf(-output_data[i]));
+        }
+    }
+}
+
 int ref_sigmoid_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
 {
     int dim_num = input_tensor->dim_num;
@@ -45,24 +70,15 @@ int ref_sigmoid_fp32(struct tensor* input_tensor, struct tensor* output_tensor,
     {
         int batch = input_tensor->dims[0];
         int channel = input_tensor->dims[1];
-        int cstep = input_tensor->dims[2] * input_tensor->dims[3];
-        int bstep = channel * cstep;
 
-        for (int n = 0; n < batch; n++)
-        {
-#pragma omp parallel for num_threads(num_thread)
-            for (int c = 0; c < channel; c++)
-            {
-                float* input_data = (float*)input_tensor->data + n * bstep + c * cstep;
-                float* output_data = (float*)output_tensor->data + n * bstep + c * cstep;
-                for (int i = 0; i < cstep; i++)
-                {
-                    output_data[i] = SIGMOID_MIN(input_data[i], 30.0f);
-                    output_data[i] = SIGMOID_MAX(input_data[i], -30.0f);
-                    output_data[i] = 1.f / (1 + expf(-output_data[i]));
-                }
-            }
-        }
+        /* the channels of all the batches are contiguous */
+        struct sigmoid_job job;
+
+        job.input_data = (float*)input_tensor->data;
+        job.output_data = (float*)output_tensor->data;
+        job.cstep = input_tensor->dims[2] * input_tensor->dims[3];
+
+        parallel_for(sigmoid_channel, &job, batch * channel, num_thread);
     }
     else
     {
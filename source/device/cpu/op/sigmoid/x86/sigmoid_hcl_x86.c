@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "utility/simd_math.h"
+#include "system/cpu.h"
+#include "system/thread_pool.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+
+/* the elements are cut in blocks for the threads */
+#define SIGMOID_BLOCK 4096
+
+struct sigmoid_job
+{
+    const float* input;
+    float* output;
+    int size;
+};
+
+static void sigmoid_block(void* arg, int begin, int end)
+{
+    struct sigmoid_job* job = (struct sigmoid_job*)arg;
+    const float* input = job->input;
+    float* output = job->output;
+
+    int i = begin * SIGMOID_BLOCK;
+    int size = end * SIGMOID_BLOCK < job->size ? end * SIGMOID_BLOCK : job->size;
+
+#if __AVX__
+    for (; i + 7 < size; i += 8)
+        _mm256_storeu_ps(output + i, simd_sigmoid_f32x8(_mm256_loadu_ps(input + i)));
+#endif
+    for (; i < size; i++)
+        output[i] = simd_sigmoid_f32(input[i]);
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    struct sigmoid_job job;
+
+    job.input = (const float*)input_tensor->data;
+    job.output = (float*)output_tensor->data;
+    job.size = input_tensor->elem_num;
+
+    parallel_for(sigmoid_block, &job, (job.size + SIGMOID_BLOCK - 1) / SIGMOID_BLOCK, exec_graph->num_thread);
+
+    return 0;
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct node* ir_node = exec_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+
+    if (input_tensor->data_type != TENGINE_DT_FP32)
+        return 0;
+
+    return OPS_SCORE_PREFER;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = NULL,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = NULL,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .isa = CPU_ISA_BUILD};
+
+int register_sigmoid_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_SIGMOID, &hcl_node_ops);
+}
+
+int unregister_sigmoid_hcl_x86_op()
+{
+    unregister_builtin_node_ops(OP_SIGMOID, &hcl_node_ops);
+    return 0;
+}
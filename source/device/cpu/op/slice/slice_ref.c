@@ -355,6 +355,67 @@ static int ref_slice_common(const int8_t* in_data, int8_t** out_data, int elemen
         return tf_run(in_data, out_data, element_size, param);
 }
 
+/*
+ * the output is a slice of the input when the slices are along the outer dim, for the consecutive outputs of
+ * caffe and the single output of onnx or mxnet in steps of 1. the uint8 slice is computed in fp32, never a view.
+ */
+static int get_view_offset(struct graph* ir_graph, struct node* ir_node, int output_slot, size_t* offset)
+{
+    slice_param_t* param = (struct slice_param*)(ir_node->op.param_mem);
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[output_slot]);
+    int axis = param->axis;
+
+    if (input_tensor->data_type != TENGINE_DT_FP32 || !can_view_ir_tensor(input_tensor, output_tensor))
+        return -1;
+
+    if (!param->iscaffe && !(param->isonnx && param->step <= 1) && !param->ismxnet)
+        return -1;
+
+    if (axis < 0 || axis >= input_tensor->dim_num || input_tensor->dim_num > 4 || output_tensor->dim_num != input_tensor->dim_num)
+        return -1;
+
+    int slice_size = 1;
+
+    for (int i = 0; i < input_tensor->dim_num; i++)
+    {
+        if (i < axis && input_tensor->dims[i] != 1)
+            return -1;
+
+        if (i != axis && output_tensor->dims[i] != input_tensor->dims[i])
+            return -1;
+
+        if (i > axis)
+            slice_size *= input_tensor->dims[i];
+    }
+
+    int begin = 0;
+
+    if (param->iscaffe)
+    {
+        for (int i = 0; i < output_slot; i++)
+        {
+            struct tensor* prev_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[i]);
+
+            begin += prev_tensor->dims[axis];
+        }
+    }
+    else
+    {
+        if (output_slot != 0 || input_tensor->dim_num < 2)
+            return -1;
+
+        begin = param->begin;
+    }
+
+    if (begin < 0 || begin + output_tensor->dims[axis] > input_tensor->dims[axis])
+        return -1;
+
+    *offset = (size_t)begin * slice_size * input_tensor->elem_size;
+
+    return 0;
+}
+
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     return 0;
@@ -375,6 +436,20 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     slice_param_t* _param = (struct slice_param*)(ir_node->op.param_mem);
 
     int out_num = exec_node->output_num;
+    int view_num = 0;
+
+    /* the outputs placed in the input by the mem pool */
+    for (int i = 0; i < out_num; i++)
+    {
+        struct tensor* out_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[i]);
+        size_t offset;
+
+        if (get_view_offset(ir_graph, ir_node, i, &offset) == 0 && out_tensor->data == (uint8_t*)input_tensor->data + offset)
+            view_num++;
+    }
+
+    if (view_num == out_num)
+        return 0;
 
     struct shape_dim sd[MAX_SHAPE_DIM_NUM * 2];
     int8_t** out_data_ptrs = (int8_t**)sys_malloc(out_num * sizeof(int8_t*));
@@ -515,6 +590,13 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     return 0;
 }
 
+static int view_output(struct node_ops* node_ops, struct exec_node* exec_node, int output_slot, size_t* offset)
+{
+    struct node* ir_node = exec_node->ir_node;
+
+    return get_view_offset(ir_node->graph, ir_node, output_slot, offset) == 0 ? 0 : -1;
+}
+
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
     return OPS_SCORE_BEST;
@@ -526,7 +608,8 @@ static struct node_ops slice_node_ops = {.prerun = NULL,
                                          .postrun = NULL,
                                          .init_node = init_node,
                                          .release_node = release_node,
-                                         .score = score};
+                                         .score = score,
+                                         .view_output = view_output};
 
 int register_slice_ref_op()
 {
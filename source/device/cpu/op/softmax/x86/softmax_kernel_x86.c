@@ -0,0 +1,250 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "softmax_kernel_x86.h"
+
+#include "utility/simd_math.h"
+#include "system/thread_pool.h"
+
+/* the columns of an axis that is not the last one are done in blocks of SOFTMAX_COLUMN_BLOCK */
+#define SOFTMAX_COLUMN_BLOCK 64
+
+struct softmax_job
+{
+    const float* input;
+    float* output;
+    int on_size;
+    int in_size;
+    int block_num; /* the column blocks of an outer index */
+    int is_log;
+};
+
+#if __AVX__
+static inline float reduce_max_f32x8(__m256 x)
+{
+    __m128 y = _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    y = _mm_max_ps(y, _mm_movehl_ps(y, y));
+    y = _mm_max_ss(y, _mm_shuffle_ps(y, y, 1));
+    return _mm_cvtss_f32(y);
+}
+
+static inline float reduce_add_f32x8(__m256 x)
+{
+    __m128 y = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    y = _mm_add_ps(y, _mm_movehl_ps(y, y));
+    y = _mm_add_ss(y, _mm_shuffle_ps(y, y, 1));
+    return _mm_cvtss_f32(y);
+}
+#endif
+
+/* the axis is the last one, the row is contiguous */
+static void softmax_row(const float* input, float* output, int size, int is_log)
+{
+    float max = input[0];
+    int i = 0;
+
+#if __AVX__
+    __m256 _max = _mm256_set1_ps(max);
+    for (; i + 7 < size; i += 8)
+        _max = _mm256_max_ps(_max, _mm256_loadu_ps(input + i));
+    max = reduce_max_f32x8(_max);
+#endif
+    for (; i < size; i++)
+        max = input[i] > max ? input[i] : max;
+
+    /* the exp are kept in the output for the softmax */
+    float sum = 0.f;
+    i = 0;
+
+#if __AVX__
+    _max = _mm256_set1_ps(max);
+    __m256 _sum = _mm256_setzero_ps();
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _e = simd_exp_f32x8(_mm256_sub_ps(_mm256_loadu_ps(input + i), _max));
+        if (!is_log)
+            _mm256_storeu_ps(output + i, _e);
+        _sum = _mm256_add_ps(_sum, _e);
+    }
+    sum = reduce_add_f32x8(_sum);
+#endif
+    for (; i < size; i++)
+    {
+        float e = simd_exp_f32(input[i] - max);
+        if (!is_log)
+            output[i] = e;
+        sum += e;
+    }
+
+    if (is_log)
+    {
+        float shift = max + simd_log_f32(sum);
+        i = 0;
+#if __AVX__
+        __m256 _shift = _mm256_set1_ps(shift);
+        for (; i + 7 < size; i += 8)
+            _mm256_storeu_ps(output + i, _mm256_sub_ps(_mm256_loadu_ps(input + i), _shift));
+#endif
+        for (; i < size; i++)
+            output[i] = input[i] - shift;
+    }
+    else
+    {
+        float scale = 1.f / sum;
+        i = 0;
+#if __AVX__
+        __m256 _scale = _mm256_set1_ps(scale);
+        for (; i + 7 < size; i += 8)
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(output + i), _scale));
+#endif
+        for (; i < size; i++)
+            output[i] *= scale;
+    }
+}
+
+/* the columns of [on_size, stride] in [0, width), width <= SOFTMAX_COLUMN_BLOCK */
+static void softmax_column(const float* input, float* output, int on_size, int stride, int width, int is_log)
+{
+    float max[SOFTMAX_COLUMN_BLOCK];
+    float sum[SOFTMAX_COLUMN_BLOCK];
+
+    for (int l = 0; l < width; l++)
+    {
+        max[l] = input[l];
+        sum[l] = 0.f;
+    }
+
+    for (int j = 1; j < on_size; j++)
+    {
+        const float* x = input + (size_t)j * stride;
+        int l = 0;
+#if __AVX__
+        for (; l + 7 < width; l += 8)
+            _mm256_storeu_ps(max + l, _mm256_max_ps(_mm256_loadu_ps(max + l), _mm256_loadu_ps(x + l)));
+#endif
+        for (; l < width; l++)
+            max[l] = x[l] > max[l] ? x[l] : max[l];
+    }
+
+    for (int j = 0; j < on_size; j++)
+    {
+        const float* x = input + (size_t)j * stride;
+        float* y = output + (size_t)j * stride;
+        int l = 0;
+#if __AVX__
+        for (; l + 7 < width; l += 8)
+        {
+            __m256 _e = simd_exp_f32x8(_mm256_sub_ps(_mm256_loadu_ps(x + l), _mm256_loadu_ps(max + l)));
+            if (!is_log)
+                _mm256_storeu_ps(y + l, _e);
+            _mm256_storeu_ps(sum + l, _mm256_add_ps(_mm256_loadu_ps(sum + l), _e));
+        }
+#endif
+        for (; l < width; l++)
+        {
+            float e = simd_exp_f32(x[l] - max[l]);
+            if (!is_log)
+                y[l] = e;
+            sum[l] += e;
+        }
+    }
+
+    /* the scale or the shift of a column is left in the sum */
+    for (int l = 0; l < width; l++)
+        sum[l] = is_log ? max[l] + simd_log_f32(sum[l]) : 1.f / sum[l];
+
+    for (int j = 0; j < on_size; j++)
+    {
+        const float* x = input + (size_t)j * stride;
+        float* y = output + (size_t)j * stride;
+        int l = 0;
+
+        if (is_log)
+        {
+#if __AVX__
+            for (; l + 7 < width; l += 8)
+                _mm256_storeu_ps(y + l, _mm256_sub_ps(_mm256_loadu_ps(x + l), _mm256_loadu_ps(sum + l)));
+#endif
+            for (; l < width; l++)
+                y[l] = x[l] - sum[l];
+        }
+        else
+        {
+#if __AVX__
+            for (; l + 7 < width; l += 8)
+                _mm256_storeu_ps(y + l, _mm256_mul_ps(_mm256_loadu_ps(y + l), _mm256_loadu_ps(sum + l)));
+#endif
+            for (; l < width; l++)
+                y[l] *= sum[l];
+        }
+    }
+}
+
+static void softmax_block(void* arg, int begin, int end)
+{
+    struct softmax_job* job = (struct softmax_job*)arg;
+    int on_in_size = job->on_size * job->in_size;
+
+    for (int n = begin; n < end; n++)
+    {
+        int outer = n / job->block_num;
+        int column = (n % job->block_num) * SOFTMAX_COLUMN_BLOCK;
+        size_t offset = (size_t)outer * on_in_size + column;
+
+        if (job->in_size == 1)
+        {
+            softmax_row(job->input + offset, job->output + offset, job->on_size, job->is_log);
+        }
+        else
+        {
+            int width = job->in_size - column < SOFTMAX_COLUMN_BLOCK ? job->in_size - column : SOFTMAX_COLUMN_BLOCK;
+
+            softmax_column(job->input + offset, job->output + offset, job->on_size, job->in_size, width, job->is_log);
+        }
+    }
+}
+
+int softmax_kernel_x86_run(struct tensor* input_tensor, struct tensor* output_tensor, int axis, int is_log,
+                           int num_thread)
+{
+    int out_size = 1;
+    for (int i = 0; i < axis; i++)
+        out_size *= input_tensor->dims[i];
+
+    int in_size = 1;
+    for (int i = axis + 1; i < input_tensor->dim_num; i++)
+        in_size *= input_tensor->dims[i];
+
+    struct softmax_job job;
+
+    job.input = (const float*)input_tensor->data;
+    job.output = (float*)output_tensor->data;
+    job.on_size = input_tensor->dims[axis];
+    job.in_size = in_size;
+    job.block_num = (in_size + SOFTMAX_COLUMN_BLOCK - 1) / SOFTMAX_COLUMN_BLOCK;
+    job.is_log = is_log;
+
+    parallel_for(softmax_block, &job, out_size * job.block_num, num_thread);
+
+    return 0;
+}
@@ -30,6 +30,7 @@
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
+#include "system/thread_pool.h"
 #include "utility/float.h"
 #include "utility/sys_port.h"
 #include "utility/log.h"
@@ -40,6 +41,30 @@
 #include <stdio.h>
 #endif
 
+struct softplus_job
+{
+    const float* input_data;
+    float* out_data;
+    int c_step;
+    int size;
+};
+
+static void softplus_channel(void* arg, int begin, int end)
+{
+    struct softplus_job* job = (struct softplus_job*)arg;
+
+    for (int q = begin; q < end; q++)
+    {
+        const float* src = job->input_data + job->c_step * q;
+        float* dst = job->out_data + job->c_step * q;
+
+        for (int i = 0; i < job->size; i++)
+        {
+            dst[i] = log(exp(src[i]) + 1.0f);
+        }
+    }
+}
+
 int ref_softplus_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
 {
     int w = input_tensor->dims[3];
@@ -48,20 +73,14 @@ int ref_softplus_fp32(struct tensor* input_tensor, struct tensor* output_tensor,
     int size = h * w;
     int c_step = h * w;
 
-    float* input_data = (float*)input_tensor->data;
-    float* out_data = (float*)output_tensor->data;
+    struct softplus_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int q = 0; q < channels; q++)
-    {
-        float* src = input_data + c_step * q;
-        float* dst = out_data + c_step * q;
+    job.input_data = (float*)input_tensor->data;
+    job.out_data = (float*)output_tensor->data;
+    job.c_step = c_step;
+    job.size = size;
 
-        for (int i = 0; i < size; i++)
-        {
-            dst[i] = log(exp(src[i]) + 1.0f);
-        }
-    }
+    parallel_for(softplus_channel, &job, channels, num_thread);
 
     return 0;
 }
@@ -22,6 +22,9 @@
  * Author: qtang@openailab.com
  */
 
+#include "spacetodepth_param.h"
+#include "device/cpu/op/transpose/transpose_kernel_ref.h"
+
 #include "graph/tensor.h"
 #include "graph/node.h"
 #include "graph/graph.h"
@@ -34,34 +37,6 @@
 
 #include <math.h>
 
-int ref_spacetodepth_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
-{
-    float* input_data = (float*)input_tensor->data;
-    float* out_data = (float*)output_tensor->data;
-    int total_size = input_tensor->elem_num;
-
-    for (int i = 0; i < total_size; i++)
-    {
-        out_data[i] = input_data[i];
-    }
-
-    return 0;
-}
-
-int ref_spacetodepth_uint8(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
-{
-    uint8_t* input_data = (uint8_t*)input_tensor->data;
-    uint8_t* out_data = (uint8_t*)output_tensor->data;
-    int total_size = input_tensor->elem_num;
-
-    for (int i = 0; i < total_size; i++)
-    {
-        out_data[i] = input_data[i];
-    }
-
-    return 0;
-}
-
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     return 0;
@@ -83,18 +58,33 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct graph* ir_graph = ir_node->graph;
     struct tensor* input_tensor;
     struct tensor* output_tensor;
-    int layout = ir_graph->graph_layout;
 
     input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
     output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
 
-    int ret = -1;
-    if (input_tensor->data_type == TENGINE_DT_FP32)
-        ret = ref_spacetodepth_fp32(input_tensor, output_tensor, exec_graph->num_thread);
-    else if (input_tensor->data_type == TENGINE_DT_UINT8)
-        ret = ref_spacetodepth_uint8(input_tensor, output_tensor, exec_graph->num_thread);
+    struct spacetodepth_param* param = (struct spacetodepth_param*)ir_node->op.param_mem;
+
+    int data_type = input_tensor->data_type;
+    if (data_type != TENGINE_DT_FP32 && data_type != TENGINE_DT_UINT8 && data_type != TENGINE_DT_INT8)
+    {
+        TLOG_ERR("Input data type %d not to be supported.\n", data_type);
+        return -1;
+    }
+
+    /* as onnx, [n, c, outh, block, outw, block] to [n, block, block, c, outh, outw] */
+    int block_size = param->block_size;
+    int dims[6];
+    dims[0] = input_tensor->dims[0];
+    dims[1] = input_tensor->dims[1];
+    dims[2] = input_tensor->dims[2] / block_size;
+    dims[3] = block_size;
+    dims[4] = input_tensor->dims[3] / block_size;
+    dims[5] = block_size;
+
+    const int perm[6] = {0, 3, 5, 1, 2, 4};
 
-    return ret;
+    return ref_transpose(input_tensor->data, output_tensor->data, dims, perm, 6, input_tensor->elem_size,
+                         exec_graph->num_thread);
 }
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
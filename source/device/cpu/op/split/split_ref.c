@@ -134,6 +134,46 @@ int ref_split_int8(struct tensor* input_tensor, struct tensor* output_tensor, st
     return 0;
 }
 
+/* the output is the slice of the input when the slices are along the outer dim, or the whole input for caffe */
+static int get_view_offset(struct graph* ir_graph, struct node* ir_node, int output_slot, size_t* offset)
+{
+    struct split_param* split_param = (struct split_param*)ir_node->op.param_mem;
+    struct tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[output_slot]);
+    int slice_axis = split_param->axis;
+
+    if (!can_view_ir_tensor(input_tensor, output_tensor))
+        return -1;
+
+    *offset = 0;
+
+    if (split_param->is_caffe)
+        return input_tensor->elem_num == output_tensor->elem_num ? 0 : -1;
+
+    for (int i = 0; i < slice_axis; i++)
+    {
+        if (input_tensor->dims[i] != 1)
+            return -1;
+    }
+
+    int slice_size = 1;
+    int slice_index = 0;
+
+    for (int i = slice_axis + 1; i < input_tensor->dim_num; i++)
+        slice_size = slice_size * input_tensor->dims[i];
+
+    for (int i = 0; i < output_slot; i++)
+    {
+        struct tensor* prev_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[i]);
+
+        slice_index += prev_tensor->dims[slice_axis];
+    }
+
+    *offset = (size_t)slice_index * slice_size * input_tensor->elem_size;
+
+    return 0;
+}
+
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     return 0;
@@ -180,6 +220,17 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     for (int i = 0; i < out_num; i++)
     {
         struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[i]);
+        size_t offset;
+
+        /* the output placed in the input by the mem pool */
+        if (get_view_offset(ir_graph, ir_node, i, &offset) == 0 && output_tensor->data == (uint8_t*)input_tensor->data + offset)
+        {
+            if (!split_param->is_caffe)
+                slice_index += output_tensor->dims[slice_axis];
+
+            ret = 0;
+            continue;
+        }
 
         if (input_tensor->data_type == TENGINE_DT_FP32)
             ret = ref_split_fp32(input_tensor, output_tensor, split_param, &slice_index, num_slices, slice_size, in_slice, slice_axis);
@@ -192,6 +243,13 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     return ret;
 }
 
+static int view_output(struct node_ops* node_ops, struct exec_node* exec_node, int output_slot, size_t* offset)
+{
+    struct node* ir_node = exec_node->ir_node;
+
+    return get_view_offset(ir_node->graph, ir_node, output_slot, offset) == 0 ? 0 : -1;
+}
+
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
 {
     return OPS_SCORE_BEST;
@@ -203,7 +261,8 @@ static struct node_ops hcl_node_ops = {.prerun = prerun,
                                        .postrun = NULL,
                                        .init_node = init_node,
                                        .release_node = release_node,
-                                       .score = score};
+                                       .score = score,
+                                       .view_output = view_output};
 
 int register_split_ref_op()
 {
@@ -28,12 +28,39 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
 #include <math.h>
 
+struct squareddifference_job
+{
+    const float* input0;
+    const float* input1;
+    float* output;
+    int c_step;
+    int size;
+};
+
+static void squareddifference_channel(void* arg, int begin, int end)
+{
+    struct squareddifference_job* job = (struct squareddifference_job*)arg;
+
+    for (int q = begin; q < end; q++)
+    {
+        const float* src0 = job->input0 + job->c_step * q;
+        const float* src1 = job->input1 + job->c_step * q;
+        float* dst = job->output + job->c_step * q;
+
+        for (int i = 0; i < job->size; i++)
+        {
+            dst[i] = powf((src0[i] - src1[i]), 2);
+        }
+    }
+}
+
 int ref_squareddifference_fp32(struct tensor* input_tensor_0, struct tensor* input_tensor_1,
                                struct tensor* output_tensor, int num_thread)
 {
@@ -61,22 +88,15 @@ int ref_squareddifference_fp32(struct tensor* input_tensor_0, struct tensor* inp
         int size = h * w;
         int c_step = h * w;
 
-        float* input0 = (float*)input_tensor_0->data;
-        float* input1 = (float*)input_tensor_1->data;
-        float* output = (float*)output_tensor->data;
+        struct squareddifference_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-        for (int q = 0; q < channels; q++)
-        {
-            float* src0 = input0 + c_step * q;
-            float* src1 = input1 + c_step * q;
-            float* dst = output + c_step * q;
-
-            for (int i = 0; i < size; i++)
-            {
-                dst[i] = powf((src0[i] - src1[i]), 2);
-            }
-        }
+        job.input0 = (float*)input_tensor_0->data;
+        job.input1 = (float*)input_tensor_1->data;
+        job.output = (float*)output_tensor->data;
+        job.c_step = c_step;
+        job.size = size;
+
+        parallel_for(squareddifference_channel, &job, channels, num_thread);
 
         return 0;
     }
@@ -135,18 +155,15 @@ int ref_squareddifference_uint8(struct tensor* input_tensor_0, struct tensor* in
         int size = h * w;
         int c_step = h * w;
 
-#pragma omp parallel for num_threads(num_thread)
-        for (int q = 0; q < channels; q++)
-        {
-            float* src0 = input0 + c_step * q;
-            float* src1 = input1 + c_step * q;
-            float* dst = output + c_step * q;
-
-            for (int i = 0; i < size; i++)
-            {
-                dst[i] = powf((src0[i] - src1[i]), 2);
-            }
-        }
+        struct squareddifference_job job;
+
+        job.input0 = input0;
+        job.input1 = input1;
+        job.output = output;
+        job.c_step = c_step;
+        job.size = size;
+
+        parallel_for(squareddifference_channel, &job, channels, num_thread);
 
         return 0;
     }
@@ -197,6 +214,13 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     input_tensor_1 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
     output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
 
+    /* the ref supports no broadcast */
+    if (input_tensor_0->elem_num != output_tensor->elem_num || input_tensor_1->elem_num != output_tensor->elem_num)
+    {
+        TLOG_ERR("squareddifference ref op does not support broadcast\n");
+        return -1;
+    }
+
     int ret = -1;
     if (input_tensor_0->data_type == TENGINE_DT_FP32)
         ret = ref_squareddifference_fp32(input_tensor_0, input_tensor_1, output_tensor, exec_graph->num_thread);
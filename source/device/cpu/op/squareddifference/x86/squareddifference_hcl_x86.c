@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+#include "system/cpu.h"
+#include "device/cpu/cpu_node.h"
+#include "device/cpu/cpu_graph.h"
+#include "device/cpu/cpu_module.h"
+#include "device/cpu/op/eltwise/x86/eltwise_kernel_x86.h"
+
+/* output = (input0 - input1)^2, the inputs broadcast numpy style */
+static int set_squareddifference_param(struct eltwise_x86_param* param, struct node* ir_node)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* input_tensor1 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    if (eltwise_x86_set_type(param, input_tensor0, input_tensor1, output_tensor) < 0)
+        return -1;
+
+    param->op = ELTWISE_X86_SQUARED_DIFF;
+
+    int ret = eltwise_x86_set_shape(param, input_tensor0->dims, input_tensor0->dim_num, input_tensor1->dims,
+                                    input_tensor1->dim_num);
+    if (ret < 0)
+        return -1;
+
+    int size = 1;
+    for (int i = 0; i < param->dim_num; i++)
+        size *= param->dims[i];
+
+    return size == output_tensor->elem_num ? 0 : -1;
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct node* ir_node = exec_node->ir_node;
+    struct graph* ir_graph = ir_node->graph;
+    struct eltwise_x86_param param;
+
+    if (set_squareddifference_param(&param, ir_node) < 0)
+    {
+        TLOG_ERR("squareddifference x86 op does not support the shapes of node %d\n", ir_node->index);
+        return -1;
+    }
+
+    struct tensor* input_tensor0 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct tensor* input_tensor1 = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    eltwise_x86_run(&param, input_tensor0->data, input_tensor1->data, output_tensor->data, exec_graph->num_thread);
+
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
+{
+    struct eltwise_x86_param param;
+
+    if (set_squareddifference_param(&param, exec_node) < 0)
+        return 0;
+
+    return OPS_SCORE_PREFER;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = NULL,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = NULL,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score,
+                                       .isa = CPU_ISA_BUILD};
+
+int register_squareddifference_hcl_x86_op()
+{
+    return register_builtin_node_ops(OP_SQUAREDDIFFERENCE, &hcl_node_ops);
+}
+
+int unregister_squareddifference_hcl_x86_op()
+{
+    return unregister_builtin_node_ops(OP_SQUAREDDIFFERENCE, &hcl_node_ops);
+}
@@ -23,6 +23,7 @@
  */
 
 #include "swap_axis_param.h"
+#include "device/cpu/op/transpose/transpose_kernel_ref.h"
 
 #include "graph/tensor.h"
 #include "graph/node.h"
@@ -37,42 +38,6 @@
 #include <math.h>
 #include <string.h>
 
-static int ref_swap_axis_common(struct tensor* input_tensor, struct tensor* output_tensor, const int* dims, int element_size)
-{
-    const float* in_data = (float*)input_tensor->data;
-    float* out_data = (float*)output_tensor->data;
-
-    for (int i = 0; i < dims[0]; i++)
-        for (int j = 0; j < dims[3]; j++)
-            for (int p = 0; p < dims[2]; p++)
-                for (int q = 0; q < dims[1]; q++)
-                {
-                    int out_index = i * dims[1] * dims[2] * dims[3] * dims[4] + j * dims[2] * dims[1] * dims[4] + p * dims[1] * dims[4] + q * dims[4];
-                    int in_index = i * dims[1] * dims[2] * dims[3] * dims[4] + q * dims[2] * dims[3] * dims[4] + p * dims[3] * dims[4] + j * dims[4];
-                    memcpy(out_data + out_index * element_size, in_data + in_index * element_size,
-                           (size_t)dims[4] * element_size);
-                }
-    return 0;
-}
-
-static int ref_swap_axis_uint8(struct tensor* input_tensor, struct tensor* output_tensor, const int* dims, int element_size)
-{
-    const uint8_t* in_data = (uint8_t*)input_tensor->data;
-    uint8_t* out_data = (uint8_t*)output_tensor->data;
-
-    for (int i = 0; i < dims[0]; i++)
-        for (int j = 0; j < dims[3]; j++)
-            for (int p = 0; p < dims[2]; p++)
-                for (int q = 0; q < dims[1]; q++)
-                {
-                    int out_index = i * dims[1] * dims[2] * dims[3] * dims[4] + j * dims[2] * dims[1] * dims[4] + p * dims[1] * dims[4] + q * dims[4];
-                    int in_index = i * dims[1] * dims[2] * dims[3] * dims[4] + q * dims[2] * dims[3] * dims[4] + p * dims[3] * dims[4] + j * dims[4];
-                    memcpy(out_data + out_index * element_size, in_data + in_index * element_size,
-                           (size_t)dims[4] * element_size);
-                }
-    return 0;
-}
-
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
 {
     return 0;
@@ -91,11 +56,6 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
 
     struct swap_axis_param* _param = (struct swap_axis_param*)(ir_node->op.param_mem);
-    int in_size = 1;
-    for (int i = 0; i < input_tensor->dim_num; i++)
-    {
-        in_size *= input_tensor->dims[i];
-    }
     int dim0 = _param->dim_0;
     int dim1 = _param->dim_1;
     int dims[5];
@@ -106,6 +66,13 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
         dim1 = tmp;
     }
 
+    int data_type = input_tensor->data_type;
+    if (data_type != TENGINE_DT_FP32 && data_type != TENGINE_DT_UINT8 && data_type != TENGINE_DT_INT8)
+    {
+        TLOG_ERR("Input data type %d not to be supported.\n", data_type);
+        return -1;
+    }
+
     for (int i = 0; i < 5; i++)
         dims[i] = 1;
     // dim0
@@ -119,16 +86,13 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     // dim3
     dims[3] = input_tensor->dims[dim1];
     // dim4
-    for (int i = dim1 + 1; i < in_size; i++)
+    for (int i = dim1 + 1; i < input_tensor->dim_num; i++)
         dims[4] *= input_tensor->dims[i];
 
-    int ret = -1;
-    if (input_tensor->data_type == TENGINE_DT_FP32)
-        ret = ref_swap_axis_common(input_tensor, output_tensor, dims, sizeof(float));
-    else if (input_tensor->data_type == TENGINE_DT_UINT8)
-        ret = ref_swap_axis_uint8(input_tensor, output_tensor, dims, sizeof(uint8_t));
+    const int perm[5] = {0, 3, 2, 1, 4};
 
-    return ret;
+    return ref_transpose(input_tensor->data, output_tensor->data, dims, perm, 5, input_tensor->elem_size,
+                         exec_graph->num_thread);
 }
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "topk_kernel_ref.h"
+
+static inline int is_better(const struct topk_pair* a, const struct topk_pair* b)
+{
+    return a->score > b->score || (a->score == b->score && a->index < b->index);
+}
+
+/* the worst pair of the heap is on the top */
+static void sift_down(struct topk_pair* heap, int size, int i)
+{
+    struct topk_pair pair = heap[i];
+
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= size)
+            break;
+
+        if (child + 1 < size && is_better(&heap[child], &heap[child + 1]))
+            child++;
+
+        if (!is_better(&pair, &heap[child]))
+            break;
+
+        heap[i] = heap[child];
+        i = child;
+    }
+
+    heap[i] = pair;
+}
+
+void ref_topk(struct topk_pair* pairs, int n, int k)
+{
+    if (k > n)
+        k = n;
+
+    if (k <= 0)
+        return;
+
+    for (int i = k / 2 - 1; i >= 0; i--)
+        sift_down(pairs, k, i);
+
+    for (int i = k; i < n; i++)
+    {
+        if (is_better(&pairs[i], &pairs[0]))
+        {
+            struct topk_pair pair = pairs[i];
+            pairs[i] = pairs[0];
+            pairs[0] = pair;
+
+            sift_down(pairs, k, 0);
+        }
+    }
+
+    /* the worst to the back one by one */
+    for (int size = k - 1; size > 0; size--)
+    {
+        struct topk_pair pair = pairs[size];
+        pairs[size] = pairs[0];
+        pairs[0] = pair;
+
+        sift_down(pairs, size, 0);
+    }
+}
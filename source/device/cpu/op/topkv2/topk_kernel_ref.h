@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef __TOPK_KERNEL_REF_H__
+#define __TOPK_KERNEL_REF_H__
+
+struct topk_pair
+{
+    float score;
+    int index;
+};
+
+/*
+ * the selection of topkv2 and of the boxes of the detection ops. a pair is better than another
+ * of a larger score, or of a smaller index for the same score, so the order of the ties does
+ * not depend on the algorithm.
+ *
+ * the k best of the n pairs are moved to the front in order, the best first, the others are
+ * left in [k, n) in no order. the k best are kept in a heap while the pairs are scanned, it is
+ * n log k compares, k = n sorts them all.
+ */
+void ref_topk(struct topk_pair* pairs, int n, int k);
+
+#endif
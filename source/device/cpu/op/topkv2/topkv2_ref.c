@@ -22,6 +22,8 @@
  * Author: qtang@openailab.com
  */
 
+#include "topk_kernel_ref.h"
+
 #include "topkv2_param.h"
 
 #include "graph/tensor.h"
@@ -30,6 +32,7 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
@@ -37,146 +40,88 @@
 #include <math.h>
 #include <string.h>
 
-struct topkv2_param_ref
+/* the rows are independent, the input is not changed */
+struct topkv2_job
 {
+    const void* input;
+    void* output;
+    int* index;
+    int data_type;
     int k;
     int row_size;
-    int num_rows;
+
+    float input_scale;
+    float output_scale;
+    int input_zero;
+    int output_zero;
+
+    int error;
 };
 
-static void swap_fp32(float* p, float* q)
-{
-    float buf;
-    buf = *p;
-    *p = *q;
-    *q = buf;
-    return;
-}
-static void swap_int(int* p, int* q)
-{
-    int buf;
-    buf = *p;
-    *p = *q;
-    *q = buf;
-    return;
-}
-static void quick_sort_fp32(float* a, int low, int high, int* indexv)
+static void topkv2_task(void* arg, int begin, int end)
 {
-    int i = low;
-    int j = high;
-    float key = a[low];
+    struct topkv2_job* job = (struct topkv2_job*)arg;
+    int k = job->k;
+    int row_size = job->row_size;
 
-    if (low >= high)
+    struct topk_pair* pairs = (struct topk_pair*)sys_malloc(row_size * sizeof(struct topk_pair));
+    if (pairs == NULL)
     {
+        job->error = 1;
         return;
     }
 
-    while (low < high)
+    for (int i = begin; i < end; i++)
     {
-        while (low < high && key >= a[high])
-        {
-            --high;
-        }
+        size_t start = (size_t)i * row_size;
 
-        if (key < a[high])
-        {
-            swap_fp32(&a[low], &a[high]);
-            swap_int(&indexv[low], &indexv[high]);
-
-            ++low;
-        }
-        while (low < high && key <= a[low])
+        if (job->data_type == TENGINE_DT_FP32)
         {
-            ++low;
+            const float* input = (const float*)job->input + start;
+            for (int j = 0; j < row_size; j++)
+            {
+                pairs[j].score = input[j];
+                pairs[j].index = j;
+            }
         }
-        if (key > a[low])
+        else
         {
-            swap_fp32(&a[low], &a[high]);
-            swap_int(&indexv[low], &indexv[high]);
-
-            --high;
+            const uint8_t* input = (const uint8_t*)job->input + start;
+            for (int j = 0; j < row_size; j++)
+            {
+                pairs[j].score = ((float)input[j] - (float)job->input_zero) * job->input_scale;
+                pairs[j].index = j;
+            }
         }
-    }
-    quick_sort_fp32(a, i, low - 1, indexv);
-    quick_sort_fp32(a, low + 1, j, indexv);
-}
-
-static int ref_topkv2_fp32(float* in_data, float* out_data, int* out_index, struct topkv2_param_ref* param)
-{
-    int k = param->k;
-
-    int row_size = param->row_size;
-    int num_rows = param->num_rows;
-    int* index = (int*)sys_malloc(row_size * sizeof(int));
 
-    for (int i = 0; i < num_rows; ++i)
-    {
-        int start = i * row_size;
-        for (int j = 0; j < row_size; ++j)
-            index[j] = j;
-
-        quick_sort_fp32(&in_data[start], 0, row_size - 1, index);
-        memcpy(&out_data[i * k], &in_data[start], k * sizeof(float));
-        memcpy(&out_index[i * k], index, k * sizeof(float));
-        sys_free(index);
-    }
+        ref_topk(pairs, row_size, k);
 
-    return 0;
-}
+        int* index = job->index + (size_t)i * k;
+        for (int j = 0; j < k; j++)
+            index[j] = pairs[j].index;
 
-static int ref_topkv2_uint8(struct tensor* input_tensor, struct tensor* output_tensor, int* out_index, struct topkv2_param_ref* param)
-{
-    /* dequant */
-    uint8_t* input_uint8 = (uint8_t*)input_tensor->data;
-    uint8_t* output_uint8 = (uint8_t*)output_tensor->data;
-    float input_scale = input_tensor->scale;
-    float output_scale = output_tensor->scale;
-    int32_t input_zero = input_tensor->zero_point;
-    int32_t output_zero = output_tensor->zero_point;
-    int input_size = input_tensor->elem_num;
-    int output_size = output_tensor->elem_num;
-
-    float* in_data = (float*)sys_malloc(input_size * sizeof(float));
-    float* out_data = (float*)sys_malloc(output_size * sizeof(float));
-
-    for (int i = 0; i < input_size; i++)
-    {
-        in_data[i] = ((float)input_uint8[i] - (float)input_zero) * input_scale;
-    }
-
-    int k = param->k;
-    int row_size = param->row_size;
-    int num_rows = param->num_rows;
-    int* index = (int*)sys_malloc(row_size * sizeof(int));
-
-    for (int i = 0; i < num_rows; ++i)
-    {
-        int start = i * row_size;
-        for (int j = 0; j < row_size; ++j)
-            index[j] = j;
-
-        quick_sort_fp32(&in_data[start], 0, row_size - 1, index);
-
-        memcpy(&out_data[i * k], &in_data[start], k * sizeof(float));
-        memcpy(&out_index[i * k], index, k * sizeof(float));
-        sys_free(index);
-    }
-
-    /* quant */
-    for (int i = 0; i < output_size; i++)
-    {
-        int udata = round(out_data[i] / output_scale + output_zero);
-        if (udata > 255)
-            udata = 255;
-        else if (udata < 0)
-            udata = 0;
-        output_uint8[i] = udata;
+        if (job->data_type == TENGINE_DT_FP32)
+        {
+            float* output = (float*)job->output + (size_t)i * k;
+            for (int j = 0; j < k; j++)
+                output[j] = pairs[j].score;
+        }
+        else
+        {
+            uint8_t* output = (uint8_t*)job->output + (size_t)i * k;
+            for (int j = 0; j < k; j++)
+            {
+                int udata = round(pairs[j].score / job->output_scale + job->output_zero);
+                if (udata > 255)
+                    udata = 255;
+                else if (udata < 0)
+                    udata = 0;
+                output[j] = udata;
+            }
+        }
     }
 
-    sys_free(in_data);
-    sys_free(out_data);
-
-    return 0;
+    sys_free(pairs);
 }
 
 static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
@@ -201,7 +146,6 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct topkv2_param* _param = (struct topkv2_param*)(ir_node->op.param_mem);
     struct tensor* input_tensor;
     int out_nums = ir_node->output_num;
-    struct topkv2_priv_info* topkv2_priv_info = (struct topkv2_priv_info*)exec_node->ops_priv;
     input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
     struct tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
     struct tensor* output_tensor_1 = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[1]);
@@ -211,19 +155,35 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     {
         num_rows *= input_tensor->dims[i];
     }
-    struct topkv2_param_ref op_param;
-    op_param.k = _param->k;
-    op_param.row_size = input_tensor->dims[dims_len - 1];
-    op_param.num_rows = num_rows;
-    float* input = (float*)input_tensor->data;
-
-    int ret = -1;
-    if (input_tensor->data_type == TENGINE_DT_FP32)
-        ret = ref_topkv2_fp32(input, (float*)output_tensor->data, (int*)output_tensor_1->data, &op_param);
-    else if (input_tensor->data_type == TENGINE_DT_UINT8)
-        ret = ref_topkv2_uint8(input_tensor, output_tensor, (int*)output_tensor_1->data, &op_param);
-
-    return ret;
+
+    if (input_tensor->data_type != TENGINE_DT_FP32 && input_tensor->data_type != TENGINE_DT_UINT8)
+    {
+        TLOG_ERR("Input data type %d not to be supported.\n", input_tensor->data_type);
+        return -1;
+    }
+
+    struct topkv2_job job;
+    job.input = input_tensor->data;
+    job.output = output_tensor->data;
+    job.index = (int*)output_tensor_1->data;
+    job.data_type = input_tensor->data_type;
+    job.k = _param->k;
+    job.row_size = input_tensor->dims[dims_len - 1];
+    job.input_scale = input_tensor->scale;
+    job.output_scale = output_tensor->scale;
+    job.input_zero = input_tensor->zero_point;
+    job.output_zero = output_tensor->zero_point;
+    job.error = 0;
+
+    if (job.k > job.row_size)
+    {
+        TLOG_ERR("topkv2: k %d is over the row size %d\n", job.k, job.row_size);
+        return -1;
+    }
+
+    parallel_for(topkv2_task, &job, num_rows, exec_graph->num_thread);
+
+    return job.error ? -1 : 0;
 }
 
 static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct node* exec_node)
@@ -0,0 +1,435 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "transpose_kernel_ref.h"
+
+#include "api/c_api.h"
+#include "system/thread_pool.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#elif __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/* the x86 ops are built for the x86 targets, with the 8x8 tile of avx2 */
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#include "system/cpu.h"
+#include "x86/transpose_kernel_x86.h"
+#define TRANSPOSE_REF_X86 1
+#endif
+
+/*
+ * the bytes of the input rows read by a block, the output rows of a block are as many as the
+ * elements of them. more rows written at the same time are more streams than the prefetcher
+ * keeps, so 8 rows of fp32 are faster than 32.
+ */
+#define TRANSPOSE_REF_BLOCK 32
+
+/* the bytes of a thread task at least */
+#define TRANSPOSE_REF_TASK_SIZE 16384
+
+struct transpose_job
+{
+    const uint8_t* input;
+    uint8_t* output;
+    int elem_size;
+
+    /* the outer dims in the output order, the strides are in elements */
+    int outer_num;
+    int outer_dims[MAX_SHAPE_DIM_NUM];
+    size_t in_strides[MAX_SHAPE_DIM_NUM];
+    size_t out_strides[MAX_SHAPE_DIM_NUM];
+
+    /* copy the runs of x_num elements, or else out[x * out_ld + y] = in[y * in_ld + x] */
+    int copy;
+    int x_num;
+    int y_num;
+    size_t in_ld;
+    size_t out_ld;
+
+    /* a unit is a block of the x of an outer index, a task is unit_per_task units */
+    int block;
+    int block_num;
+    size_t unit_num;
+    size_t unit_per_task;
+
+    int avx2; /* the cpu has avx2, the fp32 planes are transposed in tiles of 8 */
+};
+
+/*
+ * drop the dims of size 1 and merge the dims which are adjacent in both the input and the
+ * output, return the count of the dims left
+ */
+static int collapse_perm(const int* dims, const int* perm, int dim_num, int* new_dims, int* new_perm)
+{
+    int index[MAX_SHAPE_DIM_NUM];
+    int squeezed_dims[MAX_SHAPE_DIM_NUM];
+    int squeezed_perm[MAX_SHAPE_DIM_NUM];
+    int num = 0;
+
+    for (int i = 0; i < dim_num; i++)
+    {
+        index[i] = dims[i] == 1 ? -1 : num;
+        if (dims[i] != 1)
+            squeezed_dims[num++] = dims[i];
+    }
+
+    int perm_num = 0;
+    for (int i = 0; i < dim_num; i++)
+    {
+        if (index[perm[i]] >= 0)
+            squeezed_perm[perm_num++] = index[perm[i]];
+    }
+
+    /* the groups of the input dims in the output order */
+    int group_start[MAX_SHAPE_DIM_NUM];
+    int group_size[MAX_SHAPE_DIM_NUM];
+    int group_num = 0;
+
+    for (int i = 0; i < num; i++)
+    {
+        if (i > 0 && squeezed_perm[i] == squeezed_perm[i - 1] + 1)
+        {
+            group_size[group_num - 1]++;
+            continue;
+        }
+
+        group_start[group_num] = squeezed_perm[i];
+        group_size[group_num] = 1;
+        group_num++;
+    }
+
+    for (int i = 0; i < group_num; i++)
+    {
+        int rank = 0;
+        for (int j = 0; j < group_num; j++)
+        {
+            if (group_start[j] < group_start[i])
+                rank++;
+        }
+
+        new_perm[i] = rank;
+        new_dims[rank] = 1;
+        for (int j = 0; j < group_size[i]; j++)
+            new_dims[rank] *= squeezed_dims[group_start[i] + j];
+    }
+
+    return group_num;
+}
+
+#if __SSE2__
+static inline void transpose_4x4(const uint32_t* in, size_t in_ld, uint32_t* out, size_t out_ld)
+{
+    __m128i _r0 = _mm_loadu_si128((const __m128i*)(in));
+    __m128i _r1 = _mm_loadu_si128((const __m128i*)(in + in_ld));
+    __m128i _r2 = _mm_loadu_si128((const __m128i*)(in + in_ld * 2));
+    __m128i _r3 = _mm_loadu_si128((const __m128i*)(in + in_ld * 3));
+
+    __m128i _t0 = _mm_unpacklo_epi32(_r0, _r1);
+    __m128i _t1 = _mm_unpacklo_epi32(_r2, _r3);
+    __m128i _t2 = _mm_unpackhi_epi32(_r0, _r1);
+    __m128i _t3 = _mm_unpackhi_epi32(_r2, _r3);
+
+    _mm_storeu_si128((__m128i*)(out), _mm_unpacklo_epi64(_t0, _t1));
+    _mm_storeu_si128((__m128i*)(out + out_ld), _mm_unpackhi_epi64(_t0, _t1));
+    _mm_storeu_si128((__m128i*)(out + out_ld * 2), _mm_unpacklo_epi64(_t2, _t3));
+    _mm_storeu_si128((__m128i*)(out + out_ld * 3), _mm_unpackhi_epi64(_t2, _t3));
+}
+#elif __ARM_NEON
+static inline void transpose_4x4(const uint32_t* in, size_t in_ld, uint32_t* out, size_t out_ld)
+{
+    uint32x4x2_t _t01 = vtrnq_u32(vld1q_u32(in), vld1q_u32(in + in_ld));
+    uint32x4x2_t _t23 = vtrnq_u32(vld1q_u32(in + in_ld * 2), vld1q_u32(in + in_ld * 3));
+
+    vst1q_u32(out, vcombine_u32(vget_low_u32(_t01.val[0]), vget_low_u32(_t23.val[0])));
+    vst1q_u32(out + out_ld, vcombine_u32(vget_low_u32(_t01.val[1]), vget_low_u32(_t23.val[1])));
+    vst1q_u32(out + out_ld * 2, vcombine_u32(vget_high_u32(_t01.val[0]), vget_high_u32(_t23.val[0])));
+    vst1q_u32(out + out_ld * 3, vcombine_u32(vget_high_u32(_t01.val[1]), vget_high_u32(_t23.val[1])));
+}
+#endif
+
+/* out[x * out_ld + y] = in[y * in_ld + x], in tiles of 8 or 4 y and x by simd, the rest in scalar */
+static void transpose_plane_32(const uint32_t* in, uint32_t* out, int x_num, int y_num, size_t in_ld, size_t out_ld,
+                               int avx2)
+{
+    int y = 0;
+
+#if TRANSPOSE_REF_X86
+    if (avx2)
+        y = transpose_x86_plane_32_avx2(in, out, x_num, y_num, in_ld, out_ld);
+#endif
+
+#if __SSE2__ || __ARM_NEON
+    for (; y + 3 < y_num; y += 4)
+    {
+        int x = 0;
+        for (; x + 3 < x_num; x += 4)
+            transpose_4x4(in + y * in_ld + x, in_ld, out + x * out_ld + y, out_ld);
+
+        for (; x < x_num; x++)
+        {
+            for (int k = 0; k < 4; k++)
+                out[x * out_ld + y + k] = in[(y + k) * in_ld + x];
+        }
+    }
+#endif
+
+    for (; y < y_num; y++)
+    {
+        for (int x = 0; x < x_num; x++)
+            out[x * out_ld + y] = in[y * in_ld + x];
+    }
+}
+
+/* the other sizes in scalar, 8 y at a time for the writes to stay in the cache lines */
+#define TRANSPOSE_PLANE_SCALAR(name, type)                                                                 \
+    static void name(const type* in, type* out, int x_num, int y_num, size_t in_ld, size_t out_ld)        \
+    {                                                                                                      \
+        for (int y0 = 0; y0 < y_num; y0 += 8)                                                              \
+        {                                                                                                  \
+            int y1 = y0 + 8 < y_num ? y0 + 8 : y_num;                                                      \
+            for (int x = 0; x < x_num; x++)                                                                \
+            {                                                                                              \
+                for (int y = y0; y < y1; y++)                                                              \
+                    out[x * out_ld + y] = in[y * in_ld + x];                                               \
+            }                                                                                              \
+        }                                                                                                  \
+    }
+
+TRANSPOSE_PLANE_SCALAR(transpose_plane_8, uint8_t)
+TRANSPOSE_PLANE_SCALAR(transpose_plane_16, uint16_t)
+TRANSPOSE_PLANE_SCALAR(transpose_plane_64, uint64_t)
+
+static void transpose_plane_bytes(const uint8_t* in, uint8_t* out, int x_num, int y_num, size_t in_ld, size_t out_ld,
+                                  int elem_size)
+{
+    for (int y = 0; y < y_num; y++)
+    {
+        for (int x = 0; x < x_num; x++)
+            memcpy(out + (x * out_ld + y) * elem_size, in + (y * in_ld + x) * elem_size, elem_size);
+    }
+}
+
+static void transpose_plane(const struct transpose_job* job, const uint8_t* in, uint8_t* out, int x_num)
+{
+    int y_num = job->y_num;
+    size_t in_ld = job->in_ld;
+    size_t out_ld = job->out_ld;
+
+    switch (job->elem_size)
+    {
+    case 1:
+        transpose_plane_8(in, out, x_num, y_num, in_ld, out_ld);
+        break;
+    case 2:
+        transpose_plane_16((const uint16_t*)in, (uint16_t*)out, x_num, y_num, in_ld, out_ld);
+        break;
+    case 4:
+        transpose_plane_32((const uint32_t*)in, (uint32_t*)out, x_num, y_num, in_ld, out_ld, job->avx2);
+        break;
+    case 8:
+        transpose_plane_64((const uint64_t*)in, (uint64_t*)out, x_num, y_num, in_ld, out_ld);
+        break;
+    default:
+        transpose_plane_bytes(in, out, x_num, y_num, in_ld, out_ld, job->elem_size);
+        break;
+    }
+}
+
+static void transpose_task(void* arg, int begin, int end)
+{
+    const struct transpose_job* job = (const struct transpose_job*)arg;
+    size_t unit = job->unit_per_task * begin;
+    size_t unit_end = job->unit_per_task * end;
+
+    if (unit_end > job->unit_num)
+        unit_end = job->unit_num;
+
+    if (unit >= unit_end)
+        return;
+
+    /* the index of the outer dims of the first unit */
+    int index[MAX_SHAPE_DIM_NUM];
+    size_t outer = unit / job->block_num;
+    int block = (int)(unit % job->block_num);
+    size_t in_offset = 0;
+    size_t out_offset = 0;
+
+    for (int i = job->outer_num - 1; i >= 0; i--)
+    {
+        index[i] = (int)(outer % job->outer_dims[i]);
+        outer /= job->outer_dims[i];
+
+        in_offset += index[i] * job->in_strides[i];
+        out_offset += index[i] * job->out_strides[i];
+    }
+
+    int elem_size = job->elem_size;
+
+    for (; unit < unit_end; unit++)
+    {
+        const uint8_t* in = job->input + in_offset * elem_size;
+        uint8_t* out = job->output + out_offset * elem_size;
+
+        if (job->copy)
+        {
+            memcpy(out, in, (size_t)job->x_num * elem_size);
+        }
+        else
+        {
+            int x = block * job->block;
+            int x_num = job->x_num - x < job->block ? job->x_num - x : job->block;
+
+            transpose_plane(job, in + x * elem_size, out + x * job->out_ld * elem_size, x_num);
+
+            if (++block < job->block_num)
+                continue;
+
+            block = 0;
+        }
+
+        /* the next outer index */
+        for (int i = job->outer_num - 1; i >= 0; i--)
+        {
+            in_offset += job->in_strides[i];
+            out_offset += job->out_strides[i];
+
+            if (++index[i] < job->outer_dims[i])
+                break;
+
+            in_offset -= index[i] * job->in_strides[i];
+            out_offset -= index[i] * job->out_strides[i];
+            index[i] = 0;
+        }
+    }
+}
+
+int ref_transpose(const void* input, void* output, const int* dims, const int* perm, int dim_num, int elem_size,
+                  int num_thread)
+{
+    if (dim_num < 1 || dim_num > MAX_SHAPE_DIM_NUM)
+        return -1;
+
+    int used = 0;
+    size_t total = 1;
+
+    for (int i = 0; i < dim_num; i++)
+    {
+        if (perm[i] < 0 || perm[i] >= dim_num || (used & (1 << perm[i])))
+            return -1;
+
+        used |= 1 << perm[i];
+        total *= dims[i];
+    }
+
+    if (total == 0)
+        return 0;
+
+    int new_dims[MAX_SHAPE_DIM_NUM];
+    int new_perm[MAX_SHAPE_DIM_NUM];
+    int num = collapse_perm(dims, perm, dim_num, new_dims, new_perm);
+
+    if (num <= 1)
+    {
+        memcpy(output, input, total * elem_size);
+        return 0;
+    }
+
+    size_t in_strides[MAX_SHAPE_DIM_NUM];
+    size_t out_strides[MAX_SHAPE_DIM_NUM];
+
+    in_strides[num - 1] = 1;
+    for (int i = num - 2; i >= 0; i--)
+        in_strides[i] = in_strides[i + 1] * new_dims[i + 1];
+
+    out_strides[num - 1] = 1;
+    for (int i = num - 2; i >= 0; i--)
+        out_strides[i] = out_strides[i + 1] * new_dims[new_perm[i + 1]];
+
+    struct transpose_job job;
+
+    job.input = (const uint8_t*)input;
+    job.output = (uint8_t*)output;
+    job.elem_size = elem_size;
+    job.outer_num = 0;
+    job.avx2 = 0;
+#if TRANSPOSE_REF_X86
+    job.avx2 = (get_cpu_isa() & CPU_ISA_AVX2) != 0;
+#endif
+
+    /* the innermost input dim stays innermost as the dims are merged, or else is swapped with a dim */
+    job.copy = new_perm[num - 1] == num - 1;
+
+    int inner = 0;
+    while (new_perm[inner] != num - 1)
+        inner++;
+
+    job.x_num = new_dims[num - 1];
+    job.y_num = new_dims[new_perm[num - 1]];
+    job.in_ld = in_strides[new_perm[num - 1]];
+    job.out_ld = out_strides[inner];
+
+    for (int i = 0; i < num - 1; i++)
+    {
+        if (!job.copy && i == inner)
+            continue;
+
+        job.outer_dims[job.outer_num] = new_dims[new_perm[i]];
+        job.in_strides[job.outer_num] = in_strides[new_perm[i]];
+        job.out_strides[job.outer_num] = out_strides[i];
+        job.outer_num++;
+    }
+
+    size_t outer_total = 1;
+    for (int i = 0; i < job.outer_num; i++)
+        outer_total *= job.outer_dims[i];
+
+    size_t unit_size;
+
+    if (job.copy)
+    {
+        job.block = job.x_num;
+        job.block_num = 1;
+        unit_size = (size_t)job.x_num * elem_size;
+    }
+    else
+    {
+        job.block = elem_size < TRANSPOSE_REF_BLOCK ? TRANSPOSE_REF_BLOCK / elem_size : 1;
+        job.block_num = (job.x_num + job.block - 1) / job.block;
+        unit_size = (size_t)job.block * job.y_num * elem_size;
+    }
+
+    job.unit_num = outer_total * job.block_num;
+    job.unit_per_task = (TRANSPOSE_REF_TASK_SIZE + unit_size - 1) / unit_size;
+
+    size_t task_num = (job.unit_num + job.unit_per_task - 1) / job.unit_per_task;
+
+    parallel_for(transpose_task, &job, (int)task_num, num_thread);
+
+    return 0;
+}
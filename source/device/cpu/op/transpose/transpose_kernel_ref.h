@@ -0,0 +1,42 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef __TRANSPOSE_KERNEL_REF_H__
+#define __TRANSPOSE_KERNEL_REF_H__
+
+/*
+ * the permute engine of transpose, permute, swap_axis, depthtospace, spacetodepth and
+ * shuffle_channel. the dim i of the output is the dim perm[i] of the input, the elements are
+ * moved as bytes, so it is the same for any data type of elem_size bytes.
+ *
+ * the dims of size 1 are dropped and the dims staying adjacent are merged first. then the runs
+ * contiguous in both the input and the output are copied, or else the planes of the innermost
+ * input dim and the innermost output dim are transposed in cache sized blocks of simd tiles.
+ * the outer dims and the blocks are split over the threads.
+ *
+ * return -1 for a perm not a permutation of [0, dim_num), the input and the output must not overlap.
+ */
+int ref_transpose(const void* input, void* output, const int* dims, const int* perm, int dim_num, int elem_size,
+                  int num_thread);
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef _TRANSPOSE_KERNEL_X86_H_
+#define _TRANSPOSE_KERNEL_X86_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * only for the cpu with avx2, out[x * out_ld + y] = in[y * in_ld + x] of the 32 bit elements
+ * in tiles of 8 y and 8 x. the y of the tiles are done, return their count, the rest is left.
+ */
+int transpose_x86_plane_32_avx2(const uint32_t* in, uint32_t* out, int x_num, int y_num, size_t in_ld, size_t out_ld);
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "transpose_kernel_x86.h"
+
+#if __AVX__
+#include <immintrin.h>
+
+static inline void transpose_8x8(const uint32_t* in, size_t in_ld, uint32_t* out, size_t out_ld)
+{
+    __m256 _r0 = _mm256_loadu_ps((const float*)(in));
+    __m256 _r1 = _mm256_loadu_ps((const float*)(in + in_ld));
+    __m256 _r2 = _mm256_loadu_ps((const float*)(in + in_ld * 2));
+    __m256 _r3 = _mm256_loadu_ps((const float*)(in + in_ld * 3));
+    __m256 _r4 = _mm256_loadu_ps((const float*)(in + in_ld * 4));
+    __m256 _r5 = _mm256_loadu_ps((const float*)(in + in_ld * 5));
+    __m256 _r6 = _mm256_loadu_ps((const float*)(in + in_ld * 6));
+    __m256 _r7 = _mm256_loadu_ps((const float*)(in + in_ld * 7));
+
+    /* only shuffles, the bits of any data type are kept */
+    __m256 _t0 = _mm256_unpacklo_ps(_r0, _r1);
+    __m256 _t1 = _mm256_unpackhi_ps(_r0, _r1);
+    __m256 _t2 = _mm256_unpacklo_ps(_r2, _r3);
+    __m256 _t3 = _mm256_unpackhi_ps(_r2, _r3);
+    __m256 _t4 = _mm256_unpacklo_ps(_r4, _r5);
+    __m256 _t5 = _mm256_unpackhi_ps(_r4, _r5);
+    __m256 _t6 = _mm256_unpacklo_ps(_r6, _r7);
+    __m256 _t7 = _mm256_unpackhi_ps(_r6, _r7);
+
+    __m256 _s0 = _mm256_shuffle_ps(_t0, _t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 _s1 = _mm256_shuffle_ps(_t0, _t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 _s2 = _mm256_shuffle_ps(_t1, _t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 _s3 = _mm256_shuffle_ps(_t1, _t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 _s4 = _mm256_shuffle_ps(_t4, _t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 _s5 = _mm256_shuffle_ps(_t4, _t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 _s6 = _mm256_shuffle_ps(_t5, _t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 _s7 = _mm256_shuffle_ps(_t5, _t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    _mm256_storeu_ps((float*)(out), _mm256_permute2f128_ps(_s0, _s4, 0x20));
+    _mm256_storeu_ps((float*)(out + out_ld), _mm256_permute2f128_ps(_s1, _s5, 0x20));
+    _mm256_storeu_ps((float*)(out + out_ld * 2), _mm256_permute2f128_ps(_s2, _s6, 0x20));
+    _mm256_storeu_ps((float*)(out + out_ld * 3), _mm256_permute2f128_ps(_s3, _s7, 0x20));
+    _mm256_storeu_ps((float*)(out + out_ld * 4), _mm256_permute2f128_ps(_s0, _s4, 0x31));
+    _mm256_storeu_ps((float*)(out + out_ld * 5), _mm256_permute2f128_ps(_s1, _s5, 0x31));
+    _mm256_storeu_ps((float*)(out + out_ld * 6), _mm256_permute2f128_ps(_s2, _s6, 0x31));
+    _mm256_storeu_ps((float*)(out + out_ld * 7), _mm256_permute2f128_ps(_s3, _s7, 0x31));
+}
+#endif
+
+int transpose_x86_plane_32_avx2(const uint32_t* in, uint32_t* out, int x_num, int y_num, size_t in_ld, size_t out_ld)
+{
+    int y = 0;
+
+#if __AVX__
+    for (; y + 7 < y_num; y += 8)
+    {
+        int x = 0;
+        for (; x + 7 < x_num; x += 8)
+            transpose_8x8(in + y * in_ld + x, in_ld, out + x * out_ld + y, out_ld);
+
+        for (; x < x_num; x++)
+        {
+            for (int k = 0; k < 8; k++)
+                out[x * out_ld + y + k] = in[(y + k) * in_ld + x];
+        }
+    }
+#endif
+
+    return y;
+}
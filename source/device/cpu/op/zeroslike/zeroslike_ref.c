@@ -28,11 +28,26 @@
 #include "utility/sys_port.h"
 #include "utility/float.h"
 #include "utility/log.h"
+#include "system/thread_pool.h"
 #include "device/cpu/cpu_node.h"
 #include "device/cpu/cpu_graph.h"
 #include "device/cpu/cpu_module.h"
 
 #include <math.h>
+#include <string.h>
+
+struct zeroslike_job
+{
+    uint8_t* out_data;
+    int c_step; /* in bytes */
+};
+
+static void zeroslike_channel(void* arg, int begin, int end)
+{
+    struct zeroslike_job* job = (struct zeroslike_job*)arg;
+
+    memset(job->out_data + (size_t)job->c_step * begin, 0, (size_t)job->c_step * (end - begin));
+}
 
 int ref_zeroslike_fp32(struct tensor* input_tensor, struct tensor* output_tensor, int num_thread)
 {
@@ -56,23 +71,14 @@ int ref_zeroslike_fp32(struct tensor* input_tensor, struct tensor* output_tensor
         int w = input_tensor->dims[3];
         int h = output_tensor->dims[2];
         int channels = input_tensor->dims[1];
-        int size = h * w;
         int c_step = h * w;
 
-        float* input_data = (float*)input_tensor->data;
-        float* out_data = (float*)output_tensor->data;
+        struct zeroslike_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-        for (int q = 0; q < channels; q++)
-        {
-            float* src = input_data + c_step * q;
-            float* dst = out_data + c_step * q;
+        job.out_data = (uint8_t*)output_tensor->data;
+        job.c_step = c_step * (int)sizeof(float);
 
-            for (int i = 0; i < size; i++)
-            {
-                dst[i] = 0.f;
-            }
-        }
+        parallel_for(zeroslike_channel, &job, channels, num_thread);
 
         return 0;
     }
@@ -102,23 +108,14 @@ int ref_zeroslike_uint8(struct tensor* input_tensor, struct tensor* output_tenso
         int w = input_tensor->dims[3];
         int h = output_tensor->dims[2];
         int channels = input_tensor->dims[1];
-        int size = h * w;
         int c_step = h * w;
 
-        uint8_t* input_data = (uint8_t*)input_tensor->data;
-        uint8_t* out_data = (uint8_t*)output_tensor->data;
+        struct zeroslike_job job;
 
-#pragma omp parallel for num_threads(num_thread)
-        for (int q = 0; q < channels; q++)
-        {
-            uint8_t* src = input_data + c_step * q;
-            uint8_t* dst = out_data + c_step * q;
+        job.out_data = (uint8_t*)output_tensor->data;
+        job.c_step = c_step;
 
-            for (int i = 0; i < size; i++)
-            {
-                dst[i] = 0;
-            }
-        }
+        parallel_for(zeroslike_channel, &job, channels, num_thread);
 
         return 0;
     }
@@ -48,10 +48,7 @@ void destroy_attribute(struct graph* graph, ir_attribute_t* attribute)
         sys_free(attribute->device_privacy);
     }
 
-    if (NULL != attribute->scheduler_privacy)
-    {
-        sys_free(attribute->scheduler_privacy);
-    }
+    /* scheduler_privacy is released by the scheduler in destroy_graph */
 
     sys_free(attribute);
 }
@@ -0,0 +1,414 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "executer/profile.h"
+
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "operator/op.h"
+#include "system/thread_pool.h"
+#include "utility/sys_port.h"
+#include "utility/utils.h"
+#include "utility/log.h"
+
+#include "convolution_param.h"
+#include "deconv_param.h"
+#include "pooling_param.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static double get_monotonic_time(void)
+{
+#ifdef _MSC_VER
+    LARGE_INTEGER freq;
+    LARGE_INTEGER pc;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&pc);
+
+    return pc.QuadPart * 1000.0 / freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+static inline int fetch_add(int* value, int add)
+{
+#ifdef __GNUC__
+    return __atomic_fetch_add(value, add, __ATOMIC_RELAXED);
+#else
+    int old = *value;
+    *value += add;
+    return old;
+#endif
+}
+
+static inline unsigned int fetch_add_unsigned(unsigned int* value, unsigned int add)
+{
+#ifdef __GNUC__
+    return __atomic_fetch_add(value, add, __ATOMIC_RELAXED);
+#else
+    unsigned int old = *value;
+    *value += add;
+    return old;
+#endif
+}
+
+ir_profile_t* create_profile(int record_size)
+{
+    if (record_size <= 0)
+        return NULL;
+
+    ir_profile_t* profile = (ir_profile_t*)sys_malloc(sizeof(ir_profile_t));
+
+    if (NULL == profile)
+        return NULL;
+
+    profile->record_list = (profile_record_t*)sys_malloc(sizeof(profile_record_t) * record_size);
+
+    if (NULL == profile->record_list)
+    {
+        sys_free(profile);
+        return NULL;
+    }
+
+    profile->record_size = record_size;
+
+    reset_profile(profile);
+
+    return profile;
+}
+
+void destroy_profile(ir_profile_t* profile)
+{
+    if (NULL == profile)
+        return;
+
+    sys_free(profile->record_list);
+    sys_free(profile);
+}
+
+void reset_profile(ir_profile_t* profile)
+{
+    profile->record_count = 0;
+    profile->run_count = 0;
+    profile->base_time = get_monotonic_time();
+}
+
+void begin_profile_run(ir_profile_t* profile)
+{
+    fetch_add(&profile->run_count, 1);
+}
+
+double get_profile_time(const ir_profile_t* profile)
+{
+    return get_monotonic_time() - profile->base_time;
+}
+
+/* the multiply and add of each weight for each output, or one operation for each output of the other ops */
+static double get_node_flops(struct node* ir_node)
+{
+    struct graph* ir_graph = ir_node->graph;
+    struct tensor* output = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    double output_num = (double)output->elem_num;
+
+    switch (ir_node->op.type)
+    {
+    case OP_CONV:
+    case OP_FC:
+    {
+        /* the weight of [out][in ...], the inputs of each output */
+        struct tensor* weight = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+
+        if (weight->dim_num < 2 || weight->dims[0] == 0)
+            return output_num;
+
+        return output_num * (double)(weight->elem_num / weight->dims[0]) * 2.;
+    }
+    case OP_DECONV:
+    {
+        /* each input is scattered to the kernel of each output channel of its group */
+        struct deconv_param* param = (struct deconv_param*)ir_node->op.param_mem;
+        struct tensor* input = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+        int group = param->group > 0 ? param->group : 1;
+
+        return (double)input->elem_num * (double)(param->num_output / group) * param->kernel_h * param->kernel_w * 2.;
+    }
+    case OP_POOL:
+    {
+        struct pool_param* param = (struct pool_param*)ir_node->op.param_mem;
+
+        return output_num * param->kernel_h * param->kernel_w;
+    }
+    default:
+        return output_num;
+    }
+}
+
+static double get_node_bytes(struct node* ir_node)
+{
+    struct graph* ir_graph = ir_node->graph;
+    double bytes = 0.;
+
+    for (int i = 0; i < ir_node->input_num; i++)
+        bytes += (double)get_ir_tensor_mem_size(get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]));
+
+    for (int i = 0; i < ir_node->output_num; i++)
+        bytes += (double)get_ir_tensor_mem_size(get_ir_graph_tensor(ir_graph, ir_node->output_tensors[i]));
+
+    return bytes;
+}
+
+void record_profile_node(ir_profile_t* profile, struct node* ir_node, const char* device, const char* kernel,
+                         double start_time, double end_time)
+{
+    /* unsigned, so the slot stays in the ring however many records are taken */
+    unsigned int count = fetch_add_unsigned(&profile->record_count, 1);
+    profile_record_t* record = &profile->record_list[count % (unsigned int)profile->record_size];
+
+    record->node_idx = ir_node->index;
+    record->node_name = ir_node->name;
+    record->op_name = get_op_name_from_type(ir_node->op.type);
+    record->device = device;
+    record->kernel = NULL != kernel ? kernel : "unknown";
+    record->run_idx = profile->run_count - 1;
+    record->thread_id = get_parallel_thread_id();
+    record->start_time = start_time;
+    record->end_time = end_time;
+    record->flops = get_node_flops(ir_node);
+    record->bytes = get_node_bytes(ir_node);
+}
+
+int get_profile_record_number(const ir_profile_t* profile)
+{
+    return profile->record_count < (unsigned int)profile->record_size ? (int)profile->record_count : profile->record_size;
+}
+
+const profile_record_t* get_profile_record(const ir_profile_t* profile, int index)
+{
+    int number = get_profile_record_number(profile);
+
+    if (index < 0 || index >= number)
+        return NULL;
+
+    /* the oldest record kept is the one after the last taken */
+    unsigned int first = profile->record_count - number;
+
+    return &profile->record_list[(first + index) % (unsigned int)profile->record_size];
+}
+
+/* the json is written like snprintf(), the length counts on after the buffer is full */
+struct json_writer
+{
+    char* buf;
+    int size;
+    int len;
+};
+
+static void write_json(struct json_writer* writer, const char* format, ...)
+{
+    int room = writer->len < writer->size ? writer->size - writer->len : 0;
+    va_list args;
+
+    va_start(args, format);
+    int len = vsnprintf(room > 0 ? writer->buf + writer->len : NULL, room, format, args);
+    va_end(args);
+
+    if (len > 0)
+        writer->len += len;
+}
+
+static void write_json_string(struct json_writer* writer, const char* str)
+{
+    write_json(writer, "\"");
+
+    for (const char* p = (NULL != str ? str : ""); *p; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+
+        if (c == '"' || c == '\\')
+            write_json(writer, "\\%c", c);
+        else if (c < 0x20)
+            write_json(writer, "\\u%04x", c);
+        else
+            write_json(writer, "%c", c);
+    }
+
+    write_json(writer, "\"");
+}
+
+static void write_chrome_trace(const ir_profile_t* profile, struct json_writer* writer)
+{
+    int number = get_profile_record_number(profile);
+
+    write_json(writer, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    for (int i = 0; i < number; i++)
+    {
+        const profile_record_t* record = get_profile_record(profile, i);
+
+        write_json(writer, "%s\n{\"name\":", i > 0 ? "," : "");
+        write_json_string(writer, record->node_name);
+        write_json(writer, ",\"cat\":");
+        write_json_string(writer, record->op_name);
+        write_json(writer, ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"node\":%d,\"kernel\":",
+                   record->thread_id, record->start_time * 1000., (record->end_time - record->start_time) * 1000.,
+                   record->node_idx);
+        write_json_string(writer, record->kernel);
+        write_json(writer, ",\"device\":");
+        write_json_string(writer, record->device);
+        write_json(writer, ",\"run\":%d,\"flops\":%.0f,\"bytes\":%.0f}}", record->run_idx, record->flops, record->bytes);
+    }
+
+    write_json(writer, "\n]}\n");
+}
+
+struct node_summary
+{
+    const profile_record_t* last;
+    int count;
+    double total;
+    double min;
+    double max;
+};
+
+static int write_summary(const ir_profile_t* profile, struct json_writer* writer)
+{
+    int number = get_profile_record_number(profile);
+    int node_num = 0;
+
+    for (int i = 0; i < number; i++)
+    {
+        const profile_record_t* record = get_profile_record(profile, i);
+
+        if (record->node_idx + 1 > node_num)
+            node_num = record->node_idx + 1;
+    }
+
+    struct node_summary* summary = NULL;
+
+    if (node_num > 0)
+    {
+        summary = (struct node_summary*)sys_malloc(sizeof(struct node_summary) * node_num);
+
+        if (NULL == summary)
+            return -1;
+
+        memset(summary, 0, sizeof(struct node_summary) * node_num);
+    }
+
+    double total = 0.;
+
+    for (int i = 0; i < number; i++)
+    {
+        const profile_record_t* record = get_profile_record(profile, i);
+        struct node_summary* node = &summary[record->node_idx];
+        double time = record->end_time - record->start_time;
+
+        if (node->count == 0 || time < node->min)
+            node->min = time;
+        if (node->count == 0 || time > node->max)
+            node->max = time;
+
+        node->last = record;
+        node->count++;
+        node->total += time;
+        total += time;
+    }
+
+    write_json(writer, "{\"runs\":%d,\"records\":%d,\"dropped\":%u,\"time_ms\":%.6f,\"nodes\":[", profile->run_count,
+               number, profile->record_count - number, total);
+
+    int first = 1;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        const struct node_summary* node = &summary[i];
+        const profile_record_t* record = node->last;
+
+        if (node->count == 0)
+            continue;
+
+        double avg = node->total / node->count;
+
+        write_json(writer, "%s\n{\"node\":%d,\"name\":", first ? "" : ",", i);
+        write_json_string(writer, record->node_name);
+        write_json(writer, ",\"op\":");
+        write_json_string(writer, record->op_name);
+        write_json(writer, ",\"device\":");
+        write_json_string(writer, record->device);
+        write_json(writer, ",\"kernel\":");
+        write_json_string(writer, record->kernel);
+        write_json(writer, ",\"count\":%d,\"total_ms\":%.6f,\"avg_ms\":%.6f,\"min_ms\":%.6f,\"max_ms\":%.6f", node->count,
+                   node->total, avg, node->min, node->max);
+        write_json(writer, ",\"flops\":%.0f,\"bytes\":%.0f,\"gflops\":%.3f}", record->flops, record->bytes,
+                   avg > 0. ? record->flops / avg / 1000000. : 0.);
+
+        first = 0;
+    }
+
+    write_json(writer, "\n]}\n");
+
+    sys_free(summary);
+
+    return 0;
+}
+
+int export_profile(const ir_profile_t* profile, int format, char* buf, int size)
+{
+    struct json_writer writer;
+
+    writer.buf = buf;
+    writer.size = NULL != buf && size > 0 ? size : 0;
+    writer.len = 0;
+
+    if (writer.size > 0)
+        buf[0] = '\0';
+
+    switch (format)
+    {
+    case GRAPH_PROFILE_CHROME_TRACE:
+        write_chrome_trace(profile, &writer);
+        break;
+    case GRAPH_PROFILE_SUMMARY:
+        if (write_summary(profile, &writer) < 0)
+            return -1;
+        break;
+    default:
+        TLOG_ERR("Tengine: Profile format %d is not supported.\n", format);
+        return -1;
+    }
+
+    return writer.len;
+}
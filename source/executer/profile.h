@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#pragma once
+
+#include "api/c_api.h"
+
+struct node;
+
+/*!
+ * @struct ir_profile_t
+ * @brief  The profile of a graph, a ring of the records of the node runs
+ */
+typedef struct profile
+{
+    profile_record_t* record_list; //!< the ring of the records
+    int record_size;               //!< the max count of the records kept
+    unsigned int record_count;     //!< the records ever taken, the last record_size ones are kept
+    int run_count;                 //!< the runs of the graph begun
+    double base_time;              //!< the time the record times count from
+} ir_profile_t;
+
+/*!
+ * @brief  Create a profile.
+ *
+ * @param [in]  record_size: the max count of the records kept.
+ *
+ * @return the profile, NULL for failure.
+ */
+ir_profile_t* create_profile(int record_size);
+
+/*!
+ * @brief  Destroy a profile.
+ *
+ * @param [in]  profile: specific profile.
+ */
+void destroy_profile(ir_profile_t* profile);
+
+/*!
+ * @brief  Drop the records and the runs, the record times restart from 0.
+ *
+ * @param [in]  profile: specific profile.
+ */
+void reset_profile(ir_profile_t* profile);
+
+/*!
+ * @brief  Count a run of the graph, before its nodes run.
+ *
+ * @param [in]  profile: specific profile.
+ */
+void begin_profile_run(ir_profile_t* profile);
+
+/*!
+ * @brief  Get the time of the profile.
+ *
+ * @param [in]  profile: specific profile.
+ *
+ * @return the ms since the profile was created or reset.
+ */
+double get_profile_time(const ir_profile_t* profile);
+
+/*!
+ * @brief  Record a run of a node, it may be called by several threads at the same time.
+ *
+ * @param [in]  profile: specific profile.
+ * @param [in]  ir_node: the node.
+ * @param [in]  device: the name of the device running the node.
+ * @param [in]  kernel: the name of the kernel implementation, NULL for unknown.
+ * @param [in]  start_time: the time the node started, by get_profile_time().
+ * @param [in]  end_time: the time the node ended, by get_profile_time().
+ */
+void record_profile_node(ir_profile_t* profile, struct node* ir_node, const char* device, const char* kernel,
+                         double start_time, double end_time);
+
+/*!
+ * @brief  Get the count of the records kept.
+ *
+ * @param [in]  profile: specific profile.
+ *
+ * @return the record count.
+ */
+int get_profile_record_number(const ir_profile_t* profile);
+
+/*!
+ * @brief  Get a record kept, from the oldest one.
+ *
+ * @param [in]  profile: specific profile.
+ * @param [in]  index: the index of the record.
+ *
+ * @return the record, NULL for the index out of range.
+ */
+const profile_record_t* get_profile_record(const ir_profile_t* profile, int index);
+
+/*!
+ * @brief  Export the records as json, like snprintf().
+ *
+ * @param [in]  profile: specific profile.
+ * @param [in]  format: GRAPH_PROFILE_CHROME_TRACE or GRAPH_PROFILE_SUMMARY.
+ * @param [out] buf: the buffer, NULL for the length only.
+ * @param [in]  size: the size of the buffer.
+ *
+ * @return the length of the json, -1 for failure.
+ */
+int export_profile(const ir_profile_t* profile, int format, char* buf, int size);
@@ -32,7 +32,10 @@
 #include "graph/node.h"
 #include "graph/subgraph.h"
 #include "executer/executer.h"
+#include "executer/profile.h"
 #include "serializer/serializer.h"
+#include "operator/op.h"
+#include "module/module.h"
 #include "utility/utils.h"
 #include "utility/log.h"
 
@@ -79,6 +82,11 @@ void init_ir_graph(ir_graph_t* graph, struct context* context)
 
     graph->status = GRAPH_STAT_CREATED;
 
+    graph->profile = NULL;
+
+    graph->origin = NULL;
+    graph->instance_count = 1;
+
     init_attribute(graph->attribute, context);
 }
 
@@ -127,9 +135,192 @@ void destroy_ir_graph(ir_graph_t* graph)
         destroy_attribute(graph, graph->attribute);
     }
 
+    destroy_profile(graph->profile);
+
     sys_free(graph);
 }
 
+static int clone_ir_tensor(ir_graph_t* clone, const ir_tensor_t* tensor)
+{
+    ir_tensor_t* new_tensor = create_ir_tensor(clone, tensor->name, tensor->data_type);
+    if (NULL == new_tensor)
+    {
+        return -1;
+    }
+
+    new_tensor->producer = tensor->producer;
+    new_tensor->tensor_type = tensor->tensor_type;
+    new_tensor->elem_size = tensor->elem_size;
+    new_tensor->layout = tensor->layout;
+    new_tensor->dim_num = tensor->dim_num;
+    new_tensor->elem_num = tensor->elem_num;
+
+    for (int i = 0; i < tensor->consumer_num; i++)
+    {
+        if (0 != set_ir_tensor_consumer(new_tensor, tensor->consumer[i]))
+        {
+            return -1;
+        }
+    }
+
+    memcpy(new_tensor->dims, tensor->dims, sizeof(tensor->dims));
+
+    /* the consts are read only, the other tensors get their own memory in prerun */
+    if (TENSOR_TYPE_CONST == tensor->tensor_type)
+    {
+        new_tensor->data = tensor->data;
+    }
+
+    new_tensor->quant_param_num = tensor->quant_param_num;
+
+    if (tensor->quant_param_num > 1)
+    {
+        new_tensor->scale_list = (float*)sys_malloc(sizeof(float) * tensor->quant_param_num);
+        new_tensor->zp_list = (int*)sys_malloc(sizeof(int) * tensor->quant_param_num);
+
+        if (NULL == new_tensor->scale_list || NULL == new_tensor->zp_list)
+        {
+            return -1;
+        }
+
+        memcpy(new_tensor->scale_list, tensor->scale_list, sizeof(float) * tensor->quant_param_num);
+        memcpy(new_tensor->zp_list, tensor->zp_list, sizeof(int) * tensor->quant_param_num);
+    }
+    else
+    {
+        new_tensor->scale = tensor->scale;
+        new_tensor->zero_point = tensor->zero_point;
+    }
+
+    return 0;
+}
+
+static int clone_ir_node(ir_graph_t* clone, const ir_node_t* node)
+{
+    ir_node_t* new_node = create_ir_node(clone, node->name, node->op.type, node->op.version);
+    if (NULL == new_node)
+    {
+        return -1;
+    }
+
+    /* infer_shape and the kernels may write the op params, so each instance has a copy of them. the arrays
+     * they point to are set by the loaders, read only, and stay with the origin */
+    ir_method_t* method = find_op_method(node->op.type, node->op.version);
+
+    if (NULL != method && NULL != method->release)
+    {
+        method->release(&new_node->op);
+    }
+
+    new_node->op = node->op;
+    new_node->op.param_mem = NULL;
+
+    if (0 < node->op.param_size && NULL != node->op.param_mem)
+    {
+        new_node->op.param_mem = sys_malloc(node->op.param_size);
+        if (NULL == new_node->op.param_mem)
+        {
+            return -1;
+        }
+
+        memcpy(new_node->op.param_mem, node->op.param_mem, node->op.param_size);
+    }
+    new_node->dynamic_shape = node->dynamic_shape;
+    new_node->node_type = node->node_type;
+
+    if (0 < node->input_num)
+    {
+        new_node->input_tensors = (uint16_t*)sys_malloc(sizeof(uint16_t) * node->input_num);
+        if (NULL == new_node->input_tensors)
+        {
+            return -1;
+        }
+
+        memcpy(new_node->input_tensors, node->input_tensors, sizeof(uint16_t) * node->input_num);
+        new_node->input_num = node->input_num;
+    }
+
+    if (0 < node->output_num)
+    {
+        new_node->output_tensors = (uint16_t*)sys_malloc(sizeof(uint16_t) * node->output_num);
+        if (NULL == new_node->output_tensors)
+        {
+            return -1;
+        }
+
+        memcpy(new_node->output_tensors, node->output_tensors, sizeof(uint16_t) * node->output_num);
+        new_node->output_num = node->output_num;
+    }
+
+    return 0;
+}
+
+static int fetch_add_instance(ir_graph_t* graph, int add)
+{
+#ifdef __GNUC__
+    return __atomic_add_fetch(&graph->instance_count, add, __ATOMIC_ACQ_REL);
+#else
+    graph->instance_count += add;
+    return graph->instance_count;
+#endif
+}
+
+ir_graph_t* clone_ir_graph(ir_graph_t* graph, struct context* context)
+{
+    /* the clones of a clone share the same origin */
+    ir_graph_t* origin = NULL != graph->origin ? graph->origin : graph;
+
+    ir_graph_t* clone = create_ir_graph(context);
+    if (NULL == clone)
+    {
+        return NULL;
+    }
+
+    /* set before the nodes are created, the arrays their op params share are not released with them */
+    clone->origin = origin;
+    fetch_add_instance(origin, 1);
+
+    clone->graph_layout = graph->graph_layout;
+    clone->model_layout = graph->model_layout;
+    clone->model_format = graph->model_format;
+    clone->device = graph->device;
+
+    for (int i = 0; i < graph->tensor_num; i++)
+    {
+        if (0 != clone_ir_tensor(clone, graph->tensor_list[i]))
+        {
+            destroy_ir_graph(clone);
+            release_ir_graph_instance(origin);
+            return NULL;
+        }
+    }
+
+    for (int i = 0; i < graph->node_num; i++)
+    {
+        if (0 != clone_ir_node(clone, graph->node_list[i]))
+        {
+            destroy_ir_graph(clone);
+            release_ir_graph_instance(origin);
+            return NULL;
+        }
+    }
+
+    if ((0 < graph->input_num && 0 != set_ir_graph_input_node(clone, graph->input_nodes, graph->input_num))
+        || (0 < graph->output_num && 0 != set_ir_graph_output_node(clone, graph->output_nodes, graph->output_num)))
+    {
+        destroy_ir_graph(clone);
+        release_ir_graph_instance(origin);
+        return NULL;
+    }
+
+    return clone;
+}
+
+int release_ir_graph_instance(ir_graph_t* graph)
+{
+    return fetch_add_instance(graph, -1);
+}
+
 int set_ir_graph_input_node(ir_graph_t* graph, int16_t input_nodes[], int input_number)
 {
     if (0 >= input_number)
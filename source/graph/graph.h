@@ -36,6 +36,7 @@ struct node;
 struct tensor;
 struct device;
 struct attribute;
+struct profile;
 
 /*!
  * @struct ir_graph_t
@@ -68,6 +69,11 @@ typedef struct graph
     struct attribute* attribute; //<! attribute of graph
 
     struct vector* subgraph_list; //!< subgraph list of this graph
+
+    struct profile* profile; //!< the node run records, NULL for not profiled
+
+    struct graph* origin; //!< the graph this one is cloned from, NULL for none, see clone_ir_graph()
+    int instance_count;   //!< the graph and its clones not destroyed, the last one destroys the graph
 } ir_graph_t;
 
 /*!
@@ -96,6 +102,29 @@ void init_ir_graph(ir_graph_t* graph, struct context* context);
  */
 void destroy_ir_graph(ir_graph_t* graph);
 
+/*!
+ * @brief Clone a prerun graph into another instance.
+ *
+ * The clone shares the const tensor data of the graph read only, it owns a copy of
+ * the op params, its other tensors and nodes and must be prerun itself. The origin graph is
+ * kept until its clones are destroyed, see release_ir_graph_instance().
+ *
+ * @param [in]  graph: specific graph, or a clone of it.
+ * @param [in]  context: specific context for the clone.
+ *
+ * @return  The pointer of the clone, NULL for failure.
+ */
+ir_graph_t* clone_ir_graph(ir_graph_t* graph, struct context* context);
+
+/*!
+ * @brief Drop an instance of an origin graph, it is destroyed with the last one.
+ *
+ * @param [in]  graph: the origin graph.
+ *
+ * @return  The instances left, 0 for the graph to be destroyed.
+ */
+int release_ir_graph_instance(ir_graph_t* graph);
+
 /*!
  * @brief Set input nodes for specific graph.
  *
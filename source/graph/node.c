@@ -118,7 +118,12 @@ void destroy_ir_node(struct graph* ir_graph, ir_node_t* ir_node)
 
     ir_method_t* method = find_op_method(ir_node->op.type, ir_node->op.version);
 
-    if (NULL != method && NULL != method->release)
+    /* the op params of a clone are a copy, the arrays they point to belong to its origin graph */
+    if (NULL != ir_graph->origin)
+    {
+        sys_free(ir_node->op.param_mem);
+    }
+    else if (NULL != method && NULL != method->release)
     {
         method->release(&ir_node->op);
     }
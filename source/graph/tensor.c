@@ -189,6 +189,75 @@ int set_ir_tensor_shape(ir_tensor_t* tensor, const int dims[], int dim_number)
     return 0;
 }
 
+int get_ir_tensor_broadcast_shape(const ir_tensor_t* a, const ir_tensor_t* b, int dims[])
+{
+    int dim_num = a->dim_num > b->dim_num ? a->dim_num : b->dim_num;
+
+    if (dim_num > MAX_SHAPE_DIM_NUM)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < dim_num; i++)
+    {
+        int a_index = i - (dim_num - a->dim_num);
+        int b_index = i - (dim_num - b->dim_num);
+        int a_dim = a_index >= 0 ? a->dims[a_index] : 1;
+        int b_dim = b_index >= 0 ? b->dims[b_index] : 1;
+
+        if (a_dim != b_dim && a_dim != 1 && b_dim != 1)
+        {
+            return -1;
+        }
+
+        dims[i] = a_dim == 1 ? b_dim : a_dim;
+    }
+
+    return dim_num;
+}
+
+int get_layout_channel_block(int layout)
+{
+    switch (layout)
+    {
+    case TENGINE_LAYOUT_NC4HW4:
+        return 4;
+    case TENGINE_LAYOUT_NC8HW8:
+        return 8;
+    case TENGINE_LAYOUT_NC16HW16:
+        return 16;
+    default:
+        return 1;
+    }
+}
+
+int get_channel_block_layout(int block)
+{
+    switch (block)
+    {
+    case 4:
+        return TENGINE_LAYOUT_NC4HW4;
+    case 8:
+        return TENGINE_LAYOUT_NC8HW8;
+    case 16:
+        return TENGINE_LAYOUT_NC16HW16;
+    default:
+        return -1;
+    }
+}
+
+size_t get_ir_tensor_mem_size(const ir_tensor_t* ir_tensor)
+{
+    int block = get_layout_channel_block(ir_tensor->layout);
+
+    if (block == 1 || ir_tensor->dim_num != 4)
+        return (size_t)ir_tensor->elem_size * ir_tensor->elem_num;
+
+    int channel = (ir_tensor->dims[1] + block - 1) / block * block;
+
+    return (size_t)ir_tensor->elem_size * ir_tensor->dims[0] * channel * ir_tensor->dims[2] * ir_tensor->dims[3];
+}
+
 char* create_ir_tensor_name_from_index(int index)
 {
     char* name = (char*)sys_malloc(TE_COMMON_ALIGN_SIZE * 2);
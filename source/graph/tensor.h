@@ -31,11 +31,21 @@ extern "C" {
 
 #include "defines.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 struct node;
 struct graph;
 
+/*
+ * the blocked layouts a device may keep its 4d tensors in between its kernels,
+ * NCHW with the channels cut in blocks of 4, 8 or 16, the channels of a block
+ * are interleaved for each pixel, and the last block is padded.
+ */
+#define TENGINE_LAYOUT_NC4HW4   2
+#define TENGINE_LAYOUT_NC8HW8   3
+#define TENGINE_LAYOUT_NC16HW16 4
+
 /*!
  * @struct ir_tensor_t
  * @brief  Abstract tensor intermediate representation
@@ -55,7 +65,7 @@ typedef struct tensor
     uint8_t subgraph_num;       //!< count of all subgraphs which will wait for this tensor to be ready
     uint8_t free_host_mem;      //!< should free host memory?
     uint8_t internal_allocated; //!< how memory is allocated?
-    uint8_t layout;             //!< tensor layout: { TENGINE_LAYOUT_NCHW, TENGINE_LAYOUT_NHWC }
+    uint8_t layout;             //!< tensor layout: { TENGINE_LAYOUT_NCHW, TENGINE_LAYOUT_NHWC, blocked ones }
 
     uint16_t quant_param_num;       //!< quantization dimension
     uint32_t elem_num;              //!< count of total elements
@@ -133,6 +143,46 @@ void destroy_ir_tensor(struct graph* ir_graph, ir_tensor_t* ir_tensor);
  */
 int set_ir_tensor_shape(ir_tensor_t* ir_tensor, const int dims[], int dim_number);
 
+/*!
+ * @brief  Get the shape two tensors broadcast to, numpy style.
+ *
+ * The dims are aligned to the right, a dim of size 1 or missing is broadcast to the other.
+ *
+ * @param [in]  a: one tensor.
+ * @param [in]  b: the other tensor.
+ * @param [out] dims: the broadcast shape, MAX_SHAPE_DIM_NUM dims at most.
+ *
+ * @return the dim number of the shape, -1 for the shapes not broadcast.
+ */
+int get_ir_tensor_broadcast_shape(const ir_tensor_t* a, const ir_tensor_t* b, int dims[]);
+
+/*!
+ * @brief  Get the channel block of a layout.
+ *
+ * @param [in]  layout: tensor layout.
+ *
+ * @return the channels of a block, 1 for the layouts not blocked.
+ */
+int get_layout_channel_block(int layout);
+
+/*!
+ * @brief  Get the blocked layout of a channel block.
+ *
+ * @param [in]  block: the channels of a block, 4, 8 or 16.
+ *
+ * @return the layout, -1 for the block having no layout.
+ */
+int get_channel_block_layout(int block);
+
+/*!
+ * @brief  Get the memory size of a tensor, with the padded channels of a blocked layout.
+ *
+ * @param [in]  ir_tensor: specific tensor.
+ *
+ * @return the size in bytes.
+ */
+size_t get_ir_tensor_mem_size(const ir_tensor_t* ir_tensor);
+
 /*!
  * @brief  Set tensor name from id, for anonymity ones.
  *
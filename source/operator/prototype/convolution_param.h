@@ -71,5 +71,20 @@ struct conv_priv_info
     int* multi;
     int activation_min;
     int activation_max;
+
+    /* x86 int8 sgemm */
+    int sgemm_i8_kernel;
+    int* sgemm_i8_offset;
+    float* sgemm_i8_scales;
+
+    /* x86 blocked layout */
+    int nchwc;            // the input or the output is blocked
+    float* nchwc_weight;  // the weights packed by the output channel blocks, then the bias padded to them
+    float* nchwc_input;   // the plain input of depthwise packed by the channel blocks
+    int nchwc_input_size; // input data transform buffer size
+
+    /* the packed weights of the prepack cache or its share, the kernels use them instead of packing, and never free them */
+    void* cached_weight;
+    int cached_weight_size;
 };
 #endif
@@ -71,6 +71,19 @@ static int infer_shape(struct node* node)
         dim_num = input1->dim_num;
     }
 
+    /* the inputs of the same dim number both broadcast, such as [n, 1] and [1, m] */
+    int dims[MAX_SHAPE_DIM_NUM];
+
+    if (input0->dim_num == input1->dim_num && get_ir_tensor_broadcast_shape(input0, input1, dims) == dim_num)
+    {
+        int size = 1;
+        for (int i = 0; i < dim_num; i++)
+            size *= dims[i];
+
+        if (size > i0_size && size > i1_size)
+            memcpy(output->dims, dims, dim_num * sizeof(int));
+    }
+
     set_ir_tensor_shape(output, output->dims, dim_num);
 
     return 0;
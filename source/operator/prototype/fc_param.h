@@ -27,4 +27,5 @@
 struct fc_param
 {
     int num_output;
+    int activation; // fused relu (0) or relu6 (6), -1 for none, for fp32 only
 };
@@ -36,6 +36,7 @@ static int infer_shape(struct node* node)
 {
     struct graph* ir_graph = node->graph;
     struct tensor* input = get_ir_graph_tensor(ir_graph, node->input_tensors[0]);
+    struct tensor* weight = get_ir_graph_tensor(ir_graph, node->input_tensors[1]);
     struct tensor* output = get_ir_graph_tensor(ir_graph, node->output_tensors[0]);
     struct lstm_param* lstm_param = (struct lstm_param*)(node->op.param_mem);
     int batch_size = input->dims[1];
@@ -47,7 +48,7 @@ static int infer_shape(struct node* node)
     if (lstm_param->mxnet_flag == 0)
     {
         dims[0] = input->dims[0];
-        dims[1] = 1;
+        dims[1] = weight->dim_num == 3 ? weight->dims[0] : 1; /* the directions */
         dims[2] = input->dims[1];
         dims[3] = lstm_param->hidden_size;
     }
@@ -184,6 +184,9 @@ static int init_op(ir_op_t* op)
     slice_param->ismxnet = 0;
     slice_param->isonnx = 0;
     slice_param->step = 1;
+    slice_param->slice_point_ = NULL;
+    slice_param->begin_ = NULL;
+    slice_param->size_ = NULL;
 
     op->param_mem = slice_param;
     op->param_size = sizeof(struct slice_param);
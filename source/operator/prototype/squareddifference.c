@@ -22,6 +22,7 @@
  * Author: qtang@openailab.com
  */
 
+#include "api/c_api.h"
 #include "graph/tensor.h"
 #include "graph/node.h"
 #include "graph/graph.h"
@@ -34,18 +35,15 @@ static int infer_shape(struct node* node)
     struct tensor* input1 = get_ir_graph_tensor(graph, node->input_tensors[1]);
     struct tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
 
-    /* assert inputs shape */
-    if (input0->dim_num != input1->dim_num)
-        return -1;
+    /* the inputs are broadcast numpy style */
+    int dims[MAX_SHAPE_DIM_NUM];
+    int dim_num = get_ir_tensor_broadcast_shape(input0, input1, dims);
 
-    for (int i = 0; i < input0->dim_num; i++)
-    {
-        if (input0->dims[i] != input1->dims[i])
-            return -1;
-    }
+    if (dim_num < 0)
+        return -1;
 
     /* set output shape */
-    set_ir_tensor_shape(output, input0->dims, input0->dim_num);
+    set_ir_tensor_shape(output, dims, dim_num);
 
     return 0;
 }
@@ -42,30 +42,21 @@ static int infer_shape(struct node* node)
     {
         return -1;
     }
-    int in_size = 1;
-    for (int i = 0; i < input->dim_num; i++)
-    {
-        in_size *= input->dims[i];
-    }
-    int out_size = 1;
-    for (int i = 0; i < output->dim_num; i++)
-    {
-        out_size *= output->dims[i];
-    }
-    if (in_size != 1 || out_size != 1)
+    int dim_num = input->dim_num;
+    if (swap_axis_param->dim_0 < 0 || swap_axis_param->dim_1 < 0)
         return -1;
 
-    if (swap_axis_param->dim_0 >= in_size || swap_axis_param->dim_1 >= in_size)
+    if (swap_axis_param->dim_0 >= dim_num || swap_axis_param->dim_1 >= dim_num)
         return -1;
 
-    int* newdim = (int*)sys_malloc(in_size * sizeof(int));
-    for (int i = 0; i < in_size; i++)
+    int* newdim = (int*)sys_malloc(dim_num * sizeof(int));
+    for (int i = 0; i < dim_num; i++)
     {
         newdim[i] = input->dims[i];
     }
     newdim[swap_axis_param->dim_0] = input->dims[swap_axis_param->dim_1];
     newdim[swap_axis_param->dim_1] = input->dims[swap_axis_param->dim_0];
-    set_ir_tensor_shape(output, newdim, in_size);
+    set_ir_tensor_shape(output, newdim, dim_num);
 
     sys_free(newdim);
     return 0;
@@ -0,0 +1,889 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "optimizer/fusion.h"
+
+#include "convolution_param.h"
+#include "fc_param.h"
+#include "batchnorm_param.h"
+#include "eltwise_param.h"
+#include "relu_param.h"
+#include "clip_param.h"
+
+#include "api/c_api.h"
+#include "graph/tensor.h"
+#include "graph/node.h"
+#include "graph/graph.h"
+#include "module/module.h"
+#include "operator/op.h"
+#include "utility/sys_port.h"
+#include "utility/log.h"
+
+#include <math.h>
+#include <string.h>
+
+/* nodes and tensors are only marked while fusing, the graph is compacted once at the end */
+struct fusion
+{
+    struct graph* graph;
+    int precision;
+    int node_cap;
+    int tensor_cap;
+    uint8_t* node_dead;
+    uint8_t* tensor_dead;
+    int fused;
+};
+
+static int is_output_tensor(struct graph* graph, const struct tensor* tensor)
+{
+    for (int i = 0; i < graph->output_num; i++)
+    {
+        struct node* node = get_ir_graph_node(graph, graph->output_nodes[i]);
+
+        for (int j = 0; j < node->output_num; j++)
+        {
+            if (node->output_tensors[j] == tensor->index)
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* the tensor is read by the node only, and the user cannot read it either */
+static int is_private_tensor(struct graph* graph, const struct tensor* tensor, const struct node* node)
+{
+    return tensor->consumer_num == 1 && tensor->consumer[0] == node->index && !is_output_tensor(graph, tensor);
+}
+
+static int is_fp32_const(const struct tensor* tensor, int elem_num)
+{
+    return tensor->tensor_type == TENSOR_TYPE_CONST && tensor->data_type == TENGINE_DT_FP32 && tensor->data != NULL
+           && (int)tensor->elem_num == elem_num;
+}
+
+static int is_fp32_var(const struct tensor* tensor)
+{
+    return tensor->tensor_type == TENSOR_TYPE_VAR && tensor->data_type == TENGINE_DT_FP32;
+}
+
+static int same_shape(const struct tensor* a, const struct tensor* b)
+{
+    if (a->dim_num != b->dim_num)
+        return 0;
+
+    for (int i = 0; i < a->dim_num; i++)
+    {
+        if (a->dims[i] != b->dims[i])
+            return 0;
+    }
+
+    return 1;
+}
+
+static struct node* get_producer(struct graph* graph, const struct tensor* tensor)
+{
+    if (tensor->producer < 0)
+        return NULL;
+
+    return get_ir_graph_node(graph, tensor->producer);
+}
+
+static void remove_consumer(struct tensor* tensor, int node_index)
+{
+    for (int i = 0; i < tensor->consumer_num; i++)
+    {
+        if (tensor->consumer[i] == node_index)
+        {
+            for (int j = i + 1; j < tensor->consumer_num; j++)
+                tensor->consumer[j - 1] = tensor->consumer[j];
+
+            tensor->consumer_num--;
+            return;
+        }
+    }
+}
+
+/* the weights may live in the model file or in a buffer of the user, they are copied before being changed */
+static int own_tensor_data(struct tensor* tensor)
+{
+    if (tensor->free_host_mem)
+        return 0;
+
+    size_t size = (size_t)tensor->elem_num * tensor->elem_size;
+    void* data = sys_malloc(size);
+
+    if (data == NULL)
+        return -1;
+
+    memcpy(data, tensor->data, size);
+
+    tensor->data = data;
+    tensor->free_host_mem = 1;
+
+    return 0;
+}
+
+/* the node leaves the graph, with the consts only it was reading */
+static void kill_node(struct fusion* f, struct node* node)
+{
+    struct graph* graph = f->graph;
+
+    for (int i = 0; i < node->input_num; i++)
+    {
+        struct tensor* tensor = get_ir_graph_tensor(graph, node->input_tensors[i]);
+        struct node* producer = get_producer(graph, tensor);
+
+        remove_consumer(tensor, node->index);
+
+        if (tensor->consumer_num == 0 && producer != NULL && producer->op.type == OP_CONST && !is_output_tensor(graph, tensor))
+        {
+            f->node_dead[producer->index] = 1;
+            f->tensor_dead[tensor->index] = 1;
+        }
+    }
+
+    f->node_dead[node->index] = 1;
+    f->fused++;
+}
+
+/*
+ * the node reading the output of pre is merged into pre: pre writes the output
+ * of the node, so the names and the graph outputs are kept.
+ */
+static void merge_node(struct fusion* f, struct node* pre, struct node* node)
+{
+    struct graph* graph = f->graph;
+    struct tensor* input = NULL;
+    struct tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+    for (int i = 0; i < node->input_num; i++)
+    {
+        input = get_ir_graph_tensor(graph, node->input_tensors[i]);
+        if (input->producer == pre->index)
+            break;
+    }
+
+    for (int i = 0; i < pre->output_num; i++)
+    {
+        if (pre->output_tensors[i] == input->index)
+            pre->output_tensors[i] = output->index;
+    }
+
+    output->producer = pre->index;
+
+    for (int i = 0; i < graph->output_num; i++)
+    {
+        if (graph->output_nodes[i] == node->index)
+            graph->output_nodes[i] = pre->index;
+    }
+
+    kill_node(f, node);
+    f->tensor_dead[input->index] = 1;
+}
+
+/* a zero bias is added to the conv or fc without one, the residual input goes after it */
+static struct tensor* get_bias(struct fusion* f, struct node* node, int channel)
+{
+    struct graph* graph = f->graph;
+
+    if (node->input_num > 2)
+    {
+        struct tensor* bias = get_ir_graph_tensor(graph, node->input_tensors[2]);
+
+        if (!is_fp32_const(bias, channel) || !is_private_tensor(graph, bias, node))
+            return NULL;
+
+        return bias;
+    }
+
+    if (graph->node_num >= f->node_cap || graph->tensor_num >= f->tensor_cap)
+        return NULL;
+
+    char name[256];
+    snprintf(name, sizeof(name), "%s.bias", node->name ? node->name : "fused");
+
+    struct node* bias_node = create_ir_node(graph, name, OP_CONST, 1);
+    if (bias_node == NULL)
+        return NULL;
+
+    struct tensor* bias = create_ir_tensor(graph, name, TENGINE_DT_FP32);
+    if (bias == NULL)
+        return NULL;
+
+    f->node_dead[bias_node->index] = 0;
+    f->tensor_dead[bias->index] = 0;
+
+    bias->tensor_type = TENSOR_TYPE_CONST;
+    set_ir_tensor_shape(bias, &channel, 1);
+
+    bias->data = sys_malloc(sizeof(float) * channel);
+    if (bias->data == NULL)
+        return NULL;
+
+    memset(bias->data, 0, sizeof(float) * channel);
+    bias->free_host_mem = 1;
+
+    set_ir_node_output_tensor(bias_node, 0, bias);
+
+    if (set_ir_node_input_tensor(node, 2, bias) < 0)
+        return NULL;
+
+    return bias;
+}
+
+/* the weights of the conv or fc ahead of the node, if the node may be folded into them */
+static struct node* get_foldable_weight_node(struct fusion* f, struct node* node, int* channel)
+{
+    struct graph* graph = f->graph;
+    struct tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+    struct node* pre = get_producer(graph, input);
+
+    if (pre == NULL || pre->dynamic_shape || node->dynamic_shape || !is_fp32_var(input) || input->dim_num < 2)
+        return NULL;
+    if (!is_private_tensor(graph, input, node) || pre->output_num != 1)
+        return NULL;
+
+    struct tensor* weight = get_ir_graph_tensor(graph, pre->input_tensors[1]);
+
+    if (pre->op.type == OP_CONV)
+    {
+        struct conv_param* param = (struct conv_param*)pre->op.param_mem;
+
+        if (param->activation >= 0 || pre->input_num > 3 || weight->dims[0] != param->output_channel)
+            return NULL;
+    }
+    else if (pre->op.type == OP_FC)
+    {
+        struct fc_param* param = (struct fc_param*)pre->op.param_mem;
+
+        if (param->activation >= 0 || weight->dims[0] != param->num_output)
+            return NULL;
+    }
+    else
+        return NULL;
+
+    *channel = weight->dims[0];
+
+    if (input->dims[1] != *channel || !is_fp32_const(weight, weight->elem_num) || !is_private_tensor(graph, weight, pre))
+        return NULL;
+
+    if (pre->input_num > 2)
+    {
+        struct tensor* bias = get_ir_graph_tensor(graph, pre->input_tensors[2]);
+
+        if (!is_fp32_const(bias, *channel) || !is_private_tensor(graph, bias, pre))
+            return NULL;
+    }
+
+    return pre;
+}
+
+/* y = x * scale + shift per output channel, folded into the weights and the bias */
+static int fold_affine(struct fusion* f, struct node* pre, int channel, const float* scale, const float* shift)
+{
+    struct graph* graph = f->graph;
+    struct tensor* weight = get_ir_graph_tensor(graph, pre->input_tensors[1]);
+    struct tensor* bias = get_bias(f, pre, channel);
+
+    if (bias == NULL || own_tensor_data(weight) < 0 || own_tensor_data(bias) < 0)
+        return -1;
+
+    float* weight_data = (float*)weight->data;
+    float* bias_data = (float*)bias->data;
+    int size = weight->elem_num / channel;
+
+    for (int c = 0; c < channel; c++)
+    {
+        float* w = weight_data + (size_t)c * size;
+
+        for (int i = 0; i < size; i++)
+            w[i] *= scale[c];
+
+        bias_data[c] = bias_data[c] * scale[c] + shift[c];
+    }
+
+    return 0;
+}
+
+/* the batchnorm as a per channel scale and shift, see the batchnorm ref op */
+static int get_batchnorm_affine(struct graph* graph, struct node* node, int channel, float* scale, float* shift)
+{
+    struct batchnorm_param* param = (struct batchnorm_param*)node->op.param_mem;
+
+    if (node->input_num < 5)
+        return -1;
+
+    struct tensor* mean_tensor = get_ir_graph_tensor(graph, node->input_tensors[3]);
+    struct tensor* var_tensor = get_ir_graph_tensor(graph, node->input_tensors[4]);
+
+    if (!is_fp32_const(mean_tensor, channel) || !is_fp32_const(var_tensor, channel))
+        return -1;
+
+    const float* mean = (const float*)mean_tensor->data;
+    const float* var = (const float*)var_tensor->data;
+    const float* gamma = NULL;
+    const float* beta = NULL;
+
+    if (!param->caffe_flavor)
+    {
+        struct tensor* gamma_tensor = get_ir_graph_tensor(graph, node->input_tensors[1]);
+        struct tensor* beta_tensor = get_ir_graph_tensor(graph, node->input_tensors[2]);
+
+        if (!is_fp32_const(gamma_tensor, channel) || !is_fp32_const(beta_tensor, channel))
+            return -1;
+
+        gamma = (const float*)gamma_tensor->data;
+        beta = (const float*)beta_tensor->data;
+    }
+
+    float rescale_factor = param->rescale_factor ? 1 / param->rescale_factor : 0;
+
+    for (int c = 0; c < channel; c++)
+    {
+        scale[c] = 1.f / sqrtf(var[c] * rescale_factor + param->eps);
+        shift[c] = -mean[c] * rescale_factor * scale[c];
+
+        if (gamma)
+        {
+            scale[c] *= gamma[c];
+            shift[c] = shift[c] * gamma[c] + beta[c];
+        }
+    }
+
+    return 0;
+}
+
+static int get_scale_affine(struct graph* graph, struct node* node, int channel, float* scale, float* shift)
+{
+    struct tensor* gamma_tensor = get_ir_graph_tensor(graph, node->input_tensors[1]);
+
+    if (!is_fp32_const(gamma_tensor, channel))
+        return -1;
+
+    memcpy(scale, gamma_tensor->data, sizeof(float) * channel);
+    memset(shift, 0, sizeof(float) * channel);
+
+    if (node->input_num > 2)
+    {
+        struct tensor* beta_tensor = get_ir_graph_tensor(graph, node->input_tensors[2]);
+
+        if (!is_fp32_const(beta_tensor, channel))
+            return -1;
+
+        memcpy(shift, beta_tensor->data, sizeof(float) * channel);
+    }
+
+    return 0;
+}
+
+/* conv or fc, then batchnorm or scale */
+static int fuse_weight_affine(struct fusion* f)
+{
+    struct graph* graph = f->graph;
+    int node_num = graph->node_num;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct node* node = get_ir_graph_node(graph, i);
+        int channel;
+
+        if (f->node_dead[i] || (node->op.type != OP_BATCHNORM && node->op.type != OP_SCALE) || node->input_num < 2)
+            continue;
+
+        struct node* pre = get_foldable_weight_node(f, node, &channel);
+        if (pre == NULL)
+            continue;
+
+        float* scale = (float*)sys_malloc(sizeof(float) * channel * 2);
+        float* shift = scale + channel;
+        int ret;
+
+        if (scale == NULL)
+            return -1;
+
+        if (node->op.type == OP_BATCHNORM)
+            ret = get_batchnorm_affine(graph, node, channel, scale, shift);
+        else
+            ret = get_scale_affine(graph, node, channel, scale, shift);
+
+        if (ret == 0)
+        {
+            if (fold_affine(f, pre, channel, scale, shift) < 0)
+            {
+                sys_free(scale);
+                TLOG_ERR("Tengine: fold %s into %s failed.\n", node->name, pre->name);
+                return -1;
+            }
+
+            merge_node(f, pre, node);
+        }
+
+        sys_free(scale);
+    }
+
+    return 0;
+}
+
+/* a batchnorm read by a scale only is folded into the scale, which then reads the input of the batchnorm */
+static int fuse_batchnorm_scale(struct fusion* f)
+{
+    struct graph* graph = f->graph;
+    int node_num = graph->node_num;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct node* node = get_ir_graph_node(graph, i);
+
+        if (f->node_dead[i] || node->op.type != OP_SCALE || node->input_num != 3 || node->dynamic_shape)
+            continue;
+
+        struct tensor* bn_output = get_ir_graph_tensor(graph, node->input_tensors[0]);
+        struct node* bn = get_producer(graph, bn_output);
+
+        if (bn == NULL || bn->op.type != OP_BATCHNORM || bn->dynamic_shape || bn->output_num != 1)
+            continue;
+        if (!is_fp32_var(bn_output) || bn_output->dim_num < 2 || !is_private_tensor(graph, bn_output, node))
+            continue;
+
+        int channel = bn_output->dims[1];
+        struct tensor* gamma_tensor = get_ir_graph_tensor(graph, node->input_tensors[1]);
+        struct tensor* beta_tensor = get_ir_graph_tensor(graph, node->input_tensors[2]);
+
+        if (!is_fp32_const(gamma_tensor, channel) || !is_private_tensor(graph, gamma_tensor, node))
+            continue;
+        if (!is_fp32_const(beta_tensor, channel) || !is_private_tensor(graph, beta_tensor, node))
+            continue;
+
+        float* scale = (float*)sys_malloc(sizeof(float) * channel * 2);
+        float* shift = scale + channel;
+
+        if (scale == NULL)
+            return -1;
+
+        if (get_batchnorm_affine(graph, bn, channel, scale, shift) == 0)
+        {
+            if (own_tensor_data(gamma_tensor) < 0 || own_tensor_data(beta_tensor) < 0)
+            {
+                sys_free(scale);
+                return -1;
+            }
+
+            float* gamma = (float*)gamma_tensor->data;
+            float* beta = (float*)beta_tensor->data;
+
+            for (int c = 0; c < channel; c++)
+            {
+                beta[c] = shift[c] * gamma[c] + beta[c];
+                gamma[c] = scale[c] * gamma[c];
+            }
+
+            struct tensor* input = get_ir_graph_tensor(graph, bn->input_tensors[0]);
+
+            node->input_tensors[0] = input->index;
+            if (set_ir_tensor_consumer(input, node->index) < 0)
+            {
+                sys_free(scale);
+                return -1;
+            }
+
+            kill_node(f, bn);
+            f->tensor_dead[bn_output->index] = 1;
+        }
+
+        sys_free(scale);
+    }
+
+    return 0;
+}
+
+/* relu, then a min with 6, is relu6 */
+static int fuse_relu_min(struct fusion* f)
+{
+    struct graph* graph = f->graph;
+    int node_num = graph->node_num;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct node* node = get_ir_graph_node(graph, i);
+
+        if (f->node_dead[i] || node->op.type != OP_ELTWISE || node->input_num != 2 || node->dynamic_shape)
+            continue;
+
+        struct eltwise_param* param = (struct eltwise_param*)node->op.param_mem;
+        struct tensor* relu_output = get_ir_graph_tensor(graph, node->input_tensors[0]);
+        struct tensor* six = get_ir_graph_tensor(graph, node->input_tensors[1]);
+        struct node* relu = get_producer(graph, relu_output);
+
+        if (param->type != ELT_MIN_SCALAR || relu == NULL || relu->op.type != OP_RELU || relu->dynamic_shape)
+            continue;
+        if (((struct relu_param*)relu->op.param_mem)->negative_slope != 0.f)
+            continue;
+        if (!is_fp32_var(relu_output) || !is_private_tensor(graph, relu_output, node))
+            continue;
+        if (!is_fp32_const(six, 1) || ((float*)six->data)[0] != 6.f)
+            continue;
+
+        ir_method_t* relu_method = find_op_method(OP_RELU, relu->op.version);
+        ir_method_t* relu6_method = find_op_method(OP_RELU6, 1);
+
+        if (relu6_method == NULL || relu6_method->init == NULL)
+            continue;
+
+        if (relu_method && relu_method->release)
+            relu_method->release(&relu->op);
+
+        relu->op.type = OP_RELU6;
+        relu->op.version = 1;
+        relu->op.param_mem = NULL;
+
+        if (relu6_method->init(&relu->op) < 0)
+        {
+            TLOG_ERR("Tengine: init relu6 of %s failed.\n", relu->name);
+            return -1;
+        }
+
+        merge_node(f, relu, node);
+    }
+
+    return 0;
+}
+
+/* the tensor added to the output of a conv becomes the residual input of the conv */
+static int fuse_conv_residual(struct fusion* f)
+{
+    struct graph* graph = f->graph;
+    int node_num = graph->node_num;
+
+    if (f->precision != TENGINE_MODE_FP32)
+        return 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct node* node = get_ir_graph_node(graph, i);
+
+        if (f->node_dead[i] || node->op.type != OP_ELTWISE || node->input_num != 2 || node->dynamic_shape)
+            continue;
+
+        struct eltwise_param* param = (struct eltwise_param*)node->op.param_mem;
+        if (param->type != ELT_SUM)
+            continue;
+
+        /* the later conv of the two inputs runs after the other input is ready */
+        struct node* conv = NULL;
+        struct tensor* conv_output = NULL;
+        struct tensor* residual = NULL;
+
+        for (int j = 0; j < 2; j++)
+        {
+            struct tensor* input = get_ir_graph_tensor(graph, node->input_tensors[j]);
+            struct tensor* other = get_ir_graph_tensor(graph, node->input_tensors[1 - j]);
+            struct node* pre = get_producer(graph, input);
+
+            if (pre == NULL || pre->op.type != OP_CONV || pre->dynamic_shape || pre->output_num != 1 || pre->input_num > 3)
+                continue;
+            if (((struct conv_param*)pre->op.param_mem)->activation >= 0)
+                continue;
+            if (!is_fp32_var(input) || !is_private_tensor(graph, input, node) || input == other)
+                continue;
+            if (other->data_type != TENGINE_DT_FP32 || !same_shape(input, other) || other->producer >= pre->index)
+                continue;
+            if (conv != NULL && pre->index < conv->index)
+                continue;
+
+            conv = pre;
+            conv_output = input;
+            residual = other;
+        }
+
+        if (conv == NULL)
+            continue;
+
+        struct tensor* weight = get_ir_graph_tensor(graph, conv->input_tensors[1]);
+
+        if (get_bias(f, conv, weight->dims[0]) == NULL)
+            continue;
+
+        if (set_ir_node_input_tensor(conv, 3, residual) < 0)
+            return -1;
+
+        merge_node(f, conv, node);
+    }
+
+    return 0;
+}
+
+/* relu, relu6 or clip to 6, as the activation of the conv or fc ahead */
+static int fuse_activation(struct fusion* f)
+{
+    struct graph* graph = f->graph;
+    int node_num = graph->node_num;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct node* node = get_ir_graph_node(graph, i);
+        int activation;
+
+        if (f->node_dead[i] || node->dynamic_shape)
+            continue;
+
+        if (node->op.type == OP_RELU && ((struct relu_param*)node->op.param_mem)->negative_slope == 0.f)
+            activation = 0;
+        else if (node->op.type == OP_RELU6)
+            activation = 6;
+        else if (node->op.type == OP_CLIP && ((struct clip_param*)node->op.param_mem)->min == 0.f
+                 && ((struct clip_param*)node->op.param_mem)->max == 6.f)
+            activation = 6;
+        else
+            continue;
+
+        struct tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+        struct node* pre = get_producer(graph, input);
+
+        if (pre == NULL || pre->dynamic_shape || pre->output_num != 1)
+            continue;
+        if (!is_fp32_var(input) || !is_private_tensor(graph, input, node))
+            continue;
+
+        if (pre->op.type == OP_CONV)
+        {
+            struct conv_param* param = (struct conv_param*)pre->op.param_mem;
+
+            if (param->activation >= 0)
+                continue;
+
+            param->activation = activation;
+        }
+        else if (pre->op.type == OP_FC && f->precision == TENGINE_MODE_FP32)
+        {
+            struct fc_param* param = (struct fc_param*)pre->op.param_mem;
+
+            if (param->activation >= 0)
+                continue;
+
+            param->activation = activation;
+        }
+        else
+            continue;
+
+        merge_node(f, pre, node);
+    }
+
+    return 0;
+}
+
+static int is_identity_node(struct graph* graph, struct node* node)
+{
+    if (node->dynamic_shape || node->input_num < 1 || node->output_num != 1)
+        return 0;
+
+    struct tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+    struct tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+    if (input->data_type != output->data_type || input->elem_num != output->elem_num)
+        return 0;
+
+    switch (node->op.type)
+    {
+    case OP_DROPOUT:
+        return 1;
+    case OP_RESHAPE:
+    case OP_FLATTEN:
+        return same_shape(input, output);
+    default:
+        return 0;
+    }
+}
+
+/* dropout, and reshape or flatten keeping the shape, are removed */
+static int remove_identity(struct fusion* f)
+{
+    struct graph* graph = f->graph;
+    int node_num = graph->node_num;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct node* node = get_ir_graph_node(graph, i);
+
+        if (f->node_dead[i] || !is_identity_node(graph, node))
+            continue;
+
+        struct tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+        struct tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+        if (!is_output_tensor(graph, output))
+        {
+            /* the readers of the output read the input */
+            for (int j = 0; j < output->consumer_num; j++)
+            {
+                struct node* consumer = get_ir_graph_node(graph, output->consumer[j]);
+
+                for (int k = 0; k < consumer->input_num; k++)
+                {
+                    if (consumer->input_tensors[k] == output->index)
+                        consumer->input_tensors[k] = input->index;
+                }
+
+                if (set_ir_tensor_consumer(input, consumer->index) < 0)
+                    return -1;
+            }
+
+            kill_node(f, node);
+            f->tensor_dead[output->index] = 1;
+            continue;
+        }
+
+        /* a graph output keeps its name, the producer of the input writes it */
+        struct node* pre = get_producer(graph, input);
+
+        if (pre != NULL && pre->op.type != OP_INPUT && pre->op.type != OP_CONST && is_private_tensor(graph, input, node))
+            merge_node(f, pre, node);
+    }
+
+    return 0;
+}
+
+/* the dead nodes and tensors are destroyed, and the others renumbered */
+static int compact_graph(struct fusion* f)
+{
+    struct graph* graph = f->graph;
+    int node_num = graph->node_num;
+    int tensor_num = graph->tensor_num;
+
+    int* node_map = (int*)sys_malloc(sizeof(int) * (node_num + tensor_num));
+    int* tensor_map = node_map + node_num;
+
+    if (node_map == NULL)
+        return -1;
+
+    int n = 0;
+    for (int i = 0; i < node_num; i++)
+        node_map[i] = f->node_dead[i] ? -1 : n++;
+
+    int t = 0;
+    for (int i = 0; i < tensor_num; i++)
+        tensor_map[i] = f->tensor_dead[i] ? -1 : t++;
+
+    for (int i = 0; i < tensor_num; i++)
+    {
+        struct tensor* tensor = graph->tensor_list[i];
+
+        if (f->tensor_dead[i])
+        {
+            destroy_ir_tensor(graph, tensor);
+            continue;
+        }
+
+        int consumer_num = 0;
+        for (int j = 0; j < tensor->consumer_num; j++)
+        {
+            if (node_map[tensor->consumer[j]] >= 0)
+                tensor->consumer[consumer_num++] = node_map[tensor->consumer[j]];
+        }
+
+        tensor->consumer_num = consumer_num;
+        tensor->producer = tensor->producer >= 0 ? node_map[tensor->producer] : -1;
+        tensor->index = tensor_map[i];
+        graph->tensor_list[tensor_map[i]] = tensor;
+    }
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct node* node = graph->node_list[i];
+
+        if (f->node_dead[i])
+        {
+            destroy_ir_node(graph, node);
+            continue;
+        }
+
+        for (int j = 0; j < node->input_num; j++)
+            node->input_tensors[j] = tensor_map[node->input_tensors[j]];
+        for (int j = 0; j < node->output_num; j++)
+            node->output_tensors[j] = tensor_map[node->output_tensors[j]];
+
+        node->index = node_map[i];
+        graph->node_list[node_map[i]] = node;
+    }
+
+    for (int i = 0; i < graph->input_num; i++)
+        graph->input_nodes[i] = node_map[graph->input_nodes[i]];
+    for (int i = 0; i < graph->output_num; i++)
+        graph->output_nodes[i] = node_map[graph->output_nodes[i]];
+
+    graph->node_num = n;
+    graph->tensor_num = t;
+
+    sys_free(node_map);
+
+    return 0;
+}
+
+int fuse_ir_graph(struct graph* ir_graph, int precision)
+{
+    if (ir_graph->graph_layout != TENGINE_LAYOUT_NCHW)
+        return 0;
+
+    struct fusion f;
+    int weight_node_num = 0;
+
+    for (int i = 0; i < ir_graph->node_num; i++)
+    {
+        int type = get_ir_graph_node(ir_graph, i)->op.type;
+
+        if (type == OP_CONV || type == OP_FC)
+            weight_node_num++;
+    }
+
+    /* each conv or fc may get a bias */
+    f.graph = ir_graph;
+    f.precision = precision;
+    f.node_cap = ir_graph->node_num + weight_node_num;
+    f.tensor_cap = ir_graph->tensor_num + weight_node_num;
+    f.node_dead = (uint8_t*)sys_malloc(f.node_cap + f.tensor_cap);
+    f.tensor_dead = f.node_dead + f.node_cap;
+    f.fused = 0;
+
+    if (f.node_dead == NULL)
+        return -1;
+
+    memset(f.node_dead, 0, f.node_cap + f.tensor_cap);
+
+    int ret = -1;
+
+    if (remove_identity(&f) < 0 || fuse_weight_affine(&f) < 0 || fuse_batchnorm_scale(&f) < 0 || fuse_relu_min(&f) < 0
+        || fuse_conv_residual(&f) < 0 || fuse_activation(&f) < 0)
+        goto out;
+
+    if (f.fused > 0 && compact_graph(&f) < 0)
+        goto out;
+
+    TLOG_DEBUG("Tengine: %d nodes fused.\n", f.fused);
+
+    ret = 0;
+
+out:
+    sys_free(f.node_dead);
+
+    return ret;
+}
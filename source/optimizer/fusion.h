@@ -0,0 +1,43 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#pragma once
+
+struct graph;
+
+/*!
+ * @brief  Fuse the fp32 nodes of a loaded graph, before it is split.
+ *
+ *   BatchNorm and Scale are folded into the weights of the Convolution or
+ * FullyConnected ahead of them, ReLU and ReLU6 become the activation of the
+ * Convolution or FullyConnected, an Eltwise sum adding a tensor to the
+ * output of a Convolution becomes its residual input, and Dropout, Reshape
+ * and Flatten not changing the shape are removed. The residual and the
+ * activation of FullyConnected are only fused for the fp32 precision.
+ *
+ * @param [in]  ir_graph: specific graph, the shapes are inferred.
+ * @param [in]  precision: the precision the graph will run with.
+ *
+ * @return statue value, 0 success, other value failure.
+ */
+int fuse_ir_graph(struct graph* ir_graph, int precision);
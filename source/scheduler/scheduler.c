@@ -25,17 +25,24 @@
 
 #include "scheduler/scheduler.h"
 
+#include "defines.h"
 #include "api/c_api.h"
 #include "device/device.h"
 #include "graph/graph.h"
 #include "graph/subgraph.h"
 #include "executer/executer.h"
+#include "executer/profile.h"
+#include "system/thread_pool.h"
 #include "utility/sys_port.h"
 #include "utility/vector.h"
 #include "utility/log.h"
 
 #include <string.h>
 
+#ifdef TENGINE_HAS_LIB_POSIX_THREAD
+#include <pthread.h>
+#endif
+
 static int sched_prerun(ir_scheduler_t* scheduler, ir_graph_t* ir_graph)
 {
     int subgraph_num = get_vector_num(ir_graph->subgraph_list);
@@ -70,6 +77,45 @@ static int sched_prerun(ir_scheduler_t* scheduler, ir_graph_t* ir_graph)
     return 0;
 }
 
+struct group_job
+{
+    struct vector* wait_list;
+    int* ready_list;
+    int* group_list;
+    int ready_num;
+    int has_error;
+};
+
+/* runs the ready subgraphs of the device groups [begin, end) */
+static void run_subgraph_group(void* arg, int begin, int end)
+{
+    struct group_job* job = (struct group_job*)arg;
+
+    for (int g = begin; g < end; g++)
+    {
+        for (int i = 0; i < job->ready_num; i++)
+        {
+            if (job->group_list[i] != g)
+                continue;
+
+            struct subgraph* subgraph = *(struct subgraph**)get_vector_data(job->wait_list, job->ready_list[i]);
+            ir_device_t* nn_dev = subgraph->device;
+
+            subgraph->status = GRAPH_STAT_RUNNING;
+
+            if (nn_dev->interface->run(nn_dev, subgraph) < 0)
+            {
+                TLOG_ERR("run subgraph %d error!\n", subgraph->index);
+                subgraph->status = GRAPH_STAT_ERROR;
+                job->has_error = 1;
+                break;
+            }
+
+            subgraph->status = GRAPH_STAT_READY;
+        }
+    }
+}
+
 static int sched_run(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int block)
 {
     if (block == 0)
@@ -85,6 +131,11 @@ static int sched_run(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int block)
         return -1;
     }
 
+    if (NULL != ir_graph->profile)
+    {
+        begin_profile_run(ir_graph->profile);
+    }
+
     int subgraph_num = get_vector_num(ir_graph->subgraph_list);
 
     /* insert all subgraph into wait list */
@@ -95,16 +146,21 @@ static int sched_run(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int block)
         push_vector_data(wait_list, &subgraph);
     }
 
-    int* ready_list = (int*)sys_malloc(sizeof(int) * subgraph_num);
+    int* ready_list = (int*)sys_malloc(sizeof(int) * subgraph_num * 2);
 
     if (ready_list == NULL)
     {
+        release_vector(wait_list);
         return -1;
     }
 
+    /* device group of each ready subgraph */
+    int* group_list = ready_list + subgraph_num;
+
     while (1)
     {
         int ready_num = 0;
+        int group_num = 0;
         int wait_num = get_vector_num(wait_list);
 
         if (wait_num == 0)
@@ -114,31 +170,57 @@ static int sched_run(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int block)
         {
             struct subgraph* subgraph = *(struct subgraph**)get_vector_data(wait_list, i);
 
-            if (subgraph->input_ready_count == subgraph->input_wait_count)
-                ready_list[ready_num++] = i;
+            if (subgraph->input_ready_count != subgraph->input_wait_count)
+                continue;
+
+            group_list[ready_num] = group_num;
+
+            for (int j = 0; j < ready_num; j++)
+            {
+                struct subgraph* ready_graph = *(struct subgraph**)get_vector_data(wait_list, ready_list[j]);
+
+                if (ready_graph->device == subgraph->device)
+                {
+                    group_list[ready_num] = group_list[j];
+                    break;
+                }
+            }
+
+            if (group_list[ready_num] == group_num)
+                group_num++;
+
+            ready_list[ready_num++] = i;
         }
 
         if (ready_num == 0)
         {
             TLOG_ERR("no subgraph is ready, but there are still %d subgraphs in wait_list\n", wait_num);
+            sys_free(ready_list);
+            release_vector(wait_list);
+            return -1;
+        }
+
+        /* ready subgraphs are independent, the ones on different devices run at the same time */
+        struct group_job job;
+
+        job.wait_list = wait_list;
+        job.ready_list = ready_list;
+        job.group_list = group_list;
+        job.ready_num = ready_num;
+        job.has_error = 0;
+
+        parallel_for(run_subgraph_group, &job, group_num, group_num);
+
+        if (job.has_error)
+        {
+            sys_free(ready_list);
+            release_vector(wait_list);
             return -1;
         }
 
         for (int i = 0; i < ready_num; i++)
         {
             struct subgraph* subgraph = *(struct subgraph**)get_vector_data(wait_list, ready_list[i]);
-            ir_device_t* nn_dev = subgraph->device;
-
-            subgraph->status = GRAPH_STAT_RUNNING;
-
-            if (nn_dev->interface->run(nn_dev, subgraph) < 0)
-            {
-                TLOG_ERR("run subgraph %d error!\n", subgraph->index);
-                sys_free(ready_list);
-                release_vector(wait_list);
-                subgraph->status = GRAPH_STAT_ERROR;
-                return -1;
-            }
 
             for (int j = 0; j < get_vector_num(ir_graph->subgraph_list); j++)
             {
@@ -156,8 +238,6 @@ static int sched_run(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int block)
                     }
                 }
             }
-
-            subgraph->status = GRAPH_STAT_READY;
         }
 
         /* remove executed subgraph from list, should from higher idx to lower idx */
@@ -181,9 +261,10 @@ static int sched_run(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int block)
     return 0;
 }
 
-static int sched_wait(ir_scheduler_t* scheduler, ir_graph_t* ir_graph)
+static int sched_wait(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int try_wait)
 {
-    return -1;
+    /* every run of sync scheduler is finished before returning */
+    return ir_graph->status == GRAPH_STAT_READY ? 1 : -1;
 }
 
 static int sched_postrun(ir_scheduler_t* scheduler, ir_graph_t* ir_graph)
@@ -212,16 +293,239 @@ static int sched_postrun(ir_scheduler_t* scheduler, ir_graph_t* ir_graph)
         return 0;
 }
 
+static int sync_sched_run(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int block)
+{
+    ir_graph->status = GRAPH_STAT_RUNNING;
+
+    int ret = sched_run(scheduler, ir_graph, block);
+
+    ir_graph->status = ret < 0 ? GRAPH_STAT_ERROR : GRAPH_STAT_READY;
+
+    return ret;
+}
+
 static ir_scheduler_t sync_scheduler = {
     .name = "sync",
     .prerun = sched_prerun,
-    .run = sched_run,
+    .run = sync_sched_run,
     .wait = sched_wait,
     .postrun = sched_postrun,
     .release = NULL,
 };
 
+#ifdef TENGINE_HAS_LIB_POSIX_THREAD
+/*!
+ * @struct async_job
+ * @brief  Per graph worker of async scheduler, the graph owns at most one job in flight
+ */
+struct async_job
+{
+    pthread_t worker;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int pending; //!< a run is in flight, in the worker or in a blocking caller
+    int queued;  //!< the run in flight is for the worker
+    int quit;    //!< ask worker to exit
+    int result;  //!< return value of the last finished run
+    ir_scheduler_t* scheduler;
+    ir_graph_t* graph;
+};
+
+/* caller must hold job->lock */
+static void finish_async_run(struct async_job* job, int ret)
+{
+    job->result = ret;
+    job->graph->status = ret < 0 ? GRAPH_STAT_ERROR : GRAPH_STAT_READY;
+    job->pending = 0;
+    job->queued = 0;
+
+    pthread_cond_broadcast(&job->cond);
+}
+
+static void* async_worker(void* arg)
+{
+    struct async_job* job = (struct async_job*)arg;
+
+    pthread_mutex_lock(&job->lock);
+
+    while (1)
+    {
+        while (!job->queued && !job->quit)
+            pthread_cond_wait(&job->cond, &job->lock);
+
+        if (!job->queued)
+            break;
+
+        pthread_mutex_unlock(&job->lock);
+
+        int ret = sched_run(job->scheduler, job->graph, 1);
+
+        pthread_mutex_lock(&job->lock);
+
+        finish_async_run(job, ret);
+    }
+
+    pthread_mutex_unlock(&job->lock);
+
+    return NULL;
+}
+
+static struct async_job* get_async_job(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int create)
+{
+    struct async_job* job = (struct async_job*)ir_graph->attribute->scheduler_privacy;
+
+    if (NULL != job || !create)
+        return job;
+
+    job = (struct async_job*)sys_malloc(sizeof(struct async_job));
+    if (NULL == job)
+        return NULL;
+
+    memset(job, 0, sizeof(struct async_job));
+    job->scheduler = scheduler;
+    job->graph = ir_graph;
+
+    pthread_mutex_init(&job->lock, NULL);
+    pthread_cond_init(&job->cond, NULL);
+
+    if (0 != pthread_create(&job->worker, NULL, async_worker, job))
+    {
+        TLOG_ERR("Tengine: Create async worker for graph failed.\n");
+        pthread_cond_destroy(&job->cond);
+        pthread_mutex_destroy(&job->lock);
+        sys_free(job);
+        return NULL;
+    }
+
+    ir_graph->attribute->scheduler_privacy = job;
+
+    return job;
+}
+
+/* caller must hold job->lock */
+static void wait_async_job(struct async_job* job)
+{
+    while (job->pending)
+        pthread_cond_wait(&job->cond, &job->lock);
+}
+
+static void release_async_job(ir_graph_t* ir_graph)
+{
+    struct async_job* job = (struct async_job*)ir_graph->attribute->scheduler_privacy;
+
+    if (NULL == job)
+        return;
+
+    pthread_mutex_lock(&job->lock);
+    wait_async_job(job);
+    job->quit = 1;
+    pthread_cond_broadcast(&job->cond);
+    pthread_mutex_unlock(&job->lock);
+
+    pthread_join(job->worker, NULL);
+
+    pthread_cond_destroy(&job->cond);
+    pthread_mutex_destroy(&job->lock);
+    sys_free(job);
+
+    ir_graph->attribute->scheduler_privacy = NULL;
+}
+
+static int async_sched_run(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int block)
+{
+    struct async_job* job = get_async_job(scheduler, ir_graph, !block);
+
+    if (NULL == job)
+    {
+        if (!block)
+        {
+            ir_graph->status = GRAPH_STAT_ERROR;
+            return -1;
+        }
+
+        /* no non-blocking run was ever made, so there is no worker to race with */
+        return sync_sched_run(scheduler, ir_graph, 1);
+    }
+
+    pthread_mutex_lock(&job->lock);
+
+    /* inputs and outputs belong to the graph, so a new run has to wait for the one in flight */
+    wait_async_job(job);
+
+    ir_graph->status = GRAPH_STAT_RUNNING;
+    job->pending = 1;
+
+    if (block)
+    {
+        pthread_mutex_unlock(&job->lock);
+
+        int ret = sched_run(scheduler, ir_graph, 1);
+
+        pthread_mutex_lock(&job->lock);
+        finish_async_run(job, ret);
+        pthread_mutex_unlock(&job->lock);
+
+        return ret;
+    }
+
+    job->queued = 1;
+    pthread_cond_broadcast(&job->cond);
+    pthread_mutex_unlock(&job->lock);
+
+    return 0;
+}
+
+static int async_sched_wait(ir_scheduler_t* scheduler, ir_graph_t* ir_graph, int try_wait)
+{
+    struct async_job* job = get_async_job(scheduler, ir_graph, 0);
+
+    if (NULL == job)
+        return ir_graph->status == GRAPH_STAT_ERROR ? -1 : 1;
+
+    pthread_mutex_lock(&job->lock);
+
+    if (job->pending && try_wait)
+    {
+        pthread_mutex_unlock(&job->lock);
+        return 0;
+    }
+
+    wait_async_job(job);
+
+    int ret = job->result < 0 ? -1 : 1;
+
+    pthread_mutex_unlock(&job->lock);
+
+    return ret;
+}
+
+static int async_sched_postrun(ir_scheduler_t* scheduler, ir_graph_t* ir_graph)
+{
+    release_async_job(ir_graph);
+
+    return sched_postrun(scheduler, ir_graph);
+}
+
+static void async_sched_release(ir_scheduler_t* scheduler, ir_graph_t* ir_graph)
+{
+    release_async_job(ir_graph);
+}
+
+static ir_scheduler_t async_scheduler = {
+    .name = "async",
+    .prerun = sched_prerun,
+    .run = async_sched_run,
+    .wait = async_sched_wait,
+    .postrun = async_sched_postrun,
+    .release = async_sched_release,
+};
+#endif
+
 ir_scheduler_t* find_default_scheduler(void)
 {
+#ifdef TENGINE_HAS_LIB_POSIX_THREAD
+    return &async_scheduler;
+#else
     return &sync_scheduler;
+#endif
 }
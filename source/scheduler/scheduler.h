@@ -38,15 +38,17 @@ typedef struct scheduler
 
     int (*prerun)(struct scheduler*, struct graph*);
     int (*run)(struct scheduler*, struct graph*, int block);
-    int (*wait)(struct scheduler*, struct graph*);
+    int (*wait)(struct scheduler*, struct graph*, int try_wait);
     int (*postrun)(struct scheduler*, struct graph*);
-    void (*release)(struct scheduler*);
+    void (*release)(struct scheduler*, struct graph*); //!< free what the scheduler keeps for the graph, on destroy
 } ir_scheduler_t;
 
 /*!
- * @brief  Dump the node.
+ * @brief  Get the default scheduler, "async" if posix thread is available, otherwise "sync".
+ *         Both run blocking requests in the caller thread, "async" hands non-blocking
+ *         requests to a per graph worker thread, which is released in postrun or when
+ *         the graph is destroyed. The schedulers set the status of the graph for its runs.
  *
- * @param [in]  graph: specific graph.
- * @param [in]  node: specific node.
+ * @return The default scheduler.
  */
 struct scheduler* find_default_scheduler(void);
@@ -154,6 +154,97 @@ static int unregister_tm2_op_loader(struct tm2_serializer* s, int op_type, int o
     return -1;
 }
 
+/*
+ * permute a 4 dims const tensor from nhwc to nchw.
+ * the source data is never written: mapped models keep their pages shared with the page cache,
+ * so only the permuted tensors get a private copy.
+ */
+static int permute_const_tensor(struct tensor* ir_tensor, struct tm2_priv* priv)
+{
+    int type = ir_tensor->data_type;
+
+    if (type != TENGINE_DT_FP32 && type != TENGINE_DT_UINT8 && type != TENGINE_DT_INT8)
+        return 0;
+
+    int elem_size = ir_tensor->elem_size;
+    int size = ir_tensor->elem_num * elem_size;
+
+    const char* input = (const char*)ir_tensor->data;
+    char* output = NULL;
+    char* tensor_data_org = NULL;
+
+    if (priv->mem_type == TM2_MEM_HEAP)
+    {
+        /* the model buffer is private already, permute it in place */
+        tensor_data_org = (char*)sys_malloc(size);
+        if (NULL == tensor_data_org)
+            return -1;
+
+        memcpy(tensor_data_org, input, size);
+        input = tensor_data_org;
+        output = (char*)ir_tensor->data;
+    }
+    else
+    {
+        output = (char*)sys_malloc(size);
+        if (NULL == output)
+            return -1;
+    }
+
+    int cout = ir_tensor->dims[0];
+    int cin = ir_tensor->dims[1];
+    int h = ir_tensor->dims[2];
+    int w = ir_tensor->dims[3];
+
+    if (cin == 1)
+    {
+        for (int co = 0; co < cout; co++)
+        {
+            for (int hi = 0; hi < h; hi++)
+            {
+                for (int wi = 0; wi < w; wi++)
+                {
+                    int offset_org = co + hi * w * cout + wi * cout;
+                    int offset = co * h * w + hi * w + wi;
+
+                    memcpy(output + offset * elem_size, input + offset_org * elem_size, elem_size);
+                }
+            }
+        }
+    }
+    else
+    {
+        for (int co = 0; co < cout; co++)
+        {
+            for (int ci = 0; ci < cin; ci++)
+            {
+                for (int hi = 0; hi < h; hi++)
+                {
+                    for (int wi = 0; wi < w; wi++)
+                    {
+                        int offset_org = co * cin * h * w + ci + hi * w * cin + wi * cin;
+                        int offset = co * cin * h * w + ci * h * w + hi * w + wi;
+
+                        memcpy(output + offset * elem_size, input + offset_org * elem_size, elem_size);
+                    }
+                }
+            }
+        }
+    }
+
+    if (NULL != tensor_data_org)
+    {
+        sys_free(tensor_data_org);
+    }
+    else
+    {
+        ir_tensor->data = output;
+        ir_tensor->free_host_mem = 1;
+    }
+
+    return 0;
+}
+
 static int load_graph_tensors(struct tm2_serializer* tm2_s, struct graph* graph, struct tm2_priv* priv)
 {
     char* mem_base = (char*)priv->base;
@@ -176,7 +267,6 @@ static int load_graph_tensors(struct tm2_serializer* tm2_s, struct graph* graph,
     {
         const TM2_Tensor* tm_tensor = (TM2_Tensor*)(mem_base + v_tensors->offsets[i]);
         int flag_permute = 0; // flag the tensor has to be permute
-        int dims_org[8] = {0};
 
         /* TODO: check type definition */
         struct tensor* ir_tensor = create_ir_tensor(graph, NULL, tm_tensor->data_type);
@@ -211,11 +301,6 @@ static int load_graph_tensors(struct tm2_serializer* tm2_s, struct graph* graph,
                 {
                     int dims[8] = {0};
 
-                    dims_org[0] = v_dims->dims[0];
-                    dims_org[1] = v_dims->dims[1];
-                    dims_org[2] = v_dims->dims[2];
-                    dims_org[3] = v_dims->dims[3];
-
                     dims[0] = v_dims->dims[0]; // c_out
                     dims[1] = v_dims->dims[3]; // c_in
                     dims[2] = v_dims->dims[1]; // h
@@ -255,179 +340,9 @@ static int load_graph_tensors(struct tm2_serializer* tm2_s, struct graph* graph,
                 }
 
                 /* permute the data of tensor from nhwc to nchw */
-                if (flag_permute)
+                if (flag_permute && permute_const_tensor(ir_tensor, priv) < 0)
                 {
-                    int size = ir_tensor->elem_num;
-                    int type = ir_tensor->data_type;
-
-                    if (type == TENGINE_DT_FP32)
-                    {
-                        float* tensor_data_org = (float*)sys_malloc(size * sizeof(float));
-                        float* original_date = (float*)ir_tensor->data;
-
-                        for (int n = 0; n < size; n++)
-                        {
-                            tensor_data_org[n] = original_date[n];
-                        }
-
-                        int dims[4];
-                        dims[0] = ir_tensor->dims[0];
-                        dims[1] = ir_tensor->dims[1];
-                        dims[2] = ir_tensor->dims[2];
-                        dims[3] = ir_tensor->dims[3];
-
-                        /* nhwc to nchw */
-                        //                    fprintf(stderr, "%s:\n", ir_tensor->name);
-                        //                    fprintf(stderr, "original %d, %d, %d, %d\n", dims_org[0], dims_org[1], dims_org[2],
-                        //                    dims_org[3]); fprintf(stderr, "permute  %d, %d, %d, %d\n", dims[0], dims[1], dims[2],
-                        //                    dims[3]);
-
-                        float* input = tensor_data_org;
-                        float* output = (float*)ir_tensor->data;
-
-                        int cout = dims[0];
-                        int cin = dims[1];
-                        int h = dims[2];
-                        int w = dims[3];
-
-                        if (cin == 1)
-                        {
-                            for (int co = 0; co < cout; co++)
-                            {
-                                for (int hi = 0; hi < h; hi++)
-                                {
-                                    for (int wi = 0; wi < w; wi++)
-                                    {
-                                        int offset_org = 0;
-                                        offset_org += co;
-                                        offset_org += hi * w * cout;
-                                        offset_org += wi * cout;
-
-                                        int offset = 0;
-                                        offset += co * h * w;
-                                        offset += hi * w;
-                                        offset += wi;
-
-                                        output[offset] = input[offset_org];
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            for (int co = 0; co < cout; co++)
-                            {
-                                for (int ci = 0; ci < cin; ci++)
-                                {
-                                    for (int hi = 0; hi < h; hi++)
-                                    {
-                                        for (int wi = 0; wi < w; wi++)
-                                        {
-                                            int offset_org = 0;
-                                            offset_org += co * cin * h * w;
-                                            offset_org += ci;
-                                            offset_org += hi * w * cin;
-                                            offset_org += wi * cin;
-
-                                            int offset = 0;
-                                            offset += co * cin * h * w;
-                                            offset += ci * h * w;
-                                            offset += hi * w;
-                                            offset += wi;
-
-                                            output[offset] = input[offset_org];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        sys_free(tensor_data_org);
-                    }
-
-                    if (type == TENGINE_DT_UINT8 || type == TENGINE_DT_INT8)
-                    {
-                        unsigned char* tensor_data_org = (unsigned char*)sys_malloc(size * sizeof(unsigned char));
-                        unsigned char* original_date = (unsigned char*)ir_tensor->data;
-
-                        for (int n = 0; n < size; n++)
-                        {
-                            tensor_data_org[n] = original_date[n];
-                        }
-
-                        int dims[4];
-                        dims[0] = ir_tensor->dims[0];
-                        dims[1] = ir_tensor->dims[1];
-                        dims[2] = ir_tensor->dims[2];
-                        dims[3] = ir_tensor->dims[3];
-
-                        /* nhwc to nchw */
-                        //                        fprintf(stderr, "%s:\n", ir_tensor->name);
-                        //                        fprintf(stderr, "original %d, %d, %d, %d\n", dims_org[0], dims_org[1], dims_org[2], dims_org[3]);
-                        //                        fprintf(stderr, "permute  %d, %d, %d, %d\n", dims[0], dims[1], dims[2], dims[3]);
-
-                        unsigned char* input = tensor_data_org;
-                        unsigned char* output = (unsigned char*)ir_tensor->data;
-
-                        int cout = dims[0];
-                        int cin = dims[1];
-                        int h = dims[2];
-                        int w = dims[3];
-
-                        if (cin == 1)
-                        {
-                            for (int co = 0; co < cout; co++)
-                            {
-                                for (int hi = 0; hi < h; hi++)
-                                {
-                                    for (int wi = 0; wi < w; wi++)
-                                    {
-                                        int offset_org = 0;
-                                        offset_org += co;
-                                        offset_org += hi * w * cout;
-                                        offset_org += wi * cout;
-
-                                        int offset = 0;
-                                        offset += co * h * w;
-                                        offset += hi * w;
-                                        offset += wi;
-
-                                        output[offset] = input[offset_org];
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            for (int co = 0; co < cout; co++)
-                            {
-                                for (int ci = 0; ci < cin; ci++)
-                                {
-                                    for (int hi = 0; hi < h; hi++)
-                                    {
-                                        for (int wi = 0; wi < w; wi++)
-                                        {
-                                            int offset_org = 0;
-                                            offset_org += co * cin * h * w;
-                                            offset_org += ci;
-                                            offset_org += hi * w * cin;
-                                            offset_org += wi * cin;
-
-                                            int offset = 0;
-                                            offset += co * cin * h * w;
-                                            offset += ci * h * w;
-                                            offset += hi * w;
-                                            offset += wi;
-
-                                            output[offset] = input[offset_org];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        sys_free(tensor_data_org);
-                    }
+                    return -1;
                 }
             }
         }
@@ -862,6 +777,20 @@ error:
     return -1;
 }
 
+static void release_model_mem(void* mem_base, int mem_len, int mem_type)
+{
+    if (TM2_MEM_HEAP == mem_type)
+    {
+        sys_free(mem_base);
+    }
+#ifndef _MSC_VER
+    else if (TM2_MEM_MMAP == mem_type)
+    {
+        munmap(mem_base, mem_len);
+    }
+#endif
+}
+
 static int load_model(struct serializer* s, struct graph* graph, const char* fname, va_list ap)
 {
     struct stat stat;
@@ -877,29 +806,53 @@ static int load_model(struct serializer* s, struct graph* graph, const char* fna
     fstat(fd, &stat);
 
     int file_len = stat.st_size;
+    int mem_type = TM2_MEM_HEAP;
+    void* mem_base = NULL;
 
-    //    void* mem_base = mmap(NULL, file_len, PROT_READ, MAP_PRIVATE, fd, 0);
-    //
-    //    if(mem_base == MAP_FAILED)
-    //    {
-    //        set_tengine_errno(errno);
-    //        close(fd);
-    //        return -1;
-    //    }
+#ifndef _MSC_VER
+    const char* env = getenv(TM2_MODEL_MMAP_ENV);
+    if (NULL == env || env[0] != '0')
+    {
+        /* writable private mapping: pages stay shared until some kernel writes a const tensor in place */
+        mem_base = mmap(NULL, file_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
 
-    void* mem_base = (void*)sys_malloc(file_len);
-    int ret = read(fd, mem_base, file_len);
+        if (MAP_FAILED == mem_base)
+        {
+            TLOG_WARNING("Tengine: mmap file %s failed, fall back to read.\n", fname);
+            mem_base = NULL;
+        }
+        else
+        {
+            mem_type = TM2_MEM_MMAP;
+        }
+    }
+#endif
+
+    if (NULL == mem_base)
+    {
+        mem_base = (void*)sys_malloc(file_len);
+
+        if (NULL == mem_base || read(fd, mem_base, file_len) != file_len)
+        {
+            TLOG_ERR("Tengine: read file %s failed.\n", fname);
+            sys_free(mem_base);
+            close(fd);
+            return -1;
+        }
+    }
 
     struct tm2_priv* priv = (struct tm2_priv*)sys_malloc(sizeof(struct tm2_priv));
 
     if (priv == NULL)
     {
+        release_model_mem(mem_base, file_len, mem_type);
         close(fd);
         return -1;
     }
 
     priv->fd = fd;
     priv->mem_len = file_len;
+    priv->mem_type = mem_type;
     priv->base = (const char*)mem_base;
     priv->header = get_tm_file_header((const char*)mem_base);
     priv->model = get_tm_file_model((const char*)mem_base, priv->header);
@@ -923,6 +876,7 @@ static int load_mem(struct serializer* s, struct graph* graph, const void* addr,
 
     priv->fd = -1;
     priv->mem_len = size;
+    priv->mem_type = TM2_MEM_EXTERNAL;
     priv->base = (const char*)addr;
     priv->header = get_tm_file_header((const char*)addr);
     priv->model = get_tm_file_model((const char*)addr, priv->header);
@@ -941,14 +895,13 @@ static int unload_graph(struct serializer* s, struct graph* graph, void* s_priv,
 
     if (priv->fd >= 0)
     {
-        // munmap(( void* )priv->base, priv->mem_len);
         close(priv->fd);
         priv->fd = -1;
     }
 
     if (priv->base)
     {
-        sys_free((void*)priv->base);
+        release_model_mem((void*)priv->base, priv->mem_len, priv->mem_type);
         priv->base = NULL;
     }
 
@@ -28,6 +28,16 @@
 
 #define NULL_TM2_OP_LOADER ((tm2_op_loader_t)0x1)
 
+/* set to 0 to read the whole model into private heap memory instead of mapping it */
+#define TM2_MODEL_MMAP_ENV "TG_MODEL_MMAP"
+
+enum tm2_mem_type
+{
+    TM2_MEM_EXTERNAL = 0, /* owned by caller, load from memory */
+    TM2_MEM_HEAP,         /* read into sys_malloc buffer */
+    TM2_MEM_MMAP,         /* private copy-on-write file mapping */
+};
+
 struct node;
 struct graph;
 
@@ -35,6 +45,7 @@ struct tm2_priv
 {
     int fd; /* for file load */
     int mem_len;
+    int mem_type;                 /* enum tm2_mem_type, decides how base is released */
     const char* base;             /* mem base for model */
     const TM2_Header* header;     /* file header */
     const TM2_Model* model;       /* model header */
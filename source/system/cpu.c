@@ -40,8 +40,10 @@
 #include "cpu.h"
 
 #include "api/c_api.h"
+#include "utility/log.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
@@ -67,6 +69,15 @@
 #include <omp.h>
 #endif
 
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define CPU_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
 static size_t core_count = 0;
 
 static size_t affinity_mask_all_cluster = 0;
@@ -313,10 +324,149 @@ int init_cluster_mask()
     return 0;
 }
 
+#if CPU_X86
+static void get_cpuid(int leaf, int sub_leaf, uint32_t regs[4])
+{
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, leaf, sub_leaf);
+    for (int i = 0; i < 4; i++)
+        regs[i] = r[i];
+#else
+    __cpuid_count(leaf, sub_leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/* the register states enabled by the os */
+static uint64_t get_xcr0()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile(".byte 0x0f, 0x01, 0xd0" /* xgetbv */
+                     : "=a"(eax), "=d"(edx)
+                     : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+static int detect_cpu_isa()
+{
+    uint32_t regs[4];
+    int isa = 0;
+
+    get_cpuid(0, 0, regs);
+    uint32_t max_leaf = regs[0];
+
+    get_cpuid(1, 0, regs);
+    uint32_t ecx1 = regs[2];
+
+    if (ecx1 & (1u << 19))
+        isa |= CPU_ISA_SSE41;
+
+    /* the ymm and zmm registers are usable only if the os saves them */
+    uint64_t xcr0 = (ecx1 & (1u << 27)) ? get_xcr0() : 0;
+    int ymm_state = (xcr0 & 0x06) == 0x06;
+    int zmm_state = (xcr0 & 0xe6) == 0xe6;
+
+    if (!ymm_state || !(ecx1 & (1u << 28)))
+        return isa;
+
+    isa |= CPU_ISA_AVX;
+
+    if (ecx1 & (1u << 12))
+        isa |= CPU_ISA_FMA;
+    if (ecx1 & (1u << 29))
+        isa |= CPU_ISA_F16C;
+
+    if (max_leaf < 7)
+        return isa;
+
+    get_cpuid(7, 0, regs);
+    uint32_t ebx7 = regs[1];
+    uint32_t ecx7 = regs[2];
+    uint32_t max_sub_leaf = regs[0];
+    uint32_t eax7_1 = 0;
+
+    if (ebx7 & (1u << 5))
+        isa |= CPU_ISA_AVX2;
+
+    if (max_sub_leaf >= 1)
+    {
+        get_cpuid(7, 1, regs);
+        if (regs[0] & (1u << 4))
+            isa |= CPU_ISA_AVXVNNI;
+        eax7_1 = regs[0];
+    }
+
+    if (!zmm_state || !(ebx7 & (1u << 16)))
+        return isa;
+
+    isa |= CPU_ISA_AVX512F;
+
+    if (ebx7 & (1u << 30))
+        isa |= CPU_ISA_AVX512BW;
+    if (ebx7 & (1u << 31))
+        isa |= CPU_ISA_AVX512VL;
+    if (ecx7 & (1u << 11))
+        isa |= CPU_ISA_AVX512VNNI;
+    if (eax7_1 & (1u << 5))
+        isa |= CPU_ISA_AVX512BF16;
+
+    return isa;
+}
+#else
+static int detect_cpu_isa()
+{
+    return 0;
+}
+#endif
+
+static void dump_cpu_isa(int isa)
+{
+    static const char* isa_name[] = {"sse4.1", "avx", "fma", "f16c", "avx2", "avx512f", "avx512bw", "avx512vl",
+                                     "avx512vnni", "avxvnni", "avx512bf16"};
+
+    char buffer[128] = "";
+
+    for (int i = 0; i < sizeof(isa_name) / sizeof(isa_name[0]); i++)
+    {
+        if (isa & (1 << i))
+        {
+            strcat(buffer, " ");
+            strcat(buffer, isa_name[i]);
+        }
+    }
+
+    TLOG_DEBUG("cpu isa:%s\n", buffer);
+}
+
+static int cpu_isa = -1;
+
+int get_cpu_isa()
+{
+    if (0 <= cpu_isa)
+        return cpu_isa;
+
+    int isa = detect_cpu_isa();
+
+    const char* env = getenv(TENGINE_CPU_ISA_MASK);
+    if (NULL != env)
+        isa &= (int)strtol(env, NULL, 16);
+
+    dump_cpu_isa(isa);
+
+    cpu_isa = isa;
+
+    return cpu_isa;
+}
+
 int check_cpu()
 {
     init_cpu_count();
     init_cluster_mask();
+    get_cpu_isa();
 
     return 0;
 }
@@ -373,6 +523,17 @@ int set_cpu_affine(size_t mask)
     return 0;
 }
 
+int set_thread_affine(size_t mask)
+{
+    // only the calling thread, the threads of openmp are not touched
+#if defined __ANDROID__ || defined __linux__
+    return set_sched_affinity(mask);
+#else
+    (void)mask;
+    return -1;
+#endif
+}
+
 size_t get_cpu_cluster_mask(int cluster)
 {
     switch (cluster)
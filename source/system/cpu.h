@@ -27,12 +27,72 @@
 
 #include <stddef.h>
 
+/* the isa features of the cpu, only detected on x86 now */
+#define CPU_ISA_SSE41      0x0001
+#define CPU_ISA_AVX        0x0002
+#define CPU_ISA_FMA        0x0004
+#define CPU_ISA_F16C       0x0008
+#define CPU_ISA_AVX2       0x0010
+#define CPU_ISA_AVX512F    0x0020
+#define CPU_ISA_AVX512BW   0x0040
+#define CPU_ISA_AVX512VL   0x0080
+#define CPU_ISA_AVX512VNNI 0x0100
+#define CPU_ISA_AVXVNNI    0x0200
+#define CPU_ISA_AVX512BF16 0x0400
+
+/* the detected features are masked by the hex value of it, to run as on an older cpu */
+#define TENGINE_CPU_ISA_MASK "TG_CPU_ISA_MASK"
+
+/* the isa features the including source file is compiled for */
+#if __SSE4_1__
+#define CPU_ISA_BUILD_SSE41 CPU_ISA_SSE41
+#else
+#define CPU_ISA_BUILD_SSE41 0
+#endif
+#if __AVX__
+#define CPU_ISA_BUILD_AVX CPU_ISA_AVX
+#else
+#define CPU_ISA_BUILD_AVX 0
+#endif
+#if __FMA__
+#define CPU_ISA_BUILD_FMA CPU_ISA_FMA
+#else
+#define CPU_ISA_BUILD_FMA 0
+#endif
+#if __F16C__
+#define CPU_ISA_BUILD_F16C CPU_ISA_F16C
+#else
+#define CPU_ISA_BUILD_F16C 0
+#endif
+#if __AVX2__
+#define CPU_ISA_BUILD_AVX2 CPU_ISA_AVX2
+#else
+#define CPU_ISA_BUILD_AVX2 0
+#endif
+#if __AVX512F__
+#define CPU_ISA_BUILD_AVX512F CPU_ISA_AVX512F
+#else
+#define CPU_ISA_BUILD_AVX512F 0
+#endif
+
+#define CPU_ISA_BUILD (CPU_ISA_BUILD_SSE41 | CPU_ISA_BUILD_AVX | CPU_ISA_BUILD_FMA | CPU_ISA_BUILD_F16C \
+                       | CPU_ISA_BUILD_AVX2 | CPU_ISA_BUILD_AVX512F)
+
 int check_cpu();
 
+/*!
+ * @brief Get the isa features of the cpu, which are supported by the os too.
+ *
+ * @return The mask of CPU_ISA_*.
+ */
+int get_cpu_isa();
+
 int get_cpu_mask_count(size_t mask);
 
 int set_cpu_affine(size_t mask);
 
+int set_thread_affine(size_t mask);
+
 size_t get_cpu_cluster_mask(int cluster);
 
 #endif
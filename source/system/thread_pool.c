@@ -0,0 +1,497 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#include "thread_pool.h"
+
+#include "cpu.h"
+
+#include "defines.h"
+#include "api/c_api.h"
+#include "utility/sys_port.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef TENGINE_HAS_LIB_POSIX_THREAD
+#include <pthread.h>
+#include <sched.h>
+
+#define MAX_POOL_THREAD   ((int)sizeof(size_t) * 8)
+#define POOL_SPIN_COUNT   20000
+#define POOL_CACHE_LINE   64
+#define RANGE_BEGIN(r)    ((int)(uint32_t)(r))
+#define RANGE_END(r)      ((int)(uint32_t)((r) >> 32))
+#define MAKE_RANGE(b, e)  (((uint64_t)(uint32_t)(e) << 32) | (uint64_t)(uint32_t)(b))
+
+/* the items not taken yet of a slot, the owner takes from the begin, the thieves take from the end */
+struct parallel_slot
+{
+    uint64_t range;
+    char pad[POOL_CACHE_LINE - sizeof(uint64_t)];
+};
+
+struct parallel_job
+{
+    parallel_task_t task;
+    void* arg;
+    size_t mask;      /* cores the job may run on */
+    int slot_num;     /* the caller owns slot 0, each joined pool thread owns one more */
+    int next_slot;    /* protected by the pool lock */
+    int linked;       /* protected by the pool lock */
+    int active;       /* joined pool threads which have not left the job */
+    struct parallel_job* next;
+    struct parallel_slot slot[MAX_POOL_THREAD];
+};
+
+struct pool_thread
+{
+    pthread_t thread;
+    size_t mask; /* the core this thread is pinned to */
+};
+
+struct thread_pool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct parallel_job* job_list;
+    unsigned int post_seq;
+    int sleeper;
+    int quit;
+    int thread_num;
+    size_t thread_mask;
+    struct pool_thread thread[MAX_POOL_THREAD];
+};
+
+static struct thread_pool* thread_pool = NULL;
+static pthread_mutex_t thread_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t parallel_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t parallel_key;
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static void create_parallel_key(void)
+{
+    pthread_key_create(&parallel_key, NULL);
+}
+
+static size_t get_parallel_cpu_mask(void)
+{
+    pthread_once(&parallel_key_once, create_parallel_key);
+
+    return (size_t)(uintptr_t)pthread_getspecific(parallel_key);
+}
+
+size_t set_parallel_cpu_mask(size_t mask)
+{
+    size_t old_mask = get_parallel_cpu_mask();
+
+    pthread_setspecific(parallel_key, (void*)(uintptr_t)mask);
+
+    return old_mask;
+}
+
+static int take_front(struct parallel_slot* slot, int* begin, int* end)
+{
+    uint64_t range = __atomic_load_n(&slot->range, __ATOMIC_ACQUIRE);
+
+    for (;;)
+    {
+        int b = RANGE_BEGIN(range);
+        int e = RANGE_END(range);
+
+        if (b >= e)
+            return 0;
+
+        /* big chunks first, then smaller ones, so that there is still something to steal */
+        int step = (e - b) / 4;
+        if (step < 1)
+            step = 1;
+
+        if (__atomic_compare_exchange_n(&slot->range, &range, MAKE_RANGE(b + step, e), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *begin = b;
+            *end = b + step;
+            return 1;
+        }
+    }
+}
+
+static int steal_back(struct parallel_slot* slot, int* begin, int* end)
+{
+    uint64_t range = __atomic_load_n(&slot->range, __ATOMIC_ACQUIRE);
+
+    for (;;)
+    {
+        int b = RANGE_BEGIN(range);
+        int e = RANGE_END(range);
+
+        if (b >= e)
+            return 0;
+
+        int mid = e - (e - b + 1) / 2;
+
+        if (__atomic_compare_exchange_n(&slot->range, &range, MAKE_RANGE(b, mid), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *begin = mid;
+            *end = e;
+            return 1;
+        }
+    }
+}
+
+static void run_parallel_slot(struct parallel_job* job, int slot_idx)
+{
+    struct parallel_slot* slot = &job->slot[slot_idx];
+    int begin, end;
+
+    for (;;)
+    {
+        while (take_front(slot, &begin, &end))
+            job->task(job->arg, begin, end);
+
+        int stolen = 0;
+
+        for (int i = 1; i < job->slot_num && !stolen; i++)
+        {
+            int victim = (slot_idx + i) % job->slot_num;
+
+            stolen = steal_back(&job->slot[victim], &begin, &end);
+        }
+
+        if (!stolen)
+            return;
+
+        /* the own slot is empty, publish the stolen items there so they can be stolen again */
+        __atomic_store_n(&slot->range, MAKE_RANGE(begin, end), __ATOMIC_RELEASE);
+    }
+}
+
+static void unlink_parallel_job(struct thread_pool* pool, struct parallel_job* job)
+{
+    struct parallel_job** link = &pool->job_list;
+
+    while (*link != job)
+        link = &(*link)->next;
+
+    *link = job->next;
+    job->linked = 0;
+}
+
+/* called with the pool lock held, joins the first job which still has a free slot and allows the core */
+static struct parallel_job* join_parallel_job(struct thread_pool* pool, size_t core_mask, int* slot_idx)
+{
+    for (struct parallel_job* job = pool->job_list; job != NULL; job = job->next)
+    {
+        if (0 == (job->mask & core_mask))
+            continue;
+
+        *slot_idx = job->next_slot++;
+        __atomic_add_fetch(&job->active, 1, __ATOMIC_ACQ_REL);
+
+        if (job->next_slot == job->slot_num)
+            unlink_parallel_job(pool, job);
+
+        return job;
+    }
+
+    return NULL;
+}
+
+static void* pool_thread_loop(void* arg)
+{
+    struct pool_thread* self = (struct pool_thread*)arg;
+    struct thread_pool* pool = thread_pool;
+
+    set_thread_affine(self->mask);
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (!pool->quit)
+    {
+        int slot_idx;
+        struct parallel_job* job = join_parallel_job(pool, self->mask, &slot_idx);
+
+        if (NULL != job)
+        {
+            pthread_mutex_unlock(&pool->lock);
+
+            /* nested jobs posted by the task inherit the cores of this job */
+            set_parallel_cpu_mask(job->mask);
+            run_parallel_slot(job, slot_idx);
+            set_parallel_cpu_mask(0);
+
+            __atomic_sub_fetch(&job->active, 1, __ATOMIC_ACQ_REL);
+
+            pthread_mutex_lock(&pool->lock);
+            continue;
+        }
+
+        /* spin for a while before sleeping, jobs of a graph usually come one after another */
+        unsigned int seq = pool->post_seq;
+        pthread_mutex_unlock(&pool->lock);
+
+        for (int i = 0; i < POOL_SPIN_COUNT; i++)
+        {
+            if (__atomic_load_n(&pool->post_seq, __ATOMIC_ACQUIRE) != seq || __atomic_load_n(&pool->quit, __ATOMIC_ACQUIRE))
+                break;
+
+            cpu_relax();
+        }
+
+        pthread_mutex_lock(&pool->lock);
+
+        if (pool->post_seq == seq && !pool->quit)
+        {
+            pool->sleeper++;
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            pool->sleeper--;
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+static struct thread_pool* create_thread_pool(void)
+{
+    struct thread_pool* pool = (struct thread_pool*)sys_malloc(sizeof(struct thread_pool));
+
+    if (NULL == pool)
+        return NULL;
+
+    memset(pool, 0, sizeof(struct thread_pool));
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+
+    check_cpu();
+
+    /* one thread pinned to each core but the first one, the caller of a job is the extra thread */
+    size_t all_mask = get_cpu_cluster_mask(TENGINE_CLUSTER_ALL);
+    int skip = 1;
+
+    thread_pool = pool;
+
+    for (int i = 0; i < MAX_POOL_THREAD; i++)
+    {
+        size_t core_mask = (size_t)1 << i;
+
+        if (0 == (all_mask & core_mask))
+            continue;
+
+        if (skip)
+        {
+            skip = 0;
+            continue;
+        }
+
+        struct pool_thread* thread = &pool->thread[pool->thread_num];
+        thread->mask = core_mask;
+
+        if (0 != pthread_create(&thread->thread, NULL, pool_thread_loop, thread))
+            break;
+
+        pool->thread_mask |= core_mask;
+        pool->thread_num++;
+    }
+
+    return pool;
+}
+
+static struct thread_pool* get_thread_pool(void)
+{
+    struct thread_pool* pool = __atomic_load_n(&thread_pool, __ATOMIC_ACQUIRE);
+
+    if (NULL != pool)
+        return pool;
+
+    pthread_mutex_lock(&thread_pool_lock);
+
+    pool = thread_pool;
+    if (NULL == pool)
+        pool = create_thread_pool();
+
+    pthread_mutex_unlock(&thread_pool_lock);
+
+    return pool;
+}
+
+int get_parallel_thread_id(void)
+{
+    struct thread_pool* pool = __atomic_load_n(&thread_pool, __ATOMIC_ACQUIRE);
+
+    if (NULL == pool)
+        return 0;
+
+    pthread_t self = pthread_self();
+
+    for (int i = 0; i < pool->thread_num; i++)
+    {
+        if (pthread_equal(self, pool->thread[i].thread))
+            return i + 1;
+    }
+
+    return 0;
+}
+
+void release_thread_pool(void)
+{
+    pthread_mutex_lock(&thread_pool_lock);
+
+    struct thread_pool* pool = thread_pool;
+
+    if (NULL != pool)
+    {
+        pthread_mutex_lock(&pool->lock);
+        __atomic_store_n(&pool->quit, 1, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&pool->cond);
+        pthread_mutex_unlock(&pool->lock);
+
+        for (int i = 0; i < pool->thread_num; i++)
+            pthread_join(pool->thread[i].thread, NULL);
+
+        pthread_cond_destroy(&pool->cond);
+        pthread_mutex_destroy(&pool->lock);
+        sys_free(pool);
+
+        __atomic_store_n(&thread_pool, NULL, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&thread_pool_lock);
+}
+
+void parallel_for(parallel_task_t task, void* arg, int num, int num_thread)
+{
+    if (num <= 0)
+        return;
+
+    if (num_thread > num)
+        num_thread = num;
+
+    struct thread_pool* pool = num_thread > 1 ? get_thread_pool() : NULL;
+
+    if (NULL == pool)
+    {
+        task(arg, 0, num);
+        return;
+    }
+
+    size_t mask = get_parallel_cpu_mask();
+    if (0 == mask)
+        mask = pool->thread_mask;
+
+    int slot_num = get_cpu_mask_count(mask & pool->thread_mask) + 1;
+    if (slot_num > num_thread)
+        slot_num = num_thread;
+
+    if (slot_num < 2)
+    {
+        task(arg, 0, num);
+        return;
+    }
+
+    struct parallel_job job;
+
+    job.task = task;
+    job.arg = arg;
+    job.mask = mask;
+    job.slot_num = slot_num;
+    job.next_slot = 1;
+    job.linked = 1;
+    job.active = 0;
+    job.next = NULL;
+
+    for (int i = 0; i < slot_num; i++)
+    {
+        int begin = (int)((int64_t)num * i / slot_num);
+        int end = (int)((int64_t)num * (i + 1) / slot_num);
+
+        job.slot[i].range = MAKE_RANGE(begin, end);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    struct parallel_job** link = &pool->job_list;
+    while (NULL != *link)
+        link = &(*link)->next;
+    *link = &job;
+
+    __atomic_add_fetch(&pool->post_seq, 1, __ATOMIC_RELEASE);
+
+    if (0 < pool->sleeper)
+        pthread_cond_broadcast(&pool->cond);
+
+    pthread_mutex_unlock(&pool->lock);
+
+    run_parallel_slot(&job, 0);
+
+    /* nothing is left to take, no more threads may join */
+    pthread_mutex_lock(&pool->lock);
+    if (job.linked)
+        unlink_parallel_job(pool, &job);
+    pthread_mutex_unlock(&pool->lock);
+
+    /* the items taken by the joined threads are done when they leave */
+    for (int i = 0; 0 < __atomic_load_n(&job.active, __ATOMIC_ACQUIRE); i++)
+    {
+        if (i < POOL_SPIN_COUNT)
+            cpu_relax();
+        else
+            sched_yield();
+    }
+}
+
+#else
+
+void parallel_for(parallel_task_t task, void* arg, int num, int num_thread)
+{
+    (void)num_thread;
+
+    if (num > 0)
+        task(arg, 0, num);
+}
+
+size_t set_parallel_cpu_mask(size_t mask)
+{
+    (void)mask;
+    return 0;
+}
+
+int get_parallel_thread_id(void)
+{
+    return 0;
+}
+
+void release_thread_pool(void)
+{
+}
+
+#endif
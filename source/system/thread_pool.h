@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stddef.h>
+
+/*!
+ * @brief The task of a parallel job, runs the items [begin, end).
+ */
+typedef void (*parallel_task_t)(void* arg, int begin, int end);
+
+/*!
+ * @brief Run a task over the items [0, num) with at most num_thread threads.
+ *        The caller is one of the threads, the others come from the process wide
+ *        thread pool, and idle threads steal items from the busy ones. It returns
+ *        when all the items are done. Without pthread, the task runs in the caller.
+ *
+ * @param [in]  task: the task.
+ * @param [in]  arg: the argument of the task.
+ * @param [in]  num: the count of items.
+ * @param [in]  num_thread: the max count of threads.
+ */
+void parallel_for(parallel_task_t task, void* arg, int num, int num_thread);
+
+/*!
+ * @brief Set the cores which the parallel jobs posted by the calling thread may run on.
+ *        The jobs run by a pool thread inherit the cores of the job it is running.
+ *
+ * @param [in]  mask: the cpu mask, 0 means all the cores.
+ *
+ * @return The old cpu mask.
+ */
+size_t set_parallel_cpu_mask(size_t mask);
+
+/*!
+ * @brief Get the id of the calling thread in the pool.
+ *
+ * @return 1 ~ n for the threads of the pool, 0 for the other threads.
+ */
+int get_parallel_thread_id(void);
+
+/*!
+ * @brief Stop and join the threads of the pool, the pool is created again on demand.
+ */
+void release_thread_pool(void);
+
+#endif
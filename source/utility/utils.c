@@ -30,6 +30,7 @@
 #include "operator/op.h"
 #include "module/module.h"
 #include "utility/vector.h"
+#include "graph/tensor.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -53,10 +54,19 @@ const char* get_tensor_type_string(int tensor_type)
 
 const char* get_tensor_layout_string(int layout)
 {
-    if (layout == TENGINE_LAYOUT_NHWC)
+    switch (layout)
+    {
+    case TENGINE_LAYOUT_NHWC:
         return "NHWC";
-    else
+    case TENGINE_LAYOUT_NC4HW4:
+        return "NC4HW4";
+    case TENGINE_LAYOUT_NC8HW8:
+        return "NC8HW8";
+    case TENGINE_LAYOUT_NC16HW16:
+        return "NC16HW16";
+    default:
         return "NCHW";
+    }
 }
 
 const char* get_model_format_string(int model_format)
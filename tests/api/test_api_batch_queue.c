@@ -0,0 +1,284 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * run_batch_queue(): several callers run their samples by the queue at once, and each output is
+ * compared to the one of the sample run alone by another graph. the conv and the pooling of the
+ * graph are reshaped along dims[0] to the count of the samples batched.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/convolution_param.h"
+#include "operator/prototype/pooling_param.h"
+
+#include <pthread.h>
+
+#define SAMPLE_NUM 16
+#define CALLER_NUM 6
+#define RUN_NUM    20
+#define OUTPUT_NUM 2
+#define IN_C       2
+#define OUT_C      4
+#define HW         9
+
+static float weight[OUT_C * IN_C * 3 * 3];
+static float bias[OUT_C];
+
+static float* sample_input[SAMPLE_NUM];
+static float* sample_output[SAMPLE_NUM][OUTPUT_NUM];
+static int output_size[OUTPUT_NUM];
+
+/* input -> convolution 3x3 -> global average pooling, both of them are outputs */
+static graph_t create_test_graph(void* input_data)
+{
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[4] = {1, IN_C, HW, HW};
+    int weight_dims[4] = {OUT_C, IN_C, 3, 3};
+    int bias_dims[1] = {OUT_C};
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    tensor_t conv_inputs[3];
+    conv_inputs[0] = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 4, input_data);
+    conv_inputs[1] = test_cpu_const(graph, "weight", TENGINE_DT_FP32, weight_dims, 4, weight);
+    conv_inputs[2] = test_cpu_const(graph, "bias", TENGINE_DT_FP32, bias_dims, 1, bias);
+
+    node_t conv = test_cpu_node(graph, "conv", "Convolution", conv_inputs, 3, fp32, 1);
+    if (NULL == conv)
+        return NULL;
+
+    struct conv_param* conv_param = (struct conv_param*)test_cpu_param(conv);
+    conv_param->kernel_h = 3;
+    conv_param->kernel_w = 3;
+    conv_param->stride_h = 1;
+    conv_param->stride_w = 1;
+    conv_param->pad_h0 = 1;
+    conv_param->pad_h1 = 1;
+    conv_param->pad_w0 = 1;
+    conv_param->pad_w1 = 1;
+    conv_param->dilation_h = 1;
+    conv_param->dilation_w = 1;
+    conv_param->input_channel = IN_C;
+    conv_param->output_channel = OUT_C;
+    conv_param->group = 1;
+    conv_param->activation = -1;
+
+    tensor_t pool_input = get_graph_tensor(graph, "conv");
+    node_t pool = test_cpu_node(graph, "pool", "Pooling", &pool_input, 1, fp32, 1);
+    if (NULL == pool)
+        return NULL;
+
+    struct pool_param* pool_param = (struct pool_param*)test_cpu_param(pool);
+    pool_param->pool_method = POOL_AVG;
+    pool_param->global = 1;
+
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"conv", "pool"};
+
+    if (test_cpu_prerun(graph, inputs, 1, outputs, OUTPUT_NUM, 1) < 0)
+        return NULL;
+
+    return graph;
+}
+
+struct caller_job
+{
+    batch_queue_t queue;
+    int index;
+    int fails;
+    int mismatches;
+};
+
+static void* run_caller(void* arg)
+{
+    struct caller_job* job = (struct caller_job*)arg;
+
+    float* output[OUTPUT_NUM];
+    for (int i = 0; i < OUTPUT_NUM; i++)
+        output[i] = (float*)malloc(output_size[i] * sizeof(float));
+
+    for (int r = 0; r < RUN_NUM; r++)
+    {
+        int sample = (job->index * 5 + r) % SAMPLE_NUM;
+
+        const void* input_data[1] = {sample_input[sample]};
+        void* output_data[OUTPUT_NUM] = {output[0], output[1]};
+
+        if (run_batch_queue(job->queue, input_data, 1, output_data, OUTPUT_NUM) < 0)
+        {
+            job->fails++;
+            continue;
+        }
+
+        for (int i = 0; i < OUTPUT_NUM; i++)
+        {
+            char what[64];
+            snprintf(what, sizeof(what), "caller %d sample %d output %d", job->index, sample, i);
+
+            if (test_cpu_compare(what, output[i], sample_output[sample][i], output_size[i], 1e-5f) > 0)
+            {
+                job->mismatches++;
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < OUTPUT_NUM; i++)
+        free(output[i]);
+
+    return NULL;
+}
+
+/* the callers run by a queue of the max batch and the timeout, -1 for a failed run or a mismatch */
+static int test_batch_queue(int max_batch, int timeout_us)
+{
+    float* input_data = (float*)malloc(IN_C * HW * HW * sizeof(float));
+    graph_t graph = create_test_graph(input_data);
+
+    if (NULL == graph)
+    {
+        fprintf(stderr, "create the test graph of the queue failed.\n");
+        return -1;
+    }
+
+    batch_queue_t queue = create_batch_queue(graph, max_batch, timeout_us);
+
+    if (NULL == queue)
+    {
+        fprintf(stderr, "create the batch queue failed.\n");
+        return -1;
+    }
+
+    pthread_t threads[CALLER_NUM];
+    struct caller_job jobs[CALLER_NUM];
+
+    for (int i = 0; i < CALLER_NUM; i++)
+    {
+        jobs[i].queue = queue;
+        jobs[i].index = i;
+        jobs[i].fails = 0;
+        jobs[i].mismatches = 0;
+
+        pthread_create(&threads[i], NULL, run_caller, &jobs[i]);
+    }
+
+    int ret = 0;
+
+    for (int i = 0; i < CALLER_NUM; i++)
+    {
+        pthread_join(threads[i], NULL);
+
+        if (jobs[i].fails > 0 || jobs[i].mismatches > 0)
+        {
+            fprintf(stderr, "max batch %d timeout %d caller %d: %d runs failed, %d outputs differ.\n", max_batch,
+                    timeout_us, i, jobs[i].fails, jobs[i].mismatches);
+            ret = -1;
+        }
+    }
+
+    if (destroy_batch_queue(queue) < 0)
+        ret = -1;
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+    free(input_data);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 11;
+
+    for (int i = 0; i < OUT_C * IN_C * 9; i++)
+        weight[i] = test_cpu_random(&seed);
+    for (int i = 0; i < OUT_C; i++)
+        bias[i] = test_cpu_random(&seed);
+
+    for (int s = 0; s < SAMPLE_NUM; s++)
+    {
+        sample_input[s] = (float*)malloc(IN_C * HW * HW * sizeof(float));
+        for (int i = 0; i < IN_C * HW * HW; i++)
+            sample_input[s][i] = test_cpu_random(&seed);
+    }
+
+    init_tengine();
+
+    /* the expected outputs are the ones of each sample run alone */
+    float* input_data = (float*)malloc(IN_C * HW * HW * sizeof(float));
+    graph_t graph = create_test_graph(input_data);
+
+    if (NULL == graph)
+    {
+        fprintf(stderr, "create the test graph failed.\n");
+        return -1;
+    }
+
+    for (int s = 0; s < SAMPLE_NUM; s++)
+    {
+        memcpy(input_data, sample_input[s], IN_C * HW * HW * sizeof(float));
+
+        if (run_graph(graph, 1) < 0)
+        {
+            fprintf(stderr, "run the sample %d alone failed.\n", s);
+            return -1;
+        }
+
+        for (int i = 0; i < OUTPUT_NUM; i++)
+        {
+            tensor_t output = get_graph_output_tensor(graph, i, 0);
+            output_size[i] = get_tensor_buffer_size(output) / sizeof(float);
+
+            sample_output[s][i] = (float*)malloc(output_size[i] * sizeof(float));
+            memcpy(sample_output[s][i], get_tensor_buffer(output), output_size[i] * sizeof(float));
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+    free(input_data);
+
+    int ret = 0;
+
+    /* the batches filled, the ones cut by the timeout, and the samples run as they are queued */
+    if (test_batch_queue(4, 2000) < 0 || test_batch_queue(CALLER_NUM, 200) < 0 || test_batch_queue(8, 0) < 0)
+        ret = -1;
+
+    release_tengine();
+
+    for (int s = 0; s < SAMPLE_NUM; s++)
+    {
+        free(sample_input[s]);
+        for (int i = 0; i < OUTPUT_NUM; i++)
+            free(sample_output[s][i]);
+    }
+
+    if (0 == ret)
+        fprintf(stderr, "test batch queue pass.\n");
+
+    return ret;
+}
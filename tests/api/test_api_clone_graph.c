@@ -0,0 +1,337 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * clone_graph(): the origin and its clones switch between input shapes, in turn and then on
+ * threads of their own, and their outputs are compared to the ones of the origin run alone.
+ * the interp and the global pooling of the graph write their op params in infer_shape, so an
+ * instance reshaped must not change the params of the others. the case runs with the optimized
+ * ops and again with the reference ones, which read the params back in their run.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/convolution_param.h"
+#include "operator/prototype/interp_param.h"
+#include "operator/prototype/pooling_param.h"
+
+#include <pthread.h>
+
+#define INSTANCE_NUM 4
+#define SHAPE_NUM    4
+#define LOOP_NUM     24
+#define OUTPUT_NUM   2
+#define IN_C         2
+#define OUT_C        3
+
+static float weight[OUT_C * IN_C * 3 * 3];
+static float bias[OUT_C];
+
+static float* shape_input[SHAPE_NUM];
+static float* shape_output[SHAPE_NUM][OUTPUT_NUM];
+static int shape_output_size[SHAPE_NUM][OUTPUT_NUM];
+
+static int get_shape_hw(int shape)
+{
+    return 5 + 3 * shape;
+}
+
+/* input -> convolution 3x3 -> interp x2 bilinear, and convolution -> global average pooling */
+static graph_t create_test_graph(void)
+{
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    if (NULL == graph)
+        return NULL;
+
+    int hw = get_shape_hw(0);
+    int input_dims[4] = {1, IN_C, hw, hw};
+    int weight_dims[4] = {OUT_C, IN_C, 3, 3};
+    int bias_dims[1] = {OUT_C};
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    tensor_t conv_inputs[3];
+    conv_inputs[0] = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 4, NULL);
+    conv_inputs[1] = test_cpu_const(graph, "weight", TENGINE_DT_FP32, weight_dims, 4, weight);
+    conv_inputs[2] = test_cpu_const(graph, "bias", TENGINE_DT_FP32, bias_dims, 1, bias);
+
+    node_t conv = test_cpu_node(graph, "conv", "Convolution", conv_inputs, 3, fp32, 1);
+    if (NULL == conv)
+        return NULL;
+
+    struct conv_param* conv_param = (struct conv_param*)test_cpu_param(conv);
+    conv_param->kernel_h = 3;
+    conv_param->kernel_w = 3;
+    conv_param->stride_h = 1;
+    conv_param->stride_w = 1;
+    conv_param->pad_h0 = 1;
+    conv_param->pad_h1 = 1;
+    conv_param->pad_w0 = 1;
+    conv_param->pad_w1 = 1;
+    conv_param->dilation_h = 1;
+    conv_param->dilation_w = 1;
+    conv_param->input_channel = IN_C;
+    conv_param->output_channel = OUT_C;
+    conv_param->group = 1;
+    conv_param->activation = -1;
+
+    tensor_t interp_input = get_graph_tensor(graph, "conv");
+    node_t interp = test_cpu_node(graph, "interp", "Interp", &interp_input, 1, fp32, 1);
+    if (NULL == interp)
+        return NULL;
+
+    struct interp_param* interp_param = (struct interp_param*)test_cpu_param(interp);
+    interp_param->resize_type = 2;
+    interp_param->height_scale = 2.f;
+    interp_param->width_scale = 2.f;
+
+    node_t pool = test_cpu_node(graph, "pool", "Pooling", &interp_input, 1, fp32, 1);
+    if (NULL == pool)
+        return NULL;
+
+    struct pool_param* pool_param = (struct pool_param*)test_cpu_param(pool);
+    pool_param->pool_method = POOL_AVG;
+    pool_param->global = 1;
+
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"interp", "pool"};
+
+    if (test_cpu_prerun(graph, inputs, 1, outputs, OUTPUT_NUM, 1) < 0)
+        return NULL;
+
+    return graph;
+}
+
+/* set the input of the shape to the instance and run it */
+static int run_shape(graph_t graph, int shape)
+{
+    int hw = get_shape_hw(shape);
+    int dims[4] = {1, IN_C, hw, hw};
+
+    tensor_t input = get_graph_input_tensor(graph, 0, 0);
+
+    if (set_tensor_shape(input, dims, 4) < 0
+        || set_tensor_buffer(input, shape_input[shape], IN_C * hw * hw * sizeof(float)) < 0
+        || run_graph(graph, 1) < 0)
+        return -1;
+
+    return 0;
+}
+
+/* the outputs of the last run compared to the expected ones of the shape, -1 for a mismatch */
+static int check_shape(graph_t graph, int shape, int index)
+{
+    int ret = 0;
+
+    for (int i = 0; i < OUTPUT_NUM; i++)
+    {
+        tensor_t output = get_graph_output_tensor(graph, i, 0);
+        int size = get_tensor_buffer_size(output) / sizeof(float);
+
+        char what[64];
+        snprintf(what, sizeof(what), "instance %d shape %d output %d", index, shape, i);
+
+        if (size != shape_output_size[shape][i])
+        {
+            fprintf(stderr, "%s: size %d, expected %d\n", what, size, shape_output_size[shape][i]);
+            ret = -1;
+        }
+        else if (test_cpu_compare(what, (float*)get_tensor_buffer(output), shape_output[shape][i], size, 1e-5f) > 0)
+        {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+struct instance_job
+{
+    graph_t graph;
+    int index;
+    int fails;
+    int mismatches;
+};
+
+static void* run_instance(void* arg)
+{
+    struct instance_job* job = (struct instance_job*)arg;
+
+    for (int i = 0; i < LOOP_NUM; i++)
+    {
+        int shape = (job->index + i) % SHAPE_NUM;
+
+        if (run_shape(job->graph, shape) < 0)
+            job->fails++;
+        else if (check_shape(job->graph, shape, job->index) < 0)
+            job->mismatches++;
+    }
+
+    return NULL;
+}
+
+static int test_clone_graph(void)
+{
+    graph_t instances[INSTANCE_NUM];
+    instances[0] = create_test_graph();
+
+    if (NULL == instances[0])
+    {
+        fprintf(stderr, "create the test graph failed.\n");
+        return -1;
+    }
+
+    /* the expected outputs are the ones of the origin run alone */
+    for (int s = 0; s < SHAPE_NUM; s++)
+    {
+        if (run_shape(instances[0], s) < 0)
+        {
+            fprintf(stderr, "run the origin graph with shape %d failed.\n", s);
+            return -1;
+        }
+
+        for (int i = 0; i < OUTPUT_NUM; i++)
+        {
+            tensor_t output = get_graph_output_tensor(instances[0], i, 0);
+            int size = get_tensor_buffer_size(output) / sizeof(float);
+
+            shape_output_size[s][i] = size;
+            shape_output[s][i] = (float*)realloc(shape_output[s][i], size * sizeof(float));
+            memcpy(shape_output[s][i], get_tensor_buffer(output), size * sizeof(float));
+        }
+    }
+
+    for (int i = 1; i < INSTANCE_NUM; i++)
+    {
+        /* a clone of a clone has the same origin */
+        instances[i] = clone_graph(instances[i - 1]);
+
+        struct options opt;
+        opt.num_thread = 1;
+        opt.cluster = TENGINE_CLUSTER_ALL;
+        opt.precision = TENGINE_MODE_FP32;
+        opt.affinity = 0;
+
+        if (NULL == instances[i] || prerun_graph_multithread(instances[i], opt) < 0)
+        {
+            fprintf(stderr, "clone and prerun instance %d failed.\n", i);
+            return -1;
+        }
+    }
+
+    int ret = 0;
+
+    /* in turn, each shape kept for two rounds, an instance runs again after the others are reshaped to theirs */
+    for (int i = 0; i < LOOP_NUM; i++)
+    {
+        int index = i % INSTANCE_NUM;
+        int shape = (index + i / (2 * INSTANCE_NUM)) % SHAPE_NUM;
+
+        if (run_shape(instances[index], shape) < 0 || check_shape(instances[index], shape, index) < 0)
+        {
+            fprintf(stderr, "instance %d in turn with shape %d failed.\n", index, shape);
+            ret = -1;
+        }
+    }
+
+    pthread_t threads[INSTANCE_NUM];
+    struct instance_job jobs[INSTANCE_NUM];
+
+    for (int i = 0; i < INSTANCE_NUM; i++)
+    {
+        jobs[i].graph = instances[i];
+        jobs[i].index = i;
+        jobs[i].fails = 0;
+        jobs[i].mismatches = 0;
+
+        pthread_create(&threads[i], NULL, run_instance, &jobs[i]);
+    }
+
+    for (int i = 0; i < INSTANCE_NUM; i++)
+    {
+        pthread_join(threads[i], NULL);
+
+        if (jobs[i].fails > 0 || jobs[i].mismatches > 0)
+        {
+            fprintf(stderr, "instance %d: %d runs failed, %d outputs differ.\n", i, jobs[i].fails,
+                    jobs[i].mismatches);
+            ret = -1;
+        }
+    }
+
+    /* the origin first, it is kept until its clones are destroyed */
+    for (int i = 0; i < INSTANCE_NUM; i++)
+    {
+        postrun_graph(instances[i]);
+        destroy_graph(instances[i]);
+    }
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 7;
+
+    for (int i = 0; i < OUT_C * IN_C * 9; i++)
+        weight[i] = test_cpu_random(&seed);
+    for (int i = 0; i < OUT_C; i++)
+        bias[i] = test_cpu_random(&seed);
+
+    for (int s = 0; s < SHAPE_NUM; s++)
+    {
+        int size = IN_C * get_shape_hw(s) * get_shape_hw(s);
+        shape_input[s] = (float*)malloc(size * sizeof(float));
+        for (int i = 0; i < size; i++)
+            shape_input[s][i] = test_cpu_random(&seed);
+    }
+
+    init_tengine();
+
+    int ret = test_clone_graph();
+    if (0 != ret)
+        fprintf(stderr, "test clone graph with the optimized ops failed.\n");
+
+    /* the op implementations are selected in prerun */
+    setenv("TG_DEBUG_REF", "1", 1);
+
+    if (0 != test_clone_graph())
+    {
+        fprintf(stderr, "test clone graph with the reference ops failed.\n");
+        ret = -1;
+    }
+
+    release_tengine();
+
+    for (int s = 0; s < SHAPE_NUM; s++)
+    {
+        free(shape_input[s]);
+        for (int i = 0; i < OUTPUT_NUM; i++)
+            free(shape_output[s][i]);
+    }
+
+    if (0 == ret)
+        fprintf(stderr, "test clone graph pass.\n");
+
+    return ret;
+}
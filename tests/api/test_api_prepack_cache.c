@@ -0,0 +1,387 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * the prepack cache of TG_PREPACK_CACHE: a graph prerun writes its packed weights to a file, and
+ * the next one maps it and runs on the weights in it, which the test shows by spoiling them. a
+ * file of another version is written again. the fp32 and fp16 modes keep files of their own, the
+ * fp16 one holding the half weights of the fc too. processes preruning the same graph at once
+ * leave a single whole file and no temp ones.
+ */
+
+#include "test_cpu_graph.h"
+
+#include <dirent.h>
+#include <stdint.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define IN_C        4
+#define IN_HW       8
+#define CONV_C      8
+#define FC_OUT      10
+#define PROCESS_NUM 4
+
+/* the version follows the 8 bytes of the magic in the header */
+#define VERSION_OFFSET 8
+
+static float input_data[IN_C * IN_HW * IN_HW];
+
+/* input -> conv 3x3 -> fc, both pack their weights */
+static graph_t create_test_graph(void)
+{
+    unsigned int seed = 29;
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[4] = {1, IN_C, IN_HW, IN_HW};
+
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 4, input_data);
+    tensor_t conv = test_cpu_conv(graph, "conv", input, IN_C, CONV_C, 3, 1, 1, 0, &seed);
+
+    if (NULL == conv || NULL == test_cpu_fc(graph, "fc", conv, CONV_C * IN_HW * IN_HW, FC_OUT, &seed))
+        return NULL;
+
+    return graph;
+}
+
+/* prerun in the precision and run once, the output is copied to output */
+static int run_test_graph(int precision, float* output)
+{
+    graph_t graph = create_test_graph();
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"fc"};
+
+    if (NULL == graph || test_cpu_prerun_mode(graph, inputs, 1, outputs, 1, 1, precision) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "prepack cache: run of precision %d failed.\n", precision);
+        return -1;
+    }
+
+    memcpy(output, get_tensor_buffer(get_graph_tensor(graph, "fc")), FC_OUT * sizeof(float));
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return 0;
+}
+
+/* the number of cache files and of other files in the directory, the path of the last cache file */
+static int list_cache_dir(const char* dir, int* other_num, char* path, int path_size)
+{
+    DIR* d = opendir(dir);
+    if (NULL == d)
+        return -1;
+
+    int cache_num = 0;
+    *other_num = 0;
+
+    struct dirent* entry;
+    while (NULL != (entry = readdir(d)))
+    {
+        const char* name = entry->d_name;
+        size_t len = strlen(name);
+
+        if (0 == strcmp(name, ".") || 0 == strcmp(name, ".."))
+            continue;
+
+        if (len > 7 && 0 == strcmp(name + len - 7, ".tmpack"))
+        {
+            cache_num++;
+            snprintf(path, path_size, "%s/%s", dir, name);
+        }
+        else
+            (*other_num)++;
+    }
+
+    closedir(d);
+
+    return cache_num;
+}
+
+static void clear_cache_dir(const char* dir)
+{
+    DIR* d = opendir(dir);
+    if (NULL == d)
+        return;
+
+    char path[512];
+    struct dirent* entry;
+
+    while (NULL != (entry = readdir(d)))
+    {
+        if (0 == strcmp(entry->d_name, ".") || 0 == strcmp(entry->d_name, ".."))
+            continue;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        unlink(path);
+    }
+
+    closedir(d);
+}
+
+/* write the bytes over the file at the offset, from the end for a negative one */
+static int patch_file(const char* path, long offset, const void* data, size_t size)
+{
+    FILE* fp = fopen(path, "r+b");
+    if (NULL == fp)
+        return -1;
+
+    int ret = fseek(fp, offset, offset < 0 ? SEEK_END : SEEK_SET) == 0 && fwrite(data, size, 1, fp) == 1 ? 0 : -1;
+
+    fclose(fp);
+
+    return ret;
+}
+
+static int read_file_version(const char* path, uint32_t* version)
+{
+    FILE* fp = fopen(path, "rb");
+    if (NULL == fp)
+        return -1;
+
+    int ret = fseek(fp, VERSION_OFFSET, SEEK_SET) == 0 && fread(version, sizeof(uint32_t), 1, fp) == 1 ? 0 : -1;
+
+    fclose(fp);
+
+    return ret;
+}
+
+static int has_suffix(const char* path, const char* suffix)
+{
+    size_t len = strlen(path);
+    size_t suffix_len = strlen(suffix);
+
+    return len >= suffix_len && 0 == strcmp(path + len - suffix_len, suffix);
+}
+
+/* write the file, map it, spoil the weights in it, then spoil its version so it is written again */
+static int test_round_trip(const char* dir, const float* expected)
+{
+    float output[FC_OUT];
+    char path[512];
+    int other_num;
+
+    if (run_test_graph(TENGINE_MODE_FP32, output) < 0)
+        return -1;
+
+    /* fp32 mode and weights on 1 thread */
+    if (list_cache_dir(dir, &other_num, path, sizeof(path)) != 1 || other_num != 0 || !has_suffix(path, "_1_0_0.tmpack"))
+    {
+        fprintf(stderr, "prepack cache: the first prerun does not leave one fp32 cache file.\n");
+        return -1;
+    }
+
+    int ret = test_cpu_compare("prepack cache write", output, expected, FC_OUT, 1e-5f) > 0 ? -1 : 0;
+
+    if (run_test_graph(TENGINE_MODE_FP32, output) < 0)
+        return -1;
+
+    ret |= test_cpu_compare("prepack cache map", output, expected, FC_OUT, 1e-5f) > 0 ? -1 : 0;
+
+    /* the header and the entries are far smaller than the weights, the second half of the file is all weights */
+    FILE* fp = fopen(path, "rb");
+    if (NULL == fp || fseek(fp, 0, SEEK_END) != 0)
+        return -1;
+
+    long spoil_size = ftell(fp) / 2;
+    fclose(fp);
+
+    float* spoil = (float*)malloc(spoil_size);
+    for (long i = 0; i < spoil_size / (long)sizeof(float); i++)
+        spoil[i] = 100.f;
+
+    int spoiled = patch_file(path, -spoil_size, spoil, spoil_size);
+    free(spoil);
+
+    if (spoiled < 0 || run_test_graph(TENGINE_MODE_FP32, output) < 0)
+        return -1;
+
+    int changed = 0;
+    for (int i = 0; i < FC_OUT; i++)
+        changed |= fabsf(output[i] - expected[i]) > 1e-3f;
+
+    if (!changed)
+    {
+        fprintf(stderr, "prepack cache: the graph does not run on the weights of the file.\n");
+        ret = -1;
+    }
+
+    /* the file of another version is packed and written again */
+    uint32_t version = 0xffffffff;
+
+    if (patch_file(path, VERSION_OFFSET, &version, sizeof(version)) < 0 || run_test_graph(TENGINE_MODE_FP32, output) < 0)
+        return -1;
+
+    ret |= test_cpu_compare("prepack cache mismatch", output, expected, FC_OUT, 1e-5f) > 0 ? -1 : 0;
+
+    if (read_file_version(path, &version) < 0 || version == 0xffffffff)
+    {
+        fprintf(stderr, "prepack cache: the file of another version is not written again.\n");
+        ret = -1;
+    }
+
+    if (run_test_graph(TENGINE_MODE_FP32, output) < 0)
+        return -1;
+
+    ret |= test_cpu_compare("prepack cache rewritten", output, expected, FC_OUT, 1e-5f) > 0 ? -1 : 0;
+
+    return ret;
+}
+
+/* the fp16 weights of the fc go to a file of their own, next to the fp32 one */
+static int test_mode(const char* dir)
+{
+    float written[FC_OUT];
+    float mapped[FC_OUT];
+    char path[512];
+    int other_num;
+
+    if (run_test_graph(TENGINE_MODE_FP16, written) < 0 || run_test_graph(TENGINE_MODE_FP16, mapped) < 0)
+        return -1;
+
+    if (list_cache_dir(dir, &other_num, path, sizeof(path)) != 2 || other_num != 0)
+    {
+        fprintf(stderr, "prepack cache: the fp16 mode does not keep a file of its own.\n");
+        return -1;
+    }
+
+    return test_cpu_compare("prepack cache fp16", mapped, written, FC_OUT, 1e-6f) > 0 ? -1 : 0;
+}
+
+/* the processes wait on the pipe, so that they prerun at the same time once it is closed */
+static int test_processes(const char* dir)
+{
+    int fd[2];
+    pid_t pid[PROCESS_NUM];
+
+    if (pipe(fd) < 0)
+        return -1;
+
+    for (int i = 0; i < PROCESS_NUM; i++)
+    {
+        pid[i] = fork();
+
+        if (pid[i] < 0)
+            return -1;
+
+        if (0 == pid[i])
+        {
+            char c;
+            float output[FC_OUT];
+
+            close(fd[1]);
+            init_tengine();
+
+            int ret = read(fd[0], &c, 1) == 0 ? run_test_graph(TENGINE_MODE_FP32, output) : -1;
+
+            release_tengine();
+            _exit(0 == ret ? 0 : 1);
+        }
+    }
+
+    close(fd[0]);
+    close(fd[1]);
+
+    int ret = 0;
+
+    for (int i = 0; i < PROCESS_NUM; i++)
+    {
+        int status;
+
+        if (waitpid(pid[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            fprintf(stderr, "prepack cache: process %d failed.\n", i);
+            ret = -1;
+        }
+    }
+
+    char path[512];
+    int other_num;
+
+    if (list_cache_dir(dir, &other_num, path, sizeof(path)) != 1 || other_num != 0)
+    {
+        fprintf(stderr, "prepack cache: the processes do not leave one cache file and no temp file.\n");
+        ret = -1;
+    }
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 31;
+
+    for (int i = 0; i < IN_C * IN_HW * IN_HW; i++)
+        input_data[i] = test_cpu_random(&seed);
+
+    char dir[] = "/tmp/tengine_prepack_XXXXXX";
+
+    if (NULL == mkdtemp(dir))
+    {
+        fprintf(stderr, "prepack cache: no temp directory.\n");
+        return -1;
+    }
+
+    float expected[FC_OUT];
+    float output[FC_OUT];
+    int ret = 0;
+
+    /* the processes init the library themselves */
+    setenv("TG_PREPACK_CACHE", dir, 1);
+    ret |= test_processes(dir);
+    unsetenv("TG_PREPACK_CACHE");
+
+    init_tengine();
+
+    /* the output packed with no cache */
+    if (run_test_graph(TENGINE_MODE_FP32, expected) < 0)
+        return -1;
+
+    /* the file the processes wrote is whole */
+    setenv("TG_PREPACK_CACHE", dir, 1);
+
+    if (run_test_graph(TENGINE_MODE_FP32, output) < 0)
+        ret = -1;
+    else
+        ret |= test_cpu_compare("prepack cache processes", output, expected, FC_OUT, 1e-5f) > 0 ? -1 : 0;
+
+    clear_cache_dir(dir);
+
+    ret |= test_round_trip(dir, expected);
+    ret |= test_mode(dir);
+
+    unsetenv("TG_PREPACK_CACHE");
+
+    release_tengine();
+
+    clear_cache_dir(dir);
+    rmdir(dir);
+
+    if (0 == ret)
+        fprintf(stderr, "test prepack cache pass.\n");
+
+    return ret;
+}
@@ -0,0 +1,317 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+#ifndef __TEST_CPU_GRAPH_H__
+#define __TEST_CPU_GRAPH_H__
+
+/*
+ * the helpers of the c tests building their graphs in code and running them on the cpu,
+ * the expected outputs are computed by the tests themselves.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tengine/c_api.h"
+
+#include "graph/graph.h"
+#include "graph/node.h"
+#include "graph/tensor.h"
+
+#include "operator/prototype/convolution_param.h"
+#include "operator/prototype/fc_param.h"
+#include "operator/prototype/pooling_param.h"
+
+static inline int test_cpu_elem_size(int data_type)
+{
+    switch (data_type)
+    {
+    case TENGINE_DT_FP32:
+    case TENGINE_DT_INT32:
+        return 4;
+    case TENGINE_DT_FP16:
+    case TENGINE_DT_INT16:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+/* an input node and its tensor of the shape, the data is bound to the tensor if not NULL */
+static inline tensor_t test_cpu_input(graph_t graph, const char* name, int data_type, const int* dims, int dim_num,
+                                      void* data)
+{
+    node_t node = create_graph_node(graph, name, "InputOp");
+    tensor_t tensor = create_graph_tensor(graph, name, data_type);
+
+    if (NULL == node || NULL == tensor)
+        return NULL;
+
+    set_node_output_tensor(node, 0, tensor, TENSOR_TYPE_INPUT);
+    set_tensor_shape(tensor, dims, dim_num);
+
+    if (NULL != data)
+    {
+        int size = test_cpu_elem_size(data_type);
+        for (int i = 0; i < dim_num; i++)
+            size *= dims[i];
+
+        set_tensor_buffer(tensor, data, size);
+    }
+
+    return tensor;
+}
+
+/* a const node and its tensor holding the data */
+static inline tensor_t test_cpu_const(graph_t graph, const char* name, int data_type, const int* dims, int dim_num,
+                                      void* data)
+{
+    node_t node = create_graph_node(graph, name, "Const");
+    tensor_t tensor = create_graph_tensor(graph, name, data_type);
+
+    if (NULL == node || NULL == tensor)
+        return NULL;
+
+    set_node_output_tensor(node, 0, tensor, TENSOR_TYPE_CONST);
+    set_tensor_shape(tensor, dims, dim_num);
+
+    int size = test_cpu_elem_size(data_type);
+    for (int i = 0; i < dim_num; i++)
+        size *= dims[i];
+
+    set_tensor_buffer(tensor, data, size);
+
+    return tensor;
+}
+
+/* a node of the op on the inputs, the output tensors are named after it, "<name>" and "<name>_<index>" */
+static inline node_t test_cpu_node(graph_t graph, const char* name, const char* op, tensor_t* inputs, int input_num,
+                                   const int* output_types, int output_num)
+{
+    node_t node = create_graph_node(graph, name, op);
+
+    if (NULL == node)
+        return NULL;
+
+    for (int i = 0; i < input_num; i++)
+        set_node_input_tensor(node, i, inputs[i]);
+
+    for (int i = 0; i < output_num; i++)
+    {
+        char tensor_name[64];
+
+        if (i == 0)
+            snprintf(tensor_name, sizeof(tensor_name), "%s", name);
+        else
+            snprintf(tensor_name, sizeof(tensor_name), "%s_%d", name, i);
+
+        tensor_t tensor = create_graph_tensor(graph, tensor_name, output_types[i]);
+
+        if (NULL == tensor)
+            return NULL;
+
+        set_node_output_tensor(node, i, tensor, TENSOR_TYPE_VAR);
+    }
+
+    return node;
+}
+
+/* the op params of a node created by test_cpu_node() */
+static inline void* test_cpu_param(node_t node)
+{
+    return ((struct node*)node)->op.param_mem;
+}
+
+/* set the input and the output nodes, and prerun the graph in the precision with the threads */
+static inline int test_cpu_prerun_mode(graph_t graph, const char* inputs[], int input_num, const char* outputs[],
+                                       int output_num, int num_thread, int precision)
+{
+    if (set_graph_input_node(graph, inputs, input_num) < 0 || set_graph_output_node(graph, outputs, output_num) < 0)
+        return -1;
+
+    struct options opt;
+    opt.num_thread = num_thread;
+    opt.cluster = TENGINE_CLUSTER_ALL;
+    opt.precision = precision;
+    opt.affinity = 0;
+
+    return prerun_graph_multithread(graph, opt);
+}
+
+/* set the input and the output nodes, and prerun the graph in fp32 with the threads */
+static inline int test_cpu_prerun(graph_t graph, const char* inputs[], int input_num, const char* outputs[],
+                                  int output_num, int num_thread)
+{
+    return test_cpu_prerun_mode(graph, inputs, input_num, outputs, output_num, num_thread, TENGINE_MODE_FP32);
+}
+
+/* count the elements differing by more than eps, the first ones are printed */
+static inline int test_cpu_compare(const char* what, const float* data, const float* expected, int size, float eps)
+{
+    int bad = 0;
+
+    for (int i = 0; i < size; i++)
+    {
+        if (fabsf(data[i] - expected[i]) <= eps * (1.f + fabsf(expected[i])))
+            continue;
+
+        if (bad < 4)
+            fprintf(stderr, "%s: [%d] %f, expected %f\n", what, i, data[i], expected[i]);
+
+        bad++;
+    }
+
+    return bad;
+}
+
+/* a fixed sequence in [-1, 1) of the seed */
+static inline float test_cpu_random(unsigned int* seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return (float)((*seed >> 8) & 0xffff) / 32768.f - 1.f;
+}
+
+/* a const of random data in [-scale, scale), the data is freed with the graph */
+static inline tensor_t test_cpu_random_const(graph_t graph, const char* name, const int* dims, int dim_num,
+                                             float scale, unsigned int* seed)
+{
+    int size = 1;
+    for (int i = 0; i < dim_num; i++)
+        size *= dims[i];
+
+    float* data = (float*)malloc(size * sizeof(float));
+    for (int i = 0; i < size; i++)
+        data[i] = scale * test_cpu_random(seed);
+
+    tensor_t tensor = test_cpu_const(graph, name, TENGINE_DT_FP32, dims, dim_num, data);
+
+    if (NULL == tensor)
+    {
+        free(data);
+        return NULL;
+    }
+
+    ((struct tensor*)tensor)->free_host_mem = 1;
+
+    return tensor;
+}
+
+/*
+ * a convolution of the input of in_c channels to out_c ones, of random weights and bias named
+ * "<name>_weight" and "<name>_bias", padded to keep the size at stride 1. returns the output.
+ */
+static inline tensor_t test_cpu_conv(graph_t graph, const char* name, tensor_t input, int in_c, int out_c, int kernel,
+                                     int stride, int group, int activation, unsigned int* seed)
+{
+    char const_name[64];
+    int weight_dims[4] = {out_c, in_c / group, kernel, kernel};
+    int bias_dims[1] = {out_c};
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    /* the outputs keep about the scale of the inputs */
+    float scale = 1.f / sqrtf((float)(in_c / group * kernel * kernel));
+
+    tensor_t inputs[3];
+    inputs[0] = input;
+    snprintf(const_name, sizeof(const_name), "%s_weight", name);
+    inputs[1] = test_cpu_random_const(graph, const_name, weight_dims, 4, scale, seed);
+    snprintf(const_name, sizeof(const_name), "%s_bias", name);
+    inputs[2] = test_cpu_random_const(graph, const_name, bias_dims, 1, 0.1f, seed);
+
+    node_t node = test_cpu_node(graph, name, "Convolution", inputs, 3, fp32, 1);
+
+    if (NULL == inputs[1] || NULL == inputs[2] || NULL == node)
+        return NULL;
+
+    struct conv_param* param = (struct conv_param*)test_cpu_param(node);
+    param->kernel_h = kernel;
+    param->kernel_w = kernel;
+    param->stride_h = stride;
+    param->stride_w = stride;
+    param->pad_h0 = kernel / 2;
+    param->pad_h1 = kernel / 2;
+    param->pad_w0 = kernel / 2;
+    param->pad_w1 = kernel / 2;
+    param->dilation_h = 1;
+    param->dilation_w = 1;
+    param->input_channel = in_c;
+    param->output_channel = out_c;
+    param->group = group;
+    param->activation = activation;
+
+    return get_graph_tensor(graph, name);
+}
+
+/* a fully connected of the input of k elements a batch to n, of random weights and bias. returns the output */
+static inline tensor_t test_cpu_fc(graph_t graph, const char* name, tensor_t input, int k, int n, unsigned int* seed)
+{
+    char const_name[64];
+    int weight_dims[2] = {n, k};
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    tensor_t inputs[3];
+    inputs[0] = input;
+    snprintf(const_name, sizeof(const_name), "%s_weight", name);
+    inputs[1] = test_cpu_random_const(graph, const_name, weight_dims, 2, 1.f / sqrtf((float)k), seed);
+    snprintf(const_name, sizeof(const_name), "%s_bias", name);
+    inputs[2] = test_cpu_random_const(graph, const_name, &n, 1, 0.1f, seed);
+
+    node_t node = test_cpu_node(graph, name, "FullyConnected", inputs, 3, fp32, 1);
+
+    if (NULL == inputs[1] || NULL == inputs[2] || NULL == node)
+        return NULL;
+
+    ((struct fc_param*)test_cpu_param(node))->num_output = n;
+
+    return get_graph_tensor(graph, name);
+}
+
+/* a pooling of the method, padded to keep the size at stride 1, global for the kernel 0. returns the output */
+static inline tensor_t test_cpu_pool(graph_t graph, const char* name, tensor_t input, int method, int kernel,
+                                     int stride)
+{
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    node_t node = test_cpu_node(graph, name, "Pooling", &input, 1, fp32, 1);
+
+    if (NULL == node)
+        return NULL;
+
+    struct pool_param* param = (struct pool_param*)test_cpu_param(node);
+    param->pool_method = method;
+    param->global = 0 == kernel;
+    param->kernel_h = kernel;
+    param->kernel_w = kernel;
+    param->stride_h = stride;
+    param->stride_w = stride;
+    param->pad_h0 = param->pad_h0_org = kernel / 2;
+    param->pad_h1 = param->pad_h1_org = kernel / 2;
+    param->pad_w0 = param->pad_w0_org = kernel / 2;
+    param->pad_w1 = param->pad_w1_org = kernel / 2;
+
+    return get_graph_tensor(graph, name);
+}
+
+#endif
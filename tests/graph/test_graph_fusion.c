@@ -0,0 +1,320 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * graph fusion: a graph made of every pattern the fusion folds, run fused and with TG_NO_FUSION=1.
+ * batchnorm and scale folded into a conv and a fc, a conv without bias getting one, relu then a
+ * min with 6 as relu6, the residual sum and the clip as the activation of a conv, a batchnorm
+ * folded into the scale after it, and the dropouts removed, one of them a graph output. the fused
+ * graph keeps the convs, the pooling, the scale and the fc only, and the outputs are the same.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/op.h"
+#include "operator/prototype/batchnorm_param.h"
+#include "operator/prototype/clip_param.h"
+#include "operator/prototype/eltwise_param.h"
+
+#define IN_C       8
+#define IN_HW      9
+#define FC_OUT     10
+#define INPUT_NUM  2
+#define OUTPUT_NUM 3
+
+/* the ops left once fused, besides the input and the consts */
+#define FUSED_NODE_NUM 6
+
+static const char* output_names[OUTPUT_NUM] = {"relu_1", "scale_3", "out"};
+
+static tensor_t create_op(graph_t graph, const char* name, const char* op, tensor_t* inputs, int input_num)
+{
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    if (NULL == test_cpu_node(graph, name, op, inputs, input_num, fp32, 1))
+        return NULL;
+
+    return get_graph_tensor(graph, name);
+}
+
+/* a batchnorm of random gamma, beta and mean, of a variance in [0.5, 1.5) */
+static tensor_t create_batchnorm(graph_t graph, const char* name, tensor_t input, int channel, unsigned int* seed)
+{
+    static const char* const_names[4] = {"gamma", "beta", "mean", "var"};
+
+    char const_name[64];
+    tensor_t inputs[5];
+
+    inputs[0] = input;
+
+    for (int i = 0; i < 4; i++)
+    {
+        snprintf(const_name, sizeof(const_name), "%s_%s", name, const_names[i]);
+        inputs[i + 1] = test_cpu_random_const(graph, const_name, &channel, 1, 0.5f, seed);
+        if (NULL == inputs[i + 1])
+            return NULL;
+    }
+
+    float* var = (float*)((struct tensor*)inputs[4])->data;
+    float* gamma = (float*)((struct tensor*)inputs[1])->data;
+    for (int c = 0; c < channel; c++)
+    {
+        var[c] += 1.f;
+        gamma[c] += 1.f;
+    }
+
+    return create_op(graph, name, "BatchNormalize", inputs, 5);
+}
+
+static tensor_t create_scale(graph_t graph, const char* name, tensor_t input, int channel, unsigned int* seed)
+{
+    char const_name[64];
+    tensor_t inputs[3];
+
+    inputs[0] = input;
+    snprintf(const_name, sizeof(const_name), "%s_gamma", name);
+    inputs[1] = test_cpu_random_const(graph, const_name, &channel, 1, 1.f, seed);
+    snprintf(const_name, sizeof(const_name), "%s_beta", name);
+    inputs[2] = test_cpu_random_const(graph, const_name, &channel, 1, 0.5f, seed);
+
+    if (NULL == inputs[1] || NULL == inputs[2])
+        return NULL;
+
+    return create_op(graph, name, "Scale", inputs, 3);
+}
+
+/* a 1x1 conv of no bias, so the fusion has to add one */
+static tensor_t create_conv_no_bias(graph_t graph, const char* name, tensor_t input, int channel, unsigned int* seed)
+{
+    char const_name[64];
+    int weight_dims[4] = {channel, channel, 1, 1};
+
+    tensor_t inputs[2];
+    inputs[0] = input;
+    snprintf(const_name, sizeof(const_name), "%s_weight", name);
+    inputs[1] = test_cpu_random_const(graph, const_name, weight_dims, 4, 1.f / sqrtf((float)channel), seed);
+
+    if (NULL == inputs[1] || NULL == create_op(graph, name, "Convolution", inputs, 2))
+        return NULL;
+
+    struct conv_param* param = (struct conv_param*)test_cpu_param(get_graph_node(graph, name));
+    param->kernel_h = 1;
+    param->kernel_w = 1;
+    param->stride_h = 1;
+    param->stride_w = 1;
+    param->pad_h0 = 0;
+    param->pad_h1 = 0;
+    param->pad_w0 = 0;
+    param->pad_w1 = 0;
+    param->dilation_h = 1;
+    param->dilation_w = 1;
+    param->input_channel = channel;
+    param->output_channel = channel;
+    param->group = 1;
+    param->activation = -1;
+
+    return get_graph_tensor(graph, name);
+}
+
+static graph_t create_test_graph(void)
+{
+    unsigned int seed = 17;
+    int channel = IN_C;
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[4] = {1, IN_C, IN_HW, IN_HW};
+    int six_dims[1] = {1};
+    static float six[1] = {6.f};
+
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 4, NULL);
+
+    /* conv -> batchnorm -> scale -> relu, all of them into the conv */
+    tensor_t t = test_cpu_conv(graph, "conv_1", input, IN_C, IN_C, 3, 1, 1, -1, &seed);
+    t = create_batchnorm(graph, "bn_1", t, channel, &seed);
+    t = create_scale(graph, "scale_1", t, channel, &seed);
+    tensor_t relu_1 = create_op(graph, "relu_1", "ReLU", &t, 1);
+
+    /* conv of no bias -> batchnorm -> relu -> min 6 */
+    t = create_conv_no_bias(graph, "conv_2", relu_1, channel, &seed);
+    t = create_batchnorm(graph, "bn_2", t, channel, &seed);
+    t = create_op(graph, "relu_2", "ReLU", &t, 1);
+
+    tensor_t min_inputs[2] = {t, test_cpu_const(graph, "six", TENGINE_DT_FP32, six_dims, 1, six)};
+    t = create_op(graph, "min_2", "Eltwise", min_inputs, 2);
+    if (NULL == t)
+        return NULL;
+
+    ((struct eltwise_param*)test_cpu_param(get_graph_node(graph, "min_2")))->type = ELT_MIN_SCALAR;
+
+    /* conv + relu_1 -> clip to 6, the sum and the clip into the conv */
+    tensor_t sum_inputs[2];
+    sum_inputs[0] = test_cpu_conv(graph, "conv_3", t, IN_C, IN_C, 3, 1, 1, -1, &seed);
+    sum_inputs[1] = relu_1;
+    t = create_op(graph, "sum_3", "Eltwise", sum_inputs, 2);
+    if (NULL == sum_inputs[0] || NULL == t)
+        return NULL;
+
+    ((struct eltwise_param*)test_cpu_param(get_graph_node(graph, "sum_3")))->type = ELT_SUM;
+
+    t = create_op(graph, "clip_3", "Clip", &t, 1);
+    if (NULL == t)
+        return NULL;
+
+    struct clip_param* clip = (struct clip_param*)test_cpu_param(get_graph_node(graph, "clip_3"));
+    clip->min = 0.f;
+    clip->max = 6.f;
+
+    /* pool -> batchnorm -> scale, the batchnorm into the scale */
+    t = test_cpu_pool(graph, "pool_3", t, POOL_MAX, 3, 1);
+    t = create_batchnorm(graph, "bn_3", t, channel, &seed);
+    tensor_t scale_3 = create_scale(graph, "scale_3", t, channel, &seed);
+
+    /* dropout -> fc -> batchnorm -> relu -> dropout as the output, all but the fc removed */
+    t = create_op(graph, "drop_4", "Dropout", &scale_3, 1);
+    t = test_cpu_fc(graph, "fc_4", t, IN_C * IN_HW * IN_HW, FC_OUT, &seed);
+    t = create_batchnorm(graph, "bn_4", t, FC_OUT, &seed);
+    t = create_op(graph, "relu_4", "ReLU", &t, 1);
+    t = create_op(graph, "out", "Dropout", &t, 1);
+
+    if (NULL == relu_1 || NULL == scale_3 || NULL == t)
+        return NULL;
+
+    const char* inputs[] = {"input"};
+
+    if (test_cpu_prerun(graph, inputs, 1, output_names, OUTPUT_NUM, 1) < 0)
+        return NULL;
+
+    return graph;
+}
+
+static int run_input(graph_t graph, float* input_data)
+{
+    tensor_t input = get_graph_input_tensor(graph, 0, 0);
+
+    if (set_tensor_buffer(input, input_data, IN_C * IN_HW * IN_HW * sizeof(float)) < 0 || run_graph(graph, 1) < 0)
+        return -1;
+
+    return 0;
+}
+
+/* the nodes left besides the input and the consts */
+static int count_op_nodes(graph_t graph)
+{
+    struct graph* ir_graph = (struct graph*)graph;
+    int count = 0;
+
+    for (int i = 0; i < ir_graph->node_num; i++)
+    {
+        int type = ir_graph->node_list[i]->op.type;
+
+        if (type != OP_INPUT && type != OP_CONST)
+            count++;
+    }
+
+    return count;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 19;
+
+    float* input_data[INPUT_NUM];
+
+    /* large enough for the relu6 and the clip to cut some of the values at 6 */
+    for (int i = 0; i < INPUT_NUM; i++)
+    {
+        input_data[i] = (float*)malloc(IN_C * IN_HW * IN_HW * sizeof(float));
+        for (int j = 0; j < IN_C * IN_HW * IN_HW; j++)
+            input_data[i][j] = 16.f * test_cpu_random(&seed);
+    }
+
+    init_tengine();
+
+    setenv("TG_NO_FUSION", "1", 1);
+    graph_t origin = create_test_graph();
+    unsetenv("TG_NO_FUSION");
+
+    graph_t fused = create_test_graph();
+
+    if (NULL == origin || NULL == fused)
+    {
+        fprintf(stderr, "fusion: prerun failed.\n");
+        return -1;
+    }
+
+    int ret = 0;
+
+    if (count_op_nodes(fused) != FUSED_NODE_NUM)
+    {
+        fprintf(stderr, "fusion: %d nodes left, expected %d, of %d\n", count_op_nodes(fused), FUSED_NODE_NUM, count_op_nodes(origin));
+        ret = -1;
+    }
+
+    for (int i = 0; i < INPUT_NUM; i++)
+    {
+        if (run_input(origin, input_data[i]) < 0 || run_input(fused, input_data[i]) < 0)
+        {
+            fprintf(stderr, "fusion: run failed.\n");
+            ret = -1;
+            break;
+        }
+
+        for (int j = 0; j < OUTPUT_NUM; j++)
+        {
+            tensor_t expected = get_graph_tensor(origin, output_names[j]);
+            tensor_t output = get_graph_tensor(fused, output_names[j]);
+            int size = get_tensor_buffer_size(expected) / sizeof(float);
+
+            char what[64];
+            snprintf(what, sizeof(what), "fusion input %d %s", i, output_names[j]);
+
+            if (NULL == output || get_tensor_buffer_size(output) != get_tensor_buffer_size(expected))
+            {
+                fprintf(stderr, "%s: size mismatch.\n", what);
+                ret = -1;
+            }
+            else if (test_cpu_compare(what, (float*)get_tensor_buffer(output), (float*)get_tensor_buffer(expected), size, 1e-4f) > 0)
+            {
+                ret = -1;
+            }
+        }
+    }
+
+    postrun_graph(origin);
+    destroy_graph(origin);
+    postrun_graph(fused);
+    destroy_graph(fused);
+
+    release_tengine();
+
+    for (int i = 0; i < INPUT_NUM; i++)
+        free(input_data[i]);
+
+    if (0 == ret)
+        fprintf(stderr, "test fusion pass.\n");
+
+    return ret;
+}
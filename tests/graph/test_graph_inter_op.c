@@ -0,0 +1,241 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * inter-op parallel mode: two inception blocks of four branches each run with TG_INTER_OP=1,
+ * so the branches of a wave run at once on their own slots of the shared mem, and the blocks
+ * of the arena are reused wave by wave. the outputs are compared to the ones of the graph run
+ * node by node, for waves wider and narrower than the threads, over a few inputs in turn.
+ * the threads are capped at the cores, so on a single core the graph runs node by node too.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/concat_param.h"
+
+#define IN_C       8
+#define IN_HW      15
+#define INPUT_NUM  3
+#define LOOP_NUM   6
+#define OUTPUT_NUM 3
+
+static const char* output_names[OUTPUT_NUM] = {"block_2", "side", "head"};
+
+/* the branches of 1x1, 1x1 -> 3x3, 1x1 -> 3x3 -> 3x3 and max pool -> 1x1, concatenated to 32 channels */
+static tensor_t create_inception(graph_t graph, const char* name, tensor_t input, int in_c, unsigned int* seed)
+{
+    char node_name[64];
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    tensor_t branches[4];
+
+    snprintf(node_name, sizeof(node_name), "%s_1x1", name);
+    branches[0] = test_cpu_conv(graph, node_name, input, in_c, 8, 1, 1, 1, 0, seed);
+
+    snprintf(node_name, sizeof(node_name), "%s_3x3_reduce", name);
+    tensor_t reduce = test_cpu_conv(graph, node_name, input, in_c, 6, 1, 1, 1, 0, seed);
+    snprintf(node_name, sizeof(node_name), "%s_3x3", name);
+    branches[1] = test_cpu_conv(graph, node_name, reduce, 6, 8, 3, 1, 1, 0, seed);
+
+    snprintf(node_name, sizeof(node_name), "%s_5x5_reduce", name);
+    reduce = test_cpu_conv(graph, node_name, input, in_c, 4, 1, 1, 1, 0, seed);
+    snprintf(node_name, sizeof(node_name), "%s_5x5_a", name);
+    tensor_t middle = test_cpu_conv(graph, node_name, reduce, 4, 8, 3, 1, 1, 0, seed);
+    snprintf(node_name, sizeof(node_name), "%s_5x5_b", name);
+    branches[2] = test_cpu_conv(graph, node_name, middle, 8, 8, 3, 1, 1, -1, seed);
+
+    snprintf(node_name, sizeof(node_name), "%s_pool", name);
+    tensor_t pool = test_cpu_pool(graph, node_name, input, POOL_MAX, 3, 1);
+    snprintf(node_name, sizeof(node_name), "%s_proj", name);
+    branches[3] = test_cpu_conv(graph, node_name, pool, in_c, 8, 1, 1, 1, 0, seed);
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (NULL == branches[i])
+            return NULL;
+    }
+
+    node_t concat = test_cpu_node(graph, name, "Concat", branches, 4, fp32, 1);
+    if (NULL == concat)
+        return NULL;
+
+    ((struct concat_param*)test_cpu_param(concat))->axis = 1;
+
+    return get_graph_tensor(graph, name);
+}
+
+/* stem -> block 1 -> block 2 -> 1x1 -> global pool, with the global pool of block 1 as a side output */
+static graph_t create_test_graph(int num_thread)
+{
+    unsigned int seed = 7;
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[4] = {1, IN_C, IN_HW, IN_HW};
+
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 4, NULL);
+    tensor_t stem = test_cpu_conv(graph, "stem", input, IN_C, 16, 3, 1, 1, 0, &seed);
+    tensor_t block_1 = create_inception(graph, "block_1", stem, 16, &seed);
+    tensor_t block_2 = create_inception(graph, "block_2", block_1, 32, &seed);
+    tensor_t side = test_cpu_pool(graph, "side", block_1, POOL_AVG, 0, 1);
+    tensor_t classifier = test_cpu_conv(graph, "classifier", block_2, 32, 10, 1, 1, 1, -1, &seed);
+    tensor_t head = test_cpu_pool(graph, "head", classifier, POOL_AVG, 0, 1);
+
+    if (NULL == side || NULL == head)
+        return NULL;
+
+    const char* inputs[] = {"input"};
+
+    if (test_cpu_prerun(graph, inputs, 1, output_names, OUTPUT_NUM, num_thread) < 0)
+        return NULL;
+
+    return graph;
+}
+
+static int run_input(graph_t graph, float* input_data)
+{
+    tensor_t input = get_graph_input_tensor(graph, 0, 0);
+
+    if (set_tensor_buffer(input, input_data, IN_C * IN_HW * IN_HW * sizeof(float)) < 0 || run_graph(graph, 1) < 0)
+        return -1;
+
+    return 0;
+}
+
+static int test_inter_op(float** input_data, float* expected[INPUT_NUM][OUTPUT_NUM],
+                         int expected_size[OUTPUT_NUM], int num_thread)
+{
+    setenv("TG_INTER_OP", "1", 1);
+    graph_t graph = create_test_graph(num_thread);
+    unsetenv("TG_INTER_OP");
+
+    if (NULL == graph)
+    {
+        fprintf(stderr, "inter op threads %d: prerun failed.\n", num_thread);
+        return -1;
+    }
+
+    int ret = 0;
+
+    for (int i = 0; i < LOOP_NUM && 0 == ret; i++)
+    {
+        int index = i % INPUT_NUM;
+
+        if (run_input(graph, input_data[index]) < 0)
+        {
+            fprintf(stderr, "inter op threads %d: run failed.\n", num_thread);
+            ret = -1;
+            break;
+        }
+
+        for (int j = 0; j < OUTPUT_NUM; j++)
+        {
+            tensor_t output = get_graph_output_tensor(graph, j, 0);
+            int size = get_tensor_buffer_size(output) / sizeof(float);
+
+            char what[64];
+            snprintf(what, sizeof(what), "inter op threads %d input %d %s", num_thread, index, output_names[j]);
+
+            if (size != expected_size[j])
+            {
+                fprintf(stderr, "%s: size %d, expected %d\n", what, size, expected_size[j]);
+                ret = -1;
+            }
+            else if (test_cpu_compare(what, (float*)get_tensor_buffer(output), expected[index][j], size, 1e-4f) > 0)
+            {
+                ret = -1;
+            }
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 11;
+
+    float* input_data[INPUT_NUM];
+    float* expected[INPUT_NUM][OUTPUT_NUM];
+    int expected_size[OUTPUT_NUM];
+
+    for (int i = 0; i < INPUT_NUM; i++)
+    {
+        input_data[i] = (float*)malloc(IN_C * IN_HW * IN_HW * sizeof(float));
+        for (int j = 0; j < IN_C * IN_HW * IN_HW; j++)
+            input_data[i][j] = test_cpu_random(&seed);
+    }
+
+    init_tengine();
+
+    int ret = 0;
+
+    /* the outputs of the nodes run in order */
+    graph_t graph = create_test_graph(1);
+
+    for (int i = 0; i < INPUT_NUM; i++)
+    {
+        if (NULL == graph || run_input(graph, input_data[i]) < 0)
+        {
+            fprintf(stderr, "serial run failed.\n");
+            return -1;
+        }
+
+        for (int j = 0; j < OUTPUT_NUM; j++)
+        {
+            tensor_t output = get_graph_output_tensor(graph, j, 0);
+
+            expected_size[j] = get_tensor_buffer_size(output) / sizeof(float);
+            expected[i][j] = (float*)malloc(expected_size[j] * sizeof(float));
+            memcpy(expected[i][j], get_tensor_buffer(output), expected_size[j] * sizeof(float));
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    /* the widest wave has four branches, the threads are fewer, as many and more */
+    ret |= test_inter_op(input_data, expected, expected_size, 2);
+    ret |= test_inter_op(input_data, expected, expected_size, 3);
+    ret |= test_inter_op(input_data, expected, expected_size, 4);
+    ret |= test_inter_op(input_data, expected, expected_size, 8);
+
+    release_tengine();
+
+    for (int i = 0; i < INPUT_NUM; i++)
+    {
+        free(input_data[i]);
+        for (int j = 0; j < OUTPUT_NUM; j++)
+            free(expected[i][j]);
+    }
+
+    if (0 == ret)
+        fprintf(stderr, "test inter op pass.\n");
+
+    return ret;
+}
@@ -0,0 +1,226 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * the blocked layout of x86: a conv -> pool -> conv -> depthwise conv -> pool -> conv chain of 5, 12,
+ * 20 and 13 channels, none of them a multiple of the block, ending in a reshape that reads the last
+ * conv as nchw. the chain is blocked inside, and the tensors at its boundaries stay nchw: the ones
+ * read by the reshape and by a noop, and the graph outputs, a global pooling and a conv among them.
+ * the outputs are compared to the ones of the graph run with TG_NO_NCHWC=1 for two input sizes, and
+ * the layouts are checked when the blocked one is on, which needs avx.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/reshape_param.h"
+
+#define IN_C       5
+#define SHAPE_NUM  2
+#define OUTPUT_NUM 4
+#define TENSOR_NUM 10
+
+static const char* output_names[OUTPUT_NUM] = {"flat", "side", "a5", "tail"};
+static const int shape_hw[SHAPE_NUM] = {14, 11};
+
+/* the layouts once the blocked one is on, the tensors of the nodes packing and read only by them are blocked */
+static const char* tensor_names[TENSOR_NUM] = {"a1", "p1", "a2", "a3", "p2", "a4", "a5", "a6", "side", "flat"};
+static const int tensor_blocked[TENSOR_NUM] = {1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+
+static graph_t create_test_graph(int hw)
+{
+    unsigned int seed = 37;
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[4] = {1, IN_C, hw, hw};
+
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 4, NULL);
+
+    /* the chain, the stride 2 and the small sizes keep the 3x3 convs off winograd */
+    tensor_t t = test_cpu_conv(graph, "a1", input, IN_C, 12, 3, 2, 1, 0, &seed);
+    tensor_t p1 = test_cpu_pool(graph, "p1", t, POOL_MAX, 3, 1);
+    tensor_t a2 = test_cpu_conv(graph, "a2", p1, 12, 20, 3, 1, 1, -1, &seed);
+    t = test_cpu_conv(graph, "a3", a2, 20, 20, 3, 1, 20, 0, &seed);
+    t = test_cpu_pool(graph, "p2", t, POOL_AVG, 3, 2);
+    t = test_cpu_conv(graph, "a4", t, 20, 13, 1, 1, 1, -1, &seed);
+
+    node_t reshape = test_cpu_node(graph, "flat", "Reshape", &t, 1, fp32, 1);
+    if (NULL == reshape)
+        return NULL;
+
+    struct reshape_param* param = (struct reshape_param*)test_cpu_param(reshape);
+    param->re_shape = (int*)malloc(3 * sizeof(int));
+    param->re_shape[0] = 1;
+    param->re_shape[1] = 13;
+    param->re_shape[2] = -1;
+    param->dim_size = 3;
+
+    /* a2 is read by a global pooling too, a5 is a graph output read by a conv, a6 is read by a noop */
+    tensor_t side = test_cpu_pool(graph, "side", a2, POOL_AVG, 0, 1);
+    tensor_t a5 = test_cpu_conv(graph, "a5", p1, 12, 8, 1, 1, 1, -1, &seed);
+    t = test_cpu_conv(graph, "a6", a5, 8, 8, 3, 1, 1, -1, &seed);
+
+    if (NULL == side || NULL == t || NULL == test_cpu_node(graph, "tail", "Noop", &t, 1, fp32, 1))
+        return NULL;
+
+    const char* inputs[] = {"input"};
+
+    if (test_cpu_prerun(graph, inputs, 1, output_names, OUTPUT_NUM, 1) < 0)
+        return NULL;
+
+    return graph;
+}
+
+static int run_shape(graph_t graph, int hw, float* input_data)
+{
+    int dims[4] = {1, IN_C, hw, hw};
+    tensor_t input = get_graph_input_tensor(graph, 0, 0);
+
+    if (set_tensor_shape(input, dims, 4) < 0 || set_tensor_buffer(input, input_data, IN_C * hw * hw * sizeof(float)) < 0)
+        return -1;
+
+    return run_graph(graph, 1);
+}
+
+static int check_layouts(graph_t graph)
+{
+    int blocked_num = 0;
+
+    for (int i = 0; i < TENSOR_NUM; i++)
+    {
+        struct tensor* ir_tensor = (struct tensor*)get_graph_tensor(graph, tensor_names[i]);
+
+        if (ir_tensor->layout != TENGINE_LAYOUT_NCHW)
+            blocked_num++;
+    }
+
+    /* no avx */
+    if (blocked_num == 0)
+    {
+        fprintf(stderr, "nchwc: the blocked layout is off, only the outputs are checked.\n");
+        return 0;
+    }
+
+    int ret = 0;
+
+    for (int i = 0; i < TENSOR_NUM; i++)
+    {
+        struct tensor* ir_tensor = (struct tensor*)get_graph_tensor(graph, tensor_names[i]);
+        int expected = tensor_blocked[i] ? TENGINE_LAYOUT_NC8HW8 : TENGINE_LAYOUT_NCHW;
+
+        if (ir_tensor->layout != expected)
+        {
+            fprintf(stderr, "nchwc: %s of layout %d, expected %d\n", tensor_names[i], ir_tensor->layout, expected);
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 41;
+
+    float* input_data[SHAPE_NUM];
+
+    for (int i = 0; i < SHAPE_NUM; i++)
+    {
+        int size = IN_C * shape_hw[i] * shape_hw[i];
+
+        input_data[i] = (float*)malloc(size * sizeof(float));
+        for (int j = 0; j < size; j++)
+            input_data[i][j] = test_cpu_random(&seed);
+    }
+
+    init_tengine();
+
+    setenv("TG_NO_NCHWC", "1", 1);
+    graph_t plain = create_test_graph(shape_hw[0]);
+    unsetenv("TG_NO_NCHWC");
+
+    graph_t blocked = create_test_graph(shape_hw[0]);
+
+    if (NULL == plain || NULL == blocked)
+    {
+        fprintf(stderr, "nchwc: prerun failed.\n");
+        return -1;
+    }
+
+    int ret = 0;
+
+    for (int i = 0; i < SHAPE_NUM; i++)
+    {
+        /* the layouts are set again on reshape, with TG_NO_NCHWC read at that time */
+        setenv("TG_NO_NCHWC", "1", 1);
+        int plain_ret = run_shape(plain, shape_hw[i], input_data[i]);
+        unsetenv("TG_NO_NCHWC");
+
+        if (plain_ret < 0 || run_shape(blocked, shape_hw[i], input_data[i]) < 0)
+        {
+            fprintf(stderr, "nchwc: run of size %d failed.\n", shape_hw[i]);
+            ret = -1;
+            break;
+        }
+
+        ret |= check_layouts(blocked);
+
+        for (int j = 0; j < OUTPUT_NUM; j++)
+        {
+            tensor_t expected = get_graph_tensor(plain, output_names[j]);
+            tensor_t output = get_graph_tensor(blocked, output_names[j]);
+            int size = get_tensor_buffer_size(expected) / sizeof(float);
+
+            char what[64];
+            snprintf(what, sizeof(what), "nchwc size %d %s", shape_hw[i], output_names[j]);
+
+            if (get_tensor_buffer_size(output) != get_tensor_buffer_size(expected))
+            {
+                fprintf(stderr, "%s: size mismatch.\n", what);
+                ret = -1;
+            }
+            else if (test_cpu_compare(what, (float*)get_tensor_buffer(output), (float*)get_tensor_buffer(expected), size, 1e-4f) > 0)
+            {
+                ret = -1;
+            }
+        }
+    }
+
+    postrun_graph(plain);
+    destroy_graph(plain);
+    postrun_graph(blocked);
+    destroy_graph(blocked);
+
+    release_tengine();
+
+    for (int i = 0; i < SHAPE_NUM; i++)
+        free(input_data[i]);
+
+    if (0 == ret)
+        fprintf(stderr, "test nchwc pass.\n");
+
+    return ret;
+}
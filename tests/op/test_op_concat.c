@@ -0,0 +1,335 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * concat along the channels of three convolutions, which the mem pool places in the slices of
+ * the output so that they write right into it: all the inputs placed, an input shared by two
+ * concats, a concat nested in another, and the placed inputs mixed with the graph input and a
+ * const copied over their slices. the batch of 2 is not along the outer dim and copies them all.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/concat_param.h"
+
+#define IN_C      4
+#define HW        6
+#define BRANCH    3
+#define CONST_C   2
+
+#define CASE_PLACED 0
+#define CASE_SHARED 1
+#define CASE_NESTED 2
+#define CASE_MIXED  3
+
+static const char* branch_names[BRANCH] = {"a", "b", "c"};
+static const int branch_channels[BRANCH] = {2, 3, 5};
+
+/* the input and the convolutions of the branches, of the same weights in every graph */
+static graph_t create_branches(int batch, float* input_data, tensor_t* branches)
+{
+    unsigned int seed = 5;
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[4] = {batch, IN_C, HW, HW};
+
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 4, input_data);
+
+    for (int i = 0; i < BRANCH; i++)
+    {
+        branches[i] = test_cpu_conv(graph, branch_names[i], input, IN_C, branch_channels[i], 3, 1, 1, -1, &seed);
+        if (NULL == branches[i])
+            return NULL;
+    }
+
+    return graph;
+}
+
+static tensor_t create_concat(graph_t graph, const char* name, tensor_t* inputs, int input_num)
+{
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    node_t node = test_cpu_node(graph, name, "Concat", inputs, input_num, fp32, 1);
+    if (NULL == node)
+        return NULL;
+
+    ((struct concat_param*)test_cpu_param(node))->axis = 1;
+
+    return get_graph_tensor(graph, name);
+}
+
+/* the parts of the channels of each batch one after another */
+static void ref_concat(float* output, float** parts, const int* channels, int part_num, int batch)
+{
+    for (int n = 0; n < batch; n++)
+    {
+        for (int i = 0; i < part_num; i++)
+        {
+            int size = channels[i] * HW * HW;
+
+            memcpy(output, parts[i] + n * size, size * sizeof(float));
+            output += size;
+        }
+    }
+}
+
+static int check_output(graph_t graph, const char* name, float** parts, const int* channels, int part_num, int batch)
+{
+    int size = 0;
+    for (int i = 0; i < part_num; i++)
+        size += batch * channels[i] * HW * HW;
+
+    tensor_t output = get_graph_tensor(graph, name);
+
+    if (get_tensor_buffer_size(output) != size * (int)sizeof(float))
+    {
+        fprintf(stderr, "%s: size %d, expected %d\n", name, get_tensor_buffer_size(output), size * (int)sizeof(float));
+        return -1;
+    }
+
+    float* expected = (float*)malloc(size * sizeof(float));
+    ref_concat(expected, parts, channels, part_num, batch);
+
+    int bad = test_cpu_compare(name, (float*)get_tensor_buffer(output), expected, size, 1e-5f);
+
+    free(expected);
+
+    return bad > 0 ? -1 : 0;
+}
+
+/* the input written right into the output at the channel */
+static int is_placed(graph_t graph, const char* input_name, const char* output_name, int channel)
+{
+    struct tensor* input = (struct tensor*)get_graph_tensor(graph, input_name);
+    struct tensor* output = (struct tensor*)get_graph_tensor(graph, output_name);
+
+    return input->data == (float*)output->data + channel * HW * HW;
+}
+
+static int test_concat(int test_case, int batch, float* input_data, float** branch_data, float* const_data)
+{
+    tensor_t branches[BRANCH];
+
+    graph_t graph = create_branches(batch, input_data, branches);
+    if (NULL == graph)
+        return -1;
+
+    const char* outputs[2];
+    int output_num = 1;
+
+    if (test_case == CASE_PLACED)
+    {
+        create_concat(graph, "out", branches, BRANCH);
+        outputs[0] = "out";
+    }
+    else if (test_case == CASE_SHARED)
+    {
+        tensor_t ab[2] = {branches[0], branches[1]};
+        tensor_t ac[2] = {branches[0], branches[2]};
+
+        create_concat(graph, "ab", ab, 2);
+        create_concat(graph, "ac", ac, 2);
+        outputs[0] = "ab";
+        outputs[1] = "ac";
+        output_num = 2;
+    }
+    else if (test_case == CASE_NESTED)
+    {
+        tensor_t inner[2] = {branches[0], branches[1]};
+        tensor_t outer[2];
+
+        outer[0] = create_concat(graph, "inner", inner, 2);
+        outer[1] = branches[2];
+        create_concat(graph, "out", outer, 2);
+        outputs[0] = "out";
+    }
+    else
+    {
+        int const_dims[4] = {1, CONST_C, HW, HW};
+        tensor_t mixed[3];
+
+        mixed[0] = get_graph_tensor(graph, "input");
+        mixed[1] = branches[0];
+        mixed[2] = test_cpu_const(graph, "const", TENGINE_DT_FP32, const_dims, 4, const_data);
+        create_concat(graph, "out", mixed, 3);
+        outputs[0] = "out";
+    }
+
+    const char* inputs[] = {"input"};
+
+    if (test_cpu_prerun(graph, inputs, 1, outputs, output_num, 1) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "concat case %d batch %d: run failed.\n", test_case, batch);
+        destroy_graph(graph);
+        return -1;
+    }
+
+    int ret = 0;
+    int a_c = branch_channels[0];
+    int b_c = branch_channels[1];
+
+    if (test_case == CASE_PLACED)
+    {
+        ret |= check_output(graph, "out", branch_data, branch_channels, BRANCH, batch);
+
+        if (batch == 1 && (!is_placed(graph, "a", "out", 0) || !is_placed(graph, "b", "out", a_c) || !is_placed(graph, "c", "out", a_c + b_c)))
+        {
+            fprintf(stderr, "concat: the branches are not placed in the output.\n");
+            ret = -1;
+        }
+    }
+    else if (test_case == CASE_SHARED)
+    {
+        float* ab[2] = {branch_data[0], branch_data[1]};
+        float* ac[2] = {branch_data[0], branch_data[2]};
+        int ab_c[2] = {a_c, b_c};
+        int ac_c[2] = {a_c, branch_channels[2]};
+
+        ret |= check_output(graph, "ab", ab, ab_c, 2, batch);
+        ret |= check_output(graph, "ac", ac, ac_c, 2, batch);
+
+        /* the shared input is placed in one of them at most, the other one copies it */
+        if (is_placed(graph, "a", "ab", 0) && is_placed(graph, "a", "ac", 0))
+        {
+            fprintf(stderr, "concat shared: the input is placed in both outputs.\n");
+            ret = -1;
+        }
+
+        if (!is_placed(graph, "b", "ab", a_c) || !is_placed(graph, "c", "ac", a_c))
+        {
+            fprintf(stderr, "concat shared: the inputs not shared are not placed.\n");
+            ret = -1;
+        }
+    }
+    else if (test_case == CASE_NESTED)
+    {
+        ret |= check_output(graph, "out", branch_data, branch_channels, BRANCH, batch);
+
+        if (!is_placed(graph, "inner", "out", 0) || !is_placed(graph, "a", "out", 0) || !is_placed(graph, "b", "out", a_c)
+            || !is_placed(graph, "c", "out", a_c + b_c))
+        {
+            fprintf(stderr, "concat nested: the inputs are not placed in the outer output.\n");
+            ret = -1;
+        }
+    }
+    else
+    {
+        float* mixed[3] = {input_data, branch_data[0], const_data};
+        int mixed_c[3] = {IN_C, a_c, CONST_C};
+
+        ret |= check_output(graph, "out", mixed, mixed_c, 3, batch);
+
+        if (!is_placed(graph, "a", "out", IN_C) || is_placed(graph, "input", "out", 0))
+        {
+            fprintf(stderr, "concat mixed: only the branch is placed in the output.\n");
+            ret = -1;
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return ret;
+}
+
+/* the branches of the batch computed alone */
+static int run_branches(int batch, float* input_data, float** branch_data)
+{
+    tensor_t branches[BRANCH];
+
+    graph_t graph = create_branches(batch, input_data, branches);
+    if (NULL == graph)
+        return -1;
+
+    const char* inputs[] = {"input"};
+
+    if (test_cpu_prerun(graph, inputs, 1, branch_names, BRANCH, 1) < 0 || run_graph(graph, 1) < 0)
+    {
+        destroy_graph(graph);
+        return -1;
+    }
+
+    for (int i = 0; i < BRANCH; i++)
+    {
+        int size = get_tensor_buffer_size(branches[i]);
+
+        branch_data[i] = (float*)malloc(size);
+        memcpy(branch_data[i], get_tensor_buffer(branches[i]), size);
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 3;
+
+    float input_data[2 * IN_C * HW * HW];
+    float const_data[CONST_C * HW * HW];
+
+    for (int i = 0; i < 2 * IN_C * HW * HW; i++)
+        input_data[i] = test_cpu_random(&seed);
+
+    for (int i = 0; i < CONST_C * HW * HW; i++)
+        const_data[i] = test_cpu_random(&seed);
+
+    init_tengine();
+
+    int ret = 0;
+
+    for (int batch = 1; batch <= 2; batch++)
+    {
+        float* branch_data[BRANCH];
+
+        if (run_branches(batch, input_data, branch_data) < 0)
+        {
+            fprintf(stderr, "concat: the branches of batch %d failed.\n", batch);
+            return -1;
+        }
+
+        ret |= test_concat(CASE_PLACED, batch, input_data, branch_data, const_data);
+
+        if (batch == 1)
+        {
+            ret |= test_concat(CASE_SHARED, batch, input_data, branch_data, const_data);
+            ret |= test_concat(CASE_NESTED, batch, input_data, branch_data, const_data);
+            ret |= test_concat(CASE_MIXED, batch, input_data, branch_data, const_data);
+        }
+
+        for (int i = 0; i < BRANCH; i++)
+            free(branch_data[i]);
+    }
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test concat pass.\n");
+
+    return ret;
+}
@@ -0,0 +1,215 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * eltwise with broadcast inputs: the output of the inputs both broadcast, such as [2, 1, 5, 1]
+ * and [1, 16, 1, 7], is computed right by the optimized op or the run fails, and the ref op,
+ * which broadcasts one input only, rejects it. the broadcasts of one input are checked too.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/eltwise_param.h"
+
+/* run input0 op input1 in a graph of its own, the output of the run is copied, -1 for a failed run */
+static int run_eltwise(int type, const int* dims0, const int* dims1, const float* data0, const float* data1,
+                       float* output_data, int output_size)
+{
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    int fp32[1] = {TENGINE_DT_FP32};
+    tensor_t inputs[2];
+    inputs[0] = test_cpu_input(graph, "input0", TENGINE_DT_FP32, dims0, 4, (void*)data0);
+    inputs[1] = test_cpu_input(graph, "input1", TENGINE_DT_FP32, dims1, 4, (void*)data1);
+
+    node_t node = test_cpu_node(graph, "eltwise", "Eltwise", inputs, 2, fp32, 1);
+    ((struct eltwise_param*)test_cpu_param(node))->type = type;
+
+    const char* input_names[] = {"input0", "input1"};
+    const char* output_names[] = {"eltwise"};
+
+    int ret = -1;
+
+    if (test_cpu_prerun(graph, input_names, 2, output_names, 1, 1) == 0 && run_graph(graph, 1) == 0)
+    {
+        tensor_t output = get_graph_output_tensor(graph, 0, 0);
+
+        if (get_tensor_buffer_size(output) == output_size * (int)sizeof(float))
+        {
+            memcpy(output_data, get_tensor_buffer(output), output_size * sizeof(float));
+            ret = 0;
+        }
+        else
+        {
+            fprintf(stderr, "eltwise output size %d, expected %d\n", get_tensor_buffer_size(output),
+                    output_size * (int)sizeof(float));
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return ret;
+}
+
+/* numpy broadcast of the inputs of 4 dims */
+static void ref_eltwise(int type, const int* dims0, const int* dims1, const float* data0, const float* data1,
+                        const int* dims, float* output)
+{
+    int index = 0;
+
+    for (int n = 0; n < dims[0]; n++)
+        for (int c = 0; c < dims[1]; c++)
+            for (int h = 0; h < dims[2]; h++)
+                for (int w = 0; w < dims[3]; w++)
+                {
+                    int pos[4] = {n, c, h, w};
+                    int i0 = 0, i1 = 0;
+
+                    for (int d = 0; d < 4; d++)
+                    {
+                        i0 = i0 * dims0[d] + (dims0[d] == 1 ? 0 : pos[d]);
+                        i1 = i1 * dims1[d] + (dims1[d] == 1 ? 0 : pos[d]);
+                    }
+
+                    if (type == ELT_SUM)
+                        output[index++] = data0[i0] + data1[i1];
+                    else if (type == ELT_SUB)
+                        output[index++] = data0[i0] - data1[i1];
+                    else
+                        output[index++] = data0[i0] * data1[i1];
+                }
+}
+
+#define RUN_PASS   0
+#define RUN_FAIL   1
+#define RUN_EITHER 2
+
+/* the case with the op selected, a run of it expected to pass, to fail, or either with the right output */
+static int test_eltwise(const char* what, int type, const int* dims0, const int* dims1, int expect)
+{
+    unsigned int seed = 3;
+
+    int dims[4];
+    int size0 = 1, size1 = 1, size = 1;
+    for (int i = 0; i < 4; i++)
+    {
+        dims[i] = dims0[i] > dims1[i] ? dims0[i] : dims1[i];
+        size0 *= dims0[i];
+        size1 *= dims1[i];
+        size *= dims[i];
+    }
+
+    float* data0 = (float*)malloc(size0 * sizeof(float));
+    float* data1 = (float*)malloc(size1 * sizeof(float));
+    float* expected = (float*)malloc(size * sizeof(float));
+    float* output = (float*)malloc(size * sizeof(float));
+
+    for (int i = 0; i < size0; i++)
+        data0[i] = test_cpu_random(&seed);
+    for (int i = 0; i < size1; i++)
+        data1[i] = test_cpu_random(&seed);
+
+    ref_eltwise(type, dims0, dims1, data0, data1, dims, expected);
+
+    int ret = 0;
+
+    if (run_eltwise(type, dims0, dims1, data0, data1, output, size) < 0)
+    {
+        if (RUN_PASS == expect)
+        {
+            fprintf(stderr, "%s: run failed.\n", what);
+            ret = -1;
+        }
+    }
+    else if (RUN_FAIL == expect)
+    {
+        fprintf(stderr, "%s: run did not fail.\n", what);
+        ret = -1;
+    }
+    else if (test_cpu_compare(what, output, expected, size, 1e-6f) > 0)
+    {
+        ret = -1;
+    }
+
+    free(data0);
+    free(data1);
+    free(expected);
+    free(output);
+
+    return ret;
+}
+
+/* the cases of one input broadcast, both ops support them */
+static int test_one_side(const char* ops)
+{
+    int nchw[4] = {2, 3, 4, 5};
+    int chw[4] = {1, 3, 4, 5};
+    int chan[4] = {1, 3, 1, 1};
+    int scalar[4] = {1, 1, 1, 1};
+
+    char what[64];
+    int ret = 0;
+
+    snprintf(what, sizeof(what), "%s sum same shape", ops);
+    ret |= test_eltwise(what, ELT_SUM, nchw, nchw, RUN_PASS);
+
+    snprintf(what, sizeof(what), "%s sum per channel", ops);
+    ret |= test_eltwise(what, ELT_SUM, chw, chan, RUN_PASS);
+
+    snprintf(what, sizeof(what), "%s prod scalar", ops);
+    ret |= test_eltwise(what, ELT_PROD, nchw, scalar, RUN_PASS);
+
+    snprintf(what, sizeof(what), "%s sub scalar", ops);
+    ret |= test_eltwise(what, ELT_SUB, nchw, scalar, RUN_PASS);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    int dims0[4] = {2, 1, 5, 1};
+    int dims1[4] = {1, 16, 1, 7};
+
+    init_tengine();
+
+    int ret = 0;
+
+    /* the optimized op computes both inputs broadcast, or it is the ref op on the arch and fails */
+    ret |= test_one_side("opt");
+    ret |= test_eltwise("opt sum both broadcast", ELT_SUM, dims0, dims1, RUN_EITHER);
+
+    /* the op implementations are selected in prerun */
+    setenv("TG_DEBUG_REF", "1", 1);
+
+    ret |= test_one_side("ref");
+    ret |= test_eltwise("ref sum both broadcast", ELT_SUM, dims0, dims1, RUN_FAIL);
+    ret |= test_eltwise("ref prod both broadcast", ELT_PROD, dims0, dims1, RUN_FAIL);
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test eltwise pass.\n");
+
+    return ret;
+}
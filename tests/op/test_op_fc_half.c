@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * fc and matmul of their const weights kept in fp16 or bf16, run in the fp16 and bf16 modes and
+ * compared to the fp32 mode within the rounding of the weights: the fc of a 2d input and of a 4d
+ * one flattened to the hidden size, the batch changed after prerun on the packed weights, and
+ * the matmul of a const input1 broadcast over the batch of input0 or of the same batch. the
+ * hidden size is not a multiple of the vector lanes. on x86 the outputs of the half weights have
+ * to differ from the fp32 ones, or the half kernels are not run.
+ */
+
+#include "test_cpu_graph.h"
+
+#define HIDDEN   259
+#define OUT_NUM  37
+#define MAX_ROWS 10
+
+#define CASE_FC        0
+#define CASE_FC_4D     1
+#define CASE_MATMUL    2
+#define CASE_MATMUL_3D 3
+#define CASE_NUM       4
+
+static const char* case_names[CASE_NUM] = {"fc", "fc 4d", "matmul", "matmul batched"};
+
+/* the rows of the input, the batch of the fc is changed from 3 to 1 after prerun */
+#define SHAPE_NUM 2
+static const int fc_batch[SHAPE_NUM] = {3, 1};
+
+#define MATMUL_BATCH 2
+#define MATMUL_M     5
+
+/* the error of the rounded weights, bf16 keeps 8 bits of mantissa and rounds the inputs on avx512-bf16 */
+#define FP16_EPS 2e-3f
+#define BF16_EPS 2e-2f
+
+static float input_data[MAX_ROWS * HIDDEN];
+
+static tensor_t create_fc(graph_t graph, tensor_t input, unsigned int* seed)
+{
+    int fp32[1] = {TENGINE_DT_FP32};
+    int weight_dims[2] = {OUT_NUM, HIDDEN};
+    int bias_dims[1] = {OUT_NUM};
+
+    tensor_t inputs[3];
+    inputs[0] = input;
+    inputs[1] = test_cpu_random_const(graph, "weight", weight_dims, 2, 1.f / sqrtf((float)HIDDEN), seed);
+    inputs[2] = test_cpu_random_const(graph, "bias", bias_dims, 1, 0.1f, seed);
+
+    node_t node = test_cpu_node(graph, "out", "FullyConnected", inputs, 3, fp32, 1);
+
+    if (NULL == inputs[1] || NULL == inputs[2] || NULL == node)
+        return NULL;
+
+    ((struct fc_param*)test_cpu_param(node))->num_output = OUT_NUM;
+
+    return get_graph_tensor(graph, "out");
+}
+
+static tensor_t create_matmul(graph_t graph, tensor_t input, int batched, unsigned int* seed)
+{
+    int fp32[1] = {TENGINE_DT_FP32};
+    int input1_dims[3] = {MATMUL_BATCH, HIDDEN, OUT_NUM};
+
+    tensor_t inputs[2];
+    inputs[0] = input;
+    inputs[1] = batched ? test_cpu_random_const(graph, "input1", input1_dims, 3, 1.f / sqrtf((float)HIDDEN), seed)
+                        : test_cpu_random_const(graph, "input1", input1_dims + 1, 2, 1.f / sqrtf((float)HIDDEN), seed);
+
+    if (NULL == inputs[1] || NULL == test_cpu_node(graph, "out", "Matmul", inputs, 2, fp32, 1))
+        return NULL;
+
+    return get_graph_tensor(graph, "out");
+}
+
+static int get_input_dims(int test_case, int shape, int* dims)
+{
+    if (test_case == CASE_FC)
+    {
+        dims[0] = fc_batch[shape];
+        dims[1] = HIDDEN;
+        return 2;
+    }
+
+    /* the hidden size of 7 x 37 */
+    if (test_case == CASE_FC_4D)
+    {
+        dims[0] = fc_batch[shape];
+        dims[1] = 7;
+        dims[2] = HIDDEN / 7;
+        dims[3] = 1;
+        return 4;
+    }
+
+    dims[0] = MATMUL_BATCH;
+    dims[1] = MATMUL_M;
+    dims[2] = HIDDEN;
+    return 3;
+}
+
+static int get_shape_num(int test_case)
+{
+    return test_case == CASE_FC || test_case == CASE_FC_4D ? SHAPE_NUM : 1;
+}
+
+/* the graph of the case prerun in the precision, the weights are the same in every precision */
+static graph_t create_test_graph(int test_case, int precision)
+{
+    unsigned int seed = 43;
+    int dims[4];
+    int dim_num = get_input_dims(test_case, 0, dims);
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, dims, dim_num, NULL);
+    tensor_t output;
+
+    if (test_case == CASE_FC || test_case == CASE_FC_4D)
+        output = create_fc(graph, input, &seed);
+    else
+        output = create_matmul(graph, input, test_case == CASE_MATMUL_3D, &seed);
+
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"out"};
+
+    if (NULL == output || test_cpu_prerun_mode(graph, inputs, 1, outputs, 1, 1, precision) < 0)
+        return NULL;
+
+    return graph;
+}
+
+static int run_shape(graph_t graph, int test_case, int shape)
+{
+    int dims[4];
+    int dim_num = get_input_dims(test_case, shape, dims);
+    int size = 1;
+
+    for (int i = 0; i < dim_num; i++)
+        size *= dims[i];
+
+    tensor_t input = get_graph_input_tensor(graph, 0, 0);
+
+    if (set_tensor_shape(input, dims, dim_num) < 0 || set_tensor_buffer(input, input_data, size * sizeof(float)) < 0)
+        return -1;
+
+    return run_graph(graph, 1);
+}
+
+static int test_case_mode(int test_case, int precision, const char* mode_name, float eps)
+{
+    graph_t expected_graph = create_test_graph(test_case, TENGINE_MODE_FP32);
+    graph_t graph = create_test_graph(test_case, precision);
+
+    if (NULL == expected_graph || NULL == graph)
+    {
+        fprintf(stderr, "%s %s: prerun failed.\n", case_names[test_case], mode_name);
+        return -1;
+    }
+
+    int ret = 0;
+
+    for (int shape = 0; shape < get_shape_num(test_case); shape++)
+    {
+        if (run_shape(expected_graph, test_case, shape) < 0 || run_shape(graph, test_case, shape) < 0)
+        {
+            fprintf(stderr, "%s %s: run failed.\n", case_names[test_case], mode_name);
+            ret = -1;
+            break;
+        }
+
+        tensor_t expected = get_graph_tensor(expected_graph, "out");
+        tensor_t output = get_graph_tensor(graph, "out");
+        int size = get_tensor_buffer_size(expected) / sizeof(float);
+        float* expected_data = (float*)get_tensor_buffer(expected);
+        float* output_data = (float*)get_tensor_buffer(output);
+
+        char what[64];
+        snprintf(what, sizeof(what), "%s %s shape %d", case_names[test_case], mode_name, shape);
+
+        if (get_tensor_buffer_size(output) != get_tensor_buffer_size(expected))
+        {
+            fprintf(stderr, "%s: size mismatch.\n", what);
+            ret = -1;
+            continue;
+        }
+
+        if (test_cpu_compare(what, output_data, expected_data, size, eps) > 0)
+            ret = -1;
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+        int rounded = 0;
+        for (int i = 0; i < size; i++)
+            rounded |= output_data[i] != expected_data[i];
+
+        if (!rounded)
+        {
+            fprintf(stderr, "%s: the outputs are the ones of the fp32 weights.\n", what);
+            ret = -1;
+        }
+#endif
+    }
+
+    postrun_graph(expected_graph);
+    destroy_graph(expected_graph);
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 47;
+
+    for (int i = 0; i < MAX_ROWS * HIDDEN; i++)
+        input_data[i] = test_cpu_random(&seed);
+
+    init_tengine();
+
+    int ret = 0;
+
+    for (int test_case = 0; test_case < CASE_NUM; test_case++)
+    {
+        ret |= test_case_mode(test_case, TENGINE_MODE_FP16, "fp16", FP16_EPS);
+        ret |= test_case_mode(test_case, TENGINE_MODE_BF16, "bf16", BF16_EPS);
+    }
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test fc half pass.\n");
+
+    return ret;
+}
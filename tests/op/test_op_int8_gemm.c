@@ -0,0 +1,346 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * the int8 conv and fc of the int8 sgemm of x86, compared bit by bit to the ref ops run with
+ * TG_DEBUG_REF=1: the 1x1 conv reading its input as is, the convs of im2col with the activations,
+ * and the fc of a batch of 1 and of more rows, none of the sizes a multiple of the tiles. the
+ * values are random over the whole int8 range, then only +-127, whose pairs of products are the
+ * largest the int16 of vpmaddubsw takes, then -128 on both sides too, which the avx2 kernel leaves
+ * to the c tile. the kernel is the one of the cpu, the ctest runs of TG_CPU_ISA_MASK pick the others.
+ */
+
+#include "test_cpu_graph.h"
+
+#define DATA_RANDOM  0
+#define DATA_EXTREME 1
+#define DATA_MIN     2
+#define DATA_NUM     3
+
+static const char* data_names[DATA_NUM] = {"random", "+-127", "-128"};
+
+struct conv_case
+{
+    int in_c;
+    int out_c;
+    int hw;
+    int kernel;
+    int stride;
+    int pad;
+    int activation;
+};
+
+/* the 3x3 of stride 1 and 2 run on the direct int8 conv, the one here is of stride 3 */
+#define CONV_CASE_NUM 4
+static const struct conv_case conv_cases[CONV_CASE_NUM] = {
+    {13, 19, 7, 1, 1, 0, -1},
+    {6, 17, 9, 5, 1, 2, 0},
+    {33, 8, 10, 1, 2, 0, 6},
+    {5, 41, 11, 3, 3, 1, 1},
+};
+
+struct fc_case
+{
+    int batch;
+    int hidden;
+    int out_num;
+};
+
+#define FC_CASE_NUM 3
+static const struct fc_case fc_cases[FC_CASE_NUM] = {
+    {1, 37, 45},
+    {3, 259, 33},
+    {10, 64, 70},
+};
+
+#define INPUT_SCALE 0.05f
+
+static void fill_data(int8_t* data, int size, int data_set, unsigned int* seed)
+{
+    for (int i = 0; i < size; i++)
+    {
+        float r = test_cpu_random(seed);
+
+        if (data_set == DATA_RANDOM)
+            data[i] = (int8_t)(int)floorf(r * 128.f);
+        else if (data_set == DATA_EXTREME)
+            data[i] = r < 0.f ? -127 : 127;
+        else
+            data[i] = r < -0.3f ? -128 : r < 0.3f ? 127 : -127;
+    }
+}
+
+/* the weights of scales per channel, and the output scale of the sums of k random products about the middle of the range */
+static int set_quant(tensor_t input, tensor_t weight, tensor_t output, int channel, int k, unsigned int* seed)
+{
+    float* scales = (float*)malloc(channel * sizeof(float));
+    int* zero_points = (int*)calloc(channel, sizeof(int));
+    float input_scale = INPUT_SCALE;
+    float output_scale = INPUT_SCALE * 0.002f * sqrtf((float)k) * 64.f;
+    int zero_point = 0;
+
+    for (int i = 0; i < channel; i++)
+        scales[i] = 0.002f * (1.5f + test_cpu_random(seed));
+
+    int ret = set_tensor_quant_param(input, &input_scale, &zero_point, 1) < 0
+              || set_tensor_quant_param(weight, scales, zero_points, channel) < 0
+              || set_tensor_quant_param(output, &output_scale, &zero_point, 1) < 0
+                  ? -1
+                  : 0;
+
+    free(scales);
+    free(zero_points);
+
+    return ret;
+}
+
+static tensor_t create_consts(graph_t graph, int data_set, int channel, int k, int8_t* weight_data, int32_t* bias_data,
+                              const int* weight_dims, int weight_dim_num, tensor_t* inputs, unsigned int* seed)
+{
+    fill_data(weight_data, channel * k, data_set, seed);
+
+    for (int i = 0; i < channel; i++)
+        bias_data[i] = (int32_t)(20000.f * test_cpu_random(seed));
+
+    inputs[1] = test_cpu_const(graph, "weight", TENGINE_DT_INT8, weight_dims, weight_dim_num, weight_data);
+    inputs[2] = test_cpu_const(graph, "bias", TENGINE_DT_INT32, &channel, 1, bias_data);
+
+    return inputs[1] != NULL && inputs[2] != NULL ? inputs[1] : NULL;
+}
+
+/* the graph of the conv case, the consts are in the buffers given, the same for the ref graph */
+static graph_t create_conv_graph(const struct conv_case* c, int data_set, int8_t* weight_data, int32_t* bias_data)
+{
+    unsigned int seed = 61 + data_set;
+    int int8[1] = {TENGINE_DT_INT8};
+    int k = c->in_c * c->kernel * c->kernel;
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[4] = {1, c->in_c, c->hw, c->hw};
+    int weight_dims[4] = {c->out_c, c->in_c, c->kernel, c->kernel};
+
+    tensor_t inputs[3];
+    inputs[0] = test_cpu_input(graph, "input", TENGINE_DT_INT8, input_dims, 4, NULL);
+
+    if (NULL == inputs[0] || NULL == create_consts(graph, data_set, c->out_c, k, weight_data, bias_data, weight_dims, 4, inputs, &seed))
+        return NULL;
+
+    node_t node = test_cpu_node(graph, "out", "Convolution", inputs, 3, int8, 1);
+    if (NULL == node || set_quant(inputs[0], inputs[1], get_graph_tensor(graph, "out"), c->out_c, k, &seed) < 0)
+        return NULL;
+
+    struct conv_param* param = (struct conv_param*)test_cpu_param(node);
+    param->kernel_h = c->kernel;
+    param->kernel_w = c->kernel;
+    param->stride_h = c->stride;
+    param->stride_w = c->stride;
+    param->pad_h0 = c->pad;
+    param->pad_h1 = c->pad;
+    param->pad_w0 = c->pad;
+    param->pad_w1 = c->pad;
+    param->dilation_h = 1;
+    param->dilation_w = 1;
+    param->input_channel = c->in_c;
+    param->output_channel = c->out_c;
+    param->group = 1;
+    param->activation = c->activation;
+
+    const char* input_names[] = {"input"};
+    const char* output_names[] = {"out"};
+
+    if (test_cpu_prerun_mode(graph, input_names, 1, output_names, 1, 1, TENGINE_MODE_INT8) < 0)
+        return NULL;
+
+    return graph;
+}
+
+static graph_t create_fc_graph(const struct fc_case* c, int data_set, int8_t* weight_data, int32_t* bias_data)
+{
+    unsigned int seed = 67 + data_set;
+    int int8[1] = {TENGINE_DT_INT8};
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[2] = {c->batch, c->hidden};
+    int weight_dims[2] = {c->out_num, c->hidden};
+
+    tensor_t inputs[3];
+    inputs[0] = test_cpu_input(graph, "input", TENGINE_DT_INT8, input_dims, 2, NULL);
+
+    if (NULL == inputs[0] || NULL == create_consts(graph, data_set, c->out_num, c->hidden, weight_data, bias_data, weight_dims, 2, inputs, &seed))
+        return NULL;
+
+    node_t node = test_cpu_node(graph, "out", "FullyConnected", inputs, 3, int8, 1);
+    if (NULL == node || set_quant(inputs[0], inputs[1], get_graph_tensor(graph, "out"), c->out_num, c->hidden, &seed) < 0)
+        return NULL;
+
+    ((struct fc_param*)test_cpu_param(node))->num_output = c->out_num;
+
+    const char* input_names[] = {"input"};
+    const char* output_names[] = {"out"};
+
+    if (test_cpu_prerun_mode(graph, input_names, 1, output_names, 1, 1, TENGINE_MODE_INT8) < 0)
+        return NULL;
+
+    return graph;
+}
+
+static int run_input(graph_t graph, int8_t* input_data, int size)
+{
+    tensor_t input = get_graph_input_tensor(graph, 0, 0);
+
+    if (set_tensor_buffer(input, input_data, size) < 0)
+        return -1;
+
+    return run_graph(graph, 1);
+}
+
+/* the outputs of the graph and of the ref graph on the same input are the same */
+static int compare_graphs(const char* what, graph_t graph, graph_t ref_graph, int input_size, int data_set)
+{
+    unsigned int seed = 71 + data_set;
+    int8_t* input_data = (int8_t*)malloc(input_size);
+
+    fill_data(input_data, input_size, data_set, &seed);
+
+    if (NULL == graph || NULL == ref_graph || run_input(graph, input_data, input_size) < 0
+            || run_input(ref_graph, input_data, input_size) < 0)
+    {
+        fprintf(stderr, "%s: prerun or run failed.\n", what);
+        free(input_data);
+        return -1;
+    }
+
+    tensor_t output = get_graph_tensor(graph, "out");
+    tensor_t expected = get_graph_tensor(ref_graph, "out");
+    const int8_t* output_data = (const int8_t*)get_tensor_buffer(output);
+    const int8_t* expected_data = (const int8_t*)get_tensor_buffer(expected);
+    int size = get_tensor_buffer_size(expected);
+    int bad = 0;
+
+    if (get_tensor_buffer_size(output) != size)
+    {
+        fprintf(stderr, "%s: size %d, expected %d\n", what, get_tensor_buffer_size(output), size);
+        bad = 1;
+    }
+
+    for (int i = 0; i < size && !bad; i++)
+    {
+        if (output_data[i] != expected_data[i])
+        {
+            fprintf(stderr, "%s: [%d] %d, expected %d\n", what, i, output_data[i], expected_data[i]);
+            bad = 1;
+        }
+    }
+
+    free(input_data);
+
+    return bad ? -1 : 0;
+}
+
+static int test_conv(const struct conv_case* c, int data_set)
+{
+    int k = c->in_c * c->kernel * c->kernel;
+    int8_t* weight_data = (int8_t*)malloc(c->out_c * k);
+    int32_t* bias_data = (int32_t*)malloc(c->out_c * sizeof(int32_t));
+
+    graph_t graph = create_conv_graph(c, data_set, weight_data, bias_data);
+
+    setenv("TG_DEBUG_REF", "1", 1);
+    graph_t ref_graph = create_conv_graph(c, data_set, weight_data, bias_data);
+    unsetenv("TG_DEBUG_REF");
+
+    char what[96];
+    snprintf(what, sizeof(what), "conv %d->%d %dx%d s%d act %d %s", c->in_c, c->out_c, c->kernel, c->kernel, c->stride,
+             c->activation, data_names[data_set]);
+
+    int ret = compare_graphs(what, graph, ref_graph, c->in_c * c->hw * c->hw, data_set);
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+    postrun_graph(ref_graph);
+    destroy_graph(ref_graph);
+
+    free(weight_data);
+    free(bias_data);
+
+    return ret;
+}
+
+static int test_fc(const struct fc_case* c, int data_set)
+{
+    int8_t* weight_data = (int8_t*)malloc(c->out_num * c->hidden);
+    int32_t* bias_data = (int32_t*)malloc(c->out_num * sizeof(int32_t));
+
+    graph_t graph = create_fc_graph(c, data_set, weight_data, bias_data);
+
+    setenv("TG_DEBUG_REF", "1", 1);
+    graph_t ref_graph = create_fc_graph(c, data_set, weight_data, bias_data);
+    unsetenv("TG_DEBUG_REF");
+
+    char what[96];
+    snprintf(what, sizeof(what), "fc %d x %d->%d %s", c->batch, c->hidden, c->out_num, data_names[data_set]);
+
+    int ret = compare_graphs(what, graph, ref_graph, c->batch * c->hidden, data_set);
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+    postrun_graph(ref_graph);
+    destroy_graph(ref_graph);
+
+    free(weight_data);
+    free(bias_data);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* mask = getenv("TG_CPU_ISA_MASK");
+
+    fprintf(stderr, "int8 gemm: isa mask %s\n", mask ? mask : "none");
+
+    init_tengine();
+
+    int ret = 0;
+
+    for (int data_set = 0; data_set < DATA_NUM; data_set++)
+    {
+        for (int i = 0; i < CONV_CASE_NUM; i++)
+            ret |= test_conv(&conv_cases[i], data_set);
+        for (int i = 0; i < FC_CASE_NUM; i++)
+            ret |= test_fc(&fc_cases[i], data_set);
+    }
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test int8 gemm pass.\n");
+
+    return ret;
+}
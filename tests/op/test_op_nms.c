@@ -0,0 +1,475 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * the nms shared by detection_output and detection_postprocess, run through the ops and
+ * compared to a greedy nms box by box. the box offsets are 0, so the boxes decoded are the
+ * priors and the anchors exactly. detection_postprocess has enough boxes for the nms of the
+ * iou bitmasks with threads. the inputs are left unchanged.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/detection_output_param.h"
+#include "operator/prototype/detection_postprocess_param.h"
+
+#define DPP_SCORE_THRESHOLD 0.6f
+
+struct test_box
+{
+    float x0, y0, x1, y1;
+    float score;
+    int label;
+    int order;
+};
+
+/* the better box first, the larger score, or the smaller order of the same score */
+static int compare_box(const void* a, const void* b)
+{
+    const struct test_box* x = (const struct test_box*)a;
+    const struct test_box* y = (const struct test_box*)b;
+
+    if (x->score != y->score)
+        return x->score > y->score ? -1 : 1;
+
+    return x->order - y->order;
+}
+
+static float box_iou(const struct test_box* a, const struct test_box* b)
+{
+    float w = fminf(a->x1, b->x1) - fmaxf(a->x0, b->x0);
+    float h = fminf(a->y1, b->y1) - fmaxf(a->y0, b->y0);
+
+    if (w <= 0.f || h <= 0.f)
+        return 0.f;
+
+    float inter = w * h;
+    float area_a = (a->x1 - a->x0) * (a->y1 - a->y0);
+    float area_b = (b->x1 - b->x0) * (b->y1 - b->y0);
+
+    return inter / (area_a + area_b - inter);
+}
+
+/* the boxes sorted, the top best of them are kept greedily in place, return the count kept */
+static int ref_nms(struct test_box* boxes, int n, int top, float iou_threshold)
+{
+    qsort(boxes, n, sizeof(struct test_box), compare_box);
+
+    if (top < n)
+        n = top;
+
+    int kept = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int dropped = 0;
+        for (int j = 0; j < kept && !dropped; j++)
+            dropped = box_iou(&boxes[i], &boxes[j]) > iou_threshold;
+
+        if (!dropped)
+            boxes[kept++] = boxes[i];
+    }
+
+    return kept;
+}
+
+/* a box on a grid of 1 / 64 inside [0, 1], so its center and size are exact */
+static void random_box(unsigned int* seed, float* x0, float* y0, float* x1, float* y1)
+{
+    int cx = 8 + (int)((test_cpu_random(seed) + 1.f) * 24.f);
+    int cy = 8 + (int)((test_cpu_random(seed) + 1.f) * 24.f);
+    int hw = 1 + (int)((test_cpu_random(seed) + 1.f) * 3.5f);
+    int hh = 1 + (int)((test_cpu_random(seed) + 1.f) * 3.5f);
+
+    *x0 = (cx - hw) / 64.f;
+    *y0 = (cy - hh) / 64.f;
+    *x1 = (cx + hw) / 64.f;
+    *y1 = (cy + hh) / 64.f;
+}
+
+/* a score of a few levels, the same scores of different boxes are ordered by their index */
+static float random_score(unsigned int* seed)
+{
+    return (int)((test_cpu_random(seed) + 1.f) * 32.f) / 64.f;
+}
+
+static int compare_detections(const char* what, const struct test_box* boxes, const struct test_box* expected, int num)
+{
+    int bad = 0;
+
+    for (int i = 0; i < num; i++)
+    {
+        const struct test_box* a = boxes + i;
+        const struct test_box* b = expected + i;
+
+        if (a->label == b->label && a->score == b->score && a->x0 == b->x0 && a->y0 == b->y0 && a->x1 == b->x1
+            && a->y1 == b->y1)
+            continue;
+
+        if (bad < 4)
+            fprintf(stderr, "%s: [%d] %d %f (%f %f %f %f), expected %d %f (%f %f %f %f)\n", what, i, a->label,
+                    a->score, a->x0, a->y0, a->x1, a->y1, b->label, b->score, b->x0, b->y0, b->x1, b->y1);
+        bad++;
+    }
+
+    return bad > 0 ? -1 : 0;
+}
+
+/* the kept boxes of the classes in order, the keep best of them sorted, return the count */
+static int ref_detections(struct test_box* priors, const float* conf, int num_prior, int num_classes, float threshold,
+                          int inclusive, int class_top, float iou_threshold, int keep, struct test_box* output)
+{
+    struct test_box* boxes = (struct test_box*)malloc(num_prior * sizeof(struct test_box));
+    int total = 0;
+
+    for (int c = 1; c < num_classes; c++)
+    {
+        int n = 0;
+        for (int i = 0; i < num_prior; i++)
+        {
+            float score = conf[i * num_classes + c];
+            if (score > threshold || (inclusive && score == threshold))
+            {
+                boxes[n] = priors[i];
+                boxes[n].score = score;
+                boxes[n].label = c;
+                boxes[n].order = i;
+                n++;
+            }
+        }
+
+        int kept = ref_nms(boxes, n, class_top, iou_threshold);
+
+        for (int i = 0; i < kept; i++)
+        {
+            output[total] = boxes[i];
+            output[total].order = total;
+            total++;
+        }
+    }
+
+    free(boxes);
+
+    qsort(output, total, sizeof(struct test_box), compare_box);
+
+    return total < keep ? total : keep;
+}
+
+static int test_detection_output(int num_prior, int num_classes, int nms_top_k, int keep_top_k, int num_thread)
+{
+    unsigned int seed = 29 + num_prior;
+
+    int loc_size = num_prior * 4;
+    int conf_size = num_prior * num_classes;
+
+    float* loc = (float*)calloc(loc_size, sizeof(float));
+    float* conf = (float*)malloc(conf_size * sizeof(float));
+    float* prior = (float*)malloc(2 * loc_size * sizeof(float));
+    struct test_box* priors = (struct test_box*)malloc(num_prior * sizeof(struct test_box));
+    struct test_box* expected = (struct test_box*)malloc(num_prior * num_classes * sizeof(struct test_box));
+
+    for (int i = 0; i < num_prior; i++)
+    {
+        random_box(&seed, &priors[i].x0, &priors[i].y0, &priors[i].x1, &priors[i].y1);
+
+        prior[i * 4] = priors[i].x0;
+        prior[i * 4 + 1] = priors[i].y0;
+        prior[i * 4 + 2] = priors[i].x1;
+        prior[i * 4 + 3] = priors[i].y1;
+
+        /* the variances */
+        prior[loc_size + i * 4] = 0.1f;
+        prior[loc_size + i * 4 + 1] = 0.1f;
+        prior[loc_size + i * 4 + 2] = 0.2f;
+        prior[loc_size + i * 4 + 3] = 0.2f;
+    }
+
+    for (int i = 0; i < conf_size; i++)
+        conf[i] = random_score(&seed);
+
+    float* conf_copy = (float*)malloc(conf_size * sizeof(float));
+    float* prior_copy = (float*)malloc(2 * loc_size * sizeof(float));
+    memcpy(conf_copy, conf, conf_size * sizeof(float));
+    memcpy(prior_copy, prior, 2 * loc_size * sizeof(float));
+
+    float confidence_threshold = 0.3f;
+    float nms_threshold = 0.45f;
+    int class_top = nms_top_k > 0 ? nms_top_k : num_prior;
+
+    int expected_num = ref_detections(priors, conf, num_prior, num_classes, confidence_threshold, 0, class_top,
+                                      nms_threshold, keep_top_k, expected);
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    int loc_dims[3] = {1, loc_size, 1};
+    int conf_dims[3] = {1, conf_size, 1};
+    int prior_dims[3] = {1, 2, loc_size};
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    tensor_t inputs[3];
+    inputs[0] = test_cpu_input(graph, "loc", TENGINE_DT_FP32, loc_dims, 3, loc);
+    inputs[1] = test_cpu_input(graph, "conf", TENGINE_DT_FP32, conf_dims, 3, conf);
+    inputs[2] = test_cpu_input(graph, "prior", TENGINE_DT_FP32, prior_dims, 3, prior);
+
+    node_t node = test_cpu_node(graph, "detect", "DetectionOutput", inputs, 3, fp32, 1);
+
+    struct detection_output_param* param = (struct detection_output_param*)test_cpu_param(node);
+    param->num_classes = num_classes;
+    param->keep_top_k = keep_top_k;
+    param->nms_top_k = nms_top_k;
+    param->confidence_threshold = confidence_threshold;
+    param->nms_threshold = nms_threshold;
+
+    const char* input_names[] = {"loc", "conf", "prior"};
+    const char* output_names[] = {"detect"};
+
+    char what[96];
+    snprintf(what, sizeof(what), "detection output %d priors nms top %d keep top %d threads %d", num_prior, nms_top_k,
+             keep_top_k, num_thread);
+
+    int ret = 0;
+
+    if (test_cpu_prerun(graph, input_names, 3, output_names, 1, num_thread) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "%s: run failed.\n", what);
+        ret = -1;
+    }
+    else
+    {
+        tensor_t output = get_graph_output_tensor(graph, 0, 0);
+
+        int dims[4] = {0};
+        get_tensor_shape(output, dims, 4);
+
+        if (dims[1] != expected_num)
+        {
+            fprintf(stderr, "%s: %d detections, expected %d\n", what, dims[1], expected_num);
+            ret = -1;
+        }
+        else
+        {
+            const float* data = (const float*)get_tensor_buffer(output);
+            struct test_box* boxes = (struct test_box*)malloc((expected_num + 1) * sizeof(struct test_box));
+
+            for (int i = 0; i < expected_num; i++)
+            {
+                boxes[i].label = (int)data[i * 6];
+                boxes[i].score = data[i * 6 + 1];
+                boxes[i].x0 = data[i * 6 + 2];
+                boxes[i].y0 = data[i * 6 + 3];
+                boxes[i].x1 = data[i * 6 + 4];
+                boxes[i].y1 = data[i * 6 + 5];
+            }
+
+            ret = compare_detections(what, boxes, expected, expected_num);
+            free(boxes);
+        }
+
+        if (memcmp(conf, conf_copy, conf_size * sizeof(float)) != 0
+            || memcmp(prior, prior_copy, 2 * loc_size * sizeof(float)) != 0)
+        {
+            fprintf(stderr, "%s: the inputs are changed.\n", what);
+            ret = -1;
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    free(loc);
+    free(conf);
+    free(prior);
+    free(conf_copy);
+    free(prior_copy);
+    free(priors);
+    free(expected);
+
+    return ret;
+}
+
+static int test_detection_postprocess(int num_boxes, int num_classes, int max_detections, int num_thread)
+{
+    unsigned int seed = 31 + num_boxes;
+
+    /* the classes of the scores have the background 0 too */
+    int score_classes = num_classes + 1;
+
+    float* boxes = (float*)calloc(4 * num_boxes, sizeof(float));
+    float* scores = (float*)malloc(score_classes * num_boxes * sizeof(float));
+    float* anchors = (float*)malloc(4 * num_boxes * sizeof(float));
+    float* scores_nc = (float*)malloc(score_classes * num_boxes * sizeof(float));
+    struct test_box* priors = (struct test_box*)malloc(num_boxes * sizeof(struct test_box));
+    struct test_box* expected = (struct test_box*)malloc(num_boxes * score_classes * sizeof(struct test_box));
+
+    /* the anchors of ycenter, xcenter, h, w, the boxes are the anchors for the coords of 0 */
+    for (int i = 0; i < num_boxes; i++)
+    {
+        struct test_box* box = priors + i;
+        random_box(&seed, &box->x0, &box->y0, &box->x1, &box->y1);
+
+        anchors[i * 4] = (box->y0 + box->y1) * 0.5f;
+        anchors[i * 4 + 1] = (box->x0 + box->x1) * 0.5f;
+        anchors[i * 4 + 2] = box->y1 - box->y0;
+        anchors[i * 4 + 3] = box->x1 - box->x0;
+    }
+
+    /* the scores of [1, classes, boxes], and of [boxes, classes] for the reference */
+    for (int c = 0; c < score_classes; c++)
+    {
+        for (int i = 0; i < num_boxes; i++)
+        {
+            float score = 0.5f + 0.5f * random_score(&seed);
+            scores[c * num_boxes + i] = score;
+            scores_nc[i * score_classes + c] = score;
+        }
+    }
+
+    float* scores_copy = (float*)malloc(score_classes * num_boxes * sizeof(float));
+    float* anchors_copy = (float*)malloc(4 * num_boxes * sizeof(float));
+    memcpy(scores_copy, scores, score_classes * num_boxes * sizeof(float));
+    memcpy(anchors_copy, anchors, 4 * num_boxes * sizeof(float));
+
+    float iou_threshold = 0.5f;
+    int class_top = 2 * max_detections < num_boxes ? 2 * max_detections : num_boxes;
+
+    int expected_num = ref_detections(priors, scores_nc, num_boxes, score_classes, DPP_SCORE_THRESHOLD, 1, class_top,
+                                      iou_threshold, max_detections, expected);
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    int box_dims[3] = {1, 4, num_boxes};
+    int score_dims[3] = {1, score_classes, num_boxes};
+    int anchor_dims[2] = {num_boxes, 4};
+    int fp32[4] = {TENGINE_DT_FP32, TENGINE_DT_FP32, TENGINE_DT_FP32, TENGINE_DT_FP32};
+
+    tensor_t inputs[3];
+    inputs[0] = test_cpu_input(graph, "boxes", TENGINE_DT_FP32, box_dims, 3, boxes);
+    inputs[1] = test_cpu_input(graph, "scores", TENGINE_DT_FP32, score_dims, 3, scores);
+    inputs[2] = test_cpu_input(graph, "anchors", TENGINE_DT_FP32, anchor_dims, 2, anchors);
+
+    node_t node = test_cpu_node(graph, "dpp", "DetectionPostProcess", inputs, 3, fp32, 4);
+
+    /* the scales are released with the op */
+    struct detection_postprocess_param* param = (struct detection_postprocess_param*)test_cpu_param(node);
+    param->max_detections = max_detections;
+    param->max_classes_per_detection = 1;
+    param->nms_score_threshold = DPP_SCORE_THRESHOLD;
+    param->nms_iou_threshold = iou_threshold;
+    param->num_classes = num_classes;
+    param->scales = (float*)malloc(4 * sizeof(float));
+    param->scales[0] = 10.f;
+    param->scales[1] = 10.f;
+    param->scales[2] = 5.f;
+    param->scales[3] = 5.f;
+
+    const char* input_names[] = {"boxes", "scores", "anchors"};
+    const char* output_names[] = {"dpp"};
+
+    char what[96];
+    snprintf(what, sizeof(what), "detection postprocess %d boxes max %d threads %d", num_boxes, max_detections,
+             num_thread);
+
+    int ret = 0;
+
+    if (test_cpu_prerun(graph, input_names, 3, output_names, 1, num_thread) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "%s: run failed.\n", what);
+        ret = -1;
+    }
+    else
+    {
+        const float* out_boxes = (const float*)get_tensor_buffer(get_graph_tensor(graph, "dpp"));
+        const float* out_classes = (const float*)get_tensor_buffer(get_graph_tensor(graph, "dpp_1"));
+        const float* out_scores = (const float*)get_tensor_buffer(get_graph_tensor(graph, "dpp_2"));
+        const float* out_num = (const float*)get_tensor_buffer(get_graph_tensor(graph, "dpp_3"));
+
+        if ((int)out_num[0] != expected_num)
+        {
+            fprintf(stderr, "%s: %d detections, expected %d\n", what, (int)out_num[0], expected_num);
+            ret = -1;
+        }
+        else
+        {
+            struct test_box* detections = (struct test_box*)malloc((expected_num + 1) * sizeof(struct test_box));
+
+            for (int i = 0; i < expected_num; i++)
+            {
+                detections[i].label = (int)out_classes[i];
+                detections[i].score = out_scores[i];
+                detections[i].x0 = out_boxes[i * 4];
+                detections[i].y0 = out_boxes[i * 4 + 1];
+                detections[i].x1 = out_boxes[i * 4 + 2];
+                detections[i].y1 = out_boxes[i * 4 + 3];
+            }
+
+            ret = compare_detections(what, detections, expected, expected_num);
+            free(detections);
+        }
+
+        if (memcmp(scores, scores_copy, score_classes * num_boxes * sizeof(float)) != 0
+            || memcmp(anchors, anchors_copy, 4 * num_boxes * sizeof(float)) != 0)
+        {
+            fprintf(stderr, "%s: the inputs are changed.\n", what);
+            ret = -1;
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    free(boxes);
+    free(scores);
+    free(anchors);
+    free(scores_nc);
+    free(scores_copy);
+    free(anchors_copy);
+    free(priors);
+    free(expected);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    init_tengine();
+
+    int ret = 0;
+
+    /* the nms top k under, none, and over the candidates of a class, the keep top k cutting the classes */
+    ret |= test_detection_output(40, 3, 8, 10, 1);
+    ret |= test_detection_output(40, 3, 0, 100, 1);
+    ret |= test_detection_output(300, 5, 200, 50, 4);
+    ret |= test_detection_output(300, 5, 1000, 400, 2);
+
+    /* class top of 2 * max detections, over 256 boxes for the iou bitmasks with threads */
+    ret |= test_detection_postprocess(100, 2, 10, 1);
+    ret |= test_detection_postprocess(700, 2, 150, 1);
+    ret |= test_detection_postprocess(700, 2, 150, 4);
+    ret |= test_detection_postprocess(2000, 3, 600, 4);
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test nms pass.\n");
+
+    return ret;
+}
@@ -0,0 +1,231 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * resize of batches more than 1, nearest and bilinear with the half pixel coords clamped to
+ * the input at the edges, by the optimized op and the ref op, fp32 and uint8. every image of
+ * the batch differs, so an image resized from another one or left unwritten is told.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/resize_param.h"
+
+#include <stdint.h>
+
+#define RESIZE_NEAREST  0
+#define RESIZE_BILINEAR 1
+
+/* the output coords are mapped to the input by 1 / scale, as the op does when the output size is truncated */
+static void ref_resize(const float* input, float* output, int n, int c, int h, int w, int oh, int ow, float scale_h,
+                       float scale_w, int type)
+{
+    float scale_y = 1.f / scale_h;
+    float scale_x = 1.f / scale_w;
+
+    for (int p = 0; p < n * c; p++)
+    {
+        const float* in = input + p * h * w;
+        float* out = output + p * oh * ow;
+
+        for (int y = 0; y < oh; y++)
+        {
+            for (int x = 0; x < ow; x++)
+            {
+                if (RESIZE_NEAREST == type)
+                {
+                    int sy = (int)(y * scale_y) < h - 1 ? (int)(y * scale_y) : h - 1;
+                    int sx = (int)(x * scale_x) < w - 1 ? (int)(x * scale_x) : w - 1;
+                    out[y * ow + x] = in[sy * w + sx];
+                    continue;
+                }
+
+                float fy = (y + 0.5f) * scale_y - 0.5f;
+                float fx = (x + 0.5f) * scale_x - 0.5f;
+                fy = fy < 0.f ? 0.f : (fy > h - 1 ? h - 1 : fy);
+                fx = fx < 0.f ? 0.f : (fx > w - 1 ? w - 1 : fx);
+
+                int y0 = (int)fy;
+                int x0 = (int)fx;
+                int y1 = y0 + 1 < h ? y0 + 1 : h - 1;
+                int x1 = x0 + 1 < w ? x0 + 1 : w - 1;
+                float ay = fy - y0;
+                float ax = fx - x0;
+
+                out[y * ow + x] = (in[y0 * w + x0] * (1.f - ax) + in[y0 * w + x1] * ax) * (1.f - ay)
+                                  + (in[y1 * w + x0] * (1.f - ax) + in[y1 * w + x1] * ax) * ay;
+            }
+        }
+    }
+}
+
+static int test_resize(const char* ops, int n, int c, int h, int w, float scale_h, float scale_w, int type,
+                       int data_type)
+{
+    unsigned int seed = 17;
+
+    int dims[4] = {n, c, h, w};
+    int oh = (int)(h * scale_h);
+    int ow = (int)(w * scale_w);
+    int size = n * c * h * w;
+    int out_size = n * c * oh * ow;
+
+    /* the quant params of both the uint8 input and output */
+    float q_scale = 0.05f;
+    int q_zero = 10;
+
+    float* input_fp32 = (float*)malloc(size * sizeof(float));
+    float* expected = (float*)malloc(out_size * sizeof(float));
+    void* input_data = malloc(size * sizeof(float));
+
+    for (int i = 0; i < size; i++)
+    {
+        if (TENGINE_DT_FP32 == data_type)
+        {
+            input_fp32[i] = test_cpu_random(&seed);
+            ((float*)input_data)[i] = input_fp32[i];
+        }
+        else
+        {
+            uint8_t q = (uint8_t)((test_cpu_random(&seed) + 1.f) * 127.5f);
+            ((uint8_t*)input_data)[i] = q;
+            input_fp32[i] = ((float)q - q_zero) * q_scale;
+        }
+    }
+
+    ref_resize(input_fp32, expected, n, c, h, w, oh, ow, scale_h, scale_w, type);
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    int output_types[1] = {data_type};
+    tensor_t input = test_cpu_input(graph, "input", data_type, dims, 4, input_data);
+    node_t node = test_cpu_node(graph, "resize", "Resize", &input, 1, output_types, 1);
+
+    struct resize_param* param = (struct resize_param*)test_cpu_param(node);
+    param->scale_h = scale_h;
+    param->scale_w = scale_w;
+    param->type = type;
+
+    if (TENGINE_DT_UINT8 == data_type)
+    {
+        set_tensor_quant_param(input, &q_scale, &q_zero, 1);
+        set_tensor_quant_param(get_graph_tensor(graph, "resize"), &q_scale, &q_zero, 1);
+    }
+
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"resize"};
+
+    char what[128];
+    snprintf(what, sizeof(what), "%s resize %s [%d %d %d %d] to [%d %d] type %d", ops,
+             RESIZE_NEAREST == type ? "nearest" : "bilinear", n, c, h, w, oh, ow, data_type);
+
+    int ret = 0;
+
+    if (test_cpu_prerun(graph, inputs, 1, outputs, 1, 1) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "%s: run failed.\n", what);
+        ret = -1;
+    }
+    else
+    {
+        tensor_t output = get_graph_output_tensor(graph, 0, 0);
+        void* output_data = get_tensor_buffer(output);
+
+        if (get_tensor_buffer_size(output) != out_size * test_cpu_elem_size(data_type))
+        {
+            fprintf(stderr, "%s: output size %d\n", what, get_tensor_buffer_size(output));
+            ret = -1;
+        }
+        else if (TENGINE_DT_FP32 == data_type)
+        {
+            if (test_cpu_compare(what, (float*)output_data, expected, out_size, 1e-5f) > 0)
+                ret = -1;
+        }
+        else
+        {
+            /* the quantized output may round to the next step */
+            int bad = 0;
+            for (int i = 0; i < out_size; i++)
+            {
+                int q = (int)roundf(expected[i] / q_scale + q_zero);
+                q = q < 0 ? 0 : (q > 255 ? 255 : q);
+
+                if (abs((int)((uint8_t*)output_data)[i] - q) <= 1)
+                    continue;
+
+                if (bad < 4)
+                    fprintf(stderr, "%s: [%d] %d, expected %d\n", what, i, ((uint8_t*)output_data)[i], q);
+                bad++;
+            }
+
+            if (bad > 0)
+                ret = -1;
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    free(input_fp32);
+    free(expected);
+    free(input_data);
+
+    return ret;
+}
+
+static int test_resize_cases(const char* ops, int data_type)
+{
+    int ret = 0;
+
+    for (int type = RESIZE_NEAREST; type <= RESIZE_BILINEAR; type++)
+    {
+        ret |= test_resize(ops, 2, 3, 5, 7, 2.f, 2.f, type, data_type);
+        ret |= test_resize(ops, 3, 2, 6, 9, 1.5f, 2.5f, type, data_type);
+        ret |= test_resize(ops, 2, 4, 8, 10, 0.5f, 0.5f, type, data_type);
+        ret |= test_resize(ops, 1, 1, 2, 3, 4.f, 3.f, type, data_type);
+    }
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    init_tengine();
+
+    int ret = 0;
+
+    ret |= test_resize_cases("opt", TENGINE_DT_FP32);
+
+    /* the op implementations are selected in prerun */
+    setenv("TG_DEBUG_REF", "1", 1);
+
+    ret |= test_resize_cases("ref", TENGINE_DT_FP32);
+    ret |= test_resize_cases("ref", TENGINE_DT_UINT8);
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test resize pass.\n");
+
+    return ret;
+}
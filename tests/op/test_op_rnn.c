@@ -0,0 +1,254 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * lstm and gru of onnx in the inputs the ref ops take: no bias, the bias, and the bias with the
+ * initial states as exported by pytorch. the graph is prerun for the longest sequence and run for
+ * shorter ones too, one way and bidirectional, and compared to the ref ops run with TG_DEBUG_REF=1.
+ * the ref ops are one way only, the reverse direction is compared to the ref op run on the steps
+ * of the input reversed. the hidden size is not a multiple of the block of units.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/lstm_param.h"
+#include "operator/prototype/gru_param.h"
+
+#define INPUT_SIZE 10
+#define HIDDEN     13
+#define BATCH      2
+#define MAX_GATE   4
+#define MAX_DIR    2
+
+#define SEQ_NUM 3
+static const int seq_lens[SEQ_NUM] = {7, 3, 1};
+#define MAX_SEQ 7
+
+struct rnn_case
+{
+    const char* op;
+    int gate_num;
+    int input_num;
+};
+
+#define CASE_NUM 5
+static const struct rnn_case rnn_cases[CASE_NUM] = {
+    {"Lstm", 4, 3},
+    {"Lstm", 4, 4},
+    {"Lstm", 4, 6},
+    {"Gru", 3, 3},
+    {"Gru", 3, 5},
+};
+
+/* of the two directions one after another */
+static float w_data[MAX_DIR * MAX_GATE * HIDDEN * INPUT_SIZE];
+static float r_data[MAX_DIR * MAX_GATE * HIDDEN * HIDDEN];
+static float b_data[MAX_DIR * 2 * MAX_GATE * HIDDEN];
+static float h_data[MAX_DIR * BATCH * HIDDEN];
+static float c_data[MAX_DIR * BATCH * HIDDEN];
+
+static float input_data[MAX_SEQ * BATCH * INPUT_SIZE];
+
+/* the graph of dir_num directions, of the weights and states from the direction dir on */
+static graph_t create_test_graph(const struct rnn_case* rnn_case, int dir_num, int dir, int seq_len)
+{
+    int gate_hidden = rnn_case->gate_num * HIDDEN;
+    int fp32[1] = {TENGINE_DT_FP32};
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[3] = {seq_len, BATCH, INPUT_SIZE};
+    int w_dims[3] = {dir_num, gate_hidden, INPUT_SIZE};
+    int r_dims[3] = {dir_num, gate_hidden, HIDDEN};
+    int b_dims[2] = {dir_num, 2 * gate_hidden};
+    int state_dims[3] = {dir_num, BATCH, HIDDEN};
+
+    tensor_t inputs[6];
+    inputs[0] = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 3, NULL);
+    inputs[1] = test_cpu_const(graph, "w", TENGINE_DT_FP32, w_dims, 3, w_data + dir * gate_hidden * INPUT_SIZE);
+    inputs[2] = test_cpu_const(graph, "r", TENGINE_DT_FP32, r_dims, 3, r_data + dir * gate_hidden * HIDDEN);
+
+    if (rnn_case->input_num > 3)
+        inputs[3] = test_cpu_const(graph, "b", TENGINE_DT_FP32, b_dims, 2, b_data + dir * 2 * gate_hidden);
+    if (rnn_case->input_num > 4)
+        inputs[4] = test_cpu_const(graph, "init_h", TENGINE_DT_FP32, state_dims, 3, h_data + dir * BATCH * HIDDEN);
+    if (rnn_case->input_num > 5)
+        inputs[5] = test_cpu_const(graph, "init_c", TENGINE_DT_FP32, state_dims, 3, c_data + dir * BATCH * HIDDEN);
+
+    node_t node = test_cpu_node(graph, "out", rnn_case->op, inputs, rnn_case->input_num, fp32, 1);
+    if (NULL == node)
+        return NULL;
+
+    if (rnn_case->gate_num == 4)
+    {
+        struct lstm_param* param = (struct lstm_param*)test_cpu_param(node);
+        param->hidden_size = HIDDEN;
+        param->mxnet_flag = 0;
+    }
+    else
+    {
+        struct gru_param* param = (struct gru_param*)test_cpu_param(node);
+        param->hidden_size = HIDDEN;
+        param->mxnet_flag = 0;
+    }
+
+    const char* input_names[] = {"input"};
+    const char* output_names[] = {"out"};
+
+    if (test_cpu_prerun(graph, input_names, 1, output_names, 1, 1) < 0)
+        return NULL;
+
+    return graph;
+}
+
+static int run_seq(graph_t graph, int seq_len, float* data)
+{
+    int dims[3] = {seq_len, BATCH, INPUT_SIZE};
+    tensor_t input = get_graph_input_tensor(graph, 0, 0);
+
+    if (set_tensor_shape(input, dims, 3) < 0 || set_tensor_buffer(input, data, seq_len * BATCH * INPUT_SIZE * sizeof(float)) < 0)
+        return -1;
+
+    return run_graph(graph, 1);
+}
+
+/* the output of the ref op, the direction of a bidirectional one from the one way ref op of its weights */
+static int run_ref(const struct rnn_case* rnn_case, int dir_num, int seq_len, float* expected)
+{
+    float reversed[MAX_SEQ * BATCH * INPUT_SIZE];
+    int step_size = BATCH * INPUT_SIZE;
+    int out_size = BATCH * HIDDEN;
+
+    for (int s = 0; s < seq_len; s++)
+        memcpy(reversed + s * step_size, input_data + (seq_len - 1 - s) * step_size, step_size * sizeof(float));
+
+    for (int d = 0; d < dir_num; d++)
+    {
+        setenv("TG_DEBUG_REF", "1", 1);
+        graph_t graph = create_test_graph(rnn_case, 1, d, seq_len);
+        unsetenv("TG_DEBUG_REF");
+
+        if (NULL == graph || run_seq(graph, seq_len, d == 0 ? input_data : reversed) < 0)
+            return -1;
+
+        const float* output = (const float*)get_tensor_buffer(get_graph_tensor(graph, "out"));
+
+        for (int s = 0; s < seq_len; s++)
+        {
+            int step = d == 0 ? s : seq_len - 1 - s;
+
+            memcpy(expected + (step * dir_num + d) * out_size, output + s * out_size, out_size * sizeof(float));
+        }
+
+        postrun_graph(graph);
+        destroy_graph(graph);
+    }
+
+    return 0;
+}
+
+static int test_rnn(const struct rnn_case* rnn_case, int dir_num)
+{
+    graph_t graph = create_test_graph(rnn_case, dir_num, 0, MAX_SEQ);
+
+    if (NULL == graph)
+    {
+        fprintf(stderr, "%s of %d inputs, %d directions: prerun failed.\n", rnn_case->op, rnn_case->input_num, dir_num);
+        return -1;
+    }
+
+    int ret = 0;
+
+    for (int i = 0; i < SEQ_NUM; i++)
+    {
+        int seq_len = seq_lens[i];
+        int size = seq_len * dir_num * BATCH * HIDDEN;
+        float expected[MAX_SEQ * MAX_DIR * BATCH * HIDDEN];
+
+        char what[64];
+        snprintf(what, sizeof(what), "%s of %d inputs, %d directions, seq %d", rnn_case->op, rnn_case->input_num,
+                 dir_num, seq_len);
+
+        if (run_ref(rnn_case, dir_num, seq_len, expected) < 0 || run_seq(graph, seq_len, input_data) < 0)
+        {
+            fprintf(stderr, "%s: run failed.\n", what);
+            ret = -1;
+            break;
+        }
+
+        tensor_t output = get_graph_tensor(graph, "out");
+
+        if (get_tensor_buffer_size(output) != size * (int)sizeof(float))
+        {
+            fprintf(stderr, "%s: size %d, expected %d\n", what, get_tensor_buffer_size(output), size * (int)sizeof(float));
+            ret = -1;
+        }
+        else if (test_cpu_compare(what, (float*)get_tensor_buffer(output), expected, size, 1e-4f) > 0)
+        {
+            ret = -1;
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 53;
+    float scale = 1.f / sqrtf((float)HIDDEN);
+
+    for (int i = 0; i < (int)(sizeof(w_data) / sizeof(float)); i++)
+        w_data[i] = scale * test_cpu_random(&seed);
+    for (int i = 0; i < (int)(sizeof(r_data) / sizeof(float)); i++)
+        r_data[i] = scale * test_cpu_random(&seed);
+    for (int i = 0; i < (int)(sizeof(b_data) / sizeof(float)); i++)
+        b_data[i] = scale * test_cpu_random(&seed);
+    for (int i = 0; i < (int)(sizeof(h_data) / sizeof(float)); i++)
+        h_data[i] = test_cpu_random(&seed);
+    for (int i = 0; i < (int)(sizeof(c_data) / sizeof(float)); i++)
+        c_data[i] = test_cpu_random(&seed);
+    for (int i = 0; i < (int)(sizeof(input_data) / sizeof(float)); i++)
+        input_data[i] = test_cpu_random(&seed);
+
+    init_tengine();
+
+    int ret = 0;
+
+    for (int i = 0; i < CASE_NUM; i++)
+    {
+        for (int dir_num = 1; dir_num <= MAX_DIR; dir_num++)
+            ret |= test_rnn(&rnn_cases[i], dir_num);
+    }
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test rnn pass.\n");
+
+    return ret;
+}
@@ -0,0 +1,351 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * exp, tanh and sigmoid of utility/simd_math.h against the double libm, within the ulps the header
+ * states: the scalar functions and the vectors of the flags the test is built with, run as the ops
+ * run them, the vector loop and the scalar tail. every value is run at every place of the lengths
+ * around the widths, so that it is met in the vectors and in the tails. the values are the ones of
+ * the branches and of the saturation, +-88 and +-100 among them, and NaN. the sigmoid and tanh ops
+ * of the cpu are run over the same values, on lengths around the blocks of their threads.
+ */
+
+#include "test_cpu_graph.h"
+
+#include <float.h>
+
+#include "utility/simd_math.h"
+
+#define FUNC_EXP     0
+#define FUNC_TANH    1
+#define FUNC_SIGMOID 2
+#define FUNC_NUM     3
+
+static const char* func_names[FUNC_NUM] = {"exp", "tanh", "sigmoid"};
+
+/* the max errors the header states, rounded up */
+static const double func_ulps[FUNC_NUM] = {1.5, 1.5, 3.0};
+
+#define SPECIAL_NUM 44
+static float special_data[SPECIAL_NUM] = {
+    0.f, -0.f, 1e-30f, -1e-30f, 1e-3f, -1e-3f, 0.5f, -0.5f,
+    0.624f, -0.624f, 0.625f, -0.625f, 1.f, -1.f, 8.99f, -8.99f,
+    9.f, -9.f, 10.f, -10.f, 20.f, -20.f, 50.f, -50.f,
+    86.9f, -86.9f, 87.5f, -87.5f, 88.f, -88.f, 88.37f, -88.37f,
+    88.5f, -88.5f, 89.f, -89.f, 100.f, -100.f, 1e4f, -1e4f,
+    3e38f, -3e38f, NAN, -NAN};
+
+/* the lengths around the vectors of 4, 8 and 16 */
+#define LENGTH_NUM 12
+static const int lengths[LENGTH_NUM] = {1, 3, 4, 5, 7, 9, 15, 17, 31, 33, 47, 49};
+
+/* the magnitudes of the sweep from 2^-12 to 256, of both signs */
+#define SWEEP_NUM 20011
+
+/* the ops cut the elements in blocks of 4096 for the threads */
+#define OP_SIZE_NUM 4
+static const int op_sizes[OP_SIZE_NUM] = {4096 * 2 + 13, 4096, 33, 7};
+
+static float sweep_data[SWEEP_NUM];
+
+static float scalar_func(int func, float x)
+{
+    if (func == FUNC_EXP)
+        return simd_exp_f32(x);
+    if (func == FUNC_TANH)
+        return simd_tanh_f32(x);
+
+    return simd_sigmoid_f32(x);
+}
+
+/* exp saturates over SIMD_EXP_HI, by the header */
+static double ref_func(int func, double x)
+{
+    if (func == FUNC_EXP)
+        return exp(x > SIMD_EXP_HI ? SIMD_EXP_HI : x);
+    if (func == FUNC_TANH)
+        return tanh(x);
+
+    return 1. / (1. + exp(-x));
+}
+
+static void apply_scalar(int func, const float* x, float* y, int n)
+{
+    for (int i = 0; i < n; i++)
+        y[i] = scalar_func(func, x[i]);
+}
+
+#if __SSE2__ || defined(__ARM_NEON)
+static void apply_x4(int func, const float* x, float* y, int n)
+{
+    int i = 0;
+
+#if __SSE2__
+    for (; i + 3 < n; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(x + i);
+        v = func == FUNC_EXP ? simd_exp_f32x4(v) : func == FUNC_TANH ? simd_tanh_f32x4(v) : simd_sigmoid_f32x4(v);
+        _mm_storeu_ps(y + i, v);
+    }
+#else
+    for (; i + 3 < n; i += 4)
+    {
+        float32x4_t v = vld1q_f32(x + i);
+        v = func == FUNC_EXP ? simd_exp_f32x4(v) : func == FUNC_TANH ? simd_tanh_f32x4(v) : simd_sigmoid_f32x4(v);
+        vst1q_f32(y + i, v);
+    }
+#endif
+
+    for (; i < n; i++)
+        y[i] = scalar_func(func, x[i]);
+}
+#endif
+
+#if __AVX__
+static void apply_x8(int func, const float* x, float* y, int n)
+{
+    int i = 0;
+
+    for (; i + 7 < n; i += 8)
+    {
+        __m256 v = _mm256_loadu_ps(x + i);
+        v = func == FUNC_EXP ? simd_exp_f32x8(v) : func == FUNC_TANH ? simd_tanh_f32x8(v) : simd_sigmoid_f32x8(v);
+        _mm256_storeu_ps(y + i, v);
+    }
+
+    for (; i < n; i++)
+        y[i] = scalar_func(func, x[i]);
+}
+#endif
+
+#if __AVX512F__
+static void apply_x16(int func, const float* x, float* y, int n)
+{
+    int i = 0;
+
+    for (; i + 15 < n; i += 16)
+    {
+        __m512 v = _mm512_loadu_ps(x + i);
+        v = func == FUNC_EXP ? simd_exp_f32x16(v) : func == FUNC_TANH ? simd_tanh_f32x16(v) : simd_sigmoid_f32x16(v);
+        _mm512_storeu_ps(y + i, v);
+    }
+
+    for (; i < n; i++)
+        y[i] = scalar_func(func, x[i]);
+}
+#endif
+
+typedef void (*apply_t)(int func, const float* x, float* y, int n);
+
+struct width
+{
+    const char* name;
+    apply_t apply;
+};
+
+static const struct width widths[] = {
+    {"scalar", apply_scalar},
+#if __SSE2__ || defined(__ARM_NEON)
+    {"x4", apply_x4},
+#endif
+#if __AVX__
+    {"x8", apply_x8},
+#endif
+#if __AVX512F__
+    {"x16", apply_x16},
+#endif
+};
+
+#define WIDTH_NUM ((int)(sizeof(widths) / sizeof(widths[0])))
+
+/* the result of x is within the ulps of the double one, the ones under FLT_MIN are only close to 0 by the header */
+static int check_value(int func, float x, float y)
+{
+    if (x != x)
+        return y != y;
+
+    double ref = ref_func(func, x);
+
+    if (fabs(ref) < FLT_MIN)
+        return y == y && fabs(y - ref) <= FLT_MIN;
+
+    int e;
+    frexp(ref, &e);
+
+    return fabs(y - ref) <= func_ulps[func] * ldexp(1., e - 24);
+}
+
+static int check_data(const char* what, int func, const float* x, const float* y, int n)
+{
+    int bad = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (check_value(func, x[i], y[i]))
+            continue;
+
+        if (bad < 4)
+            fprintf(stderr, "%s: [%d] %s(%g) = %.9g, expected %.9g\n", what, i, func_names[func], x[i], y[i],
+                    ref_func(func, x[i]));
+
+        bad++;
+    }
+
+    return bad;
+}
+
+/* every special value at every place of every length, then the sweep */
+static int test_width(const struct width* width, int func)
+{
+    float x[64];
+    float y[64];
+    int ret = 0;
+
+    for (int l = 0; l < LENGTH_NUM; l++)
+    {
+        int n = lengths[l];
+        int bad = 0;
+
+        for (int start = 0; start < SPECIAL_NUM; start++)
+        {
+            for (int i = 0; i < n; i++)
+                x[i] = special_data[(start + i) % SPECIAL_NUM];
+
+            width->apply(func, x, y, n);
+
+            char what[64];
+            snprintf(what, sizeof(what), "%s %s length %d", width->name, func_names[func], n);
+
+            bad += check_data(what, func, x, y, n);
+        }
+
+        if (bad > 0)
+            ret = -1;
+    }
+
+    float* sweep_out = (float*)malloc(SWEEP_NUM * sizeof(float));
+
+    width->apply(func, sweep_data, sweep_out, SWEEP_NUM);
+
+    char what[64];
+    snprintf(what, sizeof(what), "%s %s sweep", width->name, func_names[func]);
+
+    if (check_data(what, func, sweep_data, sweep_out, SWEEP_NUM) > 0)
+        ret = -1;
+
+    free(sweep_out);
+
+    return ret;
+}
+
+/* the op of the cpu over the specials and the sweep, prerun for the largest size and run for smaller ones */
+static int test_op(const char* op, int func, const float* input_data)
+{
+    int fp32[1] = {TENGINE_DT_FP32};
+    int dims[2] = {1, op_sizes[0]};
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return -1;
+
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, dims, 2, NULL);
+
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"out"};
+
+    if (NULL == input || NULL == test_cpu_node(graph, "out", op, &input, 1, fp32, 1)
+            || test_cpu_prerun(graph, inputs, 1, outputs, 1, 1) < 0)
+    {
+        fprintf(stderr, "%s: prerun failed.\n", op);
+        return -1;
+    }
+
+    int ret = 0;
+
+    for (int s = 0; s < OP_SIZE_NUM; s++)
+    {
+        dims[1] = op_sizes[s];
+
+        char what[64];
+        snprintf(what, sizeof(what), "%s op size %d", op, op_sizes[s]);
+
+        if (set_tensor_shape(input, dims, 2) < 0 || set_tensor_buffer(input, (void*)input_data, dims[1] * sizeof(float)) < 0
+                || run_graph(graph, 1) < 0)
+        {
+            fprintf(stderr, "%s: run failed.\n", what);
+            ret = -1;
+            break;
+        }
+
+        const float* output = (const float*)get_tensor_buffer(get_graph_tensor(graph, "out"));
+
+        if (check_data(what, func, input_data, output, dims[1]) > 0)
+            ret = -1;
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 59;
+
+    for (int i = 0; i < SWEEP_NUM; i++)
+    {
+        float r = test_cpu_random(&seed);
+        float m = ldexpf(1.f + fabsf(test_cpu_random(&seed)), (int)(10.f * (r + 1.f)) - 12);
+
+        sweep_data[i] = i % 2 ? -m : m;
+    }
+
+    int ret = 0;
+
+    for (int w = 0; w < WIDTH_NUM; w++)
+    {
+        for (int func = 0; func < FUNC_NUM; func++)
+            ret |= test_width(&widths[w], func);
+    }
+
+    /* the specials first, so that they are in the smallest size too */
+    float* op_data = (float*)malloc(op_sizes[0] * sizeof(float));
+
+    for (int i = 0; i < op_sizes[0]; i++)
+        op_data[i] = i < SPECIAL_NUM ? special_data[i] : sweep_data[i % SWEEP_NUM];
+
+    init_tengine();
+
+    ret |= test_op("Sigmoid", FUNC_SIGMOID, op_data);
+    ret |= test_op("Tanh", FUNC_TANH, op_data);
+
+    release_tengine();
+
+    free(op_data);
+
+    if (0 == ret)
+        fprintf(stderr, "test simd math pass.\n");
+
+    return ret;
+}
@@ -0,0 +1,227 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * slice and split of caffe along the channels of a convolution, whose outputs are views on the
+ * block of the convolution, with the first output read by an inplace noop. the noop may only
+ * write over the view when no other node reads the block after it: the other output or the
+ * convolution itself read by a pooling before the noop, after it, or not at all.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/slice_param.h"
+#include "operator/prototype/split_param.h"
+
+#define IN_C   4
+#define BASE_C 6
+#define HW     5
+
+/* the pooling reads the other output before the noop, after it, or reads the convolution after it */
+#define READ_BEFORE  0
+#define READ_AFTER   1
+#define BASE_AFTER   2
+#define NOT_READ     3
+
+static const char* order_names[] = {"read before", "read after", "base after", "not read"};
+
+static tensor_t create_pool(graph_t graph, int order)
+{
+    const char* input_name = order == BASE_AFTER ? "base" : "view_1";
+
+    return test_cpu_pool(graph, "pool", get_graph_tensor(graph, input_name), POOL_AVG, 0, 1);
+}
+
+static graph_t create_test_graph(const char* op, int order, float* input_data)
+{
+    unsigned int seed = 9;
+    int fp32[2] = {TENGINE_DT_FP32, TENGINE_DT_FP32};
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+    if (NULL == graph)
+        return NULL;
+
+    int input_dims[4] = {1, IN_C, HW, HW};
+
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, input_dims, 4, input_data);
+    tensor_t base = test_cpu_conv(graph, "base", input, IN_C, BASE_C, 3, 1, 1, -1, &seed);
+
+    if (NULL == op)
+        return graph;
+
+    node_t view = test_cpu_node(graph, "view", op, &base, 1, fp32, 2);
+    if (NULL == view)
+        return NULL;
+
+    if (0 == strcmp(op, "Slice"))
+    {
+        struct slice_param* param = (struct slice_param*)test_cpu_param(view);
+        param->iscaffe = 1;
+        param->axis = 1;
+    }
+    else
+    {
+        struct split_param* param = (struct split_param*)test_cpu_param(view);
+        param->is_caffe = 1;
+        param->axis = 1;
+    }
+
+    if (order == READ_BEFORE && NULL == create_pool(graph, order))
+        return NULL;
+
+    tensor_t view_0 = get_graph_tensor(graph, "view");
+
+    if (NULL == test_cpu_node(graph, "noop", "Noop", &view_0, 1, fp32, 1))
+        return NULL;
+
+    if ((order == READ_AFTER || order == BASE_AFTER) && NULL == create_pool(graph, order))
+        return NULL;
+
+    return graph;
+}
+
+/* the channel means of the channels of the convolution */
+static void ref_global_pool(const float* base, int channel, int channel_num, float* output)
+{
+    for (int c = 0; c < channel_num; c++)
+    {
+        const float* plane = base + (channel + c) * HW * HW;
+        float sum = 0.f;
+
+        for (int i = 0; i < HW * HW; i++)
+            sum += plane[i];
+
+        output[c] = sum / (HW * HW);
+    }
+}
+
+static int check_output(const char* what, graph_t graph, const char* name, const float* expected, int size)
+{
+    tensor_t output = get_graph_tensor(graph, name);
+
+    if (get_tensor_buffer_size(output) != size * (int)sizeof(float))
+    {
+        fprintf(stderr, "%s %s: size %d, expected %d\n", what, name, get_tensor_buffer_size(output), size * (int)sizeof(float));
+        return -1;
+    }
+
+    return test_cpu_compare(what, (float*)get_tensor_buffer(output), expected, size, 1e-5f) > 0 ? -1 : 0;
+}
+
+static int test_view(const char* op, int order, float* input_data, const float* base_data)
+{
+    char what[64];
+    snprintf(what, sizeof(what), "%s %s", op, order_names[order]);
+
+    graph_t graph = create_test_graph(op, order, input_data);
+    if (NULL == graph)
+        return -1;
+
+    const char* inputs[] = {"input"};
+    const char* outputs[2] = {"noop", "pool"};
+    int output_num = order == NOT_READ ? 1 : 2;
+
+    if (test_cpu_prerun(graph, inputs, 1, outputs, output_num, 1) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "%s: run failed.\n", what);
+        destroy_graph(graph);
+        return -1;
+    }
+
+    /* slice halves the channels, split of caffe copies all of them to each output */
+    int is_slice = 0 == strcmp(op, "Slice");
+    int view_c = is_slice ? BASE_C / 2 : BASE_C;
+    int pool_c = order == BASE_AFTER ? BASE_C : view_c;
+    int pool_channel = order == BASE_AFTER || !is_slice ? 0 : BASE_C / 2;
+
+    int ret = check_output(what, graph, "noop", base_data, view_c * HW * HW);
+
+    if (order != NOT_READ)
+    {
+        float expected[BASE_C];
+        ref_global_pool(base_data, pool_channel, pool_c, expected);
+
+        ret |= check_output(what, graph, "pool", expected, pool_c);
+    }
+
+    /* the noop writes over the view only if no node reads the block of the convolution after it */
+    struct tensor* view = (struct tensor*)get_graph_tensor(graph, "view");
+    struct tensor* noop = (struct tensor*)get_graph_tensor(graph, "noop");
+    int inplace = order == READ_BEFORE || order == NOT_READ;
+
+    if ((noop->data == view->data) != inplace)
+    {
+        fprintf(stderr, "%s: the noop is %sin place, expected %sin place.\n", what, noop->data == view->data ? "" : "not ",
+                inplace ? "" : "not ");
+        ret = -1;
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 13;
+
+    float input_data[IN_C * HW * HW];
+    float base_data[BASE_C * HW * HW];
+
+    for (int i = 0; i < IN_C * HW * HW; i++)
+        input_data[i] = test_cpu_random(&seed);
+
+    init_tengine();
+
+    /* the convolution alone */
+    graph_t graph = create_test_graph(NULL, 0, input_data);
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"base"};
+
+    if (NULL == graph || test_cpu_prerun(graph, inputs, 1, outputs, 1, 1) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "convolution run failed.\n");
+        return -1;
+    }
+
+    memcpy(base_data, get_tensor_buffer(get_graph_tensor(graph, "base")), sizeof(base_data));
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    int ret = 0;
+
+    for (int order = READ_BEFORE; order <= NOT_READ; order++)
+    {
+        ret |= test_view("Slice", order, input_data, base_data);
+        ret |= test_view("Split", order, input_data, base_data);
+    }
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test slice pass.\n");
+
+    return ret;
+}
@@ -0,0 +1,171 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * spacetodepth: the blocks of the input planes are moved to the channels as onnx does,
+ * out[n][(by * block + bx) * c + ci][y][x] = in[n][ci][y * block + by][x * block + bx],
+ * for fp32 and for uint8 moved as bytes.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/spacetodepth_param.h"
+
+#include <stdint.h>
+
+static void ref_spacetodepth(const float* input, float* output, int n, int c, int h, int w, int block)
+{
+    int out_h = h / block;
+    int out_w = w / block;
+
+    for (int b = 0; b < n; b++)
+        for (int by = 0; by < block; by++)
+            for (int bx = 0; bx < block; bx++)
+                for (int ci = 0; ci < c; ci++)
+                    for (int y = 0; y < out_h; y++)
+                        for (int x = 0; x < out_w; x++)
+                        {
+                            int oc = (by * block + bx) * c + ci;
+                            int out = ((b * c * block * block + oc) * out_h + y) * out_w + x;
+                            int in = ((b * c + ci) * h + y * block + by) * w + x * block + bx;
+
+                            output[out] = input[in];
+                        }
+}
+
+static int test_spacetodepth(int n, int c, int h, int w, int block, int data_type, int num_thread)
+{
+    int dims[4] = {n, c, h, w};
+    int size = n * c * h * w;
+
+    float* input_fp32 = (float*)malloc(size * sizeof(float));
+    float* expected = (float*)malloc(size * sizeof(float));
+    float* output_fp32 = (float*)malloc(size * sizeof(float));
+    void* input_data = malloc(size * sizeof(float));
+
+    /* the index as the value, wrapped to bytes for uint8 */
+    for (int i = 0; i < size; i++)
+    {
+        if (TENGINE_DT_FP32 == data_type)
+        {
+            input_fp32[i] = (float)i;
+            ((float*)input_data)[i] = input_fp32[i];
+        }
+        else
+        {
+            input_fp32[i] = (float)(i % 251);
+            ((uint8_t*)input_data)[i] = (uint8_t)(i % 251);
+        }
+    }
+
+    ref_spacetodepth(input_fp32, expected, n, c, h, w, block);
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    int output_types[1] = {data_type};
+    tensor_t input = test_cpu_input(graph, "input", data_type, dims, 4, input_data);
+    node_t node = test_cpu_node(graph, "s2d", "Spacetodepth", &input, 1, output_types, 1);
+
+    ((struct spacetodepth_param*)test_cpu_param(node))->block_size = block;
+
+    if (TENGINE_DT_UINT8 == data_type)
+    {
+        float scale = 1.f;
+        int zero_point = 0;
+        set_tensor_quant_param(input, &scale, &zero_point, 1);
+        set_tensor_quant_param(get_graph_tensor(graph, "s2d"), &scale, &zero_point, 1);
+    }
+
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"s2d"};
+
+    char what[96];
+    snprintf(what, sizeof(what), "spacetodepth [%d %d %d %d] block %d type %d", n, c, h, w, block, data_type);
+
+    int ret = 0;
+
+    if (test_cpu_prerun(graph, inputs, 1, outputs, 1, num_thread) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "%s: run failed.\n", what);
+        ret = -1;
+    }
+    else
+    {
+        tensor_t output = get_graph_output_tensor(graph, 0, 0);
+
+        int out_dims[4] = {0};
+        get_tensor_shape(output, out_dims, 4);
+
+        if (out_dims[0] != n || out_dims[1] != c * block * block || out_dims[2] != h / block
+            || out_dims[3] != w / block)
+        {
+            fprintf(stderr, "%s: output [%d %d %d %d]\n", what, out_dims[0], out_dims[1], out_dims[2], out_dims[3]);
+            ret = -1;
+        }
+        else
+        {
+            void* output_data = get_tensor_buffer(output);
+            for (int i = 0; i < size; i++)
+            {
+                if (TENGINE_DT_FP32 == data_type)
+                    output_fp32[i] = ((float*)output_data)[i];
+                else
+                    output_fp32[i] = (float)((uint8_t*)output_data)[i];
+            }
+
+            if (test_cpu_compare(what, output_fp32, expected, size, 0.f) > 0)
+                ret = -1;
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    free(input_fp32);
+    free(expected);
+    free(output_fp32);
+    free(input_data);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    init_tengine();
+
+    int ret = 0;
+
+    ret |= test_spacetodepth(1, 1, 4, 4, 2, TENGINE_DT_FP32, 1);
+    ret |= test_spacetodepth(2, 3, 6, 8, 2, TENGINE_DT_FP32, 1);
+    ret |= test_spacetodepth(1, 5, 9, 12, 3, TENGINE_DT_FP32, 4);
+    ret |= test_spacetodepth(2, 16, 32, 32, 4, TENGINE_DT_FP32, 2);
+    ret |= test_spacetodepth(2, 3, 6, 8, 2, TENGINE_DT_UINT8, 1);
+    ret |= test_spacetodepth(1, 7, 10, 10, 5, TENGINE_DT_UINT8, 2);
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test spacetodepth pass.\n");
+
+    return ret;
+}
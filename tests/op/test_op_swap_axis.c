@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * swap_axis: the output shape is the input one with the two dims swapped, for any dim number,
+ * and the elements are moved once by the offsets of the dims. the dims out of the input fail.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/swap_axis_param.h"
+
+#define MAX_DIM 6
+
+/* the input swapped element by element */
+static void ref_swap_axis(const float* input, float* output, const int* dims, int dim_num, int dim_0, int dim_1)
+{
+    int out_dims[MAX_DIM];
+    int size = 1;
+    for (int i = 0; i < dim_num; i++)
+    {
+        out_dims[i] = dims[i];
+        size *= dims[i];
+    }
+    out_dims[dim_0] = dims[dim_1];
+    out_dims[dim_1] = dims[dim_0];
+
+    for (int o = 0; o < size; o++)
+    {
+        int pos[MAX_DIM];
+        int rest = o;
+        for (int i = dim_num - 1; i >= 0; i--)
+        {
+            pos[i] = rest % out_dims[i];
+            rest /= out_dims[i];
+        }
+
+        int tmp = pos[dim_0];
+        pos[dim_0] = pos[dim_1];
+        pos[dim_1] = tmp;
+
+        int in = 0;
+        for (int i = 0; i < dim_num; i++)
+            in = in * dims[i] + pos[i];
+
+        output[o] = input[in];
+    }
+}
+
+/* the swap of the dims checked for the shape and the data, valid is 0 for dims expected to fail */
+static int test_swap_axis(const int* dims, int dim_num, int dim_0, int dim_1, int num_thread, int valid)
+{
+    int size = 1;
+    for (int i = 0; i < dim_num; i++)
+        size *= dims[i];
+
+    float* input_data = (float*)malloc(size * sizeof(float));
+    float* expected = (float*)malloc(size * sizeof(float));
+
+    /* the index as the value, a misplaced element is told by its value */
+    for (int i = 0; i < size; i++)
+        input_data[i] = (float)i;
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    int fp32[1] = {TENGINE_DT_FP32};
+    tensor_t input = test_cpu_input(graph, "input", TENGINE_DT_FP32, dims, dim_num, input_data);
+    node_t node = test_cpu_node(graph, "swap", "SwapAxis", &input, 1, fp32, 1);
+
+    struct swap_axis_param* param = (struct swap_axis_param*)test_cpu_param(node);
+    param->dim_0 = dim_0;
+    param->dim_1 = dim_1;
+
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"swap"};
+
+    char what[64];
+    snprintf(what, sizeof(what), "swap axis %d and %d of %d dims", dim_0, dim_1, dim_num);
+
+    int ret = 0;
+
+    if (test_cpu_prerun(graph, inputs, 1, outputs, 1, num_thread) < 0 || run_graph(graph, 1) < 0)
+    {
+        if (valid)
+        {
+            fprintf(stderr, "%s: run failed.\n", what);
+            ret = -1;
+        }
+    }
+    else if (!valid)
+    {
+        fprintf(stderr, "%s: run did not fail.\n", what);
+        ret = -1;
+    }
+    else
+    {
+        tensor_t output = get_graph_output_tensor(graph, 0, 0);
+
+        int out_dims[MAX_SHAPE_DIM_NUM];
+        int out_dim_num = get_tensor_shape(output, out_dims, MAX_SHAPE_DIM_NUM);
+
+        int shape_ok = out_dim_num == dim_num;
+        for (int i = 0; shape_ok && i < dim_num; i++)
+        {
+            int expected_dim = i == dim_0 ? dims[dim_1] : (i == dim_1 ? dims[dim_0] : dims[i]);
+            shape_ok = out_dims[i] == expected_dim;
+        }
+
+        if (!shape_ok)
+        {
+            fprintf(stderr, "%s: output of %d dims, [%d %d ...]\n", what, out_dim_num, out_dims[0], out_dims[1]);
+            ret = -1;
+        }
+        else
+        {
+            ref_swap_axis(input_data, expected, dims, dim_num, dim_0, dim_1);
+
+            if (test_cpu_compare(what, (float*)get_tensor_buffer(output), expected, size, 0.f) > 0)
+                ret = -1;
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    free(input_data);
+    free(expected);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    int dims_2[2] = {9, 13};
+    int dims_4[4] = {2, 3, 5, 7};
+    int dims_5[5] = {2, 3, 4, 5, 6};
+    int dims_6[6] = {2, 1, 3, 4, 1, 5};
+
+    init_tengine();
+
+    int ret = 0;
+
+    ret |= test_swap_axis(dims_2, 2, 0, 1, 1, 1);
+    ret |= test_swap_axis(dims_4, 4, 1, 3, 1, 1);
+    ret |= test_swap_axis(dims_4, 4, 2, 3, 2, 1);
+    ret |= test_swap_axis(dims_5, 5, 3, 1, 1, 1);
+    ret |= test_swap_axis(dims_5, 5, 0, 4, 4, 1);
+    ret |= test_swap_axis(dims_6, 6, 1, 5, 1, 1);
+
+    /* the dims out of the input */
+    ret |= test_swap_axis(dims_4, 4, 1, 4, 1, 0);
+    ret |= test_swap_axis(dims_4, 4, -1, 2, 1, 0);
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test swap axis pass.\n");
+
+    return ret;
+}
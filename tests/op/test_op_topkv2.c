@@ -0,0 +1,206 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2021, OPEN AI LAB
+ */
+
+/*
+ * topkv2: the k largest of each row of the last dim in order, the ties by the smaller index,
+ * for many rows split over the threads, fp32 and uint8. the input is left unchanged.
+ */
+
+#include "test_cpu_graph.h"
+
+#include "operator/prototype/topkv2_param.h"
+
+#include <stdint.h>
+
+struct value_index
+{
+    float value;
+    int index;
+};
+
+/* the larger value first, the smaller index first of the same value */
+static int compare_value_index(const void* a, const void* b)
+{
+    const struct value_index* x = (const struct value_index*)a;
+    const struct value_index* y = (const struct value_index*)b;
+
+    if (x->value != y->value)
+        return x->value > y->value ? -1 : 1;
+
+    return x->index - y->index;
+}
+
+/* the k best of a row by sorting all of it */
+static void ref_topkv2_row(const float* row, int row_size, int k, float* values, int* indices)
+{
+    struct value_index* pairs = (struct value_index*)malloc(row_size * sizeof(struct value_index));
+
+    for (int i = 0; i < row_size; i++)
+    {
+        pairs[i].value = row[i];
+        pairs[i].index = i;
+    }
+
+    qsort(pairs, row_size, sizeof(struct value_index), compare_value_index);
+
+    for (int j = 0; j < k; j++)
+    {
+        values[j] = pairs[j].value;
+        indices[j] = pairs[j].index;
+    }
+
+    free(pairs);
+}
+
+static int test_topkv2(const int* dims, int dim_num, int k, int value_range, int data_type, int num_thread)
+{
+    unsigned int seed = 23;
+
+    int row_size = dims[dim_num - 1];
+    int size = 1;
+    for (int i = 0; i < dim_num; i++)
+        size *= dims[i];
+    int row_num = size / row_size;
+
+    float* input_fp32 = (float*)malloc(size * sizeof(float));
+    void* input_data = malloc(size * sizeof(float));
+    void* input_copy = malloc(size * sizeof(float));
+    float* expected_values = (float*)malloc(row_num * k * sizeof(float));
+    int* expected_indices = (int*)malloc(row_num * k * sizeof(int));
+
+    /* the values of a few levels in the range, so the rows have many ties */
+    for (int i = 0; i < size; i++)
+    {
+        int level = (int)((test_cpu_random(&seed) + 1.f) * 0.5f * value_range);
+
+        input_fp32[i] = (float)level;
+        if (TENGINE_DT_FP32 == data_type)
+            ((float*)input_data)[i] = input_fp32[i];
+        else
+            ((uint8_t*)input_data)[i] = (uint8_t)level;
+    }
+    memcpy(input_copy, input_data, size * sizeof(float));
+
+    for (int r = 0; r < row_num; r++)
+        ref_topkv2_row(input_fp32 + r * row_size, row_size, k, expected_values + r * k, expected_indices + r * k);
+
+    graph_t graph = create_graph(NULL, NULL, NULL);
+
+    int output_types[2] = {data_type, TENGINE_DT_INT32};
+    tensor_t input = test_cpu_input(graph, "input", data_type, dims, dim_num, input_data);
+    node_t node = test_cpu_node(graph, "topk", "Topkv2", &input, 1, output_types, 2);
+
+    struct topkv2_param* param = (struct topkv2_param*)test_cpu_param(node);
+    param->k = k;
+    param->sorted = true;
+
+    if (TENGINE_DT_UINT8 == data_type)
+    {
+        float scale = 1.f;
+        int zero_point = 0;
+        set_tensor_quant_param(input, &scale, &zero_point, 1);
+        set_tensor_quant_param(get_graph_tensor(graph, "topk"), &scale, &zero_point, 1);
+    }
+
+    const char* inputs[] = {"input"};
+    const char* outputs[] = {"topk"};
+
+    char what[96];
+    snprintf(what, sizeof(what), "topkv2 %d rows of %d k %d type %d threads %d", row_num, row_size, k, data_type,
+             num_thread);
+
+    int ret = 0;
+
+    if (test_cpu_prerun(graph, inputs, 1, outputs, 1, num_thread) < 0 || run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "%s: run failed.\n", what);
+        ret = -1;
+    }
+    else
+    {
+        void* values = get_tensor_buffer(get_graph_tensor(graph, "topk"));
+        int* indices = (int*)get_tensor_buffer(get_graph_tensor(graph, "topk_1"));
+
+        int bad = 0;
+        for (int i = 0; i < row_num * k; i++)
+        {
+            float value = TENGINE_DT_FP32 == data_type ? ((float*)values)[i] : (float)((uint8_t*)values)[i];
+
+            if (value == expected_values[i] && indices[i] == expected_indices[i])
+                continue;
+
+            if (bad < 4)
+                fprintf(stderr, "%s: [%d] %f of %d, expected %f of %d\n", what, i, value, indices[i],
+                        expected_values[i], expected_indices[i]);
+            bad++;
+        }
+
+        if (bad > 0)
+            ret = -1;
+
+        if (memcmp(input_data, input_copy, size * test_cpu_elem_size(data_type)) != 0)
+        {
+            fprintf(stderr, "%s: the input is changed.\n", what);
+            ret = -1;
+        }
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    free(input_fp32);
+    free(input_data);
+    free(input_copy);
+    free(expected_values);
+    free(expected_indices);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    int dims_row[1] = {37};
+    int dims_rows[3] = {3, 4, 50};
+    int dims_long[2] = {5, 3000};
+
+    init_tengine();
+
+    int ret = 0;
+
+    ret |= test_topkv2(dims_row, 1, 1, 1000, TENGINE_DT_FP32, 1);
+    ret |= test_topkv2(dims_row, 1, 37, 8, TENGINE_DT_FP32, 1);
+    ret |= test_topkv2(dims_rows, 3, 5, 8, TENGINE_DT_FP32, 1);
+    ret |= test_topkv2(dims_rows, 3, 17, 1000, TENGINE_DT_FP32, 4);
+    ret |= test_topkv2(dims_rows, 3, 50, 20, TENGINE_DT_FP32, 2);
+    ret |= test_topkv2(dims_long, 2, 10, 100, TENGINE_DT_FP32, 4);
+    ret |= test_topkv2(dims_long, 2, 1200, 100, TENGINE_DT_FP32, 2);
+    ret |= test_topkv2(dims_rows, 3, 5, 8, TENGINE_DT_UINT8, 1);
+    ret |= test_topkv2(dims_long, 2, 64, 256, TENGINE_DT_UINT8, 4);
+
+    release_tengine();
+
+    if (0 == ret)
+        fprintf(stderr, "test topkv2 pass.\n");
+
+    return ret;
+}